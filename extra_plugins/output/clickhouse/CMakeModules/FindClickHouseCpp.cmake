@@ -0,0 +1,24 @@
+#  CLICKHOUSE_FOUND        - System has clickhouse-cpp client library
+#  CLICKHOUSE_INCLUDE_DIRS - The clickhouse-cpp include directories
+#  CLICKHOUSE_LIBRARIES    - The libraries needed to use clickhouse-cpp
+
+find_path(
+	CLICKHOUSE_INCLUDE_DIR clickhouse/client.h
+	PATH_SUFFIXES include
+)
+
+find_library(
+	CLICKHOUSE_LIBRARY NAMES clickhouse-cpp-lib clickhouse-cpp-lib-static
+	PATH_SUFFIXES lib lib64
+)
+
+# handle the QUIETLY and REQUIRED arguments and set CLICKHOUSE_FOUND to TRUE
+# if all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(ClickHouseCpp
+	REQUIRED_VARS CLICKHOUSE_LIBRARY CLICKHOUSE_INCLUDE_DIR
+)
+
+set(CLICKHOUSE_LIBRARIES ${CLICKHOUSE_LIBRARY})
+set(CLICKHOUSE_INCLUDE_DIRS ${CLICKHOUSE_INCLUDE_DIR})
+mark_as_advanced(CLICKHOUSE_INCLUDE_DIR CLICKHOUSE_LIBRARY)
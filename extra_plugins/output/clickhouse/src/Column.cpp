@@ -0,0 +1,401 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Column.cpp
+ * \author agent <agent@local>
+ * \brief Conversion of IPFIX fields to ClickHouse columns (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <endian.h>
+
+#include "Column.hpp"
+
+Column::Column(const std::string &name, const char *type, const struct fds_iemgr_elem *elem)
+    : m_name(name), m_type(type), m_id(elem->id)
+{
+    // Reverse elements of biflow records can be defined with a different Enterprise Number
+    m_pen = elem->scope->pen;
+    if (elem->is_reverse && elem->scope->biflow_mode == FDS_BF_PEN) {
+        m_pen = elem->scope->biflow_id;
+    }
+}
+
+/** \brief Load an unsigned integer in network byte order (native size)    */
+static inline uint8_t  load_be(const uint8_t *data, uint8_t)  {return *data;}
+static inline uint16_t load_be(const uint8_t *data, uint16_t) {
+    uint16_t v; memcpy(&v, data, sizeof(v)); return be16toh(v);
+}
+static inline uint32_t load_be(const uint8_t *data, uint32_t) {
+    uint32_t v; memcpy(&v, data, sizeof(v)); return be32toh(v);
+}
+static inline uint64_t load_be(const uint8_t *data, uint64_t) {
+    uint64_t v; memcpy(&v, data, sizeof(v)); return be64toh(v);
+}
+
+/**
+ * \brief Base of all columns with a specific ClickHouse column type
+ * \tparam CT ClickHouse column type
+ */
+template <typename CT>
+class ColumnTyped : public Column {
+public:
+    template <typename... Args>
+    ColumnTyped(const std::string &name, const char *type, const struct fds_iemgr_elem *elem,
+            Args... args)
+        : Column(name, type, elem), m_col(std::make_shared<CT>(args...)) {}
+
+    clickhouse::ColumnRef
+    take(size_t rows) override
+    {
+        clickhouse::ColumnRef ret = m_col;
+        m_col = std::static_pointer_cast<CT>(ret->CloneEmpty());
+        m_col->Reserve(rows);
+        return ret;
+    }
+
+protected:
+    /** Column data                                                         */
+    std::shared_ptr<CT> m_col;
+};
+
+/**
+ * \brief Column of unsigned integers
+ *
+ * Fields encoded with the native size are copied directly. Fields with reduced-size encoding
+ * are converted using the generic function.
+ * \tparam T Native type
+ */
+template <typename T>
+class ColumnUnsigned : public ColumnTyped<clickhouse::ColumnVector<T>> {
+public:
+    using ColumnTyped<clickhouse::ColumnVector<T>>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        T value = 0;
+        if (field != nullptr && field->size == sizeof(T)) {
+            value = load_be(field->data, T());
+        } else if (field != nullptr) {
+            uint64_t tmp;
+            if (fds_get_uint_be(field->data, field->size, &tmp) == FDS_OK) {
+                const uint64_t max = std::numeric_limits<T>::max();
+                value = static_cast<T>((tmp > max) ? max : tmp);
+            }
+        }
+
+        this->m_col->Append(value);
+    }
+};
+
+/**
+ * \brief Column of signed integers
+ * \tparam T Native type
+ * \tparam U Unsigned type of the same size
+ */
+template <typename T, typename U>
+class ColumnSigned : public ColumnTyped<clickhouse::ColumnVector<T>> {
+public:
+    using ColumnTyped<clickhouse::ColumnVector<T>>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        T value = 0;
+        if (field != nullptr && field->size == sizeof(T)) {
+            value = static_cast<T>(load_be(field->data, U()));
+        } else if (field != nullptr) {
+            int64_t tmp;
+            if (fds_get_int_be(field->data, field->size, &tmp) == FDS_OK) {
+                const int64_t min = std::numeric_limits<T>::min();
+                const int64_t max = std::numeric_limits<T>::max();
+                value = static_cast<T>((tmp < min) ? min : ((tmp > max) ? max : tmp));
+            }
+        }
+
+        this->m_col->Append(value);
+    }
+};
+
+/**
+ * \brief Column of floating point numbers
+ * \tparam T Native type
+ */
+template <typename T>
+class ColumnFloat : public ColumnTyped<clickhouse::ColumnVector<T>> {
+public:
+    using ColumnTyped<clickhouse::ColumnVector<T>>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        double value = 0.0;
+        if (field != nullptr && fds_get_float_be(field->data, field->size, &value) != FDS_OK) {
+            value = 0.0;
+        }
+
+        this->m_col->Append(static_cast<T>(value));
+    }
+};
+
+/** \brief Column of booleans (stored as UInt8)                             */
+class ColumnBool : public ColumnTyped<clickhouse::ColumnUInt8> {
+public:
+    using ColumnTyped<clickhouse::ColumnUInt8>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        bool value = false;
+        if (field != nullptr && fds_get_bool(field->data, field->size, &value) != FDS_OK) {
+            value = false;
+        }
+
+        m_col->Append(value ? 1 : 0);
+    }
+};
+
+/** \brief Column of variable-length strings (strings and octet arrays)     */
+class ColumnStr : public ColumnTyped<clickhouse::ColumnString> {
+public:
+    using ColumnTyped<clickhouse::ColumnString>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        if (field == nullptr) {
+            m_col->Append(std::string_view());
+            return;
+        }
+
+        m_col->Append(std::string_view(reinterpret_cast<const char *>(field->data), field->size));
+    }
+};
+
+/** \brief Column of fixed-length strings (MAC addresses)                   */
+class ColumnFixed : public ColumnTyped<clickhouse::ColumnFixedString> {
+public:
+    ColumnFixed(const std::string &name, const char *type, const struct fds_iemgr_elem *elem,
+            size_t size)
+        : ColumnTyped(name, type, elem, size), m_size(size) {}
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        static const char zeros[16] = {0};
+        if (field == nullptr || field->size != m_size) {
+            m_col->Append(std::string_view(zeros, m_size));
+            return;
+        }
+
+        m_col->Append(std::string_view(reinterpret_cast<const char *>(field->data), m_size));
+    }
+
+private:
+    /** Size of the string                                                  */
+    size_t m_size;
+};
+
+/** \brief Column of IPv4 addresses                                          */
+class ColumnIP4 : public ColumnTyped<clickhouse::ColumnIPv4> {
+public:
+    using ColumnTyped<clickhouse::ColumnIPv4>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        struct in_addr addr;
+        if (field != nullptr && field->size == sizeof(addr)) {
+            memcpy(&addr, field->data, sizeof(addr));
+        } else {
+            addr.s_addr = 0;
+        }
+
+        m_col->Append(addr);
+    }
+};
+
+/** \brief Column of IPv6 addresses                                          */
+class ColumnIP6 : public ColumnTyped<clickhouse::ColumnIPv6> {
+public:
+    using ColumnTyped<clickhouse::ColumnIPv6>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        if (field != nullptr && field->size == sizeof(struct in6_addr)) {
+            m_col->Append(reinterpret_cast<const struct in6_addr *>(field->data));
+        } else {
+            const struct in6_addr addr = IN6ADDR_ANY_INIT;
+            m_col->Append(&addr);
+        }
+    }
+};
+
+/** \brief Column of timestamps with precision of seconds                   */
+class ColumnTimeSec : public ColumnTyped<clickhouse::ColumnDateTime> {
+public:
+    using ColumnTyped<clickhouse::ColumnDateTime>::ColumnTyped;
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        std::time_t value = 0;
+        if (field != nullptr && field->size == sizeof(uint32_t)) {
+            value = static_cast<std::time_t>(load_be(field->data, uint32_t()));
+        }
+
+        m_col->Append(value);
+    }
+};
+
+/**
+ * \brief Column of timestamps with sub-second precision
+ *
+ * Milliseconds are stored in the same units as in IPFIX and they are copied directly. Micro
+ * and nanoseconds are encoded in the NTP format and must be converted.
+ */
+class ColumnTimeHP : public ColumnTyped<clickhouse::ColumnDateTime64> {
+public:
+    ColumnTimeHP(const std::string &name, const char *type, const struct fds_iemgr_elem *elem,
+            size_t precision)
+        : ColumnTyped(name, type, elem, precision), m_type(elem->data_type)
+    {
+        m_mult = 1;
+        for (size_t i = 0; i < precision; ++i) {
+            m_mult *= 10;
+        }
+    }
+
+    void
+    append(const struct fds_drec_field *field) override
+    {
+        int64_t value = 0;
+        struct timespec ts;
+
+        if (field == nullptr) {
+            // Default value
+        } else if (m_type == FDS_ET_DATE_TIME_MILLISECONDS && field->size == sizeof(uint64_t)) {
+            value = static_cast<int64_t>(load_be(field->data, uint64_t()));
+        } else if (fds_get_datetime_hp_be(field->data, field->size, m_type, &ts) == FDS_OK) {
+            value = static_cast<int64_t>(ts.tv_sec) * m_mult
+                + static_cast<int64_t>(ts.tv_nsec) / (1000000000LL / m_mult);
+        }
+
+        m_col->Append(value);
+    }
+
+private:
+    /** Data type of the IPFIX field                                        */
+    enum fds_iemgr_element_type m_type;
+    /** Number of units per second                                          */
+    int64_t m_mult;
+};
+
+std::unique_ptr<Column>
+Column::create(const std::string &name, const struct fds_iemgr_elem *elem)
+{
+    Column *col;
+
+    switch (elem->data_type) {
+    case FDS_ET_UNSIGNED_8:
+        col = new ColumnUnsigned<uint8_t>(name, "UInt8", elem);
+        break;
+    case FDS_ET_UNSIGNED_16:
+        col = new ColumnUnsigned<uint16_t>(name, "UInt16", elem);
+        break;
+    case FDS_ET_UNSIGNED_32:
+        col = new ColumnUnsigned<uint32_t>(name, "UInt32", elem);
+        break;
+    case FDS_ET_UNSIGNED_64:
+        col = new ColumnUnsigned<uint64_t>(name, "UInt64", elem);
+        break;
+    case FDS_ET_SIGNED_8:
+        col = new ColumnSigned<int8_t, uint8_t>(name, "Int8", elem);
+        break;
+    case FDS_ET_SIGNED_16:
+        col = new ColumnSigned<int16_t, uint16_t>(name, "Int16", elem);
+        break;
+    case FDS_ET_SIGNED_32:
+        col = new ColumnSigned<int32_t, uint32_t>(name, "Int32", elem);
+        break;
+    case FDS_ET_SIGNED_64:
+        col = new ColumnSigned<int64_t, uint64_t>(name, "Int64", elem);
+        break;
+    case FDS_ET_FLOAT_32:
+        col = new ColumnFloat<float>(name, "Float32", elem);
+        break;
+    case FDS_ET_FLOAT_64:
+        col = new ColumnFloat<double>(name, "Float64", elem);
+        break;
+    case FDS_ET_BOOLEAN:
+        col = new ColumnBool(name, "UInt8", elem);
+        break;
+    case FDS_ET_MAC_ADDRESS:
+        col = new ColumnFixed(name, "FixedString(6)", elem, 6U);
+        break;
+    case FDS_ET_STRING:
+    case FDS_ET_OCTET_ARRAY:
+        col = new ColumnStr(name, "String", elem);
+        break;
+    case FDS_ET_IPV4_ADDRESS:
+        col = new ColumnIP4(name, "IPv4", elem);
+        break;
+    case FDS_ET_IPV6_ADDRESS:
+        col = new ColumnIP6(name, "IPv6", elem);
+        break;
+    case FDS_ET_DATE_TIME_SECONDS:
+        col = new ColumnTimeSec(name, "DateTime", elem);
+        break;
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+        col = new ColumnTimeHP(name, "DateTime64(3)", elem, 3U);
+        break;
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+        col = new ColumnTimeHP(name, "DateTime64(6)", elem, 6U);
+        break;
+    case FDS_ET_DATE_TIME_NANOSECONDS:
+        col = new ColumnTimeHP(name, "DateTime64(9)", elem, 9U);
+        break;
+    default:
+        throw std::invalid_argument("Data type of the Information Element '"
+            + std::string(elem->name) + "' (column '" + name + "') is not supported!");
+    }
+
+    return std::unique_ptr<Column>(col);
+}
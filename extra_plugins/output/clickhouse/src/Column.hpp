@@ -0,0 +1,120 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Column.hpp
+ * \author agent <agent@local>
+ * \brief Conversion of IPFIX fields to ClickHouse columns (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CLICKHOUSE_COLUMN_H
+#define CLICKHOUSE_COLUMN_H
+
+#include <memory>
+#include <string>
+#include <clickhouse/client.h>
+#include <libfds.h>
+
+/**
+ * \brief Column of a block of rows
+ *
+ * Values of an IPFIX field are appended directly to a native ClickHouse column, i.e. there is no
+ * intermediate representation of records. The type of the column is determined by the data
+ * type of the source Information Element.
+ */
+class Column {
+public:
+    virtual ~Column() = default;
+
+    /**
+     * \brief Create a column for values of an Information Element
+     * \param[in] name Name of the column
+     * \param[in] elem Definition of the source Information Element
+     * \throw invalid_argument if the data type of the element is not supported
+     * \return New column
+     */
+    static std::unique_ptr<Column>
+    create(const std::string &name, const struct fds_iemgr_elem *elem);
+
+    /**
+     * \brief Append a value of a field
+     * \param[in] field Field of a Data Record (nullptr == the field is missing, default value
+     *   of the column type is used)
+     */
+    virtual void
+    append(const struct fds_drec_field *field) = 0;
+
+    /**
+     * \brief Take the filled column and start a new (empty) one
+     * \param[in] rows Expected number of rows of the new column
+     * \return The filled column
+     */
+    virtual clickhouse::ColumnRef
+    take(size_t rows) = 0;
+
+    /** \brief Name of the column                                               */
+    const std::string &
+    name() const {return m_name;}
+    /** \brief Name of the ClickHouse data type of the column                   */
+    const char *
+    type() const {return m_type;}
+    /** \brief Enterprise Number of the source Information Element              */
+    uint32_t
+    pen() const {return m_pen;}
+    /** \brief ID of the source Information Element                             */
+    uint16_t
+    id() const {return m_id;}
+
+protected:
+    /**
+     * \brief Base constructor
+     * \param[in] name Name of the column
+     * \param[in] type Name of the ClickHouse data type
+     * \param[in] elem Definition of the source Information Element
+     */
+    Column(const std::string &name, const char *type, const struct fds_iemgr_elem *elem);
+
+private:
+    /** Name of the column                                                      */
+    std::string m_name;
+    /** Name of the ClickHouse data type                                        */
+    const char *m_type;
+    /** Enterprise Number of the source Information Element                     */
+    uint32_t m_pen;
+    /** ID of the source Information Element                                    */
+    uint16_t m_id;
+};
+
+#endif // CLICKHOUSE_COLUMN_H
@@ -0,0 +1,370 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Configuration of the ClickHouse output plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <strings.h>
+
+#include <libfds.h>
+#include "Config.hpp"
+
+/** Default port of the native protocol                                                         */
+#define DEF_PORT 9000
+/** Default number of rows of an inserted block                                                 */
+#define DEF_BLOCK_ROWS 100000
+/** Default maximum number of blocks waiting for insertion                                      */
+#define DEF_BLOCK_QUEUE 16
+/** Default number of parallel insert connections                                               */
+#define DEF_INSERTERS 4
+/** Default flush interval (in seconds)                                                         */
+#define DEF_FLUSH_INTERVAL 10
+
+/** XML nodes */
+enum params_xml_nodes {
+    // Connection
+    NODE_CONNECTION,   /**< Connection parameters           */
+    CONN_HOST,         /**< Hostname of a server            */
+    CONN_PORT,         /**< Port of a server                */
+    CONN_USER,         /**< User name                       */
+    CONN_PASSWORD,     /**< Password                        */
+    CONN_DATABASE,     /**< Database                        */
+    CONN_COMPRESSION,  /**< Compression of blocks           */
+    // Table
+    NODE_TABLE,        /**< Destination table               */
+    NODE_COLUMNS,      /**< List of columns                 */
+    COLUMN,            /**< Column definition               */
+    COLUMN_NAME,       /**< Name of the column              */
+    COLUMN_SOURCE,     /**< Source Information Element      */
+    // Insertion
+    NODE_BLOCK_ROWS,   /**< Rows per block                  */
+    NODE_BLOCK_QUEUE,  /**< Size of the queue of blocks     */
+    NODE_INSERTERS,    /**< Number of insert connections    */
+    NODE_FLUSH         /**< Flush interval                  */
+};
+
+/** Definition of the \<connection\> node  */
+static const struct fds_xml_args args_connection[] = {
+    FDS_OPTS_ELEM(CONN_HOST,        "host",        FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(CONN_PORT,        "port",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_USER,        "user",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_PASSWORD,    "password",    FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_DATABASE,    "database",    FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(CONN_COMPRESSION, "compression", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<column\> node  */
+static const struct fds_xml_args args_column[] = {
+    FDS_OPTS_ELEM(COLUMN_NAME,   "name",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(COLUMN_SOURCE, "source", FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<columns\> node  */
+static const struct fds_xml_args args_columns[] = {
+    FDS_OPTS_NESTED(COLUMN, "column", args_column, FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_NESTED(NODE_CONNECTION, "connection",    args_connection, 0),
+    FDS_OPTS_ELEM(NODE_TABLE,        "table",         FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_NESTED(NODE_COLUMNS,    "columns",       args_columns,    0),
+    FDS_OPTS_ELEM(NODE_BLOCK_ROWS,   "blockSize",     FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BLOCK_QUEUE,  "blockQueue",    FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_INSERTERS,    "inserterThreads", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_FLUSH,        "flushInterval", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Parse connection parameters
+ * \param[in] conn Parsed XML context
+ * \throw invalid_argument in case of invalid parameters
+ */
+void
+Config::parse_connection(fds_xml_ctx_t *conn)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(conn, &content) != FDS_EOC) {
+        switch (content->id) {
+        case CONN_HOST:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strlen(content->ptr_string) == 0) {
+                throw std::invalid_argument("Hostname of a server must not be empty!");
+            }
+            this->conn.hosts.emplace_back(content->ptr_string);
+            break;
+        case CONN_PORT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX || content->val_uint == 0) {
+                throw std::invalid_argument("Invalid port number of a server!");
+            }
+            this->conn.port = static_cast<uint16_t>(content->val_uint);
+            break;
+        case CONN_USER:
+            assert(content->type == FDS_OPTS_T_STRING);
+            this->conn.user = content->ptr_string;
+            break;
+        case CONN_PASSWORD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            this->conn.password = content->ptr_string;
+            break;
+        case CONN_DATABASE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            this->conn.database = content->ptr_string;
+            break;
+        case CONN_COMPRESSION:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "lz4") == 0) {
+                this->conn.lz4 = true;
+            } else if (strcasecmp(content->ptr_string, "none") == 0) {
+                this->conn.lz4 = false;
+            } else {
+                throw std::invalid_argument("Unexpected parameter of the element <compression> "
+                    "(expected 'lz4' or 'none')");
+            }
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <connection>!");
+        }
+    }
+}
+
+/**
+ * \brief Parse a definition of a column
+ * \param[in] column Parsed XML context
+ * \throw invalid_argument in case of invalid parameters
+ */
+void
+Config::parse_column(fds_xml_ctx_t *column)
+{
+    struct cfg_column def;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(column, &content) != FDS_EOC) {
+        switch (content->id) {
+        case COLUMN_NAME:
+            assert(content->type == FDS_OPTS_T_STRING);
+            def.name = content->ptr_string;
+            break;
+        case COLUMN_SOURCE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            def.source = content->ptr_string;
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <column>!");
+        }
+    }
+
+    if (def.name.empty() || def.source.empty()) {
+        throw std::invalid_argument("Name and source of a column must not be empty!");
+    }
+
+    columns.push_back(def);
+}
+
+/**
+ * \brief Parse a list of columns
+ * \param[in] columns Parsed XML context
+ * \throw invalid_argument in case of invalid parameters
+ */
+void
+Config::parse_columns(fds_xml_ctx_t *columns)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(columns, &content) != FDS_EOC) {
+        switch (content->id) {
+        case COLUMN:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_column(content->ptr_ctx);
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <columns>!");
+        }
+    }
+}
+
+/**
+ * \brief Parse all parameters
+ * \param[in] params Parsed XML context
+ * \throw invalid_argument in case of invalid parameters
+ */
+void
+Config::parse_params(fds_xml_ctx_t *params)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(params, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_CONNECTION:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_connection(content->ptr_ctx);
+            break;
+        case NODE_TABLE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            table = content->ptr_string;
+            break;
+        case NODE_COLUMNS:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            parse_columns(content->ptr_ctx);
+            break;
+        case NODE_BLOCK_ROWS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            block_rows = content->val_uint;
+            break;
+        case NODE_BLOCK_QUEUE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            block_queue = content->val_uint;
+            break;
+        case NODE_INSERTERS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("Number of inserter threads is too high!");
+            }
+            inserters = static_cast<unsigned int>(content->val_uint);
+            break;
+        case NODE_FLUSH:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Flush interval is too long!");
+            }
+            flush_interval = static_cast<unsigned int>(content->val_uint);
+            break;
+        default:
+            throw std::invalid_argument("Unexpected element within <params>!");
+        }
+    }
+}
+
+/**
+ * \brief Reset all parameters to default values
+ */
+void
+Config::default_set()
+{
+    conn.hosts.clear();
+    conn.port = DEF_PORT;
+    conn.user = "default";
+    conn.password.clear();
+    conn.database = "default";
+    conn.lz4 = true;
+
+    table.clear();
+    columns.clear();
+    block_rows = DEF_BLOCK_ROWS;
+    block_queue = DEF_BLOCK_QUEUE;
+    inserters = DEF_INSERTERS;
+    flush_interval = DEF_FLUSH_INTERVAL;
+}
+
+/**
+ * \brief Check if parsed configuration is valid
+ * \throw invalid_argument if the configuration is not valid
+ */
+void
+Config::check_validity()
+{
+    if (conn.hosts.empty()) {
+        throw std::invalid_argument("At least one <host> must be defined!");
+    }
+
+    if (table.empty()) {
+        throw std::invalid_argument("Name of the table must not be empty!");
+    }
+
+    if (columns.empty()) {
+        throw std::invalid_argument("At least one column must be defined!");
+    }
+
+    std::set<std::string> names;
+    for (const auto &column : columns) {
+        if (!names.insert(column.name).second) {
+            throw std::invalid_argument("Multiple columns with the same name '" + column.name
+                + "'!");
+        }
+    }
+
+    if (block_rows == 0) {
+        throw std::invalid_argument("Size of a block must be greater than zero!");
+    }
+
+    if (block_queue == 0) {
+        throw std::invalid_argument("Size of the queue of blocks must be greater than zero!");
+    }
+
+    if (inserters == 0) {
+        throw std::invalid_argument("Number of inserter threads must be greater than zero!");
+    }
+}
+
+Config::Config(const char *params)
+{
+    default_set();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_params(params_ctx);
+        check_validity();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Configuration of the ClickHouse output plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CLICKHOUSE_CONFIG_H
+#define CLICKHOUSE_CONFIG_H
+
+#include <string>
+#include <vector>
+#include <ipfixcol2.h>
+
+/** Mapping of an IPFIX field to a table column                                                */
+struct cfg_column {
+    /** Name of the column                                                                      */
+    std::string name;
+    /** Name of the source Information Element (e.g. "iana:octetDeltaCount")                    */
+    std::string source;
+};
+
+/** Connection parameters                                                                       */
+struct cfg_connection {
+    /** Hostnames or addresses of ClickHouse servers                                            */
+    std::vector<std::string> hosts;
+    /** Port of the native protocol                                                             */
+    uint16_t port;
+    /** User name                                                                               */
+    std::string user;
+    /** Password                                                                                */
+    std::string password;
+    /** Database                                                                                */
+    std::string database;
+    /** Use LZ4 compression of transmitted blocks                                               */
+    bool lz4;
+};
+
+/** Parsed configuration of an instance                                                         */
+class Config {
+private:
+    void default_set();
+    void check_validity();
+    void parse_connection(fds_xml_ctx_t *conn);
+    void parse_column(fds_xml_ctx_t *column);
+    void parse_columns(fds_xml_ctx_t *columns);
+    void parse_params(fds_xml_ctx_t *params);
+
+public:
+    /** Connection parameters                                                                   */
+    struct cfg_connection conn;
+    /** Name of the destination table                                                          */
+    std::string table;
+    /** Mapping of IPFIX fields to columns                                                      */
+    std::vector<struct cfg_column> columns;
+    /** Number of rows of an inserted block                                                     */
+    size_t block_rows;
+    /** Maximum number of blocks waiting for insertion                                          */
+    size_t block_queue;
+    /** Number of parallel insert connections                                                   */
+    unsigned int inserters;
+    /** Maximum time (in seconds) before a partially filled block is inserted (0 == disabled)   */
+    unsigned int flush_interval;
+
+    /**
+     * \brief Create a new configuration
+     * \param[in] params XML configuration of the plugin
+     * \throw runtime_error in case of invalid configuration
+     */
+    Config(const char *params);
+    /**
+     * \brief Configuration destructor
+     */
+    ~Config() = default;
+};
+
+#endif // CLICKHOUSE_CONFIG_H
@@ -0,0 +1,196 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Inserter.cpp
+ * \author agent <agent@local>
+ * \brief Pool of parallel insert connections (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include "Inserter.hpp"
+
+/** Delay between attempts to insert a block (in milliseconds)                                 */
+#define RETRY_DELAY 1000
+/** Maximum number of attempts to insert a block after a stop request                          */
+#define RETRY_STOP_MAX 3
+
+Inserter::Inserter(ipx_ctx_t *ctx, const Config &cfg)
+    : m_ctx(ctx), m_table(cfg.table), m_capacity(cfg.block_queue)
+{
+    const auto method = cfg.conn.lz4
+        ? clickhouse::CompressionMethod::LZ4
+        : clickhouse::CompressionMethod::None;
+
+    // Threads are evenly distributed among all servers
+    for (unsigned int i = 0; i < cfg.inserters; ++i) {
+        const std::string &host = cfg.conn.hosts[i % cfg.conn.hosts.size()];
+        m_opts.emplace_back(clickhouse::ClientOptions()
+            .SetHost(host)
+            .SetPort(cfg.conn.port)
+            .SetUser(cfg.conn.user)
+            .SetPassword(cfg.conn.password)
+            .SetDefaultDatabase(cfg.conn.database)
+            .SetCompressionMethod(method));
+    }
+
+    try {
+        for (size_t i = 0; i < m_opts.size(); ++i) {
+            m_threads.emplace_back(&Inserter::thread_main, this, i);
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv_ready.notify_all();
+        for (auto &thread : m_threads) {
+            thread.join();
+        }
+        throw;
+    }
+}
+
+Inserter::~Inserter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    // Threads insert all remaining blocks before termination
+    m_cv_ready.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+
+    IPX_CTX_INFO(m_ctx, "Inserted rows: %" PRIu64 ", lost rows: %" PRIu64,
+        m_rows_ok.load(), m_rows_lost.load());
+}
+
+void
+Inserter::push(clickhouse::Block &&block)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_queue.size() >= m_capacity) {
+        IPX_CTX_DEBUG(m_ctx, "The queue of blocks is full, waiting for inserter threads...", '\0');
+        m_cv_free.wait(lock, [this]() {return m_queue.size() < m_capacity;});
+    }
+
+    m_queue.push_back(std::move(block));
+    lock.unlock();
+    m_cv_ready.notify_one();
+}
+
+/**
+ * \brief Main function of an inserter thread
+ *
+ * The thread takes blocks from the queue and inserts them into the database. The function
+ * terminates after a stop request if the queue is empty.
+ * \param[in] idx Index of the thread
+ */
+void
+Inserter::thread_main(size_t idx)
+{
+    std::unique_ptr<clickhouse::Client> client;
+
+    while (true) {
+        clickhouse::Block block;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_ready.wait(lock, [this]() {return m_stop || !m_queue.empty();});
+            if (m_queue.empty()) {
+                // Stop request and nothing to insert
+                break;
+            }
+
+            block = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        m_cv_free.notify_one();
+        insert(client, idx, block);
+    }
+}
+
+/**
+ * \brief Insert a block into the database
+ *
+ * If the connection is not established, try to connect. On failure, the insert is repeated
+ * after a short delay until it succeeds. After a stop request, only a limited number of
+ * attempts is made and the block is dropped if all of them fail.
+ * \param[in] client Connection (can be nullptr, i.e. not connected)
+ * \param[in] idx    Index of the thread
+ * \param[in] block  Block to insert
+ */
+void
+Inserter::insert(std::unique_ptr<clickhouse::Client> &client, size_t idx,
+    const clickhouse::Block &block)
+{
+    const size_t rows = block.GetRowCount();
+    unsigned int stop_attempts = 0;
+
+    while (true) {
+        try {
+            if (!client) {
+                client.reset(new clickhouse::Client(m_opts[idx]));
+            }
+
+            client->Insert(m_table, block);
+            m_rows_ok += rows;
+            return;
+        } catch (std::exception &ex) {
+            // The connection is probably broken, create a new one
+            client.reset();
+            IPX_CTX_WARNING(m_ctx, "Thread %zu: Failed to insert a block of %zu rows: %s",
+                idx, rows, ex.what());
+        }
+
+        bool stop;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stop = m_stop;
+        }
+
+        if (stop && ++stop_attempts >= RETRY_STOP_MAX) {
+            IPX_CTX_ERROR(m_ctx, "Thread %zu: A block of %zu rows has been dropped!", idx, rows);
+            m_rows_lost += rows;
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY));
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Inserter.hpp
+ * \author agent <agent@local>
+ * \brief Pool of parallel insert connections (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CLICKHOUSE_INSERTER_H
+#define CLICKHOUSE_INSERTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <clickhouse/client.h>
+#include <ipfixcol2.h>
+#include "Config.hpp"
+
+/**
+ * \brief Pool of parallel insert connections
+ *
+ * Filled blocks are passed to a bounded queue and inserted by a group of threads, each of them
+ * with its own connection to a ClickHouse server. If the queue is full (i.e. the database is
+ * not able to keep up), the caller is blocked until a block is taken by a thread. Therefore,
+ * the backpressure is propagated to the rest of the collector pipeline instead of buffering
+ * an unlimited amount of data.
+ *
+ * If an insert fails (e.g. the server is not available), the connection is reestablished and
+ * the insert is retried.
+ */
+class Inserter {
+public:
+    /**
+     * \brief Create a pool and start its threads
+     * \param[in] ctx Instance context (only for logs!)
+     * \param[in] cfg Configuration of the instance
+     */
+    Inserter(ipx_ctx_t *ctx, const Config &cfg);
+    /**
+     * \brief Insert all remaining blocks and stop all threads
+     */
+    ~Inserter();
+
+    // Disable copy constructors
+    Inserter(const Inserter &) = delete;
+    Inserter &operator=(const Inserter &) = delete;
+
+    /**
+     * \brief Pass a block to the queue of blocks to insert
+     *
+     * If the queue is full, the function blocks until there is space for the block.
+     * \param[in] block Block of rows
+     */
+    void
+    push(clickhouse::Block &&block);
+
+private:
+    /** Instance context (only for logs)                                    */
+    ipx_ctx_t *m_ctx;
+    /** Name of the destination table                                       */
+    std::string m_table;
+    /** Connection options (one per thread)                                 */
+    std::vector<clickhouse::ClientOptions> m_opts;
+
+    /** Mutex of the queue                                                  */
+    std::mutex m_mutex;
+    /** Signalization of a new block in the queue                           */
+    std::condition_variable m_cv_ready;
+    /** Signalization of free space in the queue                            */
+    std::condition_variable m_cv_free;
+    /** Blocks waiting for insertion                                        */
+    std::deque<clickhouse::Block> m_queue;
+    /** Maximum number of blocks in the queue                               */
+    size_t m_capacity;
+    /** Stop request                                                        */
+    bool m_stop = false;
+
+    /** Number of inserted rows                                             */
+    std::atomic<uint64_t> m_rows_ok{0};
+    /** Number of dropped rows                                              */
+    std::atomic<uint64_t> m_rows_lost{0};
+    /** Threads                                                             */
+    std::vector<std::thread> m_threads;
+
+    void
+    thread_main(size_t idx);
+    void
+    insert(std::unique_ptr<clickhouse::Client> &client, size_t idx,
+        const clickhouse::Block &block);
+};
+
+#endif // CLICKHOUSE_INSERTER_H
@@ -0,0 +1,186 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Table.cpp
+ * \author agent <agent@local>
+ * \brief Builder of blocks of rows (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdexcept>
+#include "Table.hpp"
+
+/**
+ * \brief Get the current monotonic time (in seconds)
+ */
+static inline time_t
+time_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ts.tv_sec;
+}
+
+Table::Table(ipx_ctx_t *ctx, const Config &cfg, const fds_iemgr_t *iemgr, Inserter &inserter)
+    : m_inserter(inserter), m_block_rows(cfg.block_rows), m_flush_interval(cfg.flush_interval)
+{
+    for (const auto &def : cfg.columns) {
+        const struct fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, def.source.c_str());
+        if (!elem) {
+            throw std::invalid_argument("Unknown Information Element '" + def.source
+                + "' (column '" + def.name + "')!");
+        }
+
+        m_columns.push_back(Column::create(def.name, elem));
+        IPX_CTX_DEBUG(ctx, "Column '%s' (%s) <- '%s'", def.name.c_str(),
+            m_columns.back()->type(), def.source.c_str());
+    }
+
+    m_pos.resize(m_columns.size(), nullptr);
+    m_flush_last = time_now();
+}
+
+/**
+ * \brief Precompute positions of source fields in a template
+ *
+ * Only the first occurrence of each Information Element is used.
+ * \param[in] tmplt Template
+ */
+void
+Table::positions_prepare(const struct fds_template *tmplt)
+{
+    m_pos_tmplt = tmplt;
+
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        const Column &col = *m_columns[i];
+        m_pos[i] = nullptr;
+
+        for (uint16_t f = 0; f < tmplt->fields_cnt_total; ++f) {
+            const struct fds_tfield *field = &tmplt->fields[f];
+            if (field->id == col.id() && field->en == col.pen()) {
+                m_pos[i] = field;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * \brief Append a record to the current block
+ *
+ * If the offset and the size of a field are known, the field is accessed directly. Otherwise
+ * the field must be found (i.e. a variable-length field is placed before the field).
+ * \param[in] rec Data Record
+ */
+void
+Table::row_append(struct fds_drec *rec)
+{
+    struct fds_drec_field field;
+
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        Column &col = *m_columns[i];
+        const struct fds_tfield *tfield = m_pos[i];
+
+        if (!tfield) {
+            col.append(nullptr);
+            continue;
+        }
+
+        if (tfield->offset != FDS_IPFIX_VAR_IE_LEN && tfield->length != FDS_IPFIX_VAR_IE_LEN) {
+            field.data = rec->data + tfield->offset;
+            field.size = tfield->length;
+            field.info = tfield;
+            col.append(&field);
+            continue;
+        }
+
+        if (fds_drec_find(rec, col.pen(), col.id(), &field) == FDS_EOC) {
+            col.append(nullptr);
+        } else {
+            col.append(&field);
+        }
+    }
+
+    ++m_rows;
+}
+
+void
+Table::process(ipx_msg_ipfix_t *msg)
+{
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *ipfix_rec = ipx_msg_ipfix_get_drec(msg, i);
+        const struct fds_template *tmplt = ipfix_rec->rec.tmplt;
+        if (tmplt->type != FDS_TYPE_TEMPLATE) {
+            // Ignore records described by Options Templates
+            continue;
+        }
+
+        if (tmplt != m_pos_tmplt) {
+            positions_prepare(tmplt);
+        }
+
+        row_append(&ipfix_rec->rec);
+        if (m_rows >= m_block_rows) {
+            flush();
+        }
+    }
+
+    // Positions are valid only within the message (templates can be freed later)
+    m_pos_tmplt = nullptr;
+
+    if (m_flush_interval != 0 && m_rows != 0
+            && time_now() - m_flush_last >= m_flush_interval) {
+        flush();
+    }
+}
+
+void
+Table::flush()
+{
+    m_flush_last = time_now();
+    if (m_rows == 0) {
+        return;
+    }
+
+    clickhouse::Block block;
+    for (auto &col : m_columns) {
+        block.AppendColumn(col->name(), col->take(m_block_rows));
+    }
+
+    m_rows = 0;
+    m_inserter.push(std::move(block));
+}
@@ -0,0 +1,113 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/Table.hpp
+ * \author agent <agent@local>
+ * \brief Builder of blocks of rows (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CLICKHOUSE_TABLE_H
+#define CLICKHOUSE_TABLE_H
+
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include "Column.hpp"
+#include "Config.hpp"
+#include "Inserter.hpp"
+
+/**
+ * \brief Builder of blocks of rows
+ *
+ * Flow records are converted directly to columns of the current block. When the block is full
+ * (or the flush interval expires), the block is passed to the inserter.
+ */
+class Table {
+public:
+    /**
+     * \brief Create a builder
+     * \param[in] ctx      Instance context (only for logs!)
+     * \param[in] cfg      Configuration of the instance
+     * \param[in] iemgr    Manager of Information Elements
+     * \param[in] inserter Inserter of filled blocks
+     * \throw invalid_argument if a source Information Element is unknown or not supported
+     */
+    Table(ipx_ctx_t *ctx, const Config &cfg, const fds_iemgr_t *iemgr, Inserter &inserter);
+    ~Table() = default;
+
+    /**
+     * \brief Append all flow records of an IPFIX Message
+     *
+     * Records described by Options Templates are ignored.
+     * \param[in] msg IPFIX Message
+     */
+    void
+    process(ipx_msg_ipfix_t *msg);
+
+    /**
+     * \brief Pass the current (partially filled) block to the inserter
+     */
+    void
+    flush();
+
+private:
+    /** Inserter of filled blocks                                           */
+    Inserter &m_inserter;
+    /** Columns of the current block                                        */
+    std::vector<std::unique_ptr<Column>> m_columns;
+    /** Number of rows in the current block                                 */
+    size_t m_rows = 0;
+    /** Maximum number of rows of a block                                   */
+    size_t m_block_rows;
+    /** Flush interval (0 == disabled)                                      */
+    time_t m_flush_interval;
+    /** Time of the last flush (monotonic)                                  */
+    time_t m_flush_last;
+
+    /** Template of the precomputed positions                               */
+    const struct fds_template *m_pos_tmplt = nullptr;
+    /** Precomputed positions of source fields (nullptr == missing)         */
+    std::vector<const struct fds_tfield *> m_pos;
+
+    void
+    positions_prepare(const struct fds_template *tmplt);
+    void
+    row_append(struct fds_drec *rec);
+};
+
+#endif // CLICKHOUSE_TABLE_H
@@ -0,0 +1,132 @@
+/**
+ * \file extra_plugins/output/clickhouse/src/clickhouse.cpp
+ * \author agent <agent@local>
+ * \brief ClickHouse output plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <memory>
+#include <ipfixcol2.h>
+
+#include "Config.hpp"
+#include "Inserter.hpp"
+#include "Table.hpp"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "clickhouse",
+    // Brief description of plugin
+    "Bulk insert of flow records into ClickHouse database",
+    // Plugin type
+    IPX_PT_OUTPUT,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.1.0"
+};
+
+/** Instance data                                                                               */
+struct Instance {
+    /** Parsed configuration                                                                    */
+    std::unique_ptr<Config> config;
+    /** Pool of insert connections                                                              */
+    std::unique_ptr<Inserter> inserter;
+    /** Builder of blocks                                                                       */
+    std::unique_ptr<Table> table;
+};
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct Instance *data = nullptr;
+    try {
+        std::unique_ptr<Instance> ptr(new Instance);
+        ptr->config.reset(new Config(params));
+        ptr->inserter.reset(new Inserter(ctx, *ptr->config));
+        ptr->table.reset(new Table(ctx, *ptr->config, ipx_ctx_iemgr_get(ctx), *ptr->inserter));
+        data = ptr.release();
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "%s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unexpected exception has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    struct Instance *data = reinterpret_cast<struct Instance *>(cfg);
+
+    try {
+        // Insert the last (partially filled) block and wait for all inserts
+        data->table->flush();
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "%s", ex.what());
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unexpected exception has occurred!", '\0');
+    }
+
+    data->table.reset();
+    data->inserter.reset();
+    delete data;
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct Instance *data = reinterpret_cast<struct Instance *>(cfg);
+
+    try {
+        data->table->process(ipx_msg_base2ipfix(msg));
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "%s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unexpected exception has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
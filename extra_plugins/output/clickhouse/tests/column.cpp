@@ -0,0 +1,327 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+
+#include <Column.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Definitions of Information Elements and encoded field values */
+class Columns : public ::testing::Test {
+protected:
+    struct fds_iemgr_scope scope_iana;
+    struct fds_iemgr_scope scope_cesnet;
+    struct fds_iemgr_elem elem;
+    std::vector<std::vector<uint8_t>> values;
+
+    void SetUp() override {
+        memset(&scope_iana, 0, sizeof(scope_iana));
+        scope_iana.pen = 0;
+        scope_iana.name = const_cast<char *>("iana");
+        scope_iana.biflow_mode = FDS_BF_PEN;
+        scope_iana.biflow_id = 29305;
+
+        memset(&scope_cesnet, 0, sizeof(scope_cesnet));
+        scope_cesnet.pen = 8057;
+        scope_cesnet.name = const_cast<char *>("cesnet");
+        scope_cesnet.biflow_mode = FDS_BF_INDIVIDUAL;
+
+        memset(&elem, 0, sizeof(elem));
+        elem.id = 100;
+        elem.name = const_cast<char *>("testElement");
+        elem.scope = &scope_iana;
+    }
+
+    /** Create a column for an element of the given type */
+    std::unique_ptr<Column> create(enum fds_iemgr_element_type type) {
+        elem.data_type = type;
+        return Column::create("col", &elem);
+    }
+
+    /** Prepare a field with the given content (valid until the end of the test) */
+    struct fds_drec_field field(const std::vector<uint8_t> &data) {
+        values.push_back(data);
+        struct fds_drec_field ret;
+        ret.data = values.back().data();
+        ret.size = static_cast<uint16_t>(values.back().size());
+        ret.info = nullptr;
+        return ret;
+    }
+
+    /** Append a field with the given content */
+    void append(Column &col, const std::vector<uint8_t> &data) {
+        struct fds_drec_field fld = field(data);
+        col.append(&fld);
+    }
+
+    /** Take a filled column and cast it to the expected ClickHouse type */
+    template <typename CT>
+    std::shared_ptr<CT> take(Column &col, size_t rows) {
+        clickhouse::ColumnRef ref = col.take(16);
+        EXPECT_EQ(ref->Size(), rows);
+        std::shared_ptr<CT> ret = ref->As<CT>();
+        EXPECT_NE(ret, nullptr);
+        return ret;
+    }
+};
+
+// Data types of Information Elements are mapped to ClickHouse types
+TEST_F(Columns, typeMapping)
+{
+    const std::vector<std::pair<enum fds_iemgr_element_type, std::string>> types = {
+        {FDS_ET_UNSIGNED_8, "UInt8"}, {FDS_ET_UNSIGNED_16, "UInt16"},
+        {FDS_ET_UNSIGNED_32, "UInt32"}, {FDS_ET_UNSIGNED_64, "UInt64"},
+        {FDS_ET_SIGNED_8, "Int8"}, {FDS_ET_SIGNED_16, "Int16"},
+        {FDS_ET_SIGNED_32, "Int32"}, {FDS_ET_SIGNED_64, "Int64"},
+        {FDS_ET_FLOAT_32, "Float32"}, {FDS_ET_FLOAT_64, "Float64"},
+        {FDS_ET_BOOLEAN, "UInt8"}, {FDS_ET_MAC_ADDRESS, "FixedString(6)"},
+        {FDS_ET_STRING, "String"}, {FDS_ET_OCTET_ARRAY, "String"},
+        {FDS_ET_IPV4_ADDRESS, "IPv4"}, {FDS_ET_IPV6_ADDRESS, "IPv6"},
+        {FDS_ET_DATE_TIME_SECONDS, "DateTime"},
+        {FDS_ET_DATE_TIME_MILLISECONDS, "DateTime64(3)"},
+        {FDS_ET_DATE_TIME_MICROSECONDS, "DateTime64(6)"},
+        {FDS_ET_DATE_TIME_NANOSECONDS, "DateTime64(9)"}
+    };
+
+    for (const auto &pair : types) {
+        SCOPED_TRACE("type: " + pair.second);
+        std::unique_ptr<Column> col = create(pair.first);
+        ASSERT_NE(col, nullptr);
+        EXPECT_EQ(col->name(), "col");
+        EXPECT_EQ(std::string(col->type()), pair.second);
+        EXPECT_EQ(col->pen(), 0U);
+        EXPECT_EQ(col->id(), 100U);
+    }
+}
+
+// Structured data types are not supported
+TEST_F(Columns, typeUnsupported)
+{
+    EXPECT_THROW(create(FDS_ET_BASIC_LIST), std::invalid_argument);
+    EXPECT_THROW(create(FDS_ET_SUB_TEMPLATE_LIST), std::invalid_argument);
+    EXPECT_THROW(create(FDS_ET_SUB_TEMPLATE_MULTILIST), std::invalid_argument);
+    EXPECT_THROW(create(FDS_ET_UNASSIGNED), std::invalid_argument);
+}
+
+// Reverse elements of scopes with the "pen" biflow mode use the reverse Enterprise Number
+TEST_F(Columns, reversePen)
+{
+    elem.is_reverse = true;
+    EXPECT_EQ(create(FDS_ET_UNSIGNED_64)->pen(), 29305U);
+
+    elem.scope = &scope_cesnet;
+    EXPECT_EQ(create(FDS_ET_UNSIGNED_64)->pen(), 8057U);
+
+    elem.is_reverse = false;
+    elem.scope = &scope_iana;
+    EXPECT_EQ(create(FDS_ET_UNSIGNED_64)->pen(), 0U);
+}
+
+// Unsigned integers with native and reduced-size encoding
+TEST_F(Columns, unsignedValues)
+{
+    std::unique_ptr<Column> col = create(FDS_ET_UNSIGNED_32);
+    append(*col, {0x01, 0x02, 0x03, 0x04});
+    append(*col, {0x12, 0x34});
+    append(*col, {0xFF});
+    append(*col, {0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00}); // Saturated
+    append(*col, {0x00, 0x00, 0x00, 0x00, 0xAB, 0xCD, 0xEF, 0x01});
+    col->append(nullptr);
+
+    auto res = take<clickhouse::ColumnUInt32>(*col, 6);
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->At(0), 0x01020304U);
+    EXPECT_EQ(res->At(1), 0x1234U);
+    EXPECT_EQ(res->At(2), 0xFFU);
+    EXPECT_EQ(res->At(3), std::numeric_limits<uint32_t>::max());
+    EXPECT_EQ(res->At(4), 0xABCDEF01U);
+    EXPECT_EQ(res->At(5), 0U);
+
+    std::unique_ptr<Column> col64 = create(FDS_ET_UNSIGNED_64);
+    append(*col64, {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08});
+    append(*col64, {0x01, 0x02, 0x03, 0x04});
+    auto res64 = take<clickhouse::ColumnUInt64>(*col64, 2);
+    ASSERT_NE(res64, nullptr);
+    EXPECT_EQ(res64->At(0), 0x0102030405060708ULL);
+    EXPECT_EQ(res64->At(1), 0x01020304ULL);
+}
+
+// Signed integers with native and reduced-size encoding
+TEST_F(Columns, signedValues)
+{
+    std::unique_ptr<Column> col = create(FDS_ET_SIGNED_16);
+    append(*col, {0xFF, 0xFE});
+    append(*col, {0x80});
+    append(*col, {0x00, 0x00, 0x80, 0x00});                         // Saturated (max)
+    append(*col, {0xFF, 0xFF, 0x7F, 0xFF});                         // Saturated (min)
+    append(*col, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x85});
+    col->append(nullptr);
+
+    auto res = take<clickhouse::ColumnInt16>(*col, 6);
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->At(0), -2);
+    EXPECT_EQ(res->At(1), -128);
+    EXPECT_EQ(res->At(2), std::numeric_limits<int16_t>::max());
+    EXPECT_EQ(res->At(3), std::numeric_limits<int16_t>::min());
+    EXPECT_EQ(res->At(4), -123);
+    EXPECT_EQ(res->At(5), 0);
+}
+
+// Floating point numbers and booleans (invalid values are replaced with defaults)
+TEST_F(Columns, floatAndBool)
+{
+    std::unique_ptr<Column> col_float = create(FDS_ET_FLOAT_64);
+    append(*col_float, {0x40, 0x09, 0x21, 0xFB, 0x54, 0x44, 0x2D, 0x18}); // PI
+    append(*col_float, {0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}); // -2.0
+    col_float->append(nullptr);
+
+    auto res_float = take<clickhouse::ColumnFloat64>(*col_float, 3);
+    ASSERT_NE(res_float, nullptr);
+    EXPECT_DOUBLE_EQ(res_float->At(0), 3.141592653589793);
+    EXPECT_DOUBLE_EQ(res_float->At(1), -2.0);
+    EXPECT_DOUBLE_EQ(res_float->At(2), 0.0);
+
+    std::unique_ptr<Column> col_bool = create(FDS_ET_BOOLEAN);
+    append(*col_bool, {0x01});    // True
+    append(*col_bool, {0x02});    // False
+    append(*col_bool, {0x03});    // Invalid
+    col_bool->append(nullptr);
+
+    auto res_bool = take<clickhouse::ColumnUInt8>(*col_bool, 4);
+    ASSERT_NE(res_bool, nullptr);
+    EXPECT_EQ(res_bool->At(0), 1U);
+    EXPECT_EQ(res_bool->At(1), 0U);
+    EXPECT_EQ(res_bool->At(2), 0U);
+    EXPECT_EQ(res_bool->At(3), 0U);
+}
+
+// Strings, octet arrays and MAC addresses
+TEST_F(Columns, stringValues)
+{
+    std::unique_ptr<Column> col_str = create(FDS_ET_STRING);
+    append(*col_str, {'a', 'b', 'c'});
+    append(*col_str, {});
+    append(*col_str, {'x', 0x00, 'y'});
+    col_str->append(nullptr);
+
+    auto res_str = take<clickhouse::ColumnString>(*col_str, 4);
+    ASSERT_NE(res_str, nullptr);
+    EXPECT_EQ(res_str->At(0), "abc");
+    EXPECT_EQ(res_str->At(1), "");
+    EXPECT_EQ(res_str->At(2), std::string("x\0y", 3));
+    EXPECT_EQ(res_str->At(3), "");
+
+    std::unique_ptr<Column> col_mac = create(FDS_ET_MAC_ADDRESS);
+    append(*col_mac, {0x00, 0x11, 0x22, 0x33, 0x44, 0x55});
+    append(*col_mac, {0x00, 0x11, 0x22});                        // Invalid size
+    col_mac->append(nullptr);
+
+    auto res_mac = take<clickhouse::ColumnFixedString>(*col_mac, 3);
+    ASSERT_NE(res_mac, nullptr);
+    EXPECT_EQ(res_mac->At(0), std::string("\x00\x11\x22\x33\x44\x55", 6));
+    EXPECT_EQ(res_mac->At(1), std::string(6, '\0'));
+    EXPECT_EQ(res_mac->At(2), std::string(6, '\0'));
+}
+
+// IPv4 and IPv6 addresses
+TEST_F(Columns, addressValues)
+{
+    std::unique_ptr<Column> col_ip4 = create(FDS_ET_IPV4_ADDRESS);
+    append(*col_ip4, {192, 168, 0, 1});
+    append(*col_ip4, {192, 168});                                 // Invalid size
+    col_ip4->append(nullptr);
+
+    auto res_ip4 = take<clickhouse::ColumnIPv4>(*col_ip4, 3);
+    ASSERT_NE(res_ip4, nullptr);
+    EXPECT_EQ(res_ip4->At(0).s_addr, inet_addr("192.168.0.1"));
+    EXPECT_EQ(res_ip4->At(1).s_addr, 0U);
+    EXPECT_EQ(res_ip4->At(2).s_addr, 0U);
+
+    std::unique_ptr<Column> col_ip6 = create(FDS_ET_IPV6_ADDRESS);
+    std::vector<uint8_t> addr(16, 0);
+    addr[0] = 0x20; addr[1] = 0x01; addr[2] = 0x0D; addr[3] = 0xB8; addr[15] = 0x01;
+    append(*col_ip6, addr);
+    append(*col_ip6, {192, 168, 0, 1});                           // Invalid size
+    col_ip6->append(nullptr);
+
+    auto res_ip6 = take<clickhouse::ColumnIPv6>(*col_ip6, 3);
+    ASSERT_NE(res_ip6, nullptr);
+    const struct in6_addr any = IN6ADDR_ANY_INIT;
+    struct in6_addr value = res_ip6->At(0);
+    EXPECT_EQ(memcmp(&value, addr.data(), sizeof(value)), 0);
+    value = res_ip6->At(1);
+    EXPECT_EQ(memcmp(&value, &any, sizeof(value)), 0);
+    value = res_ip6->At(2);
+    EXPECT_EQ(memcmp(&value, &any, sizeof(value)), 0);
+}
+
+// Timestamps of all precisions (micro and nanoseconds are encoded in the NTP format)
+TEST_F(Columns, timeValues)
+{
+    // 2017-07-14 02:40:00 UTC
+    const int64_t sec = 1500000000;
+    // The same time + 0.5 second in the NTP format (seconds since 1900)
+    const std::vector<uint8_t> ntp = {0xDD, 0x12, 0xAD, 0x80, 0x80, 0x00, 0x00, 0x00};
+
+    std::unique_ptr<Column> col_sec = create(FDS_ET_DATE_TIME_SECONDS);
+    append(*col_sec, {0x59, 0x68, 0x2F, 0x00});
+    col_sec->append(nullptr);
+    auto res_sec = take<clickhouse::ColumnDateTime>(*col_sec, 2);
+    ASSERT_NE(res_sec, nullptr);
+    EXPECT_EQ(res_sec->At(0), sec);
+    EXPECT_EQ(res_sec->At(1), 0);
+
+    std::unique_ptr<Column> col_ms = create(FDS_ET_DATE_TIME_MILLISECONDS);
+    append(*col_ms, {0x00, 0x00, 0x01, 0x5D, 0x3E, 0xF7, 0x99, 0xF4});
+    col_ms->append(nullptr);
+    auto res_ms = take<clickhouse::ColumnDateTime64>(*col_ms, 2);
+    ASSERT_NE(res_ms, nullptr);
+    EXPECT_EQ(res_ms->At(0), sec * 1000 + 500);
+    EXPECT_EQ(res_ms->At(1), 0);
+
+    std::unique_ptr<Column> col_us = create(FDS_ET_DATE_TIME_MICROSECONDS);
+    append(*col_us, ntp);
+    auto res_us = take<clickhouse::ColumnDateTime64>(*col_us, 1);
+    ASSERT_NE(res_us, nullptr);
+    EXPECT_EQ(res_us->At(0), sec * 1000000 + 500000);
+
+    std::unique_ptr<Column> col_ns = create(FDS_ET_DATE_TIME_NANOSECONDS);
+    append(*col_ns, ntp);
+    col_ns->append(nullptr);
+    auto res_ns = take<clickhouse::ColumnDateTime64>(*col_ns, 2);
+    ASSERT_NE(res_ns, nullptr);
+    EXPECT_EQ(res_ns->At(0), sec * 1000000000 + 500000000);
+    EXPECT_EQ(res_ns->At(1), 0);
+}
+
+// Taking a filled column starts a new empty one of the same type
+TEST_F(Columns, take)
+{
+    std::unique_ptr<Column> col = create(FDS_ET_UNSIGNED_16);
+    append(*col, {0x00, 0x01});
+    append(*col, {0x00, 0x02});
+
+    auto first = take<clickhouse::ColumnUInt16>(*col, 2);
+    auto empty = take<clickhouse::ColumnUInt16>(*col, 0);
+    append(*col, {0x00, 0x03});
+    auto second = take<clickhouse::ColumnUInt16>(*col, 1);
+
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(first->At(0), 1U);
+    EXPECT_EQ(first->At(1), 2U);
+    EXPECT_EQ(second->At(0), 3U);
+    EXPECT_EQ(empty->Size(), 0U);
+}
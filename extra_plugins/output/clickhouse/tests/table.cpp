@@ -0,0 +1,467 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+
+#include <Config.hpp>
+#include <Inserter.hpp>
+#include <Table.hpp>
+
+/** IPFIX Message (only a list of parsed Data Records) */
+struct ipx_msg_ipfix {
+    std::vector<struct ipx_ipfix_record *> recs;
+};
+
+// The plugin is a module, functions provided by the collector must be defined here
+extern "C" {
+    enum ipx_verb_level
+    ipx_ctx_verb_get(const ipx_ctx_t *ctx)
+    {
+        (void) ctx;
+        return IPX_VERB_NONE;
+    }
+
+    void
+    ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *fmt, ...)
+    {
+        (void) level;
+        (void) ctx;
+        (void) fmt;
+    }
+
+    uint32_t
+    ipx_msg_ipfix_get_drec_cnt(const ipx_msg_ipfix_t *msg)
+    {
+        return static_cast<uint32_t>(msg->recs.size());
+    }
+
+    struct ipx_ipfix_record *
+    ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx)
+    {
+        return (idx < msg->recs.size()) ? msg->recs[idx] : nullptr;
+    }
+}
+
+/** Blocks passed to the inserter */
+static std::vector<clickhouse::Block> blocks;
+
+// The inserter is replaced by a double that only keeps pushed blocks (no connections)
+Inserter::Inserter(ipx_ctx_t *ctx, const Config &cfg)
+    : m_ctx(ctx), m_table(cfg.table), m_capacity(cfg.block_queue) {}
+
+Inserter::~Inserter() {}
+
+void
+Inserter::push(clickhouse::Block &&block)
+{
+    blocks.push_back(std::move(block));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Create a configuration with the given content of the \<params\> node */
+static std::string
+params(const std::string &content)
+{
+    return "<params>" + content + "</params>";
+}
+
+/** Connection, table and columns used by most of the tests */
+static const std::string CFG_BASE =
+    "<connection><host>localhost</host></connection>"
+    "<table>flows</table>"
+    "<columns>"
+    "  <column><name>src</name><source>iana:sourceIPv4Address</source></column>"
+    "  <column><name>bytes</name><source>iana:octetDeltaCount</source></column>"
+    "  <column><name>packets</name><source>iana:packetDeltaCount</source></column>"
+    "  <column><name>app</name><source>iana:applicationName</source></column>"
+    "  <column><name>start</name><source>iana:flowStartMilliseconds</source></column>"
+    "</columns>";
+
+// Parse a configuration with all parameters
+TEST(Config, full)
+{
+    const std::string cfg = params(
+        "<connection>"
+        "  <host>ch1.example.org</host>"
+        "  <host>ch2.example.org</host>"
+        "  <port>9440</port>"
+        "  <user>ipfix</user>"
+        "  <password>secret</password>"
+        "  <database>netflow</database>"
+        "  <compression>none</compression>"
+        "</connection>"
+        "<table>flows</table>"
+        "<columns>"
+        "  <column><name>src</name><source>iana:sourceIPv4Address</source></column>"
+        "  <column><name>bytes</name><source>iana:octetDeltaCount</source></column>"
+        "</columns>"
+        "<blockSize>500</blockSize>"
+        "<blockQueue>8</blockQueue>"
+        "<inserterThreads>2</inserterThreads>"
+        "<flushInterval>0</flushInterval>");
+
+    Config config(cfg.c_str());
+    ASSERT_EQ(config.conn.hosts.size(), 2U);
+    EXPECT_EQ(config.conn.hosts[0], "ch1.example.org");
+    EXPECT_EQ(config.conn.hosts[1], "ch2.example.org");
+    EXPECT_EQ(config.conn.port, 9440);
+    EXPECT_EQ(config.conn.user, "ipfix");
+    EXPECT_EQ(config.conn.password, "secret");
+    EXPECT_EQ(config.conn.database, "netflow");
+    EXPECT_FALSE(config.conn.lz4);
+    EXPECT_EQ(config.table, "flows");
+    ASSERT_EQ(config.columns.size(), 2U);
+    EXPECT_EQ(config.columns[0].name, "src");
+    EXPECT_EQ(config.columns[0].source, "iana:sourceIPv4Address");
+    EXPECT_EQ(config.columns[1].name, "bytes");
+    EXPECT_EQ(config.columns[1].source, "iana:octetDeltaCount");
+    EXPECT_EQ(config.block_rows, 500U);
+    EXPECT_EQ(config.block_queue, 8U);
+    EXPECT_EQ(config.inserters, 2U);
+    EXPECT_EQ(config.flush_interval, 0U);
+}
+
+// Optional parameters are replaced with default values
+TEST(Config, defaults)
+{
+    const std::string cfg = params(CFG_BASE);
+
+    Config config(cfg.c_str());
+    ASSERT_EQ(config.conn.hosts.size(), 1U);
+    EXPECT_EQ(config.conn.hosts[0], "localhost");
+    EXPECT_EQ(config.conn.port, 9000);
+    EXPECT_EQ(config.conn.user, "default");
+    EXPECT_EQ(config.conn.password, "");
+    EXPECT_EQ(config.conn.database, "default");
+    EXPECT_TRUE(config.conn.lz4);
+    EXPECT_EQ(config.columns.size(), 5U);
+    EXPECT_EQ(config.block_rows, 100000U);
+    EXPECT_EQ(config.block_queue, 16U);
+    EXPECT_EQ(config.inserters, 4U);
+    EXPECT_EQ(config.flush_interval, 10U);
+}
+
+// Invalid configurations are refused
+TEST(Config, invalid)
+{
+    const std::string col = "<column><name>a</name><source>iana:octetDeltaCount</source></column>";
+    const std::string conn = "<connection><host>localhost</host></connection>";
+    const std::vector<std::string> invalid = {
+        // Missing or empty host
+        "<connection></connection><table>t</table><columns>" + col + "</columns>",
+        "<connection><host></host></connection><table>t</table><columns>" + col + "</columns>",
+        // Invalid port and compression
+        "<connection><host>h</host><port>0</port></connection><table>t</table>"
+            "<columns>" + col + "</columns>",
+        "<connection><host>h</host><port>65536</port></connection><table>t</table>"
+            "<columns>" + col + "</columns>",
+        "<connection><host>h</host><compression>zstd</compression></connection>"
+            "<table>t</table><columns>" + col + "</columns>",
+        // Missing table name and columns
+        conn + "<table></table><columns>" + col + "</columns>",
+        conn + "<table>t</table><columns></columns>",
+        // Invalid columns
+        conn + "<table>t</table><columns>" + col + col + "</columns>",
+        conn + "<table>t</table><columns><column><name></name>"
+            "<source>iana:octetDeltaCount</source></column></columns>",
+        conn + "<table>t</table><columns><column><name>a</name><source></source>"
+            "</column></columns>",
+        // Zero sizes
+        conn + "<table>t</table><columns>" + col + "</columns><blockSize>0</blockSize>",
+        conn + "<table>t</table><columns>" + col + "</columns><blockQueue>0</blockQueue>",
+        conn + "<table>t</table><columns>" + col + "</columns><inserterThreads>0"
+            "</inserterThreads>",
+        // Unknown element
+        conn + "<table>t</table><columns>" + col + "</columns><unknown>1</unknown>"
+    };
+
+    for (const auto &content : invalid) {
+        SCOPED_TRACE("params: " + content);
+        const std::string cfg = params(content);
+        EXPECT_THROW(Config config(cfg.c_str()), std::runtime_error);
+    }
+}
+
+/** Append a value in network byte order */
+static void
+put(std::vector<uint8_t> &buffer, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * (size - i - 1))));
+    }
+}
+
+/** Append an IPv4 address */
+static void
+put_ip4(std::vector<uint8_t> &buffer, const char *addr)
+{
+    put(buffer, ntohl(inet_addr(addr)), 4);
+}
+
+/** Append a variable-length string */
+static void
+put_str(std::vector<uint8_t> &buffer, const std::string &str)
+{
+    put(buffer, str.size(), 1);
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+/** Manager of Information Elements, parsed Templates and Data Records */
+class Tables : public ::testing::Test {
+protected:
+    /** Template with fixed-length fields only */
+    static const uint16_t TID_FIXED = 256;
+    /** Template with a variable-length field placed before fixed-length fields */
+    static const uint16_t TID_VAR = 257;
+    /** Options Template */
+    static const uint16_t TID_OPTS = 258;
+
+    std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)> iemgr {nullptr, &fds_iemgr_destroy};
+    std::vector<std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>> tmplts;
+    std::vector<std::unique_ptr<struct ipx_msg_ipfix>> msgs;
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<struct ipx_ipfix_record *> recs;
+
+    void SetUp() override {
+        blocks.clear();
+        iemgr.reset(fds_iemgr_create());
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr.get(), fds_api_cfg_dir()), FDS_OK);
+
+        // sourceIPv4Address (4B), octetDeltaCount (4B), packetDeltaCount (8B), flowStart (8B)
+        std::vector<uint8_t> fixed;
+        put(fixed, TID_FIXED, 2); put(fixed, 4, 2);
+        put(fixed, 8, 2);   put(fixed, 4, 2);
+        put(fixed, 1, 2);   put(fixed, 4, 2);
+        put(fixed, 2, 2);   put(fixed, 8, 2);
+        put(fixed, 152, 2); put(fixed, 8, 2);
+        tmplt_add(FDS_TYPE_TEMPLATE, fixed);
+
+        // applicationName (var), octetDeltaCount (8B), sourceIPv4Address (4B)
+        std::vector<uint8_t> var;
+        put(var, TID_VAR, 2); put(var, 3, 2);
+        put(var, 96, 2); put(var, 65535, 2);
+        put(var, 1, 2);  put(var, 8, 2);
+        put(var, 8, 2);  put(var, 4, 2);
+        tmplt_add(FDS_TYPE_TEMPLATE, var);
+
+        // Scope: sourceIPv4Address (4B), octetDeltaCount (8B)
+        std::vector<uint8_t> opts;
+        put(opts, TID_OPTS, 2); put(opts, 2, 2); put(opts, 1, 2);
+        put(opts, 8, 2); put(opts, 4, 2);
+        put(opts, 1, 2); put(opts, 8, 2);
+        tmplt_add(FDS_TYPE_TEMPLATE_OPTS, opts);
+    }
+
+    void TearDown() override {
+        for (auto rec : recs) {
+            free(rec);
+        }
+    }
+
+    /** Parse a Template */
+    void tmplt_add(enum fds_template_type type, const std::vector<uint8_t> &raw) {
+        struct fds_template *tmplt;
+        uint16_t len = static_cast<uint16_t>(raw.size());
+        ASSERT_EQ(fds_template_parse(type, raw.data(), &len, &tmplt), FDS_OK);
+        tmplts.emplace_back(tmplt, &fds_template_destroy);
+    }
+
+    /** Find a parsed Template */
+    const struct fds_template *tmplt(uint16_t id) {
+        for (const auto &ptr : tmplts) {
+            if (ptr->id == id) {
+                return ptr.get();
+            }
+        }
+        return nullptr;
+    }
+
+    /** Create a new (empty) message */
+    ipx_msg_ipfix_t *msg_new() {
+        msgs.emplace_back(new struct ipx_msg_ipfix);
+        return msgs.back().get();
+    }
+
+    /** Append a Data Record to a message */
+    void rec_add(ipx_msg_ipfix_t *msg, uint16_t tid, const std::vector<uint8_t> &content) {
+        data.push_back(content);
+        auto rec = static_cast<struct ipx_ipfix_record *>(calloc(1, sizeof(ipx_ipfix_record)));
+        ASSERT_NE(rec, nullptr);
+        recs.push_back(rec);
+
+        rec->rec.data = data.back().data();
+        rec->rec.size = static_cast<uint16_t>(data.back().size());
+        rec->rec.tmplt = tmplt(tid);
+        rec->rec.snap = nullptr;
+        ASSERT_NE(rec->rec.tmplt, nullptr);
+        msg->recs.push_back(rec);
+    }
+
+    /** Append a record with fixed-length fields */
+    void rec_fixed(ipx_msg_ipfix_t *msg, const char *src, uint32_t bytes, uint64_t pkts,
+            uint64_t start) {
+        std::vector<uint8_t> content;
+        put_ip4(content, src);
+        put(content, bytes, 4);
+        put(content, pkts, 8);
+        put(content, start, 8);
+        rec_add(msg, TID_FIXED, content);
+    }
+
+    /** Append a record with a variable-length field */
+    void rec_var(ipx_msg_ipfix_t *msg, const std::string &app, uint64_t bytes, const char *src) {
+        std::vector<uint8_t> content;
+        put_str(content, app);
+        put(content, bytes, 8);
+        put_ip4(content, src);
+        rec_add(msg, TID_VAR, content);
+    }
+
+    /** Create a configuration with the given block size and flush interval */
+    static Config config(size_t block_rows, unsigned int flush) {
+        const std::string cfg = params(CFG_BASE
+            + "<blockSize>" + std::to_string(block_rows) + "</blockSize>"
+            + "<flushInterval>" + std::to_string(flush) + "</flushInterval>");
+        return Config(cfg.c_str());
+    }
+};
+
+/** Check values of a row of a block */
+static void
+row_check(const clickhouse::Block &block, size_t row, const char *src, uint64_t bytes,
+    uint64_t pkts, const std::string &app, int64_t start)
+{
+    SCOPED_TRACE("row: " + std::to_string(row));
+    ASSERT_EQ(block.GetColumnCount(), 5U);
+    EXPECT_EQ(block[0]->As<clickhouse::ColumnIPv4>()->At(row).s_addr, inet_addr(src));
+    EXPECT_EQ(block[1]->As<clickhouse::ColumnUInt64>()->At(row), bytes);
+    EXPECT_EQ(block[2]->As<clickhouse::ColumnUInt64>()->At(row), pkts);
+    EXPECT_EQ(block[3]->As<clickhouse::ColumnString>()->At(row), app);
+    EXPECT_EQ(block[4]->As<clickhouse::ColumnDateTime64>()->At(row), start);
+}
+
+// Unknown and unsupported Information Elements are refused
+TEST_F(Tables, invalidSource)
+{
+    Config cfg = config(10, 0);
+    Inserter inserter(nullptr, cfg);
+
+    cfg.columns.push_back({"unknown", "iana:thisElementDoesNotExist"});
+    EXPECT_THROW(Table(nullptr, cfg, iemgr.get(), inserter), std::invalid_argument);
+
+    cfg.columns.back() = {"list", "iana:subTemplateList"};
+    EXPECT_THROW(Table(nullptr, cfg, iemgr.get(), inserter), std::invalid_argument);
+}
+
+// Records of different Templates are converted to rows in the original order
+TEST_F(Tables, records)
+{
+    Config cfg = config(10, 0);
+    Inserter inserter(nullptr, cfg);
+    Table table(nullptr, cfg, iemgr.get(), inserter);
+
+    ipx_msg_ipfix_t *msg1 = msg_new();
+    rec_fixed(msg1, "10.0.0.1", 1000, 10, 1500000000500ULL);
+    rec_var(msg1, "http", 5000, "10.0.0.2");
+    std::vector<uint8_t> opts;
+    put_ip4(opts, "10.0.0.9");
+    put(opts, 1, 8);
+    rec_add(msg1, TID_OPTS, opts); // Ignored
+    rec_var(msg1, "", 6000, "10.0.0.3");
+    table.process(msg1);
+
+    ipx_msg_ipfix_t *msg2 = msg_new();
+    rec_var(msg2, "dns", 7000, "10.0.0.4");
+    rec_fixed(msg2, "10.0.0.5", 0xFFFFFFFF, 20, 1500000001000ULL);
+    table.process(msg2);
+
+    EXPECT_TRUE(blocks.empty());
+    table.flush();
+    ASSERT_EQ(blocks.size(), 1U);
+
+    const clickhouse::Block &block = blocks[0];
+    ASSERT_EQ(block.GetRowCount(), 5U);
+    ASSERT_EQ(block.GetColumnCount(), 5U);
+    EXPECT_EQ(block.GetColumnName(0), "src");
+    EXPECT_EQ(block.GetColumnName(1), "bytes");
+    EXPECT_EQ(block.GetColumnName(2), "packets");
+    EXPECT_EQ(block.GetColumnName(3), "app");
+    EXPECT_EQ(block.GetColumnName(4), "start");
+
+    // Missing fields are replaced with default values
+    row_check(block, 0, "10.0.0.1", 1000, 10, "", 1500000000500LL);
+    row_check(block, 1, "10.0.0.2", 5000, 0, "http", 0);
+    row_check(block, 2, "10.0.0.3", 6000, 0, "", 0);
+    row_check(block, 3, "10.0.0.4", 7000, 0, "dns", 0);
+    row_check(block, 4, "10.0.0.5", 0xFFFFFFFF, 20, "", 1500000001000LL);
+
+    // Nothing to insert
+    table.flush();
+    EXPECT_EQ(blocks.size(), 1U);
+}
+
+// Filled blocks are passed to the inserter immediately
+TEST_F(Tables, blockSize)
+{
+    Config cfg = config(2, 0);
+    Inserter inserter(nullptr, cfg);
+    Table table(nullptr, cfg, iemgr.get(), inserter);
+
+    ipx_msg_ipfix_t *msg = msg_new();
+    for (unsigned int i = 0; i < 5; ++i) {
+        rec_fixed(msg, "10.0.0.1", i, i, i);
+    }
+
+    table.process(msg);
+    ASSERT_EQ(blocks.size(), 2U);
+    table.flush();
+    ASSERT_EQ(blocks.size(), 3U);
+
+    uint64_t value = 0;
+    const std::vector<size_t> rows = {2, 2, 1};
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ASSERT_EQ(blocks[i].GetRowCount(), rows[i]);
+        for (size_t row = 0; row < rows[i]; ++row, ++value) {
+            row_check(blocks[i], row, "10.0.0.1", value, value, "", value);
+        }
+    }
+}
+
+// Partially filled blocks are inserted after the flush interval
+TEST_F(Tables, flushInterval)
+{
+    Config cfg = config(100, 1);
+    Inserter inserter(nullptr, cfg);
+    Table table(nullptr, cfg, iemgr.get(), inserter);
+
+    ipx_msg_ipfix_t *msg = msg_new();
+    rec_var(msg, "ssh", 100, "10.0.0.1");
+    table.process(msg);
+    EXPECT_TRUE(blocks.empty());
+
+    // Even an empty message triggers the flush
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    table.process(msg_new());
+    ASSERT_EQ(blocks.size(), 1U);
+    ASSERT_EQ(blocks[0].GetRowCount(), 1U);
+    row_check(blocks[0], 0, "10.0.0.1", 100, 0, "ssh", 0);
+
+    // An empty block is never inserted
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    table.process(msg_new());
+    EXPECT_EQ(blocks.size(), 1U);
+}
@@ -58,6 +58,9 @@
 #define BF_DEFAULT_ITEM_CNT_EST 100000
 
 #define WINDOW_SIZE             300U
+#define PROFILES_WRITERS        2U
+#define PROFILES_QUEUE          1024U
+#define PROFILES_WRITERS_MAX    64U
 
 /*
  * <params>
@@ -75,6 +78,11 @@
  *    <estimatedItemCount>...</estimatedItemCount>
  *    <falsePositiveProbability>...</falsePositiveProbability>
  *  </index>
+ *  <profiles>                                     <!-- optional -->
+ *    <treeFile>...</treeFile>
+ *    <writerThreads>...</writerThreads>           <!-- optional -->
+ *    <queueSize>...</queueSize>                   <!-- optional -->
+ *  </profiles>
  * </params>
  */
 
@@ -85,6 +93,7 @@ enum params_xml_nodes {
     NODE_COMPRESS,
     NODE_DUMP,
     NODE_IDX,
+    NODE_PROFILES,
 
     DUMP_WINDOW,
     DUMP_ALIGN,
@@ -92,7 +101,11 @@ enum params_xml_nodes {
     IDX_ENABLE,
     IDX_AUTOSIZE,
     IDX_COUNT,
-    IDX_PROB
+    IDX_PROB,
+
+    PROFILES_TREE,
+    PROFILES_WRITERS_CNT,
+    PROFILES_QUEUE_SIZE
 };
 
 
@@ -112,14 +125,23 @@ static const struct fds_xml_args args_idx[] = {
     FDS_OPTS_END
 };
 
+/** Definition of the \<profiles\> node  */
+static const struct fds_xml_args args_profiles[] = {
+    FDS_OPTS_ELEM(PROFILES_TREE,        "treeFile",      FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(PROFILES_WRITERS_CNT, "writerThreads", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PROFILES_QUEUE_SIZE,  "queueSize",     FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 /** Definition of the \<params\> node  */
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
-    FDS_OPTS_ELEM(NODE_STORAGE,  "storagePath",        FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_STORAGE,  "storagePath",        FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_ID_FIELD, "identificatorField", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_COMPRESS, "compress",           FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_DUMP,   "dumpInterval",       args_dump,         FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(NODE_IDX,    "index",              args_idx,          FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_PROFILES, "profiles",         args_profiles,     FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -180,6 +202,23 @@ configuration_validate(ipx_ctx_t *ctx, const struct conf_params *cfg)
         ret_code = IPX_ERR_FORMAT;
     }
 
+    if (cfg->profiles.en) {
+        if (!cfg->profiles.tree) {
+            IPX_CTX_ERROR(ctx, "Profile tree file is not set.", '\0');
+            ret_code = IPX_ERR_FORMAT;
+        }
+
+        if (cfg->profiles.writers > 0 && cfg->profiles.queue == 0) {
+            IPX_CTX_ERROR(ctx, "Queue size of writer threads must be greater than 0.", '\0');
+            ret_code = IPX_ERR_FORMAT;
+        }
+
+        if (cfg->files.path) {
+            IPX_CTX_WARNING(ctx, "Profiles are enabled, therefore, <storagePath> is ignored.",
+                '\0');
+        }
+    }
+
     return ret_code;
 }
 
@@ -195,6 +234,8 @@ configuration_set_defaults(ipx_ctx_t *ctx, struct conf_params *cnf)
 {
     cnf->ctx = ctx;
     cnf->profiles.en = false; // Disabled by default
+    cnf->profiles.writers = PROFILES_WRITERS;
+    cnf->profiles.queue = PROFILES_QUEUE;
 
     // Dump interval
     cnf->window.align = true;
@@ -302,6 +343,57 @@ configuration_parse_idx(ipx_ctx_t *ctx, fds_xml_ctx_t *idx, struct conf_params *
     return IPX_OK;
 }
 
+/**
+ * \brief Auxiliary function for parsing <profiles> options
+ * \param[in] ctx      Instance context (just for log)
+ * \param[in] profiles XML context to process
+ * \param[in] cnf      Configuration
+ * \return On success returns #IPX_OK. Otherwise returns #IPX_ERR_DENIED.
+ */
+static int
+configuration_parse_profiles(ipx_ctx_t *ctx, fds_xml_ctx_t *profiles, struct conf_params *cnf)
+{
+    cnf->profiles.en = true;
+
+    const struct fds_xml_cont *content;
+    while(fds_xml_next(profiles, &content) != FDS_EOC) {
+        switch (content->id) {
+        case PROFILES_TREE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            free(cnf->profiles.tree);
+            cnf->profiles.tree = strdup(content->ptr_string);
+            if (!cnf->profiles.tree) {
+                IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_DENIED;
+            }
+            break;
+        case PROFILES_WRITERS_CNT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > PROFILES_WRITERS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of writer threads must be at most %u!",
+                    PROFILES_WRITERS_MAX);
+                return IPX_ERR_DENIED;
+            }
+
+            cnf->profiles.writers = (uint32_t) content->val_uint;
+            break;
+        case PROFILES_QUEUE_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Queue size is too big!", '\0');
+                return IPX_ERR_DENIED;
+            }
+
+            cnf->profiles.queue = (uint32_t) content->val_uint;
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
 /**
  * \brief Auxiliary function for parsing <params> options
  * \param[in] ctx  Instance context (just for log)
@@ -346,6 +438,12 @@ configuration_parse_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct conf_params
                 return IPX_ERR_DENIED;
             }
             break;
+        case NODE_PROFILES:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            if (configuration_parse_profiles(ctx, content->ptr_ctx, cnf) != IPX_OK) {
+                return IPX_ERR_DENIED;
+            }
+            break;
         default:
             // Internal error
             assert(false);
@@ -440,5 +538,7 @@ configuration_free(struct conf_params *config)
         free(config->file_index.prefix);
     }
 
+    free(config->profiles.tree);
+
     free(config);
 }
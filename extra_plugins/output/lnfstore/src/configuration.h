@@ -90,6 +90,11 @@ struct conf_params {
         bool en;          /**< Enable/disable files generation based on
                             * profiles. When it is enabled, files.path is
                             * ignored                                        */
+        char *tree;       /**< Path to the profile tree file (can be NULL
+                            *  only when profiles.en == false)               */
+        uint32_t writers; /**< Number of writer threads (0 == records are
+                            *  written by the instance thread)              */
+        uint32_t queue;   /**< Capacity of a queue of each writer thread     */
     } profiles; /**< Profiles configuration                                  */
 };
 
@@ -99,18 +99,19 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
     }
 
     // Init basic/profile file storage
-    //if (conf->params->profiles.en) {
-    //    conf->storage.profiles = stg_profiles_create(parsed_params);
-    //} else {
+    if (conf->params->profiles.en) {
+        conf->storage.profiles = stg_profiles_create(ctx, parsed_params);
+    } else {
         conf->storage.basic = stg_basic_create(ctx, parsed_params);
-    //}
+    }
 
-    if (!conf->storage.basic/* && !conf->storage.profiles*/) {
+    if (!conf->storage.basic && !conf->storage.profiles) {
         IPX_CTX_ERROR(ctx, "Failed to initialize an internal structure for file storage(s).", '\0');
         translator_destroy(conf->record.translator);
         lnf_rec_free(conf->record.rec_ptr);
         configuration_free(parsed_params);
         free(conf);
+        return IPX_ERR_DENIED;
     }
 
     // Save the configuration
@@ -118,6 +119,21 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params) {
     return IPX_OK;
 }
 
+/**
+ * \brief Store a LNF record into the active storage
+ * \param[in] conf    Plugin instance
+ * \param[in] lnf_rec LNF record
+ */
+static inline void
+lnfstore_store(struct conf_lnfstore *conf, lnf_rec_t *lnf_rec)
+{
+    if (conf->params->profiles.en) {
+        stg_profiles_store(conf->storage.profiles, lnf_rec);
+    } else {
+        stg_basic_store(conf->storage.basic, lnf_rec);
+    }
+}
+
 // Pass IPFIX data with supplemental structures into the storage plugin.
 int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
@@ -139,7 +155,11 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         conf->window_start = new_time;
 
         // Update storage files
-        stg_basic_new_window(conf->storage.basic, new_time);
+        if (conf->params->profiles.en) {
+            stg_profiles_new_window(conf->storage.profiles, new_time);
+        } else {
+            stg_basic_new_window(conf->storage.basic, new_time);
+        }
     }
 
     ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
@@ -157,7 +177,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
             continue;
         }
 
-        stg_basic_store(conf->storage.basic, lnf_rec);
+        lnfstore_store(conf, lnf_rec);
 
         // Is it biflow? Store the reverse direction
         if (!biflow) {
@@ -170,7 +190,7 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
             continue;
         }
 
-        stg_basic_store(conf->storage.basic, lnf_rec);
+        lnfstore_store(conf, lnf_rec);
     }
 
     return 0;
@@ -184,11 +204,11 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     struct conf_lnfstore *conf = (struct conf_lnfstore *) cfg;
 
     // Destroy mode resources
-    //if (conf->params->profiles.en) {
-    //    stg_profiles_destroy(conf->storage.profiles);
-    //} else {
+    if (conf->params->profiles.en) {
+        stg_profiles_destroy(conf->storage.profiles);
+    } else {
         stg_basic_destroy(conf->storage.basic);
-    //}
+    }
 
     // Destroy a translator and a record
     translator_destroy(conf->record.translator);
@@ -48,6 +48,7 @@
 
 #include "configuration.h"
 #include "storage_basic.h"
+#include "storage_profiles.h"
 #include "translator.h"
 
 extern const char *msg_module;
@@ -64,7 +65,7 @@ struct conf_lnfstore {
 
     struct {
         stg_basic_t    *basic;    /**< Store all samples                     */
-        //stg_profiles_t *profiles; /**< Store records based on profiles     */
+        stg_profiles_t *profiles; /**< Store records based on profiles       */
     } storage; /**< Only one type of storage is initialized at the same time */
 
     struct {
@@ -0,0 +1,732 @@
+/**
+ * \file profile_tree.c
+ * \author agent <agent@local>
+ * \brief Profile tree (source file)
+ */
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+* 3. Neither the name of the Company nor the names of its contributors
+*    may be used to endorse or promote products derived from this
+*    software without specific prior written permission.
+*
+* ALTERNATIVELY, provided that this notice is retained in full, this
+* product may be distributed under the terms of the GNU General Public
+* License (GPL) version 2 or later, in which case the provisions
+* of the GPL apply INSTEAD OF those given above.
+*
+* This software is provided ``as is, and any express or implied
+* warranties, including, but not limited to, the implied warranties of
+* merchantability and fitness for a particular purpose are disclaimed.
+* In no event shall the company or contributors be liable for any
+* direct, indirect, incidental, special, exemplary, or consequential
+* damages (including, but not limited to, procurement of substitute
+* goods or services; loss of use, data, or profits; or business
+* interruption) however caused and on any theory of liability, whether
+* in contract, strict liability, or tort (including negligence or
+* otherwise) arising in any way out of the use of this software, even
+* if advised of the possibility of such damage.
+*/
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libfds.h>
+
+#include "profile_tree.h"
+#include "utils.h"
+
+/*
+ * <profiles>
+ *  <profile>                                      <!-- multiple -->
+ *    <name>...</name>
+ *    <parent>...</parent>                         <!-- optional -->
+ *    <directory>...</directory>
+ *    <channel>                                    <!-- multiple -->
+ *      <name>...</name>
+ *      <source>...</source>                       <!-- optional, multiple -->
+ *      <filter>...</filter>                       <!-- optional -->
+ *    </channel>
+ *  </profile>
+ * </profiles>
+ */
+
+/** XML nodes */
+enum tree_xml_nodes {
+    NODE_PROFILE = 1,
+
+    PROFILE_NAME,
+    PROFILE_PARENT,
+    PROFILE_DIR,
+    PROFILE_CHANNEL,
+
+    CHANNEL_NAME,
+    CHANNEL_SOURCE,
+    CHANNEL_FILTER
+};
+
+/** Definition of the \<channel\> node  */
+static const struct fds_xml_args args_channel[] = {
+    FDS_OPTS_ELEM(CHANNEL_NAME,   "name",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(CHANNEL_SOURCE, "source", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(CHANNEL_FILTER, "filter", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<profile\> node  */
+static const struct fds_xml_args args_profile[] = {
+    FDS_OPTS_ELEM(PROFILE_NAME,      "name",      FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(PROFILE_PARENT,    "parent",    FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PROFILE_DIR,       "directory", FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_NESTED(PROFILE_CHANNEL, "channel",   args_channel,      FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<profiles\> node  */
+static const struct fds_xml_args args_tree[] = {
+    FDS_OPTS_ROOT("profiles"),
+    FDS_OPTS_NESTED(NODE_PROFILE, "profile", args_profile, FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/** Channel description (as parsed from the file) */
+struct raw_channel {
+    const char *name;       /**< Name of the channel               */
+    const char *filter;     /**< Filter expression (can be NULL)   */
+    const char **sources;   /**< Names of source channels          */
+    size_t sources_cnt;     /**< Number of source channels         */
+};
+
+/** Profile description (as parsed from the file) */
+struct raw_profile {
+    const char *name;       /**< Name of the profile               */
+    const char *parent;     /**< Name of the parent (can be NULL)  */
+    const char *dir;        /**< Storage directory                 */
+    struct raw_channel *channels; /**< Channels                    */
+    size_t channels_cnt;    /**< Number of channels                */
+
+    size_t first_ch;        /**< Index of the first channel in the final tree */
+    bool   placed;          /**< Already placed into the final tree           */
+};
+
+/** Parsed file (all strings point to the XML parser) */
+struct raw_tree {
+    struct raw_profile *profiles; /**< Profiles           */
+    size_t profiles_cnt;          /**< Number of profiles */
+};
+
+/**
+ * \brief Append an item to a dynamic array
+ * \param[in,out] array Pointer to the array
+ * \param[in,out] cnt   Number of items in the array (will be increased)
+ * \param[in]     size  Size of one item
+ * \return Pointer to the new (zeroed) item or NULL (memory allocation error)
+ */
+static void *
+tree_array_append(void **array, size_t *cnt, size_t size)
+{
+    void *new_array = realloc(*array, (*cnt + 1) * size);
+    if (!new_array) {
+        return NULL;
+    }
+
+    *array = new_array;
+    uint8_t *item = ((uint8_t *) new_array) + (*cnt * size);
+    memset(item, 0, size);
+    (*cnt)++;
+    return item;
+}
+
+/**
+ * \brief Free a parsed file
+ * \param[in] raw Parsed file
+ */
+static void
+tree_raw_free(struct raw_tree *raw)
+{
+    for (size_t i = 0; i < raw->profiles_cnt; ++i) {
+        struct raw_profile *profile = &raw->profiles[i];
+        for (size_t j = 0; j < profile->channels_cnt; ++j) {
+            free(profile->channels[j].sources);
+        }
+        free(profile->channels);
+    }
+
+    free(raw->profiles);
+}
+
+/**
+ * \brief Auxiliary function for parsing <channel> node
+ * \param[in] ctx     Instance context (just for log)
+ * \param[in] xml     XML context to process
+ * \param[in] profile Profile where the channel belongs
+ * \return On success returns #IPX_OK. Otherwise returns #IPX_ERR_NOMEM.
+ */
+static int
+tree_parse_channel(ipx_ctx_t *ctx, fds_xml_ctx_t *xml, struct raw_profile *profile)
+{
+    struct raw_channel *channel = tree_array_append((void **) &profile->channels,
+        &profile->channels_cnt, sizeof(*channel));
+    if (!channel) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(xml, &content) != FDS_EOC) {
+        assert(content->type == FDS_OPTS_T_STRING);
+        switch (content->id) {
+        case CHANNEL_NAME:
+            channel->name = content->ptr_string;
+            break;
+        case CHANNEL_FILTER:
+            channel->filter = content->ptr_string;
+            break;
+        case CHANNEL_SOURCE: {
+            const char **src = tree_array_append((void **) &channel->sources,
+                &channel->sources_cnt, sizeof(*src));
+            if (!src) {
+                IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_NOMEM;
+            }
+            *src = content->ptr_string;
+            }
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Auxiliary function for parsing <profile> node
+ * \param[in] ctx Instance context (just for log)
+ * \param[in] xml XML context to process
+ * \param[in] raw Parsed file
+ * \return On success returns #IPX_OK. Otherwise returns #IPX_ERR_NOMEM.
+ */
+static int
+tree_parse_profile(ipx_ctx_t *ctx, fds_xml_ctx_t *xml, struct raw_tree *raw)
+{
+    struct raw_profile *profile = tree_array_append((void **) &raw->profiles,
+        &raw->profiles_cnt, sizeof(*profile));
+    if (!profile) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(xml, &content) != FDS_EOC) {
+        switch (content->id) {
+        case PROFILE_NAME:
+            assert(content->type == FDS_OPTS_T_STRING);
+            profile->name = content->ptr_string;
+            break;
+        case PROFILE_PARENT:
+            assert(content->type == FDS_OPTS_T_STRING);
+            profile->parent = content->ptr_string;
+            break;
+        case PROFILE_DIR:
+            assert(content->type == FDS_OPTS_T_STRING);
+            profile->dir = content->ptr_string;
+            break;
+        case PROFILE_CHANNEL:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            if (tree_parse_channel(ctx, content->ptr_ctx, profile) != IPX_OK) {
+                return IPX_ERR_NOMEM;
+            }
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Load content of a file into a NULL terminated string
+ * \param[in] ctx  Instance context (just for log)
+ * \param[in] file Path to the file
+ * \return Pointer to the content (must be freed by user) or NULL on failure
+ */
+static char *
+tree_file_read(ipx_ctx_t *ctx, const char *file)
+{
+    const char *err_str;
+    FILE *stream = fopen(file, "r");
+    if (!stream) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to open the profile tree file '%s': %s", file, err_str);
+        return NULL;
+    }
+
+    char *buffer = NULL;
+    long size;
+    if (fseek(stream, 0, SEEK_END) != 0 || (size = ftell(stream)) < 0
+            || fseek(stream, 0, SEEK_SET) != 0) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to get size of the profile tree file '%s': %s", file, err_str);
+        fclose(stream);
+        return NULL;
+    }
+
+    buffer = malloc((size_t) size + 1U);
+    if (!buffer) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        fclose(stream);
+        return NULL;
+    }
+
+    if (fread(buffer, 1, (size_t) size, stream) != (size_t) size) {
+        IPX_CTX_ERROR(ctx, "Failed to read the profile tree file '%s'.", file);
+        free(buffer);
+        fclose(stream);
+        return NULL;
+    }
+
+    buffer[size] = '\0';
+    fclose(stream);
+    return buffer;
+}
+
+/**
+ * \brief Find a profile by name
+ * \return Pointer or NULL (not found)
+ */
+static struct raw_profile *
+tree_raw_profile_find(struct raw_tree *raw, const char *name)
+{
+    for (size_t i = 0; i < raw->profiles_cnt; ++i) {
+        if (strcmp(raw->profiles[i].name, name) == 0) {
+            return &raw->profiles[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Find a channel of a profile by name
+ * \return Index of the channel within the profile or -1 (not found)
+ */
+static long
+tree_raw_channel_find(const struct raw_profile *profile, const char *name)
+{
+    for (size_t i = 0; i < profile->channels_cnt; ++i) {
+        if (strcmp(profile->channels[i].name, name) == 0) {
+            return (long) i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * \brief Check that names of profiles and channels are unique
+ * \return #IPX_OK or #IPX_ERR_FORMAT
+ */
+static int
+tree_raw_check_names(ipx_ctx_t *ctx, struct raw_tree *raw)
+{
+    for (size_t i = 0; i < raw->profiles_cnt; ++i) {
+        const struct raw_profile *profile = &raw->profiles[i];
+        if (tree_raw_profile_find(raw, profile->name) != profile) {
+            IPX_CTX_ERROR(ctx, "Profile '%s' is defined multiple times.", profile->name);
+            return IPX_ERR_FORMAT;
+        }
+
+        for (size_t j = 0; j < profile->channels_cnt; ++j) {
+            const char *name = profile->channels[j].name;
+            if (tree_raw_channel_find(profile, name) != (long) j) {
+                IPX_CTX_ERROR(ctx, "Channel '%s' of the profile '%s' is defined multiple times.",
+                    name, profile->name);
+                return IPX_ERR_FORMAT;
+            }
+
+            if (strchr(name, '/') != NULL) {
+                IPX_CTX_ERROR(ctx, "Name of the channel '%s' (profile '%s') must not contain '/'.",
+                    name, profile->name);
+                return IPX_ERR_FORMAT;
+            }
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Get a (shared) filter with a given expression
+ *
+ * If the filter doesn't exist yet, it is compiled and added to the tree. Leading and trailing
+ * white spaces are ignored and an empty expression or "*" matches all records.
+ * \param[in]  ctx  Instance context (just for log)
+ * \param[in]  tree Profile tree
+ * \param[in]  expr Filter expression (can be NULL)
+ * \param[out] idx  Index of the filter
+ * \return #IPX_OK, #IPX_ERR_FORMAT (invalid expression) or #IPX_ERR_NOMEM
+ */
+static int
+tree_filter_get(ipx_ctx_t *ctx, struct profile_tree *tree, const char *expr, size_t *idx)
+{
+    char *norm = NULL;
+    if (expr) {
+        while (isspace((unsigned char) *expr)) {
+            expr++;
+        }
+
+        size_t len = strlen(expr);
+        while (len > 0 && isspace((unsigned char) expr[len - 1])) {
+            len--;
+        }
+
+        if (len > 0 && !(len == 1 && expr[0] == '*')) {
+            norm = strndup(expr, len);
+            if (!norm) {
+                IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_NOMEM;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < tree->filters_cnt; ++i) {
+        const char *other = tree->filters[i].expr;
+        if ((!norm && !other) || (norm && other && strcmp(norm, other) == 0)) {
+            free(norm);
+            *idx = i;
+            return IPX_OK;
+        }
+    }
+
+    lnf_filter_t *filter = NULL;
+    if (norm && lnf_filter_init_v2(&filter, norm) != LNF_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to compile the filter expression '%s'.", norm);
+        free(norm);
+        return IPX_ERR_FORMAT;
+    }
+
+    struct pt_filter *rec = tree_array_append((void **) &tree->filters, &tree->filters_cnt,
+        sizeof(*rec));
+    if (!rec) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        if (filter) {
+            lnf_filter_free(filter);
+        }
+        free(norm);
+        return IPX_ERR_NOMEM;
+    }
+
+    rec->expr = norm;
+    rec->filter = filter;
+    *idx = tree->filters_cnt - 1;
+    return IPX_OK;
+}
+
+/**
+ * \brief Add all channels of a profile to the tree
+ * \param[in] ctx     Instance context (just for log)
+ * \param[in] tree    Profile tree
+ * \param[in] raw     Parsed file
+ * \param[in] profile Profile to add (parent profile MUST be already added)
+ * \return #IPX_OK, #IPX_ERR_FORMAT or #IPX_ERR_NOMEM
+ */
+static int
+tree_profile_add(ipx_ctx_t *ctx, struct profile_tree *tree, struct raw_tree *raw,
+    struct raw_profile *profile)
+{
+    struct raw_profile *parent = NULL;
+    if (profile->parent) {
+        parent = tree_raw_profile_find(raw, profile->parent);
+        assert(parent != NULL && parent->placed);
+    }
+
+    char *dir = utils_path_preprocessor(profile->dir);
+    if (!dir) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Failed to process the directory of the profile '%s': %s",
+            profile->name, err_str);
+        return IPX_ERR_FORMAT;
+    }
+
+    int rc = IPX_OK;
+    profile->first_ch = tree->channels_cnt;
+    for (size_t i = 0; i < profile->channels_cnt && rc == IPX_OK; ++i) {
+        const struct raw_channel *raw_ch = &profile->channels[i];
+        struct pt_channel *channel = tree_array_append((void **) &tree->channels,
+            &tree->channels_cnt, sizeof(*channel));
+        if (!channel) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+
+        channel->name = strdup(raw_ch->name);
+        channel->profile = strdup(profile->name);
+        channel->path = malloc(strlen(dir) + strlen(raw_ch->name) + 3U);
+        if (!channel->name || !channel->profile || !channel->path) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+        sprintf(channel->path, "%s/%s/", dir, raw_ch->name);
+
+        // Sources
+        if (!parent) {
+            if (raw_ch->sources_cnt != 0) {
+                IPX_CTX_ERROR(ctx, "Channel '%s' of the root profile '%s' cannot have any "
+                    "sources.", raw_ch->name, profile->name);
+                rc = IPX_ERR_FORMAT;
+                break;
+            }
+        } else {
+            // No sources == all channels of the parent profile
+            size_t src_cnt = (raw_ch->sources_cnt != 0)
+                ? raw_ch->sources_cnt : parent->channels_cnt;
+            if (src_cnt == 0) {
+                IPX_CTX_WARNING(ctx, "Channel '%s' of the profile '%s' has no sources (the parent "
+                    "profile doesn't have any channels). No records will be stored.",
+                    raw_ch->name, profile->name);
+                channel->sources_cnt = SIZE_MAX; // Never matches (sources == NULL)
+                rc = tree_filter_get(ctx, tree, raw_ch->filter, &channel->filter_idx);
+                continue;
+            }
+
+            channel->sources = calloc(src_cnt, sizeof(*channel->sources));
+            if (!channel->sources) {
+                IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+                rc = IPX_ERR_NOMEM;
+                break;
+            }
+
+            for (size_t j = 0; j < src_cnt; ++j) {
+                long src_idx = (long) j;
+                if (raw_ch->sources_cnt != 0) {
+                    src_idx = tree_raw_channel_find(parent, raw_ch->sources[j]);
+                }
+
+                if (src_idx < 0) {
+                    IPX_CTX_ERROR(ctx, "Source channel '%s' of the channel '%s' (profile '%s') "
+                        "doesn't exist in the parent profile '%s'.", raw_ch->sources[j],
+                        raw_ch->name, profile->name, parent->name);
+                    rc = IPX_ERR_FORMAT;
+                    break;
+                }
+
+                channel->sources[j] = parent->first_ch + (size_t) src_idx;
+                channel->sources_cnt++;
+            }
+
+            if (rc != IPX_OK) {
+                break;
+            }
+        }
+
+        rc = tree_filter_get(ctx, tree, raw_ch->filter, &channel->filter_idx);
+    }
+
+    free(dir);
+    profile->placed = (rc == IPX_OK);
+    return rc;
+}
+
+/**
+ * \brief Build a profile tree from a parsed file
+ *
+ * Profiles are placed in topological order (i.e. parents are always placed before their
+ * children) so all channels can be evaluated in a single pass.
+ * \return #IPX_OK, #IPX_ERR_FORMAT or #IPX_ERR_NOMEM
+ */
+static int
+tree_build(ipx_ctx_t *ctx, struct profile_tree *tree, struct raw_tree *raw)
+{
+    int rc = tree_raw_check_names(ctx, raw);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    size_t placed = 0;
+    while (placed < raw->profiles_cnt) {
+        size_t placed_prev = placed;
+
+        for (size_t i = 0; i < raw->profiles_cnt; ++i) {
+            struct raw_profile *profile = &raw->profiles[i];
+            if (profile->placed) {
+                continue;
+            }
+
+            if (profile->parent) {
+                const struct raw_profile *parent = tree_raw_profile_find(raw, profile->parent);
+                if (!parent) {
+                    IPX_CTX_ERROR(ctx, "Parent profile '%s' of the profile '%s' doesn't exist.",
+                        profile->parent, profile->name);
+                    return IPX_ERR_FORMAT;
+                }
+
+                if (!parent->placed) {
+                    continue;
+                }
+            }
+
+            rc = tree_profile_add(ctx, tree, raw, profile);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+            placed++;
+        }
+
+        if (placed == placed_prev) {
+            const char *name = NULL;
+            for (size_t i = 0; i < raw->profiles_cnt && !name; ++i) {
+                name = raw->profiles[i].placed ? NULL : raw->profiles[i].name;
+            }
+            IPX_CTX_ERROR(ctx, "The profile tree contains a cycle (e.g. profile '%s').", name);
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    return IPX_OK;
+}
+
+struct profile_tree *
+profile_tree_load(ipx_ctx_t *ctx, const char *file)
+{
+    char *content = tree_file_read(ctx, file);
+    if (!content) {
+        return NULL;
+    }
+
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        free(content);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_tree) != FDS_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        free(content);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *xml_ctx = fds_xml_parse_mem(parser, content, true);
+    if (!xml_ctx) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the profile tree '%s': %s", file,
+            fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        free(content);
+        return NULL;
+    }
+
+    struct raw_tree raw;
+    memset(&raw, 0, sizeof(raw));
+    struct profile_tree *tree = calloc(1, sizeof(*tree));
+    int rc = (tree != NULL) ? IPX_OK : IPX_ERR_NOMEM;
+
+    const struct fds_xml_cont *cont;
+    while (rc == IPX_OK && fds_xml_next(xml_ctx, &cont) != FDS_EOC) {
+        assert(cont->id == NODE_PROFILE && cont->type == FDS_OPTS_T_CONTEXT);
+        rc = tree_parse_profile(ctx, cont->ptr_ctx, &raw);
+    }
+
+    if (rc == IPX_OK) {
+        rc = tree_build(ctx, tree, &raw);
+    }
+
+    if (rc == IPX_OK && tree->channels_cnt == 0) {
+        IPX_CTX_ERROR(ctx, "The profile tree '%s' doesn't contain any channels.", file);
+        rc = IPX_ERR_FORMAT;
+    }
+
+    tree_raw_free(&raw);
+    fds_xml_destroy(parser);
+    free(content);
+
+    if (rc != IPX_OK) {
+        if (rc == IPX_ERR_NOMEM && !tree) {
+            IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        }
+        profile_tree_destroy(tree);
+        return NULL;
+    }
+
+    IPX_CTX_INFO(ctx, "Profile tree loaded (%zu channels, %zu unique filters).",
+        tree->channels_cnt, tree->filters_cnt);
+    return tree;
+}
+
+void
+profile_tree_destroy(struct profile_tree *tree)
+{
+    if (!tree) {
+        return;
+    }
+
+    for (size_t i = 0; i < tree->channels_cnt; ++i) {
+        struct pt_channel *channel = &tree->channels[i];
+        free(channel->name);
+        free(channel->profile);
+        free(channel->path);
+        free(channel->sources);
+    }
+
+    for (size_t i = 0; i < tree->filters_cnt; ++i) {
+        struct pt_filter *filter = &tree->filters[i];
+        if (filter->filter) {
+            lnf_filter_free(filter->filter);
+        }
+        free(filter->expr);
+    }
+
+    free(tree->channels);
+    free(tree->filters);
+    free(tree);
+}
+
+size_t
+profile_tree_eval(struct profile_tree *tree, lnf_rec_t *rec, uint64_t rec_id, bool *matches)
+{
+    size_t match_cnt = 0;
+
+    for (size_t i = 0; i < tree->channels_cnt; ++i) {
+        const struct pt_channel *channel = &tree->channels[i];
+
+        // At least one source channel must match (sources are always evaluated before)
+        bool src_match = (channel->sources_cnt == 0);
+        for (size_t j = 0; !src_match && j < channel->sources_cnt && channel->sources; ++j) {
+            src_match = matches[channel->sources[j]];
+        }
+
+        if (!src_match) {
+            matches[i] = false;
+            continue;
+        }
+
+        struct pt_filter *filter = &tree->filters[channel->filter_idx];
+        if (filter->eval_id != rec_id) {
+            filter->result = (!filter->filter || lnf_filter_match(filter->filter, rec));
+            filter->eval_id = rec_id;
+        }
+
+        matches[i] = filter->result;
+        if (filter->result) {
+            match_cnt++;
+        }
+    }
+
+    return match_cnt;
+}
@@ -0,0 +1,120 @@
+/**
+ * \file profile_tree.h
+ * \author agent <agent@local>
+ * \brief Profile tree (header file)
+ */
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+* 3. Neither the name of the Company nor the names of its contributors
+*    may be used to endorse or promote products derived from this
+*    software without specific prior written permission.
+*
+* ALTERNATIVELY, provided that this notice is retained in full, this
+* product may be distributed under the terms of the GNU General Public
+* License (GPL) version 2 or later, in which case the provisions
+* of the GPL apply INSTEAD OF those given above.
+*
+* This software is provided ``as is, and any express or implied
+* warranties, including, but not limited to, the implied warranties of
+* merchantability and fitness for a particular purpose are disclaimed.
+* In no event shall the company or contributors be liable for any
+* direct, indirect, incidental, special, exemplary, or consequential
+* damages (including, but not limited to, procurement of substitute
+* goods or services; loss of use, data, or profits; or business
+* interruption) however caused and on any theory of liability, whether
+* in contract, strict liability, or tort (including negligence or
+* otherwise) arising in any way out of the use of this software, even
+* if advised of the possibility of such damage.
+*/
+
+#ifndef LS_PROFILE_TREE_H
+#define LS_PROFILE_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <libnf.h>
+#include <ipfixcol2.h>
+
+/**
+ * \brief Compiled filter expression
+ *
+ * Channels with the same (normalized) filter expression share the same filter, therefore,
+ * the expression is evaluated at most once per record. The result is cached until a new record
+ * (i.e. with different identification) is evaluated.
+ */
+struct pt_filter {
+    char *expr;             /**< Filter expression (NULL == match all)              */
+    lnf_filter_t *filter;   /**< Compiled filter (NULL == match all)                */
+    uint64_t eval_id;       /**< Identification of the last evaluated record        */
+    bool result;            /**< Result of the last evaluation                      */
+};
+
+/**
+ * \brief Channel of a profile
+ *
+ * Channels are stored in topological order i.e. all source channels of a channel are always
+ * placed before the channel itself.
+ */
+struct pt_channel {
+    char *name;             /**< Name of the channel                                */
+    char *profile;          /**< Name of the profile the channel belongs to         */
+    char *path;             /**< Storage directory ('profile_dir'/'channel_name')   */
+    size_t filter_idx;      /**< Index of the (shared) filter                       */
+    size_t *sources;        /**< Indexes of source channels in the parent profile   */
+    size_t sources_cnt;     /**< Number of source channels (0 == all records)       */
+};
+
+/** \brief Profile tree  */
+struct profile_tree {
+    struct pt_channel *channels;  /**< Channels (in topological order) */
+    size_t channels_cnt;          /**< Number of channels              */
+    struct pt_filter *filters;    /**< Unique filters                  */
+    size_t filters_cnt;           /**< Number of unique filters        */
+};
+
+/**
+ * \brief Load a profile tree from a file
+ *
+ * The file describes a list of profiles. Each profile (except the root ones) refers to its
+ * parent profile and each channel of the profile can receive records only from channels of
+ * the parent profile (i.e. sources). Filters of the channels are compiled and all filters with
+ * the same expression are merged.
+ * \param[in] ctx  Instance context (only for logs!)
+ * \param[in] file Path to the profile tree file
+ * \return On success returns a pointer to the tree. Otherwise returns NULL.
+ */
+struct profile_tree *
+profile_tree_load(ipx_ctx_t *ctx, const char *file);
+
+/**
+ * \brief Destroy a profile tree
+ * \param[in] tree Profile tree
+ */
+void
+profile_tree_destroy(struct profile_tree *tree);
+
+/**
+ * \brief Evaluate all channels of the tree on a record
+ *
+ * Each filter is evaluated at most once and only if it is required, i.e. filters of channels
+ * with non-matching sources are skipped.
+ * \param[in]  tree    Profile tree
+ * \param[in]  rec     LNF record to evaluate
+ * \param[in]  rec_id  Unique non-zero identification of the record (must differ for each call)
+ * \param[out] matches Array of results for all channels (at least tree->channels_cnt items)
+ * \return Number of matching channels
+ */
+size_t
+profile_tree_eval(struct profile_tree *tree, lnf_rec_t *rec, uint64_t rec_id, bool *matches);
+
+#endif // LS_PROFILE_TREE_H
@@ -0,0 +1,525 @@
+/**
+ * \file storage_profiles.c
+ * \author agent <agent@local>
+ * \brief Profile storage management (source file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lnfstore.h"
+#include "storage_profiles.h"
+#include "storage_common.h"
+#include "profile_tree.h"
+#include "utils.h"
+
+/** Type of a writer request */
+enum stg_item_type {
+    STG_ITEM_RECORD,   /**< Store a record into channels        */
+    STG_ITEM_WINDOW    /**< Create a new time window            */
+};
+
+/** Writer request */
+struct stg_item {
+    enum stg_item_type type; /**< Type of the request                              */
+    lnf_rec_t *rec;          /**< Copy of the record (only STG_ITEM_RECORD)         */
+    time_t window;           /**< Start of the window (only STG_ITEM_WINDOW)        */
+    size_t *channels;        /**< Indexes of destination channels                   */
+    size_t channels_cnt;     /**< Number of destination channels                    */
+};
+
+/** Channel runtime */
+struct stg_channel {
+    const struct pt_channel *desc; /**< Description of the channel (from the tree)  */
+    files_mgr_t *mgr;              /**< Output files                                */
+    size_t writer;                 /**< Index of the writer that owns the channel   */
+};
+
+/** Writer thread */
+struct stg_writer {
+    struct stg_profiles_s *stg;  /**< Parent storage                                 */
+    pthread_t thread;            /**< Thread of the writer                           */
+
+    pthread_mutex_t mutex;       /**< Queue mutex                                    */
+    pthread_cond_t cond_full;    /**< Queue is not full anymore                      */
+    pthread_cond_t cond_empty;   /**< Queue is not empty anymore                     */
+    struct stg_item *queue;      /**< Circular queue of requests                     */
+    size_t queue_size;           /**< Capacity of the queue                          */
+    size_t queue_head;           /**< Index of the first valid request               */
+    size_t queue_cnt;            /**< Number of valid requests                       */
+    bool stop;                   /**< Stop flag                                      */
+
+    size_t *channels;            /**< Indexes of owned channels                      */
+    size_t channels_cnt;         /**< Number of owned channels                       */
+};
+
+/** \brief Profile storage structure */
+struct stg_profiles_s {
+    /** Instance context (only for logs!)   */
+    ipx_ctx_t *ctx;
+    /** Pointer to the plugin configuration */
+    const struct conf_params *params;
+    /** Profile tree                        */
+    struct profile_tree *tree;
+
+    struct stg_channel *channels;  /**< Channels (the same order as in the tree)         */
+    bool *matches;                 /**< Result of evaluation of the last record          */
+    uint64_t rec_id;               /**< Identification of the last evaluated record      */
+
+    struct stg_writer *writers;    /**< Writer threads (can be NULL)                     */
+    size_t writers_cnt;            /**< Number of writers (0 == no threads)              */
+};
+
+/**
+ * \brief Create a new time window of a channel
+ *
+ * If the storage directory of the channel doesn't exist, the function will try to create it.
+ * \param[in] stg     Storage
+ * \param[in] channel Channel
+ * \param[in] window  Start of the window
+ * \return On success returns 0. Otherwise returns a non-zero value.
+ */
+static int
+stg_channel_new_window(struct stg_profiles_s *stg, struct stg_channel *channel, time_t window)
+{
+    const char *dir_path = channel->desc->path;
+    if (stg_common_dir_exists(dir_path) && utils_mkdir(dir_path) != IPX_OK) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        files_mgr_invalidate(channel->mgr);
+        IPX_CTX_ERROR(stg->ctx, "Failed to create a new time window of the channel '%s' "
+            "(profile '%s'). Records of the channel will be lost (failed to create the directory "
+            "'%s': %s).", channel->desc->name, channel->desc->profile, dir_path, err_str);
+        return 1;
+    }
+
+    if (files_mgr_new_window(channel->mgr, &window) != 0) {
+        IPX_CTX_WARNING(stg->ctx, "New time window of the channel '%s' (profile '%s') is not "
+            "properly created.", channel->desc->name, channel->desc->profile);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Process a request of a writer
+ * \param[in] stg  Storage
+ * \param[in] item Request
+ */
+static void
+stg_item_process(struct stg_profiles_s *stg, const struct stg_item *item)
+{
+    for (size_t i = 0; i < item->channels_cnt; ++i) {
+        struct stg_channel *channel = &stg->channels[item->channels[i]];
+        switch (item->type) {
+        case STG_ITEM_RECORD:
+            files_mgr_add_record(channel->mgr, item->rec);
+            break;
+        case STG_ITEM_WINDOW:
+            stg_channel_new_window(stg, channel, item->window);
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Main function of a writer thread
+ *
+ * The writer takes all pending requests at once, processes them and releases them together
+ * to reduce contention on the queue.
+ * \param[in] arg Writer
+ * \return Always NULL
+ */
+static void *
+stg_writer_main(void *arg)
+{
+    struct stg_writer *writer = (struct stg_writer *) arg;
+
+    while (true) {
+        pthread_mutex_lock(&writer->mutex);
+        while (writer->queue_cnt == 0 && !writer->stop) {
+            pthread_cond_wait(&writer->cond_empty, &writer->mutex);
+        }
+
+        const size_t head = writer->queue_head;
+        const size_t cnt = writer->queue_cnt;
+        pthread_mutex_unlock(&writer->mutex);
+
+        if (cnt == 0) {
+            // Stop flag is set and all requests have been processed
+            break;
+        }
+
+        for (size_t i = 0; i < cnt; ++i) {
+            stg_item_process(writer->stg, &writer->queue[(head + i) % writer->queue_size]);
+        }
+
+        pthread_mutex_lock(&writer->mutex);
+        writer->queue_head = (head + cnt) % writer->queue_size;
+        writer->queue_cnt -= cnt;
+        pthread_cond_signal(&writer->cond_full);
+        pthread_mutex_unlock(&writer->mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Reserve a free request in a queue of a writer
+ *
+ * If the queue is full, the function blocks until the writer releases at least one request.
+ * The request MUST be submitted by stg_writer_commit() before another one is reserved.
+ * \param[in] writer Writer
+ * \return Pointer to the request
+ */
+static struct stg_item *
+stg_writer_reserve(struct stg_writer *writer)
+{
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->queue_cnt == writer->queue_size) {
+        pthread_cond_wait(&writer->cond_full, &writer->mutex);
+    }
+
+    // Only the producer can modify the request behind the last valid one
+    size_t idx = (writer->queue_head + writer->queue_cnt) % writer->queue_size;
+    pthread_mutex_unlock(&writer->mutex);
+
+    struct stg_item *item = &writer->queue[idx];
+    item->channels_cnt = 0;
+    return item;
+}
+
+/**
+ * \brief Submit the previously reserved request to a writer
+ * \param[in] writer Writer
+ */
+static void
+stg_writer_commit(struct stg_writer *writer)
+{
+    pthread_mutex_lock(&writer->mutex);
+    writer->queue_cnt++;
+    pthread_cond_signal(&writer->cond_empty);
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+/**
+ * \brief Stop a writer thread and free its resources
+ *
+ * All pending requests are processed before the thread is terminated.
+ * \param[in] writer  Writer
+ * \param[in] running The thread is running
+ */
+static void
+stg_writer_destroy(struct stg_writer *writer, bool running)
+{
+    if (running) {
+        pthread_mutex_lock(&writer->mutex);
+        writer->stop = true;
+        pthread_cond_signal(&writer->cond_empty);
+        pthread_mutex_unlock(&writer->mutex);
+        pthread_join(writer->thread, NULL);
+    }
+
+    for (size_t i = 0; writer->queue != NULL && i < writer->queue_size; ++i) {
+        if (writer->queue[i].rec) {
+            lnf_rec_free(writer->queue[i].rec);
+        }
+        free(writer->queue[i].channels);
+    }
+
+    pthread_cond_destroy(&writer->cond_empty);
+    pthread_cond_destroy(&writer->cond_full);
+    pthread_mutex_destroy(&writer->mutex);
+    free(writer->queue);
+    free(writer->channels);
+}
+
+/**
+ * \brief Initialize a writer (the thread is not started)
+ *
+ * Channels must be already assigned to writers.
+ * \param[in] stg    Storage
+ * \param[in] writer Writer to initialize
+ * \param[in] idx    Index of the writer
+ * \return On success returns #IPX_OK. Otherwise returns #IPX_ERR_NOMEM.
+ */
+static int
+stg_writer_init(struct stg_profiles_s *stg, struct stg_writer *writer, size_t idx)
+{
+    writer->stg = stg;
+    writer->queue_size = stg->params->profiles.queue;
+
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->cond_empty, NULL);
+    pthread_cond_init(&writer->cond_full, NULL);
+
+    for (size_t i = 0; i < stg->tree->channels_cnt; ++i) {
+        writer->channels_cnt += (stg->channels[i].writer == idx) ? 1 : 0;
+    }
+
+    writer->channels = calloc(writer->channels_cnt, sizeof(*writer->channels));
+    writer->queue = calloc(writer->queue_size, sizeof(*writer->queue));
+    if (!writer->channels || !writer->queue) {
+        return IPX_ERR_NOMEM;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < stg->tree->channels_cnt; ++i) {
+        if (stg->channels[i].writer == idx) {
+            writer->channels[pos++] = i;
+        }
+    }
+
+    for (size_t i = 0; i < writer->queue_size; ++i) {
+        struct stg_item *item = &writer->queue[i];
+        item->channels = calloc(writer->channels_cnt, sizeof(*item->channels));
+        if (!item->channels || lnf_rec_init(&item->rec) != LNF_OK) {
+            item->rec = NULL;
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Create and start writer threads
+ * \param[in] stg Storage
+ * \return On success returns #IPX_OK. Otherwise returns #IPX_ERR_NOMEM or #IPX_ERR_DENIED.
+ */
+static int
+stg_writers_start(struct stg_profiles_s *stg)
+{
+    size_t cnt = stg->params->profiles.writers;
+    if (cnt > stg->tree->channels_cnt) {
+        // Each writer must have at least one channel
+        cnt = stg->tree->channels_cnt;
+    }
+
+    if (cnt == 0) {
+        return IPX_OK;
+    }
+
+    stg->writers = calloc(cnt, sizeof(*stg->writers));
+    if (!stg->writers) {
+        IPX_CTX_ERROR(stg->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < stg->tree->channels_cnt; ++i) {
+        stg->channels[i].writer = i % cnt;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        struct stg_writer *writer = &stg->writers[i];
+        if (stg_writer_init(stg, writer, i) != IPX_OK) {
+            IPX_CTX_ERROR(stg->ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+            stg_writer_destroy(writer, false);
+            return IPX_ERR_NOMEM;
+        }
+
+        int rc = pthread_create(&writer->thread, NULL, &stg_writer_main, writer);
+        if (rc != 0) {
+            const char *err_str;
+            ipx_strerror(rc, err_str);
+            IPX_CTX_ERROR(stg->ctx, "Failed to start a writer thread: %s", err_str);
+            stg_writer_destroy(writer, false);
+            return IPX_ERR_DENIED;
+        }
+
+        stg->writers_cnt++;
+    }
+
+    IPX_CTX_INFO(stg->ctx, "%zu writer thread(s) started.", stg->writers_cnt);
+    return IPX_OK;
+}
+
+stg_profiles_t *
+stg_profiles_create(ipx_ctx_t *ctx, const struct conf_params *params)
+{
+    // Prepare the internal structure
+    stg_profiles_t *instance = (stg_profiles_t *) calloc(1, sizeof(*instance));
+    if (!instance) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    instance->ctx = ctx;
+    instance->params = params;
+    instance->tree = profile_tree_load(ctx, params->profiles.tree);
+    if (!instance->tree) {
+        IPX_CTX_ERROR(ctx, "Failed to load the profile tree '%s'.", params->profiles.tree);
+        free(instance);
+        return NULL;
+    }
+
+    const size_t ch_cnt = instance->tree->channels_cnt;
+    instance->channels = calloc(ch_cnt, sizeof(*instance->channels));
+    instance->matches = calloc(ch_cnt, sizeof(*instance->matches));
+    if (!instance->channels || !instance->matches) {
+        IPX_CTX_ERROR(ctx, "Unable to allocate memory (%s:%d)", __FILE__, __LINE__);
+        stg_profiles_destroy(instance);
+        return NULL;
+    }
+
+    // Create an output file manager for each channel
+    for (size_t i = 0; i < ch_cnt; ++i) {
+        struct stg_channel *channel = &instance->channels[i];
+        channel->desc = &instance->tree->channels[i];
+        channel->mgr = stg_common_files_mgr_create(ctx, params, channel->desc->path);
+        if (!channel->mgr) {
+            IPX_CTX_ERROR(ctx, "Failed to create output manager of the channel '%s' "
+                "(profile '%s').", channel->desc->name, channel->desc->profile);
+            stg_profiles_destroy(instance);
+            return NULL;
+        }
+    }
+
+    if (stg_writers_start(instance) != IPX_OK) {
+        stg_profiles_destroy(instance);
+        return NULL;
+    }
+
+    return instance;
+}
+
+void
+stg_profiles_destroy(stg_profiles_t *storage)
+{
+    // Flush all pending records first
+    for (size_t i = 0; i < storage->writers_cnt; ++i) {
+        stg_writer_destroy(&storage->writers[i], true);
+    }
+    free(storage->writers);
+
+    for (size_t i = 0; storage->channels != NULL && i < storage->tree->channels_cnt; ++i) {
+        if (storage->channels[i].mgr) {
+            files_mgr_destroy(storage->channels[i].mgr);
+        }
+    }
+
+    free(storage->channels);
+    free(storage->matches);
+    profile_tree_destroy(storage->tree);
+    free(storage);
+}
+
+int
+stg_profiles_store(stg_profiles_t *storage, lnf_rec_t *rec)
+{
+    // Evaluate all channels at once
+    bool *matches = storage->matches;
+    if (profile_tree_eval(storage->tree, rec, ++storage->rec_id, matches) == 0) {
+        return 0;
+    }
+
+    int ret = 0;
+    if (storage->writers_cnt == 0) {
+        for (size_t i = 0; i < storage->tree->channels_cnt; ++i) {
+            if (matches[i] && files_mgr_add_record(storage->channels[i].mgr, rec) != 0) {
+                ret = 1;
+            }
+        }
+
+        return ret;
+    }
+
+    // Pass one copy of the record to each writer with at least one matching channel
+    for (size_t i = 0; i < storage->writers_cnt; ++i) {
+        struct stg_writer *writer = &storage->writers[i];
+        struct stg_item *item = NULL;
+
+        for (size_t j = 0; j < writer->channels_cnt; ++j) {
+            const size_t ch_idx = writer->channels[j];
+            if (!matches[ch_idx]) {
+                continue;
+            }
+
+            if (!item) {
+                item = stg_writer_reserve(writer);
+                item->type = STG_ITEM_RECORD;
+                if (lnf_rec_copy(item->rec, rec) != LNF_OK) {
+                    ret = 1;
+                    break;
+                }
+            }
+
+            item->channels[item->channels_cnt++] = ch_idx;
+        }
+
+        if (item && item->channels_cnt > 0) {
+            stg_writer_commit(writer);
+        }
+    }
+
+    return ret;
+}
+
+int
+stg_profiles_new_window(stg_profiles_t *storage, time_t window)
+{
+    int ret = 0;
+
+    if (storage->writers_cnt == 0) {
+        for (size_t i = 0; i < storage->tree->channels_cnt; ++i) {
+            if (stg_channel_new_window(storage, &storage->channels[i], window) != 0) {
+                ret = 1;
+            }
+        }
+    } else {
+        // Requests are processed by writers after all previously stored records
+        for (size_t i = 0; i < storage->writers_cnt; ++i) {
+            struct stg_writer *writer = &storage->writers[i];
+            struct stg_item *item = stg_writer_reserve(writer);
+            item->type = STG_ITEM_WINDOW;
+            item->window = window;
+            memcpy(item->channels, writer->channels, writer->channels_cnt * sizeof(size_t));
+            item->channels_cnt = writer->channels_cnt;
+            stg_writer_commit(writer);
+        }
+    }
+
+    if (ret == 0) {
+        IPX_CTX_INFO(storage->ctx, "New time window successfully created.", '\0');
+    } else {
+        IPX_CTX_WARNING(storage->ctx, "New time window is not properly created.", '\0');
+    }
+
+    return ret;
+}
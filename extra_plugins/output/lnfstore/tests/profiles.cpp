@@ -0,0 +1,362 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <ftw.h>
+#include <unistd.h>
+
+extern "C" {
+    #include <configuration.h>
+    #include <profile_tree.h>
+    #include <storage_profiles.h>
+}
+
+// The plugin is a module, functions provided by the collector must be defined here
+extern "C" {
+    enum ipx_verb_level
+    ipx_ctx_verb_get(const ipx_ctx_t *ctx)
+    {
+        (void) ctx;
+        return IPX_VERB_NONE;
+    }
+
+    void
+    ipx_verb_ctx_print(enum ipx_verb_level level, const ipx_ctx_t *ctx, const char *fmt, ...)
+    {
+        (void) level;
+        (void) ctx;
+        (void) fmt;
+    }
+
+    int
+    ipx_strerror_fn(int errnum, char *buffer, size_t buffer_size)
+    {
+        snprintf(buffer, buffer_size, "%s", strerror(errnum));
+        return IPX_OK;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Start of the first time window (2017-07-14 02:40:00 UTC) */
+static const time_t WINDOW = 1500000000;
+
+/** Temporary directory with a profile tree file */
+class Profiles : public ::testing::Test {
+protected:
+    std::string dir;
+    std::string file;
+
+    void SetUp() override {
+        char tmp[] = "/tmp/ipfixcol2_lnfstore_XXXXXX";
+        ASSERT_NE(mkdtemp(tmp), nullptr);
+        dir = tmp;
+        file = dir + "/profiles.xml";
+    }
+
+    void TearDown() override {
+        nftw(dir.c_str(), [](const char *path, const struct stat *, int, struct FTW *) {
+            return remove(path);
+        }, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    /** Write a profile tree file (all "@" are replaced with the temporary directory) */
+    void write_tree(std::string content) {
+        size_t pos;
+        while ((pos = content.find('@')) != std::string::npos) {
+            content.replace(pos, 1, dir);
+        }
+
+        std::ofstream out(file);
+        out << content;
+    }
+
+    /** Load the tree file */
+    struct profile_tree *load() {
+        return profile_tree_load(nullptr, file.c_str());
+    }
+};
+
+/**
+ * Tree with profiles defined before their parents:
+ *   live: tcp, udp, all
+ *   dns (parent live): any (all channels of the parent as sources)
+ *   http (parent live): web (source tcp)
+ */
+static const char *TREE_VALID =
+    "<profiles>"
+    "  <profile>"
+    "    <name>http</name><parent>live</parent><directory>@/http</directory>"
+    "    <channel><name>web</name><source>tcp</source><filter>dst port 80</filter></channel>"
+    "  </profile>"
+    "  <profile>"
+    "    <name>live</name><directory>@/live</directory>"
+    "    <channel><name>tcp</name><filter>proto tcp</filter></channel>"
+    "    <channel><name>udp</name><filter>  proto udp </filter></channel>"
+    "    <channel><name>all</name><filter>*</filter></channel>"
+    "  </profile>"
+    "  <profile>"
+    "    <name>dns</name><parent>live</parent><directory>@/dns</directory>"
+    "    <channel><name>any</name><filter>proto udp</filter></channel>"
+    "  </profile>"
+    "</profiles>";
+
+/** Create a LNF record */
+static lnf_rec_t *
+rec_create(uint64_t first, uint8_t proto, uint16_t dport)
+{
+    lnf_rec_t *rec = nullptr;
+    if (lnf_rec_init(&rec) != LNF_OK) {
+        return nullptr;
+    }
+
+    lnf_rec_fset(rec, LNF_FLD_FIRST, &first);
+    lnf_rec_fset(rec, LNF_FLD_PROT, &proto);
+    lnf_rec_fset(rec, LNF_FLD_DSTPORT, &dport);
+    return rec;
+}
+
+// Channels are placed in topological order and filters with the same expression are shared
+TEST_F(Profiles, treeLayout)
+{
+    write_tree(TREE_VALID);
+    struct profile_tree *tree = load();
+    ASSERT_NE(tree, nullptr);
+
+    ASSERT_EQ(tree->channels_cnt, 5U);
+    const char *names[] = {"tcp", "udp", "all", "any", "web"};
+    const char *profiles[] = {"live", "live", "live", "dns", "http"};
+    for (size_t i = 0; i < tree->channels_cnt; ++i) {
+        EXPECT_STREQ(tree->channels[i].name, names[i]);
+        EXPECT_STREQ(tree->channels[i].profile, profiles[i]);
+    }
+
+    EXPECT_EQ(std::string(tree->channels[0].path), dir + "/live/tcp/");
+    EXPECT_EQ(std::string(tree->channels[4].path), dir + "/http/web/");
+
+    // Sources: root channels have none, "any" has all channels of "live", "web" only "tcp"
+    EXPECT_EQ(tree->channels[0].sources_cnt, 0U);
+    ASSERT_EQ(tree->channels[3].sources_cnt, 3U);
+    EXPECT_EQ(tree->channels[3].sources[0], 0U);
+    EXPECT_EQ(tree->channels[3].sources[2], 2U);
+    ASSERT_EQ(tree->channels[4].sources_cnt, 1U);
+    EXPECT_EQ(tree->channels[4].sources[0], 0U);
+
+    // "proto tcp", "proto udp" (shared by "udp" and "any"), match all, "dst port 80"
+    ASSERT_EQ(tree->filters_cnt, 4U);
+    EXPECT_EQ(tree->channels[1].filter_idx, tree->channels[3].filter_idx);
+    EXPECT_EQ(tree->filters[tree->channels[2].filter_idx].expr, nullptr);
+    EXPECT_EQ(tree->filters[tree->channels[2].filter_idx].filter, nullptr);
+
+    profile_tree_destroy(tree);
+}
+
+// A channel matches only if its filter and at least one of its sources match
+TEST_F(Profiles, treeEval)
+{
+    write_tree(TREE_VALID);
+    struct profile_tree *tree = load();
+    ASSERT_NE(tree, nullptr);
+    bool matches[5];
+
+    lnf_rec_t *rec_tcp = rec_create(1, 6, 80);
+    ASSERT_NE(rec_tcp, nullptr);
+    EXPECT_EQ(profile_tree_eval(tree, rec_tcp, 1, matches), 3U);
+    const bool exp_tcp[] = {true, false, true, false, true};
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(matches[i], exp_tcp[i]) << tree->channels[i].name;
+    }
+
+    // "web" has a matching filter, but its only source doesn't match
+    lnf_rec_t *rec_udp = rec_create(2, 17, 80);
+    ASSERT_NE(rec_udp, nullptr);
+    EXPECT_EQ(profile_tree_eval(tree, rec_udp, 2, matches), 3U);
+    const bool exp_udp[] = {false, true, true, true, false};
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(matches[i], exp_udp[i]) << tree->channels[i].name;
+    }
+
+    // Results of filters are cached for the same record identification
+    EXPECT_EQ(profile_tree_eval(tree, rec_tcp, 2, matches), 3U);
+    EXPECT_TRUE(matches[1]);
+    EXPECT_EQ(profile_tree_eval(tree, rec_tcp, 3, matches), 3U);
+    EXPECT_TRUE(matches[0]);
+    EXPECT_FALSE(matches[1]);
+
+    lnf_rec_free(rec_tcp);
+    lnf_rec_free(rec_udp);
+    profile_tree_destroy(tree);
+}
+
+// Invalid trees are refused
+TEST_F(Profiles, treeInvalid)
+{
+    const std::vector<std::string> trees = {
+        // Missing file content
+        "",
+        // Cycle
+        "<profiles>"
+        "  <profile><name>a</name><parent>b</parent><directory>@/a</directory>"
+        "    <channel><name>x</name></channel></profile>"
+        "  <profile><name>b</name><parent>a</parent><directory>@/b</directory>"
+        "    <channel><name>y</name></channel></profile>"
+        "</profiles>",
+        // Unknown parent
+        "<profiles>"
+        "  <profile><name>a</name><parent>b</parent><directory>@/a</directory>"
+        "    <channel><name>x</name></channel></profile>"
+        "</profiles>",
+        // Unknown source channel
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory>"
+        "    <channel><name>x</name></channel></profile>"
+        "  <profile><name>b</name><parent>a</parent><directory>@/b</directory>"
+        "    <channel><name>y</name><source>z</source></channel></profile>"
+        "</profiles>",
+        // Root channel with a source
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory>"
+        "    <channel><name>x</name><source>x</source></channel></profile>"
+        "</profiles>",
+        // Duplicated profile
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory>"
+        "    <channel><name>x</name></channel></profile>"
+        "  <profile><name>a</name><directory>@/b</directory>"
+        "    <channel><name>y</name></channel></profile>"
+        "</profiles>",
+        // Duplicated channel
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory>"
+        "    <channel><name>x</name></channel><channel><name>x</name></channel></profile>"
+        "</profiles>",
+        // Invalid channel name
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory>"
+        "    <channel><name>x/y</name></channel></profile>"
+        "</profiles>",
+        // Invalid filter
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory>"
+        "    <channel><name>x</name><filter>proto proto</filter></channel></profile>"
+        "</profiles>",
+        // No channels
+        "<profiles>"
+        "  <profile><name>a</name><directory>@/a</directory></profile>"
+        "</profiles>"
+    };
+
+    for (const auto &content : trees) {
+        write_tree(content);
+        struct profile_tree *tree = load();
+        EXPECT_EQ(tree, nullptr) << content;
+        profile_tree_destroy(tree);
+    }
+
+    EXPECT_EQ(profile_tree_load(nullptr, (dir + "/missing.xml").c_str()), nullptr);
+}
+
+/** Profile storage with a given number of writer threads */
+class Storage : public Profiles, public ::testing::WithParamInterface<uint32_t> {
+protected:
+    struct conf_params params;
+    char suffix[32] = "%Y%m%d%H%M";
+    char prefix[8] = "lnf.";
+
+    void SetUp() override {
+        Profiles::SetUp();
+        write_tree(TREE_VALID);
+
+        memset(&params, 0, sizeof(params));
+        params.files.suffix = suffix;
+        params.file_lnf.prefix = prefix;
+        params.profiles.en = true;
+        params.profiles.tree = &file[0];
+        params.profiles.writers = GetParam();
+        params.profiles.queue = 4; // Writers must wait for each other
+    }
+
+    /** Read the "first" field of all records in a file of a channel */
+    std::vector<uint64_t> read(const std::string &channel, const std::string &name) {
+        std::vector<uint64_t> result;
+        const std::string path = dir + "/" + channel + "/2017/07/14/lnf." + name;
+        lnf_file_t *lnf_file = nullptr;
+        if (lnf_open(&lnf_file, path.c_str(), LNF_READ, nullptr) != LNF_OK) {
+            ADD_FAILURE() << "Failed to open " << path;
+            return result;
+        }
+
+        lnf_rec_t *rec = nullptr;
+        EXPECT_EQ(lnf_rec_init(&rec), LNF_OK);
+        while (lnf_read(lnf_file, rec) == LNF_OK) {
+            uint64_t first;
+            lnf_rec_fget(rec, LNF_FLD_FIRST, &first);
+            result.push_back(first);
+        }
+
+        lnf_rec_free(rec);
+        lnf_close(lnf_file);
+        return result;
+    }
+};
+
+// Records of each channel are stored in the original order and window changes are applied
+// after all records stored before
+TEST_P(Storage, order)
+{
+    stg_profiles_t *stg = stg_profiles_create(nullptr, &params);
+    ASSERT_NE(stg, nullptr);
+
+    // Expected content of files: [channel][window]
+    std::vector<std::vector<uint64_t>> expected[5];
+    for (auto &files : expected) {
+        files.resize(2);
+    }
+
+    for (uint64_t i = 0; i < 200; ++i) {
+        const size_t window = i / 100;
+        if (i % 100 == 0) {
+            ASSERT_EQ(stg_profiles_new_window(stg, WINDOW + (time_t) window * 300), 0);
+        }
+
+        const bool is_tcp = (i % 2 == 0);
+        const bool is_http = (i % 4 == 0);
+        lnf_rec_t *rec = rec_create(i, is_tcp ? 6 : 17, is_http ? 80 : 53);
+        ASSERT_NE(rec, nullptr);
+        EXPECT_EQ(stg_profiles_store(stg, rec), 0);
+        lnf_rec_free(rec); // The storage must keep its own copy
+
+        expected[is_tcp ? 0 : 1][window].push_back(i);
+        expected[2][window].push_back(i);
+        if (!is_tcp) {
+            expected[3][window].push_back(i);
+        }
+        if (is_http) {
+            expected[4][window].push_back(i);
+        }
+    }
+
+    stg_profiles_destroy(stg);
+
+    const char *channels[] = {"live/tcp", "live/udp", "live/all", "dns/any", "http/web"};
+    const char *files[] = {"201707140240", "201707140245"};
+    for (size_t ch = 0; ch < 5; ++ch) {
+        for (size_t window = 0; window < 2; ++window) {
+            EXPECT_EQ(read(channels[ch], files[window]), expected[ch][window])
+                << channels[ch] << " " << files[window];
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Writers, Storage, ::testing::Values(0U, 1U, 2U, 8U));
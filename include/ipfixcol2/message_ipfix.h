@@ -48,6 +48,7 @@ extern "C" {
 
 #include <libfds.h>
 #include <stddef.h>
+#include <sys/uio.h>
 
 #include <ipfixcol2/api.h>
 #include "session.h"
@@ -91,6 +92,13 @@ struct ipx_ipfix_set {
 	 * i.e. \code{.c} uint16_t real_len = ntohs(ptr->length); \endcode
 	 */
     struct fds_ipfix_set_hdr *ptr;
+    /**
+     * (Options) Template of a Data Set
+     * \note NULL if the Set is not a Data Set or the Template is not available.
+     */
+    const struct fds_template *tmplt;
+    /** Template snapshot of the Data Set (NULL if the Template is not available)  */
+    const fds_tsnapshot_t *snap;
 
     // New parameters could be added here...
 };
@@ -101,10 +109,62 @@ struct ipx_ipfix_set {
 struct ipx_ipfix_record {
     /** Data record information                                               */
     struct fds_drec rec;
+    /** Bitset of filled extensions (see ipx_ctx_rext_set_filled())           */
+    uint64_t ext_mask;
     /** Start of reserved space for registered extensions (filled by plugins) */
     uint8_t ext[1];
 };
 
+/** \brief Flags of derived flow information (see ipx_flow_info::flags)      */
+enum ipx_flow_info_flags {
+    /** Source and destination addresses are available                      */
+    IPX_FLOW_ADDR  = (1U << 0),
+    /** Both addresses are IPv4 addresses                                    */
+    IPX_FLOW_IPV4  = (1U << 1),
+    /** Source and destination ports are available                          */
+    IPX_FLOW_PORTS = (1U << 2),
+    /** Protocol identifier is available                                    */
+    IPX_FLOW_PROTO = (1U << 3),
+    /** Flow start timestamp is available                                   */
+    IPX_FLOW_START = (1U << 4),
+    /** Flow end timestamp is available                                     */
+    IPX_FLOW_END   = (1U << 5)
+};
+
+/**
+ * \brief Flow key and timestamps derived from a Data Record
+ *
+ * The information is derived only from IANA (i.e. non-reverse) Information Elements. If a field
+ * is not available, its value is zero. IPv4 addresses are stored as IPv4-mapped IPv6 addresses
+ * (i.e. "::ffff:a.b.c.d"). Timestamps are converted from any available precision (seconds,
+ * milliseconds, microseconds, nanoseconds), from microseconds relative to the Export Time and
+ * from the system uptime relative to systemInitTimeMilliseconds (in this order of preference).
+ */
+struct ipx_flow_info {
+    /** Source address (IPv6 or IPv4-mapped IPv6 address)                   */
+    uint8_t src_addr[16];
+    /** Destination address (IPv6 or IPv4-mapped IPv6 address)              */
+    uint8_t dst_addr[16];
+    /** Source port (host byte order)                                        */
+    uint16_t src_port;
+    /** Destination port (host byte order)                                   */
+    uint16_t dst_port;
+    /** Protocol identifier                                                  */
+    uint8_t proto;
+    /** Available information (see #ipx_flow_info_flags)                     */
+    uint8_t flags;
+    /**
+     * Hash of the flow key (addresses, ports and protocol)
+     * \note The hash doesn't depend on the direction of the flow, i.e. a flow and its opposite
+     *   direction (swapped addresses and ports) have the same hash.
+     */
+    uint64_t hash;
+    /** Flow start (nanoseconds since the UNIX epoch)                         */
+    uint64_t start;
+    /** Flow end (nanoseconds since the UNIX epoch)                           */
+    uint64_t end;
+};
+
 /**
  * \brief Create an empty wrapper around IPFIX (or NetFlow) Message
  *
@@ -125,6 +185,8 @@ ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_
 
 /**
  * \brief Destroy a message wrapper with a parsed IPFIX packet
+ * \note If the message is shared by multiple branches of the pipeline, only the reference of
+ *   the caller is released.
  * \param[out] msg Pointer to the message
  */
 IPX_API void
@@ -140,12 +202,34 @@ ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg);
  *
  * \note Size of the message is stored directly in the header (network byte
  *   order) i.e. \code{.c} uint16_t real_len = ntohs(header->length); \endcode
+ * \warning
+ *   The message can be segmented (e.g. after conversion from NetFlow, unmodified parts of the
+ *   original message are only referenced). In this case, the returned memory holds only the
+ *   first segment, which always contains at least the whole IPFIX Message header. To access
+ *   the whole message, use ipx_msg_ipfix_get_segs().
  * \param[in] msg Message
  * \return Pointer to the IPFIX (or NetFlow) Message header
  */
 IPX_API uint8_t *
 ipx_msg_ipfix_get_packet(ipx_msg_ipfix_t *msg);
 
+/**
+ * \brief Get segments of the raw message
+ *
+ * The message is represented as a sequence of memory segments that together form the whole
+ * IPFIX Message (i.e. the sum of their sizes is equal to the length in the IPFIX Message header).
+ * The first segment always starts with the IPFIX Message header and each IPFIX Set is always
+ * stored within a single segment. If the message is not segmented, there is only one segment.
+ * The array is suitable for functions such as writev() or sendmsg().
+ *
+ * \warning The segments MUST be used read-only!
+ * \param[in]  msg Message
+ * \param[out] iov Pointer to the array of segments
+ * \param[out] cnt Number of segments in the array
+ */
+IPX_API void
+ipx_msg_ipfix_get_segs(ipx_msg_ipfix_t *msg, const struct iovec **iov, size_t *cnt);
+
 /**
  * \brief Get the message context
  *
@@ -167,6 +251,11 @@ ipx_msg_ipfix_get_sets(ipx_msg_ipfix_t *msg, struct ipx_ipfix_set **sets, size_t
 
 /**
  * \brief Get a number of parsed IPFIX Data records in the message
+ *
+ * If no instance of the pipeline requires Data Records (see #IPX_PF_SET_LEVEL), the parser
+ * doesn't split Data Sets into records and the records are split on demand during the first
+ * call of this function or ipx_msg_ipfix_get_drec(). The split is performed only once and it
+ * is safe to call the functions concurrently from multiple output instances.
  * \note Data records that a preprocessor failed to interpret are not counted!
  * \param[in] msg Message
  * \return Count
@@ -178,6 +267,7 @@ ipx_msg_ipfix_get_drec_cnt(const ipx_msg_ipfix_t *msg);
  * \brief Get a pointer to the data record (specified by an index) in the packet
  *
  * \note Data records that a preprocessor failed to interpret are not listed!
+ * \note Data records might be split on demand, see ipx_msg_ipfix_get_drec_cnt().
  * \param[in] msg Message
  * \param[in] idx Index of the record (index starts at 0)
  * \return On success returns the pointer.
@@ -186,6 +276,61 @@ ipx_msg_ipfix_get_drec_cnt(const ipx_msg_ipfix_t *msg);
 IPX_API struct ipx_ipfix_record *
 ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx);
 
+/**
+ * \brief Get the flow key and timestamps of a Data Record (specified by an index)
+ *
+ * The information is derived for all Data Records of the message during the first call of
+ * the function, so all plugins share the same values and records are walked only once. Each
+ * Template is analyzed only once (extraction plans are cached) and the records are processed
+ * only by the precomputed plan. It is safe to call the function concurrently from multiple
+ * output instances.
+ * \note A plugin that modifies Data Records in place MUST call ipx_msg_ipfix_flow_info_reset().
+ * \param[in] msg Message
+ * \param[in] idx Index of the record (index starts at 0)
+ * \return On success returns the pointer.
+ *   Otherwise (the index is out-of-range or a memory allocation error) returns NULL.
+ */
+IPX_API const struct ipx_flow_info *
+ipx_msg_ipfix_get_flow_info(ipx_msg_ipfix_t *msg, uint32_t idx);
+
+/**
+ * \brief Discard the derived flow information of the message
+ *
+ * The information will be derived again during the next call of ipx_msg_ipfix_get_flow_info().
+ * \warning The message MUST NOT be shared with other instances at the time of the call.
+ * \param[in] msg Message
+ */
+IPX_API void
+ipx_msg_ipfix_flow_info_reset(ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Add a new reference to an IPFIX Set
+ *
+ * This function (together with ipx_msg_ipfix_add_drec_ref()) allows plugins to build new
+ * messages, for example, by transformation of received ones. The Set MUST be placed in the
+ * raw message of the wrapper (see ipx_msg_ipfix_create()).
+ * \note The reference is zeroed (i.e. the Template is unknown) and the caller MUST fill at
+ *   least the pointer to the Set!
+ * \param[in] msg Message
+ * \return Pointer to the reference or NULL (memory allocation error)
+ */
+IPX_API struct ipx_ipfix_set *
+ipx_msg_ipfix_add_set_ref(ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Add a new reference to an IPFIX Data Record
+ *
+ * The Data Record (i.e. its data) MUST be placed in the raw message of the wrapper and its
+ * Template MUST be available in the Template snapshot of the record.
+ * \note The record is uninitialized (except for the empty set of filled extensions) and the
+ *   caller MUST fill it!
+ * \warning The wrapper \p msg_ref can be reallocated and different pointer can be returned!
+ * \param[in,out] msg_ref Message
+ * \return Pointer to the record or NULL (memory allocation error)
+ */
+IPX_API struct ipx_ipfix_record *
+ipx_msg_ipfix_add_drec_ref(ipx_msg_ipfix_t **msg_ref);
+
 /**
  * \brief Cast from a source session message to a base message
  * \param[in] msg Pointer to the session message
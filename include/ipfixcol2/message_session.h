@@ -57,6 +57,11 @@ extern "C" {
  * useful for preparing or cleaning up internal structures of plugins.
  *
  * \remark Identification type of this message is #IPX_MSG_SESSION.
+ * \warning A received message can be a copy stored directly in a slot of the input ring
+ *   buffer of the instance. Such a copy is valid only until the next message is taken from the
+ *   ring buffer, i.e. the plugin MUST pass or destroy it within the same call of
+ *   ipx_plugin_process() and MUST NOT keep a pointer to the message for later. The Source
+ *   Session referenced by the message is not affected.
  *
  * @{
  */
@@ -88,6 +93,8 @@ ipx_msg_session_create(const struct ipx_session *session, enum ipx_msg_session_e
  * \brief Destroy a status message
  *
  * Only destroy the message. A Source Session is not freed.
+ * \note If the message is shared by multiple branches of the pipeline, only the reference of
+ *   the caller is released.
  * \param[in] msg Pointer to the message
  */
 IPX_API void
@@ -51,6 +51,7 @@ typedef struct ipx_ctx ipx_ctx_t;
 /** Internal data structure that represents IPFIXcol record extension                          */
 typedef struct ipx_ctx_rext ipx_ctx_rext_t;
 
+#include <time.h>
 #include <ipfixcol2/api.h>
 #include <ipfixcol2/verbose.h>
 #include <ipfixcol2/session.h>
@@ -134,6 +135,31 @@ typedef struct ipx_ctx_rext ipx_ctx_rext_t;
  */
 #define IPX_PT_OUTPUT 3U
 
+/**
+ * \def IPX_PF_SET_LEVEL
+ * \brief Plugin flag: the plugin processes IPFIX Messages only at the level of IPFIX Sets
+ *
+ * The plugin never (or only rarely) accesses individual Data Records of IPFIX Messages using
+ * ipx_msg_ipfix_get_drec() and ipx_msg_ipfix_get_drec_cnt(). Instead, it works with raw Sets and
+ * their Templates (see ipx_msg_ipfix_get_sets()). If all intermediate and output instances have
+ * the flag, the IPFIX parser doesn't split Data Sets into Data Records and the records are split
+ * only on demand.
+ */
+#define IPX_PF_SET_LEVEL 0x0001U
+
+/**
+ * \def IPX_PF_MSG_MODIFY
+ * \brief Plugin flag: the intermediate plugin modifies content of received IPFIX Messages
+ *
+ * The plugin modifies raw Data Records (e.g. anonymization of IP addresses) or other parts of
+ * IPFIX Messages it passes. If the pipeline consists of multiple branches (see the startup
+ * configuration), a message can be shared by intermediate instances of multiple branches.
+ * In this case, the instance gets its own copy of the message before processing, so
+ * modifications are not visible to other branches. Producers of record extensions (see
+ * ipx_ctx_rext_producer()) are always considered as modifying plugins.
+ */
+#define IPX_PF_MSG_MODIFY 0x0002U
+
 /**
  * \brief Identification of a plugin
  *
@@ -148,7 +174,7 @@ struct ipx_plugin_info {
     const char *dsc;
     /** Plugin type (one of #IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT)              */
     uint16_t type;
-    /** Configuration flags (reserved for future use)                                         */
+    /** Configuration flags (zero or more IPX_PF_* flags, e.g. #IPX_PF_SET_LEVEL)             */
     uint16_t flags;
     /** Plugin version string (like "1.2.3")                                                  */
     const char *version;
@@ -292,6 +318,27 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 IPX_API void
 ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *session);
 
+/**
+ * \brief Periodic tick (Intermediate and Output plugins only, optional)
+ *
+ * The function is called periodically by the IPFIXcol core if the instance requested ticks
+ * during its initialization (see ipx_ctx_tick_set()). It is called by the same thread as
+ * ipx_plugin_process(), i.e. in order with processing of messages and never concurrently.
+ * Therefore, the plugin can, for example, flush buffered records or rotate files within
+ * a bounded time even if no messages are received and it doesn't have to read the current
+ * time while processing messages.
+ *
+ * The tick is delivered as soon as possible after the interval expires, however, it is never
+ * delivered in the middle of processing a message. Missed ticks are not accumulated. After
+ * processing of messages by the instance is terminated, no more ticks are delivered.
+ * Intermediate plugins are allowed to pass messages (see ipx_ctx_msg_pass()).
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private data of the instance prepared by initialization function
+ * \param[in] now Current time (CLOCK_REALTIME)
+ */
+IPX_API void
+ipx_plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now);
+
 /**
  * @}
  *
@@ -396,6 +443,185 @@ ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t
 IPX_API const fds_iemgr_t *
 ipx_ctx_iemgr_get(ipx_ctx_t *ctx);
 
+/**
+ * \brief Check if messages of an Observation Domain are processed by any output instance
+ *
+ * Output instances can be configured to process only selected ODIDs. If messages of an ODID
+ * are not processed by any output instance, an input plugin SHOULD drop them right after
+ * reading their header, i.e. before a message wrapper is created and passed to the pipeline.
+ * Dropped messages are counted by the collector, so the plugin doesn't have to report them.
+ * \warning
+ *   This interface is only for Input plugins and the ODID must be the same as the ODID in
+ *   the context of the created message (see struct ipx_msg_ctx).
+ * \param[in] ctx  Plugin context
+ * \param[in] odid Observation Domain ID
+ * \return True if the messages should be passed, false if they should be dropped.
+ */
+IPX_API bool
+ipx_ctx_odid_wanted(ipx_ctx_t *ctx, uint32_t odid);
+
+/**
+ * \brief Get busy polling timeout of sockets (low-latency mode)
+ *
+ * If the collector runs in the low-latency mode, input plugins SHOULD set the timeout on their
+ * sockets (i.e. socket option SO_BUSY_POLL) and they SHOULD NOT block in the getter waiting for
+ * new data (e.g. use zero timeout of epoll_wait()), because the getter is called again
+ * immediately. Latency of passing messages is prioritized over CPU utilization in this mode.
+ * \warning This interface is only for Input plugins.
+ * \param[in] ctx Plugin context
+ * \return Timeout in microseconds or 0 (the low-latency mode is disabled)
+ */
+IPX_API uint32_t
+ipx_ctx_busy_poll_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Declare an Information Element processed by the instance
+ *
+ * By default, each instance is interested in all Information Elements. If the instance
+ * processes only a few fields, it can declare them so the collector can compute a demand
+ * of the whole pipeline and the IPFIX parser can skip Data Sets of (Options) Templates that
+ * don't contain any field demanded by any instance. Data Records of such Data Sets are not
+ * available to any instance (but the Sets are still part of IPFIX Messages).
+ *
+ * After the first call, the instance is interested only in the declared elements (unless
+ * ipx_ctx_ie_demand_all() is called).
+ * \note Fields nested in structured data types (e.g. subTemplateList) are not considered. If
+ *   the instance needs them, it MUST declare the list field itself.
+ * \warning The function can be called only within ipx_plugin_init() of Intermediate and Output
+ *   plugins.
+ * \param[in] ctx Plugin context
+ * \param[in] en  Enterprise Number
+ * \param[in] id  Information Element ID
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is not allowed to declare the element now
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_ctx_ie_demand(ipx_ctx_t *ctx, uint32_t en, uint16_t id);
+
+/**
+ * \brief Declare that the instance processes all Information Elements
+ *
+ * This is the default behaviour. The function is useful if the instance decides based on its
+ * configuration and it overrides all elements declared by ipx_ctx_ie_demand().
+ * \warning The function can be called only within ipx_plugin_init() of Intermediate and Output
+ *   plugins.
+ * \param[in] ctx Plugin context
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is not allowed to declare the elements now
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_ctx_ie_demand_all(ipx_ctx_t *ctx);
+
+/**
+ * \brief Request periodic ticks (see ipx_plugin_tick())
+ *
+ * By default, ticks are disabled.
+ * \warning The function can be called only within ipx_plugin_init() of Intermediate and Output
+ *   plugins that implement ipx_plugin_tick().
+ * \param[in] ctx      Plugin context
+ * \param[in] interval Interval between ticks in milliseconds (0 == disabled)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is not allowed to request ticks
+ */
+IPX_API int
+ipx_ctx_tick_set(ipx_ctx_t *ctx, uint32_t interval);
+
+/**
+ * @}
+ *
+ * \defgroup RextAPI Record extensions
+ * \ingroup pluginAPI
+ * \brief Additional data attached to IPFIX Data Records
+ *
+ * An Intermediate plugin can attach its own data (an extension) to each Data Record of an IPFIX
+ * Message. For example, results of a lookup in a database can be computed only once and shared
+ * with all following plugins in the pipeline. Each extension is identified by its type (i.e.
+ * a format of the data, e.g. "exporter-meta") and name.
+ *
+ * During initialization (i.e. inside ipx_plugin_init()), the instance that wants to fill an
+ * extension registers itself as its producer and instances that want to read it register
+ * themselves as its consumers. After all instances are initialized, the collector checks that
+ * each consumer has a producer placed before it in the pipeline and reserves space for all
+ * extensions in each Data Record.
+ *
+ * Extensions are not filled by default. The producer MUST call ipx_ctx_rext_set_filled() after
+ * writing the data to a record, otherwise consumers treat the extension as missing.
+ *
+ * @{
+ */
+
+/** Maximum number of extensions produced in the pipeline */
+#define IPX_CTX_REXT_MAX 64
+
+struct ipx_ipfix_record;
+
+/**
+ * \brief Register the instance as a producer of a record extension
+ *
+ * Only Intermediate plugins can produce extensions and only one instance in the pipeline can
+ * produce the extension of the same type and name.
+ * \warning The function can be called only within ipx_plugin_init() of the instance.
+ * \param[in]  ctx  Plugin context
+ * \param[in]  type Type of the extension (i.e. format of the data)
+ * \param[in]  name Name of the extension
+ * \param[in]  size Size of the extension data (in bytes, non-zero)
+ * \param[out] rext Reference to the extension (used to access data in records)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the parameters are not valid
+ * \return #IPX_ERR_DENIED if the instance is not allowed to register the extension now
+ * \return #IPX_ERR_EXISTS if the instance has already registered the same extension
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_ctx_rext_producer(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
+    ipx_ctx_rext_t **rext);
+
+/**
+ * \brief Register the instance as a consumer of a record extension
+ *
+ * Only Intermediate and Output plugins can consume extensions.
+ * \warning The function can be called only within ipx_plugin_init() of the instance.
+ * \param[in]  ctx  Plugin context
+ * \param[in]  type Type of the extension (i.e. format of the data)
+ * \param[in]  name Name of the extension
+ * \param[out] rext Reference to the extension (used to access data in records)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the parameters are not valid
+ * \return #IPX_ERR_DENIED if the instance is not allowed to register the extension now
+ * \return #IPX_ERR_EXISTS if the instance has already registered the same extension
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+IPX_API int
+ipx_ctx_rext_consumer(ipx_ctx_t *ctx, const char *type, const char *name, ipx_ctx_rext_t **rext);
+
+/**
+ * \brief Get data of a record extension
+ *
+ * The producer of the extension is allowed to get and modify the data even if they are not
+ * filled yet. Consumers MUST use the data read-only.
+ * \warning Extensions can be accessed only after the instance has been initialized.
+ * \param[in]  rext Reference to the extension
+ * \param[in]  drec Data Record
+ * \param[out] data Pointer to the data of the extension
+ * \param[out] size Size of the data (can be NULL)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the extension hasn't been filled by the producer (the data are
+ *   still available for the producer)
+ */
+IPX_API int
+ipx_ctx_rext_get(const ipx_ctx_rext_t *rext, struct ipx_ipfix_record *drec, void **data,
+    size_t *size);
+
+/**
+ * \brief Mark a record extension as filled (producer only)
+ * \param[in] rext Reference to the extension
+ * \param[in] drec Data Record
+ */
+IPX_API void
+ipx_ctx_rext_set_filled(const ipx_ctx_rext_t *rext, struct ipx_ipfix_record *drec);
+
 /**
  * @}
  * @}
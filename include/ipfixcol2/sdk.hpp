@@ -0,0 +1,96 @@
+/**
+ * \file include/ipfixcol2/sdk.hpp
+ * \author agent <agent@local>
+ * \brief Header-only C++17 SDK for plugins (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_SDK_HPP
+#define IPX_SDK_HPP
+
+#if __cplusplus < 201703L
+#error "IPFIXcol2 C++ SDK requires C++17 or newer"
+#endif
+
+/**
+ * \defgroup ipxSdk C++ SDK
+ * \ingroup publicAPIs
+ * \brief Header-only C++17 layer over the plugin API
+ *
+ * The SDK provides non-owning views of IPFIX Messages and Data Records, compile-time descriptors
+ * of Information Elements (see ::ipx::ie) and an accessor with per-template cache of field
+ * positions (::ipx::Accessor). It doesn't replace the C API, i.e. the underlying structures
+ * are always available.
+ *
+ * Example of an output plugin:
+ * \code{.cpp}
+ * #include <ipfixcol2/sdk.hpp>
+ *
+ * class Counter {
+ * public:
+ *     Counter(ipx::Context ctx, const char *params) : m_ctx(ctx) {(void) params;}
+ *     ~Counter() {IPX_CTX_INFO(m_ctx.raw(), "Total bytes: %" PRIu64, m_total);}
+ *
+ *     int process(ipx::Context ctx, ipx_msg_t *msg) {
+ *         (void) ctx;
+ *         for (ipx::Record rec : ipx::IpfixMessage(msg)) {
+ *             m_total += m_acc.get(rec, m_bytes).value_or(0);
+ *         }
+ *         return IPX_OK;
+ *     }
+ *
+ * private:
+ *     ipx::Context m_ctx;
+ *     ipx::Accessor<> m_acc;
+ *     const ipx::Handle<uint64_t> m_bytes = m_acc.add(ipx::ie::iana::octetDeltaCount);
+ *     uint64_t m_total = 0;
+ * };
+ *
+ * IPX_API struct ipx_plugin_info ipx_plugin_info = {
+ *     "counter", "Byte counter", IPX_PT_OUTPUT, 0, "1.0.0", "2.1.0"
+ * };
+ * IPX_SDK_PLUGIN(Counter)
+ * \endcode
+ */
+
+#include <ipfixcol2.h>
+#include <ipfixcol2/sdk/field.hpp>
+#include <ipfixcol2/sdk/message.hpp>
+#include <ipfixcol2/sdk/accessor.hpp>
+#include <ipfixcol2/sdk/plugin.hpp>
+
+#endif // IPX_SDK_HPP
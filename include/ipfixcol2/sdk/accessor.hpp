@@ -0,0 +1,286 @@
+/**
+ * \file include/ipfixcol2/sdk/accessor.hpp
+ * \author agent <agent@local>
+ * \brief C++ SDK: cached access to fields of Data Records (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_SDK_ACCESSOR_HPP
+#define IPX_SDK_ACCESSOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+
+#include <ipfixcol2/sdk/field.hpp>
+#include <ipfixcol2/sdk/message.hpp>
+
+namespace ipx {
+
+/**
+ * \addtogroup ipxSdk
+ * @{
+ */
+
+/**
+ * \brief Typed handle of a field registered in an accessor
+ * \tparam T Type of the value
+ */
+template <typename T>
+class Handle {
+public:
+    /** \brief Descriptor of the field                                    */
+    const Field<T> &
+    field() const noexcept {return m_field;}
+
+private:
+    template <size_t, size_t> friend class Accessor;
+    constexpr Handle(size_t idx, const Field<T> &field) noexcept : m_idx(idx), m_field(field) {}
+
+    /** Index of the field in the accessor                                */
+    size_t m_idx;
+    /** Descriptor of the field                                           */
+    Field<T> m_field;
+};
+
+/**
+ * \brief Accessor of fields with per-template cache of positions
+ *
+ * Fields of interest are registered in advance (usually in the constructor of a plugin).
+ * When a record is accessed for the first time, positions of all registered fields in its
+ * template are resolved and stored in a small direct-mapped table. Following records with the
+ * same template use the cached positions, i.e. fields with known offset are read directly
+ * without any lookup. Fields with unknown offset (i.e. placed after a variable-length field)
+ * are searched in the record. The accessor never allocates memory after registration.
+ *
+ * \code{.cpp}
+ * ipx::Accessor<> acc;
+ * const auto bytes = acc.add(ipx::ie::iana::octetDeltaCount);
+ * const auto src = acc.add(ipx::ie::iana::sourceIPv4Address);
+ *
+ * for (ipx::Record rec : ipx::IpfixMessage(msg)) {
+ *     uint64_t value;
+ *     if (acc.get(rec, bytes, value)) {
+ *         // ...
+ *     }
+ * }
+ * \endcode
+ *
+ * \warning Cached positions are valid only within the currently processed IPFIX Message
+ *   (templates can be freed after the message is processed). The cache is invalidated
+ *   automatically when a new ::ipx::IpfixMessage view is created. If records are accessed
+ *   without the view, reset() MUST be called for each new message.
+ * \tparam MaxFields Maximum number of registered fields
+ * \tparam Slots     Number of cached templates
+ */
+template <size_t MaxFields = 16, size_t Slots = 8>
+class Accessor {
+public:
+    static_assert(MaxFields > 0 && Slots > 0, "Invalid size of the accessor");
+
+    /**
+     * \brief Register a field
+     * \param[in] field Descriptor of the field
+     * \throw std::length_error if the maximum number of fields has been reached
+     * \return Handle of the field
+     */
+    template <typename T>
+    Handle<T>
+    add(const Field<T> &field)
+    {
+        if (m_cnt == MaxFields) {
+            throw std::length_error("Too many fields registered in an accessor");
+        }
+
+        m_keys[m_cnt] = Key{field.pen, field.id};
+        reset();
+        return Handle<T>(m_cnt++, field);
+    }
+
+    /**
+     * \brief Invalidate all cached positions
+     */
+    void
+    reset() noexcept
+    {
+        for (auto &slot : m_slots) {
+            slot.tmplt = nullptr;
+        }
+    }
+
+    /**
+     * \brief Get a value of a field
+     * \param[in]  rec    Data Record
+     * \param[in]  handle Handle of the field
+     * \param[out] value  Value of the first occurrence of the field
+     * \return True on success. False if the field is missing or cannot be converted.
+     */
+    template <typename T>
+    bool
+    get(const Record &rec, const Handle<T> &handle, T &value) noexcept
+    {
+        const Pos &pos = slot_get(rec.tmplt()).pos[handle.m_idx];
+        switch (pos.mode) {
+        case Mode::MISSING:
+            return false;
+        case Mode::DIRECT:
+            return detail::value_get(rec.data() + pos.offset, pos.length, handle.m_field.type,
+                value);
+        case Mode::SEARCH:
+        default:
+            break;
+        }
+
+        struct fds_drec_field info;
+        if (fds_drec_find(&rec.drec(), handle.m_field.pen, handle.m_field.id, &info) == FDS_EOC) {
+            return false;
+        }
+        return detail::value_get(info.data, info.size, handle.m_field.type, value);
+    }
+
+    /**
+     * \brief Get a value of a field
+     * \param[in] rec    Data Record
+     * \param[in] handle Handle of the field
+     * \return Value of the first occurrence of the field or std::nullopt
+     */
+    template <typename T>
+    std::optional<T>
+    get(const Record &rec, const Handle<T> &handle) noexcept
+    {
+        T value;
+        if (!get(rec, handle, value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /**
+     * \brief Check if a field is present in a record
+     * \param[in] rec    Data Record
+     * \param[in] handle Handle of the field
+     */
+    template <typename T>
+    bool
+    has(const Record &rec, const Handle<T> &handle) noexcept
+    {
+        return slot_get(rec.tmplt()).pos[handle.m_idx].mode != Mode::MISSING;
+    }
+
+private:
+    /** Identification of a field                                         */
+    struct Key {
+        uint32_t pen;
+        uint16_t id;
+    };
+
+    /** Access mode of a field                                            */
+    enum class Mode : uint8_t {
+        MISSING,  ///< The field is not present in the template
+        DIRECT,   ///< The offset and size of the field are known
+        SEARCH    ///< The field must be searched in the record
+    };
+
+    /** Position of a field in a template                                 */
+    struct Pos {
+        uint16_t offset;
+        uint16_t length;
+        Mode mode;
+    };
+
+    /** Cached positions of all fields in a template                      */
+    struct Slot {
+        const struct fds_template *tmplt = nullptr;
+        uint64_t generation = 0;
+        std::array<Pos, MaxFields> pos;
+    };
+
+    /** Registered fields                                                 */
+    std::array<Key, MaxFields> m_keys;
+    /** Number of registered fields                                       */
+    size_t m_cnt = 0;
+    /** Cached templates                                                  */
+    std::array<Slot, Slots> m_slots;
+
+    /**
+     * \brief Get cached positions of fields in a template
+     *
+     * If the template is not cached, positions are resolved and replace the previous content
+     * of the slot.
+     * \param[in] tmplt Template
+     */
+    const Slot &
+    slot_get(const struct fds_template *tmplt) noexcept
+    {
+        const uintptr_t hash = reinterpret_cast<uintptr_t>(tmplt) / alignof(struct fds_template);
+        Slot &slot = m_slots[hash % Slots];
+        if (slot.tmplt == tmplt && slot.generation == detail::msg_generation) {
+            return slot;
+        }
+
+        slot.tmplt = tmplt;
+        slot.generation = detail::msg_generation;
+        for (size_t i = 0; i < m_cnt; ++i) {
+            Pos &pos = slot.pos[i];
+            pos.mode = Mode::MISSING;
+
+            for (uint16_t f = 0; f < tmplt->fields_cnt_total; ++f) {
+                const struct fds_tfield &field = tmplt->fields[f];
+                if (field.id != m_keys[i].id || field.en != m_keys[i].pen) {
+                    continue;
+                }
+
+                if (field.offset != FDS_IPFIX_VAR_IE_LEN && field.length != FDS_IPFIX_VAR_IE_LEN) {
+                    pos.mode = Mode::DIRECT;
+                    pos.offset = field.offset;
+                    pos.length = field.length;
+                } else {
+                    pos.mode = Mode::SEARCH;
+                }
+                break;
+            }
+        }
+
+        return slot;
+    }
+};
+
+/**@}*/
+} // namespace ipx
+
+#endif // IPX_SDK_ACCESSOR_HPP
@@ -0,0 +1,278 @@
+/**
+ * \file include/ipfixcol2/sdk/field.hpp
+ * \author agent <agent@local>
+ * \brief C++ SDK: descriptors of Information Elements and value conversion (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_SDK_FIELD_HPP
+#define IPX_SDK_FIELD_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include <endian.h>
+#include <libfds.h>
+
+namespace ipx {
+
+/**
+ * \addtogroup ipxSdk
+ * @{
+ */
+
+/** IPv4 address (network byte order)                                      */
+using ip4_t = std::array<uint8_t, 4>;
+/** IPv6 address (network byte order)                                      */
+using ip6_t = std::array<uint8_t, 16>;
+/** MAC address                                                            */
+using mac_t = std::array<uint8_t, 6>;
+/** Timestamp (seconds and nanoseconds since the UNIX epoch)               */
+using timestamp_t = struct timespec;
+
+/**
+ * \brief Compile-time descriptor of an Information Element
+ *
+ * The descriptor identifies the element and defines the C++ type of its value. Supported
+ * types are unsigned and signed integers, float, double, bool, ::ipx::ip4_t, ::ipx::ip6_t,
+ * ::ipx::mac_t, ::ipx::timestamp_t and std::string_view (strings and octet arrays, the view
+ * refers to the record).
+ * \tparam T Type of the value
+ */
+template <typename T>
+struct Field {
+    /** Private Enterprise Number                                           */
+    uint32_t pen;
+    /** Information Element ID                                              */
+    uint16_t id;
+    /** IPFIX data type (required for conversion of timestamps)             */
+    enum fds_iemgr_element_type type;
+};
+
+/**
+ * \brief Get a descriptor of a reverse element of a biflow record
+ * \note Only for IANA elements (reverse elements are defined by RFC 5103)
+ * \param[in] field Descriptor of a forward IANA element
+ */
+template <typename T>
+constexpr Field<T>
+reverse(const Field<T> &field)
+{
+    return Field<T>{29305U, field.id, field.type};
+}
+
+namespace detail {
+
+/** \brief Helper for static assertions in templates */
+template <typename T>
+struct always_false : std::false_type {};
+
+/** \brief Check if the type is an array of bytes */
+template <typename T>
+struct is_byte_array : std::false_type {};
+template <size_t N>
+struct is_byte_array<std::array<uint8_t, N>> : std::true_type {};
+
+/**
+ * \brief Load an unsigned integer with native size in network byte order
+ * \tparam T Unsigned integer type
+ */
+template <typename T>
+inline T
+load_be(const uint8_t *data) noexcept
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    if constexpr (sizeof(T) == 2) {
+        return static_cast<T>(be16toh(value));
+    } else if constexpr (sizeof(T) == 4) {
+        return static_cast<T>(be32toh(value));
+    } else if constexpr (sizeof(T) == 8) {
+        return static_cast<T>(be64toh(value));
+    } else {
+        return value;
+    }
+}
+
+/**
+ * \brief Convert a value of a field
+ *
+ * Integers encoded with the native size are loaded directly, other sizes (i.e. reduced-size
+ * encoding) are converted using libfds functions.
+ * \param[in]  data  Pointer to the field
+ * \param[in]  size  Size of the field
+ * \param[in]  type  IPFIX data type of the field
+ * \param[out] out   Converted value
+ * \return True on success. False if the value cannot be converted (e.g. it doesn't fit into
+ *   the type).
+ */
+template <typename T>
+inline bool
+value_get(const uint8_t *data, uint16_t size, enum fds_iemgr_element_type type, T &out) noexcept
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        (void) type;
+        return fds_get_bool(data, size, &out) == FDS_OK;
+    } else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>) {
+        (void) type;
+        if (size == sizeof(T)) {
+            out = load_be<T>(data);
+            return true;
+        }
+
+        uint64_t value;
+        if (fds_get_uint_be(data, size, &value) != FDS_OK
+                || value > std::numeric_limits<T>::max()) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    } else if constexpr (std::is_integral_v<T>) {
+        (void) type;
+        if (size == sizeof(T)) {
+            out = static_cast<T>(load_be<std::make_unsigned_t<T>>(data));
+            return true;
+        }
+
+        int64_t value;
+        if (fds_get_int_be(data, size, &value) != FDS_OK
+                || value < std::numeric_limits<T>::min()
+                || value > std::numeric_limits<T>::max()) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        (void) type;
+        double value;
+        if (fds_get_float_be(data, size, &value) != FDS_OK) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        (void) type;
+        out = std::string_view(reinterpret_cast<const char *>(data), size);
+        return true;
+    } else if constexpr (std::is_same_v<T, timestamp_t>) {
+        return fds_get_datetime_hp_be(data, size, type, &out) == FDS_OK;
+    } else if constexpr (is_byte_array<T>::value) {
+        (void) type;
+        if (size != out.size()) {
+            return false;
+        }
+        std::memcpy(out.data(), data, out.size());
+        return true;
+    } else {
+        static_assert(always_false<T>::value, "Unsupported type of a field value");
+    }
+}
+
+} // namespace detail
+
+/**
+ * \brief Descriptors of common Information Elements
+ */
+namespace ie {
+/** \brief IANA Information Elements (see RFC 7012 and IANA IPFIX registry) */
+namespace iana {
+constexpr Field<uint64_t>    octetDeltaCount          {0,   1, FDS_ET_UNSIGNED_64};
+constexpr Field<uint64_t>    packetDeltaCount         {0,   2, FDS_ET_UNSIGNED_64};
+constexpr Field<uint64_t>    deltaFlowCount           {0,   3, FDS_ET_UNSIGNED_64};
+constexpr Field<uint8_t>     protocolIdentifier       {0,   4, FDS_ET_UNSIGNED_8};
+constexpr Field<uint8_t>     ipClassOfService         {0,   5, FDS_ET_UNSIGNED_8};
+constexpr Field<uint16_t>    tcpControlBits           {0,   6, FDS_ET_UNSIGNED_16};
+constexpr Field<uint16_t>    sourceTransportPort      {0,   7, FDS_ET_UNSIGNED_16};
+constexpr Field<ip4_t>       sourceIPv4Address        {0,   8, FDS_ET_IPV4_ADDRESS};
+constexpr Field<uint8_t>     sourceIPv4PrefixLength   {0,   9, FDS_ET_UNSIGNED_8};
+constexpr Field<uint32_t>    ingressInterface         {0,  10, FDS_ET_UNSIGNED_32};
+constexpr Field<uint16_t>    destinationTransportPort {0,  11, FDS_ET_UNSIGNED_16};
+constexpr Field<ip4_t>       destinationIPv4Address   {0,  12, FDS_ET_IPV4_ADDRESS};
+constexpr Field<uint8_t>     destinationIPv4PrefixLength {0, 13, FDS_ET_UNSIGNED_8};
+constexpr Field<uint32_t>    egressInterface          {0,  14, FDS_ET_UNSIGNED_32};
+constexpr Field<ip4_t>       ipNextHopIPv4Address     {0,  15, FDS_ET_IPV4_ADDRESS};
+constexpr Field<uint32_t>    bgpSourceAsNumber        {0,  16, FDS_ET_UNSIGNED_32};
+constexpr Field<uint32_t>    bgpDestinationAsNumber   {0,  17, FDS_ET_UNSIGNED_32};
+constexpr Field<uint32_t>    flowEndSysUpTime         {0,  21, FDS_ET_UNSIGNED_32};
+constexpr Field<uint32_t>    flowStartSysUpTime       {0,  22, FDS_ET_UNSIGNED_32};
+constexpr Field<ip6_t>       sourceIPv6Address        {0,  27, FDS_ET_IPV6_ADDRESS};
+constexpr Field<ip6_t>       destinationIPv6Address   {0,  28, FDS_ET_IPV6_ADDRESS};
+constexpr Field<uint8_t>     sourceIPv6PrefixLength   {0,  29, FDS_ET_UNSIGNED_8};
+constexpr Field<uint8_t>     destinationIPv6PrefixLength {0, 30, FDS_ET_UNSIGNED_8};
+constexpr Field<uint32_t>    flowLabelIPv6            {0,  31, FDS_ET_UNSIGNED_32};
+constexpr Field<uint16_t>    icmpTypeCodeIPv4         {0,  32, FDS_ET_UNSIGNED_16};
+constexpr Field<uint32_t>    samplingInterval         {0,  34, FDS_ET_UNSIGNED_32};
+constexpr Field<uint8_t>     samplingAlgorithm        {0,  35, FDS_ET_UNSIGNED_8};
+constexpr Field<mac_t>       sourceMacAddress         {0,  56, FDS_ET_MAC_ADDRESS};
+constexpr Field<uint16_t>    vlanId                   {0,  58, FDS_ET_UNSIGNED_16};
+constexpr Field<uint8_t>     ipVersion                {0,  60, FDS_ET_UNSIGNED_8};
+constexpr Field<uint8_t>     flowDirection            {0,  61, FDS_ET_UNSIGNED_8};
+constexpr Field<ip6_t>       ipNextHopIPv6Address     {0,  62, FDS_ET_IPV6_ADDRESS};
+constexpr Field<mac_t>       destinationMacAddress    {0,  80, FDS_ET_MAC_ADDRESS};
+constexpr Field<uint64_t>    octetTotalCount          {0,  85, FDS_ET_UNSIGNED_64};
+constexpr Field<uint64_t>    packetTotalCount         {0,  86, FDS_ET_UNSIGNED_64};
+constexpr Field<std::string_view> applicationId       {0,  95, FDS_ET_OCTET_ARRAY};
+constexpr Field<uint8_t>     flowEndReason            {0, 136, FDS_ET_UNSIGNED_8};
+constexpr Field<uint16_t>    icmpTypeCodeIPv6         {0, 139, FDS_ET_UNSIGNED_16};
+constexpr Field<uint32_t>    exportingProcessId       {0, 144, FDS_ET_UNSIGNED_32};
+constexpr Field<uint64_t>    flowId                   {0, 148, FDS_ET_UNSIGNED_64};
+constexpr Field<uint32_t>    observationDomainId      {0, 149, FDS_ET_UNSIGNED_32};
+constexpr Field<timestamp_t> flowStartSeconds         {0, 150, FDS_ET_DATE_TIME_SECONDS};
+constexpr Field<timestamp_t> flowEndSeconds           {0, 151, FDS_ET_DATE_TIME_SECONDS};
+constexpr Field<timestamp_t> flowStartMilliseconds    {0, 152, FDS_ET_DATE_TIME_MILLISECONDS};
+constexpr Field<timestamp_t> flowEndMilliseconds      {0, 153, FDS_ET_DATE_TIME_MILLISECONDS};
+constexpr Field<timestamp_t> flowStartMicroseconds    {0, 154, FDS_ET_DATE_TIME_MICROSECONDS};
+constexpr Field<timestamp_t> flowEndMicroseconds      {0, 155, FDS_ET_DATE_TIME_MICROSECONDS};
+constexpr Field<timestamp_t> flowStartNanoseconds     {0, 156, FDS_ET_DATE_TIME_NANOSECONDS};
+constexpr Field<timestamp_t> flowEndNanoseconds       {0, 157, FDS_ET_DATE_TIME_NANOSECONDS};
+constexpr Field<uint8_t>     ipTTL                    {0, 192, FDS_ET_UNSIGNED_8};
+constexpr Field<uint32_t>    ingressVRFID             {0, 234, FDS_ET_UNSIGNED_32};
+constexpr Field<uint32_t>    egressVRFID              {0, 235, FDS_ET_UNSIGNED_32};
+constexpr Field<uint8_t>     biflowDirection          {0, 239, FDS_ET_UNSIGNED_8};
+constexpr Field<uint64_t>    selectorId               {0, 302, FDS_ET_UNSIGNED_64};
+} // namespace iana
+} // namespace ie
+
+/**@}*/
+} // namespace ipx
+
+#endif // IPX_SDK_FIELD_HPP
@@ -0,0 +1,238 @@
+/**
+ * \file include/ipfixcol2/sdk/message.hpp
+ * \author agent <agent@local>
+ * \brief C++ SDK: views of messages and records (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_SDK_MESSAGE_HPP
+#define IPX_SDK_MESSAGE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+
+#include <ipfixcol2.h>
+#include <ipfixcol2/sdk/field.hpp>
+
+namespace ipx {
+
+/**
+ * \addtogroup ipxSdk
+ * @{
+ */
+
+/** \brief Deleter of owned messages                                       */
+struct MessageDeleter {
+    void operator()(ipx_msg_t *msg) const noexcept {ipx_msg_destroy(msg);}
+};
+
+/**
+ * \brief Owning pointer to a message
+ *
+ * The message is destroyed automatically unless it is released (e.g. passed to the next plugin
+ * using Context::pass()).
+ */
+using MessagePtr = std::unique_ptr<ipx_msg_t, MessageDeleter>;
+
+namespace detail {
+/**
+ * \brief Generation of the currently processed IPFIX Message
+ *
+ * The value is changed whenever a new view of an IPFIX Message is created. Cached positions
+ * of fields (see ::ipx::Accessor) are valid only within a single generation because templates
+ * referenced by records can be freed after the message is processed.
+ */
+inline thread_local uint64_t msg_generation = 0;
+} // namespace detail
+
+/**
+ * \brief Non-owning view of a Data Record
+ */
+class Record {
+public:
+    /**
+     * \brief Create a view
+     * \param[in] rec Data Record of an IPFIX Message
+     */
+    explicit Record(struct ipx_ipfix_record *rec) noexcept : m_rec(rec) {}
+
+    /** \brief Get the underlying record (including extensions)          */
+    struct ipx_ipfix_record *
+    raw() const noexcept {return m_rec;}
+    /** \brief Get the libfds record                                     */
+    struct fds_drec &
+    drec() const noexcept {return m_rec->rec;}
+    /** \brief Get the template of the record                            */
+    const struct fds_template *
+    tmplt() const noexcept {return m_rec->rec.tmplt;}
+    /** \brief Check if the record is described by an Options Template   */
+    bool
+    is_options() const noexcept {return m_rec->rec.tmplt->type == FDS_TYPE_TEMPLATE_OPTS;}
+    /** \brief Get the raw data of the record                            */
+    const uint8_t *
+    data() const noexcept {return m_rec->rec.data;}
+    /** \brief Get the size of the record                                */
+    uint16_t
+    size() const noexcept {return m_rec->rec.size;}
+
+    /**
+     * \brief Find a field and convert its value
+     *
+     * The field is searched in the record every time the function is called. For repeated
+     * access to the same fields of many records prefer ::ipx::Accessor.
+     * \param[in] field Descriptor of the field
+     * \return Value of the first occurrence of the field or std::nullopt (the field is missing
+     *   or cannot be converted)
+     */
+    template <typename T>
+    std::optional<T>
+    get(const Field<T> &field) const noexcept
+    {
+        struct fds_drec_field info;
+        T value;
+        if (fds_drec_find(&m_rec->rec, field.pen, field.id, &info) == FDS_EOC
+                || !detail::value_get(info.data, info.size, field.type, value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+private:
+    /** Data Record                                                      */
+    struct ipx_ipfix_record *m_rec;
+};
+
+/**
+ * \brief Non-owning view of an IPFIX Message
+ *
+ * The view provides iteration over all Data Records of the message.
+ * \code{.cpp}
+ * for (ipx::Record rec : ipx::IpfixMessage(msg)) {
+ *     // ...
+ * }
+ * \endcode
+ */
+class IpfixMessage {
+public:
+    /** \brief Iterator over Data Records                                 */
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Record;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Record;
+
+        iterator(ipx_msg_ipfix_t *msg, uint32_t idx) noexcept : m_msg(msg), m_idx(idx) {}
+
+        Record
+        operator*() const noexcept {return Record(ipx_msg_ipfix_get_drec(m_msg, m_idx));}
+        iterator &
+        operator++() noexcept {++m_idx; return *this;}
+        iterator
+        operator++(int) noexcept {iterator tmp = *this; ++m_idx; return tmp;}
+        bool
+        operator==(const iterator &other) const noexcept {return m_idx == other.m_idx;}
+        bool
+        operator!=(const iterator &other) const noexcept {return m_idx != other.m_idx;}
+
+    private:
+        ipx_msg_ipfix_t *m_msg;
+        uint32_t m_idx;
+    };
+
+    /**
+     * \brief Create a view
+     * \param[in] msg IPFIX Message
+     */
+    explicit IpfixMessage(ipx_msg_ipfix_t *msg) noexcept
+        : m_msg(msg), m_cnt(ipx_msg_ipfix_get_drec_cnt(msg))
+    {
+        ++detail::msg_generation;
+    }
+
+    /**
+     * \brief Create a view
+     * \param[in] msg Base message (MUST be an IPFIX Message)
+     */
+    explicit IpfixMessage(ipx_msg_t *msg) noexcept : IpfixMessage(ipx_msg_base2ipfix(msg)) {}
+
+    /** \brief Get the underlying message                                */
+    ipx_msg_ipfix_t *
+    raw() const noexcept {return m_msg;}
+    /** \brief Get the number of Data Records                            */
+    uint32_t
+    size() const noexcept {return m_cnt;}
+    /** \brief Get a Data Record (the index MUST be less than size())    */
+    Record
+    operator[](uint32_t idx) const noexcept {return Record(ipx_msg_ipfix_get_drec(m_msg, idx));}
+    /** \brief Get the flow key and timestamps of a Data Record (or nullptr) */
+    const struct ipx_flow_info *
+    flow_info(uint32_t idx) const noexcept {return ipx_msg_ipfix_get_flow_info(m_msg, idx);}
+    /** \brief Get the first Data Record                                 */
+    iterator
+    begin() const noexcept {return iterator(m_msg, 0);}
+    /** \brief Get the end of Data Records                               */
+    iterator
+    end() const noexcept {return iterator(m_msg, m_cnt);}
+
+    /** \brief Get the IPFIX Message header                              */
+    const struct fds_ipfix_msg_hdr *
+    header() const noexcept
+    {
+        return reinterpret_cast<const struct fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(m_msg));
+    }
+    /** \brief Get the Transport Session                                 */
+    const struct ipx_session *
+    session() const noexcept {return ipx_msg_ipfix_get_ctx(m_msg)->session;}
+    /** \brief Get the Observation Domain ID                             */
+    uint32_t
+    odid() const noexcept {return ipx_msg_ipfix_get_ctx(m_msg)->odid;}
+
+private:
+    /** IPFIX Message                                                    */
+    ipx_msg_ipfix_t *m_msg;
+    /** Number of Data Records                                           */
+    uint32_t m_cnt;
+};
+
+/**@}*/
+} // namespace ipx
+
+#endif // IPX_SDK_MESSAGE_HPP
@@ -0,0 +1,242 @@
+/**
+ * \file include/ipfixcol2/sdk/plugin.hpp
+ * \author agent <agent@local>
+ * \brief C++ SDK: plugin context and entry points (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_SDK_PLUGIN_HPP
+#define IPX_SDK_PLUGIN_HPP
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include <ipfixcol2.h>
+#include <ipfixcol2/sdk/message.hpp>
+
+namespace ipx {
+
+/**
+ * \addtogroup ipxSdk
+ * @{
+ */
+
+/**
+ * \brief Non-owning wrapper of a plugin context
+ */
+class Context {
+public:
+    /**
+     * \brief Create a wrapper
+     * \param[in] ctx Plugin context
+     */
+    explicit Context(ipx_ctx_t *ctx) noexcept : m_ctx(ctx) {}
+
+    /** \brief Get the underlying context (e.g. for logging macros)     */
+    ipx_ctx_t *
+    raw() const noexcept {return m_ctx;}
+    /** \brief Get the name of the instance                              */
+    const char *
+    name() const noexcept {return ipx_ctx_name_get(m_ctx);}
+    /** \brief Get the manager of Information Elements                   */
+    const fds_iemgr_t *
+    iemgr() const noexcept {return ipx_ctx_iemgr_get(m_ctx);}
+
+    /**
+     * \brief Pass a message to the successor of the instance
+     * \param[in] msg Message
+     * \throw std::runtime_error if the message cannot be passed (the message is destroyed)
+     */
+    void
+    pass(MessagePtr msg) const
+    {
+        if (ipx_ctx_msg_pass(m_ctx, msg.get()) != IPX_OK) {
+            throw std::runtime_error("Failed to pass a message");
+        }
+        msg.release();
+    }
+
+    /**
+     * \brief Change message subscription
+     * \param[in] mask Message types (bitwise OR of ::ipx_msg_type)
+     * \throw std::runtime_error if the mask cannot be installed
+     */
+    void
+    subscribe(ipx_msg_mask_t mask) const
+    {
+        if (ipx_ctx_subscribe(m_ctx, &mask, nullptr) != IPX_OK) {
+            throw std::runtime_error("Failed to change message subscription");
+        }
+    }
+
+    /**
+     * \brief Request periodic ticks (only within the constructor of the plugin)
+     *
+     * The plugin must also define the tick entry point (see #IPX_SDK_PLUGIN_TICK).
+     * \param[in] interval Interval between ticks in milliseconds (0 == disabled)
+     * \throw std::runtime_error if ticks cannot be requested
+     */
+    void
+    tick_set(uint32_t interval) const
+    {
+        if (ipx_ctx_tick_set(m_ctx, interval) != IPX_OK) {
+            throw std::runtime_error("Failed to request periodic ticks");
+        }
+    }
+
+private:
+    /** Plugin context                                                    */
+    ipx_ctx_t *m_ctx;
+};
+
+namespace detail {
+
+/** \brief Report an exception caught in a plugin callback              */
+inline void
+plugin_exception(ipx_ctx_t *ctx) noexcept
+{
+    try {
+        throw;
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "%s", ex.what());
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unexpected exception has occurred!", '\0');
+    }
+}
+
+/** \brief Implementation of ipx_plugin_init()                          */
+template <typename Plugin>
+inline int
+plugin_init(ipx_ctx_t *ctx, const char *params) noexcept
+{
+    try {
+        Plugin *instance = new Plugin(Context(ctx), params);
+        ipx_ctx_private_set(ctx, instance);
+    } catch (...) {
+        plugin_exception(ctx);
+        return IPX_ERR_DENIED;
+    }
+    return IPX_OK;
+}
+
+/** \brief Implementation of ipx_plugin_destroy()                       */
+template <typename Plugin>
+inline void
+plugin_destroy(ipx_ctx_t *ctx, void *cfg) noexcept
+{
+    try {
+        delete reinterpret_cast<Plugin *>(cfg);
+    } catch (...) {
+        plugin_exception(ctx);
+    }
+}
+
+/** \brief Implementation of ipx_plugin_process()                       */
+template <typename Plugin>
+inline int
+plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg) noexcept
+{
+    try {
+        return reinterpret_cast<Plugin *>(cfg)->process(Context(ctx), msg);
+    } catch (...) {
+        plugin_exception(ctx);
+        return IPX_ERR_DENIED;
+    }
+}
+
+/** \brief Implementation of ipx_plugin_tick()                          */
+template <typename Plugin>
+inline void
+plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now) noexcept
+{
+    try {
+        reinterpret_cast<Plugin *>(cfg)->tick(Context(ctx), *now);
+    } catch (...) {
+        plugin_exception(ctx);
+    }
+}
+
+} // namespace detail
+
+/**@}*/
+} // namespace ipx
+
+/**
+ * \brief Define entry points of a plugin implemented by a class
+ *
+ * The class must provide a constructor `Plugin(ipx::Context ctx, const char *params)` and
+ * a member function `int process(ipx::Context ctx, ipx_msg_t *msg)`. The instance is destroyed
+ * by its destructor. Exceptions thrown by the constructor and process() are reported and
+ * converted to #IPX_ERR_DENIED. The plugin description (::ipx_plugin_info) must be defined
+ * separately.
+ * \ingroup ipxSdk
+ */
+#define IPX_SDK_PLUGIN(Plugin)                                                     \
+    int                                                                            \
+    ipx_plugin_init(ipx_ctx_t *ctx, const char *params)                            \
+    {                                                                              \
+        return ::ipx::detail::plugin_init<Plugin>(ctx, params);                    \
+    }                                                                              \
+    void                                                                           \
+    ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)                                  \
+    {                                                                              \
+        ::ipx::detail::plugin_destroy<Plugin>(ctx, cfg);                           \
+    }                                                                              \
+    int                                                                            \
+    ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)                  \
+    {                                                                              \
+        return ::ipx::detail::plugin_process<Plugin>(ctx, cfg, msg);               \
+    }
+
+
+/**
+ * \brief Define the periodic tick entry point of a plugin implemented by a class
+ *
+ * The class must provide a member function `void tick(ipx::Context ctx, const timespec &now)`
+ * and request ticks in its constructor (see ipx::Context::tick_set()). Exceptions thrown by
+ * the function are reported.
+ * \ingroup ipxSdk
+ */
+#define IPX_SDK_PLUGIN_TICK(Plugin)                                                \
+    void                                                                           \
+    ipx_plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now)         \
+    {                                                                              \
+        ::ipx::detail::plugin_tick<Plugin>(ctx, cfg, now);                         \
+    }
+
+#endif // IPX_SDK_PLUGIN_HPP
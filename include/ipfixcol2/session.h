@@ -185,6 +185,23 @@ ipx_session_new_tcp(const struct ipx_session_net *net);
 IPX_API struct ipx_session *
 ipx_session_new_udp(const struct ipx_session_net *net, uint16_t lf_data, uint16_t lf_opts);
 
+/**
+ * \brief Create a new UDP Transport Session structure with a user defined identification
+ *
+ * Same as ipx_session_new_udp(), however, the identification of the session (i.e. the ident
+ * field) is a copy of the given string instead of the source address and port. It is useful
+ * for exporters that are not identified by a network address (e.g. local processes).
+ * \param[in] net     User defined network configuration
+ * \param[in] ident   Identification of the session (cannot be empty)
+ * \param[in] lf_data Template lifetime
+ * \param[in] lf_opts Options Template lifetime
+ * \return On success returns a pointer to newly allocated structure.
+ * \return On failure (usually a memory allocation error) returns NULL.
+ */
+IPX_API struct ipx_session *
+ipx_session_new_udp_named(const struct ipx_session_net *net, const char *ident, uint16_t lf_data,
+    uint16_t lf_opts);
+
 /**
  * \brief Create a new SCTP Transport Session structure
  * \param[in] net User defined network configuration
@@ -39,10 +39,12 @@
  *
  */
 
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
 #include <memory>
+#include <utility>
 
 #include <libfds.h>
 #include <iostream>
@@ -56,6 +58,7 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <sched.h>
 
 extern "C" {
 #include "../utils.h"
@@ -80,6 +83,7 @@ enum file_xml_nodes {
     IN_PLUGIN_PLUGIN,
     IN_PLUGIN_PARAMS,
     IN_PLUGIN_VERBOSITY,
+    IN_PLUGIN_REPLICATION,
     // Intermediate plugin parameters
     INTER_PLUGIN_NAME,
     INTER_PLUGIN_PLUGIN,
@@ -92,6 +96,27 @@ enum file_xml_nodes {
     OUT_PLUGIN_VERBOSITY,
     OUT_PLUGIN_ODID_ONLY,
     OUT_PLUGIN_ODID_EXCEPT,
+    // Low-latency mode
+    LATENCY_MODE,
+    LATENCY_BUSY_POLL,
+    LATENCY_RT_PRIO,
+    LATENCY_CPUS,
+    // Branches of the pipeline
+    BRANCH,
+    BRANCH_NAME,
+    // Attribution of processing cost
+    COST,
+    COST_SAMPLING,
+    COST_TOP,
+    COST_INTERVAL,
+    // Tracing of messages
+    TRACE,
+    TRACE_SAMPLING,
+    TRACE_BUFFER_SIZE,
+    TRACE_FILE,
+    // Live tap of Data Records
+    TAP,
+    TAP_SOCKET,
 };
 
 /**
@@ -103,6 +128,7 @@ static const struct fds_xml_args args_instance_input[] = {
     FDS_OPTS_ELEM(IN_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( IN_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
+    FDS_OPTS_RAW( IN_PLUGIN_REPLICATION, "replication",                 FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -156,6 +182,47 @@ static const struct fds_xml_args args_list_output[] = {
     FDS_OPTS_END
 };
 
+/**
+ * \brief Definition of the \<branch\> node
+ * \note The configurator checks later if at least one output instance is present
+ */
+static const struct fds_xml_args args_branch[] = {
+    FDS_OPTS_ELEM(BRANCH_NAME,  "name",                FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(LIST_INTER,  "intermediatePlugins", args_list_inter,  FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(LIST_OUTPUT, "outputPlugins",       args_list_output, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<latencyMode\> node                                                      */
+static const struct fds_xml_args args_latency[] = {
+    FDS_OPTS_ELEM(LATENCY_BUSY_POLL, "busyPoll",         FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(LATENCY_RT_PRIO,   "realtimePriority", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(LATENCY_CPUS,      "cpus",             FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<costAttribution\> node                                                 */
+static const struct fds_xml_args args_cost[] = {
+    FDS_OPTS_ELEM(COST_SAMPLING, "sampling", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(COST_TOP,      "top",      FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(COST_INTERVAL, "interval", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<tracing\> node                                                         */
+static const struct fds_xml_args args_trace[] = {
+    FDS_OPTS_ELEM(TRACE_SAMPLING,    "sampling",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(TRACE_BUFFER_SIZE, "bufferSize", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(TRACE_FILE,        "file",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<tap\> node                                                             */
+static const struct fds_xml_args args_tap[] = {
+    FDS_OPTS_ELEM(TAP_SOCKET, "socket", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
 /**
  * \brief Definition of the main \<ipfixcol2\> node
  * \note
@@ -167,6 +234,12 @@ static const struct fds_xml_args args_main[] = {
     FDS_OPTS_NESTED(LIST_INPUTS, "inputPlugins",        args_list_inputs, FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(LIST_INTER,  "intermediatePlugins", args_list_inter,  FDS_OPTS_P_OPT),
     FDS_OPTS_NESTED(LIST_OUTPUT, "outputPlugins",       args_list_output, FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(LATENCY_MODE, "latencyMode",        args_latency,     FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(BRANCH,       "branch",             args_branch,
+        FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(COST,         "costAttribution",    args_cost,        FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(TRACE,        "tracing",            args_trace,       FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(TAP,          "tap",                args_tap,         FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -207,6 +280,9 @@ file_parse_instance_input(fds_xml_ctx_t *ctx, ipx_config_model &model)
         case IN_PLUGIN_PARAMS:
             input.params = content->ptr_string;
             break;
+        case IN_PLUGIN_REPLICATION:
+            input.replication = content->ptr_string;
+            break;
         default:
             // Unexpected XML node within <input>!
             assert(false);
@@ -244,14 +320,16 @@ file_parse_list_input(fds_xml_ctx_t *ctx, ipx_config_model &model)
 
 /**
  * \brief Parse \<intermediate\> node and add the parsed intermediate instance to the model
- * \param[in] ctx   Parsed XML node
- * \param[in] model Configuration model
+ * \param[in] ctx    Parsed XML node
+ * \param[in] model  Configuration model
+ * \param[in] branch Branch of the pipeline (empty == the shared part)
  * \throw invalid_argument if the parameters are not valid or missing
  */
 static void
-file_parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
+file_parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &model, const std::string &branch)
 {
     struct ipx_plugin_inter inter;
+    inter.branch = branch;
 
     const struct fds_xml_cont *content;
     while (fds_xml_next(ctx, &content) != FDS_EOC) {
@@ -279,12 +357,13 @@ file_parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
 
 /**
  * \brief Parse \<intermediatePlugins\> node and add the parsed intermediate instances to the model
- * \param[in] ctx   Parsed XML node
- * \param[in] model Configuration model
+ * \param[in] ctx    Parsed XML node
+ * \param[in] model  Configuration model
+ * \param[in] branch Branch of the pipeline (empty == the shared part)
  * \throw invalid_argument if the parameters are not valid or missing
  */
 static void
-file_parse_list_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
+file_parse_list_inter(fds_xml_ctx_t *ctx, ipx_config_model &model, const std::string &branch)
 {
     unsigned int cnt = 0;
     const struct fds_xml_cont *content;
@@ -295,7 +374,7 @@ file_parse_list_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
         cnt++;
 
         try {
-            file_parse_instance_inter(content->ptr_ctx, model);
+            file_parse_instance_inter(content->ptr_ctx, model, branch);
         } catch (std::exception &ex) {
             throw std::runtime_error("Failed to parse the configuration of the "
                 + std::to_string(cnt) + ". intermediate plugin: " + ex.what());
@@ -305,14 +384,16 @@ file_parse_list_inter(fds_xml_ctx_t *ctx, ipx_config_model &model)
 
 /**
  * \brief Parse \<output\> node and add the parsed output instance to the model
- * \param[in] ctx   Parsed XML node
- * \param[in] model Configuration model
+ * \param[in] ctx    Parsed XML node
+ * \param[in] model  Configuration model
+ * \param[in] branch Branch of the pipeline (empty == the shared part)
  * \throw invalid_argument if the parameters are not valid or missing
  */
 static void
-file_parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model &model)
+file_parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model &model, const std::string &branch)
 {
     struct ipx_plugin_output output;
+    output.branch = branch;
     output.odid_type = IPX_ODID_FILTER_NONE; // default
     bool odid_set = false;
 
@@ -358,12 +439,13 @@ file_parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model &model)
 
 /**
  * \brief Parse \<outputPlugins\> node and add the parsed intermediate instances to the model
- * \param[in] ctx   Parsed XML node
- * \param[in] model Configuration model
+ * \param[in] ctx    Parsed XML node
+ * \param[in] model  Configuration model
+ * \param[in] branch Branch of the pipeline (empty == the shared part)
  * \throw invalid_argument if the parameters are not valid or missing
  */
 static void
-file_parse_list_output(fds_xml_ctx_t *ctx, ipx_config_model &model)
+file_parse_list_output(fds_xml_ctx_t *ctx, ipx_config_model &model, const std::string &branch)
 {
     unsigned int cnt = 0;
     const struct fds_xml_cont *content;
@@ -374,7 +456,7 @@ file_parse_list_output(fds_xml_ctx_t *ctx, ipx_config_model &model)
         cnt++;
 
         try {
-            file_parse_instance_output(content->ptr_ctx, model);
+            file_parse_instance_output(content->ptr_ctx, model, branch);
         } catch (std::exception &ex) {
             throw std::runtime_error("Failed to parse the configuration of the "
                 + std::to_string(cnt) + ". output plugin: " + ex.what());
@@ -382,6 +464,240 @@ file_parse_list_output(fds_xml_ctx_t *ctx, ipx_config_model &model)
     }
 }
 
+/**
+ * \brief Parse \<branch\> node and add the branch and its instances to the model
+ * \param[in] ctx   Parsed XML node
+ * \param[in] model Configuration model
+ * \throw invalid_argument if the parameters are not valid or missing
+ */
+static void
+file_parse_branch(fds_xml_ctx_t *ctx, ipx_config_model &model)
+{
+    // The name of the branch can be defined after its instances
+    std::string name;
+    std::vector<std::pair<int, fds_xml_ctx_t *> > lists;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case BRANCH_NAME:
+            name = content->ptr_string;
+            break;
+        case LIST_INTER:
+        case LIST_OUTPUT:
+            lists.emplace_back(content->id, content->ptr_ctx);
+            break;
+        default:
+            // Unexpected XML node within <branch>!
+            assert(false);
+        }
+    }
+
+    model.add_branch(name);
+    for (const auto &list : lists) {
+        if (list.first == LIST_INTER) {
+            file_parse_list_inter(list.second, model, name);
+        } else {
+            file_parse_list_output(list.second, model, name);
+        }
+    }
+}
+
+/**
+ * \brief Parse a list of CPUs (e.g. "2-4, 7")
+ * \param[in] expr List of CPUs (comma separated numbers and intervals)
+ * \return Vector of CPUs (in the order of the definition)
+ * \throw invalid_argument if the list is malformed
+ */
+static std::vector<int>
+file_parse_cpus(const std::string &expr)
+{
+    std::vector<int> cpus;
+    size_t pos = 0;
+
+    while (pos < expr.size()) {
+        size_t end = expr.find(',', pos);
+        if (end == std::string::npos) {
+            end = expr.size();
+        }
+
+        const std::string item = expr.substr(pos, end - pos);
+        pos = end + 1;
+        if (item.find_first_not_of(" \t") == std::string::npos) {
+            continue; // Empty item
+        }
+
+        unsigned long first, last;
+        char *tail;
+        errno = 0;
+        first = strtoul(item.c_str(), &tail, 10);
+        last = first;
+        while (*tail == ' ' || *tail == '\t') {
+            tail++;
+        }
+        if (*tail == '-') {
+            last = strtoul(tail + 1, &tail, 10);
+            while (*tail == ' ' || *tail == '\t') {
+                tail++;
+            }
+        }
+
+        if (errno != 0 || *tail != '\0' || first > last || last >= CPU_SETSIZE) {
+            throw std::invalid_argument("Invalid list of CPUs ('<cpus>'): '" + expr + "'");
+        }
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+
+    if (cpus.empty()) {
+        throw std::invalid_argument("List of CPUs ('<cpus>') cannot be empty!");
+    }
+
+    return cpus;
+}
+
+/**
+ * \brief Parse \<latencyMode\> node and enable the low-latency mode of the model
+ * \param[in] ctx   Parsed XML node
+ * \param[in] model Configuration model
+ * \throw invalid_argument if the parameters are not valid
+ */
+static void
+file_parse_latency(fds_xml_ctx_t *ctx, ipx_config_model &model)
+{
+    struct ipx_config_latency latency;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case LATENCY_BUSY_POLL:
+            if (content->val_uint > INT32_MAX) {
+                throw std::invalid_argument("Busy polling timeout ('<busyPoll>') is too big!");
+            }
+            latency.busy_poll = static_cast<uint32_t>(content->val_uint);
+            break;
+        case LATENCY_RT_PRIO:
+            if (content->val_uint > 99) {
+                throw std::invalid_argument("Real-time priority ('<realtimePriority>') must be "
+                    "in range 1 - 99 (or 0 to keep the default scheduling)!");
+            }
+            latency.rt_prio = static_cast<int>(content->val_uint);
+            break;
+        case LATENCY_CPUS:
+            latency.cpus = file_parse_cpus(content->ptr_string);
+            break;
+        default:
+            // Unexpected XML node within <latencyMode>!
+            assert(false);
+        }
+    }
+
+    model.set_latency(latency);
+}
+
+/**
+ * \brief Parse \<costAttribution\> node and enable attribution of processing cost
+ * \param[in] ctx   Parsed XML node
+ * \param[in] model Configuration model
+ * \throw invalid_argument if the parameters are not valid
+ */
+static void
+file_parse_cost(fds_xml_ctx_t *ctx, ipx_config_model &model)
+{
+    struct ipx_config_cost cost;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        if (content->val_uint > UINT32_MAX) {
+            throw std::invalid_argument("Value of a parameter is too big!");
+        }
+
+        const uint32_t value = static_cast<uint32_t>(content->val_uint);
+        switch (content->id) {
+        case COST_SAMPLING:
+            cost.sampling = value;
+            break;
+        case COST_TOP:
+            cost.top = value;
+            break;
+        case COST_INTERVAL:
+            cost.interval = value;
+            break;
+        default:
+            // Unexpected XML node within <costAttribution>!
+            assert(false);
+        }
+    }
+
+    model.set_cost(cost);
+}
+
+/**
+ * \brief Parse \<tracing\> node and enable tracing of messages
+ * \param[in] ctx   Parsed XML node
+ * \param[in] model Configuration model
+ * \throw invalid_argument if the parameters are not valid
+ */
+static void
+file_parse_trace(fds_xml_ctx_t *ctx, ipx_config_model &model)
+{
+    struct ipx_config_trace trace;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case TRACE_SAMPLING:
+        case TRACE_BUFFER_SIZE:
+            if (content->val_uint > UINT32_MAX) {
+                throw std::invalid_argument("Value of a parameter is too big!");
+            }
+
+            if (content->id == TRACE_SAMPLING) {
+                trace.sampling = static_cast<uint32_t>(content->val_uint);
+            } else {
+                trace.buffer_size = static_cast<uint32_t>(content->val_uint);
+            }
+            break;
+        case TRACE_FILE:
+            trace.file = content->ptr_string;
+            break;
+        default:
+            // Unexpected XML node within <tracing>!
+            assert(false);
+        }
+    }
+
+    model.set_trace(trace);
+}
+
+/**
+ * \brief Parse \<tap\> node and enable the live tap of Data Records
+ * \param[in] ctx   Parsed XML node
+ * \param[in] model Configuration model
+ * \throw invalid_argument if the parameters are not valid
+ */
+static void
+file_parse_tap(fds_xml_ctx_t *ctx, ipx_config_model &model)
+{
+    struct ipx_config_tap tap;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case TAP_SOCKET:
+            tap.socket = content->ptr_string;
+            break;
+        default:
+            // Unexpected XML node within <tap>!
+            assert(false);
+        }
+    }
+
+    model.set_tap(tap);
+}
+
 /**
  * \brief Parse startup configuration file
  *
@@ -455,10 +771,50 @@ file_parse_model(const std::string &path)
             file_parse_list_input(content->ptr_ctx, model);
             break;
         case LIST_INTER:
-            file_parse_list_inter(content->ptr_ctx, model);
+            file_parse_list_inter(content->ptr_ctx, model, "");
             break;
         case LIST_OUTPUT:
-            file_parse_list_output(content->ptr_ctx, model);
+            file_parse_list_output(content->ptr_ctx, model, "");
+            break;
+        case BRANCH:
+            try {
+                file_parse_branch(content->ptr_ctx, model);
+            } catch (std::exception &ex) {
+                throw std::runtime_error("Failed to parse the configuration of a branch of the "
+                    "pipeline: " + std::string(ex.what()));
+            }
+            break;
+        case LATENCY_MODE:
+            try {
+                file_parse_latency(content->ptr_ctx, model);
+            } catch (std::exception &ex) {
+                throw std::runtime_error("Failed to parse the configuration of the low-latency "
+                    "mode: " + std::string(ex.what()));
+            }
+            break;
+        case COST:
+            try {
+                file_parse_cost(content->ptr_ctx, model);
+            } catch (std::exception &ex) {
+                throw std::runtime_error("Failed to parse the configuration of the attribution "
+                    "of processing cost: " + std::string(ex.what()));
+            }
+            break;
+        case TRACE:
+            try {
+                file_parse_trace(content->ptr_ctx, model);
+            } catch (std::exception &ex) {
+                throw std::runtime_error("Failed to parse the configuration of tracing of "
+                    "messages: " + std::string(ex.what()));
+            }
+            break;
+        case TAP:
+            try {
+                file_parse_tap(content->ptr_ctx, model);
+            } catch (std::exception &ex) {
+                throw std::runtime_error("Failed to parse the configuration of the live tap: "
+                    + std::string(ex.what()));
+            }
             break;
         default:
             // Unexpected XML node within startup <ipfixcol2>!
@@ -487,6 +843,7 @@ ipx_config_file(ipx_configurator &conf, const std::string &path)
     sigemptyset(&mask_new);
     sigaddset(&mask_new, SIGINT);
     sigaddset(&mask_new, SIGTERM);
+    sigaddset(&mask_new, SIGUSR1); // Export of the trace of messages
     pthread_sigmask(SIG_BLOCK, &mask_new, &mask_old);
 
     while (true) {
@@ -499,6 +856,14 @@ ipx_config_file(ipx_configurator &conf, const std::string &path)
         if (sig == SIGINT || sig == SIGTERM) {
             break;
         }
+
+        if (sig == SIGUSR1) {
+            try {
+                conf.trace_export();
+            } catch (const std::exception &ex) {
+                IPX_WARNING(comp_str, "%s", ex.what());
+            }
+        }
     }
 
     IPX_INFO(comp_str, "Received a termination signal.", '\0');
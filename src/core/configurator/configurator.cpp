@@ -39,8 +39,11 @@
  *
  */
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <iostream>
+#include <cinttypes>
 #include <cstdlib>
 #include <dlfcn.h>
 #include <signal.h>
@@ -51,6 +54,7 @@ extern "C" {
 #include "../message_terminate.h"
 #include "../plugin_parser.h"
 #include "../plugin_output_mgr.h"
+#include "../trace.h"
 #include "../verbose.h"
 }
 
@@ -60,6 +64,9 @@ static const char *comp_str = "Configurator";
 ipx_configurator::ipx_configurator()
 {
     iemgr = nullptr;
+    odid_sel = nullptr;
+    ie_sel = nullptr;
+    tap = nullptr;
     ring_size = RING_DEF_SIZE;
 }
 
@@ -68,6 +75,14 @@ ipx_configurator::~ipx_configurator()
     // First, stop all instances
     stop();
 
+    if (odid_sel != nullptr) {
+        ipx_orange_destroy(odid_sel);
+    }
+
+    if (ie_sel != nullptr) {
+        ipx_ie_demand_destroy(ie_sel);
+    }
+
     if (iemgr != nullptr) {
         fds_iemgr_destroy(iemgr);
     }
@@ -77,7 +92,7 @@ ipx_configurator::~ipx_configurator()
  * \brief Check if the model is valid for application
  *
  * The model must include at least one instance of an input plugin and one instance of an output
- * plugin
+ * plugin. Each branch of the pipeline must also include at least one output instance.
  * \param[in] model Model to check
  */
 void
@@ -90,6 +105,243 @@ ipx_configurator::model_check(const ipx_config_model &model)
     if (model.outputs.empty()) {
         throw std::runtime_error("At least one output plugin must be defined!");
     }
+
+    for (const std::string &branch : model.branches) {
+        auto pred = [&branch](const ipx_plugin_output &output) {return output.branch == branch;};
+        if (std::none_of(model.outputs.begin(), model.outputs.end(), pred)) {
+            throw std::runtime_error("At least one output plugin must be defined in the branch '"
+                + branch + "'!");
+        }
+    }
+}
+
+/**
+ * \brief Create a selection of ODIDs processed by at least one output instance
+ *
+ * The selection is a union of ODID filters of all output instances. Messages of other
+ * Observation Domains are useless and can be dropped by input instances and parsers before
+ * any processing.
+ * \note ODID filters of the output instances MUST be already set.
+ * \param[in] outputs Output instances
+ * \return Pointer to the new selection or nullptr (i.e. all ODIDs are processed)
+ * \throw runtime_error if a memory allocation error has occurred
+ */
+ipx_orange_t *
+ipx_configurator::odid_sel_create(std::vector<std::unique_ptr<ipx_instance_output> > &outputs)
+{
+    std::unique_ptr<ipx_orange_t, decltype(&ipx_orange_destroy)> sel(ipx_orange_create(),
+        &ipx_orange_destroy);
+    if (!sel) {
+        throw std::runtime_error("Failed to create a selection of Observation Domain IDs!");
+    }
+
+    for (auto &output : outputs) {
+        auto input = output->get_input();
+        enum ipx_odid_filter_type type = std::get<1>(input);
+        if (type == IPX_ODID_FILTER_NONE) {
+            // The instance processes all ODIDs
+            return nullptr;
+        }
+
+        if (ipx_orange_add(sel.get(), type, std::get<2>(input)) != IPX_OK) {
+            throw std::runtime_error("Failed to create a selection of Observation Domain IDs!");
+        }
+    }
+
+    if (ipx_orange_full(sel.get())) {
+        return nullptr;
+    }
+
+    return sel.release();
+}
+
+/**
+ * \brief Create a union of Information Elements demanded by intermediate and output instances
+ *
+ * Each instance declares Information Elements it processes during its initialization. Instances
+ * that do not declare anything are considered to process all Information Elements.
+ * \note The instances MUST be already initialized.
+ * \param[in] ctxs Contexts of intermediate and output instances (i.e. without output managers
+ *   that don't process any field)
+ * \return Pointer to the new demand or nullptr (i.e. all Information Elements are demanded)
+ * \throw runtime_error if a memory allocation error has occurred
+ */
+ipx_ie_demand_t *
+ipx_configurator::ie_sel_create(const std::vector<ipx_ctx_t *> &ctxs)
+{
+    std::unique_ptr<ipx_ie_demand_t, decltype(&ipx_ie_demand_destroy)> sel(
+        ipx_ie_demand_create(), &ipx_ie_demand_destroy);
+    if (!sel) {
+        throw std::runtime_error("Failed to create a selection of Information Elements!");
+    }
+
+    for (const ipx_ctx_t *ctx : ctxs) {
+        if (ipx_ie_demand_merge(sel.get(), ipx_ctx_ie_demand_get(ctx)) != IPX_OK) {
+            throw std::runtime_error("Failed to create a selection of Information Elements!");
+        }
+
+        if (ipx_ie_demand_is_all(sel.get())) {
+            return nullptr;
+        }
+    }
+
+    return sel.release();
+}
+
+/**
+ * \brief Enable the low-latency mode of all instances
+ *
+ * Threads of all instances spin on their input ring buffers instead of sleeping, input
+ * instances are informed about the busy polling timeout of their sockets and, if configured,
+ * threads are pinned to CPUs (in the order of the pipeline) and use real-time scheduling.
+ * \param[in] latency Configuration of the mode
+ * \param[in] inputs  Input instances
+ * \param[in] inters  Intermediate instances (including output managers)
+ * \param[in] outputs Output instances
+ */
+void
+ipx_configurator::latency_set(const struct ipx_config_latency &latency,
+    std::vector<std::unique_ptr<ipx_instance_input> > &inputs,
+    std::vector<std::unique_ptr<ipx_instance_intermediate> > &inters,
+    std::vector<std::unique_ptr<ipx_instance_output> > &outputs)
+{
+    struct ipx_ctx_latency cfg;
+    cfg.busy_poll = latency.busy_poll;
+    cfg.spin = true;
+    cfg.cpu = -1;
+    cfg.rt_prio = latency.rt_prio;
+
+    // CPUs are assigned to threads in the order of the pipeline (round-robin)
+    size_t cpu_idx = 0;
+    auto next_cpu = [&latency, &cpu_idx]() -> int {
+        if (latency.cpus.empty()) {
+            return -1;
+        }
+        return latency.cpus[cpu_idx++ % latency.cpus.size()];
+    };
+
+    for (auto &input : inputs) {
+        input->set_latency(cfg, next_cpu);
+    }
+    for (auto &inter : inters) {
+        inter->set_latency(cfg, next_cpu);
+    }
+    for (auto &output : outputs) {
+        output->set_latency(cfg, next_cpu);
+    }
+
+    if (!latency.cpus.empty() && cpu_idx > latency.cpus.size()) {
+        IPX_WARNING(comp_str, "The low-latency mode requires %zu threads but only %zu CPUs are "
+            "available. Spinning threads that share a CPU increase latency!", cpu_idx,
+            latency.cpus.size());
+    }
+
+    IPX_INFO(comp_str, "Low-latency mode enabled (busy polling: %" PRIu32 " us, real-time "
+        "priority: %d).", latency.busy_poll, latency.rt_prio);
+}
+
+/**
+ * \brief Enable attribution of processing cost of intermediate and output instances
+ * \param[in] cost Configuration of the attribution
+ * \param[in] ctxs Contexts of intermediate and output instances
+ * \throw runtime_error if the attribution cannot be enabled
+ */
+void
+ipx_configurator::cost_set(const struct ipx_config_cost &cost,
+    const std::vector<ipx_ctx_t *> &ctxs)
+{
+    struct ipx_ctx_cost cfg;
+    cfg.sampling = cost.sampling;
+    cfg.top = cost.top;
+    cfg.interval = cost.interval;
+
+    for (ipx_ctx_t *ctx : ctxs) {
+        if (ipx_ctx_cost_set(ctx, &cfg) != IPX_OK) {
+            throw std::runtime_error("Failed to enable attribution of processing cost of the "
+                "instance '" + std::string(ipx_ctx_name_get(ctx)) + "'!");
+        }
+    }
+
+    IPX_INFO(comp_str, "Attribution of processing cost enabled (1 of %" PRIu32 " IPFIX Messages "
+        "is measured).", cost.sampling);
+}
+
+/**
+ * \brief Enable tracing of messages (must be called before threads of instances are started)
+ * \param[in] trace Configuration of the tracing
+ * \throw runtime_error if the tracing cannot be enabled
+ */
+void
+ipx_configurator::trace_set(const struct ipx_config_trace &trace)
+{
+    if (ipx_trace_enable(trace.sampling, trace.buffer_size) != IPX_OK) {
+        throw std::runtime_error("Failed to enable tracing of messages!");
+    }
+
+    trace_file = trace.file;
+    IPX_INFO(comp_str, "Tracing of messages enabled (1 of %" PRIu32 " IPFIX Messages is traced). "
+        "Send SIGUSR1 to export the trace to '%s'.", trace.sampling, trace_file.c_str());
+}
+
+void
+ipx_configurator::trace_export()
+{
+    if (trace_file.empty()) {
+        throw std::runtime_error("Unable to export the trace because tracing of messages is not "
+            "enabled!");
+    }
+
+    if (ipx_trace_export(trace_file.c_str()) != IPX_OK) {
+        throw std::runtime_error("Failed to export the trace to '" + trace_file + "'!");
+    }
+}
+
+/**
+ * \brief Start a server of the live tap of Data Records
+ *
+ * Tap points are parsers of input instances and intermediate instances (i.e. without output
+ * managers). Failure to start the server is not fatal, the pipeline works without it.
+ * \param[in] cfg        Configuration of the tap
+ * \param[in] inputs     Input instances
+ * \param[in] inters     Intermediate instances (including output managers)
+ * \param[in] inters_cfg Configurations of intermediate instances (nullptr == output manager)
+ */
+void
+ipx_configurator::tap_set(const struct ipx_config_tap &cfg,
+    std::vector<std::unique_ptr<ipx_instance_input> > &inputs,
+    std::vector<std::unique_ptr<ipx_instance_intermediate> > &inters,
+    const std::vector<const ipx_plugin_inter *> &inters_cfg)
+{
+    std::unique_ptr<ipx_tap_t, decltype(&ipx_tap_destroy)> new_tap(ipx_tap_create(
+        cfg.socket.c_str()), &ipx_tap_destroy);
+    if (!new_tap) {
+        IPX_WARNING(comp_str, "Failed to create a server of the live tap. Records cannot be "
+            "tapped.", '\0');
+        return;
+    }
+
+    std::vector<ipx_ctx_t *> points;
+    for (auto &input : inputs) {
+        points.push_back(input->get_parser_ctx());
+    }
+    for (size_t i = 0; i < inters.size(); ++i) {
+        if (inters_cfg[i] != nullptr) {
+            points.push_back(inters[i]->get_ctx());
+        }
+    }
+
+    for (ipx_ctx_t *ctx : points) {
+        if (ipx_tap_point_add(new_tap.get(), ctx) != IPX_OK) {
+            IPX_WARNING(comp_str, "Failed to add a tap point. Records cannot be tapped.", '\0');
+            return;
+        }
+    }
+
+    if (ipx_tap_start(new_tap.get()) != IPX_OK) {
+        return;
+    }
+
+    tap = new_tap.release();
 }
 
 /**
@@ -177,9 +429,21 @@ ipx_configurator::start(const ipx_config_model &model)
         iemgr_dir.c_str());
 
     // In case of an exception, smart pointers make sure that all instances are destroyed
+    // (selections of ODIDs and IEs are used by input instances, therefore, they must be
+    // destroyed last)
+    std::unique_ptr<ipx_orange_t, decltype(&ipx_orange_destroy)> new_sel(nullptr,
+        &ipx_orange_destroy);
+    std::unique_ptr<ipx_ie_demand_t, decltype(&ipx_ie_demand_destroy)> new_ie_sel(nullptr,
+        &ipx_ie_demand_destroy);
     std::vector<std::unique_ptr<ipx_instance_output> > outputs;
     std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
     std::vector<std::unique_ptr<ipx_instance_input> > inputs;
+    // Configurations of intermediate instances (nullptr == output manager)
+    std::vector<const ipx_plugin_inter *> inters_cfg;
+    // Output managers of the shared part (i.e. "") and of branches with intermediate instances
+    std::map<std::string, ipx_instance_outmgr *> managers;
+    // Output managers of output instances
+    std::vector<ipx_instance_outmgr *> outputs_mgr;
 
     // Phase 1. Create all instances (i.e. find plugins)
     for (const auto &output : model.outputs) {
@@ -187,9 +451,36 @@ ipx_configurator::start(const ipx_config_model &model)
         outputs.emplace_back(new ipx_instance_output(output.name, ref, ring_size));
     }
 
-    for (const auto &inter : model.inters) {
-        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
-        inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, ring_size));
+    /* Intermediate instances are stored in the order of the pipeline, i.e. the shared chain is
+     * followed by chains of branches. Each chain ends with its own output manager, however,
+     * output instances of branches without intermediate instances are connected directly to
+     * the output manager of the shared chain.
+     */
+    std::vector<std::string> chains {""};
+    chains.insert(chains.end(), model.branches.begin(), model.branches.end());
+    for (const std::string &chain : chains) {
+        size_t chain_size = 0;
+        for (const auto &inter : model.inters) {
+            if (inter.branch != chain) {
+                continue;
+            }
+
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
+            inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, ring_size));
+            inters_cfg.push_back(&inter);
+            chain_size++;
+        }
+
+        if (!chain.empty() && chain_size == 0) {
+            continue;
+        }
+
+        // Insert the output manager as the last intermediate plugin of the chain
+        const std::string name = chain.empty() ? "Output manager" : "Output manager " + chain;
+        ipx_instance_outmgr *output_manager = new ipx_instance_outmgr(ring_size, name);
+        inters.emplace_back(output_manager);
+        inters_cfg.push_back(nullptr);
+        managers[chain] = output_manager;
     }
 
     for (const auto &input : model.inputs) {
@@ -197,10 +488,6 @@ ipx_configurator::start(const ipx_config_model &model)
         inputs.emplace_back(new ipx_instance_input(input.name, ref, ring_size));
     }
 
-    // Insert the output manager as the last intermediate plugin
-    ipx_instance_outmgr *output_manager = new ipx_instance_outmgr(ring_size);
-    inters.emplace_back(output_manager);
-
     IPX_DEBUG(comp_str, "All plugins have been successfully loaded.", '\0');
 
     // Phase 2. Connect instances (input -> inter -> ... -> inter -> output manager -> output)
@@ -209,10 +496,16 @@ ipx_configurator::start(const ipx_config_model &model)
         input->connect_to(*first_inter); // This can enable multi-writer mode
     }
 
+    ipx_instance_outmgr *shared_manager = managers.at("");
     for (size_t i = 0; i < inters.size() - 1; ++i) { // Skip the last element
         ipx_instance_intermediate *from = inters[i].get();
         ipx_instance_intermediate *to = inters[i + 1].get();
-        from->connect_to(*to);
+        if (inters_cfg[i] != nullptr) {
+            from->connect_to(*to);
+        } else {
+            // End of a chain, the next instance is the first instance of a branch
+            shared_manager->connect_to_branch(*to);
+        }
     }
 
     for (size_t i = 0; i < model.outputs.size(); ++i) {
@@ -223,8 +516,47 @@ ipx_configurator::start(const ipx_config_model &model)
             instance->set_filter(cfg.odid_type, cfg.odid_expression);
         }
 
-        // Connect the output manager and the output instance
+        // Connect the output manager of the branch and the output instance
+        auto it = managers.find(cfg.branch);
+        ipx_instance_outmgr *output_manager = (it != managers.end()) ? it->second : shared_manager;
         output_manager->connect_to(*instance);
+        outputs_mgr.push_back(output_manager);
+    }
+
+    if (!model.branches.empty()) {
+        IPX_INFO(comp_str, "The pipeline is split into %zu branches. Messages are shared by the "
+            "branches and copied only if modified.", model.branches.size());
+    }
+
+    // Messages of ODIDs that are not processed by any output can be dropped by inputs
+    new_sel.reset(odid_sel_create(outputs));
+    if (new_sel) {
+        IPX_INFO(comp_str, "Observation Domains not processed by any output instance will be "
+            "dropped by input instances.", '\0');
+        for (auto &input : inputs) {
+            input->set_odid_sel(new_sel.get());
+        }
+    }
+
+    // Data Records are split on demand if all instances work at the level of IPFIX Sets
+    bool split_defer = true;
+    for (auto &inter : inters) {
+        split_defer &= (ipx_ctx_plugin_flags(inter->get_ctx()) & IPX_PF_SET_LEVEL) != 0;
+    }
+    for (auto &output : outputs) {
+        split_defer &= (ipx_ctx_plugin_flags(output->get_ctx()) & IPX_PF_SET_LEVEL) != 0;
+    }
+    if (split_defer) {
+        IPX_INFO(comp_str, "All instances process IPFIX Sets only. Data Records will be split "
+            "on demand.", '\0');
+        for (auto &input : inputs) {
+            input->set_split_defer(true);
+        }
+    }
+
+    // Low-latency mode (must be set before initialization, inputs configure their sockets)
+    if (model.latency.enabled) {
+        latency_set(model.latency, inputs, inters, outputs);
     }
 
     // Phase 3. Initialize all instances (call constructors)
@@ -234,22 +566,95 @@ ipx_configurator::start(const ipx_config_model &model)
         instance->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
     }
 
-    output_manager->init(iemgr, ipx_verb_level_get());
-    for (size_t i = 0; i < model.inters.size(); ++i) {
+    for (auto &manager : managers) {
+        manager.second->init(iemgr, ipx_verb_level_get());
+    }
+
+    // Contexts of intermediate and output instances (i.e. without output managers)
+    std::vector<ipx_ctx_t *> plugin_ctxs;
+    for (size_t i = 0; i < inters.size(); ++i) {
+        const ipx_plugin_inter *cfg = inters_cfg[i];
+        if (!cfg) {
+            // Output manager (already initialized)
+            continue;
+        }
+
         ipx_instance_intermediate *instance = inters[i].get();
-        const ipx_plugin_inter &cfg = model.inters[i];
-        instance->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
+        instance->init(cfg->params, iemgr, verbosity_str2level(cfg->verbosity));
+        plugin_ctxs.push_back(instance->get_ctx());
+    }
+    for (auto &output : outputs) {
+        plugin_ctxs.push_back(output->get_ctx());
+    }
+
+    // Attribution of processing cost (only instances of plugins, i.e. without output managers)
+    if (model.cost.enabled) {
+        cost_set(model.cost, plugin_ctxs);
+    }
+
+    // Data Sets without any field demanded by intermediate and output instances can be skipped
+    new_ie_sel.reset(ie_sel_create(plugin_ctxs));
+    if (new_ie_sel) {
+        IPX_INFO(comp_str, "Data Sets without any Information Element demanded by intermediate "
+            "and output instances will be skipped by parsers.", '\0');
+        for (auto &input : inputs) {
+            input->set_ie_sel(new_ie_sel.get());
+        }
     }
 
     for (size_t i = 0; i < model.inputs.size(); ++i) {
         ipx_instance_input *instance = inputs[i].get();
         const ipx_plugin_input &cfg = model.inputs[i];
+        if (!cfg.replication.empty()) {
+            instance->set_replication(cfg.replication);
+        }
         instance->init(cfg.params, iemgr, verbosity_str2level(cfg.verbosity));
     }
 
     IPX_DEBUG(comp_str, "All instances have been successfully initialized.", '\0');
 
+    /* Phase 3b. Resolve record extensions of each path through the pipeline (intermediate
+     * instances first, then outputs). Producers always get a private copy of a message shared by
+     * multiple branches, so extensions of different branches can use the same space.
+     */
+    size_t rec_size = 0;
+    for (const auto &manager : managers) {
+        std::vector<ipx_ctx_t *> rext_ctxs;
+        for (size_t i = 0; i < inters.size(); ++i) {
+            const ipx_plugin_inter *cfg = inters_cfg[i];
+            if (cfg != nullptr && (cfg->branch.empty() || cfg->branch == manager.first)) {
+                rext_ctxs.push_back(inters[i]->get_ctx());
+            }
+        }
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            if (outputs_mgr[i] == manager.second) {
+                rext_ctxs.push_back(outputs[i]->get_ctx());
+            }
+        }
+
+        size_t path_size;
+        if (ipx_ctx_rext_resolve(rext_ctxs.data(), rext_ctxs.size(), &path_size) != IPX_OK) {
+            throw std::runtime_error("Failed to resolve dependencies of record extensions!");
+        }
+        rec_size = std::max(rec_size, path_size);
+    }
+
+    for (auto &inst : inputs) {
+        inst->set_recsize(rec_size);
+    }
+    for (auto &inst : inters) {
+        inst->set_recsize(rec_size);
+    }
+    for (auto &inst : outputs) {
+        inst->set_recsize(rec_size);
+    }
+
     // Phase 4. Start threads of all plugins
+    if (model.trace.enabled) {
+        // Threads create their trace buffers on start
+        trace_set(model.trace);
+    }
+
     for (auto &output : outputs) {
         output->start();
     }
@@ -263,13 +668,34 @@ ipx_configurator::start(const ipx_config_model &model)
     }
 
     IPX_DEBUG(comp_str, "All threads of instances has been successfully started.", '\0');
+    if (model.tap.enabled) {
+        tap_set(model.tap, inputs, inters, inters_cfg);
+    }
+
     running_inputs = std::move(inputs);
     running_inter = std::move(inters);
     running_outputs = std::move(outputs);
+
+    // Previous instances (if any) have been destroyed, replace the selection
+    if (odid_sel != nullptr) {
+        ipx_orange_destroy(odid_sel);
+    }
+    odid_sel = new_sel.release();
+
+    if (ie_sel != nullptr) {
+        ipx_ie_demand_destroy(ie_sel);
+    }
+    ie_sel = new_ie_sel.release();
 }
 
 void ipx_configurator::stop()
 {
+    if (tap != nullptr) {
+        // No new clients can be attached to instances that are going to be destroyed
+        ipx_tap_destroy(tap);
+        tap = nullptr;
+    }
+
     if (running_inputs.empty()) {
         // No instances -> nothing to do
         return;
@@ -295,4 +721,10 @@ void ipx_configurator::stop()
     running_outputs.clear();
 
     IPX_DEBUG(comp_str, "All instances successfully terminated.", '\0');
+
+    if (!trace_file.empty()) {
+        // Threads are not running anymore, recorded spans can be freed
+        ipx_trace_cleanup();
+        trace_file.clear();
+    }
 }
@@ -74,10 +74,30 @@ private:
     std::vector<std::unique_ptr<ipx_instance_intermediate> > running_inter;
     /** Vector of running instances of output plugins                                          */
     std::vector<std::unique_ptr<ipx_instance_output> > running_outputs;
+    /** ODIDs processed by at least one running output instance (nullptr == all ODIDs)      */
+    ipx_orange_t *odid_sel;
+    /** Information Elements demanded by running instances (nullptr == all IEs)             */
+    ipx_ie_demand_t *ie_sel;
+    /** Output file of the trace (empty == tracing disabled)                                   */
+    std::string trace_file;
+    /** Server of the live tap of Data Records (nullptr == disabled)                          */
+    ipx_tap_t *tap;
 
     void model_check(const ipx_config_model &model);
     fds_iemgr_t *iemgr_load(const std::string dir);
     enum ipx_verb_level verbosity_str2level(const std::string &verb);
+    ipx_orange_t *odid_sel_create(std::vector<std::unique_ptr<ipx_instance_output> > &outputs);
+    void latency_set(const struct ipx_config_latency &latency,
+        std::vector<std::unique_ptr<ipx_instance_input> > &inputs,
+        std::vector<std::unique_ptr<ipx_instance_intermediate> > &inters,
+        std::vector<std::unique_ptr<ipx_instance_output> > &outputs);
+    ipx_ie_demand_t *ie_sel_create(const std::vector<ipx_ctx_t *> &ctxs);
+    void cost_set(const struct ipx_config_cost &cost, const std::vector<ipx_ctx_t *> &ctxs);
+    void trace_set(const struct ipx_config_trace &trace);
+    void tap_set(const struct ipx_config_tap &cfg,
+        std::vector<std::unique_ptr<ipx_instance_input> > &inputs,
+        std::vector<std::unique_ptr<ipx_instance_intermediate> > &inters,
+        const std::vector<const ipx_plugin_inter *> &inters_cfg);
 
 public:
     /** Minimal size of ring buffers between instances of plugins                              */
@@ -125,6 +145,13 @@ public:
       * \param[in] size Size
       */
      void set_buffer_size(uint32_t size);
+     /**
+      * \brief Export the trace of messages into the configured file
+      *
+      * The trace consists of spans recorded so far by threads of running instances.
+      * \throw runtime_error if tracing is not enabled or the export failed
+      */
+     void trace_export();
 };
 
 #endif //IPFIXCOL_CONFIGURATOR_H
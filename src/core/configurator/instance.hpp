@@ -42,6 +42,7 @@
 #ifndef IPFIXCOL_INSTANCE_H
 #define IPFIXCOL_INSTANCE_H
 
+#include <functional>
 #include <tuple>
 #include <string>
 #include <stdexcept>
@@ -51,6 +52,7 @@
 extern "C" {
 #include <ipfixcol2.h>
 #include "../ring.h"
+#include "../context.h"
 }
 
 /** Unique pointer type of an instance context */
@@ -114,6 +116,26 @@ public:
      */
     virtual void init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level) = 0;
 
+    /**
+     * \brief Get the context of the instance
+     * \return Pointer to the context
+     */
+    ipx_ctx_t *get_ctx() {return _ctx;};
+    /**
+     * \brief Set size of IPFIX records (with registered extensions) processed by the instance
+     * \param[in] size Size of a record (in bytes)
+     */
+    virtual void set_recsize(size_t size) {ipx_ctx_recsize_set(_ctx, size);};
+    /**
+     * \brief Set low-latency configuration of threads of the instance
+     * \param[in] cfg      Configuration (the CPU is ignored)
+     * \param[in] next_cpu Function that returns a CPU for the next thread (negative == any CPU)
+     */
+    virtual void set_latency(struct ipx_ctx_latency cfg, const std::function<int()> &next_cpu) {
+        cfg.cpu = next_cpu();
+        ipx_ctx_latency_set(_ctx, &cfg);
+    };
+
     /** \brief Start a thread of the instance                                                    */
     virtual void start() = 0;
 };
@@ -77,6 +77,9 @@ ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::
         throw std::runtime_error("Failed to create components of an input instance!");
     }
 
+    // Keep message properties and small messages directly in slots of the ring buffer
+    ipx_ring_inline_mode(ring_wrap.get(), true);
+
     // Configure the components (connect them)
     ipx_ctx_fpipe_set(input_wrap.get(), feedback.get());
     ipx_ctx_ring_dst_set(input_wrap.get(), ring_wrap.get());
@@ -106,6 +109,45 @@ ipx_instance_input::~ipx_instance_input()
     ipx_ring_destroy(_parser_buffer);
 }
 
+void
+ipx_instance_input::set_replication(const std::string &params)
+{
+    assert(_state == state::NEW); // Only configuration of uninitialized instances can be changed!
+    _parser_params = params;
+}
+
+void
+ipx_instance_input::set_odid_sel(const ipx_orange_t *sel)
+{
+    assert(_state == state::NEW); // Only configuration of uninitialized instances can be changed!
+    ipx_ctx_odid_sel_set(_ctx, sel);
+    ipx_ctx_odid_sel_set(_parser_ctx, sel);
+}
+
+void
+ipx_instance_input::set_split_defer(bool enable)
+{
+    assert(_state == state::NEW); // Only configuration of uninitialized instances can be changed!
+    ipx_ctx_split_defer_set(_parser_ctx, enable);
+}
+
+void
+ipx_instance_input::set_ie_sel(const ipx_ie_demand_t *sel)
+{
+    assert(_state == state::NEW); // Only configuration of uninitialized instances can be changed!
+    ipx_ctx_ie_sel_set(_parser_ctx, sel);
+}
+
+void
+ipx_instance_input::set_latency(struct ipx_ctx_latency cfg, const std::function<int()> &next_cpu)
+{
+    assert(_state == state::NEW); // Only configuration of uninitialized instances can be changed!
+    cfg.cpu = next_cpu();
+    ipx_ctx_latency_set(_ctx, &cfg);
+    cfg.cpu = next_cpu();
+    ipx_ctx_latency_set(_parser_ctx, &cfg);
+}
+
 void
 ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level)
 {
@@ -119,7 +161,8 @@ ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ip
     ipx_ctx_iemgr_set(_parser_ctx, iemgr);
 
     // Initialize
-    if (ipx_ctx_init(_parser_ctx, nullptr) != IPX_OK) {
+    const char *parser_params = _parser_params.empty() ? nullptr : _parser_params.c_str();
+    if (ipx_ctx_init(_parser_ctx, parser_params) != IPX_OK) {
         throw std::runtime_error("Failed to initialize the parser of IPFIX Messages!");
     }
 
@@ -150,6 +193,13 @@ ipx_instance_input::get_feedback()
     return _input_feedback;
 }
 
+void
+ipx_instance_input::set_recsize(size_t size)
+{
+    ipx_ctx_recsize_set(_ctx, size);
+    ipx_ctx_recsize_set(_parser_ctx, size);
+}
+
 void
 ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate)
 {
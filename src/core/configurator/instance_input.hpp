@@ -89,6 +89,8 @@ protected:
     ipx_ring_t  *_parser_buffer;
     /** Instance of the parser plugin (internal)                                                 */
     ipx_ctx_t   *_parser_ctx;
+    /** XML parameters of the parser (replication, can be empty)                                 */
+    std::string  _parser_params;
 
     // Disable copy constructors
     ipx_instance_input(const ipx_instance_input &) = delete;
@@ -115,6 +117,47 @@ public:
      */
     ~ipx_instance_input();
 
+    /**
+     * \brief Enable replication of template state of the IPFIX parser (disabled by default)
+     * \param[in] params XML parameters of replication (root node "\<replication\>")
+     */
+    void set_replication(const std::string &params);
+
+    /**
+     * \brief Set ODIDs processed by at least one output instance (all by default)
+     *
+     * Messages of other Observation Domains are dropped by the input instance (if supported
+     * by the plugin) or by the parser.
+     * \note The selection MUST exist until the instance is destroyed.
+     * \param[in] sel Selection of ODIDs (nullptr == all ODIDs)
+     */
+    void set_odid_sel(const ipx_orange_t *sel);
+
+    /**
+     * \brief Defer splitting of Data Sets into Data Records by the parser (disabled by default)
+     *
+     * Enable only if all following instances process messages at the level of IPFIX Sets
+     * (i.e. plugins with #IPX_PF_SET_LEVEL flag).
+     * \param[in] enable Enable/disable
+     */
+    void set_split_defer(bool enable);
+
+    /**
+     * \brief Set Information Elements demanded by at least one following instance (all by default)
+     *
+     * Data Sets without any demanded field are skipped by the parser.
+     * \note The demand MUST exist until the instance is destroyed.
+     * \param[in] sel Demand of Information Elements (nullptr == all Information Elements)
+     */
+    void set_ie_sel(const ipx_ie_demand_t *sel);
+
+    /**
+     * \brief Set low-latency configuration of threads of the input and the parser
+     * \param[in] cfg      Configuration (the CPU is ignored)
+     * \param[in] next_cpu Function that returns a CPU for the next thread (negative == any CPU)
+     */
+    void set_latency(struct ipx_ctx_latency cfg, const std::function<int()> &next_cpu);
+
     /**
      * \brief Initialize the instance
      *
@@ -139,6 +182,18 @@ public:
      */
     ipx_fpipe_t *get_feedback();
 
+    /**
+     * \brief Get a context of the IPFIX parser of the instance
+     * \return Pointer to the context
+     */
+    ipx_ctx_t *get_parser_ctx() {return _parser_ctx;};
+
+    /**
+     * \brief Set size of IPFIX records of the input instance and the parser
+     * \param[in] size Size of a record (in bytes)
+     */
+    void set_recsize(size_t size);
+
     /**
      * \brief Connect the the input instance to an instance of an intermediate plugin
      * \param[in] intermediate Intermediate plugin to receive our messages
@@ -58,6 +58,9 @@ ipx_instance_intermediate::internals_init(const struct ipx_ctx_callbacks *cbs, u
         throw std::runtime_error("Failed to create components of an intermediate instance!");
     }
 
+    // Keep message properties and small messages directly in slots of the ring buffer
+    ipx_ring_inline_mode(ring_wrap.get(), true);
+
     // Configure the components (connect them)
     ipx_ctx_ring_src_set(inter_wrap.get(), ring_wrap.get());
     _instance_buffer = ring_wrap.release();
@@ -59,8 +59,8 @@ static const struct ipx_ctx_callbacks output_mgr_callbacks = {
 };
 
 
-ipx_instance_outmgr::ipx_instance_outmgr(uint32_t bsize)
-    : ipx_instance_intermediate("Output manager", &output_mgr_callbacks, bsize)
+ipx_instance_outmgr::ipx_instance_outmgr(uint32_t bsize, const std::string &name)
+    : ipx_instance_intermediate(name, &output_mgr_callbacks, bsize)
 {
     _list = ipx_output_mgr_list_create();
     if (!_list) {
@@ -83,7 +83,8 @@ void ipx_instance_outmgr::init(const fds_iemgr_t *iemgr,
 {
     assert(_state == state::NEW); // Only not initialized instance can be initialized
     if (ipx_output_mgr_list_empty(_list)) {
-        throw std::runtime_error("Output manager is not connected to any output instances!");
+        throw std::runtime_error("Output manager is not connected to any output instances or "
+            "branches!");
     }
 
     // Pass the list of destinations
@@ -112,4 +113,15 @@ ipx_instance_outmgr::connect_to(ipx_instance_output &output)
     if (ipx_output_mgr_list_add(_list, ring, filter_type, filter) != IPX_OK) {
         throw std::runtime_error("Failed to connect an output instance to the output manager!");
     }
-}
\ No newline at end of file
+}
+
+void
+ipx_instance_outmgr::connect_to_branch(ipx_instance_intermediate &intermediate)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    if (ipx_output_mgr_list_add(_list, intermediate.get_input(), IPX_ODID_FILTER_NONE, nullptr)
+            != IPX_OK) {
+        throw std::runtime_error("Failed to connect a branch of the pipeline to the output "
+            "manager!");
+    }
+}
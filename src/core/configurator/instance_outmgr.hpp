@@ -55,11 +55,12 @@ extern "C" {
  * The class takes care of (i.e. initialize, configure and destroy):
  * - a plugin context of the output manager (implemented as an internal plugin)
  * - an input ring buffer (inherited from the base class)
- * - a list of connected output instances (with optional ODID filters)
+ * - a list of connected output instances (with optional ODID filters) and branches of the
+ *   pipeline
  *
  * \note
- *   The output manager must be connected to at least one output instance before it can be
- *   initialized!
+ *   The output manager must be connected to at least one output instance (or a branch) before
+ *   it can be initialized!
  *
  * \verbatim
  *                +--------+
@@ -82,8 +83,9 @@ public:
     /**
      * \brief Create an instance of the internal output manager plugin
      * \param[in] bsize  Size of the input ring buffer
+     * \param[in] name   Identification name of the instance
      */
-    explicit ipx_instance_outmgr(uint32_t bsize);
+    explicit ipx_instance_outmgr(uint32_t bsize, const std::string &name = "Output manager");
     /**
      * \brief Destroy the instance
      *   If the thread is running (start() has been called), the function blocks until the thread
@@ -114,6 +116,16 @@ public:
      * \throw runtime_error if creating of the connection fails
      */
     void connect_to(ipx_instance_output &output);
+
+    /**
+     * \brief Connect the output manager to the first instance of a branch of the pipeline
+     *
+     * All messages are passed to the branch (i.e. without any ODID filter). Messages shared by
+     * multiple branches must not be modified, see #IPX_PF_MSG_MODIFY.
+     * \param[in] intermediate First intermediate instance of the branch
+     * \throw runtime_error if creating of the connection fails
+     */
+    void connect_to_branch(ipx_instance_intermediate &intermediate);
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTMGR_HPP
@@ -56,6 +56,9 @@ ipx_instance_output::ipx_instance_output(const std::string &name,
         throw std::runtime_error("Failed to create components of an output instance!");
     }
 
+    // Keep message properties and small messages directly in slots of the ring buffer
+    ipx_ring_inline_mode(ring_wrap.get(), true);
+
     // Configure the components (connect them)
     ipx_ctx_ring_src_set(output_wrap.get(), ring_wrap.get());
     _instance_buffer = ring_wrap.release();
@@ -41,6 +41,7 @@
 
 #include <stdexcept>
 #include <strings.h>
+#include <sched.h>
 #include <iostream>
 #include "model.hpp"
 
@@ -88,6 +89,28 @@ ipx_config_model::check_common(struct ipx_plugin_base *base)
     }
 }
 
+/**
+ * \brief Check that a branch of an instance has been defined
+ * \param[in] branch Name of the branch (empty == the shared part of the pipeline)
+ * \param[in] name   Name of the instance
+ */
+void
+ipx_config_model::check_branch(const std::string &branch, const std::string &name)
+{
+    if (branch.empty()) {
+        return;
+    }
+
+    for (const std::string &item : branches) {
+        if (item == branch) {
+            return;
+        }
+    }
+
+    throw std::invalid_argument("Branch '" + branch + "' of the instance '" + name + "' is not "
+        "defined!");
+}
+
 void
 ipx_config_model::add_instance(struct ipx_plugin_input &instance)
 {
@@ -119,6 +142,7 @@ ipx_config_model::add_instance(struct ipx_plugin_inter &instance)
             + instance.name + "' are not allowed!");
     }
 
+    check_branch(instance.branch, instance.name);
     inters.push_back(instance);
 }
 
@@ -142,9 +166,93 @@ ipx_config_model::add_instance(struct ipx_plugin_output &instance)
             "output instance '" + instance.name + "' cannot be empty!");
     }
 
+    check_branch(instance.branch, instance.name);
     outputs.push_back(instance);
 }
 
+void
+ipx_config_model::add_branch(const std::string &name)
+{
+    if (name.empty()) {
+        throw std::invalid_argument("Name of a branch ('<name>') is not specified or it is empty!");
+    }
+
+    for (const std::string &branch : branches) {
+        if (branch == name) {
+            throw std::invalid_argument("Multiple branches with the same <name> '" + name
+                + "' are not allowed!");
+        }
+    }
+
+    branches.push_back(name);
+}
+
+void
+ipx_config_model::set_latency(const struct ipx_config_latency &cfg)
+{
+    if (cfg.rt_prio < 0 || cfg.rt_prio > 99) {
+        throw std::invalid_argument("Real-time priority ('<realtimePriority>') must be in range "
+            "1 - 99 (or 0 to keep the default scheduling)!");
+    }
+
+    for (int cpu : cfg.cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            throw std::invalid_argument("CPU " + std::to_string(cpu) + " ('<cpus>') is out of "
+                "range!");
+        }
+    }
+
+    latency = cfg;
+    latency.enabled = true;
+}
+
+void
+ipx_config_model::set_cost(const struct ipx_config_cost &cfg)
+{
+    if (cfg.sampling == 0) {
+        throw std::invalid_argument("Sampling rate ('<sampling>') must be greater than zero!");
+    }
+
+    if (cfg.top == 0) {
+        throw std::invalid_argument("Number of reported sources ('<top>') must be greater than "
+            "zero!");
+    }
+
+    cost = cfg;
+    cost.enabled = true;
+}
+
+void
+ipx_config_model::set_trace(const struct ipx_config_trace &cfg)
+{
+    if (cfg.sampling == 0) {
+        throw std::invalid_argument("Sampling rate ('<sampling>') must be greater than zero!");
+    }
+
+    if (cfg.buffer_size == 0) {
+        throw std::invalid_argument("Size of trace buffers ('<bufferSize>') must be greater "
+            "than zero!");
+    }
+
+    if (cfg.file.empty()) {
+        throw std::invalid_argument("Output file ('<file>') must not be empty!");
+    }
+
+    trace = cfg;
+    trace.enabled = true;
+}
+
+void
+ipx_config_model::set_tap(const struct ipx_config_tap &cfg)
+{
+    if (cfg.socket.empty()) {
+        throw std::invalid_argument("Path of the socket ('<socket>') must not be empty!");
+    }
+
+    tap = cfg;
+    tap.enabled = true;
+}
+
 void
 ipx_config_model::dump()
 {
@@ -163,7 +271,11 @@ ipx_config_model::dump()
     // Intermediate plugins
     std::cout << "Intermediate plugins:\n";
     for (auto &inter : inters) {
-        std::cout << "\t- " << inter.plugin << " / " << inter.name << "\n";
+        std::cout << "\t- " << inter.plugin << " / " << inter.name;
+        if (!inter.branch.empty()) {
+            std::cout << " (branch '" << inter.branch << "')";
+        }
+        std::cout << "\n";
     }
 
     if (inters.empty()) {
@@ -175,7 +287,11 @@ ipx_config_model::dump()
     // Output plugins
     std::cout << "Output plugins:\n";
     for (auto &out : outputs) {
-        std::cout << "\t- " << out.plugin << " / " << out.name << "\n";
+        std::cout << "\t- " << out.plugin << " / " << out.name;
+        if (!out.branch.empty()) {
+            std::cout << " (branch '" << out.branch << "')";
+        }
+        std::cout << "\n";
     }
 
     if (outputs.empty()) {
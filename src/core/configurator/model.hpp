@@ -62,19 +62,71 @@ struct ipx_plugin_base {
 };
 
 /** Configuration of an input plugin                                          */
-struct ipx_plugin_input  : ipx_plugin_base {};
+struct ipx_plugin_input  : ipx_plugin_base {
+    /** Replication of template state (root node "\<replication\>", can be empty) */
+    std::string replication;
+};
 
 /** Configuration of an intermediate plugin                                   */
-struct ipx_plugin_inter  : ipx_plugin_base {};
+struct ipx_plugin_inter  : ipx_plugin_base {
+    /** Name of the branch of the pipeline (empty == the shared part)         */
+    std::string branch;
+};
 
 /** Configuration of an output plugin                                         */
 struct ipx_plugin_output : ipx_plugin_base {
+    /** Name of the branch of the pipeline (empty == the shared part)         */
+    std::string branch;
     /** ODID filter type                                                      */
     enum ipx_odid_filter_type odid_type;
     /** ODID filter expression                                                */
     std::string odid_expression;
 };
 
+/** Low-latency mode of the pipeline                                          */
+struct ipx_config_latency {
+    /** Low-latency mode is enabled                                            */
+    bool enabled = false;
+    /** Busy polling timeout of sockets of input plugins (in microseconds)     */
+    uint32_t busy_poll = 50;
+    /** SCHED_FIFO priority of instance threads (0 == default scheduling)      */
+    int rt_prio = 0;
+    /** CPUs to pin instance threads to (empty == any CPU)                      */
+    std::vector<int> cpus;
+};
+
+/** Attribution of processing cost of intermediate and output instances     */
+struct ipx_config_cost {
+    /** Attribution is enabled                                                 */
+    bool enabled = false;
+    /** Measure one of N IPFIX Messages                                        */
+    uint32_t sampling = 64;
+    /** Number of the most expensive sources in reports                        */
+    uint32_t top = 10;
+    /** Interval of periodic reports in seconds (0 == only on termination)     */
+    uint32_t interval = 0;
+};
+
+/** Tracing of a sample of IPFIX Messages through the pipeline                */
+struct ipx_config_trace {
+    /** Tracing is enabled                                                     */
+    bool enabled = false;
+    /** Trace one of N IPFIX Messages received by each input instance          */
+    uint32_t sampling = 1000;
+    /** Number of spans kept per thread                                        */
+    uint32_t buffer_size = 16384;
+    /** Output file of the trace                                               */
+    std::string file = "/tmp/ipfixcol2_trace.json";
+};
+
+/** Live tap of Data Records                                                  */
+struct ipx_config_tap {
+    /** Tap server is enabled                                                  */
+    bool enabled = false;
+    /** Path of the Unix socket of the server                                  */
+    std::string socket = "/tmp/ipfixcol2_tap.sock";
+};
+
 /** Parsed configuration of the collector                                      */
 class ipx_config_model {
     friend class ipx_configurator;
@@ -85,8 +137,19 @@ private:
     std::vector<struct ipx_plugin_inter>  inters;
     /** List of instances of output plugins                                    */
     std::vector<struct ipx_plugin_output> outputs;
+    /** Names of branches of the pipeline (in the order of definition)         */
+    std::vector<std::string> branches;
+    /** Low-latency mode                                                       */
+    struct ipx_config_latency latency;
+    /** Attribution of processing cost                                         */
+    struct ipx_config_cost cost;
+    /** Tracing of messages                                                    */
+    struct ipx_config_trace trace;
+    /** Live tap of Data Records                                               */
+    struct ipx_config_tap tap;
 
     void check_common(struct ipx_plugin_base *base);
+    void check_branch(const std::string &branch, const std::string &name);
 public:
     ipx_config_model() = default;
     ~ipx_config_model() = default;
@@ -112,6 +175,40 @@ public:
      * \throw invalid_argument if there is any obvious configuration error
      */
     void add_instance(struct ipx_plugin_output &instance);
+    /**
+     * \brief Add a branch of the pipeline
+     *
+     * Intermediate and output instances of the branch process messages of the shared part of
+     * the pipeline (i.e. after the shared intermediate instances) independently of other
+     * branches. The branch must be added before its instances.
+     * \param[in] name Name of the branch
+     * \throw invalid_argument if the name is empty or already used
+     */
+    void add_branch(const std::string &name);
+    /**
+     * \brief Enable the low-latency mode
+     * \param[in] cfg Configuration of the mode
+     * \throw invalid_argument if there is any obvious configuration error
+     */
+    void set_latency(const struct ipx_config_latency &cfg);
+    /**
+     * \brief Enable attribution of processing cost
+     * \param[in] cfg Configuration of the attribution
+     * \throw invalid_argument if there is any obvious configuration error
+     */
+    void set_cost(const struct ipx_config_cost &cfg);
+    /**
+     * \brief Enable tracing of messages
+     * \param[in] cfg Configuration of the tracing
+     * \throw invalid_argument if there is any obvious configuration error
+     */
+    void set_trace(const struct ipx_config_trace &cfg);
+    /**
+     * \brief Enable the live tap of Data Records
+     * \param[in] cfg Configuration of the tap
+     * \throw invalid_argument if there is any obvious configuration error
+     */
+    void set_tap(const struct ipx_config_tap &cfg);
 };
 
 #endif //IPFIXCOL_MODEL_H
@@ -658,6 +658,7 @@ ipx_plugin_mgr::plugin::symbol_load_all(void *handle, struct ipx_ctx_callbacks &
     if (type == IPX_PT_INTERMEDIATE || type == IPX_PT_OUTPUT) {
         // Try to find the process function
         *(void **) (&cbs.process) = symbol_get(handle, "ipx_plugin_process");
+        *(void **) (&cbs.tick) = symbol_get(handle, "ipx_plugin_tick", true);
     }
 }
 
@@ -39,9 +39,12 @@
  *
  */
 
+// Get GNU specific pthread_setaffinity_np() function
+#define _GNU_SOURCE
 #include <stdlib.h>
 #include <inttypes.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
 #include <signal.h>
 #include <sys/prctl.h>
@@ -52,6 +55,7 @@
 #include "fpipe.h"
 #include "ring.h"
 #include "message_ipfix.h"
+#include "trace.h"
 
 /** Identification of this component (for log) */
 const char *comp_str = "Context";
@@ -62,6 +66,28 @@ enum ipx_ctx_permissions {
     IPX_CP_MSG_PASS    = (1 << 0),
     /** Permission to subscribe a message         */
     IPX_CP_MSG_SUB     = (1 << 1),
+    /** Permission to register record extensions  */
+    IPX_CP_REXT_REG    = (1 << 2),
+    /** Permission to declare demanded IEs        */
+    IPX_CP_IE_DEMAND   = (1 << 3),
+    /** Permission to request periodic ticks      */
+    IPX_CP_TICK_SET    = (1 << 4),
+};
+
+/** Registered record extension (producer or consumer) */
+struct ipx_ctx_rext {
+    /** Producer (true) or consumer (false)                                   */
+    bool producer;
+    /** Type of the extension                                                 */
+    char *type;
+    /** Name of the extension                                                 */
+    char *name;
+    /** Size of the data (consumers: filled during resolution)                */
+    size_t size;
+    /** Offset of the data from the start of the reserved space in records   */
+    size_t offset;
+    /** Bit of the extension in ipx_ipfix_record::ext_mask                    */
+    uint64_t mask;
 };
 
 /** State of context */
@@ -139,6 +165,36 @@ struct ipx_ctx {
         const fds_iemgr_t *ie_mgr;
         /** Current size of IPFIX record (with registered extensions)                            */
         size_t rec_size;
+        /** ODIDs processed by at least one output instance (NULL == all ODIDs)                  */
+        const ipx_orange_t *odid_sel;
+        /** Number of messages of unwanted ODIDs dropped by the instance                         */
+        uint64_t odid_dropped;
+        /** Do not split Data Sets into Data Records (only for the IPFIX parser)                 */
+        bool split_defer;
+        /** Information Elements demanded by the instance (NULL == all)                          */
+        ipx_ie_demand_t *ie_demand;
+        /** Information Elements demanded by the pipeline (NULL == all, only for the parser)     */
+        const ipx_ie_demand_t *ie_sel;
+        /** Low-latency configuration of the thread                                              */
+        struct ipx_ctx_latency latency;
+        /** Interval of periodic ticks in milliseconds (0 == disabled)                           */
+        uint32_t tick_interval;
+        /** The instance modifies IPFIX Messages (i.e. shared messages must be copied first)     */
+        bool msg_modify;
+        /** Attribution of processing cost (NULL == disabled)                                    */
+        ipx_cost_t *cost;
+        /** Configuration of the attribution of processing cost                                  */
+        struct ipx_ctx_cost cost_cfg;
+        /** Number of IPFIX Messages to process before the next measurement                      */
+        uint32_t cost_skip;
+        /** Time of the next periodic report of processing cost (CLOCK_MONOTONIC_COARSE)         */
+        struct timespec cost_report;
+        /** Tracing of messages is enabled and the thread has a trace buffer                     */
+        bool trace;
+        /** Start of receiving of the next message by the input instance (see ipx_trace_now())  */
+        uint64_t trace_recv;
+        /** Attached client of the live tap (NULL == none, atomic access only)                    */
+        ipx_tap_client_t *tap;
         /** Verbosity level of the plugin                                                        */
         uint8_t  vlevel;
         /**
@@ -150,8 +206,135 @@ struct ipx_ctx {
          */
         unsigned int term_msg_cnt;
     } cfg_system; /**< System configuration                                                      */
+
+    struct {
+        /** Array of registered extensions                                                       */
+        struct ipx_ctx_rext **items;
+        /** Number of extensions in the array                                                    */
+        size_t cnt;
+    } rext; /**< Record extensions of the instance                                               */
 };
 
+/**
+ * \brief Remove all registered record extensions of the instance
+ * \param[in] ctx Plugin context
+ */
+static void
+rext_clear(ipx_ctx_t *ctx)
+{
+    for (size_t i = 0; i < ctx->rext.cnt; ++i) {
+        struct ipx_ctx_rext *rext = ctx->rext.items[i];
+        free(rext->type);
+        free(rext->name);
+        free(rext);
+    }
+
+    free(ctx->rext.items);
+    ctx->rext.items = NULL;
+    ctx->rext.cnt = 0;
+}
+
+/**
+ * \brief Register a new record extension of the instance
+ * \param[in]  ctx      Plugin context
+ * \param[in]  producer Producer or consumer
+ * \param[in]  type     Type of the extension
+ * \param[in]  name     Name of the extension
+ * \param[in]  size     Size of the data (producers only)
+ * \param[out] rext     Reference to the extension
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_EXISTS if the extension has been already registered by the instance
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+rext_register(ipx_ctx_t *ctx, bool producer, const char *type, const char *name, size_t size,
+    ipx_ctx_rext_t **rext)
+{
+    for (size_t i = 0; i < ctx->rext.cnt; ++i) {
+        const struct ipx_ctx_rext *item = ctx->rext.items[i];
+        if (strcmp(item->type, type) == 0 && strcmp(item->name, name) == 0) {
+            IPX_CTX_ERROR(ctx, "Record extension '%s' (type '%s') has been already registered!",
+                name, type);
+            return IPX_ERR_EXISTS;
+        }
+    }
+
+    const size_t items_size = (ctx->rext.cnt + 1) * sizeof(*ctx->rext.items);
+    struct ipx_ctx_rext **items_new = realloc(ctx->rext.items, items_size);
+    if (!items_new) {
+        return IPX_ERR_NOMEM;
+    }
+    ctx->rext.items = items_new;
+
+    struct ipx_ctx_rext *item = calloc(1, sizeof(*item));
+    if (!item) {
+        return IPX_ERR_NOMEM;
+    }
+
+    item->producer = producer;
+    item->size = size;
+    item->type = strdup(type);
+    item->name = strdup(name);
+    if (!item->type || !item->name) {
+        free(item->type);
+        free(item->name);
+        free(item);
+        return IPX_ERR_NOMEM;
+    }
+
+    ctx->rext.items[ctx->rext.cnt++] = item;
+    *rext = item;
+    return IPX_OK;
+}
+
+/**
+ * \brief Report the most expensive sources of the instance
+ *
+ * Measured CPU time is multiplied by the sampling rate to estimate the total cost.
+ * \param[in] ctx Plugin context
+ */
+static void
+cost_report(const ipx_ctx_t *ctx)
+{
+    const ipx_cost_t *cost = ctx->cfg_system.cost;
+    const uint32_t sampling = ctx->cfg_system.cost_cfg.sampling;
+    const uint64_t total = ipx_cost_total(cost);
+    if (total == 0) {
+        IPX_CTX_INFO(ctx, "CPU cost attribution: no IPFIX Messages have been measured yet.", '\0');
+        return;
+    }
+
+    const size_t top_cnt = ctx->cfg_system.cost_cfg.top;
+    struct ipx_cost_entry *top = malloc(top_cnt * sizeof(*top));
+    if (!top) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    const size_t cnt = ipx_cost_top(cost, top, top_cnt);
+    IPX_CTX_INFO(ctx, "CPU cost attribution (1 of %" PRIu32 " IPFIX Messages measured, "
+        "estimated total %.1f ms, %zu source(s)):", sampling, (total * sampling) / 1e6,
+        ipx_cost_cnt(cost));
+
+    for (size_t i = 0; i < cnt; ++i) {
+        const struct ipx_cost_entry *item = &top[i];
+        const double share = (100.0 * item->cost) / total;
+        const double est_ms = (item->cost * sampling) / 1e6;
+
+        if (!item->session) {
+            IPX_CTX_INFO(ctx, "%2zu. %5.1f%% (est. %.1f ms, %" PRIu64 " B measured) "
+                "<other sources>", i + 1, share, est_ms, item->bytes);
+            continue;
+        }
+
+        IPX_CTX_INFO(ctx, "%2zu. %5.1f%% (est. %.1f ms, %" PRIu64 " B measured) %s "
+            "[ODID %" PRIu32 ", Set ID %" PRIu16 "]", i + 1, share, est_ms, item->bytes,
+            item->session, item->odid, item->set_id);
+    }
+
+    free(top);
+}
+
 ipx_ctx_t *
 ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
 {
@@ -176,6 +359,7 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
     ctx->cfg_system.msg_mask_selected = 0; // No messages to process selected
     ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     ctx->cfg_system.term_msg_cnt = 1; // By default, wait for 1 termination message
+    ctx->cfg_system.latency.cpu = -1; // Any CPU
 
     if (callbacks == NULL) {
         // Dummy context for testing
@@ -215,6 +399,25 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
         ctx->pipeline.dst = tmp;
     }
 
+    if (ctx->cfg_system.odid_dropped != 0) {
+        IPX_CTX_INFO(ctx, "%" PRIu64 " message(s) of ODIDs not processed by any output instance "
+            "have been dropped.", ctx->cfg_system.odid_dropped);
+    }
+
+    if (ctx->cfg_system.cost != NULL) {
+        cost_report(ctx);
+        ipx_cost_destroy(ctx->cfg_system.cost);
+    }
+
+    if (ctx->cfg_system.ie_demand != NULL) {
+        ipx_ie_demand_destroy(ctx->cfg_system.ie_demand);
+    }
+
+    if (ctx->cfg_system.tap != NULL) {
+        ipx_tap_client_destroy(ctx->cfg_system.tap);
+    }
+
+    rext_clear(ctx);
     free(ctx->name);
     free(ctx);
 }
@@ -290,6 +493,44 @@ ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t
     return IPX_OK;
 }
 
+/**
+ * \brief Pass Data Records of a message to the attached client of the live tap
+ *
+ * If the client has disconnected, it is detached and destroyed.
+ * \param[in] ctx    Plugin context
+ * \param[in] client Attached client
+ * \param[in] msg    Message passed by the instance
+ */
+static void
+tap_process(struct ipx_ctx *ctx, ipx_tap_client_t *client, ipx_msg_t *msg)
+{
+    if (ipx_msg_get_type(msg) != IPX_MSG_IPFIX
+            || ipx_tap_client_process(client, ipx_msg_base2ipfix(msg)) == IPX_OK) {
+        return;
+    }
+
+    __atomic_store_n(&ctx->cfg_system.tap, NULL, __ATOMIC_RELEASE);
+    IPX_CTX_INFO(ctx, "Tap client detached (%" PRIu64 " Data Record(s) sent).",
+        ipx_tap_client_sent(client));
+    ipx_tap_client_destroy(client);
+}
+
+/**
+ * \brief Pass a message to the live tap of the instance (if a client is attached)
+ *
+ * Without an attached client, the only cost is a single well-predicted branch.
+ * \param[in] ctx Plugin context
+ * \param[in] msg Message passed by the instance
+ */
+static inline void
+tap_pass(struct ipx_ctx *ctx, ipx_msg_t *msg)
+{
+    ipx_tap_client_t *client = __atomic_load_n(&ctx->cfg_system.tap, __ATOMIC_ACQUIRE);
+    if (__builtin_expect(client != NULL, 0)) {
+        tap_process(ctx, client, msg);
+    }
+}
+
 int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
 {
@@ -309,7 +550,23 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_OK;
     }
 
-    ipx_ring_push(ctx->pipeline.dst, msg);
+    if (ctx->cfg_system.trace && ctx->type == IPX_PT_INPUT
+            && ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+        // Input instances decide which messages are traced
+        const uint32_t trace_id = ipx_trace_sample();
+        if (trace_id != 0) {
+            ipx_msg_ipfix_trace_set(ipx_msg_base2ipfix(msg), trace_id);
+            ipx_trace_span(trace_id, "receive", ctx->cfg_system.trace_recv, ipx_trace_now());
+        }
+    }
+
+    // Records must be inspected before the message is available to the successor
+    tap_pass(ctx, msg);
+
+    if (ipx_ring_push(ctx->pipeline.dst, msg)) {
+        // The message has been copied into the ring buffer
+        ipx_msg_destroy(msg);
+    }
     return IPX_OK;
 }
 
@@ -345,6 +602,338 @@ ipx_ctx_iemgr_set(ipx_ctx_t *ctx, const fds_iemgr_t *mgr)
     ctx->cfg_system.ie_mgr = mgr;
 }
 
+void
+ipx_ctx_odid_sel_set(ipx_ctx_t *ctx, const ipx_orange_t *sel)
+{
+    assert(ctx->state != IPX_CS_RUNNING);
+    ctx->cfg_system.odid_sel = sel;
+}
+
+const ipx_orange_t *
+ipx_ctx_odid_sel_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.odid_sel;
+}
+
+void
+ipx_ctx_split_defer_set(ipx_ctx_t *ctx, bool enable)
+{
+    assert(ctx->state != IPX_CS_RUNNING);
+    ctx->cfg_system.split_defer = enable;
+}
+
+bool
+ipx_ctx_split_defer_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.split_defer;
+}
+
+/**
+ * \brief Get Information Elements demanded by the instance (create an empty demand, if necessary)
+ * \param[in]  ctx    Plugin context
+ * \param[out] demand Demand of the instance
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is not allowed to demand Information Elements now
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+ie_demand_prepare(ipx_ctx_t *ctx, ipx_ie_demand_t **demand)
+{
+    const uint16_t plugin_type = ctx->plugin_cbs->info->type;
+    if ((ctx->permissions & IPX_CP_IE_DEMAND) == 0
+            || (plugin_type != IPX_PT_INTERMEDIATE && plugin_type != IPX_PT_OUTPUT)) {
+        IPX_CTX_ERROR(ctx, "Information Elements can be demanded only by Intermediate and Output "
+            "plugins during initialization!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    if (ctx->cfg_system.ie_demand == NULL) {
+        ctx->cfg_system.ie_demand = ipx_ie_demand_create();
+        if (!ctx->cfg_system.ie_demand) {
+            IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    *demand = ctx->cfg_system.ie_demand;
+    return IPX_OK;
+}
+
+int
+ipx_ctx_ie_demand(ipx_ctx_t *ctx, uint32_t en, uint16_t id)
+{
+    ipx_ie_demand_t *demand;
+    int rc = ie_demand_prepare(ctx, &demand);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    return ipx_ie_demand_add(demand, en, id);
+}
+
+int
+ipx_ctx_ie_demand_all(ipx_ctx_t *ctx)
+{
+    ipx_ie_demand_t *demand;
+    int rc = ie_demand_prepare(ctx, &demand);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    ipx_ie_demand_add_all(demand);
+    return IPX_OK;
+}
+
+const ipx_ie_demand_t *
+ipx_ctx_ie_demand_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.ie_demand;
+}
+
+void
+ipx_ctx_ie_sel_set(ipx_ctx_t *ctx, const ipx_ie_demand_t *sel)
+{
+    assert(ctx->state != IPX_CS_RUNNING);
+    ctx->cfg_system.ie_sel = sel;
+}
+
+const ipx_ie_demand_t *
+ipx_ctx_ie_sel_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.ie_sel;
+}
+
+uint16_t
+ipx_ctx_plugin_flags(const ipx_ctx_t *ctx)
+{
+    return ctx->plugin_cbs->info->flags;
+}
+
+void
+ipx_ctx_latency_set(ipx_ctx_t *ctx, const struct ipx_ctx_latency *cfg)
+{
+    assert(ctx->state != IPX_CS_RUNNING);
+    ctx->cfg_system.latency = *cfg;
+}
+
+int
+ipx_ctx_cost_set(ipx_ctx_t *ctx, const struct ipx_ctx_cost *cfg)
+{
+    assert(ctx->state != IPX_CS_RUNNING);
+    const uint16_t plugin_type = ctx->plugin_cbs->info->type;
+    if (plugin_type != IPX_PT_INTERMEDIATE && plugin_type != IPX_PT_OUTPUT) {
+        return IPX_ERR_DENIED;
+    }
+
+    if (cfg->sampling == 0) {
+        // Disable the attribution
+        if (ctx->cfg_system.cost != NULL) {
+            ipx_cost_destroy(ctx->cfg_system.cost);
+            ctx->cfg_system.cost = NULL;
+        }
+        ctx->cfg_system.cost_cfg = *cfg;
+        return IPX_OK;
+    }
+
+    if (ctx->cfg_system.cost == NULL) {
+        ctx->cfg_system.cost = ipx_cost_create();
+        if (!ctx->cfg_system.cost) {
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    ctx->cfg_system.cost_cfg = *cfg;
+    ctx->cfg_system.cost_skip = cfg->sampling;
+    return IPX_OK;
+}
+
+int
+ipx_ctx_tap_attach(ipx_ctx_t *ctx, ipx_tap_client_t *client)
+{
+    if (ctx->plugin_cbs->info->type != IPX_PT_INTERMEDIATE) {
+        return IPX_ERR_DENIED;
+    }
+
+    // The instance detaches the client by itself, so only an empty slot can be replaced
+    ipx_tap_client_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&ctx->cfg_system.tap, &expected, client, false,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+bool
+ipx_ctx_tap_attached(const ipx_ctx_t *ctx)
+{
+    return __atomic_load_n(&ctx->cfg_system.tap, __ATOMIC_ACQUIRE) != NULL;
+}
+
+int
+ipx_ctx_tick_set(ipx_ctx_t *ctx, uint32_t interval)
+{
+    const uint16_t plugin_type = ctx->plugin_cbs->info->type;
+    if ((ctx->permissions & IPX_CP_TICK_SET) == 0
+            || (plugin_type != IPX_PT_INTERMEDIATE && plugin_type != IPX_PT_OUTPUT)) {
+        IPX_CTX_ERROR(ctx, "Periodic ticks can be requested only by Intermediate and Output "
+            "plugins during initialization!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    if (interval != 0 && ctx->plugin_cbs->tick == NULL) {
+        IPX_CTX_ERROR(ctx, "Periodic ticks cannot be requested because the plugin doesn't "
+            "implement the tick callback (ipx_plugin_tick)!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    ctx->cfg_system.tick_interval = interval;
+    return IPX_OK;
+}
+
+uint32_t
+ipx_ctx_busy_poll_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.latency.busy_poll;
+}
+
+bool
+ipx_ctx_odid_wanted(ipx_ctx_t *ctx, uint32_t odid)
+{
+    const ipx_orange_t *sel = ctx->cfg_system.odid_sel;
+    if (!sel || ipx_orange_in(sel, odid)) {
+        return true;
+    }
+
+    ctx->cfg_system.odid_dropped++;
+    return false;
+}
+
+
+int
+ipx_ctx_rext_producer(ipx_ctx_t *ctx, const char *type, const char *name, size_t size,
+    ipx_ctx_rext_t **rext)
+{
+    if ((ctx->permissions & IPX_CP_REXT_REG) == 0
+            || ctx->plugin_cbs->info->type != IPX_PT_INTERMEDIATE) {
+        IPX_CTX_ERROR(ctx, "Record extensions can be produced only by Intermediate plugins "
+            "during initialization!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    if (!type || !name || !rext || size == 0) {
+        return IPX_ERR_ARG;
+    }
+
+    return rext_register(ctx, true, type, name, size, rext);
+}
+
+int
+ipx_ctx_rext_consumer(ipx_ctx_t *ctx, const char *type, const char *name, ipx_ctx_rext_t **rext)
+{
+    const uint16_t plugin_type = ctx->plugin_cbs->info->type;
+    if ((ctx->permissions & IPX_CP_REXT_REG) == 0
+            || (plugin_type != IPX_PT_INTERMEDIATE && plugin_type != IPX_PT_OUTPUT)) {
+        IPX_CTX_ERROR(ctx, "Record extensions can be consumed only by Intermediate and Output "
+            "plugins during initialization!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    if (!type || !name || !rext) {
+        return IPX_ERR_ARG;
+    }
+
+    return rext_register(ctx, false, type, name, 0, rext);
+}
+
+int
+ipx_ctx_rext_get(const ipx_ctx_rext_t *rext, struct ipx_ipfix_record *drec, void **data,
+    size_t *size)
+{
+    *data = &drec->ext[rext->offset];
+    if (size != NULL) {
+        *size = rext->size;
+    }
+
+    return ((drec->ext_mask & rext->mask) != 0) ? IPX_OK : IPX_ERR_NOTFOUND;
+}
+
+void
+ipx_ctx_rext_set_filled(const ipx_ctx_rext_t *rext, struct ipx_ipfix_record *drec)
+{
+    drec->ext_mask |= rext->mask;
+}
+
+int
+ipx_ctx_rext_resolve(ipx_ctx_t **ctxs, size_t cnt, size_t *rec_size)
+{
+    const struct ipx_ctx_rext *producers[IPX_CTX_REXT_MAX];
+    size_t prod_cnt = 0;
+    size_t offset = 0;
+
+    for (size_t i = 0; i < cnt; ++i) {
+        ipx_ctx_t *ctx = ctxs[i];
+
+        // Connect consumers to producers of previous instances
+        for (size_t x = 0; x < ctx->rext.cnt; ++x) {
+            struct ipx_ctx_rext *item = ctx->rext.items[x];
+            if (item->producer) {
+                continue;
+            }
+
+            const struct ipx_ctx_rext *prod = NULL;
+            for (size_t y = 0; y < prod_cnt && !prod; ++y) {
+                if (strcmp(producers[y]->type, item->type) == 0
+                        && strcmp(producers[y]->name, item->name) == 0) {
+                    prod = producers[y];
+                }
+            }
+
+            if (!prod) {
+                IPX_CTX_ERROR(ctx, "No producer of record extension '%s' (type '%s') found "
+                    "before the instance in the pipeline!", item->name, item->type);
+                return IPX_ERR_NOTFOUND;
+            }
+
+            item->size = prod->size;
+            item->offset = prod->offset;
+            item->mask = prod->mask;
+        }
+
+        // Reserve space for extensions produced by the instance
+        for (size_t x = 0; x < ctx->rext.cnt; ++x) {
+            struct ipx_ctx_rext *item = ctx->rext.items[x];
+            if (!item->producer) {
+                continue;
+            }
+
+            for (size_t y = 0; y < prod_cnt; ++y) {
+                if (strcmp(producers[y]->type, item->type) == 0
+                        && strcmp(producers[y]->name, item->name) == 0) {
+                    IPX_CTX_ERROR(ctx, "Record extension '%s' (type '%s') is already produced "
+                        "by another instance!", item->name, item->type);
+                    return IPX_ERR_EXISTS;
+                }
+            }
+
+            if (prod_cnt == IPX_CTX_REXT_MAX) {
+                IPX_CTX_ERROR(ctx, "Too many record extensions (max. %d)!", IPX_CTX_REXT_MAX);
+                return IPX_ERR_LIMIT;
+            }
+
+            item->offset = offset;
+            item->mask = UINT64_C(1) << prod_cnt;
+            producers[prod_cnt++] = item;
+
+            // Keep all extensions (and records) aligned to 8 bytes
+            offset += (item->size + 7U) & ~(size_t) 7U;
+        }
+    }
+
+    *rec_size = IPX_MSG_IPFIX_BASE_REC_SIZE + offset;
+    return IPX_OK;
+}
+
 void
 ipx_ctx_ring_src_set(ipx_ctx_t *ctx, ipx_ring_t *ring)
 {
@@ -357,6 +946,16 @@ ipx_ctx_ring_dst_set(ipx_ctx_t *ctx, ipx_ring_t *ring)
     ctx->pipeline.dst = ring;
 }
 
+const struct ipx_ring_info *
+ipx_ctx_msg_info(const ipx_ctx_t *ctx)
+{
+    if (!ctx->pipeline.src) {
+        return NULL;
+    }
+
+    return ipx_ring_info(ctx->pipeline.src);
+}
+
 
 // -------------------------------------------------------------------------------------------------
 
@@ -485,10 +1084,87 @@ thread_set_name(const char *ident)
     }
 }
 
+/**
+ * \brief Pass a message to the successor of the instance
+ *
+ * If the message has been copied into the ring buffer (see ipx_ring_inline_mode()), the
+ * original message is destroyed.
+ * \param[in] ctx Plugin context
+ * \param[in] msg Message
+ */
+static inline void
+thread_msg_push(struct ipx_ctx *ctx, ipx_msg_t *msg)
+{
+    tap_pass(ctx, msg);
+    if (ipx_ring_push(ctx->pipeline.dst, msg)) {
+        ipx_msg_destroy(msg);
+    }
+}
+
+/**
+ * \brief Get a private copy of an IPFIX Message that is going to be modified by the instance
+ *
+ * If the message is shared by other branches of the pipeline, the instance releases its
+ * reference to the message and gets a copy. Otherwise, the message is returned as it is.
+ * \param[in] ctx Plugin context
+ * \param[in] msg IPFIX Message
+ * \return Private message or NULL (failed to create a copy, the message has been dropped)
+ */
+static ipx_msg_t *
+thread_msg_unshare(struct ipx_ctx *ctx, ipx_msg_t *msg)
+{
+    ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+    ipx_msg_ipfix_t *msg_private = ipx_msg_ipfix_unshare(msg_ipfix);
+    if (!msg_private) {
+        IPX_CTX_ERROR(ctx, "Failed to create a private copy of an IPFIX Message shared by "
+            "multiple branches of the pipeline. The message has been dropped! (%s:%d)",
+            __FILE__, __LINE__);
+        ipx_msg_ipfix_destroy(msg_ipfix);
+        return NULL;
+    }
+
+    return ipx_msg_ipfix2base(msg_private);
+}
+
+/**
+ * \brief Get the type of the last message received from the input ring buffer
+ *
+ * If available, the type stored in the ring buffer is used to avoid access to the message.
+ * \param[in] ctx Plugin context
+ * \param[in] msg Message
+ * \return Type of the message
+ */
+static inline enum ipx_msg_type
+thread_msg_type(const struct ipx_ctx *ctx, ipx_msg_t *msg)
+{
+    const struct ipx_ring_info *info = ipx_ring_info(ctx->pipeline.src);
+    return (info != NULL) ? info->type : ipx_msg_get_type(msg);
+}
+
 /**
  * \brief Get the name of a thread
  * \param[out] ident Current identification
  */
+/**
+ * \brief Create a trace buffer of the thread (only if tracing is enabled)
+ * \param[in] ctx Plugin context
+ */
+static void
+thread_trace_init(struct ipx_ctx *ctx)
+{
+    if (!ipx_trace_enabled()) {
+        return;
+    }
+
+    if (ipx_trace_thread_init(ctx->name) != IPX_OK) {
+        IPX_CTX_WARNING(ctx, "Failed to create a trace buffer. Messages will not be traced by "
+            "the instance.", '\0');
+        return;
+    }
+
+    ctx->cfg_system.trace = true;
+}
+
 static inline void
 thread_get_name(char ident[16])
 {
@@ -585,9 +1261,10 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
     // Try to initialize the plugin
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Calling instance constructor of the plugin '%s'", plugin_name);
-    // Temporarily remove permission to pass messages
+    // Temporarily remove permission to pass messages and allow registration of extensions (and IEs)
     uint32_t permissions_old = ctx->permissions;
     ctx->permissions &= ~(uint32_t) IPX_CP_MSG_PASS;
+    ctx->permissions |= IPX_CP_REXT_REG | IPX_CP_IE_DEMAND | IPX_CP_TICK_SET;
     rc = ctx->plugin_cbs->init(ctx, params);
     ctx->permissions = permissions_old;
 
@@ -598,6 +1275,7 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
     if (rc != IPX_OK) {
         IPX_CTX_ERROR(ctx, "Initialization function of the instance failed!", '\0');
         // Restore default default parameters
+        rext_clear(ctx);
         ctx->permissions = 0;
         ctx->cfg_system.msg_mask_selected = 0;
         ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION;
@@ -612,6 +1290,15 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         IPX_CTX_WARNING(ctx, "The instance didn't set its private data.", '\0');
     }
 
+    if (plugin_type == IPX_PT_INTERMEDIATE) {
+        // Record extensions are stored in Data Records, so producers modify messages too
+        bool modify = (ctx->plugin_cbs->info->flags & IPX_PF_MSG_MODIFY) != 0;
+        for (size_t i = 0; i < ctx->rext.cnt && !modify; ++i) {
+            modify = ctx->rext.items[i]->producer;
+        }
+        ctx->cfg_system.msg_modify = modify;
+    }
+
     ctx->type = plugin_type;
     ctx->state = IPX_CS_INIT;
     return IPX_OK;
@@ -667,13 +1354,13 @@ thread_input_process_pipe(struct ipx_ctx *ctx)
         IPX_CTX_DEBUG(ctx, "Calling instance destructor of the input plugin '%s'", plugin_name);
         ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
         // Pass the termination message
-        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+        thread_msg_push(ctx, msg_ptr);
         return IPX_ERR_EOF;
     }
 
     IPX_CTX_ERROR(ctx, "Received unexpected message from the feedback pipe (type %d). "
         "It will be passed on to an IPFIX parser.", msg_type);
-    ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    thread_msg_push(ctx, msg_ptr);
     return IPX_OK;
 }
 
@@ -691,6 +1378,8 @@ thread_input(void *arg)
     assert(ctx->type == IPX_PT_INPUT);
     thread_set_name(ctx->name);
 
+    thread_trace_init(ctx);
+
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the input plugin '%s' has started!", plugin_name);
 
@@ -705,6 +1394,9 @@ thread_input(void *arg)
         }
 
         // Try to get a new IPFIX message
+        if (ctx->cfg_system.trace) {
+            ctx->cfg_system.trace_recv = ipx_trace_now();
+        }
         ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private); // TODO: check return value
     }
 
@@ -713,6 +1405,178 @@ thread_input(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Plan the next tick of the instance (after the tick interval from now)
+ * \param[in]  ctx  Plugin context
+ * \param[out] next Time of the next tick (CLOCK_MONOTONIC)
+ */
+static void
+thread_tick_plan(const struct ipx_ctx *ctx, struct timespec *next)
+{
+    const uint32_t interval = ctx->cfg_system.tick_interval;
+    clock_gettime(CLOCK_MONOTONIC, next);
+    next->tv_sec += interval / 1000U;
+    next->tv_nsec += (long) (interval % 1000U) * 1000000L;
+    if (next->tv_nsec >= 1000000000L) {
+        next->tv_nsec -= 1000000000L;
+        next->tv_sec += 1;
+    }
+}
+
+/**
+ * \brief Call the tick callback of the instance and plan the next tick
+ *
+ * The next tick is planned after the interval from now, i.e. missed ticks (e.g. due to long
+ * processing of a message) are never accumulated.
+ * \param[in]     ctx  Plugin context
+ * \param[in,out] next Time of the next tick (CLOCK_MONOTONIC)
+ */
+static void
+thread_tick(struct ipx_ctx *ctx, struct timespec *next)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    ctx->plugin_cbs->tick(ctx, ctx->cfg_plugin.private, &now);
+    thread_tick_plan(ctx, next);
+}
+
+/**
+ * \brief Get the next message from the input ring buffer and deliver ticks (if requested)
+ *
+ * If the instance requested periodic ticks, the tick callback is called between processing
+ * of messages (i.e. in order with the stream of messages) as soon as the tick interval expires.
+ * The expiration is checked using a coarse clock to keep the overhead per message negligible.
+ * \param[in]     ctx     Plugin context
+ * \param[in]     tick_en Enable delivery of ticks
+ * \param[in,out] next    Time of the next tick (CLOCK_MONOTONIC)
+ * \return Message
+ */
+static ipx_msg_t *
+thread_msg_get(struct ipx_ctx *ctx, bool tick_en, struct timespec *next)
+{
+    if (!tick_en || ctx->cfg_system.tick_interval == 0) {
+        return ipx_ring_pop(ctx->pipeline.src);
+    }
+
+    while (true) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        if (now.tv_sec < next->tv_sec
+                || (now.tv_sec == next->tv_sec && now.tv_nsec < next->tv_nsec)) {
+            ipx_msg_t *msg = ipx_ring_pop_timed(ctx->pipeline.src, next);
+            if (msg != NULL) {
+                return msg;
+            }
+        }
+
+        // The interval has expired
+        thread_tick(ctx, next);
+    }
+}
+
+/**
+ * \brief Plan the next periodic report of processing cost of the instance
+ * \param[in] ctx Plugin context
+ */
+static void
+thread_cost_plan(struct ipx_ctx *ctx)
+{
+    struct timespec *next = &ctx->cfg_system.cost_report;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, next);
+    next->tv_sec += ctx->cfg_system.cost_cfg.interval;
+}
+
+/**
+ * \brief Process an IPFIX Message and measure its processing cost
+ *
+ * If the interval of periodic reports has expired, the report is also generated.
+ * \param[in] ctx Plugin context
+ * \param[in] msg IPFIX Message
+ */
+static void
+thread_process_measured(struct ipx_ctx *ctx, ipx_msg_t *msg)
+{
+    ipx_cost_t *cost = ctx->cfg_system.cost;
+    ctx->cfg_system.cost_skip = ctx->cfg_system.cost_cfg.sampling;
+
+    // The message can be passed on by the instance, so Sets must be inspected in advance
+    if (ipx_cost_begin(cost, ipx_msg_base2ipfix(msg)) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg); // TODO:check return value
+        return;
+    }
+
+    ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg); // TODO:check return value
+    ipx_cost_end(cost);
+
+    if (ctx->cfg_system.cost_cfg.interval == 0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    const struct timespec *next = &ctx->cfg_system.cost_report;
+    if (now.tv_sec > next->tv_sec
+            || (now.tv_sec == next->tv_sec && now.tv_nsec >= next->tv_nsec)) {
+        cost_report(ctx);
+        thread_cost_plan(ctx);
+    }
+}
+
+/**
+ * \brief Get the trace ID of the last message received from the input ring buffer
+ * \param[in] ctx      Plugin context
+ * \param[in] msg_type Type of the message
+ * \return Trace ID or 0, if the message is not traced
+ */
+static inline uint32_t
+thread_trace_id(const struct ipx_ctx *ctx, enum ipx_msg_type msg_type)
+{
+    if (!ctx->cfg_system.trace || msg_type != IPX_MSG_IPFIX) {
+        return 0;
+    }
+
+    const struct ipx_ring_info *info = ipx_ring_info(ctx->pipeline.src);
+    return (info != NULL) ? info->trace_id : 0;
+}
+
+/**
+ * \brief Pass a message to the processing callback of the instance
+ *
+ * If attribution of processing cost is enabled, a sample of IPFIX Messages is measured.
+ * If the message is traced, the time spent in the input ring buffer and the processing are
+ * recorded as spans.
+ * \param[in] ctx      Plugin context
+ * \param[in] msg      Message
+ * \param[in] msg_type Type of the message
+ */
+static inline void
+thread_process(struct ipx_ctx *ctx, ipx_msg_t *msg, enum ipx_msg_type msg_type)
+{
+    // The message can be passed on (or destroyed) by the instance, get the ID in advance
+    const uint32_t trace_id = thread_trace_id(ctx, msg_type);
+    uint64_t trace_start = 0;
+    if (trace_id != 0) {
+        const uint64_t pushed = ipx_ring_trace_pushed(ctx->pipeline.src);
+        trace_start = ipx_trace_now();
+        if (pushed != 0) {
+            ipx_trace_span(trace_id, "queue", pushed, trace_start);
+        }
+    }
+
+    if (ctx->cfg_system.cost != NULL && msg_type == IPX_MSG_IPFIX
+            && --ctx->cfg_system.cost_skip == 0) {
+        thread_process_measured(ctx, msg);
+    } else {
+        ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg); // TODO:check return value
+    }
+
+    if (trace_id != 0) {
+        const char *name = (ctx->type == IPX_PT_OUTPUT_MGR) ? "dispatch" : "process";
+        ipx_trace_span(trace_id, name, trace_start, ipx_trace_now());
+    }
+}
+
 /**
  * \brief Intermediate instance control thread
  *
@@ -728,6 +1592,8 @@ thread_intermediate(void *arg)
     assert(ctx->type == IPX_PT_INTERMEDIATE || ctx->type == IPX_PT_OUTPUT_MGR);
     thread_set_name(ctx->name);
 
+    thread_trace_init(ctx);
+
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has started!", plugin_name);
 
@@ -736,11 +1602,14 @@ thread_intermediate(void *arg)
 
     bool terminate = false;
     bool process_en = true; // enable message processing
+    struct timespec tick_next;
+    thread_tick_plan(ctx, &tick_next);
+    thread_cost_plan(ctx);
 
     while (!terminate) {
         // Get a new message for the buffer
-        msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        msg_type = ipx_msg_get_type(msg_ptr);
+        msg_ptr = thread_msg_get(ctx, process_en, &tick_next);
+        msg_type = thread_msg_type(ctx, msg_ptr);
         bool processed = false; // only not processed messages are automatically passed
 
         if (msg_type == IPX_MSG_TERMINATE) {
@@ -764,8 +1633,16 @@ thread_intermediate(void *arg)
 
         if ((process_en && (msg_type & ctx->cfg_system.msg_mask_selected) != 0)
                 || ctx->type == IPX_PT_OUTPUT_MGR) { // Always pass all messages to the output manager
+            if (msg_type == IPX_MSG_IPFIX && ctx->cfg_system.msg_modify) {
+                // Modifications must not be visible to other branches of the pipeline
+                msg_ptr = thread_msg_unshare(ctx, msg_ptr);
+                if (!msg_ptr) {
+                    continue;
+                }
+            }
+
             // Process the message
-            ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr); // TODO:check return value
+            thread_process(ctx, msg_ptr, msg_type);
             processed = true;
         }
 
@@ -774,7 +1651,7 @@ thread_intermediate(void *arg)
              * Note: Termination message is passed after intermediate instance destructor!
              */
             assert(ctx->type != IPX_PT_OUTPUT_MGR);
-            ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+            thread_msg_push(ctx, msg_ptr);
         }
     }
 
@@ -786,7 +1663,7 @@ thread_intermediate(void *arg)
     assert(msg_type == IPX_MSG_TERMINATE);
     if (ctx->type != IPX_PT_OUTPUT_MGR) {
         // All intermediate plugins (except the output manager) have to pass the message here
-        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+        thread_msg_push(ctx, msg_ptr);
     }
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has been terminated!",
@@ -808,20 +1685,25 @@ thread_output(void *arg)
     assert(ctx->type == IPX_PT_OUTPUT);
     thread_set_name(ctx->name);
 
+    thread_trace_init(ctx);
+
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has started!", plugin_name);
 
     bool terminate = false;
     bool process_en = true; // enable message processing
+    struct timespec tick_next;
+    thread_tick_plan(ctx, &tick_next);
+    thread_cost_plan(ctx);
 
     while (!terminate) {
         // Get a new message for the buffer
-        ipx_msg_t *msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+        ipx_msg_t *msg_ptr = thread_msg_get(ctx, process_en, &tick_next);
+        enum ipx_msg_type msg_type = thread_msg_type(ctx, msg_ptr);
 
         if (process_en && (msg_type & ctx->cfg_system.msg_mask_selected) != 0) {
             // Process the message
-            ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr); // TODO:check return value
+            thread_process(ctx, msg_ptr, msg_type);
         }
 
         if (msg_type == IPX_MSG_TERMINATE) {
@@ -853,6 +1735,42 @@ thread_output(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Apply CPU affinity and real-time scheduling of the thread (if configured)
+ *
+ * Failures are not fatal, the thread just keeps the default settings.
+ * \param[in] ctx Plugin context (the thread must be running)
+ */
+static void
+thread_sched_set(ipx_ctx_t *ctx)
+{
+    const struct ipx_ctx_latency *latency = &ctx->cfg_system.latency;
+    const char *err_str;
+    int rc;
+
+    if (latency->cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(latency->cpu, &cpus);
+        if ((rc = pthread_setaffinity_np(ctx->thread_id, sizeof(cpus), &cpus)) != 0) {
+            ipx_strerror(rc, err_str);
+            IPX_CTX_WARNING(ctx, "Failed to pin the instance thread to CPU %d: %s", latency->cpu,
+                err_str);
+        } else {
+            IPX_CTX_DEBUG(ctx, "The instance thread has been pinned to CPU %d.", latency->cpu);
+        }
+    }
+
+    if (latency->rt_prio > 0) {
+        struct sched_param param = {.sched_priority = latency->rt_prio};
+        if ((rc = pthread_setschedparam(ctx->thread_id, SCHED_FIFO, &param)) != 0) {
+            ipx_strerror(rc, err_str);
+            IPX_CTX_WARNING(ctx, "Failed to set real-time scheduling (SCHED_FIFO, priority %d) "
+                "of the instance thread: %s", latency->rt_prio, err_str);
+        }
+    }
+}
+
 int
 ipx_ctx_run(ipx_ctx_t *ctx)
 {
@@ -880,6 +1798,12 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         return IPX_ERR_DENIED;
     }
 
+    // The thread (i.e. the reader of the ring) is not running yet, so the mode can be changed
+    const struct ipx_ctx_latency *latency = &ctx->cfg_system.latency;
+    if (latency->spin && ctx->pipeline.src != NULL) {
+        ipx_ring_busy_mode(ctx->pipeline.src, true);
+    }
+
     // Block processing all signals
     sigset_t set_new, set_old;
     sigfillset(&set_new);
@@ -901,5 +1825,6 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         return IPX_ERR_DENIED;
     }
 
+    thread_sched_set(ctx);
     return IPX_OK;
 }
@@ -44,8 +44,12 @@
 
 #include <ipfixcol2.h>
 #include <libfds.h>
+#include "cost.h"
 #include "fpipe.h"
+#include "ie_demand.h"
+#include "odid_range.h"
 #include "ring.h"
+#include "tap.h"
 
 /** List of plugin callbacks  */
 struct ipx_ctx_callbacks {
@@ -65,6 +69,8 @@ struct ipx_ctx_callbacks {
     int  (*process) (ipx_ctx_t *, void *, ipx_msg_t *);
     /** Close session request (INPUT plugins only, can be NULL)                 */
     void  (*ts_close)(ipx_ctx_t *, void *, const struct ipx_session *);
+    /** Periodic tick (INTERMEDIATE and OUTPUT plugins only, can be NULL)      */
+    void  (*tick)    (ipx_ctx_t *, void *, const struct timespec *);
 };
 
 /** Identification number of output manager plugin */
@@ -223,6 +229,18 @@ ipx_ctx_ring_src_set(ipx_ctx_t *ctx, ipx_ring_t *ring);
 IPX_API void
 ipx_ctx_ring_dst_set(ipx_ctx_t *ctx, ipx_ring_t *ring);
 
+/**
+ * \brief Get properties of the message that is being processed by the instance
+ *
+ * The properties are taken from the source ring buffer, so the message doesn't have to be
+ * accessed (see ipx_ring_info()).
+ * \warning Can be called only from the instance thread (e.g. from the processing callback).
+ * \param[in] ctx Plugin context
+ * \return Pointer to the properties or NULL (not available)
+ */
+IPX_API const struct ipx_ring_info *
+ipx_ctx_msg_info(const ipx_ctx_t *ctx);
+
 /**
  * \brief Set a reference to a manager of Information Elements
  * \param[in] ctx Plugin context
@@ -231,6 +249,160 @@ ipx_ctx_ring_dst_set(ipx_ctx_t *ctx, ipx_ring_t *ring);
 IPX_API void
 ipx_ctx_iemgr_set(ipx_ctx_t *ctx, const fds_iemgr_t *mgr);
 
+/**
+ * \brief Set ODIDs processed by at least one output instance
+ *
+ * Input plugins (see ipx_ctx_odid_wanted()) and parsers of IPFIX Messages use the selection to
+ * drop messages of unwanted Observation Domains as soon as possible.
+ * \note The selection MUST exist at least until the context is destroyed or the selection is
+ *   replaced. The selection can be changed only if the instance is not running.
+ * \param[in] ctx Plugin context
+ * \param[in] sel Selection of ODIDs (NULL == all ODIDs)
+ */
+IPX_API void
+ipx_ctx_odid_sel_set(ipx_ctx_t *ctx, const ipx_orange_t *sel);
+
+/**
+ * \brief Get ODIDs processed by at least one output instance
+ * \param[in] ctx Plugin context
+ * \return Selection of ODIDs or NULL (all ODIDs)
+ */
+IPX_API const ipx_orange_t *
+ipx_ctx_odid_sel_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Defer splitting of Data Sets into Data Records (only for the IPFIX parser)
+ *
+ * The option should be enabled only if all following instances have the #IPX_PF_SET_LEVEL flag.
+ * \note The option can be changed only if the instance is not running.
+ * \param[in] ctx    Plugin context
+ * \param[in] enable Enable/disable (disabled by default)
+ */
+IPX_API void
+ipx_ctx_split_defer_set(ipx_ctx_t *ctx, bool enable);
+
+/**
+ * \brief Check if splitting of Data Sets into Data Records is deferred
+ * \param[in] ctx Plugin context
+ * \return True or false
+ */
+IPX_API bool
+ipx_ctx_split_defer_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get Information Elements demanded by the instance (see ipx_ctx_ie_demand())
+ * \param[in] ctx Plugin context
+ * \return Demand or NULL (all Information Elements)
+ */
+IPX_API const ipx_ie_demand_t *
+ipx_ctx_ie_demand_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Set Information Elements demanded by at least one instance of the pipeline
+ *
+ * The IPFIX parser uses the demand to skip Data Sets of (Options) Templates without any
+ * demanded field.
+ * \note The demand MUST exist at least until the context is destroyed or the demand is
+ *   replaced. The demand can be changed only if the instance is not running.
+ * \param[in] ctx Plugin context
+ * \param[in] sel Demand of the pipeline (NULL == all Information Elements)
+ */
+IPX_API void
+ipx_ctx_ie_sel_set(ipx_ctx_t *ctx, const ipx_ie_demand_t *sel);
+
+/**
+ * \brief Get Information Elements demanded by at least one instance of the pipeline
+ * \param[in] ctx Plugin context
+ * \return Demand or NULL (all Information Elements)
+ */
+IPX_API const ipx_ie_demand_t *
+ipx_ctx_ie_sel_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get configuration flags of the plugin (see ipx_plugin_info::flags)
+ * \param[in] ctx Plugin context
+ * \return Flags
+ */
+IPX_API uint16_t
+ipx_ctx_plugin_flags(const ipx_ctx_t *ctx);
+
+/** Low-latency configuration of an instance thread */
+struct ipx_ctx_latency {
+    /** Busy polling timeout of sockets of input plugins (in microseconds, 0 == disabled)  */
+    uint32_t busy_poll;
+    /** Spin on the input ring buffer instead of sleeping (see ipx_ring_busy_mode())        */
+    bool spin;
+    /** CPU to pin the thread to (negative == any CPU)                                        */
+    int cpu;
+    /** SCHED_FIFO priority of the thread (0 == default scheduling policy)                     */
+    int rt_prio;
+};
+
+/**
+ * \brief Set low-latency configuration of the instance thread (disabled by default)
+ *
+ * The configuration is applied when the thread is started (see ipx_ctx_run()). Failures to set
+ * CPU affinity or real-time scheduling are reported as warnings only.
+ * \note The configuration can be changed only if the instance is not running.
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Configuration
+ */
+IPX_API void
+ipx_ctx_latency_set(ipx_ctx_t *ctx, const struct ipx_ctx_latency *cfg);
+
+/** Attribution of processing cost of an instance */
+struct ipx_ctx_cost {
+    /** Measure one of N IPFIX Messages (0 == disabled)                                       */
+    uint32_t sampling;
+    /** Number of the most expensive sources in reports                                        */
+    uint32_t top;
+    /** Interval of periodic reports in seconds (0 == only when the instance is destroyed)    */
+    uint32_t interval;
+};
+
+/**
+ * \brief Enable attribution of processing cost of the instance (disabled by default)
+ *
+ * CPU time spent by the instance on a sample of IPFIX Messages is measured and attributed to
+ * combinations of a Transport Session, ODID and Template ID (see \ref ipxCost). The most
+ * expensive combinations are reported periodically (if configured) and when the context is
+ * destroyed.
+ * \note Only intermediate and output instances are supported. The configuration can be changed
+ *   only if the instance is not running.
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is not an intermediate or output instance
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_ctx_cost_set(ipx_ctx_t *ctx, const struct ipx_ctx_cost *cfg);
+
+/**
+ * \brief Attach a client of the live tap to the instance (see \ref ipxTap)
+ *
+ * Data Records of IPFIX Messages passed by the instance to its successor are passed to the
+ * client. The client is detached and destroyed by the instance when it disconnects or when
+ * the context is destroyed.
+ * \note Only intermediate instances (including the IPFIX parser) are supported. The function
+ *   can be called while the instance is running.
+ * \param[in] ctx    Plugin context
+ * \param[in] client Client (ownership is transferred to the context only on success)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is not an intermediate instance or another client
+ *   is already attached
+ */
+IPX_API int
+ipx_ctx_tap_attach(ipx_ctx_t *ctx, ipx_tap_client_t *client);
+
+/**
+ * \brief Check if a client of the live tap is attached to the instance
+ * \param[in] ctx Plugin context
+ * \return True or false
+ */
+IPX_API bool
+ipx_ctx_tap_attached(const ipx_ctx_t *ctx);
+
 /**
  * \brief Set verbosity of the context
  * \param[in] ctx  Plugin context
@@ -264,4 +436,23 @@ ipx_ctx_verb_set(ipx_ctx_t *ctx, enum ipx_verb_level verb);
 IPX_API int
 ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt);
 
+/**
+ * \brief Resolve record extensions registered by instances of the pipeline
+ *
+ * Producers of all extensions are assigned a position in the reserved space of Data Records and
+ * consumers are connected to their producers. Each consumer must have a producer that is placed
+ * before it in the pipeline (i.e. at a lower index in the array of contexts).
+ *
+ * \warning All contexts must be initialized, but their threads cannot be running!
+ * \param[in]  ctxs     Array of intermediate and output contexts (in order of the pipeline)
+ * \param[in]  cnt      Number of contexts in the array
+ * \param[out] rec_size Size of one IPFIX record with all extensions (in bytes)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if a consumer doesn't have its producer
+ * \return #IPX_ERR_EXISTS if an extension has multiple producers
+ * \return #IPX_ERR_LIMIT if the number of produced extensions exceeds #IPX_CTX_REXT_MAX
+ */
+IPX_API int
+ipx_ctx_rext_resolve(ipx_ctx_t **ctxs, size_t cnt, size_t *rec_size);
+
 #endif // IPFIXCOL_CONTEXT_INTERNAL_H
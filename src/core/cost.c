@@ -0,0 +1,436 @@
+/**
+ * \file src/core/cost.c
+ * \author agent <agent@local>
+ * \brief Attribution of processing cost to flow sources (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "cost.h"
+
+/** Initial number of slots of the hash table (must be a power of two)      */
+#define SLOTS_DEF_CNT 64U
+/** Maximum number of slots of the hash table (load factor is at most 50%) */
+#define SLOTS_MAX_CNT (2U * IPX_COST_MAX_ENTRIES)
+/** Default number of pre-allocated parts of a measurement                 */
+#define PARTS_DEF_CNT 16U
+
+/** Accumulated cost of a combination (slot of the hash table) */
+struct cost_item {
+    /** Identification of the Transport Session (NULL == empty slot)       */
+    char *session;
+    /** Hash of the combination                                             */
+    uint32_t hash;
+    /** Observation Domain ID                                               */
+    uint32_t odid;
+    /** Set ID                                                              */
+    uint16_t set_id;
+    /** Measured CPU time (in nanoseconds)                                  */
+    uint64_t cost;
+    /** Size of measured Sets (in bytes)                                    */
+    uint64_t bytes;
+};
+
+/** Part of a measured message (all Sets with the same Set ID) */
+struct cost_part {
+    /** Set ID                                                              */
+    uint16_t set_id;
+    /** Total size of the Sets                                              */
+    uint64_t bytes;
+};
+
+/** Cost table */
+struct ipx_cost {
+    /** Hash table of combinations (open addressing, linear probing)        */
+    struct cost_item *slots;
+    /** Number of slots (power of two)                                      */
+    size_t slots_cnt;
+    /** Number of used slots                                                */
+    size_t items_cnt;
+    /** Cost of combinations that don't fit into the table                  */
+    struct cost_item other;
+    /** Total measured CPU time (in nanoseconds)                            */
+    uint64_t total;
+
+    struct {
+        /** Identification of the Transport Session of the message           */
+        const char *session;
+        /** Observation Domain ID of the message                              */
+        uint32_t odid;
+        /** CPU time at the beginning of the measurement                      */
+        struct timespec start;
+        /** Parts of the message                                              */
+        struct cost_part *parts;
+        /** Number of valid parts                                             */
+        size_t parts_valid;
+        /** Number of allocated parts                                         */
+        size_t parts_alloc;
+    } msr; /**< The current measurement                                      */
+};
+
+/**
+ * \brief Calculate a hash of a combination (FNV-1a)
+ * \param[in] session Identification of the Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] set_id  Set ID
+ * \return Hash
+ */
+static uint32_t
+cost_hash(const char *session, uint32_t odid, uint16_t set_id)
+{
+    uint32_t hash = 2166136261U;
+    for (const char *ch = session; *ch != '\0'; ++ch) {
+        hash = (hash ^ (uint8_t) *ch) * 16777619U;
+    }
+
+    const uint8_t numbers[6] = {
+        (uint8_t) (odid >> 24), (uint8_t) (odid >> 16), (uint8_t) (odid >> 8), (uint8_t) odid,
+        (uint8_t) (set_id >> 8), (uint8_t) set_id
+    };
+    for (size_t i = 0; i < sizeof(numbers); ++i) {
+        hash = (hash ^ numbers[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Double the size of the hash table
+ * \param[in] cost Cost table
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred (the table is unchanged)
+ */
+static int
+cost_grow(ipx_cost_t *cost)
+{
+    const size_t cnt_new = 2 * cost->slots_cnt;
+    struct cost_item *slots_new = calloc(cnt_new, sizeof(*slots_new));
+    if (!slots_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < cost->slots_cnt; ++i) {
+        const struct cost_item *item = &cost->slots[i];
+        if (!item->session) {
+            continue;
+        }
+
+        size_t idx = item->hash & (cnt_new - 1);
+        while (slots_new[idx].session != NULL) {
+            idx = (idx + 1) & (cnt_new - 1);
+        }
+        slots_new[idx] = *item;
+    }
+
+    free(cost->slots);
+    cost->slots = slots_new;
+    cost->slots_cnt = cnt_new;
+    return IPX_OK;
+}
+
+/**
+ * \brief Find a combination in the table (add it, if missing)
+ *
+ * If the table is full, the accumulator of other sources is returned.
+ * \param[in] cost    Cost table
+ * \param[in] session Identification of the Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] set_id  Set ID
+ * \return Pointer to the combination or NULL (memory allocation error)
+ */
+static struct cost_item *
+cost_find(ipx_cost_t *cost, const char *session, uint32_t odid, uint16_t set_id)
+{
+    const uint32_t hash = cost_hash(session, odid, set_id);
+    size_t idx = hash & (cost->slots_cnt - 1);
+
+    while (cost->slots[idx].session != NULL) {
+        struct cost_item *item = &cost->slots[idx];
+        if (item->hash == hash && item->odid == odid && item->set_id == set_id
+                && strcmp(item->session, session) == 0) {
+            return item;
+        }
+        idx = (idx + 1) & (cost->slots_cnt - 1);
+    }
+
+    // Not found -> add a new combination
+    if (cost->items_cnt >= IPX_COST_MAX_ENTRIES) {
+        return &cost->other;
+    }
+
+    if (2 * (cost->items_cnt + 1) > cost->slots_cnt) {
+        if (cost_grow(cost) != IPX_OK) {
+            return NULL;
+        }
+
+        // Find an empty slot in the new table
+        idx = hash & (cost->slots_cnt - 1);
+        while (cost->slots[idx].session != NULL) {
+            idx = (idx + 1) & (cost->slots_cnt - 1);
+        }
+    }
+
+    struct cost_item *item = &cost->slots[idx];
+    item->session = strdup(session);
+    if (!item->session) {
+        return NULL;
+    }
+
+    item->hash = hash;
+    item->odid = odid;
+    item->set_id = set_id;
+    item->cost = 0;
+    item->bytes = 0;
+    cost->items_cnt++;
+    return item;
+}
+
+ipx_cost_t *
+ipx_cost_create()
+{
+    struct ipx_cost *cost = calloc(1, sizeof(*cost));
+    if (!cost) {
+        return NULL;
+    }
+
+    cost->slots = calloc(SLOTS_DEF_CNT, sizeof(*cost->slots));
+    cost->msr.parts = malloc(PARTS_DEF_CNT * sizeof(*cost->msr.parts));
+    if (!cost->slots || !cost->msr.parts) {
+        free(cost->slots);
+        free(cost->msr.parts);
+        free(cost);
+        return NULL;
+    }
+
+    cost->slots_cnt = SLOTS_DEF_CNT;
+    cost->msr.parts_alloc = PARTS_DEF_CNT;
+    return cost;
+}
+
+void
+ipx_cost_destroy(ipx_cost_t *cost)
+{
+    for (size_t i = 0; i < cost->slots_cnt; ++i) {
+        free(cost->slots[i].session);
+    }
+
+    free(cost->slots);
+    free(cost->msr.parts);
+    free(cost);
+}
+
+/**
+ * \brief Add a Set to the current measurement (Sets with the same ID are merged)
+ * \param[in] cost   Cost table
+ * \param[in] set_id Set ID
+ * \param[in] bytes  Size of the Set
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+cost_part_add(ipx_cost_t *cost, uint16_t set_id, uint64_t bytes)
+{
+    for (size_t i = 0; i < cost->msr.parts_valid; ++i) {
+        if (cost->msr.parts[i].set_id == set_id) {
+            cost->msr.parts[i].bytes += bytes;
+            return IPX_OK;
+        }
+    }
+
+    if (cost->msr.parts_valid == cost->msr.parts_alloc) {
+        const size_t alloc_new = 2 * cost->msr.parts_alloc;
+        struct cost_part *parts_new = realloc(cost->msr.parts, alloc_new * sizeof(*parts_new));
+        if (!parts_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        cost->msr.parts = parts_new;
+        cost->msr.parts_alloc = alloc_new;
+    }
+
+    struct cost_part *part = &cost->msr.parts[cost->msr.parts_valid++];
+    part->set_id = set_id;
+    part->bytes = bytes;
+    return IPX_OK;
+}
+
+int
+ipx_cost_begin(ipx_cost_t *cost, ipx_msg_ipfix_t *msg)
+{
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    cost->msr.session = (msg_ctx->session != NULL) ? msg_ctx->session->ident : "";
+    cost->msr.odid = msg_ctx->odid;
+    cost->msr.parts_valid = 0;
+
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &sets_cnt);
+
+    for (size_t i = 0; i < sets_cnt; ++i) {
+        const struct fds_ipfix_set_hdr *hdr = sets[i].ptr;
+        if (cost_part_add(cost, ntohs(hdr->flowset_id), ntohs(hdr->length)) != IPX_OK) {
+            cost->msr.session = NULL;
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cost->msr.start);
+    return IPX_OK;
+}
+
+void
+ipx_cost_end(ipx_cost_t *cost)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    if (!cost->msr.session) {
+        // The measurement hasn't been started
+        return;
+    }
+
+    int64_t diff = (int64_t) (now.tv_sec - cost->msr.start.tv_sec) * 1000000000LL
+        + (now.tv_nsec - cost->msr.start.tv_nsec);
+    const uint64_t ns = (diff > 0) ? (uint64_t) diff : 0;
+
+    uint64_t bytes_total = 0;
+    for (size_t i = 0; i < cost->msr.parts_valid; ++i) {
+        bytes_total += cost->msr.parts[i].bytes;
+    }
+
+    if (bytes_total == 0) {
+        // No Sets (or only empty ones) -> the whole cost belongs to the message itself
+        ipx_cost_add(cost, cost->msr.session, cost->msr.odid, 0, ns, 0);
+    } else {
+        // Split the cost proportionally to the size of Sets (the rest goes to the last one)
+        uint64_t ns_rest = ns;
+        for (size_t i = 0; i < cost->msr.parts_valid; ++i) {
+            const struct cost_part *part = &cost->msr.parts[i];
+            const uint64_t ns_part = (i + 1 == cost->msr.parts_valid)
+                ? ns_rest : (ns * part->bytes) / bytes_total;
+            ns_rest -= ns_part;
+            ipx_cost_add(cost, cost->msr.session, cost->msr.odid, part->set_id, ns_part,
+                part->bytes);
+        }
+    }
+
+    cost->msr.session = NULL;
+}
+
+int
+ipx_cost_add(ipx_cost_t *cost, const char *session, uint32_t odid, uint16_t set_id,
+    uint64_t ns, uint64_t bytes)
+{
+    struct cost_item *item = cost_find(cost, session, odid, set_id);
+    if (!item) {
+        return IPX_ERR_NOMEM;
+    }
+
+    item->cost += ns;
+    item->bytes += bytes;
+    cost->total += ns;
+    return IPX_OK;
+}
+
+uint64_t
+ipx_cost_total(const ipx_cost_t *cost)
+{
+    return cost->total;
+}
+
+size_t
+ipx_cost_cnt(const ipx_cost_t *cost)
+{
+    return cost->items_cnt;
+}
+
+/**
+ * \brief Compare two combinations by their cost (descending order)
+ * \param[in] p1 First combination
+ * \param[in] p2 Second combination
+ * \return Negative, zero or positive number
+ */
+static int
+cost_cmp(const void *p1, const void *p2)
+{
+    const struct cost_item *item1 = *(const struct cost_item * const *) p1;
+    const struct cost_item *item2 = *(const struct cost_item * const *) p2;
+    if (item1->cost == item2->cost) {
+        return 0;
+    }
+
+    return (item1->cost > item2->cost) ? -1 : 1;
+}
+
+size_t
+ipx_cost_top(const ipx_cost_t *cost, struct ipx_cost_entry *top, size_t cnt)
+{
+    const struct cost_item **items = malloc((cost->items_cnt + 1) * sizeof(*items));
+    if (!items) {
+        return 0;
+    }
+
+    size_t items_cnt = 0;
+    for (size_t i = 0; i < cost->slots_cnt; ++i) {
+        if (cost->slots[i].session != NULL) {
+            items[items_cnt++] = &cost->slots[i];
+        }
+    }
+    if (cost->other.cost != 0 || cost->other.bytes != 0) {
+        items[items_cnt++] = &cost->other;
+    }
+
+    qsort(items, items_cnt, sizeof(*items), &cost_cmp);
+    if (cnt > items_cnt) {
+        cnt = items_cnt;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        top[i].session = items[i]->session;
+        top[i].odid = items[i]->odid;
+        top[i].set_id = items[i]->set_id;
+        top[i].cost = items[i]->cost;
+        top[i].bytes = items[i]->bytes;
+    }
+
+    free(items);
+    return cnt;
+}
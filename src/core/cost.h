@@ -0,0 +1,162 @@
+/**
+ * \file src/core/cost.h
+ * \author agent <agent@local>
+ * \brief Attribution of processing cost to flow sources (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_COST_H
+#define IPFIXCOL_COST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/**
+ * \defgroup ipxCost Attribution of processing cost
+ * \brief Accumulation of CPU time spent by an instance on messages of flow sources
+ *
+ * The CPU time spent by an instance on processing of an IPFIX Message is split among Sets of the
+ * message proportionally to their size and attributed to combinations of a Transport Session,
+ * ODID and Set ID (i.e. Template ID of Data Sets). The most expensive combinations help to
+ * identify sources that are worth filtering or re-routing.
+ *
+ * Only a sample of messages is supposed to be measured, therefore, the totals are estimations.
+ * @{
+ */
+
+/** Internal data type                                                      */
+typedef struct ipx_cost ipx_cost_t;
+
+/** Maximum number of distinct combinations (more are accumulated as "other sources") */
+#define IPX_COST_MAX_ENTRIES 4096U
+
+/** Accumulated cost of a combination of a Transport Session, ODID and Set ID */
+struct ipx_cost_entry {
+    /** Identification of the Transport Session (NULL == other sources)     */
+    const char *session;
+    /** Observation Domain ID                                               */
+    uint32_t odid;
+    /** Set ID (i.e. Template ID of Data Sets, 2/3 for (Options) Template Sets) */
+    uint16_t set_id;
+    /** Measured CPU time (in nanoseconds)                                   */
+    uint64_t cost;
+    /** Size of measured Sets (in bytes)                                     */
+    uint64_t bytes;
+};
+
+/**
+ * \brief Create an empty cost table
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_cost_t *
+ipx_cost_create();
+
+/**
+ * \brief Destroy a cost table
+ * \param[in] cost Cost table
+ */
+IPX_API void
+ipx_cost_destroy(ipx_cost_t *cost);
+
+/**
+ * \brief Start a measurement of processing of an IPFIX Message
+ *
+ * Sizes of Sets of the message and the current CPU time of the calling thread are remembered.
+ * The message can be passed on or destroyed by the instance before the measurement is finished.
+ * \param[in] cost Cost table
+ * \param[in] msg  IPFIX Message (the Transport Session must still exist)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred (nothing is measured)
+ */
+IPX_API int
+ipx_cost_begin(ipx_cost_t *cost, ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Finish the measurement started by ipx_cost_begin() and attribute the spent CPU time
+ * \note Must be called by the same thread as ipx_cost_begin().
+ * \param[in] cost Cost table
+ */
+IPX_API void
+ipx_cost_end(ipx_cost_t *cost);
+
+/**
+ * \brief Add a cost of a Set directly (without measurement)
+ * \param[in] cost    Cost table
+ * \param[in] session Identification of the Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] set_id  Set ID
+ * \param[in] ns      CPU time (in nanoseconds)
+ * \param[in] bytes   Size of the Set
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_cost_add(ipx_cost_t *cost, const char *session, uint32_t odid, uint16_t set_id,
+    uint64_t ns, uint64_t bytes);
+
+/**
+ * \brief Get the total measured CPU time (in nanoseconds)
+ * \param[in] cost Cost table
+ * \return Total cost
+ */
+IPX_API uint64_t
+ipx_cost_total(const ipx_cost_t *cost);
+
+/**
+ * \brief Get the most expensive combinations
+ *
+ * \param[in]  cost Cost table
+ * \param[out] top  Array for the combinations (sorted from the most expensive)
+ * \param[in]  cnt  Size of the array
+ * \return Number of filled items (i.e. up to \p cnt)
+ * \warning Items are valid only until the next modification of the table.
+ */
+IPX_API size_t
+ipx_cost_top(const ipx_cost_t *cost, struct ipx_cost_entry *top, size_t cnt);
+
+/**
+ * \brief Get the number of distinct combinations in the table
+ * \param[in] cost Cost table
+ * \return Number of combinations
+ */
+IPX_API size_t
+ipx_cost_cnt(const ipx_cost_t *cost);
+
+/**@}*/
+
+#endif // IPFIXCOL_COST_H
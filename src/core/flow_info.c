@@ -0,0 +1,658 @@
+/**
+ * \file src/core/flow_info.c
+ * \author agent <agent@local>
+ * \brief Derivation of flow keys and timestamps (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flow_info.h"
+
+/** Number of slots of a cache of extraction plans (MUST be a power of 2)    */
+#define FLOW_PLANS_SIZE 64U
+/** Difference between the NTP and UNIX epoch (seconds)                     */
+#define FLOW_NTP_EPOCH  2208988800ULL
+/** Nanoseconds in a second                                                 */
+#define FLOW_NSEC       1000000000ULL
+
+/** Items of flow information                                               */
+enum flow_item {
+    FI_SRC_IP4 = 0,
+    FI_DST_IP4,
+    FI_SRC_IP6,
+    FI_DST_IP6,
+    FI_SRC_PORT,
+    FI_DST_PORT,
+    FI_PROTO,
+    FI_START,
+    FI_END,
+    FI_SYS_INIT,
+    FI_CNT      /**< Number of items                                    */
+};
+
+/** Types of timestamps (a higher value is preferred)                      */
+enum flow_time {
+    FT_NONE = 0,
+    FT_UPTIME,  /**< Milliseconds relative to systemInitTimeMilliseconds */
+    FT_DELTA,   /**< Microseconds before the Export Time                 */
+    FT_SEC,     /**< dateTimeSeconds                                     */
+    FT_MSEC,    /**< dateTimeMilliseconds                                */
+    FT_USEC,    /**< dateTimeMicroseconds                                */
+    FT_NSEC     /**< dateTimeNanoseconds                                 */
+};
+
+/** Description of an IANA Information Element of flow information         */
+struct flow_ie {
+    /** Information Element ID                                          */
+    uint16_t id;
+    /** Item of flow information (see #flow_item)                       */
+    uint8_t item;
+    /** Type of the timestamp (see #flow_time)                          */
+    uint8_t time;
+};
+
+/** IANA Information Elements of flow information                         */
+static const struct flow_ie flow_ies[] = {
+    {4,   FI_PROTO,    FT_NONE},   // protocolIdentifier
+    {7,   FI_SRC_PORT, FT_NONE},   // sourceTransportPort
+    {8,   FI_SRC_IP4,  FT_NONE},   // sourceIPv4Address
+    {11,  FI_DST_PORT, FT_NONE},   // destinationTransportPort
+    {12,  FI_DST_IP4,  FT_NONE},   // destinationIPv4Address
+    {21,  FI_END,      FT_UPTIME}, // flowEndSysUpTime
+    {22,  FI_START,    FT_UPTIME}, // flowStartSysUpTime
+    {27,  FI_SRC_IP6,  FT_NONE},   // sourceIPv6Address
+    {28,  FI_DST_IP6,  FT_NONE},   // destinationIPv6Address
+    {150, FI_START,    FT_SEC},    // flowStartSeconds
+    {151, FI_END,      FT_SEC},    // flowEndSeconds
+    {152, FI_START,    FT_MSEC},   // flowStartMilliseconds
+    {153, FI_END,      FT_MSEC},   // flowEndMilliseconds
+    {154, FI_START,    FT_USEC},   // flowStartMicroseconds
+    {155, FI_END,      FT_USEC},   // flowEndMicroseconds
+    {156, FI_START,    FT_NSEC},   // flowStartNanoseconds
+    {157, FI_END,      FT_NSEC},   // flowEndNanoseconds
+    {158, FI_START,    FT_DELTA},  // flowStartDeltaMicroseconds
+    {159, FI_END,      FT_DELTA},  // flowEndDeltaMicroseconds
+    {160, FI_SYS_INIT, FT_NONE}    // systemInitTimeMilliseconds
+};
+
+/** Field of an extraction plan                                            */
+struct flow_field {
+    /** Index of the field in the Template                             */
+    uint16_t idx;
+    /** Index of the last field with a known offset before the field   */
+    uint16_t base;
+    /** Item of flow information (see #flow_item)                      */
+    uint8_t item;
+    /** Type of the timestamp (see #flow_time)                         */
+    uint8_t time;
+};
+
+/** Extraction plan of a Template                                          */
+struct flow_plan {
+    /** Template of the plan                                           */
+    const struct fds_template *tmplt;
+    /** Copy of the raw Template (to detect reuse of freed Templates)  */
+    uint8_t *raw;
+    /** Size of the raw Template                                       */
+    uint16_t raw_len;
+    /** Number of fields                                               */
+    uint16_t fields_cnt;
+    /** Fields to extract (sorted by their index in the Template)      */
+    struct flow_field fields[FI_CNT];
+};
+
+/** Cache of extraction plans (direct-mapped by address of Templates)       */
+struct ipx_flow_plans {
+    /** Template verified in the current message                      */
+    const struct fds_template *verified;
+    /** Plan of the verified Template                                  */
+    const struct flow_plan *verified_plan;
+    /** Slots of the cache                                             */
+    struct flow_plan *slots[FLOW_PLANS_SIZE];
+};
+
+/** Key of caches of extraction plans of threads                           */
+static pthread_key_t flow_plans_key;
+/** Initialization of the key                                              */
+static pthread_once_t flow_plans_once = PTHREAD_ONCE_INIT;
+
+/**
+ * \brief Find description of an Information Element of flow information
+ * \param[in] field Template field
+ * \return Pointer or NULL (not an Information Element of flow information)
+ */
+static const struct flow_ie *
+flow_ie_find(const struct fds_tfield *field)
+{
+    if (field->en != 0) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < sizeof(flow_ies) / sizeof(flow_ies[0]); ++i) {
+        if (flow_ies[i].id == field->id) {
+            return &flow_ies[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Destroy an extraction plan
+ * \param[in] plan Plan (can be NULL)
+ */
+static void
+flow_plan_destroy(struct flow_plan *plan)
+{
+    if (!plan) {
+        return;
+    }
+
+    free(plan->raw);
+    free(plan);
+}
+
+/**
+ * \brief Create an extraction plan of a Template
+ *
+ * Only the first occurrence of each Information Element is used, except for timestamps where
+ * the most preferred type is selected. Timestamps relative to the system initialization time
+ * are ignored if the Template doesn't contain systemInitTimeMilliseconds.
+ * \param[in] tmplt Template
+ * \return Pointer or NULL (memory allocation error)
+ */
+static struct flow_plan *
+flow_plan_create(const struct fds_template *tmplt)
+{
+    struct flow_plan *plan = calloc(1, sizeof(*plan));
+    if (!plan) {
+        return NULL;
+    }
+
+    plan->raw = malloc(tmplt->raw.length);
+    if (!plan->raw) {
+        free(plan);
+        return NULL;
+    }
+    memcpy(plan->raw, tmplt->raw.data, tmplt->raw.length);
+    plan->raw_len = tmplt->raw.length;
+    plan->tmplt = tmplt;
+
+    struct flow_field *items[FI_CNT] = {NULL};
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct flow_ie *ie = flow_ie_find(&tmplt->fields[i]);
+        if (!ie) {
+            continue;
+        }
+
+        struct flow_field *field = items[ie->item];
+        if (!field) {
+            field = &plan->fields[plan->fields_cnt++];
+            items[ie->item] = field;
+        } else if (field->time >= ie->time) {
+            continue;
+        }
+
+        field->idx = i;
+        field->item = ie->item;
+        field->time = ie->time;
+    }
+
+    // Remove unusable timestamps
+    const bool has_init = (items[FI_SYS_INIT] != NULL);
+    for (uint16_t i = 0; i < plan->fields_cnt; ) {
+        if (plan->fields[i].time == FT_UPTIME && !has_init) {
+            plan->fields[i] = plan->fields[--plan->fields_cnt];
+            continue;
+        }
+        ++i;
+    }
+
+    // Sort fields by their position (insertion sort of a few items)
+    for (uint16_t i = 1; i < plan->fields_cnt; ++i) {
+        const struct flow_field tmp = plan->fields[i];
+        uint16_t j = i;
+        while (j > 0 && plan->fields[j - 1].idx > tmp.idx) {
+            plan->fields[j] = plan->fields[j - 1];
+            --j;
+        }
+        plan->fields[j] = tmp;
+    }
+
+    // Offsets of fields after a variable-length field must be calculated for each record
+    for (uint16_t i = 0; i < plan->fields_cnt; ++i) {
+        uint16_t base = plan->fields[i].idx;
+        while (tmplt->fields[base].offset == FDS_IPFIX_VAR_IE_LEN) {
+            base--;
+        }
+        plan->fields[i].base = base;
+    }
+
+    return plan;
+}
+
+/**
+ * \brief Get an extraction plan of a Template
+ *
+ * If the cache doesn't contain the plan, a new plan is created.
+ * \param[in] plans Cache of extraction plans
+ * \param[in] tmplt Template
+ * \return Pointer or NULL (memory allocation error)
+ */
+static const struct flow_plan *
+flow_plan_get(ipx_flow_plans_t *plans, const struct fds_template *tmplt)
+{
+    if (plans->verified == tmplt) {
+        return plans->verified_plan;
+    }
+
+    const uintptr_t key = (uintptr_t) tmplt;
+    struct flow_plan **slot = &plans->slots[((key >> 4) ^ (key >> 12)) & (FLOW_PLANS_SIZE - 1)];
+    struct flow_plan *plan = *slot;
+
+    if (!plan || plan->tmplt != tmplt || plan->raw_len != tmplt->raw.length
+            || memcmp(plan->raw, tmplt->raw.data, plan->raw_len) != 0) {
+        struct flow_plan *plan_new = flow_plan_create(tmplt);
+        if (!plan_new) {
+            return NULL;
+        }
+
+        flow_plan_destroy(plan);
+        plan = plan_new;
+        *slot = plan;
+    }
+
+    plans->verified = tmplt;
+    plans->verified_plan = plan;
+    return plan;
+}
+
+ipx_flow_plans_t *
+ipx_flow_plans_create()
+{
+    return calloc(1, sizeof(struct ipx_flow_plans));
+}
+
+void
+ipx_flow_plans_destroy(ipx_flow_plans_t *plans)
+{
+    for (size_t i = 0; i < FLOW_PLANS_SIZE; ++i) {
+        flow_plan_destroy(plans->slots[i]);
+    }
+    free(plans);
+}
+
+/** \brief Create the key of caches of threads */
+static void
+flow_plans_key_create()
+{
+    if (pthread_key_create(&flow_plans_key, (void (*)(void *)) &ipx_flow_plans_destroy) != 0) {
+        abort();
+    }
+}
+
+ipx_flow_plans_t *
+ipx_flow_plans_local()
+{
+    pthread_once(&flow_plans_once, &flow_plans_key_create);
+    ipx_flow_plans_t *plans = pthread_getspecific(flow_plans_key);
+    if (plans != NULL) {
+        return plans;
+    }
+
+    plans = ipx_flow_plans_create();
+    if (plans != NULL && pthread_setspecific(flow_plans_key, plans) != 0) {
+        ipx_flow_plans_destroy(plans);
+        plans = NULL;
+    }
+    return plans;
+}
+
+void
+ipx_flow_plans_begin(ipx_flow_plans_t *plans)
+{
+    plans->verified = NULL;
+    plans->verified_plan = NULL;
+}
+
+/**
+ * \brief Get a value of a field at a given offset of a Data Record
+ * \param[in]  rec    Data Record
+ * \param[in]  field  Template field
+ * \param[in]  offset Offset of the field in the record
+ * \param[out] data   Value of the field
+ * \param[out] size   Size of the value
+ * \return True on success, false if the record is malformed
+ */
+static inline bool
+flow_field_value(const struct fds_drec *rec, const struct fds_tfield *field, uint32_t offset,
+    const uint8_t **data, uint16_t *size)
+{
+    uint32_t value_off = offset;
+    uint32_t value_len = field->length;
+
+    if (value_len == FDS_IPFIX_VAR_IE_LEN) {
+        if (offset + 1U > rec->size) {
+            return false;
+        }
+
+        value_len = rec->data[offset];
+        value_off = offset + 1U;
+        if (value_len == 255U) {
+            if (offset + 3U > rec->size) {
+                return false;
+            }
+            value_len = ((uint32_t) rec->data[offset + 1U] << 8) | rec->data[offset + 2U];
+            value_off = offset + 3U;
+        }
+    }
+
+    if (value_off + value_len > rec->size) {
+        return false;
+    }
+
+    *data = &rec->data[value_off];
+    *size = (uint16_t) value_len;
+    return true;
+}
+
+/**
+ * \brief Convert an unsigned integer in network byte order
+ * \param[in] data Value
+ * \param[in] size Size of the value (at most 8 bytes)
+ */
+static inline uint64_t
+flow_uint(const uint8_t *data, uint16_t size)
+{
+    uint64_t value = 0;
+    for (uint16_t i = 0; i < size; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * \brief Convert a timestamp to nanoseconds since the UNIX epoch
+ * \param[in]  type     Type of the timestamp (see #flow_time)
+ * \param[in]  data     Value
+ * \param[in]  size     Size of the value
+ * \param[in]  exp_time Export Time (seconds since the UNIX epoch)
+ * \param[in]  sys_init System initialization time (milliseconds since the UNIX epoch)
+ * \param[out] result   Converted timestamp
+ * \return True on success, false if the value is invalid
+ */
+static bool
+flow_time_conv(uint8_t type, const uint8_t *data, uint16_t size, uint32_t exp_time,
+    uint64_t sys_init, uint64_t *result)
+{
+    uint64_t value;
+    uint64_t frac;
+
+    switch (type) {
+    case FT_SEC:
+        if (size != 4U) {
+            return false;
+        }
+        *result = flow_uint(data, size) * FLOW_NSEC;
+        return true;
+    case FT_MSEC:
+        if (size != 8U) {
+            return false;
+        }
+        *result = flow_uint(data, size) * 1000000ULL;
+        return true;
+    case FT_USEC:
+    case FT_NSEC:
+        // NTP format, the lowest 11 bits of microsecond timestamps must be ignored (RFC 7011)
+        if (size != 8U || (value = flow_uint(data, 4U)) < FLOW_NTP_EPOCH) {
+            return false;
+        }
+        frac = flow_uint(&data[4], 4U);
+        if (type == FT_USEC) {
+            frac &= 0xFFFFF800ULL;
+        }
+        *result = (value - FLOW_NTP_EPOCH) * FLOW_NSEC + ((frac * FLOW_NSEC) >> 32);
+        return true;
+    case FT_DELTA:
+        if (size == 0 || size > 4U) {
+            return false;
+        }
+        value = flow_uint(data, size) * 1000ULL;
+        if (value > exp_time * FLOW_NSEC) {
+            return false;
+        }
+        *result = exp_time * FLOW_NSEC - value;
+        return true;
+    case FT_UPTIME:
+        if (size == 0 || size > 4U || sys_init == 0) {
+            return false;
+        }
+        *result = (sys_init + flow_uint(data, size)) * 1000000ULL;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * \brief Convert an IP address to an IPv6 or IPv4-mapped IPv6 address
+ * \param[out] addr Converted address
+ * \param[in]  ip4  IPv4 address (can be NULL)
+ * \param[in]  ip4_size Size of the IPv4 address
+ * \param[in]  ip6  IPv6 address (can be NULL)
+ * \param[in]  ip6_size Size of the IPv6 address
+ * \return 4 or 6 (version of the address), 0 if not available
+ */
+static inline unsigned int
+flow_addr(uint8_t *addr, const uint8_t *ip4, uint16_t ip4_size, const uint8_t *ip6,
+    uint16_t ip6_size)
+{
+    static const uint8_t ip4_mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+
+    if (ip4 != NULL && ip4_size == 4U) {
+        memcpy(addr, ip4_mapped, sizeof(ip4_mapped));
+        memcpy(&addr[sizeof(ip4_mapped)], ip4, 4U);
+        return 4U;
+    }
+
+    if (ip6 != NULL && ip6_size == 16U) {
+        memcpy(addr, ip6, 16U);
+        return 6U;
+    }
+
+    return 0;
+}
+
+int
+ipx_flow_info_fill(ipx_flow_plans_t *plans, const struct fds_drec *rec, uint32_t exp_time,
+    struct ipx_flow_info *info)
+{
+    memset(info, 0, sizeof(*info));
+    const struct flow_plan *plan = flow_plan_get(plans, rec->tmplt);
+    if (!plan) {
+        return IPX_ERR_NOMEM;
+    }
+
+    // Locate values of all fields of the plan
+    const struct fds_tfield *tfields = rec->tmplt->fields;
+    const uint8_t *values[FI_CNT] = {NULL};
+    uint16_t sizes[FI_CNT] = {0};
+    uint8_t times[FI_CNT] = {FT_NONE};
+    uint16_t cur_idx = 0;
+    uint32_t cur_offset = 0;
+
+    for (uint16_t i = 0; i < plan->fields_cnt; ++i) {
+        const struct flow_field *field = &plan->fields[i];
+        if (tfields[field->idx].offset != FDS_IPFIX_VAR_IE_LEN) {
+            cur_idx = field->idx;
+            cur_offset = tfields[field->idx].offset;
+        } else {
+            if (cur_idx < field->base) {
+                cur_idx = field->base;
+                cur_offset = tfields[field->base].offset;
+            }
+
+            const uint8_t *skip_data;
+            uint16_t skip_size;
+            while (cur_idx < field->idx) {
+                if (!flow_field_value(rec, &tfields[cur_idx], cur_offset, &skip_data,
+                        &skip_size)) {
+                    break;
+                }
+                cur_offset = (uint32_t) (skip_data - rec->data) + skip_size;
+                cur_idx++;
+            }
+            if (cur_idx != field->idx) {
+                // Malformed record, the rest of fields is not available
+                break;
+            }
+        }
+
+        if (!flow_field_value(rec, &tfields[cur_idx], cur_offset, &values[field->item],
+                &sizes[field->item])) {
+            values[field->item] = NULL;
+            break;
+        }
+        times[field->item] = field->time;
+    }
+
+    // Flow key
+    const unsigned int src_ver = flow_addr(info->src_addr, values[FI_SRC_IP4],
+        sizes[FI_SRC_IP4], values[FI_SRC_IP6], sizes[FI_SRC_IP6]);
+    const unsigned int dst_ver = flow_addr(info->dst_addr, values[FI_DST_IP4],
+        sizes[FI_DST_IP4], values[FI_DST_IP6], sizes[FI_DST_IP6]);
+    if (src_ver != 0 && dst_ver != 0) {
+        info->flags |= IPX_FLOW_ADDR;
+        if (src_ver == 4U && dst_ver == 4U) {
+            info->flags |= IPX_FLOW_IPV4;
+        }
+    }
+
+    unsigned int ports = 0;
+    if (values[FI_SRC_PORT] != NULL && sizes[FI_SRC_PORT] >= 1U && sizes[FI_SRC_PORT] <= 2U) {
+        info->src_port = (uint16_t) flow_uint(values[FI_SRC_PORT], sizes[FI_SRC_PORT]);
+        ports++;
+    }
+    if (values[FI_DST_PORT] != NULL && sizes[FI_DST_PORT] >= 1U && sizes[FI_DST_PORT] <= 2U) {
+        info->dst_port = (uint16_t) flow_uint(values[FI_DST_PORT], sizes[FI_DST_PORT]);
+        ports++;
+    }
+    if (ports == 2U) {
+        info->flags |= IPX_FLOW_PORTS;
+    }
+
+    if (values[FI_PROTO] != NULL && sizes[FI_PROTO] == 1U) {
+        info->proto = values[FI_PROTO][0];
+        info->flags |= IPX_FLOW_PROTO;
+    }
+
+    // Timestamps
+    uint64_t sys_init = 0;
+    if (values[FI_SYS_INIT] != NULL && sizes[FI_SYS_INIT] == 8U) {
+        sys_init = flow_uint(values[FI_SYS_INIT], 8U);
+    }
+    if (values[FI_START] != NULL && flow_time_conv(times[FI_START], values[FI_START],
+            sizes[FI_START], exp_time, sys_init, &info->start)) {
+        info->flags |= IPX_FLOW_START;
+    }
+    if (values[FI_END] != NULL && flow_time_conv(times[FI_END], values[FI_END],
+            sizes[FI_END], exp_time, sys_init, &info->end)) {
+        info->flags |= IPX_FLOW_END;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Add a 64-bit word to a hash
+ * \param[in] hash  Current hash
+ * \param[in] value Word
+ */
+static inline uint64_t
+flow_hash_add(uint64_t hash, uint64_t value)
+{
+    hash ^= value * 0x9E3779B97F4A7C15ULL;
+    hash = (hash << 27) | (hash >> 37);
+    return hash * 0xC2B2AE3D27D4EB4FULL;
+}
+
+/**
+ * \brief Calculate the final value of a hash
+ * \param[in] hash Current hash
+ */
+static inline uint64_t
+flow_hash_final(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void
+ipx_flow_info_hash(struct ipx_flow_info *infos, size_t cnt)
+{
+    for (size_t i = 0; i < cnt; ++i) {
+        struct ipx_flow_info *info = &infos[i];
+        uint64_t src[2];
+        uint64_t dst[2];
+        memcpy(src, info->src_addr, sizeof(src));
+        memcpy(dst, info->dst_addr, sizeof(dst));
+
+        // Endpoints are ordered, so both directions of the flow have the same key
+        const uint64_t src_port = info->src_port;
+        const uint64_t dst_port = info->dst_port;
+        const int cmp = memcmp(info->src_addr, info->dst_addr, 16U);
+        const bool swap = (cmp > 0) || (cmp == 0 && src_port > dst_port);
+        const uint64_t *lo = swap ? dst : src;
+        const uint64_t *hi = swap ? src : dst;
+        const uint64_t ports = swap ? ((dst_port << 16) | src_port) : ((src_port << 16) | dst_port);
+
+        uint64_t hash = 0x5851F42D4C957F2DULL;
+        hash = flow_hash_add(hash, lo[0]);
+        hash = flow_hash_add(hash, lo[1]);
+        hash = flow_hash_add(hash, hi[0]);
+        hash = flow_hash_add(hash, hi[1]);
+        hash = flow_hash_add(hash, (ports << 8) | info->proto);
+        info->hash = flow_hash_final(hash);
+    }
+}
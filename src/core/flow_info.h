@@ -0,0 +1,125 @@
+/**
+ * \file src/core/flow_info.h
+ * \author agent <agent@local>
+ * \brief Derivation of flow keys and timestamps (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_FLOW_INFO_H
+#define IPFIXCOL_FLOW_INFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+/**
+ * \defgroup ipxFlowInfo Derivation of flow keys and timestamps
+ * \brief Canonical flow information shared by all plugins (see ipx_msg_ipfix_get_flow_info())
+ *
+ * Positions and types of fields that hold the flow key and timestamps are resolved only once
+ * per Template (i.e. an extraction plan) and plans are cached per thread, so records are
+ * processed without any lookup of fields.
+ * @{
+ */
+
+/** Cache of extraction plans                                               */
+typedef struct ipx_flow_plans ipx_flow_plans_t;
+
+/**
+ * \brief Create a new empty cache of extraction plans
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_flow_plans_t *
+ipx_flow_plans_create();
+
+/**
+ * \brief Destroy a cache of extraction plans
+ * \param[in] plans Cache
+ */
+IPX_API void
+ipx_flow_plans_destroy(ipx_flow_plans_t *plans);
+
+/**
+ * \brief Get the cache of extraction plans of the calling thread
+ *
+ * The cache is created during the first call and destroyed automatically when the thread exits.
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_flow_plans_t *
+ipx_flow_plans_local();
+
+/**
+ * \brief Start processing of a new IPFIX Message
+ *
+ * Templates are verified against cached plans only once per message. The function MUST be
+ * called before records of each message are processed, because Templates of previous
+ * messages might have been freed (and their memory reused) in the meantime.
+ * \param[in] plans Cache of extraction plans
+ */
+IPX_API void
+ipx_flow_plans_begin(ipx_flow_plans_t *plans);
+
+/**
+ * \brief Derive the flow key and timestamps of a Data Record
+ *
+ * The hash of the flow key is NOT calculated, see ipx_flow_info_hash().
+ * \param[in]  plans    Cache of extraction plans
+ * \param[in]  rec      Data Record
+ * \param[in]  exp_time Export Time of the IPFIX Message (seconds since the UNIX epoch)
+ * \param[out] info     Flow information
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the information is zeroed)
+ */
+IPX_API int
+ipx_flow_info_fill(ipx_flow_plans_t *plans, const struct fds_drec *rec, uint32_t exp_time,
+    struct ipx_flow_info *info);
+
+/**
+ * \brief Calculate hashes of flow keys of an array of flow information
+ *
+ * Keys are hashed in a separate pass over the array, so the calculation works on the fixed-size
+ * keys of consecutive records without any branching on content of the records.
+ * \param[in,out] infos Array of flow information
+ * \param[in]     cnt   Number of items in the array
+ */
+IPX_API void
+ipx_flow_info_hash(struct ipx_flow_info *infos, size_t cnt);
+
+/**@}*/
+
+#endif // IPFIXCOL_FLOW_INFO_H
@@ -0,0 +1,229 @@
+/**
+ * \file src/core/ie_demand.c
+ * \author agent <agent@local>
+ * \brief Demand of Information Elements (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ie_demand.h"
+
+/** Number of IANA Information Elements (15 bits)                          */
+#define IANA_IE_CNT (1U << 15)
+/** Mask of an Information Element ID (without the enterprise bit)         */
+#define IE_ID_MASK (0x7FFFU)
+/** Default number of pre-allocated enterprise specific elements           */
+#define ENT_DEF_CNT 16
+
+/** Demand of Information Elements */
+struct ipx_ie_demand {
+    /** All Information Elements are demanded                              */
+    bool all;
+    /** Bitset of demanded IANA elements (indexed by ID)                    */
+    uint64_t iana[IANA_IE_CNT / 64];
+
+    struct {
+        /** Sorted array of demanded elements (Enterprise Number << 16 | ID) */
+        uint64_t *items;
+        /** Number of valid items                                           */
+        size_t cnt_valid;
+        /** Number of allocated items                                       */
+        size_t cnt_alloc;
+    } ent; /**< Enterprise specific elements                                 */
+};
+
+/**
+ * \brief Get a key of an enterprise specific element
+ * \param[in] en Enterprise Number
+ * \param[in] id Information Element ID
+ * \return Key
+ */
+static inline uint64_t
+ent_key(uint32_t en, uint16_t id)
+{
+    return (((uint64_t) en) << 16) | (id & IE_ID_MASK);
+}
+
+/**
+ * \brief Find position of an enterprise specific element (binary search)
+ * \param[in]  demand Demand
+ * \param[in]  key    Key of the element
+ * \param[out] pos    Position of the element or position where it should be inserted
+ * \return True if the element has been found
+ */
+static bool
+ent_find(const ipx_ie_demand_t *demand, uint64_t key, size_t *pos)
+{
+    size_t low = 0;
+    size_t high = demand->ent.cnt_valid;
+
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const uint64_t value = demand->ent.items[mid];
+        if (value == key) {
+            *pos = mid;
+            return true;
+        }
+
+        if (value < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *pos = low;
+    return false;
+}
+
+ipx_ie_demand_t *
+ipx_ie_demand_create()
+{
+    return calloc(1, sizeof(struct ipx_ie_demand));
+}
+
+void
+ipx_ie_demand_destroy(ipx_ie_demand_t *demand)
+{
+    free(demand->ent.items);
+    free(demand);
+}
+
+int
+ipx_ie_demand_add(ipx_ie_demand_t *demand, uint32_t en, uint16_t id)
+{
+    id &= IE_ID_MASK;
+    if (en == 0) {
+        demand->iana[id / 64] |= (1ULL << (id % 64));
+        return IPX_OK;
+    }
+
+    const uint64_t key = ent_key(en, id);
+    size_t pos;
+    if (ent_find(demand, key, &pos)) {
+        // Already present
+        return IPX_OK;
+    }
+
+    if (demand->ent.cnt_valid == demand->ent.cnt_alloc) {
+        const size_t alloc_new = (demand->ent.cnt_alloc == 0) ? ENT_DEF_CNT
+            : 2 * demand->ent.cnt_alloc;
+        uint64_t *items_new = realloc(demand->ent.items, alloc_new * sizeof(*items_new));
+        if (!items_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        demand->ent.items = items_new;
+        demand->ent.cnt_alloc = alloc_new;
+    }
+
+    uint64_t *items = demand->ent.items;
+    memmove(&items[pos + 1], &items[pos], (demand->ent.cnt_valid - pos) * sizeof(*items));
+    items[pos] = key;
+    demand->ent.cnt_valid++;
+    return IPX_OK;
+}
+
+void
+ipx_ie_demand_add_all(ipx_ie_demand_t *demand)
+{
+    demand->all = true;
+}
+
+int
+ipx_ie_demand_merge(ipx_ie_demand_t *demand, const ipx_ie_demand_t *other)
+{
+    if (other == NULL || other->all) {
+        demand->all = true;
+        return IPX_OK;
+    }
+
+    for (size_t i = 0; i < IANA_IE_CNT / 64; ++i) {
+        demand->iana[i] |= other->iana[i];
+    }
+
+    for (size_t i = 0; i < other->ent.cnt_valid; ++i) {
+        const uint64_t key = other->ent.items[i];
+        int rc = ipx_ie_demand_add(demand, (uint32_t) (key >> 16), (uint16_t) (key & IE_ID_MASK));
+        if (rc != IPX_OK) {
+            return rc;
+        }
+    }
+
+    return IPX_OK;
+}
+
+bool
+ipx_ie_demand_is_all(const ipx_ie_demand_t *demand)
+{
+    return demand->all;
+}
+
+bool
+ipx_ie_demand_has(const ipx_ie_demand_t *demand, uint32_t en, uint16_t id)
+{
+    if (demand->all) {
+        return true;
+    }
+
+    id &= IE_ID_MASK;
+    if (en == 0) {
+        return (demand->iana[id / 64] & (1ULL << (id % 64))) != 0;
+    }
+
+    size_t pos;
+    return ent_find(demand, ent_key(en, id), &pos);
+}
+
+bool
+ipx_ie_demand_tmplt(const ipx_ie_demand_t *demand, const struct fds_template *tmplt)
+{
+    if (demand->all) {
+        return true;
+    }
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (ipx_ie_demand_has(demand, field->en, field->id)) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,135 @@
+/**
+ * \file src/core/ie_demand.h
+ * \author agent <agent@local>
+ * \brief Demand of Information Elements (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_IE_DEMAND_H
+#define IPFIXCOL_IE_DEMAND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <ipfixcol2/api.h>
+#include <libfds.h>
+
+/**
+ * \defgroup ipxIeDemand Demand of Information Elements
+ * \brief Set of Information Elements required by instances of plugins
+ *
+ * Each intermediate and output instance can declare Information Elements it processes. The union
+ * of demands of all instances represents fields that are useful in the pipeline. Data Sets of
+ * (Options) Templates without any demanded field can be skipped by the IPFIX parser.
+ * @{
+ */
+
+/** Internal data type                                                      */
+typedef struct ipx_ie_demand ipx_ie_demand_t;
+
+/**
+ * \brief Create a new empty demand (i.e. no Information Elements)
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_ie_demand_t *
+ipx_ie_demand_create();
+
+/**
+ * \brief Destroy a demand
+ * \param[in] demand Demand to destroy
+ */
+IPX_API void
+ipx_ie_demand_destroy(ipx_ie_demand_t *demand);
+
+/**
+ * \brief Add an Information Element to the demand
+ * \param[in] demand Demand
+ * \param[in] en     Enterprise Number
+ * \param[in] id     Information Element ID (the enterprise bit is ignored)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_ie_demand_add(ipx_ie_demand_t *demand, uint32_t en, uint16_t id);
+
+/**
+ * \brief Demand all Information Elements
+ * \param[in] demand Demand
+ */
+IPX_API void
+ipx_ie_demand_add_all(ipx_ie_demand_t *demand);
+
+/**
+ * \brief Extend a demand by another demand
+ * \param[in] demand Demand to extend
+ * \param[in] other  Other demand (NULL == all Information Elements)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_ie_demand_merge(ipx_ie_demand_t *demand, const ipx_ie_demand_t *other);
+
+/**
+ * \brief Check if all Information Elements are demanded
+ * \param[in] demand Demand
+ * \return True or false
+ */
+IPX_API bool
+ipx_ie_demand_is_all(const ipx_ie_demand_t *demand);
+
+/**
+ * \brief Check if an Information Element is demanded
+ * \param[in] demand Demand
+ * \param[in] en     Enterprise Number
+ * \param[in] id     Information Element ID (the enterprise bit is ignored)
+ * \return True or false
+ */
+IPX_API bool
+ipx_ie_demand_has(const ipx_ie_demand_t *demand, uint32_t en, uint16_t id);
+
+/**
+ * \brief Check if an (Options) Template contains at least one demanded field
+ *
+ * \note Fields nested in structured data types (e.g. subTemplateList) are not considered.
+ * \param[in] demand Demand
+ * \param[in] tmplt  (Options) Template
+ * \return True or false
+ */
+IPX_API bool
+ipx_ie_demand_tmplt(const ipx_ie_demand_t *demand, const struct fds_template *tmplt);
+
+/**@}*/
+#endif // IPFIXCOL_IE_DEMAND_H
@@ -50,6 +50,21 @@ ipx_msg_get_type(ipx_msg_t *msg)
     return msg->type;
 }
 
+// Size of a message that can be stored inline
+size_t
+ipx_msg_inline_size(const ipx_msg_t *msg)
+{
+    switch (msg->type) {
+    case IPX_MSG_SESSION:
+        return ipx_msg_session_size();
+    case IPX_MSG_TERMINATE:
+        return ipx_msg_terminate_size();
+    default:
+        // Garbage messages must be destroyed exactly once and IPFIX Messages are too big
+        return 0;
+    }
+}
+
 // Destroy a message for the collector pipeline
 void
 ipx_msg_destroy(ipx_msg_t *msg)
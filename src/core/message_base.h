@@ -66,10 +66,20 @@
 struct ipx_msg {
     /** Type of the message                                                           */
     enum ipx_msg_type type;
-    /** Reference counter (set by the output manager, decremented by output plugins)  */
+    /** Reference counter (set by output managers, decremented by output plugins)      */
     unsigned int ref_cnt;
+    /** Flags (see #IPX_MSG_F_INLINE)                                                 */
+    unsigned int flags;
 }; // TODO: 64 bytes alignment
 
+/**
+ * \brief Flag of a message that is a copy stored directly in a slot of a ring buffer
+ *
+ * Memory of such message belongs to the ring buffer, therefore, it must not be freed.
+ * See ipx_ring_inline_mode() for more details.
+ */
+#define IPX_MSG_F_INLINE (1U << 0)
+
 static_assert(offsetof(struct ipx_msg, type) == 0,
     "Message type must be the first element of each IPFIXcol message.");
 
@@ -83,6 +93,8 @@ static inline void
 ipx_msg_header_init(struct ipx_msg *header, enum ipx_msg_type type)
 {
     header->type = type;
+    header->ref_cnt = 1;
+    header->flags = 0;
 }
 
 /**
@@ -98,7 +110,37 @@ ipx_msg_header_destroy(struct ipx_msg *header)
 }
 
 /**
- * \brief Set the reference counter (only for the output manager)
+ * \brief Check if a message is stored inline in a slot of a ring buffer
+ * \param[in] header Pointer to the header of the message
+ * \return True if memory of the message must not be freed, false otherwise
+ */
+static inline bool
+ipx_msg_header_is_inline(const struct ipx_msg *header)
+{
+    return (header->flags & IPX_MSG_F_INLINE) != 0;
+}
+
+/**
+ * \brief Get size of a message that can be copied by value (i.e. stored inline)
+ *
+ * Only messages without any side effect of their destruction (i.e. Transport Session and
+ * Termination messages) can be copied. Copies are independent on the original message, which
+ * must be destroyed separately.
+ * \param[in] msg Message
+ * \return Size of the message structure or 0 if the message cannot be copied
+ */
+IPX_API size_t
+ipx_msg_inline_size(const ipx_msg_t *msg);
+
+/**
+ * \brief Get size of the Transport Session message structure
+ * \return Size in bytes
+ */
+size_t
+ipx_msg_session_size();
+
+/**
+ * \brief Set the reference counter (only for internal components, e.g. ring buffers)
  * \param[in] header Pointer to the header of the message
  * \param[in] cnt    Initial value
  */
@@ -108,6 +150,58 @@ ipx_msg_header_cnt_set(struct ipx_msg *header, unsigned int cnt)
     header->ref_cnt = cnt;
 }
 
+/**
+ * \brief Share a message among multiple destinations (only for output managers)
+ *
+ * The reference of the caller is replaced by \p cnt references. If the message is already
+ * shared (e.g. it has been passed to multiple branches of the pipeline), the counter is
+ * increased accordingly.
+ * \param[in] header Pointer to the header of the message
+ * \param[in] cnt    Number of destinations (at least one)
+ */
+static inline void
+ipx_msg_header_cnt_share(struct ipx_msg *header, unsigned int cnt)
+{
+    assert(cnt > 0);
+    if (__atomic_load_n(&header->ref_cnt, __ATOMIC_ACQUIRE) <= 1) {
+        // Not shared, no one else can access the counter
+        header->ref_cnt = cnt;
+        return;
+    }
+
+    __atomic_add_fetch(&header->ref_cnt, cnt - 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * \brief Check if a message is shared by multiple instances
+ * \param[in] header Pointer to the header of the message
+ * \return True if other instances can access the message, false otherwise
+ */
+static inline bool
+ipx_msg_header_is_shared(const struct ipx_msg *header)
+{
+    return __atomic_load_n(&header->ref_cnt, __ATOMIC_ACQUIRE) > 1;
+}
+
+/**
+ * \brief Release a reference of a message that can be shared
+ *
+ * Unlike ipx_msg_header_cnt_dec(), the counter is not touched if the caller is the only user
+ * of the message.
+ * \param[in] header Pointer to the header of the message
+ * \return True if this is the last reference and the message should be freed
+ * \return False otherwise
+ */
+static inline bool
+ipx_msg_header_release(struct ipx_msg *header)
+{
+    if (!ipx_msg_header_is_shared(header)) {
+        return true;
+    }
+
+    return (__atomic_sub_fetch(&header->ref_cnt, 1U, __ATOMIC_SEQ_CST) == 0);
+}
+
 /**
  * \brief Decrement the reference counter (only for output plugins)
  * \param[in] header Pointer to the header of the message
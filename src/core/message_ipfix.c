@@ -44,14 +44,38 @@
 #include "message_base.h"
 #include "message_ipfix.h"
 #include "context.h"
+#include "flow_info.h"
 
+#include <sched.h>  // sched_yield
+#include <arpa/inet.h> // ntohl
 #include <stddef.h> // offsetof
 #include <stdlib.h> // free
+#include <string.h> // memcpy, memset
 
 // Check correctness of structure implementation
 static_assert(offsetof(struct ipx_msg_ipfix, msg_header.type) == 0,
     "Message header must be the first element of each IPFIXcol message.");
 
+/** Splitting of Data Sets into Data Records */
+enum msg_split_state {
+    /** Data Records are available                            */
+    MSG_SPLIT_DONE = 0,
+    /** Data Sets haven't been split yet                      */
+    MSG_SPLIT_PENDING,
+    /** Data Sets are being split by another thread           */
+    MSG_SPLIT_RUNNING
+};
+
+/** Derivation of flow information */
+enum msg_flow_state {
+    /** Flow information hasn't been derived yet              */
+    MSG_FLOW_NONE = 0,
+    /** Flow information is being derived by another thread   */
+    MSG_FLOW_RUNNING,
+    /** Flow information is available                         */
+    MSG_FLOW_DONE
+};
+
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size)
 {
@@ -73,6 +97,9 @@ ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_
     wrapper->ctx = *msg_ctx;
     wrapper->raw_pkt = msg_data;
     wrapper->raw_size = msg_size;
+    wrapper->segs.base[0].iov_base = msg_data;
+    wrapper->segs.base[0].iov_len = msg_size;
+    wrapper->segs.cnt_valid = 1;
     wrapper->sets.cnt_alloc = SET_DEF_CNT;
     wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
     wrapper->rec_info.rec_size = rec_size;
@@ -82,8 +109,17 @@ ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_
 void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
 {
+    if (!ipx_msg_header_release(&msg->msg_header)) {
+        // The message is still used by another branch of the pipeline
+        return;
+    }
+
     // Destroy the IPFIX packet
     free(msg->raw_pkt);
+    free(msg->segs.owner);
+    free(msg->segs.extended);
+    free(msg->rec_info.deferred);
+    free(msg->flow_info.items);
 
     // Destroy the wrapper
     if (msg->sets.extended) {
@@ -99,6 +135,18 @@ ipx_msg_ipfix_get_packet(ipx_msg_ipfix_t *msg)
     return msg->raw_pkt;
 }
 
+void
+ipx_msg_ipfix_get_segs(ipx_msg_ipfix_t *msg, const struct iovec **iov, size_t *cnt)
+{
+    if (iov != NULL) {
+        *iov = (msg->segs.cnt_valid <= SEG_DEF_CNT) ? msg->segs.base : msg->segs.extended;
+    }
+
+    if (cnt != NULL) {
+        *cnt = msg->segs.cnt_valid;
+    }
+}
+
 struct ipx_msg_ctx *
 ipx_msg_ipfix_get_ctx(ipx_msg_ipfix_t *msg)
 {
@@ -122,30 +170,187 @@ ipx_msg_ipfix_get_sets(ipx_msg_ipfix_t *msg, struct ipx_ipfix_set **sets, size_t
     }
 }
 
+void
+ipx_msg_ipfix_split_defer(struct ipx_msg_ipfix *msg)
+{
+    assert(msg->rec_info.cnt_valid == 0 && msg->rec_info.deferred == NULL);
+    msg->rec_info.split = MSG_SPLIT_PENDING;
+}
+
+/**
+ * \brief Split deferred Data Sets into Data Records
+ *
+ * Only the first caller splits the Data Sets, other threads wait until the records are ready.
+ * Boundaries of the records have been already validated by the parser, therefore, the split
+ * cannot fail. In case of a memory allocation error, only the records that fit into the
+ * allocated memory are available.
+ * \param[in] msg IPFIX Message wrapper
+ */
+static void
+msg_split(struct ipx_msg_ipfix *msg)
+{
+    uint32_t state = MSG_SPLIT_PENDING;
+    if (!__atomic_compare_exchange_n(&msg->rec_info.split, &state, MSG_SPLIT_RUNNING, false,
+            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        // Another thread is splitting the records right now (or it has already finished)
+        while (__atomic_load_n(&msg->rec_info.split, __ATOMIC_ACQUIRE) != MSG_SPLIT_DONE) {
+            sched_yield();
+        }
+        return;
+    }
+
+    const size_t rec_size = msg->rec_info.rec_size;
+    uint8_t *recs = NULL;
+    uint32_t recs_valid = 0;
+    uint32_t recs_alloc = 0;
+
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &sets_cnt);
+
+    for (size_t i = 0; i < sets_cnt; ++i) {
+        const struct fds_template *tmplt = sets[i].tmplt;
+        if (!tmplt) {
+            // Not a Data Set or unknown Template
+            continue;
+        }
+
+        struct fds_dset_iter it;
+        fds_dset_iter_init(&it, sets[i].ptr, tmplt);
+        while (fds_dset_iter_next(&it) == FDS_OK) {
+            if (recs_valid == recs_alloc) {
+                const uint32_t alloc_new = (recs_alloc == 0) ? REC_DEF_CNT : 2U * recs_alloc;
+                uint8_t *recs_new = realloc(recs, alloc_new * rec_size);
+                if (!recs_new) {
+                    goto done;
+                }
+                recs = recs_new;
+                recs_alloc = alloc_new;
+            }
+
+            uint8_t *rec_start = recs + (recs_valid * rec_size);
+            struct ipx_ipfix_record *rec = (struct ipx_ipfix_record *) rec_start;
+            rec->rec.data = it.rec;
+            rec->rec.size = it.size;
+            rec->rec.tmplt = tmplt;
+            rec->rec.snap = sets[i].snap;
+            rec->ext_mask = 0;
+            recs_valid++;
+        }
+    }
+
+done:
+    msg->rec_info.deferred = recs;
+    msg->rec_info.cnt_valid = recs_valid;
+    msg->rec_info.cnt_alloc = recs_alloc;
+    __atomic_store_n(&msg->rec_info.split, MSG_SPLIT_DONE, __ATOMIC_RELEASE);
+}
+
 uint32_t
 ipx_msg_ipfix_get_drec_cnt(const ipx_msg_ipfix_t *msg)
 {
+    if (__atomic_load_n(&msg->rec_info.split, __ATOMIC_ACQUIRE) != MSG_SPLIT_DONE) {
+        // The wrapper is never allocated as a constant object
+        msg_split((struct ipx_msg_ipfix *) msg);
+    }
+
     return msg->rec_info.cnt_valid;
 }
 
 struct ipx_ipfix_record *
 ipx_msg_ipfix_get_drec(ipx_msg_ipfix_t *msg, uint32_t idx)
 {
+    if (__atomic_load_n(&msg->rec_info.split, __ATOMIC_ACQUIRE) != MSG_SPLIT_DONE) {
+        msg_split(msg);
+    }
+
     if (idx >= msg->rec_info.cnt_valid) {
         return NULL;
     }
 
     const size_t offset = idx * msg->rec_info.rec_size;
-    uint8_t *rec_start = ((uint8_t *) msg->recs) + offset;
-    return (struct ipx_ipfix_record *) rec_start;
+    uint8_t *recs = (msg->rec_info.deferred != NULL)
+        ? msg->rec_info.deferred
+        : (uint8_t *) msg->recs;
+    return (struct ipx_ipfix_record *) (recs + offset);
+}
+
+/**
+ * \brief Derive flow information of all Data Records
+ *
+ * Only the first caller derives the information, other callers wait until it's available.
+ * In case of a memory allocation error, the information is not available.
+ * \param[in] msg IPFIX Message wrapper
+ */
+static void
+msg_flow_info(struct ipx_msg_ipfix *msg)
+{
+    uint32_t state = MSG_FLOW_NONE;
+    if (!__atomic_compare_exchange_n(&msg->flow_info.state, &state, MSG_FLOW_RUNNING, false,
+            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        // Another thread is deriving the information right now (or it has already finished)
+        while (__atomic_load_n(&msg->flow_info.state, __ATOMIC_ACQUIRE) != MSG_FLOW_DONE) {
+            sched_yield();
+        }
+        return;
+    }
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    ipx_flow_plans_t *plans = ipx_flow_plans_local();
+    struct ipx_flow_info *items = NULL;
+    if (rec_cnt != 0 && plans != NULL) {
+        items = malloc(rec_cnt * sizeof(*items));
+    }
+
+    if (items != NULL) {
+        const struct fds_ipfix_msg_hdr *hdr = (const struct fds_ipfix_msg_hdr *) msg->raw_pkt;
+        const uint32_t exp_time = ntohl(hdr->export_time);
+
+        ipx_flow_plans_begin(plans);
+        for (uint32_t i = 0; i < rec_cnt; ++i) {
+            // In case of a memory allocation error, the information of the record is empty
+            ipx_flow_info_fill(plans, &ipx_msg_ipfix_get_drec(msg, i)->rec, exp_time, &items[i]);
+        }
+        ipx_flow_info_hash(items, rec_cnt);
+    }
+
+    msg->flow_info.items = items;
+    msg->flow_info.cnt = (items != NULL) ? rec_cnt : 0;
+    __atomic_store_n(&msg->flow_info.state, MSG_FLOW_DONE, __ATOMIC_RELEASE);
+}
+
+const struct ipx_flow_info *
+ipx_msg_ipfix_get_flow_info(ipx_msg_ipfix_t *msg, uint32_t idx)
+{
+    if (__atomic_load_n(&msg->flow_info.state, __ATOMIC_ACQUIRE) != MSG_FLOW_DONE) {
+        msg_flow_info(msg);
+    }
+
+    if (idx >= msg->flow_info.cnt) {
+        return NULL;
+    }
+
+    return &msg->flow_info.items[idx];
+}
+
+void
+ipx_msg_ipfix_flow_info_reset(ipx_msg_ipfix_t *msg)
+{
+    free(msg->flow_info.items);
+    msg->flow_info.items = NULL;
+    msg->flow_info.cnt = 0;
+    msg->flow_info.state = MSG_FLOW_NONE;
 }
 
 struct ipx_ipfix_set *
 ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
 {
+    struct ipx_ipfix_set *ref;
     if (msg->sets.cnt_valid < SET_DEF_CNT) {
         // Return a reference into "base" array
-        return &msg->sets.base[msg->sets.cnt_valid++];
+        ref = &msg->sets.base[msg->sets.cnt_valid++];
+        memset(ref, 0, sizeof(*ref));
+        return ref;
     }
 
     if (msg->sets.cnt_valid == msg->sets.cnt_alloc) {
@@ -165,13 +370,18 @@ ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
     }
 
     // Return reference into "extended" array
-    return &msg->sets.extended[msg->sets.cnt_valid++];
+    ref = &msg->sets.extended[msg->sets.cnt_valid++];
+    memset(ref, 0, sizeof(*ref));
+    return ref;
 }
 
 struct ipx_ipfix_record *
 ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
 {
     struct ipx_msg_ipfix *msg = *msg_ref;
+    assert(msg->rec_info.split == MSG_SPLIT_DONE && msg->rec_info.deferred == NULL);
+    // Previously derived flow information doesn't cover the new record
+    ipx_msg_ipfix_flow_info_reset(msg);
     if (msg->rec_info.cnt_valid == msg->rec_info.cnt_alloc) {
         // Reallocation of the message is necessary
         const uint32_t alloc_new = 2U * msg->rec_info.cnt_valid;
@@ -189,5 +399,263 @@ ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
     assert(msg->rec_info.cnt_valid < msg->rec_info.cnt_alloc);
     const size_t offset = msg->rec_info.cnt_valid * msg->rec_info.rec_size;
     msg->rec_info.cnt_valid++;
-    return ((struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset));
-}
\ No newline at end of file
+    struct ipx_ipfix_record *rec = (struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset);
+    rec->ext_mask = 0; // No extensions are filled yet
+    return rec;
+}
+
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *data, uint16_t size)
+{
+    free(msg->raw_pkt);
+    free(msg->segs.owner);
+    free(msg->segs.extended);
+
+    msg->raw_pkt = data;
+    msg->raw_size = size;
+    msg->segs.base[0].iov_base = data;
+    msg->segs.base[0].iov_len = size;
+    msg->segs.cnt_valid = 1;
+    msg->segs.extended = NULL;
+    msg->segs.owner = NULL;
+}
+
+int
+ipx_msg_ipfix_raw_replace_segs(struct ipx_msg_ipfix *msg, uint8_t *data, const struct iovec *iov,
+    size_t iov_cnt)
+{
+    assert(iov_cnt > 0 && iov[0].iov_base == data);
+    assert(msg->segs.cnt_valid == 1 && msg->segs.owner == NULL && "Already segmented!");
+
+    size_t total = 0;
+    for (size_t i = 0; i < iov_cnt; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    if (total > UINT16_MAX || iov_cnt > UINT32_MAX) {
+        return IPX_ERR_FORMAT;
+    }
+
+    struct iovec *dst = msg->segs.base;
+    if (iov_cnt > SEG_DEF_CNT) {
+        dst = malloc(iov_cnt * sizeof(*dst));
+        if (!dst) {
+            return IPX_ERR_NOMEM;
+        }
+        msg->segs.extended = dst;
+    }
+
+    memcpy(dst, iov, iov_cnt * sizeof(*dst));
+    msg->segs.cnt_valid = (uint32_t) iov_cnt;
+
+    // Keep the original message (referenced by the segments) until the wrapper is destroyed
+    msg->segs.owner = msg->raw_pkt;
+    msg->raw_pkt = data;
+    msg->raw_size = (uint16_t) total;
+    return IPX_OK;
+}
+
+/**
+ * \brief Wait until a concurrently running operation with the message is finished
+ * \param[in] state   State of the operation (atomic access only)
+ * \param[in] running Value of the state during the operation
+ * \return Current (stable) state
+ */
+static uint32_t
+msg_state_stable(const uint32_t *state, uint32_t running)
+{
+    uint32_t value;
+    while ((value = __atomic_load_n(state, __ATOMIC_ACQUIRE)) == running) {
+        sched_yield();
+    }
+
+    return value;
+}
+
+/**
+ * \brief Translate a pointer into the raw message to a pointer into its contiguous copy
+ * \param[in] iov     Segments of the raw message
+ * \param[in] iov_cnt Number of segments
+ * \param[in] raw     Contiguous copy of the segments
+ * \param[in] ptr     Pointer into the raw message
+ * \return Translated pointer or NULL (the pointer doesn't point into any segment)
+ */
+static uint8_t *
+msg_ptr_rebase(const struct iovec *iov, uint32_t iov_cnt, uint8_t *raw, const void *ptr)
+{
+    const uint8_t *pos = (const uint8_t *) ptr;
+    size_t offset = 0;
+
+    for (uint32_t i = 0; i < iov_cnt; ++i) {
+        const uint8_t *start = (const uint8_t *) iov[i].iov_base;
+        if (pos >= start && pos < start + iov[i].iov_len) {
+            return raw + offset + (size_t) (pos - start);
+        }
+        offset += iov[i].iov_len;
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Copy parsed Data Records and translate their references to the raw message
+ * \param[out] dst     Destination array
+ * \param[in]  src     Source array
+ * \param[in]  cnt     Number of records
+ * \param[in]  size    Size of a single record (including extensions)
+ * \param[in]  iov     Segments of the raw message
+ * \param[in]  iov_cnt Number of segments
+ * \param[in]  raw     Contiguous copy of the raw message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if a record is not a part of the raw message
+ */
+static int
+msg_clone_recs(uint8_t *dst, const uint8_t *src, uint32_t cnt, size_t size,
+    const struct iovec *iov, uint32_t iov_cnt, uint8_t *raw)
+{
+    memcpy(dst, src, cnt * size);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        struct ipx_ipfix_record *rec = (struct ipx_ipfix_record *) (dst + (i * size));
+        rec->rec.data = msg_ptr_rebase(iov, iov_cnt, raw, rec->rec.data);
+        if (!rec->rec.data) {
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Create an independent copy of an IPFIX Message wrapper
+ *
+ * The raw message is always copied into a single contiguous buffer. The message can be
+ * concurrently accessed by other threads, however, only deferred splitting of Data Sets and
+ * derivation of flow information can modify it (see msg_split() and msg_flow_info()).
+ * \param[in] msg IPFIX Message wrapper
+ * \return Pointer to the copy or NULL (memory allocation error)
+ */
+static struct ipx_msg_ipfix *
+msg_clone(struct ipx_msg_ipfix *msg)
+{
+    const uint32_t split = msg_state_stable(&msg->rec_info.split, MSG_SPLIT_RUNNING);
+    const uint32_t flow = msg_state_stable(&msg->flow_info.state, MSG_FLOW_RUNNING);
+    const size_t rec_size = msg->rec_info.rec_size;
+
+    // Records split on demand are stored outside of the wrapper
+    const bool recs_inside = (split == MSG_SPLIT_DONE && msg->rec_info.deferred == NULL);
+    const uint32_t recs_alloc = recs_inside ? msg->rec_info.cnt_alloc : 1U;
+    struct ipx_msg_ipfix *copy = calloc(1, ipx_msg_ipfix_size(recs_alloc, rec_size));
+    uint8_t *raw = malloc(msg->raw_size);
+    if (!copy || !raw) {
+        free(copy);
+        free(raw);
+        return NULL;
+    }
+
+    const struct iovec *iov;
+    size_t iov_cnt;
+    ipx_msg_ipfix_get_segs(msg, &iov, &iov_cnt);
+    size_t raw_pos = 0;
+    for (size_t i = 0; i < iov_cnt; ++i) {
+        memcpy(raw + raw_pos, iov[i].iov_base, iov[i].iov_len);
+        raw_pos += iov[i].iov_len;
+    }
+
+    ipx_msg_header_init(&copy->msg_header, IPX_MSG_IPFIX);
+    copy->ctx = msg->ctx;
+    copy->trace_id = msg->trace_id;
+    copy->raw_pkt = raw;
+    copy->raw_size = msg->raw_size;
+    copy->segs.base[0].iov_base = raw;
+    copy->segs.base[0].iov_len = msg->raw_size;
+    copy->segs.cnt_valid = 1;
+
+    // Parsed Sets
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &sets_cnt);
+    copy->sets.cnt_valid = (uint32_t) sets_cnt;
+    copy->sets.cnt_alloc = SET_DEF_CNT;
+    struct ipx_ipfix_set *sets_dst = copy->sets.base;
+    if (sets_cnt > SET_DEF_CNT) {
+        sets_dst = malloc(sets_cnt * sizeof(*sets_dst));
+        if (!sets_dst) {
+            goto error;
+        }
+        copy->sets.extended = sets_dst;
+        copy->sets.cnt_alloc = (uint32_t) sets_cnt;
+    }
+
+    memcpy(sets_dst, sets, sets_cnt * sizeof(*sets_dst));
+    for (size_t i = 0; i < sets_cnt; ++i) {
+        sets_dst[i].ptr = (struct fds_ipfix_set_hdr *) msg_ptr_rebase(iov, (uint32_t) iov_cnt,
+            raw, sets[i].ptr);
+        if (!sets_dst[i].ptr) {
+            goto error;
+        }
+    }
+
+    // Data Records (if already split)
+    copy->rec_info.rec_size = rec_size;
+    copy->rec_info.cnt_alloc = recs_alloc;
+    copy->rec_info.split = split;
+    if (split == MSG_SPLIT_DONE) {
+        const uint32_t recs_cnt = msg->rec_info.cnt_valid;
+        uint8_t *recs_dst = (uint8_t *) copy->recs;
+        if (!recs_inside) {
+            recs_dst = malloc((recs_cnt > 0 ? recs_cnt : 1U) * rec_size);
+            if (!recs_dst) {
+                goto error;
+            }
+            copy->rec_info.deferred = recs_dst;
+            copy->rec_info.cnt_alloc = recs_cnt;
+        }
+
+        const uint8_t *recs_src = recs_inside
+            ? (const uint8_t *) msg->recs
+            : msg->rec_info.deferred;
+        if (msg_clone_recs(recs_dst, recs_src, recs_cnt, rec_size, iov, (uint32_t) iov_cnt, raw)
+                != IPX_OK) {
+            goto error;
+        }
+        copy->rec_info.cnt_valid = recs_cnt;
+    }
+
+    // Flow information (if not available, it will be derived again on demand)
+    copy->flow_info.state = MSG_FLOW_NONE;
+    if (flow == MSG_FLOW_DONE && msg->flow_info.cnt > 0) {
+        const size_t items_size = msg->flow_info.cnt * sizeof(*msg->flow_info.items);
+        copy->flow_info.items = malloc(items_size);
+        if (copy->flow_info.items != NULL) {
+            memcpy(copy->flow_info.items, msg->flow_info.items, items_size);
+            copy->flow_info.cnt = msg->flow_info.cnt;
+            copy->flow_info.state = MSG_FLOW_DONE;
+        }
+    }
+
+    return copy;
+
+error:
+    free(copy->rec_info.deferred);
+    free(copy->sets.extended);
+    free(copy);
+    free(raw);
+    return NULL;
+}
+
+struct ipx_msg_ipfix *
+ipx_msg_ipfix_unshare(struct ipx_msg_ipfix *msg)
+{
+    if (!ipx_msg_header_is_shared(&msg->msg_header)) {
+        return msg;
+    }
+
+    struct ipx_msg_ipfix *copy = msg_clone(msg);
+    if (!copy) {
+        return NULL;
+    }
+
+    // Release the reference to the shared message (other branches might already released theirs)
+    ipx_msg_ipfix_destroy(msg);
+    return copy;
+}
@@ -45,12 +45,15 @@
 /** Default maximum number of IPFIX sets per message */
 #include <ipfixcol2.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 #include "message_base.h"
 
 /** Default number of pre-allocated structures for parser IPFIX Sets         */
 #define SET_DEF_CNT (32)
 /** Default number of pre-allocated structures for parser IPFIX Data Records */
 #define REC_DEF_CNT (64)
+/** Default number of pre-allocated segments of a raw IPFIX Message          */
+#define SEG_DEF_CNT (8)
 
 /**
  * \brief Structure for a parsed IPFIX Message
@@ -65,11 +68,28 @@ struct ipx_msg_ipfix {
 
     /** Packet context  */
     struct ipx_msg_ctx ctx;
-    /** Raw IPFIX packet from a source (in Network Byte Order)               */
+    /**
+     * Raw IPFIX packet from a source (in Network Byte Order)
+     * \note If the message is segmented, only the first segment is stored here.
+     */
     uint8_t *raw_pkt;
-    /** Size of raw message                                                  */
+    /** Size of raw message (i.e. the total size of all segments)            */
     uint16_t raw_size;
 
+    struct {
+        /** Array of segments (valid only when #cnt_valid <= SEG_DEF_CNT)   */
+        struct iovec  base[SEG_DEF_CNT];
+        /** Array of segments (valid only when #cnt_valid > SEG_DEF_CNT)    */
+        struct iovec *extended;
+        /** Number of segments (always at least one)                        */
+        uint32_t cnt_valid;
+        /**
+         * Owner of memory referenced by segments other than #raw_pkt
+         * (typically the original NetFlow message, can be NULL)
+         */
+        uint8_t *owner;
+    } segs; /**< Segments of the raw message                                 */
+
     struct {
         /** Array of sets (valid only when #cnt_valid <= SET_DEF_CNT)       */
         struct ipx_ipfix_set  base[SET_DEF_CNT];
@@ -89,8 +109,24 @@ struct ipx_msg_ipfix {
         uint32_t cnt_valid;
         /** Number of allocated records                                      */
         uint32_t cnt_alloc;
+        /** State of deferred splitting of Data Sets (atomic access only)    */
+        uint32_t split;
+        /** Array of Data Records split on demand (NULL if not split yet)    */
+        uint8_t *deferred;
     } rec_info; /**< Parsed IPFIX Data records                               */
 
+    struct {
+        /** State of derivation (atomic access only)                         */
+        uint32_t state;
+        /** Number of items                                                  */
+        uint32_t cnt;
+        /** Flow information of Data Records (NULL if not derived)           */
+        struct ipx_flow_info *items;
+    } flow_info; /**< Flow keys and timestamps (see ipx_msg_ipfix_get_flow_info()) */
+
+    /** Trace ID of the message (0 == not traced, see \ref ipxTrace)          */
+    uint32_t trace_id;
+
     /**
      * Array of parsed records.
      * This MUST be the last element in this structure. To access individual
@@ -117,25 +153,89 @@ size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size);
 
 /**
- * \brief Add a new IPFIX Set
+ * \brief Get the trace ID of the message
+ * \param[in] msg IPFIX Message wrapper
+ * \return Trace ID or 0, if the message is not traced
+ */
+static inline uint32_t
+ipx_msg_ipfix_trace_id(const struct ipx_msg_ipfix *msg)
+{
+    return msg->trace_id;
+}
+
+/**
+ * \brief Set the trace ID of the message
+ * \param[in] msg IPFIX Message wrapper
+ * \param[in] id  Trace ID (0 == not traced)
+ */
+static inline void
+ipx_msg_ipfix_trace_set(struct ipx_msg_ipfix *msg, uint32_t id)
+{
+    msg->trace_id = id;
+}
+
+/**
+ * \brief Defer splitting of Data Sets into Data Records
  *
- * The record is uninitialized and user MUST fill it!
+ * Data Records of all Data Sets with a known Template (see ipx_ipfix_set::tmplt) will be split
+ * on the first call of ipx_msg_ipfix_get_drec() or ipx_msg_ipfix_get_drec_cnt(). The records
+ * are stored outside of the wrapper, so the split is possible even if the message is shared by
+ * multiple output instances.
+ * \warning The message MUST NOT contain any Data Record references and no references can be
+ *   added using ipx_msg_ipfix_add_drec_ref() afterwards.
  * \param[in] msg IPFIX Message wrapper
- * \return Pointer to the record or NULL (memory allocation error)
  */
-struct ipx_ipfix_set *
-ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg);
+void
+ipx_msg_ipfix_split_defer(struct ipx_msg_ipfix *msg);
+
+/**
+ * \brief Replace the raw message with a new contiguous one
+ *
+ * The previous raw message (and all its segments) is freed and the wrapper takes ownership
+ * of the new one.
+ * \note Typical usage is replacement of a NetFlow message with a converted IPFIX Message.
+ * \warning All parsed Sets and Data Records (if any) are NOT updated!
+ * \param[in] msg  IPFIX Message wrapper
+ * \param[in] data New raw message
+ * \param[in] size Size of the new message
+ */
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *data, uint16_t size);
 
 /**
- * \brief Add a new IPFIX Data Record
+ * \brief Replace the raw message with a new segmented one
  *
- * The record is uninitialized and user MUST fill it!
- * \warning The wrapper \p msg_ref can be reallocated and different pointer can be returned!
- * \param[in,out] msg_ref IPFIX Message wrapper
- * \return Pointer to the record or NULL (memory allocation error)
+ * The new message consists of segments in the memory of the \p data buffer and in the memory
+ * of the current raw message (i.e. unmodified parts of the original message can be referenced
+ * without copying). The wrapper takes ownership of the \p data buffer and keeps the current raw
+ * message until the wrapper is destroyed.
+ * \warning The current raw message MUST NOT be segmented.
+ * \warning All parsed Sets and Data Records (if any) are NOT updated!
+ * \param[in] msg     IPFIX Message wrapper
+ * \param[in] data    New buffer (the first segment MUST start at its beginning)
+ * \param[in] iov     Array of segments
+ * \param[in] iov_cnt Number of segments (at least one)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the total size of the segments exceeds the maximum message size
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the wrapper is unchanged)
  */
-struct ipx_ipfix_record *
-ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref);
+int
+ipx_msg_ipfix_raw_replace_segs(struct ipx_msg_ipfix *msg, uint8_t *data, const struct iovec *iov,
+    size_t iov_cnt);
 
+/**
+ * \brief Get a private (i.e. modifiable) IPFIX Message
+ *
+ * If the message is shared by multiple branches of the pipeline, a copy of the message with
+ * a contiguous raw message, all parsed Sets, Data Records (including their extensions) and flow
+ * information is created and the reference of the caller to the shared message is released.
+ * Otherwise, the message is returned as it is.
+ * \param[in] msg IPFIX Message wrapper
+ * \return Private message
+ * \return NULL in case of a memory allocation error (the reference of the caller to the shared
+ *   message is kept)
+ */
+struct ipx_msg_ipfix *
+ipx_msg_ipfix_unshare(struct ipx_msg_ipfix *msg);
 
 #endif // IPFIXCOL_MESSAGE_IPFIX_INTERNAL_H
@@ -85,8 +85,21 @@ ipx_msg_session_create(const struct ipx_session *session, enum ipx_msg_session_e
 void
 ipx_msg_session_destroy(ipx_msg_session_t *msg)
 {
+    if (!ipx_msg_header_release(&msg->msg_header)) {
+        // The message is still used by another branch of the pipeline
+        return;
+    }
+
     ipx_msg_header_destroy((ipx_msg_t *) msg);
-    free(msg);
+    if (!ipx_msg_header_is_inline(&msg->msg_header)) {
+        free(msg);
+    }
+}
+
+size_t
+ipx_msg_session_size()
+{
+    return sizeof(struct ipx_msg_session);
 }
 
 enum ipx_msg_session_event
@@ -75,7 +75,15 @@ void
 ipx_msg_termiante_destroy(ipx_msg_terminate_t *msg)
 {
     ipx_msg_header_destroy((ipx_msg_t *) msg);
-    free(msg);
+    if (!ipx_msg_header_is_inline(&msg->msg_header)) {
+        free(msg);
+    }
+}
+
+size_t
+ipx_msg_terminate_size()
+{
+    return sizeof(struct ipx_msg_terminate);
 }
 
 enum ipx_msg_terminate_type
@@ -46,7 +46,14 @@
 extern "C" {
 #endif
 
-/** \brief The type of terminate message           */
+/**
+ * \brief The type of terminate message
+ *
+ * \warning If the ring buffers of the pipeline use the inline mode (see ipx_ring_inline_mode()),
+ *   a message taken from a ring buffer can be a copy stored directly in a slot of the buffer.
+ *   Such a copy is valid only until the next message is taken from the same ring buffer, so it
+ *   MUST be passed to the next ring buffer or destroyed before that and never kept for later.
+ */
 typedef struct ipx_msg_terminate ipx_msg_terminate_t;
 
 #include <ipfixcol2/message.h>
@@ -99,6 +106,13 @@ ipx_msg_termiante_destroy(ipx_msg_terminate_t *msg);
 IPX_API enum ipx_msg_terminate_type
 ipx_msg_terminate_get_type(const ipx_msg_terminate_t *msg);
 
+/**
+ * \brief Get size of the termination message structure
+ * \return Size in bytes
+ */
+size_t
+ipx_msg_terminate_size();
+
 /**
  * \brief Cast from a terminate message to a base message
  * \param[in] msg Pointer to the terminate message
@@ -116,6 +116,25 @@ static const struct nf2ipx_data nf2ipx_data_table[] = {
 /// Number of record the the Data conversion table */
 #define NF2IPX_DATA_TABLE_SIZE (sizeof(nf2ipx_data_table) / sizeof(nf2ipx_data_table[0]))
 
+/**
+ * @brief Reference to an unmodified part of the original NetFlow Message
+ *
+ * Data FlowSets of Templates that require no conversion (i.e. the IPFIX Data record is
+ * the same as the NetFlow record) are not copied into the new IPFIX Message. Instead, they are
+ * referenced and the new message is represented as a list of segments.
+ */
+struct conv_ref {
+    /// Position in the new IPFIX Message buffer where the reference is inserted
+    size_t offset;
+    /// Referenced memory (part of the original NetFlow Message)
+    const uint8_t *ptr;
+    /// Size of the referenced memory
+    uint16_t size;
+};
+
+/// Maximum number of references per message (i.e. the message has at most 2x + 1 segments)
+#define CONV_REFS_MAX 64U
+
 /// Internal converter structure
 struct ipx_nf9_conv {
     /// Instance identification (only for log!)
@@ -147,6 +166,17 @@ struct ipx_nf9_conv {
         uint16_t drecs_converted;
     } data; ///< Data of currently converted messages
 
+    struct {
+        /// Array of references (sorted by offset)
+        struct conv_ref *items;
+        /// Number of valid references
+        size_t cnt_valid;
+        /// Number of allocated references
+        size_t cnt_alloc;
+        /// Total size of referenced memory
+        size_t size;
+    } refs; ///< Unmodified parts of the NetFlow Message referenced by the new IPFIX Message
+
     /// Template lookup table - 2-level table  (256 x 256)
     struct tmplts_l1_table l1_table;
 };
@@ -234,6 +264,7 @@ ipx_nf9_conv_destroy(struct ipx_nf9_conv *conv)
     nf9_tmplts_destroy(&conv->l1_table);
 
     // Destroy the main structure
+    free(conv->refs.items);
     free(conv->ident);
     free(conv);
 }
@@ -249,6 +280,8 @@ conv_mem_init(ipx_nf9_conv_t *conv)
     conv->data.write_ptr = NULL;
     conv->data.ipx_size_used = 0;
     conv->data.ipx_size_alloc = 0;
+    conv->refs.cnt_valid = 0;
+    conv->refs.size = 0;
 }
 
 /**
@@ -395,6 +428,44 @@ conv_mem_pos_set(ipx_nf9_conv_t *conv, size_t offset)
     assert(conv->data.ipx_size_used <= conv->data.ipx_size_alloc);
 }
 
+/**
+ * @brief Insert a reference to an unmodified part of the NetFlow Message
+ *
+ * The reference is inserted at the current position of the "commit" pointer, i.e. the referenced
+ * memory will be placed after all already committed memory in the new IPFIX Message.
+ * @param[in] conv Converter internals
+ * @param[in] ptr  Referenced memory (MUST be part of the original NetFlow Message)
+ * @param[in] size Size of the referenced memory
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_LIMIT if the maximum number of references has been reached
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static inline int
+conv_mem_ref_add(ipx_nf9_conv_t *conv, const uint8_t *ptr, uint16_t size)
+{
+    if (conv->refs.cnt_valid == CONV_REFS_MAX) {
+        return IPX_ERR_LIMIT;
+    }
+
+    if (conv->refs.cnt_valid == conv->refs.cnt_alloc) {
+        size_t new_alloc = (conv->refs.cnt_alloc == 0) ? 8U : (2U * conv->refs.cnt_alloc);
+        struct conv_ref *new_items = realloc(conv->refs.items, new_alloc * sizeof(*new_items));
+        if (!new_items) {
+            return IPX_ERR_NOMEM;
+        }
+
+        conv->refs.items = new_items;
+        conv->refs.cnt_alloc = new_alloc;
+    }
+
+    struct conv_ref *ref = &conv->refs.items[conv->refs.cnt_valid++];
+    ref->offset = conv_mem_pos_get(conv);
+    ref->ptr = ptr;
+    ref->size = size;
+    conv->refs.size += size;
+    return IPX_OK;
+}
+
 // -----------------------------------------------------------------------------------------
 
 /**
@@ -992,6 +1063,24 @@ conv_process_drec(ipx_nf9_conv_t *conv, const struct ipx_nf9_msg_hdr *nf9_msg,
     return IPX_OK;
 }
 
+/**
+ * @brief Check if Data records described by a template can be used without any modification
+ *
+ * This is true if the conversion consists only of a single copy instruction over the whole
+ * record i.e. the NetFlow Data record is the same as the IPFIX Data record.
+ * @param[in] tmplt Internal template record with conversion instructions
+ * @return True or false
+ */
+static inline bool
+conv_tmplt_is_identity(const struct nf9_trec *tmplt)
+{
+    return tmplt->action == REC_ACT_CONVERT
+        && tmplt->instr_size == 1
+        && tmplt->instr_data[0].itype == NF2IPX_ITYPE_CPY
+        && tmplt->nf9_drec_len > 0
+        && tmplt->nf9_drec_len == tmplt->ipx_drec_len;
+}
+
 /**
  * @brief Convert NetFlow Data FlowSet to IPFIX Data Set
  *
@@ -1032,6 +1121,25 @@ conv_process_dset(ipx_nf9_conv_t *conv, const struct ipx_nf9_set_hdr *flowset_hd
         return IPX_OK;
     }
 
+    if (conv_tmplt_is_identity(tmplt)) {
+        // The FlowSet is also valid IPFIX Data Set -> just reference it (no copy)
+        const uint16_t set_len = ntohs(flowset_hdr->length);
+        int rc_ref = conv_mem_ref_add(conv, (const uint8_t *) flowset_hdr, set_len);
+        if (rc_ref == IPX_OK) {
+            uint16_t rec_cnt = (set_len - IPX_NF9_SET_HDR_LEN) / tmplt->nf9_drec_len;
+            conv->data.recs_processed += rec_cnt;
+            conv->data.drecs_converted += rec_cnt;
+            return IPX_OK;
+        }
+
+        if (rc_ref == IPX_ERR_NOMEM) {
+            CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+
+        // Too many references -> fall back to conversion (i.e. copy)
+    }
+
     // Add Data Set header (parameters will be filled later)
     if (conv_mem_reserve(conv, FDS_IPFIX_SET_HDR_LEN) != IPX_OK) {
         CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
@@ -1245,7 +1353,8 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
     }
 
     // Fill the new IPFIX Message header
-    size_t ipx_size = conv_mem_pos_get(conv);
+    const size_t buffer_size = conv_mem_pos_get(conv);
+    size_t ipx_size = buffer_size + conv->refs.size;
     if (ipx_size > UINT16_MAX) {
         CONV_ERROR(conv, "Unable to convert NetFlow v9 to IPFIX. Size of the converted message "
             "exceeds the maximum size of an IPFIX Message! (before: %" PRIu16 " B, after: %zu B)",
@@ -1264,9 +1373,44 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
     conv->ipx_seq_next += conv->data.drecs_converted;
 
     // Finally, replace the converted NetFlow Message with the new IPFIX Message
-    free(wrapper->raw_pkt);
-    wrapper->raw_pkt = conv_mem_release(conv);
-    wrapper->raw_size = (uint16_t) ipx_size;
+    uint8_t *buffer = conv_mem_release(conv);
+    if (conv->refs.cnt_valid == 0) {
+        ipx_msg_ipfix_raw_replace(wrapper, buffer, (uint16_t) ipx_size);
+        return IPX_OK;
+    }
+
+    // Segmented message (the original NetFlow Message is kept and referenced)
+    struct iovec iov[2U * CONV_REFS_MAX + 1U];
+    size_t iov_cnt = 0;
+    size_t pos = 0;
+
+    for (size_t i = 0; i < conv->refs.cnt_valid; ++i) {
+        const struct conv_ref *ref = &conv->refs.items[i];
+        if (ref->offset > pos) {
+            iov[iov_cnt].iov_base = buffer + pos;
+            iov[iov_cnt].iov_len = ref->offset - pos;
+            iov_cnt++;
+            pos = ref->offset;
+        }
+
+        iov[iov_cnt].iov_base = (void *) ref->ptr;
+        iov[iov_cnt].iov_len = ref->size;
+        iov_cnt++;
+    }
+
+    if (buffer_size > pos) {
+        iov[iov_cnt].iov_base = buffer + pos;
+        iov[iov_cnt].iov_len = buffer_size - pos;
+        iov_cnt++;
+    }
+
+    rc = ipx_msg_ipfix_raw_replace_segs(wrapper, buffer, iov, iov_cnt);
+    if (rc != IPX_OK) {
+        CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        free(buffer);
+        return rc;
+    }
+
     return IPX_OK;
 }
 
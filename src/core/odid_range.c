@@ -113,6 +113,30 @@ range_add(struct ipx_orange *range, struct range_node node)
     return IPX_OK;
 }
 
+/**
+ * \brief Add a value or an interval node
+ * \param[in] range ODID range filter
+ * \param[in] from  The first ODID of the interval
+ * \param[in] to    The last ODID of the interval
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+range_add_interval(struct ipx_orange *range, uint32_t from, uint32_t to)
+{
+    struct range_node node;
+    if (from == to) {
+        node.type = RANGE_NODE_VALUE;
+        node.val = from;
+    } else {
+        node.type = RANGE_NODE_INTERVAL;
+        node.interval.from = from;
+        node.interval.to = to;
+    }
+
+    return range_add(range, node);
+}
+
 /**
  * \brief Check if a string is empty or consists only of whitespace characters
  * \param[in] str String to test
@@ -228,17 +252,7 @@ range_parse_interval(struct ipx_orange *range, char *token)
     }
 
     // Add value/interval to the range
-    struct range_node node;
-    if (from_value == to_value) {
-        node.type = RANGE_NODE_VALUE;
-        node.val = from_value;
-    } else {
-        node.type = RANGE_NODE_INTERVAL;
-        node.interval.from = from_value;
-        node.interval.to = to_value;
-    }
-
-    return range_add(range, node);
+    return range_add_interval(range, from_value, to_value);
 }
 
 /**
@@ -305,7 +319,9 @@ range_node_cmp(const void *p1, const void *p2)
 }
 
 /**
- * \brief Sort filter nodes (from the lowest number to the highest)
+ * \brief Sort filter nodes (from the lowest number to the highest) and merge overlapping nodes
+ *
+ * After the optimization, the nodes are disjoint and non-adjacent.
  * \param range ODID range filter
  */
 static void
@@ -313,6 +329,36 @@ range_sort(struct ipx_orange *range)
 {
     const size_t elem_size = sizeof(struct range_node);
     qsort(range->nodes, range->valid, elem_size, &range_node_cmp);
+
+    size_t idx_out = 0;
+    for (size_t idx = 0; idx < range->valid; ++idx) {
+        const struct range_node *node = &range->nodes[idx];
+        const uint32_t from = (node->type == RANGE_NODE_VALUE) ? node->val : node->interval.from;
+        const uint32_t to = (node->type == RANGE_NODE_VALUE) ? node->val : node->interval.to;
+
+        struct range_node *prev = (idx_out > 0) ? &range->nodes[idx_out - 1] : NULL;
+        const uint32_t prev_to = (!prev) ? 0
+            : ((prev->type == RANGE_NODE_VALUE) ? prev->val : prev->interval.to);
+        if (!prev || (uint64_t) prev_to + 1 < from) {
+            // New node
+            range->nodes[idx_out++] = *node;
+            continue;
+        }
+
+        if (to <= prev_to) {
+            // Already covered by the previous node
+            continue;
+        }
+
+        // Extend the previous node
+        const uint32_t prev_from = (prev->type == RANGE_NODE_VALUE)
+            ? prev->val : prev->interval.from;
+        prev->type = RANGE_NODE_INTERVAL;
+        prev->interval.from = prev_from;
+        prev->interval.to = to;
+    }
+
+    range->valid = idx_out;
 }
 
 
@@ -415,6 +461,65 @@ ipx_orange_in(const ipx_orange_t *range, uint32_t odid)
     return false;
 }
 
+int
+ipx_orange_add(ipx_orange_t *range, enum ipx_odid_filter_type type, const ipx_orange_t *filter)
+{
+    int rc = IPX_OK;
+
+    switch (type) {
+    case IPX_ODID_FILTER_NONE:
+        rc = range_add_interval(range, 0, UINT32_MAX);
+        break;
+    case IPX_ODID_FILTER_ONLY:
+        for (size_t idx = 0; rc == IPX_OK && idx < filter->valid; ++idx) {
+            rc = range_add(range, filter->nodes[idx]);
+        }
+        break;
+    case IPX_ODID_FILTER_EXCEPT: {
+        // Add gaps between (sorted) nodes of the filter
+        uint64_t next = 0;
+        for (size_t idx = 0; rc == IPX_OK && idx < filter->valid; ++idx) {
+            const struct range_node *node = &filter->nodes[idx];
+            const uint32_t from = (node->type == RANGE_NODE_VALUE)
+                ? node->val : node->interval.from;
+            const uint32_t to = (node->type == RANGE_NODE_VALUE)
+                ? node->val : node->interval.to;
+
+            if (from > next) {
+                rc = range_add_interval(range, (uint32_t) next, from - 1);
+            }
+            if ((uint64_t) to + 1 > next) {
+                next = (uint64_t) to + 1;
+            }
+        }
+
+        if (rc == IPX_OK && next <= UINT32_MAX) {
+            rc = range_add_interval(range, (uint32_t) next, UINT32_MAX);
+        }
+        break;
+    }
+    default:
+        assert(false && "Unknown ODID filter type");
+        break;
+    }
+
+    // Keep the range sorted even if some nodes failed to be added
+    range_sort(range);
+    return rc;
+}
+
+bool
+ipx_orange_full(const ipx_orange_t *range)
+{
+    if (range->valid != 1) {
+        return false;
+    }
+
+    const struct range_node *node = &range->nodes[0];
+    return node->type == RANGE_NODE_INTERVAL
+        && node->interval.from == 0 && node->interval.to == UINT32_MAX;
+}
+
 void
 ipx_orange_print(const ipx_orange_t *range)
 {
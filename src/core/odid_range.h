@@ -103,6 +103,29 @@ ipx_orange_parse(ipx_orange_t *range, const char *expr);
 IPX_API bool
 ipx_orange_in(const ipx_orange_t *range, uint32_t odid);
 
+/**
+ * \brief Extend a range by all ODIDs selected by a filter
+ *
+ * The range becomes a union of its previous content and ODIDs selected by the filter. For
+ * example, the union of ODID filters of all output instances represents ODIDs processed by at
+ * least one output.
+ * \param[in] range  ODID range to extend
+ * \param[in] type   Filter type
+ * \param[in] filter Filter (ignored if \p type == #IPX_ODID_FILTER_NONE, i.e. all ODIDs)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_orange_add(ipx_orange_t *range, enum ipx_odid_filter_type type, const ipx_orange_t *filter);
+
+/**
+ * \brief Check if a range contains all ODIDs
+ * \param[in] range ODID range filter
+ * \return True or false
+ */
+IPX_API bool
+ipx_orange_full(const ipx_orange_t *range);
+
 /**
  * \brief Dump filter to standard output
  *
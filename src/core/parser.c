@@ -40,6 +40,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 #include <libfds.h>
 #include <ipfixcol2.h>
@@ -71,12 +72,16 @@ struct stream_info {
     uint16_t flags;
     /** Expected Sequence Number of the next Message                   */
     uint32_t seq_num;
+    /** Export Time of the last replicated Sequence Number             */
+    uint32_t repl_time;
 };
 
 /** Auxiliary flags specific to each Stream context                    */
 enum stream_ctx_flags {
     /** Ignore all IPFIX messages                                      */
     SCF_BLOCK = (1 << 0),
+    /** Fill the Template manager with replicated state (standby only) */
+    SCF_SEED = (1 << 1),
 };
 
 /** Type of source data                                                */
@@ -149,6 +154,28 @@ struct ipx_parser {
     size_t recs_valid;
     /** Array of records                           */
     struct parser_rec *recs;
+
+    /** Replicator of template state (can be NULL) */
+    ipx_repl_t *repl;
+
+    /** ODIDs processed by at least one output (NULL == all ODIDs) */
+    const ipx_orange_t *odid_sel;
+    struct {
+        /** Number of dropped messages             */
+        uint64_t msgs;
+        /** Total size of dropped messages         */
+        uint64_t bytes;
+    } odid_dropped; /**< Messages dropped due to the selection of ODIDs */
+    /** Do not split Data Sets into Data Records (see ipx_msg_ipfix_split_defer()) */
+    bool split_defer;
+    /** IEs demanded by the pipeline (NULL == all IEs) */
+    const ipx_ie_demand_t *ie_sel;
+    struct {
+        /** Number of skipped Data Sets            */
+        uint64_t sets;
+        /** Number of skipped Data Records         */
+        uint64_t recs;
+    } ie_skipped; /**< Data Sets skipped due to the demand of IEs */
 };
 
 /**
@@ -373,6 +400,7 @@ stream_ctx_rec_get(struct stream_ctx **ctx, ipx_stream_t id)
     info = &(*ctx)->infos[(*ctx)->infos_valid++];
     info->id = id;
     info->seq_num = 0;
+    info->repl_time = 0;
     info->flags = 0;
 
     stream_ctx_rec_sort(*ctx);
@@ -481,6 +509,15 @@ parser_rec_get(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
 
     PARSER_INFO(parser, ctx, "New connection detected!", '\0');
 
+    if (parser->repl != NULL && ctx->session->type == FDS_SESSION_UDP) {
+        if (ipx_repl_role_get(parser->repl) == IPX_REPL_STANDBY) {
+            // Templates can be added only after Export Time is known
+            rec->ctx->flags |= SCF_SEED;
+        } else {
+            ipx_repl_session(parser->repl, ctx->session);
+        }
+    }
+
     parser->recs_valid++;
     parser_rec_sort(parser);
     // Position has been changes... find it again
@@ -594,8 +631,12 @@ struct ipx_parser_data {
 
     /** Number of parser data records                   */
     uint16_t data_recs;
+    /** Splitting of Data Sets has been deferred        */
+    bool split_deferred;
     /** Templates added/removed                         */
     bool tmplt_changes;
+    /** Replicator of new templates (can be NULL)       */
+    ipx_repl_t *repl;
 };
 
 /**
@@ -744,6 +785,15 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
         }
     }
 
+    // UDP exporters periodically refresh templates, replicate only new or modified definitions
+    bool repl = false;
+    if (pdata->repl != NULL) {
+        const struct fds_template *tmplt_old;
+        repl = fds_tmgr_template_get(pdata->tmgr, tid, &tmplt_old) != FDS_OK
+            || tmplt_old->raw.length != tmplt->raw.length
+            || memcmp(tmplt_old->raw.data, tmplt->raw.data, tmplt->raw.length) != 0;
+    }
+
     // Add (Options) Template
     if ((rc = fds_tmgr_template_add(pdata->tmgr, tmplt)) != FDS_OK) {
         // Something bad happened
@@ -771,6 +821,12 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
     PARSER_INFO(pdata->parser, msg_ctx, "A definition of the %s ID %" PRIu16 " has been accepted.",
         (type == FDS_TYPE_TEMPLATE) ? "Template" : "Options Template", tid);
 
+    if (repl) {
+        // The template is owned by the manager now, but it is still valid
+        ipx_repl_tmplt(pdata->repl, msg_ctx->session, msg_ctx->odid, type, tmplt->raw.data,
+            tmplt->raw.length);
+    }
+
     return IPX_OK;
 }
 
@@ -837,19 +893,25 @@ parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
  * \brief Parser Data Records in an IPFIX Set
  *
  * First, find an (Options) Template necessary to decode structure of records in this Set and
- * then detect the start position of each Data Record and mark it.
+ * then detect the start position of each Data Record and mark it. If splitting of Data Sets is
+ * deferred, records are only counted.
  * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
  * \param[in]     dset  Pointer to the Set header
+ * \param[out]    tmplt (Options) Template of the Set (NULL if not available)
+ * \param[out]    snap  Template snapshot of the Set (NULL if not available)
  * \return #IPX_OK on success (all records successfully processed)
  * \return #IPX_ERR_FORMAT if an unexpected formatting error has been detected
  * \return #IPX_ERR_ARG in case of an internal error
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
 static inline int
-parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
+parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset,
+    const struct fds_template **tmplt_out, const fds_tsnapshot_t **snap_out)
 {
     uint16_t set_id = ntohs(dset->flowset_id);
     assert(set_id >= FDS_IPFIX_SET_MIN_DSET);
+    *tmplt_out = NULL;
+    *snap_out = NULL;
 
     // Find a Snapshot
     int rc;
@@ -879,6 +941,30 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
         return IPX_OK;
     }
 
+    // Skip the Set if no instance is interested in any field of the Template
+    struct ipx_parser *parser = pdata->parser;
+    const bool skip = (parser->ie_sel != NULL && !ipx_ie_demand_tmplt(parser->ie_sel, tmplt));
+    if (skip) {
+        parser->ie_skipped.sets++;
+    } else {
+        *tmplt_out = tmplt;
+        *snap_out = snap;
+    }
+
+    // Records are not added if they are skipped or split later (i.e. only counted)
+    const bool defer = skip || parser->split_defer;
+    if (defer) {
+        pdata->split_deferred |= !skip;
+        if ((tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0 && tmplt->data_length > 0) {
+            // Fixed size records (anything shorter than a record is padding) -> just count them
+            const uint16_t data_len = ntohs(dset->length) - FDS_IPFIX_SET_HDR_LEN;
+            const uint16_t rec_cnt = data_len / tmplt->data_length;
+            pdata->data_recs += rec_cnt;
+            parser->ie_skipped.recs += (skip) ? rec_cnt : 0;
+            return IPX_OK;
+        }
+    }
+
     struct fds_drec rec;
     rec.tmplt = tmplt;
     rec.snap = snap;
@@ -888,6 +974,13 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
     fds_dset_iter_init(&it, dset, tmplt);
 
     while ((rc = fds_dset_iter_next(&it)) == FDS_OK) {
+        if (defer) {
+            // Only check boundaries of the record
+            pdata->data_recs++;
+            parser->ie_skipped.recs += (skip) ? 1 : 0;
+            continue;
+        }
+
         // Add a new record
         rec.data = it.rec;
         rec.size = it.size;
@@ -936,6 +1029,97 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
     }
 }
 
+/**
+ * \brief Parse an IPFIX Set
+ *
+ * Process records of the Set and add a reference to the Set into the wrapper.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     set   IPFIX Set to parse
+ * \return Same as parser_parse_message()
+ */
+static inline int
+parser_parse_set(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *set)
+{
+    int rc_parse;
+    uint16_t set_id = ntohs(set->flowset_id);
+    const struct fds_template *tmplt = NULL;
+    const fds_tsnapshot_t *snap = NULL;
+
+    if (set_id >= FDS_IPFIX_SET_MIN_DSET) {
+        // Data Set
+        rc_parse = parser_parse_dset(pdata, set, &tmplt, &snap);
+    } else if (set_id == FDS_IPFIX_SET_TMPLT || set_id == FDS_IPFIX_SET_OPTS_TMPLT) {
+        // (Options) Template Set
+        rc_parse = parser_parse_tset(pdata, set);
+    } else {
+        // Unknown Set ID
+        const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+        PARSER_WARNING(pdata->parser, msg_ctx, "Skipping unknown Set ID %" PRIu16 ".", set_id);
+        rc_parse = IPX_OK;
+    }
+
+    // Add a reference to the Set
+    struct ipx_ipfix_set *set_ref = ipx_msg_ipfix_add_set_ref(pdata->ipfix_msg);
+    if (!set_ref) {
+        // Memory allocation failure
+        const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+        PARSER_ERROR(pdata->parser, msg_ctx, "A memory allocation failed (%s:%d).",
+            __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    set_ref->ptr = set;
+    set_ref->tmplt = tmplt;
+    set_ref->snap = snap;
+    return rc_parse;
+}
+
+/**
+ * \brief Parse a segmented IPFIX Message
+ *
+ * Same as parser_parse_message() but Sets are located in multiple memory segments (for example,
+ * a converted NetFlow Message that references unmodified parts of the original message). Each
+ * Set must be stored within a single segment.
+ *
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     cnt   Number of segments
+ * \return Same as parser_parse_message()
+ */
+static int
+parser_parse_segments(struct ipx_parser_data *pdata, size_t cnt)
+{
+    int rc_parse = IPX_OK;
+
+    for (size_t i = 0; rc_parse == IPX_OK && i < cnt; ++i) {
+        // Note: the wrapper (and its array of segments) can be reallocated during parsing
+        const struct iovec *iov;
+        ipx_msg_ipfix_get_segs(pdata->ipfix_msg, &iov, NULL);
+        uint8_t *pos = iov[i].iov_base;
+        uint8_t *end = pos + iov[i].iov_len;
+        if (i == 0) {
+            // Skip the IPFIX Message header
+            pos += FDS_IPFIX_MSG_HDR_LEN;
+        }
+
+        while (rc_parse == IPX_OK && pos < end) {
+            struct fds_ipfix_set_hdr *set = (struct fds_ipfix_set_hdr *) pos;
+            const size_t remain = (size_t) (end - pos);
+            if (remain < FDS_IPFIX_SET_HDR_LEN || ntohs(set->length) < FDS_IPFIX_SET_HDR_LEN
+                    || ntohs(set->length) > remain) {
+                const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+                PARSER_ERROR(pdata->parser, msg_ctx, "Failed to parse an IPFIX Set (invalid "
+                    "length of a Set in the segment %zu).", i);
+                return IPX_ERR_FORMAT;
+            }
+
+            rc_parse = parser_parse_set(pdata, set);
+            pos += ntohs(set->length);
+        }
+    }
+
+    return rc_parse;
+}
+
 /**
  * \brief Parse IPFIX Message
  *
@@ -957,37 +1141,18 @@ parser_parse_message(struct ipx_parser_data *pdata)
     int rc_iter;
     int rc_parse = IPX_OK;
 
+    size_t seg_cnt;
+    ipx_msg_ipfix_get_segs(pdata->ipfix_msg, NULL, &seg_cnt);
+    if (seg_cnt > 1) {
+        return parser_parse_segments(pdata, seg_cnt);
+    }
+
     struct fds_sets_iter it;
     fds_sets_iter_init(&it, (struct fds_ipfix_msg_hdr *) pdata->ipfix_msg->raw_pkt);
 
     // Iterate over all Sets in the IPFIX Message
     while (rc_parse == IPX_OK && (rc_iter = fds_sets_iter_next(&it)) == FDS_OK) {
-        uint16_t set_id = ntohs(it.set->flowset_id);
-
-        if (set_id >= FDS_IPFIX_SET_MIN_DSET) {
-            // Data Set
-            rc_parse = parser_parse_dset(pdata, it.set);
-        } else if (set_id == FDS_IPFIX_SET_TMPLT || set_id == FDS_IPFIX_SET_OPTS_TMPLT) {
-            // (Options) Template Set
-            rc_parse = parser_parse_tset(pdata, it.set);
-        } else {
-            // Unknown Set ID
-            const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
-            PARSER_WARNING(pdata->parser, msg_ctx, "Skipping unknown Set ID %" PRIu16 ".", set_id);
-            rc_parse = IPX_OK;
-        }
-
-        // Add a reference to the Set
-        struct ipx_ipfix_set *set_ref = ipx_msg_ipfix_add_set_ref(pdata->ipfix_msg);
-        if (!set_ref) {
-            // Memory allocation failure
-            const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
-            PARSER_ERROR(pdata->parser, msg_ctx, "A memory allocation failed (%s:%d).",
-                __FILE__, __LINE__);
-            return IPX_ERR_NOMEM;
-        }
-
-        set_ref->ptr = it.set;
+        rc_parse = parser_parse_set(pdata, it.set);
     }
 
     if (rc_parse != IPX_OK) {
@@ -1142,6 +1307,99 @@ parser_convert(ipx_parser_t *parser, struct parser_rec *rec, ipx_msg_ipfix_t *ms
     return IPX_OK;
 }
 
+/** Auxiliary data for replication of templates of a snapshot */
+struct parser_repl_dump {
+    /** Replicator                                 */
+    ipx_repl_t *repl;
+    /** Parser record                              */
+    const struct parser_rec *rec;
+};
+
+/**
+ * \brief Replicate a template (callback for fds_tsnapshot_for())
+ * \param[in] tmplt Template
+ * \param[in] data  Auxiliary data (struct parser_repl_dump)
+ * \return Always true (continue)
+ */
+static bool
+parser_repl_dump_cb(const struct fds_template *tmplt, void *data)
+{
+    struct parser_repl_dump *dump = data;
+    ipx_repl_tmplt(dump->repl, dump->rec->session, dump->rec->odid, tmplt->type, tmplt->raw.data,
+        tmplt->raw.length);
+    return true;
+}
+
+/**
+ * \brief Send the full state of all UDP Transport Sessions to a standby (primary only)
+ * \param[in] parser Message parser
+ */
+static void
+parser_repl_dump(ipx_parser_t *parser)
+{
+    IPX_INFO(parser->ident, "Sending state of UDP sessions to the standby collector...", '\0');
+    ipx_repl_reset(parser->repl);
+
+    const struct ipx_session *session = NULL;
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        const struct parser_rec *rec = &parser->recs[idx];
+        const struct stream_ctx *ctx = rec->ctx;
+        if (rec->session->type != FDS_SESSION_UDP || ctx->type != ST_IPFIX
+                || (ctx->flags & SCF_BLOCK) != 0) {
+            continue;
+        }
+
+        if (rec->session != session) {
+            // The array is primary sorted by Transport Session
+            session = rec->session;
+            ipx_repl_session(parser->repl, session);
+        }
+
+        const fds_tsnapshot_t *snap;
+        if (fds_tmgr_snapshot_get(ctx->mgr, &snap) == FDS_OK) {
+            struct parser_repl_dump dump = {.repl = parser->repl, .rec = rec};
+            fds_tsnapshot_for(snap, &parser_repl_dump_cb, &dump);
+        }
+
+        // UDP uses only Stream 0
+        if (ctx->infos_valid > 0 && (ctx->infos[0].flags & SIF_SEEN) != 0) {
+            ipx_repl_seq(parser->repl, rec->session, rec->odid, ctx->infos[0].seq_num);
+        }
+    }
+}
+
+/**
+ * \brief Fill a Template manager of a new UDP Transport Session with replicated state (standby)
+ *
+ * \note Export Time of the Template manager MUST be already set.
+ * \param[in] parser  Message parser
+ * \param[in] rec     Parser record
+ * \param[in] msg_ctx IPFIX Message context
+ * \param[in] msg_seq Sequence number of the current IPFIX Message
+ */
+static void
+parser_repl_seed(ipx_parser_t *parser, struct parser_rec *rec, const struct ipx_msg_ctx *msg_ctx,
+    uint32_t msg_seq)
+{
+    rec->ctx->flags &= ~SCF_SEED;
+
+    uint32_t seq_num;
+    unsigned int tmplts;
+    bool seq_valid = ipx_repl_seed(parser->repl, msg_ctx->session, msg_ctx->odid, rec->ctx->mgr,
+        &seq_num, &tmplts);
+    if (tmplts == 0 && !seq_valid) {
+        // Unknown to the primary
+        return;
+    }
+
+    PARSER_INFO(parser, msg_ctx, "%u (Options) Template(s) taken over from the primary collector.",
+        tmplts);
+    if (seq_valid && seq_num != msg_seq) {
+        PARSER_WARNING(parser, msg_ctx, "Flow records have been lost during the switchover "
+            "(expected Sequence number: %" PRIu32 ", got: %" PRIu32 ").", seq_num, msg_seq);
+    }
+}
+
 ipx_parser_t *
 ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
 {
@@ -1167,12 +1425,25 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
     parser->vlevel = vlevel;
     parser->recs_alloc = PARSER_DEF_RECS;
     parser->ie_mgr = NULL;
+    parser->repl = NULL;
     return parser;
 }
 
 void
 ipx_parser_destroy(ipx_parser_t *parser)
 {
+    if (parser->odid_dropped.msgs != 0) {
+        IPX_INFO(parser->ident, "%" PRIu64 " message(s) (%" PRIu64 " bytes) of ODIDs not "
+            "processed by any output instance have been dropped.", parser->odid_dropped.msgs,
+            parser->odid_dropped.bytes);
+    }
+
+    if (parser->ie_skipped.sets != 0) {
+        IPX_INFO(parser->ident, "%" PRIu64 " Data Set(s) (%" PRIu64 " records) without any "
+            "Information Element demanded by the pipeline have been skipped.",
+            parser->ie_skipped.sets, parser->ie_skipped.recs);
+    }
+
     // Destroy all stream contexts
     for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
         stream_ctx_destroy(parser->recs[idx].ctx);
@@ -1207,12 +1478,54 @@ ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_
     }
 }
 
+void
+ipx_parser_repl_set(ipx_parser_t *parser, ipx_repl_t *repl)
+{
+    parser->repl = repl;
+}
+
+void
+ipx_parser_odid_sel_set(ipx_parser_t *parser, const ipx_orange_t *sel)
+{
+    parser->odid_sel = sel;
+}
+
+void
+ipx_parser_split_defer(ipx_parser_t *parser, bool enable)
+{
+    parser->split_defer = enable;
+}
+
+void
+ipx_parser_ie_sel_set(ipx_parser_t *parser, const ipx_ie_demand_t *sel)
+{
+    parser->ie_sel = sel;
+}
+
 int
 ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbage_t **garbage)
 {
     *garbage = NULL;
     const struct ipx_msg_ctx *msg_ctx = &(*ipfix)->ctx;
 
+    if (parser->odid_sel != NULL && !ipx_orange_in(parser->odid_sel, msg_ctx->odid)) {
+        // No output instance processes the ODID, drop the message before its parsing
+        parser->odid_dropped.msgs++;
+        parser->odid_dropped.bytes += (*ipfix)->raw_size;
+        return IPX_ERR_DENIED;
+    }
+
+    // Replication to the standby collector
+    ipx_repl_t *repl = NULL;
+    if (parser->repl != NULL && ipx_repl_role_get(parser->repl) == IPX_REPL_PRIMARY) {
+        if (ipx_repl_resync_needed(parser->repl)) {
+            parser_repl_dump(parser);
+        }
+        if (msg_ctx->session->type == FDS_SESSION_UDP) {
+            repl = parser->repl;
+        }
+    }
+
     // Find a Stream Info
     struct parser_rec *rec;   // Combination of Transport Session, ODID
     struct stream_info *info; // Combination of Transport Session, ODID and Stream ID
@@ -1309,13 +1622,23 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         }
     }
 
+    if (rec->ctx->type != ST_IPFIX) {
+        // Converters of NetFlow keep their own state, which is not replicated
+        repl = NULL;
+        rec->ctx->flags &= ~SCF_SEED;
+    } else if ((rec->ctx->flags & SCF_SEED) != 0) {
+        parser_repl_seed(parser, rec, msg_ctx, msg_seq);
+    }
+
     // Parse IPFIX Sets
     struct ipx_parser_data parser_data = {
         .parser = parser,
         .ipfix_msg = *ipfix,
         .tmgr = tmgr,
         .data_recs = 0,
-        .tmplt_changes = false
+        .split_deferred = false,
+        .tmplt_changes = false,
+        .repl = repl
     };
     rc = parser_parse_message(&parser_data);
 
@@ -1334,11 +1657,24 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         return rc;
     }
 
+    if (parser_data.split_deferred) {
+        // Data Records will be split on demand
+        ipx_msg_ipfix_split_defer(*ipfix);
+    }
+
     // Update expected Sequence number of the next message
     if (!old_oos) {
         info->seq_num += parser_data.data_recs;
     }
 
+    // Replicate the Sequence number at most once per second (of Export Time)
+    const uint32_t exp_time = ntohl(msg_data->export_time);
+    if (repl != NULL && !old_oos && info->repl_time != exp_time) {
+        const struct ipx_msg_ctx *ctx_new = &(*ipfix)->ctx;
+        ipx_repl_seq(repl, ctx_new->session, ctx_new->odid, info->seq_num);
+        info->repl_time = exp_time;
+    }
+
     ipx_msg_garbage_t *garbage_msg = NULL;
     if (parser_data.tmplt_changes) {
         // There is potentially garbage to destroy
@@ -1450,6 +1786,11 @@ ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *sessio
         }
     }
 
+    if (parser->repl != NULL && session->type == FDS_SESSION_UDP
+            && ipx_repl_role_get(parser->repl) == IPX_REPL_PRIMARY) {
+        ipx_repl_close(parser->repl, session);
+    }
+
     // Move session data into garbage
     ipx_msg_garbage_t *garbage_msg = parser_rec_to_garbage(parser, idx_start, idx_end);
     /* Note: If the garbage message is NULL, allocation of the memory failed and information about
@@ -44,6 +44,9 @@
 
 #include <ipfixcol2/message.h>
 #include <ipfixcol2/verbose.h>
+#include "ie_demand.h"
+#include "odid_range.h"
+#include "replicator.h"
 
 /**
  * \defgroup ipxParser IPFIX Message parser
@@ -98,6 +101,62 @@ ipx_parser_destroy(ipx_parser_t *parser);
 IPX_API void
 ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_level *v_old);
 
+/**
+ * \brief Set a replicator of template state
+ *
+ * If the role of the replicator is primary, (Options) Templates, sequence numbers and closed
+ * sessions of UDP Transport Sessions are streamed to a standby collector. If the role is standby,
+ * template managers of new UDP Transport Sessions are pre-filled with the replicated state.
+ * \note The replicator MUST exist at least until the parser is destroyed or the replicator is
+ *   replaced.
+ * \param[in] parser Message parser
+ * \param[in] repl   Replicator (can be NULL, i.e. disable replication)
+ */
+IPX_API void
+ipx_parser_repl_set(ipx_parser_t *parser, ipx_repl_t *repl);
+
+/**
+ * \brief Set ODIDs processed by at least one output instance
+ *
+ * Messages of other ODIDs are dropped right after reading their header, i.e. before any
+ * information about the combination of the Transport Session and ODID is created. Dropped
+ * messages are counted and the counters are reported when the parser is destroyed.
+ * \note The selection MUST exist at least until the parser is destroyed or the selection is
+ *   replaced.
+ * \param[in] parser Message parser
+ * \param[in] sel    Selection of ODIDs (can be NULL, i.e. all ODIDs)
+ */
+IPX_API void
+ipx_parser_odid_sel_set(ipx_parser_t *parser, const ipx_orange_t *sel);
+
+/**
+ * \brief Enable/disable deferred splitting of Data Sets into Data Records (disabled by default)
+ *
+ * If enabled, the parser still validates boundaries of IPFIX Sets, availability of Templates and
+ * counts Data Records (necessary for sequence number checks), but references to individual Data
+ * Records are not created. They are created on demand by the first call of
+ * ipx_msg_ipfix_get_drec() or ipx_msg_ipfix_get_drec_cnt() (if ever).
+ * \param[in] parser Message parser
+ * \param[in] enable Enable/disable
+ */
+IPX_API void
+ipx_parser_split_defer(ipx_parser_t *parser, bool enable);
+
+/**
+ * \brief Set Information Elements demanded by at least one instance of the pipeline
+ *
+ * Data Sets of (Options) Templates without any demanded field are skipped, i.e. their Data
+ * Records are only counted (for sequence number checks) and references to the records are not
+ * created. The Template of a skipped Set is not available in the reference to the Set
+ * (see ipx_ipfix_set::tmplt). Skipped Sets are counted and the counters are reported when the
+ * parser is destroyed.
+ * \note The demand MUST exist at least until the parser is destroyed or the demand is replaced.
+ * \param[in] parser Message parser
+ * \param[in] sel    Demand of the pipeline (can be NULL, i.e. all Information Elements)
+ */
+IPX_API void
+ipx_parser_ie_sel_set(ipx_parser_t *parser, const ipx_ie_demand_t *sel);
+
 /**
  * \brief Process IPFIX (or NetFlow) Message
  *
@@ -128,7 +187,9 @@ ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_
  *   destroy the message immediately and the Session should be closed.
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred. User MUST destroy the message
  *   and the Session should be closed.
- * \return #IPX_ERR_DENIED if a Transport Session has been blocked by ipx_parser_session_block()
+ * \return #IPX_ERR_DENIED if a Transport Session has been blocked by ipx_parser_session_block() or
+ *   if the ODID is not processed by any output instance (see ipx_parser_odid_sel_set()). User
+ *   MUST destroy the message.
  */
 IPX_API int
 ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbage_t **garbage);
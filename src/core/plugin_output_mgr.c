@@ -45,7 +45,7 @@
 #include "message_base.h"
 #include "context.h"
 
-/** Definition of a connection with an output instance      */
+/** Definition of a connection with an output instance (or a branch of the pipeline)   */
 struct ipx_output_mgr_rec {
     /** Ring buffer connection (writer only)                */
     ipx_ring_t *ring;
@@ -127,7 +127,7 @@ const struct ipx_plugin_info ipx_plugin_output_mgr_info = {
     .name    = "Output manager",
     .dsc     = "Internal IPFIXcol plugin for passing messages to output plugins.",
     .type    = IPX_PT_OUTPUT_MGR,
-    .flags   = 0,
+    .flags   = IPX_PF_SET_LEVEL,
     .version = "1.0.0",
     .ipx_min = "2.0.0"
 };
@@ -155,22 +155,40 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) cfg;
 }
 
+/**
+ * \brief Pass a message to an output instance
+ *
+ * If the message has been copied into the ring buffer of the instance (see
+ * ipx_ring_inline_mode()), the reference of the instance is released immediately.
+ * \param[in] ring Ring buffer of the output instance
+ * \param[in] msg  Message (the reference counter must be already set)
+ */
+static inline void
+output_mgr_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    if (ipx_ring_push(ring, msg) && ipx_msg_header_cnt_dec(msg)) {
+        ipx_msg_destroy(msg);
+    }
+}
+
 int
 ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
-    (void) ctx;
     // List of output destination is prepared by the configurator
     struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
     assert(list != NULL);
 
+    // Properties stored in the ring buffer (if available) save access to the message
+    const struct ipx_ring_info *info = ipx_ctx_msg_info(ctx);
+
     // Only IPFIX messages are filtered
-    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    enum ipx_msg_type msg_type = (info != NULL) ? info->type : ipx_msg_get_type(msg);
     if (msg_type != IPX_MSG_IPFIX) {
-        // Set the number of references and pass the message to all output instances
-        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+        // Set the number of references and pass the message to all destinations
+        ipx_msg_header_cnt_share(msg, (unsigned int) list->size);
 
         for (size_t i = 0; i < list->size; ++i) {
-            ipx_ring_push(list->recs[i].ring, msg);
+            output_mgr_push(list->recs[i].ring, msg);
         }
 
         return IPX_OK;
@@ -179,7 +197,8 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     // First, get number of destinations...
     uint64_t dest_mask = 0;
     unsigned int dest_cnt = 0;
-    uint32_t odid = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
+    uint32_t odid = (info != NULL)
+        ? info->odid : ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
 
     for (size_t i = 0; i < list->size; ++i) {
         struct ipx_output_mgr_rec *rec = &list->recs[i];
@@ -212,7 +231,7 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     }
 
     // Set the number of references and send to all selected destinations
-    ipx_msg_header_cnt_set(msg, dest_cnt);
+    ipx_msg_header_cnt_share(msg, dest_cnt);
     for (size_t dest_idx = 0; dest_mask != 0; dest_idx++, dest_mask >>= 1) {
         if ((dest_mask & 0x1) == 0) {
             // Skip
@@ -220,7 +239,7 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         struct ipx_output_mgr_rec *rec = &list->recs[dest_idx];
-        ipx_ring_push(rec->ring, msg);
+        output_mgr_push(rec->ring, msg);
     }
 
     return IPX_OK;
@@ -78,7 +78,8 @@ ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list);
 /**
  * \brief Add a new destination to the list
  * \param[in] list        Output manager list
- * \param[in] ring        Output plugin connection  (for a writer)
+ * \param[in] ring        Output plugin connection  (for a writer), or the input of the first
+ *   intermediate instance of a branch of the pipeline
  * \param[in] odid_type   ODID filter type
  * \param[in] odid_filter ODID filter (should be NULL, if odid_type == IPX_ODID_FILTER_NONE)
  * \return #IPX_OK on success
@@ -117,7 +118,8 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg);
  * \brief Pass messages to output plugins
  *
  * Based on configurations (ODID filters, etc.) sets corresponding number of references and
- * passes the message.
+ * passes the message. If the message is already shared by multiple branches of the pipeline,
+ * the number of references is increased instead.
  * \param[in] ctx Plugin context
  * \param[in] cfg Private instance data
  * \param[in] msg IPFIX or Transport Session Message to process
@@ -39,10 +39,17 @@
  *
  */
 
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <libfds.h>
+
 #include "fpipe.h"
 #include "context.h"
 #include "plugin_parser.h"
 #include "parser.h"
+#include "replicator.h"
 
 const struct ipx_plugin_info ipx_plugin_parser_info = {
     .name    = "IPFIX Parser",
@@ -53,11 +60,136 @@ const struct ipx_plugin_info ipx_plugin_parser_info = {
     .ipx_min = "2.0.0"
 };
 
+/** Private data of the parser plugin */
+struct parser_plugin {
+    /** IPFIX Message parser                                */
+    ipx_parser_t *parser;
+    /** Replicator of template state (can be NULL)          */
+    ipx_repl_t *repl;
+};
+
+/*
+ * <replication>
+ *  <role>primary|standby</role>    <!-- mandatory                          -->
+ *  <socket>...</socket>            <!-- optional (Unix socket)             -->
+ *  <host>...</host>                <!-- optional (TCP, remote/local addr.) -->
+ *  <port>...</port>                <!-- optional (TCP)                     -->
+ * </replication>
+ */
+
+/** XML nodes */
+enum repl_xml_nodes {
+    REPL_ROLE = 1,
+    REPL_SOCKET,
+    REPL_HOST,
+    REPL_PORT
+};
+
+/** Definition of the \<replication\> node */
+static const struct fds_xml_args args_repl[] = {
+    FDS_OPTS_ROOT("replication"),
+    FDS_OPTS_ELEM(REPL_ROLE,   "role",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(REPL_SOCKET, "socket", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(REPL_HOST,   "host",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(REPL_PORT,   "port",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Parse configuration of replication and create a replicator
+ * \param[in] ctx    Plugin context
+ * \param[in] params XML configuration (root node "\<replication\>")
+ * \return Pointer to the replicator or NULL (an error message is printed)
+ */
+static ipx_repl_t *
+parser_plugin_repl_create(ipx_ctx_t *ctx, const char *params)
+{
+    fds_xml_t *xml = fds_xml_create();
+    if (!xml) {
+        IPX_CTX_ERROR(ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(xml, args_repl) != FDS_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(xml);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *root = fds_xml_parse_mem(xml, params, true);
+    if (!root) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration of replication: %s",
+            fds_xml_last_err(xml));
+        fds_xml_destroy(xml);
+        return NULL;
+    }
+
+    struct ipx_repl_cfg cfg = {.role = IPX_REPL_PRIMARY, .socket = NULL, .host = NULL, .port = 0};
+    bool port_set = false;
+    bool valid = true;
+
+    const struct fds_xml_cont *content;
+    while (valid && fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case REPL_ROLE:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "primary") == 0) {
+                cfg.role = IPX_REPL_PRIMARY;
+            } else if (strcasecmp(content->ptr_string, "standby") == 0) {
+                cfg.role = IPX_REPL_STANDBY;
+            } else {
+                IPX_CTX_ERROR(ctx, "Unknown replication role '%s' (expected 'primary' or "
+                    "'standby').", content->ptr_string);
+                valid = false;
+            }
+            break;
+        case REPL_SOCKET:
+            assert(content->type == FDS_OPTS_T_STRING);
+            cfg.socket = content->ptr_string;
+            break;
+        case REPL_HOST:
+            assert(content->type == FDS_OPTS_T_STRING);
+            cfg.host = content->ptr_string;
+            break;
+        case REPL_PORT:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Replication port must be between 1..%" PRIu16, UINT16_MAX);
+                valid = false;
+            }
+            cfg.port = (uint16_t) content->val_uint;
+            port_set = true;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    if (valid && (cfg.socket != NULL) == (port_set || cfg.host != NULL)) {
+        IPX_CTX_ERROR(ctx, "Replication requires either <socket> or <port> (and optionally "
+            "<host>), but not both.", '\0');
+        valid = false;
+    }
+
+    if (valid && cfg.role == IPX_REPL_PRIMARY && cfg.socket == NULL && cfg.host == NULL) {
+        IPX_CTX_ERROR(ctx, "Replication requires <host> of the standby collector.", '\0');
+        valid = false;
+    }
+
+    ipx_repl_t *repl = NULL;
+    if (valid) {
+        // Note: strings in the configuration are copied by the replicator
+        repl = ipx_repl_create(ipx_ctx_name_get(ctx), &cfg);
+    }
+
+    fds_xml_destroy(xml);
+    return repl;
+}
+
 int
 ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
 {
-    (void) params; // Not used
-
     // Subscribe to receive IPFIX and Session messages
     const uint16_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
@@ -88,14 +220,49 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
         ipx_msg_garbage_destroy(garbage);
     }
 
-    ipx_ctx_private_set(ctx, parser);
+    // Drop messages of ODIDs that are not processed by any output instance
+    ipx_parser_odid_sel_set(parser, ipx_ctx_odid_sel_get(ctx));
+    // Don't split Data Sets if following instances don't need Data Records
+    ipx_parser_split_defer(parser, ipx_ctx_split_defer_get(ctx));
+    // Skip Data Sets without any field demanded by following instances
+    ipx_parser_ie_sel_set(parser, ipx_ctx_ie_sel_get(ctx));
+
+    struct parser_plugin *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        ipx_parser_destroy(parser);
+        return IPX_ERR_DENIED;
+    }
+    data->parser = parser;
+
+    // Optional replication of template state
+    if (params != NULL) {
+        data->repl = parser_plugin_repl_create(ctx, params);
+        if (!data->repl) {
+            ipx_parser_destroy(parser);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+
+        ipx_parser_repl_set(parser, data->repl);
+    }
+
+    ipx_ctx_private_set(ctx, data);
     return IPX_OK;
 }
 
 void
 ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
 {
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    struct parser_plugin *data = (struct parser_plugin *) cfg;
+    ipx_parser_t *parser = data->parser;
+
+    // The parser can outlive the plugin (see below), stop replication now
+    if (data->repl != NULL) {
+        ipx_parser_repl_set(parser, NULL);
+        ipx_repl_destroy(data->repl);
+    }
+    free(data);
 
     // Create a garbage message
     ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
@@ -287,7 +454,7 @@ int
 ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
     int rc;
-    ipx_parser_t *parser = (ipx_parser_t *) cfg;
+    ipx_parser_t *parser = ((struct parser_plugin *) cfg)->parser;
 
     switch (ipx_msg_get_type(msg)) {
     case IPX_MSG_IPFIX:
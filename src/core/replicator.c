@@ -0,0 +1,1164 @@
+/**
+ * \file src/core/replicator.c
+ * \author agent <agent@local>
+ * \brief Replication of template state between collectors (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "replicator.h"
+#include "verbose.h"
+
+/** Version of the replication protocol                                 */
+#define REPL_VERSION     (1U)
+/** Maximum size of unsent updates (if exceeded, the full state is resent) */
+#define REPL_BUFFER_MAX  (8U * 1024U * 1024U)
+/** Timeout of waiting loops (in milliseconds)                          */
+#define REPL_TIMEOUT     (100)
+/** Delay between connection attempts (in milliseconds)                 */
+#define REPL_RECONNECT   (1000)
+/** Size of the receive buffer of the standby                           */
+#define REPL_RECV_SIZE   (64U * 1024U)
+
+/** Type of replication event */
+enum repl_event {
+    /** Forget all state (beginning of the full state)                  */
+    REPL_EV_RESET = 1,
+    /** Description of a Transport Session (body: key + ident)          */
+    REPL_EV_SESSION,
+    /** (Options) Template definition (body: key + type + raw record)   */
+    REPL_EV_TMPLT,
+    /** Expected sequence number (body: key + sequence number)          */
+    REPL_EV_SEQ,
+    /** Transport Session closed (body: key)                            */
+    REPL_EV_CLOSE
+};
+
+/** Header of a replication event (network byte order) */
+struct __attribute__((__packed__)) repl_hdr {
+    /** Protocol version                                                */
+    uint8_t version;
+    /** Event type (see #repl_event)                                    */
+    uint8_t type;
+    /** Reserved (must be zero)                                         */
+    uint16_t reserved;
+    /** Total length of the event (including this header)              */
+    uint32_t length;
+};
+
+/** Identification of an exporter and its Observation Domain */
+struct __attribute__((__packed__)) repl_key {
+    /** IPv6 or IPv4-mapped IPv6 address of the exporter                */
+    uint8_t addr[16];
+    /** Source port of the exporter                                     */
+    uint16_t port;
+    /** Reserved (must be zero)                                         */
+    uint16_t reserved;
+    /** Observation Domain ID (ignored by session events)               */
+    uint32_t odid;
+};
+
+/** Replicated (Options) Template */
+struct repl_tmplt {
+    /** Template type                                                   */
+    enum fds_template_type type;
+    /** Template ID                                                     */
+    uint16_t id;
+    /** Size of the raw template record                                 */
+    uint16_t size;
+    /** Raw template record                                             */
+    uint8_t *data;
+};
+
+/** Replicated state of an exporter and its Observation Domain (standby only) */
+struct repl_entry {
+    /** Exporter and ODID (host byte order)                             */
+    struct repl_key key;
+    /** Is the sequence number valid                                    */
+    bool seq_valid;
+    /** Expected sequence number                                        */
+    uint32_t seq_num;
+    /** Number of templates                                             */
+    size_t tmplts_cnt;
+    /** Array of templates                                              */
+    struct repl_tmplt *tmplts;
+};
+
+/** Replicator */
+struct ipx_repl {
+    /** Identification (for logs)                                       */
+    char *ident;
+    /** Role of the collector                                           */
+    enum ipx_repl_role role;
+    /** Path of the Unix domain socket (NULL == TCP)                    */
+    char *socket;
+    /** Remote/local address (can be NULL)                              */
+    char *host;
+    /** TCP port                                                        */
+    uint16_t port;
+    /** Listening socket (standby only)                                 */
+    int fd_listen;
+
+    /** Thread of the replicator                                        */
+    pthread_t thread;
+    /** Mutex for all items below                                       */
+    pthread_mutex_t mutex;
+    /** Stop flag of the thread                                         */
+    bool stop;
+
+    struct {
+        /** Condition variable (new updates to send)                    */
+        pthread_cond_t cond;
+        /** Connected to the standby                                    */
+        bool connected;
+        /** The full state must be sent                                 */
+        bool resync;
+        /** Buffer of unsent updates                                    */
+        uint8_t *data;
+        /** Size of valid data in the buffer                            */
+        size_t size;
+        /** Allocated size of the buffer                                */
+        size_t alloc;
+    } tx; /**< Primary only */
+
+    struct {
+        /** Number of entries                                           */
+        size_t cnt;
+        /** Array of entries                                            */
+        struct repl_entry *entries;
+    } store; /**< Standby only */
+};
+
+/**
+ * \brief Fill an identification key of a Transport Session
+ * \param[in]  session Transport Session (UDP)
+ * \param[in]  odid    Observation Domain ID
+ * \param[out] key     Key (host byte order)
+ */
+static void
+repl_key_fill(const struct ipx_session *session, uint32_t odid, struct repl_key *key)
+{
+    static const uint8_t v4_prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    const struct ipx_session_net *net = &session->udp.net;
+    assert(session->type == FDS_SESSION_UDP);
+
+    memset(key, 0, sizeof(*key));
+    if (net->l3_proto == AF_INET) {
+        memcpy(key->addr, v4_prefix, sizeof(v4_prefix));
+        memcpy(&key->addr[12], &net->addr_src.ipv4, 4U);
+    } else {
+        memcpy(key->addr, &net->addr_src.ipv6, 16U);
+    }
+
+    key->port = net->port_src;
+    key->odid = odid;
+}
+
+/**
+ * \brief Compare exporters of two keys (ODID is ignored)
+ * \return True if the exporters are the same
+ */
+static inline bool
+repl_key_exporter_eq(const struct repl_key *k1, const struct repl_key *k2)
+{
+    return k1->port == k2->port && memcmp(k1->addr, k2->addr, sizeof(k1->addr)) == 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Primary
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Append an event to the buffer of unsent updates
+ *
+ * If the primary is not connected to the standby, the event is dropped (the full state will be
+ * sent after a connection is established). If the buffer is full, all unsent updates are dropped
+ * and the full state is requested.
+ * \param[in] repl  Replicator
+ * \param[in] type  Event type
+ * \param[in] key   Key (host byte order, can be NULL)
+ * \param[in] body  Body of the event after the key (can be NULL)
+ * \param[in] size  Size of the body
+ * \param[in] body2 Second part of the body (can be NULL)
+ * \param[in] size2 Size of the second part
+ */
+static void
+repl_event_add(ipx_repl_t *repl, enum repl_event type, const struct repl_key *key,
+    const void *body, size_t size, const void *body2, size_t size2)
+{
+    assert(repl->role == IPX_REPL_PRIMARY);
+
+    const size_t key_size = (key != NULL) ? sizeof(*key) : 0;
+    const size_t total = sizeof(struct repl_hdr) + key_size + size + size2;
+
+    pthread_mutex_lock(&repl->mutex);
+    if (!repl->tx.connected || repl->tx.resync) {
+        // Not connected or waiting for the full state
+        pthread_mutex_unlock(&repl->mutex);
+        return;
+    }
+
+    if (repl->tx.size + total > REPL_BUFFER_MAX) {
+        IPX_WARNING(repl->ident, "Replication is too slow, unsent updates have been dropped. "
+            "The full state will be sent again.", '\0');
+        repl->tx.size = 0;
+        repl->tx.resync = true;
+        pthread_mutex_unlock(&repl->mutex);
+        return;
+    }
+
+    if (repl->tx.size + total > repl->tx.alloc) {
+        size_t alloc_new = (repl->tx.alloc != 0) ? repl->tx.alloc : 4096U;
+        while (alloc_new < repl->tx.size + total) {
+            alloc_new *= 2;
+        }
+
+        uint8_t *data_new = realloc(repl->tx.data, alloc_new);
+        if (!data_new) {
+            IPX_ERROR(repl->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+            repl->tx.size = 0;
+            repl->tx.resync = true;
+            pthread_mutex_unlock(&repl->mutex);
+            return;
+        }
+
+        repl->tx.data = data_new;
+        repl->tx.alloc = alloc_new;
+    }
+
+    uint8_t *pos = repl->tx.data + repl->tx.size;
+    struct repl_hdr hdr = {
+        .version = REPL_VERSION,
+        .type = (uint8_t) type,
+        .reserved = 0,
+        .length = htonl((uint32_t) total)
+    };
+    memcpy(pos, &hdr, sizeof(hdr));
+    pos += sizeof(hdr);
+
+    if (key != NULL) {
+        struct repl_key key_net = *key;
+        key_net.port = htons(key->port);
+        key_net.odid = htonl(key->odid);
+        memcpy(pos, &key_net, sizeof(key_net));
+        pos += sizeof(key_net);
+    }
+
+    if (size > 0) {
+        memcpy(pos, body, size);
+        pos += size;
+    }
+
+    if (size2 > 0) {
+        memcpy(pos, body2, size2);
+    }
+
+    repl->tx.size += total;
+    pthread_cond_signal(&repl->tx.cond);
+    pthread_mutex_unlock(&repl->mutex);
+}
+
+/**
+ * \brief Connect to the standby
+ * \param[in] repl Replicator
+ * \return Socket descriptor or -1 (failed)
+ */
+static int
+repl_primary_connect(ipx_repl_t *repl)
+{
+    int fd;
+
+    if (repl->socket != NULL) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, repl->socket, sizeof(addr.sun_path) - 1);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1) {
+            return -1;
+        }
+
+        if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%" PRIu16, repl->port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *res;
+    if (getaddrinfo(repl->host, port_str, &hints, &res) != 0) {
+        return -1;
+    }
+
+    fd = -1;
+    for (struct addrinfo *it = res; it != NULL; it = it->ai_next) {
+        fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if (fd == -1) {
+            continue;
+        }
+
+        if (connect(fd, it->ai_addr, it->ai_addrlen) == 0) {
+            break;
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(res);
+    return fd;
+}
+
+/**
+ * \brief Send data to the standby
+ * \return True on success, false if the connection has been lost
+ */
+static bool
+repl_primary_send(int fd, const uint8_t *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t ret = send(fd, data, size, MSG_NOSIGNAL);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+
+        data += ret;
+        size -= (size_t) ret;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Check if the standby has closed the connection
+ * \return True if the connection is closed
+ */
+static bool
+repl_primary_closed(int fd)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+    if (poll(&pfd, 1, 0) <= 0) {
+        return false;
+    }
+
+    // The standby never sends anything, so readable socket means EOF or an error
+    char byte;
+    return recv(fd, &byte, 1, MSG_DONTWAIT) <= 0;
+}
+
+/**
+ * \brief Thread of the primary replicator
+ *
+ * Maintains a connection to the standby and sends updates produced by a parser.
+ * \param[in] arg Replicator
+ * \return Nothing
+ */
+static void *
+repl_primary_thread(void *arg)
+{
+    ipx_repl_t *repl = (ipx_repl_t *) arg;
+    uint8_t *data = NULL;   // Local copy of updates
+    size_t data_alloc = 0;
+    int fd = -1;
+    bool failed = false;    // Last connection attempt failed
+
+    pthread_mutex_lock(&repl->mutex);
+    while (!repl->stop) {
+        if (fd == -1) {
+            // Try to (re)connect
+            pthread_mutex_unlock(&repl->mutex);
+            fd = repl_primary_connect(repl);
+            pthread_mutex_lock(&repl->mutex);
+
+            if (fd == -1) {
+                if (!failed) {
+                    IPX_WARNING(repl->ident, "Unable to connect to the standby collector. "
+                        "Trying again...", '\0');
+                    failed = true;
+                }
+
+                struct timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                ts.tv_sec += REPL_RECONNECT / 1000;
+                pthread_cond_timedwait(&repl->tx.cond, &repl->mutex, &ts);
+                continue;
+            }
+
+            IPX_INFO(repl->ident, "Connected to the standby collector.", '\0');
+            failed = false;
+            repl->tx.connected = true;
+            repl->tx.resync = true;
+            repl->tx.size = 0;
+        }
+
+        if (repl->tx.size == 0) {
+            // Wait for new updates
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += REPL_TIMEOUT * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec += 1;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&repl->tx.cond, &repl->mutex, &ts);
+
+            if (repl->tx.size == 0) {
+                pthread_mutex_unlock(&repl->mutex);
+                bool closed = repl_primary_closed(fd);
+                pthread_mutex_lock(&repl->mutex);
+                if (!closed) {
+                    continue;
+                }
+
+                IPX_WARNING(repl->ident, "Connection to the standby collector has been closed.",
+                    '\0');
+                close(fd);
+                fd = -1;
+                repl->tx.connected = false;
+                continue;
+            }
+        }
+
+        // Take the updates and send them without holding the lock
+        if (data_alloc < repl->tx.size) {
+            uint8_t *data_new = realloc(data, repl->tx.alloc);
+            if (!data_new) {
+                IPX_ERROR(repl->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+                repl->tx.size = 0;
+                repl->tx.resync = true;
+                continue;
+            }
+            data = data_new;
+            data_alloc = repl->tx.alloc;
+        }
+
+        const size_t data_size = repl->tx.size;
+        memcpy(data, repl->tx.data, data_size);
+        repl->tx.size = 0;
+        pthread_mutex_unlock(&repl->mutex);
+
+        bool ok = repl_primary_send(fd, data, data_size);
+        pthread_mutex_lock(&repl->mutex);
+
+        if (!ok) {
+            IPX_WARNING(repl->ident, "Failed to send updates to the standby collector. "
+                "Reconnecting...", '\0');
+            close(fd);
+            fd = -1;
+            repl->tx.connected = false;
+        }
+    }
+
+    repl->tx.connected = false;
+    pthread_mutex_unlock(&repl->mutex);
+
+    if (fd != -1) {
+        close(fd);
+    }
+    free(data);
+    return NULL;
+}
+
+bool
+ipx_repl_resync_needed(ipx_repl_t *repl)
+{
+    pthread_mutex_lock(&repl->mutex);
+    bool ret = repl->tx.connected && repl->tx.resync;
+    if (ret) {
+        // From now, updates are accepted
+        repl->tx.resync = false;
+    }
+    pthread_mutex_unlock(&repl->mutex);
+    return ret;
+}
+
+void
+ipx_repl_reset(ipx_repl_t *repl)
+{
+    repl_event_add(repl, REPL_EV_RESET, NULL, NULL, 0, NULL, 0);
+}
+
+void
+ipx_repl_session(ipx_repl_t *repl, const struct ipx_session *session)
+{
+    struct repl_key key;
+    repl_key_fill(session, 0, &key);
+    repl_event_add(repl, REPL_EV_SESSION, &key, session->ident, strlen(session->ident), NULL, 0);
+}
+
+void
+ipx_repl_tmplt(ipx_repl_t *repl, const struct ipx_session *session, uint32_t odid,
+    enum fds_template_type type, const uint8_t *data, uint16_t size)
+{
+    struct repl_key key;
+    repl_key_fill(session, odid, &key);
+    uint16_t type_net[2] = {htons((uint16_t) type), 0};
+    repl_event_add(repl, REPL_EV_TMPLT, &key, type_net, sizeof(type_net), data, size);
+}
+
+void
+ipx_repl_seq(ipx_repl_t *repl, const struct ipx_session *session, uint32_t odid,
+    uint32_t seq_num)
+{
+    struct repl_key key;
+    repl_key_fill(session, odid, &key);
+    uint32_t seq_net = htonl(seq_num);
+    repl_event_add(repl, REPL_EV_SEQ, &key, &seq_net, sizeof(seq_net), NULL, 0);
+}
+
+void
+ipx_repl_close(ipx_repl_t *repl, const struct ipx_session *session)
+{
+    struct repl_key key;
+    repl_key_fill(session, 0, &key);
+    repl_event_add(repl, REPL_EV_CLOSE, &key, NULL, 0, NULL, 0);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Standby
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Destroy a replicated entry (only its content)
+ * \param[in] entry Entry
+ */
+static void
+repl_entry_clear(struct repl_entry *entry)
+{
+    for (size_t i = 0; i < entry->tmplts_cnt; ++i) {
+        free(entry->tmplts[i].data);
+    }
+    free(entry->tmplts);
+    entry->tmplts = NULL;
+    entry->tmplts_cnt = 0;
+}
+
+/**
+ * \brief Remove all replicated entries
+ * \note The mutex must be locked by the caller!
+ * \param[in] repl Replicator
+ */
+static void
+repl_store_clear(ipx_repl_t *repl)
+{
+    for (size_t i = 0; i < repl->store.cnt; ++i) {
+        repl_entry_clear(&repl->store.entries[i]);
+    }
+    free(repl->store.entries);
+    repl->store.entries = NULL;
+    repl->store.cnt = 0;
+}
+
+/**
+ * \brief Find a replicated entry
+ * \note The mutex must be locked by the caller!
+ * \param[in] repl   Replicator
+ * \param[in] key    Key (host byte order)
+ * \param[in] create Create the entry if it doesn't exist
+ * \return Pointer to the entry or NULL (not found or memory allocation error)
+ */
+static struct repl_entry *
+repl_store_get(ipx_repl_t *repl, const struct repl_key *key, bool create)
+{
+    for (size_t i = 0; i < repl->store.cnt; ++i) {
+        struct repl_entry *entry = &repl->store.entries[i];
+        if (entry->key.odid == key->odid && repl_key_exporter_eq(&entry->key, key)) {
+            return entry;
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    const size_t size_new = (repl->store.cnt + 1) * sizeof(struct repl_entry);
+    struct repl_entry *entries_new = realloc(repl->store.entries, size_new);
+    if (!entries_new) {
+        return NULL;
+    }
+
+    repl->store.entries = entries_new;
+    struct repl_entry *entry = &entries_new[repl->store.cnt++];
+    memset(entry, 0, sizeof(*entry));
+    entry->key = *key;
+    return entry;
+}
+
+/**
+ * \brief Remove all entries of an exporter
+ * \note The mutex must be locked by the caller!
+ * \param[in] repl Replicator
+ * \param[in] key  Key of the exporter (ODID is ignored)
+ */
+static void
+repl_store_remove(ipx_repl_t *repl, const struct repl_key *key)
+{
+    size_t idx_new = 0;
+    for (size_t i = 0; i < repl->store.cnt; ++i) {
+        struct repl_entry *entry = &repl->store.entries[i];
+        if (repl_key_exporter_eq(&entry->key, key)) {
+            repl_entry_clear(entry);
+            continue;
+        }
+
+        repl->store.entries[idx_new++] = *entry;
+    }
+
+    repl->store.cnt = idx_new;
+}
+
+/**
+ * \brief Add or replace a template of an entry
+ * \param[in] entry Entry
+ * \param[in] type  Template type
+ * \param[in] data  Raw template record
+ * \param[in] size  Size of the record
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the record is malformed
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+repl_entry_tmplt(struct repl_entry *entry, enum fds_template_type type, const uint8_t *data,
+    uint16_t size)
+{
+    if (size < sizeof(uint16_t)) {
+        return IPX_ERR_FORMAT;
+    }
+
+    uint16_t tid;
+    memcpy(&tid, data, sizeof(tid));
+    tid = ntohs(tid);
+
+    uint8_t *data_cpy = malloc(size);
+    if (!data_cpy) {
+        return IPX_ERR_NOMEM;
+    }
+    memcpy(data_cpy, data, size);
+
+    struct repl_tmplt *tmplt = NULL;
+    for (size_t i = 0; i < entry->tmplts_cnt; ++i) {
+        if (entry->tmplts[i].id == tid) {
+            tmplt = &entry->tmplts[i];
+            free(tmplt->data);
+            break;
+        }
+    }
+
+    if (!tmplt) {
+        const size_t size_new = (entry->tmplts_cnt + 1) * sizeof(struct repl_tmplt);
+        struct repl_tmplt *tmplts_new = realloc(entry->tmplts, size_new);
+        if (!tmplts_new) {
+            free(data_cpy);
+            return IPX_ERR_NOMEM;
+        }
+
+        entry->tmplts = tmplts_new;
+        tmplt = &tmplts_new[entry->tmplts_cnt++];
+    }
+
+    tmplt->type = type;
+    tmplt->id = tid;
+    tmplt->size = size;
+    tmplt->data = data_cpy;
+    return IPX_OK;
+}
+
+/**
+ * \brief Apply a received event to the replicated state
+ * \param[in] repl Replicator
+ * \param[in] type Event type
+ * \param[in] body Body of the event (after the header)
+ * \param[in] size Size of the body
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the event is malformed (the connection should be closed)
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+repl_standby_apply(ipx_repl_t *repl, uint8_t type, const uint8_t *body, size_t size)
+{
+    if (type == REPL_EV_RESET) {
+        pthread_mutex_lock(&repl->mutex);
+        repl_store_clear(repl);
+        pthread_mutex_unlock(&repl->mutex);
+        IPX_DEBUG(repl->ident, "Receiving the full state of the primary collector...", '\0');
+        return IPX_OK;
+    }
+
+    struct repl_key key;
+    if (size < sizeof(key)) {
+        return IPX_ERR_FORMAT;
+    }
+
+    memcpy(&key, body, sizeof(key));
+    key.port = ntohs(key.port);
+    key.odid = ntohl(key.odid);
+    body += sizeof(key);
+    size -= sizeof(key);
+
+    int rc = IPX_OK;
+    struct repl_entry *entry;
+
+    pthread_mutex_lock(&repl->mutex);
+    switch (type) {
+    case REPL_EV_SESSION:
+        IPX_DEBUG(repl->ident, "Replicating state of the session '%.*s'", (int) size,
+            (const char *) body);
+        break;
+    case REPL_EV_TMPLT: {
+        uint16_t type_net[2];
+        if (size < sizeof(type_net)) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        memcpy(type_net, body, sizeof(type_net));
+        const enum fds_template_type t_type = (enum fds_template_type) ntohs(type_net[0]);
+        if ((t_type != FDS_TYPE_TEMPLATE && t_type != FDS_TYPE_TEMPLATE_OPTS)
+                || size - sizeof(type_net) > UINT16_MAX) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        if ((entry = repl_store_get(repl, &key, true)) == NULL) {
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+
+        rc = repl_entry_tmplt(entry, t_type, body + sizeof(type_net),
+            (uint16_t) (size - sizeof(type_net)));
+        break;
+        }
+    case REPL_EV_SEQ: {
+        uint32_t seq_net;
+        if (size < sizeof(seq_net)) {
+            rc = IPX_ERR_FORMAT;
+            break;
+        }
+
+        if ((entry = repl_store_get(repl, &key, true)) == NULL) {
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+
+        memcpy(&seq_net, body, sizeof(seq_net));
+        entry->seq_num = ntohl(seq_net);
+        entry->seq_valid = true;
+        break;
+        }
+    case REPL_EV_CLOSE:
+        repl_store_remove(repl, &key);
+        break;
+    default:
+        // Unknown events are ignored (forward compatibility)
+        break;
+    }
+    pthread_mutex_unlock(&repl->mutex);
+
+    if (rc == IPX_ERR_NOMEM) {
+        IPX_ERROR(repl->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+    }
+    return rc;
+}
+
+/**
+ * \brief Create a listening socket of the standby
+ * \param[in] repl Replicator
+ * \return Socket descriptor or -1 (an error message is printed)
+ */
+static int
+repl_standby_listen(ipx_repl_t *repl)
+{
+    int fd = -1;
+
+    if (repl->socket != NULL) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(repl->socket) >= sizeof(addr.sun_path)) {
+            IPX_ERROR(repl->ident, "Socket path '%s' is too long.", repl->socket);
+            return -1;
+        }
+        strcpy(addr.sun_path, repl->socket);
+        unlink(repl->socket);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd != -1 && (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0
+                || listen(fd, 1) != 0)) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        char port_str[8];
+        snprintf(port_str, sizeof(port_str), "%" PRIu16, repl->port);
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+
+        struct addrinfo *res;
+        if (getaddrinfo(repl->host, port_str, &hints, &res) == 0) {
+            for (struct addrinfo *it = res; it != NULL; it = it->ai_next) {
+                fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+                if (fd == -1) {
+                    continue;
+                }
+
+                int yes = 1;
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+                if (bind(fd, it->ai_addr, it->ai_addrlen) == 0 && listen(fd, 1) == 0) {
+                    break;
+                }
+
+                close(fd);
+                fd = -1;
+            }
+            freeaddrinfo(res);
+        }
+    }
+
+    if (fd == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(repl->ident, "Failed to create a replication socket: %s", err_str);
+    }
+
+    return fd;
+}
+
+/**
+ * \brief Thread of the standby replicator
+ *
+ * Accepts a connection of the primary (a new connection replaces the previous one) and applies
+ * received events to the replicated state.
+ * \param[in] arg Replicator
+ * \return Nothing
+ */
+static void *
+repl_standby_thread(void *arg)
+{
+    ipx_repl_t *repl = (ipx_repl_t *) arg;
+    const int fd_listen = repl->fd_listen;
+    int fd_conn = -1;
+
+    uint8_t *buffer = malloc(REPL_RECV_SIZE);
+    size_t buffer_alloc = REPL_RECV_SIZE;
+    size_t buffer_size = 0;
+    if (!buffer) {
+        IPX_ERROR(repl->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    while (true) {
+        pthread_mutex_lock(&repl->mutex);
+        const bool stop = repl->stop;
+        pthread_mutex_unlock(&repl->mutex);
+        if (stop) {
+            break;
+        }
+
+        struct pollfd pfds[2] = {
+            {.fd = fd_listen, .events = POLLIN, .revents = 0},
+            {.fd = fd_conn,   .events = POLLIN, .revents = 0}
+        };
+        int ret = poll(pfds, (fd_conn != -1) ? 2 : 1, REPL_TIMEOUT);
+        if (ret <= 0) {
+            continue;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            int fd_new = accept(fd_listen, NULL, NULL);
+            if (fd_new != -1) {
+                if (fd_conn != -1) {
+                    IPX_WARNING(repl->ident, "A new primary collector has connected. "
+                        "Replacing the previous connection.", '\0');
+                    close(fd_conn);
+                }
+
+                IPX_INFO(repl->ident, "The primary collector has connected.", '\0');
+                fd_conn = fd_new;
+                buffer_size = 0;
+                continue;
+            }
+        }
+
+        if (fd_conn == -1 || (pfds[1].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+            continue;
+        }
+
+        ssize_t len = recv(fd_conn, buffer + buffer_size, buffer_alloc - buffer_size, 0);
+        if (len <= 0) {
+            if (len == -1 && errno == EINTR) {
+                continue;
+            }
+
+            // The state is kept until the primary connects again (it might be needed soon)
+            IPX_WARNING(repl->ident, "Connection to the primary collector has been closed. "
+                "Keeping the last known state.", '\0');
+            close(fd_conn);
+            fd_conn = -1;
+            continue;
+        }
+        buffer_size += (size_t) len;
+
+        // Process all complete events
+        size_t pos = 0;
+        bool failed = false;
+        while (buffer_size - pos >= sizeof(struct repl_hdr)) {
+            struct repl_hdr hdr;
+            memcpy(&hdr, buffer + pos, sizeof(hdr));
+            const size_t ev_size = ntohl(hdr.length);
+            if (hdr.version != REPL_VERSION || ev_size < sizeof(hdr)) {
+                failed = true;
+                break;
+            }
+
+            if (ev_size > buffer_alloc) {
+                // Too long event -> the buffer must be enlarged
+                uint8_t *buffer_new = realloc(buffer, ev_size);
+                if (!buffer_new) {
+                    failed = true;
+                    break;
+                }
+                buffer = buffer_new;
+                buffer_alloc = ev_size;
+            }
+
+            if (buffer_size - pos < ev_size) {
+                // Incomplete event
+                break;
+            }
+
+            const uint8_t *body = buffer + pos + sizeof(hdr);
+            if (repl_standby_apply(repl, hdr.type, body, ev_size - sizeof(hdr)) != IPX_OK) {
+                failed = true;
+                break;
+            }
+
+            pos += ev_size;
+        }
+
+        if (failed) {
+            IPX_ERROR(repl->ident, "Received malformed replication data. Closing connection "
+                "to the primary collector.", '\0');
+            close(fd_conn);
+            fd_conn = -1;
+            buffer_size = 0;
+            continue;
+        }
+
+        // Move the rest of the data to the beginning
+        memmove(buffer, buffer + pos, buffer_size - pos);
+        buffer_size -= pos;
+    }
+
+    if (fd_conn != -1) {
+        close(fd_conn);
+    }
+    free(buffer);
+    return NULL;
+}
+
+bool
+ipx_repl_seed(ipx_repl_t *repl, const struct ipx_session *session, uint32_t odid,
+    fds_tmgr_t *tmgr, uint32_t *seq_num, unsigned int *tmplts)
+{
+    assert(repl->role == IPX_REPL_STANDBY);
+    *tmplts = 0;
+
+    struct repl_key key;
+    repl_key_fill(session, odid, &key);
+
+    pthread_mutex_lock(&repl->mutex);
+    struct repl_entry *entry = repl_store_get(repl, &key, false);
+    if (!entry) {
+        pthread_mutex_unlock(&repl->mutex);
+        return false;
+    }
+
+    for (size_t i = 0; i < entry->tmplts_cnt; ++i) {
+        const struct repl_tmplt *rec = &entry->tmplts[i];
+        struct fds_template *tmplt;
+        uint16_t size = rec->size;
+
+        if (fds_template_parse(rec->type, rec->data, &size, &tmplt) != FDS_OK) {
+            IPX_WARNING(repl->ident, "Failed to parse a replicated template (Template ID "
+                "%" PRIu16 ").", rec->id);
+            continue;
+        }
+
+        if (fds_tmgr_template_add(tmgr, tmplt) != FDS_OK) {
+            fds_template_destroy(tmplt);
+            IPX_WARNING(repl->ident, "Failed to add a replicated template (Template ID "
+                "%" PRIu16 ").", rec->id);
+            continue;
+        }
+
+        (*tmplts)++;
+    }
+
+    const bool seq_valid = entry->seq_valid;
+    *seq_num = entry->seq_num;
+    pthread_mutex_unlock(&repl->mutex);
+    return seq_valid;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Common
+// -------------------------------------------------------------------------------------------------
+
+ipx_repl_t *
+ipx_repl_create(const char *ident, const struct ipx_repl_cfg *cfg)
+{
+    struct ipx_repl *repl = calloc(1, sizeof(*repl));
+    if (!repl) {
+        IPX_ERROR(ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    repl->role = cfg->role;
+    repl->port = cfg->port;
+    repl->ident = strdup(ident);
+    repl->socket = (cfg->socket != NULL) ? strdup(cfg->socket) : NULL;
+    repl->host = (cfg->host != NULL) ? strdup(cfg->host) : NULL;
+    if (!repl->ident || (cfg->socket && !repl->socket) || (cfg->host && !repl->host)) {
+        IPX_ERROR(ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        goto err_params;
+    }
+
+    if (pthread_mutex_init(&repl->mutex, NULL) != 0) {
+        IPX_ERROR(ident, "Failed to initialize a mutex.", '\0');
+        goto err_params;
+    }
+
+    if (pthread_cond_init(&repl->tx.cond, NULL) != 0) {
+        IPX_ERROR(ident, "Failed to initialize a condition variable.", '\0');
+        goto err_mutex;
+    }
+
+    void *(*thread_fn)(void *) = &repl_primary_thread;
+    if (repl->role == IPX_REPL_STANDBY) {
+        // The socket must be ready before the collector starts receiving flows
+        repl->fd_listen = repl_standby_listen(repl);
+        if (repl->fd_listen == -1) {
+            goto err_cond;
+        }
+
+        thread_fn = &repl_standby_thread;
+    }
+
+    if (pthread_create(&repl->thread, NULL, thread_fn, repl) != 0) {
+        IPX_ERROR(ident, "Failed to start a replication thread.", '\0');
+        if (repl->role == IPX_REPL_STANDBY) {
+            close(repl->fd_listen);
+        }
+        goto err_cond;
+    }
+
+    return repl;
+
+err_cond:
+    pthread_cond_destroy(&repl->tx.cond);
+err_mutex:
+    pthread_mutex_destroy(&repl->mutex);
+err_params:
+    free(repl->host);
+    free(repl->socket);
+    free(repl->ident);
+    free(repl);
+    return NULL;
+}
+
+void
+ipx_repl_destroy(ipx_repl_t *repl)
+{
+    pthread_mutex_lock(&repl->mutex);
+    repl->stop = true;
+    pthread_cond_signal(&repl->tx.cond);
+    pthread_mutex_unlock(&repl->mutex);
+    pthread_join(repl->thread, NULL);
+
+    if (repl->role == IPX_REPL_STANDBY) {
+        close(repl->fd_listen);
+        if (repl->socket != NULL) {
+            unlink(repl->socket);
+        }
+    }
+
+    repl_store_clear(repl);
+    free(repl->tx.data);
+    pthread_cond_destroy(&repl->tx.cond);
+    pthread_mutex_destroy(&repl->mutex);
+    free(repl->host);
+    free(repl->socket);
+    free(repl->ident);
+    free(repl);
+}
+
+enum ipx_repl_role
+ipx_repl_role_get(const ipx_repl_t *repl)
+{
+    return repl->role;
+}
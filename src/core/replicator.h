@@ -0,0 +1,200 @@
+/**
+ * \file src/core/replicator.h
+ * \author agent <agent@local>
+ * \brief Replication of template state between collectors (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_REPLICATOR_H
+#define IPFIXCOL_REPLICATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+/**
+ * \defgroup ipxReplicator Replication of template state
+ * \brief Hot-standby replication of (Options) Templates and sequence numbers of UDP sessions
+ *
+ * A parser of a primary collector streams definitions of (Options) Templates, session metadata
+ * and expected sequence numbers of UDP Transport Sessions to a standby collector. The standby
+ * keeps a warm copy of the state and uses it to pre-fill template managers of new Transport
+ * Sessions. Therefore, when exporters' traffic is moved to the standby (e.g. by moving a virtual
+ * IP address), the standby is able to interpret Data Records immediately and it doesn't have to
+ * wait for the next template refresh.
+ *
+ * Only UDP sessions of IPFIX Messages are replicated. Other session types (TCP, SCTP) always
+ * send templates at the beginning of a new connection and the NetFlow converters keep their own
+ * state. Sessions are matched by the exporter's address and port (i.e. the local address and
+ * port of the collector may differ).
+ *
+ * The primary connects to the standby and sends its full state after each (re)connection. If
+ * the standby is not reachable or too slow, updates are dropped and the full state is sent again
+ * after a new connection is established.
+ * @{
+ */
+
+/** Internal data type of the replicator */
+typedef struct ipx_repl ipx_repl_t;
+
+/** Role of the collector */
+enum ipx_repl_role {
+    /** Send the state to a standby collector          */
+    IPX_REPL_PRIMARY,
+    /** Receive the state from a primary collector     */
+    IPX_REPL_STANDBY
+};
+
+/** Configuration of the replication channel */
+struct ipx_repl_cfg {
+    /** Role of the collector                                                                 */
+    enum ipx_repl_role role;
+    /** Path of a Unix domain socket (if NULL, TCP is used)                                    */
+    const char *socket;
+    /** Primary: address of the standby, Standby: local address to bind (NULL == any address) */
+    const char *host;
+    /** TCP port                                                                              */
+    uint16_t port;
+};
+
+/**
+ * \brief Create a replicator and start its thread
+ *
+ * The primary replicator tries to connect to the standby in the background (and reconnects
+ * automatically). The standby replicator listens for a connection of the primary.
+ * \param[in] ident Identification (for logs)
+ * \param[in] cfg   Configuration
+ * \return Pointer to the replicator or NULL (failed to start, error message is printed)
+ */
+IPX_API ipx_repl_t *
+ipx_repl_create(const char *ident, const struct ipx_repl_cfg *cfg);
+
+/**
+ * \brief Stop the thread and destroy the replicator
+ * \param[in] repl Replicator
+ */
+IPX_API void
+ipx_repl_destroy(ipx_repl_t *repl);
+
+/**
+ * \brief Get the role of the replicator
+ * \param[in] repl Replicator
+ */
+IPX_API enum ipx_repl_role
+ipx_repl_role_get(const ipx_repl_t *repl);
+
+/**
+ * \brief Check and clear a request to send the full state (primary only)
+ *
+ * The request is raised after a new connection to the standby has been established or after
+ * updates have been dropped. The caller is expected to send the full state, i.e. call
+ * ipx_repl_reset() followed by description of all sessions.
+ * \param[in] repl Replicator
+ * \return True if the full state must be sent
+ */
+IPX_API bool
+ipx_repl_resync_needed(ipx_repl_t *repl);
+
+/**
+ * \brief Start a new full state (primary only)
+ *
+ * The standby forgets all previously received state.
+ * \param[in] repl Replicator
+ */
+IPX_API void
+ipx_repl_reset(ipx_repl_t *repl);
+
+/**
+ * \brief Announce a Transport Session (primary only)
+ * \param[in] repl    Replicator
+ * \param[in] session UDP Transport Session
+ */
+IPX_API void
+ipx_repl_session(ipx_repl_t *repl, const struct ipx_session *session);
+
+/**
+ * \brief Send a definition of an (Options) Template (primary only)
+ * \param[in] repl    Replicator
+ * \param[in] session UDP Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] type    Type of the template
+ * \param[in] data    Raw template record (as defined in IPFIX)
+ * \param[in] size    Size of the record
+ */
+IPX_API void
+ipx_repl_tmplt(ipx_repl_t *repl, const struct ipx_session *session, uint32_t odid,
+    enum fds_template_type type, const uint8_t *data, uint16_t size);
+
+/**
+ * \brief Send an expected sequence number of the next IPFIX Message (primary only)
+ * \param[in] repl    Replicator
+ * \param[in] session UDP Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] seq_num Sequence number
+ */
+IPX_API void
+ipx_repl_seq(ipx_repl_t *repl, const struct ipx_session *session, uint32_t odid,
+    uint32_t seq_num);
+
+/**
+ * \brief Announce that a Transport Session has been closed (primary only)
+ * \param[in] repl    Replicator
+ * \param[in] session Transport Session
+ */
+IPX_API void
+ipx_repl_close(ipx_repl_t *repl, const struct ipx_session *session);
+
+/**
+ * \brief Fill a template manager with the replicated state (standby only)
+ *
+ * All replicated (Options) Templates of the Transport Session and ODID are added to the
+ * template manager. Export time of the manager must be already set.
+ * \param[in]  repl     Replicator
+ * \param[in]  session  UDP Transport Session
+ * \param[in]  odid     Observation Domain ID
+ * \param[in]  tmgr     Template manager to fill
+ * \param[out] seq_num  Expected sequence number (only if the function returns true)
+ * \param[out] tmplts   Number of added templates
+ * \return True if the replicated sequence number is available
+ */
+IPX_API bool
+ipx_repl_seed(ipx_repl_t *repl, const struct ipx_session *session, uint32_t odid,
+    fds_tmgr_t *tmgr, uint32_t *seq_num, unsigned int *tmplts);
+
+/**@}*/
+#endif // IPFIXCOL_REPLICATOR_H
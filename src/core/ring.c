@@ -40,12 +40,17 @@
  */
 
 #include <stdlib.h> // aligned_malloc
+#include <string.h> // memcpy
 //#include <unistd.h>
 #include <pthread.h>
+#include <sched.h> // sched_yield
 #include <time.h>
 
 #include "ring.h"
 #include "verbose.h"
+#include "message_base.h"
+#include "message_ipfix.h"
+#include "trace.h"
 
 
 // START TODO: move into header files
@@ -67,6 +72,61 @@
 /** Internal identification of the ring buffer */
 static const char *module = "Ring buffer";
 
+/** Size of a message that can be stored directly in a slot (the rest of the cache line)       */
+#define RING_INLINE_SIZE (IPX_CLINE_SIZE - 24U)
+
+/** \brief Slot of the ring buffer (one cache line) */
+struct ring_slot {
+    /** Message (in case of an inline message, points to the #body of the slot)           */
+    ipx_msg_t *msg;
+    /** Properties of the message (valid only in the inline mode)                          */
+    struct ipx_ring_info info;
+    /** Inline message (or the time of push of a traced IPFIX Message)                     */
+    union {
+        uint8_t  data[RING_INLINE_SIZE];
+        uint64_t align;
+    } body;
+} __ipx_cache_aligned;
+
+static_assert(sizeof(struct ring_slot) == IPX_CLINE_SIZE, "Ring slot must fill a cache line!");
+
+/** Max. number of CPU relax instructions between two checks of a busy polling ring  */
+#define RING_SPIN_MAX 1024U
+
+/** Hint the CPU that the thread is spinning (saves power and memory bandwidth) */
+static inline void
+ring_cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * \brief Wait before the next check of a busy polling ring (exponential backoff)
+ *
+ * After the limit of spins is reached, the thread also yields the CPU so a thread on the same
+ * CPU (e.g. the other side of the ring) is not starved.
+ * \param[in,out] spins Number of relax instructions of the previous wait (0 == first wait)
+ */
+static inline void
+ring_backoff(uint32_t *spins)
+{
+    if (*spins >= RING_SPIN_MAX) {
+        sched_yield();
+    } else {
+        *spins = (*spins == 0) ? 1 : (*spins * 2);
+    }
+
+    for (uint32_t i = 0; i < *spins; ++i) {
+        ring_cpu_relax();
+    }
+}
+
 /** \brief Data structure for a reader only */
 struct ring_reader {
     /**
@@ -91,7 +151,7 @@ struct ring_reader {
      * \note Value range [0..UINT32_MAX]. Based on #read_idx.
      */
     uint32_t read_commit_idx;
-    /** \brief Total size of the ring buffer (number of pointers)                    */
+    /** \brief Total size of the ring buffer (number of slots)                       */
     uint32_t size;
     /**
      * \brief Size of a synchronization block
@@ -128,7 +188,7 @@ struct ring_writer {
      * \note Value range [0..UINT32_MAX]. Based on #write_idx.
      */
     uint32_t write_commit_idx;
-    /** \brief Total size of the ring buffer (number of pointers)                    */
+    /** \brief Total size of the ring buffer (number of slots)                       */
     uint32_t size;
     /**
      * \brief Size of a synchronization block
@@ -172,8 +232,12 @@ struct ipx_ring {
     struct ring_sync   sync        __ipx_cache_aligned;
     /** Multiple writers mode                           */
     bool               mw_mode;
-    /** Ring data (array of pointers)                   */
-    ipx_msg_t        **data;
+    /** Busy polling mode (spin instead of sleeping)    */
+    bool               busy_mode;
+    /** Inline mode (message properties and copies)     */
+    bool               inline_mode;
+    /** Ring data (array of slots)                      */
+    struct ring_slot  *data;
 };
 
 ipx_ring_t *
@@ -188,7 +252,7 @@ ipx_ring_init(uint32_t size, bool mw_mode)
         return NULL;
     }
 
-    ring->data = aligned_alloc(alignof(*ring->data), sizeof(*ring->data) * size);
+    ring->data = aligned_alloc(alignof(struct ring_slot), sizeof(struct ring_slot) * size);
     if (!ring->data) {
         IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
         goto exit_A;
@@ -251,6 +315,8 @@ ipx_ring_init(uint32_t size, bool mw_mode)
     ring->sync.write_idx = size;
 
     ring->mw_mode = mw_mode;
+    ring->busy_mode = false;
+    ring->inline_mode = false;
     return ring;
 
     // In case failure
@@ -287,15 +353,31 @@ ipx_ring_destroy(ipx_ring_t *ring)
     free(ring);
 }
 
+/**
+ * \brief Check if a deadline has expired
+ * \param[in] deadline Deadline (CLOCK_MONOTONIC)
+ * \return True or false
+ */
+static inline bool
+ring_deadline_expired(const struct timespec *deadline)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec > deadline->tv_sec
+        || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec));
+}
+
 /**
  * \brief Wrapper around condition wait
- * \param[in] cond  Condition variable
- * \param[in] mutex Locked mutex
- * \param[in] msec  Number of milliseconds to wait
+ * \param[in] cond     Condition variable
+ * \param[in] mutex    Locked mutex
+ * \param[in] msec     Number of milliseconds to wait
+ * \param[in] deadline Do not wait after the deadline (CLOCK_MONOTONIC, can be NULL)
  * \return Same as the function pthread_cond_timedwait
  */
 static inline int
-ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mutex, long msec)
+ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mutex, long msec,
+    const struct timespec *deadline)
 {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
@@ -305,6 +387,11 @@ ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mut
         ts.tv_sec += 1;
     }
 
+    if (deadline != NULL && (deadline->tv_sec < ts.tv_sec
+            || (deadline->tv_sec == ts.tv_sec && deadline->tv_nsec < ts.tv_nsec))) {
+        ts = *deadline;
+    }
+
     return pthread_cond_timedwait(cond, mutex, &ts);
 }
 
@@ -315,13 +402,13 @@ ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mut
  *   function, the function ipx_ring_commit() MUST be called first, to commit performed
  *   modifications.
  * \param[in] ring Ring buffer
- * \return Pointer to a unused place in the buffer
+ * \return Pointer to a unused slot in the buffer
  */
-static inline ipx_msg_t **
+static inline struct ring_slot *
 ipx_ring_begin(ipx_ring_t *ring)
 {
-    // Prepare the next pointer to write
-    ipx_msg_t **msg = &ring->data[ring->writer.data_idx];
+    // Prepare the next slot to write
+    struct ring_slot *msg = &ring->data[ring->writer.data_idx];
 
     // Is there enough space?
     if (ring->writer.exchange_idx - ring->writer.write_idx > 0) {
@@ -329,12 +416,19 @@ ipx_ring_begin(ipx_ring_t *ring)
     }
 
     // Get an empty space -> reader-writer synchronization
+    uint32_t spins = 0;
     pthread_mutex_lock(&ring->sync.mutex);
     ring->writer.exchange_idx = ring->sync.write_idx;
     while (ring->writer.exchange_idx - ring->writer.write_idx == 0) {
         // After sync the buffer is still full, try again later
-        pthread_cond_signal(&ring->sync.cond_reader);
-        ring_cond_timedwait(&ring->sync.cond_writer, &ring->sync.mutex, 10);
+        if (ring->busy_mode) {
+            pthread_mutex_unlock(&ring->sync.mutex);
+            ring_backoff(&spins);
+            pthread_mutex_lock(&ring->sync.mutex);
+        } else {
+            pthread_cond_signal(&ring->sync.cond_reader);
+            ring_cond_timedwait(&ring->sync.cond_writer, &ring->sync.mutex, 10, NULL);
+        }
         ring->writer.exchange_idx = ring->sync.write_idx;
     }
     pthread_cond_signal(&ring->sync.cond_reader);
@@ -373,27 +467,79 @@ ipx_ring_commit(ipx_ring_t *ring)
     }
 }
 
-void
+/**
+ * \brief Fill a slot with a message in the inline mode
+ *
+ * Properties of the message are extracted and small messages are copied into the slot.
+ * \param[in] slot Slot to fill
+ * \param[in] msg  Message
+ * \return True if the message has been copied, false otherwise
+ */
+static inline bool
+ring_slot_fill(struct ring_slot *slot, ipx_msg_t *msg)
+{
+    slot->info.type = ipx_msg_get_type(msg);
+    slot->info.odid = 0;
+    slot->info.trace_id = 0;
+
+    if (slot->info.type == IPX_MSG_IPFIX) {
+        ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+        slot->info.odid = ipx_msg_ipfix_get_ctx(msg_ipfix)->odid;
+        slot->info.trace_id = ipx_msg_ipfix_trace_id(msg_ipfix);
+        if (slot->info.trace_id != 0) {
+            // IPFIX Messages are never copied, so the body of the slot holds the time of push
+            slot->body.align = ipx_trace_now();
+        }
+    }
+
+    const size_t size = ipx_msg_inline_size(msg);
+    if (size == 0 || size > RING_INLINE_SIZE) {
+        slot->msg = msg;
+        return false;
+    }
+
+    // Only the reader of this ring buffer will use the copy
+    struct ipx_msg *copy = (struct ipx_msg *) slot->body.data;
+    memcpy(copy, msg, size);
+    copy->flags |= IPX_MSG_F_INLINE;
+    ipx_msg_header_cnt_set(copy, 1);
+    slot->msg = copy;
+    return true;
+}
+
+bool
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
 {
-    ipx_msg_t **msg_space;
+    struct ring_slot *slot;
+    bool copied = false;
 
     if (ring->mw_mode) {
         pthread_spin_lock(&ring->writer_lock);
     }
 
-    msg_space = ipx_ring_begin(ring);
-    *msg_space = msg;
+    slot = ipx_ring_begin(ring);
+    if (ring->inline_mode) {
+        copied = ring_slot_fill(slot, msg);
+    } else {
+        slot->msg = msg;
+    }
     ipx_ring_commit(ring);
 
     if (ring->mw_mode) {
         pthread_spin_unlock(&ring->writer_lock);
     }
-}
 
+    return copied;
+}
 
-ipx_msg_t *
-ipx_ring_pop(ipx_ring_t *ring)
+/**
+ * \brief Get a message from the ring buffer
+ * \param[in] ring     Ring buffer
+ * \param[in] deadline Give up waiting after the deadline (CLOCK_MONOTONIC, NULL == never)
+ * \return Pointer to the message or NULL (the deadline has expired)
+ */
+static inline ipx_msg_t *
+ring_pop(ipx_ring_t *ring, const struct timespec *deadline)
 {
     // Consider previous memory block as processed
     ring->reader.data_idx += ring->reader.last;
@@ -405,14 +551,17 @@ ipx_ring_pop(ipx_ring_t *ring)
         ring->reader.data_idx = 0;
     }
 
-    // Prepare the next pointer to read
-    ipx_msg_t **msg = &ring->data[ring->reader.data_idx];
+    // Prepare the next slot to read
+    struct ring_slot *msg = &ring->data[ring->reader.data_idx];
 
     // Sync positions with writers, if necessary
     if (ring->reader.read_idx - ring->reader.read_commit_idx >= ring->reader.div_block) {
         pthread_mutex_lock(&ring->sync.mutex);
         ring->sync.write_idx += ring->reader.read_idx - ring->reader.read_commit_idx;
-        ring->reader.exchange_idx = ring->sync.read_idx;
+        if (!ring->busy_mode) {
+            // Busy polling reader takes the index directly from writers (it can be newer)
+            ring->reader.exchange_idx = ring->sync.read_idx;
+        }
         ring->reader.read_commit_idx = ring->reader.read_idx;
         pthread_cond_signal(&ring->sync.cond_writer);
         pthread_mutex_unlock(&ring->sync.mutex);
@@ -422,7 +571,25 @@ ipx_ring_pop(ipx_ring_t *ring)
         // Ok, the reader owns this part of the buffer
         // TODO: prefetch
         ring->reader.last = 1;
-        return *msg; // Now, we can dereference the pointer
+        return msg->msg; // Now, we can dereference the pointer
+    }
+
+    if (ring->busy_mode) {
+        // Spin until a writer commits a new message (no sync with writers is required)
+        uint32_t spins = 0;
+        while (1) {
+            ring->reader.exchange_idx = __atomic_load_n(&ring->writer.write_idx, __ATOMIC_ACQUIRE);
+            if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
+                ring->reader.last = 1;
+                return msg->msg; // Now, we can dereference the pointer
+            }
+
+            if (deadline != NULL && ring_deadline_expired(deadline)) {
+                return NULL;
+            }
+
+            ring_backoff(&spins);
+        }
     }
 
     while (1) {
@@ -430,14 +597,14 @@ ipx_ring_pop(ipx_ring_t *ring)
         pthread_mutex_lock(&ring->sync.mutex);
         pthread_cond_signal(&ring->sync.cond_writer);
         // Wait until a writer sends a signal or a timeout expires
-        ring_cond_timedwait(&ring->sync.cond_reader, &ring->sync.mutex, 10);
+        ring_cond_timedwait(&ring->sync.cond_reader, &ring->sync.mutex, 10, deadline);
         ring->reader.exchange_idx = ring->sync.read_idx;
         pthread_mutex_unlock(&ring->sync.mutex);
 
         if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
             // TODO: prefetch
             ring->reader.last = 1;
-            return *msg; // Now, we can dereference the pointer
+            return msg->msg; // Now, we can dereference the pointer
         }
 
         // Writer still didn't perform sync -> try to steal all committed messages from writer
@@ -448,13 +615,62 @@ ipx_ring_pop(ipx_ring_t *ring)
         if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
             // TODO: prefetch
             ring->reader.last = 1;
-            return *msg; // Now, we can dereference the pointer
+            return msg->msg; // Now, we can dereference the pointer
+        }
+
+        if (deadline != NULL && ring_deadline_expired(deadline)) {
+            return NULL;
         }
     }
 }
 
+ipx_msg_t *
+ipx_ring_pop(ipx_ring_t *ring)
+{
+    return ring_pop(ring, NULL);
+}
+
+ipx_msg_t *
+ipx_ring_pop_timed(ipx_ring_t *ring, const struct timespec *deadline)
+{
+    return ring_pop(ring, deadline);
+}
+
 void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode)
 {
     ring->mw_mode = mode;
-}
\ No newline at end of file
+}
+
+void
+ipx_ring_busy_mode(ipx_ring_t *ring, bool mode)
+{
+    ring->busy_mode = mode;
+}
+
+void
+ipx_ring_inline_mode(ipx_ring_t *ring, bool mode)
+{
+    ring->inline_mode = mode;
+}
+
+const struct ipx_ring_info *
+ipx_ring_info(const ipx_ring_t *ring)
+{
+    if (!ring->inline_mode || ring->reader.last == 0) {
+        return NULL;
+    }
+
+    return &ring->data[ring->reader.data_idx].info;
+}
+
+uint64_t
+ipx_ring_trace_pushed(const ipx_ring_t *ring)
+{
+    const struct ipx_ring_info *info = ipx_ring_info(ring);
+    if (!info || info->trace_id == 0) {
+        return 0;
+    }
+
+    return ring->data[ring->reader.data_idx].body.align;
+}
@@ -49,6 +49,7 @@ extern "C" {
 #include <ipfixcol2.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
 
 /**
  * \defgroup ipx_ring Message ring buffer
@@ -65,6 +66,22 @@ extern "C" {
 /** Internal ring buffer type  */
 typedef struct ipx_ring ipx_ring_t;
 
+/**
+ * \brief Frequently used properties of a message stored next to the message in the ring buffer
+ *
+ * Consumers can dispatch and filter messages without touching the message itself, which was
+ * usually written by another CPU core. Available only in the inline mode of the ring buffer.
+ * \see ipx_ring_inline_mode()
+ */
+struct ipx_ring_info {
+    /** Type of the message                                                                      */
+    enum ipx_msg_type type;
+    /** Observation Domain ID (IPFIX Messages only, otherwise 0)                                 */
+    uint32_t odid;
+    /** Trace ID (traced IPFIX Messages only, otherwise 0, see ipx_ring_trace_pushed())          */
+    uint32_t trace_id;
+};
+
 /**
  * \brief Create a new ring buffer
  *
@@ -72,7 +89,7 @@ typedef struct ipx_ring ipx_ring_t;
  *   time, result is undefined!
  * \note Enabling \p mw_mode has significant impact on performance in case the protection is not
  *   necessary.
- * \param[in] size    Size of the ring buffer (number of pointers)
+ * \param[in] size    Size of the ring buffer (number of messages)
  * \param[in] mw_mode Multi-writer mode (multiple writers can writer into the buffer)
  * \return A pointer to the buffer or NULL (in case of an error).
  */
@@ -93,10 +110,14 @@ ipx_ring_destroy(ipx_ring_t *ring);
  * mode has been enabled during the ring initialization. Otherwise, result of concurrent adding
  * is not defined.
  * \note The function blocks until the message is added.
+ * \note In the inline mode, small messages are copied into the ring buffer and the caller still
+ *   owns the original message, i.e. it must destroy it (or just decrement its reference counter).
  * \param[in] ring Ring buffer
  * \param[in] msg  Message to be added into the ring buffer
+ * \return True if the message has been copied (inline mode only), false if the ring buffer has
+ *   taken over the message.
  */
-IPX_API void
+IPX_API bool
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 
 /**
@@ -104,12 +125,29 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
  *
  * \note The function blocks until the message is ready.
  * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \warning In the inline mode, a message stored inline is valid only until the next call of
+ *   this function (or its variants). Before that, it must be destroyed or passed to another
+ *   ring buffer.
  * \param[in] ring Ring buffer
  * \return Pointer to the message
  */
 IPX_API ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring);
 
+/**
+ * \brief Get a message from the ring buffer or give up after a deadline
+ *
+ * The function behaves as ipx_ring_pop(), however, if no message is available until the
+ * deadline, the function returns NULL. If a message is available, it is always returned
+ * (even if the deadline has already expired).
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in] ring     Ring buffer
+ * \param[in] deadline Deadline (absolute time of CLOCK_MONOTONIC)
+ * \return Pointer to the message or NULL (the deadline has expired)
+ */
+IPX_API ipx_msg_t *
+ipx_ring_pop_timed(ipx_ring_t *ring, const struct timespec *deadline);
+
 /**
  * \brief Change (i.e. disable/enable) multi-writer mode
  *
@@ -122,6 +160,64 @@ ipx_ring_pop(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode);
 
+/**
+ * \brief Change (i.e. disable/enable) busy polling mode (disabled by default)
+ *
+ * In the busy polling mode, the reader and writers never sleep on condition variables. Instead,
+ * they spin (with an exponential backoff) until a message or free space is available. This
+ * minimizes latency of passing messages at the cost of fully utilized CPUs.
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is using the buffer.
+ * \param[in] ring Ring buffer
+ * \param[in] mode New mode
+ */
+IPX_API void
+ipx_ring_busy_mode(ipx_ring_t *ring, bool mode);
+
+/**
+ * \brief Change (i.e. disable/enable) inline mode (disabled by default)
+ *
+ * In the inline mode, each slot of the ring buffer, which occupies a whole CPU cache line,
+ * holds the type and a few frequently used properties of the message (see ipx_ring_info())
+ * next to the pointer to the message. Moreover, small control messages (i.e. Transport Session
+ * and Termination messages) are copied directly into the slot. Therefore, the reader doesn't
+ * have to touch memory written by another CPU core to dispatch and filter messages.
+ *
+ * Copies of messages are flagged, so their destruction doesn't free any memory. However, their
+ * lifetime is limited (see ipx_ring_pop()).
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is using the buffer. All
+ *   ring buffers of the pipeline should use the same mode.
+ * \param[in] ring Ring buffer
+ * \param[in] mode New mode
+ */
+IPX_API void
+ipx_ring_inline_mode(ipx_ring_t *ring, bool mode);
+
+/**
+ * \brief Get properties of the last message returned by the reader
+ *
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in] ring Ring buffer
+ * \return Pointer to the properties (valid until the next read operation) or NULL, if the
+ *   inline mode is disabled or no message has been read yet.
+ */
+IPX_API const struct ipx_ring_info *
+ipx_ring_info(const ipx_ring_t *ring);
+
+/**
+ * \brief Get the time when the last traced message returned by the reader was pushed
+ *
+ * In the inline mode, the time is recorded for each traced IPFIX Message (see \ref ipxTrace),
+ * so the time spent by the message in the ring buffer can be measured.
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in] ring Ring buffer
+ * \return Timestamp (see ipx_trace_now()) or 0, if the last message is not traced or
+ *   the inline mode is disabled.
+ */
+IPX_API uint64_t
+ipx_ring_trace_pushed(const ipx_ring_t *ring);
+
 /**
  * @}
  */
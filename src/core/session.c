@@ -141,6 +141,30 @@ ipx_session_new_udp(const struct ipx_session_net *net, uint16_t lf_data, uint16_
     return res;
 }
 
+struct ipx_session *
+ipx_session_new_udp_named(const struct ipx_session_net *net, const char *ident, uint16_t lf_data,
+    uint16_t lf_opts)
+{
+    if (strlen(ident) == 0) {
+        return NULL;
+    }
+
+    char *ident_cpy = strdup(ident);
+    if (!ident_cpy) {
+        return NULL;
+    }
+
+    struct ipx_session *res = ipx_session_new_udp(net, lf_data, lf_opts);
+    if (!res) {
+        free(ident_cpy);
+        return NULL;
+    }
+
+    free(res->ident);
+    res->ident = ident_cpy;
+    return res;
+}
+
 struct ipx_session *
 ipx_session_new_sctp(const struct ipx_session_net *net)
 {
@@ -0,0 +1,607 @@
+/**
+ * \file src/core/tap.c
+ * \author agent <agent@local>
+ * \brief Live tap of Data Records (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+// Get GNU specific pipe2() and accept4() functions
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <libfds.h>
+#include "context.h"
+#include "tap.h"
+#include "verbose.h"
+
+/** Identification of this component (for log) */
+static const char *comp_str = "Tap";
+
+/** Maximum size of a request of a client                                  */
+#define TAP_REQ_SIZE 4096U
+/** Timeout of receiving a request of a client (seconds)                    */
+#define TAP_REQ_TIMEOUT 2
+/** Check if the client is still connected after N messages without a sent record */
+#define TAP_CHECK_INTERVAL 256U
+/** Flags of conversion of Data Records to JSON                              */
+#define TAP_JSON_FLAGS \
+    (FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_FORMAT_TCPFLAGS | FDS_CD2J_FORMAT_PROTO \
+    | FDS_CD2J_TS_FORMAT_MSEC)
+
+/** Attached client */
+struct ipx_tap_client {
+    /** Socket of the client (non-blocking)                                 */
+    int fd;
+    /** Manager of Information Elements (for conversion to JSON)            */
+    const fds_iemgr_t *iemgr;
+    /** Filter of Data Records (NULL == all records)                         */
+    fds_ipfix_filter_t *filter;
+    /** Send one of N matching Data Records                                 */
+    uint32_t sampling;
+    /** Number of matching records to skip before the next sent record      */
+    uint32_t skip;
+    /** Number of messages since the last check of the connection           */
+    uint32_t check;
+    /** Number of sent records                                              */
+    uint64_t sent;
+    /** Number of dropped records not reported to the client yet            */
+    uint64_t dropped;
+    /** Buffer for conversion of records to JSON                            */
+    char *buffer;
+    /** Size of the buffer                                                  */
+    size_t buffer_size;
+};
+
+/** Tap server */
+struct ipx_tap {
+    /** Path of the socket                                                  */
+    char *path;
+    /** Listening socket                                                    */
+    int fd;
+    /** Pipe to wake up the thread on termination (read end, write end)     */
+    int pipe[2];
+    /** Thread of the server                                                */
+    pthread_t thread;
+    /** The thread is running                                               */
+    bool running;
+    /** Contexts of tap points                                              */
+    ipx_ctx_t **points;
+    /** Number of tap points                                                */
+    size_t points_cnt;
+};
+
+ipx_tap_t *
+ipx_tap_create(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        IPX_ERROR(comp_str, "Path of the socket '%s' is too long!", path);
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+
+    struct ipx_tap *tap = calloc(1, sizeof(*tap));
+    if (!tap) {
+        IPX_ERROR(comp_str, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    tap->fd = -1;
+    tap->pipe[0] = tap->pipe[1] = -1;
+    tap->path = strdup(path);
+    if (!tap->path) {
+        IPX_ERROR(comp_str, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_tap_destroy(tap);
+        return NULL;
+    }
+
+    const char *err_str;
+    if (pipe2(tap->pipe, O_CLOEXEC) != 0) {
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(comp_str, "Failed to create a pipe: %s", err_str);
+        ipx_tap_destroy(tap);
+        return NULL;
+    }
+
+    tap->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (tap->fd == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(comp_str, "Failed to create a socket: %s", err_str);
+        ipx_tap_destroy(tap);
+        return NULL;
+    }
+
+    // Replace a socket left by a previous run (only a socket, never a regular file)
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    // Only the owner of the process is allowed to connect
+    const mode_t mask_old = umask(S_IRWXG | S_IRWXO);
+    const int rc = bind(tap->fd, (const struct sockaddr *) &addr, sizeof(addr));
+    umask(mask_old);
+    if (rc != 0 || listen(tap->fd, 4) != 0) {
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(comp_str, "Failed to listen on the socket '%s': %s", path, err_str);
+        ipx_tap_destroy(tap);
+        return NULL;
+    }
+
+    return tap;
+}
+
+int
+ipx_tap_point_add(ipx_tap_t *tap, ipx_ctx_t *ctx)
+{
+    const size_t new_cnt = tap->points_cnt + 1;
+    ipx_ctx_t **new_points = realloc(tap->points, new_cnt * sizeof(*new_points));
+    if (!new_points) {
+        return IPX_ERR_NOMEM;
+    }
+
+    new_points[tap->points_cnt] = ctx;
+    tap->points = new_points;
+    tap->points_cnt = new_cnt;
+    return IPX_OK;
+}
+
+/**
+ * \brief Send a packet to a client
+ * \param[in] fd    Socket of the client
+ * \param[in] str   Content of the packet (string)
+ * \param[in] flags Flags of send()
+ * \return Return value of send()
+ */
+static inline ssize_t
+tap_send(int fd, const char *str, int flags)
+{
+    return send(fd, str, strlen(str), flags | MSG_NOSIGNAL);
+}
+
+/**
+ * \brief Send an error reply to a client
+ * \param[in] fd     Socket of the client
+ * \param[in] reason Description of the error
+ */
+static void
+tap_send_err(int fd, const char *reason)
+{
+    char reply[TAP_REQ_SIZE];
+    snprintf(reply, sizeof(reply), "ERR %s", reason);
+    tap_send(fd, reply, 0);
+}
+
+/**
+ * \brief Find a tap point by name
+ * \param[in] tap  Tap server
+ * \param[in] name Name of the instance
+ * \return Context of the instance or NULL
+ */
+static ipx_ctx_t *
+tap_point_find(const struct ipx_tap *tap, const char *name)
+{
+    for (size_t i = 0; i < tap->points_cnt; ++i) {
+        if (strcmp(ipx_ctx_name_get(tap->points[i]), name) == 0) {
+            return tap->points[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Process a request to attach a client to a tap point
+ *
+ * On success, the client (including its socket) is handed over to the instance.
+ * \param[in] tap  Tap server
+ * \param[in] fd   Socket of the client
+ * \param[in] args Arguments of the request (point, sampling and filter separated by newlines)
+ * \return True if the client has been attached, false otherwise (the socket must be closed)
+ */
+static bool
+tap_attach(struct ipx_tap *tap, int fd, char *args)
+{
+    char *point = args;
+    char *sampling_str = strchr(point, '\n');
+    char *expr = (sampling_str != NULL) ? strchr(sampling_str + 1, '\n') : NULL;
+    if (!expr) {
+        tap_send_err(fd, "Malformed request");
+        return false;
+    }
+    *(sampling_str++) = '\0';
+    *(expr++) = '\0';
+
+    char *end;
+    errno = 0;
+    const unsigned long sampling = strtoul(sampling_str, &end, 10);
+    if (errno != 0 || *end != '\0' || sampling == 0 || sampling > UINT32_MAX) {
+        tap_send_err(fd, "Invalid sampling rate");
+        return false;
+    }
+
+    ipx_ctx_t *ctx = tap_point_find(tap, point);
+    if (!ctx) {
+        tap_send_err(fd, "Unknown tap point");
+        return false;
+    }
+
+    if (ipx_ctx_tap_attached(ctx)) {
+        tap_send_err(fd, "Another client is already attached to the tap point");
+        return false;
+    }
+
+    struct ipx_tap_client *client = calloc(1, sizeof(*client));
+    if (!client) {
+        IPX_ERROR(comp_str, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        tap_send_err(fd, "Memory allocation failed");
+        return false;
+    }
+
+    client->fd = -1;
+    client->iemgr = ipx_ctx_iemgr_get(ctx);
+    client->sampling = client->skip = (uint32_t) sampling;
+    if (*expr != '\0') {
+        // The filter is evaluated only by the thread of the instance
+        if (fds_ipfix_filter_create(&client->filter, client->iemgr, expr) != FDS_OK) {
+            char reason[TAP_REQ_SIZE];
+            snprintf(reason, sizeof(reason), "Invalid filter: %s",
+                fds_ipfix_filter_get_error(client->filter));
+            tap_send_err(fd, reason);
+            ipx_tap_client_destroy(client);
+            return false;
+        }
+    }
+
+    if (tap_send(fd, "OK", 0) == -1) {
+        ipx_tap_client_destroy(client);
+        return false;
+    }
+
+    // From now on, records are dropped instead of blocking the instance
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    client->fd = fd;
+    if (ipx_ctx_tap_attach(ctx, client) != IPX_OK) {
+        ipx_tap_client_destroy(client); // Closes the socket
+        return true;
+    }
+
+    IPX_CTX_INFO(ctx, "Tap client attached (sampling: 1 of %lu, filter: '%s').", sampling,
+        (*expr != '\0') ? expr : "none");
+    return true;
+}
+
+/**
+ * \brief Process a request of a new client
+ * \param[in] tap Tap server
+ * \param[in] fd  Socket of the client
+ */
+static void
+tap_client_accept(struct ipx_tap *tap, int fd)
+{
+    // Requests are expected immediately after connection, do not let the client block others
+    struct timeval timeout = {.tv_sec = TAP_REQ_TIMEOUT, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char req[TAP_REQ_SIZE];
+    const ssize_t len = recv(fd, req, sizeof(req) - 1, 0);
+    if (len <= 0) {
+        close(fd);
+        return;
+    }
+    req[len] = '\0';
+
+    if (strcmp(req, "LIST") == 0) {
+        tap_send(fd, "OK", 0);
+        for (size_t i = 0; i < tap->points_cnt; ++i) {
+            tap_send(fd, ipx_ctx_name_get(tap->points[i]), 0);
+        }
+        close(fd);
+        return;
+    }
+
+    static const char attach_cmd[] = "ATTACH\n";
+    const size_t attach_len = strlen(attach_cmd);
+    if (strncmp(req, attach_cmd, attach_len) != 0) {
+        tap_send_err(fd, "Unknown request");
+        close(fd);
+        return;
+    }
+
+    if (!tap_attach(tap, fd, req + attach_len)) {
+        close(fd);
+    }
+}
+
+/**
+ * \brief Thread of the tap server
+ * \param[in] arg Tap server
+ * \return NULL
+ */
+static void *
+tap_thread(void *arg)
+{
+    struct ipx_tap *tap = arg;
+    struct pollfd fds[2] = {
+        {.fd = tap->fd, .events = POLLIN, .revents = 0},
+        {.fd = tap->pipe[0], .events = POLLIN, .revents = 0}
+    };
+
+    while (true) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_ERROR(comp_str, "poll() failed: %s", err_str);
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            // Termination request
+            break;
+        }
+
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        const int fd = accept4(tap->fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd == -1) {
+            continue;
+        }
+
+        tap_client_accept(tap, fd);
+    }
+
+    return NULL;
+}
+
+int
+ipx_tap_start(ipx_tap_t *tap)
+{
+    // Signals are handled only by the main thread
+    sigset_t set_new, set_old;
+    sigfillset(&set_new);
+    pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
+    int rc = pthread_create(&tap->thread, NULL, &tap_thread, tap);
+    pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_ERROR(comp_str, "Failed to start a thread of the tap server: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    tap->running = true;
+    IPX_INFO(comp_str, "Listening for tap clients on '%s' (%zu tap point(s)).", tap->path,
+        tap->points_cnt);
+    return IPX_OK;
+}
+
+void
+ipx_tap_destroy(ipx_tap_t *tap)
+{
+    if (tap->running) {
+        const char cmd = 'x';
+        if (write(tap->pipe[1], &cmd, 1) != 1) {
+            IPX_ERROR(comp_str, "Failed to send a termination request to the thread!", '\0');
+        }
+        pthread_join(tap->thread, NULL);
+    }
+
+    if (tap->fd != -1) {
+        close(tap->fd);
+        unlink(tap->path);
+    }
+    if (tap->pipe[0] != -1) {
+        close(tap->pipe[0]);
+        close(tap->pipe[1]);
+    }
+
+    free(tap->points);
+    free(tap->path);
+    free(tap);
+}
+
+/**
+ * \brief Check if a client has disconnected
+ * \param[in] client Client
+ * \return True or false
+ */
+static bool
+tap_client_closed(const struct ipx_tap_client *client)
+{
+    char byte;
+    const ssize_t rc = recv(client->fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return rc == 0 || (rc == -1 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+/**
+ * \brief Send a packet to a client without blocking
+ * \param[in] client Client
+ * \param[in] data   Content of the packet
+ * \param[in] size   Size of the packet
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_BUFFER if the packet has been dropped (the client is too slow)
+ * \return #IPX_ERR_EOF if the client has disconnected
+ */
+static int
+tap_client_send(struct ipx_tap_client *client, const char *data, size_t size)
+{
+    if (send(client->fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL) != -1) {
+        return IPX_OK;
+    }
+
+    switch (errno) {
+    case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+    case EWOULDBLOCK:
+#endif
+    case ENOBUFS:
+    case EMSGSIZE:
+    case EINTR:
+        return IPX_ERR_BUFFER;
+    default:
+        return IPX_ERR_EOF;
+    }
+}
+
+/**
+ * \brief Convert a Data Record to JSON and send it to a client
+ * \param[in] client Client
+ * \param[in] rec    Data Record
+ * \return #IPX_OK on success (including a dropped record)
+ * \return #IPX_ERR_EOF if the client has disconnected
+ */
+static int
+tap_client_record(struct ipx_tap_client *client, struct fds_drec *rec)
+{
+    int rc;
+    if (client->dropped != 0) {
+        // Notify the client first, so it knows that the stream is not complete
+        char note[64];
+        snprintf(note, sizeof(note), "#dropped %" PRIu64, client->dropped);
+        rc = tap_client_send(client, note, strlen(note));
+        if (rc == IPX_ERR_EOF) {
+            return rc;
+        }
+        if (rc != IPX_OK) {
+            client->dropped++;
+            return IPX_OK;
+        }
+        client->dropped = 0;
+    }
+
+    const int size = fds_drec2json(rec, TAP_JSON_FLAGS, client->iemgr, &client->buffer,
+        &client->buffer_size);
+    if (size < 0) {
+        // Memory allocation error or a malformed record
+        client->dropped++;
+        return IPX_OK;
+    }
+
+    rc = tap_client_send(client, client->buffer, (size_t) size);
+    if (rc == IPX_ERR_EOF) {
+        return rc;
+    }
+
+    if (rc == IPX_OK) {
+        client->sent++;
+    } else {
+        client->dropped++;
+    }
+    return IPX_OK;
+}
+
+int
+ipx_tap_client_process(ipx_tap_client_t *client, ipx_msg_ipfix_t *msg)
+{
+    const uint64_t sent_before = client->sent + client->dropped;
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+        if (rec->rec.tmplt == NULL) {
+            continue;
+        }
+
+        if (client->filter != NULL && !fds_ipfix_filter_eval(client->filter, &rec->rec)) {
+            continue;
+        }
+
+        if (--client->skip != 0) {
+            continue;
+        }
+
+        client->skip = client->sampling;
+        if (tap_client_record(client, &rec->rec) != IPX_OK) {
+            return IPX_ERR_EOF;
+        }
+    }
+
+    if (client->sent + client->dropped != sent_before) {
+        client->check = 0;
+        return IPX_OK;
+    }
+
+    // Nothing has been sent, the client could have disconnected without being noticed
+    if (++client->check >= TAP_CHECK_INTERVAL) {
+        client->check = 0;
+        if (tap_client_closed(client)) {
+            return IPX_ERR_EOF;
+        }
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_tap_client_destroy(ipx_tap_client_t *client)
+{
+    if (client->fd != -1) {
+        close(client->fd);
+    }
+    if (client->filter != NULL) {
+        fds_ipfix_filter_destroy(client->filter);
+    }
+    free(client->buffer);
+    free(client);
+}
+
+uint64_t
+ipx_tap_client_sent(const ipx_tap_client_t *client)
+{
+    return client->sent;
+}
@@ -0,0 +1,151 @@
+/**
+ * \file src/core/tap.h
+ * \author agent <agent@local>
+ * \brief Live tap of Data Records (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_TAP_H
+#define IPFIXCOL_TAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/**
+ * \defgroup ipxTap Live tap of Data Records
+ * \brief On-demand inspection of Data Records passed by intermediate instances
+ *
+ * A tap server listens on a local Unix socket (SOCK_SEQPACKET). A client (e.g. the ipfixtap
+ * tool) attaches to a tap point, i.e. to an instance of the IPFIX parser or of an intermediate
+ * plugin, and receives a sample of Data Records passed by the instance to its successor.
+ * Records are filtered and converted to JSON by the thread of the instance, but only while
+ * a client is attached. Otherwise, the instance only checks that no client is attached.
+ *
+ * Records are sent without blocking. If the client is not fast enough, records are dropped
+ * and the client is notified about the number of dropped records.
+ *
+ * Protocol (each line is a separate packet):
+ * - the client sends a request: "ATTACH\n<point>\n<sampling>\n<filter>" or "LIST"
+ * - the server replies "OK" or "ERR <reason>"
+ * - "LIST": the server sends names of tap points and closes the connection
+ * - "ATTACH": the server sends Data Records in JSON and notifications "#dropped <N>" until
+ *   the client disconnects or the instance is terminated
+ * @{
+ */
+
+/** Internal data type of the tap server                                   */
+typedef struct ipx_tap ipx_tap_t;
+/** Internal data type of an attached client                               */
+typedef struct ipx_tap_client ipx_tap_client_t;
+
+/**
+ * \brief Create a tap server listening on a Unix socket
+ *
+ * An existing socket file with the same path is replaced. The socket is accessible only by
+ * the owner of the process.
+ * \param[in] path Path of the socket
+ * \return Pointer or NULL (failed to create the socket or a memory allocation error)
+ */
+IPX_API ipx_tap_t *
+ipx_tap_create(const char *path);
+
+/**
+ * \brief Add a tap point
+ *
+ * The point is identified by the name of the instance.
+ * \note Points must be added before the server is started.
+ * \param[in] tap Tap server
+ * \param[in] ctx Context of an instance of the IPFIX parser or an intermediate plugin
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_tap_point_add(ipx_tap_t *tap, ipx_ctx_t *ctx);
+
+/**
+ * \brief Start a thread of the server that accepts clients
+ * \param[in] tap Tap server
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the thread failed to start
+ */
+IPX_API int
+ipx_tap_start(ipx_tap_t *tap);
+
+/**
+ * \brief Stop the server and remove the socket
+ *
+ * Already attached clients are not affected, they are detached by the instances.
+ * \warning Contexts of tap points must exist until the server is destroyed.
+ * \param[in] tap Tap server
+ */
+IPX_API void
+ipx_tap_destroy(ipx_tap_t *tap);
+
+/**
+ * \brief Pass Data Records of an IPFIX Message to an attached client
+ *
+ * Records that match the filter of the client are sampled, converted to JSON and sent
+ * without blocking.
+ * \note Must be called only by the thread of the instance the client is attached to.
+ * \param[in] client Attached client
+ * \param[in] msg    IPFIX Message
+ * \return #IPX_OK on success (including dropped records)
+ * \return #IPX_ERR_EOF if the client has disconnected (i.e. it should be detached)
+ */
+IPX_API int
+ipx_tap_client_process(ipx_tap_client_t *client, ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Disconnect and destroy a client
+ * \param[in] client Client
+ */
+IPX_API void
+ipx_tap_client_destroy(ipx_tap_client_t *client);
+
+/**
+ * \brief Get the number of Data Records sent to a client
+ * \param[in] client Client
+ * \return Number of records
+ */
+IPX_API uint64_t
+ipx_tap_client_sent(const ipx_tap_client_t *client);
+
+/**@}*/
+
+#endif // IPFIXCOL_TAP_H
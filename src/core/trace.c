@@ -0,0 +1,412 @@
+/**
+ * \file src/core/trace.c
+ * \author agent <agent@local>
+ * \brief Tracing of the lifecycle of messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+#include "verbose.h"
+
+/** Identification of this component (for log) */
+static const char *comp_str = "Tracing";
+
+/** Recorded span of a message */
+struct trace_span {
+    /** Start of the span (nanoseconds)                                    */
+    uint64_t start;
+    /** Duration of the span (nanoseconds)                                 */
+    uint64_t dur;
+    /** Name of the span (string literal)                                  */
+    const char *name;
+    /** Trace ID of the message                                            */
+    uint32_t id;
+    /** Identification of the thread (filled only during export)           */
+    uint32_t tid;
+};
+
+/** Trace buffer of a thread (ring of spans) */
+struct trace_buf {
+    /** Next buffer in the list of all buffers                              */
+    struct trace_buf *next;
+    /** Name of the thread                                                  */
+    char *name;
+    /** Identification of the thread in the trace                           */
+    uint32_t tid;
+    /** Number of messages to skip before the next traced message           */
+    uint32_t skip;
+    /** Number of spans in the ring (power of two)                          */
+    uint64_t size;
+    /** Total number of recorded spans (written only by the owner, atomic)  */
+    uint64_t head;
+    /** Ring of spans                                                       */
+    struct trace_span spans[];
+};
+
+/** Global state of tracing */
+static struct {
+    /** Tracing is enabled                                                  */
+    bool enabled;
+    /** Trace one of N messages                                             */
+    uint32_t sampling;
+    /** Number of spans per buffer                                          */
+    uint64_t buf_size;
+    /** Last assigned trace ID (atomic)                                     */
+    uint32_t last_id;
+    /** Mutex protecting the list of buffers                                */
+    pthread_mutex_t lock;
+    /** List of all buffers                                                 */
+    struct trace_buf *bufs;
+    /** Number of buffers in the list                                       */
+    uint32_t bufs_cnt;
+} trace = {false, 1, 0, 0, PTHREAD_MUTEX_INITIALIZER, NULL, 0};
+
+/** Trace buffer of the current thread (NULL == not traced)                */
+static __thread struct trace_buf *trace_local = NULL;
+
+int
+ipx_trace_enable(uint32_t sampling, size_t buf_size)
+{
+    if (sampling == 0 || buf_size == 0) {
+        return IPX_ERR_ARG;
+    }
+
+    uint64_t size = 1;
+    while (size < buf_size) {
+        size <<= 1;
+    }
+
+    trace.sampling = sampling;
+    trace.buf_size = size;
+    trace.enabled = true;
+    return IPX_OK;
+}
+
+bool
+ipx_trace_enabled()
+{
+    return trace.enabled;
+}
+
+int
+ipx_trace_thread_init(const char *name)
+{
+    if (!trace.enabled || trace_local != NULL) {
+        return IPX_OK;
+    }
+
+    struct trace_buf *buf = malloc(sizeof(*buf) + trace.buf_size * sizeof(struct trace_span));
+    if (!buf) {
+        return IPX_ERR_NOMEM;
+    }
+
+    buf->name = strdup(name);
+    if (!buf->name) {
+        free(buf);
+        return IPX_ERR_NOMEM;
+    }
+
+    buf->size = trace.buf_size;
+    buf->head = 0;
+    buf->skip = trace.sampling;
+
+    pthread_mutex_lock(&trace.lock);
+    buf->tid = ++trace.bufs_cnt;
+    buf->next = trace.bufs;
+    trace.bufs = buf;
+    pthread_mutex_unlock(&trace.lock);
+
+    trace_local = buf;
+    return IPX_OK;
+}
+
+uint32_t
+ipx_trace_sample()
+{
+    struct trace_buf *buf = trace_local;
+    if (!buf || --buf->skip != 0) {
+        return 0;
+    }
+
+    buf->skip = trace.sampling;
+    uint32_t id;
+    do {
+        id = __atomic_add_fetch(&trace.last_id, 1, __ATOMIC_RELAXED);
+    } while (id == 0); // Zero is reserved for messages without tracing
+    return id;
+}
+
+void
+ipx_trace_span(uint32_t id, const char *name, uint64_t start, uint64_t end)
+{
+    struct trace_buf *buf = trace_local;
+    if (!buf) {
+        return;
+    }
+
+    // Only the owner writes the buffer, the index is published after the span is complete
+    const uint64_t idx = buf->head;
+    struct trace_span *span = &buf->spans[idx & (buf->size - 1)];
+    span->start = start;
+    span->dur = (end > start) ? (end - start) : 0;
+    span->name = name;
+    span->id = id;
+    __atomic_store_n(&buf->head, idx + 1, __ATOMIC_RELEASE);
+}
+
+void
+ipx_trace_cleanup()
+{
+    pthread_mutex_lock(&trace.lock);
+    struct trace_buf *buf = trace.bufs;
+    while (buf != NULL) {
+        struct trace_buf *next = buf->next;
+        free(buf->name);
+        free(buf);
+        buf = next;
+    }
+
+    trace.bufs = NULL;
+    trace.bufs_cnt = 0;
+    trace.enabled = false;
+    pthread_mutex_unlock(&trace.lock);
+    trace_local = NULL;
+}
+
+/**
+ * \brief Copy valid spans of a buffer
+ *
+ * The owner of the buffer can overwrite the oldest spans during copying, therefore, spans that
+ * might have been overwritten are discarded.
+ * \param[in]  buf   Trace buffer
+ * \param[out] spans Output array (at least buf->size items)
+ * \return Number of copied spans
+ */
+static size_t
+trace_buf_copy(const struct trace_buf *buf, struct trace_span *spans)
+{
+    const uint64_t head_begin = __atomic_load_n(&buf->head, __ATOMIC_ACQUIRE);
+    uint64_t first = (head_begin > buf->size) ? (head_begin - buf->size) : 0;
+
+    for (uint64_t idx = first; idx < head_begin; ++idx) {
+        spans[idx - first] = buf->spans[idx & (buf->size - 1)];
+    }
+
+    /* The owner could have already recorded new spans (and is possibly writing the next one),
+     * so the oldest slots might contain newer data now.
+     */
+    const uint64_t head_end = __atomic_load_n(&buf->head, __ATOMIC_ACQUIRE);
+    const uint64_t valid_from = (head_end + 1 > buf->size) ? (head_end + 1 - buf->size) : 0;
+    if (valid_from <= first) {
+        return (size_t) (head_begin - first);
+    }
+
+    if (valid_from >= head_begin) {
+        return 0;
+    }
+
+    const size_t skip = (size_t) (valid_from - first);
+    const size_t cnt = (size_t) (head_begin - valid_from);
+    memmove(spans, spans + skip, cnt * sizeof(*spans));
+    return cnt;
+}
+
+/**
+ * \brief Compare spans by trace ID and start (for ordering of flow events)
+ * \param[in] p1 First span
+ * \param[in] p2 Second span
+ * \return Negative, zero or positive number
+ */
+static int
+trace_span_cmp(const void *p1, const void *p2)
+{
+    const struct trace_span *span1 = p1;
+    const struct trace_span *span2 = p2;
+    if (span1->id != span2->id) {
+        return (span1->id < span2->id) ? -1 : 1;
+    }
+
+    if (span1->start != span2->start) {
+        return (span1->start < span2->start) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Write a string as a JSON string (with escaping)
+ * \param[in] file Output file
+ * \param[in] str  String
+ */
+static void
+trace_json_str(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (const unsigned char *ch = (const unsigned char *) str; *ch != '\0'; ++ch) {
+        if (*ch == '"' || *ch == '\\') {
+            fprintf(file, "\\%c", *ch);
+        } else if (*ch < 0x20) {
+            fprintf(file, "\\u%04x", *ch);
+        } else {
+            fputc(*ch, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/**
+ * \brief Write a timestamp in microseconds (the unit of the Chrome JSON format)
+ * \param[in] file Output file
+ * \param[in] ns   Timestamp in nanoseconds
+ */
+static inline void
+trace_json_us(FILE *file, uint64_t ns)
+{
+    fprintf(file, "%" PRIu64 ".%03" PRIu64, ns / 1000U, ns % 1000U);
+}
+
+/**
+ * \brief Write spans and flow events that connect spans of the same message
+ * \param[in] file  Output file
+ * \param[in] spans Spans sorted by trace ID and start
+ * \param[in] cnt   Number of spans
+ * \param[in] base  Timestamp of the beginning of the trace
+ */
+static void
+trace_json_spans(FILE *file, const struct trace_span *spans, size_t cnt, uint64_t base)
+{
+    for (size_t i = 0; i < cnt; ++i) {
+        const struct trace_span *span = &spans[i];
+        const uint64_t start = span->start - base;
+
+        fputs(",\n{\"name\":", file);
+        trace_json_str(file, span->name);
+        fprintf(file, ",\"cat\":\"message\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":",
+            span->tid);
+        trace_json_us(file, start);
+        fputs(",\"dur\":", file);
+        trace_json_us(file, span->dur);
+        fprintf(file, ",\"args\":{\"message\":%" PRIu32 "}}", span->id);
+
+        // Flow events bind to the enclosing span (i.e. they must be inside of it)
+        const bool first = (i == 0 || spans[i - 1].id != span->id);
+        const bool last = (i + 1 == cnt || spans[i + 1].id != span->id);
+        if (first && last) {
+            continue;
+        }
+
+        const char *phase = first ? "s" : (last ? "f" : "t");
+        fprintf(file, ",\n{\"name\":\"message\",\"cat\":\"message\",\"ph\":\"%s\",\"id\":%"
+            PRIu32 ",\"pid\":1,\"tid\":%" PRIu32 ",%s\"ts\":", phase, span->id, span->tid,
+            last ? "\"bp\":\"e\"," : "");
+        trace_json_us(file, start + span->dur / 2);
+        fputc('}', file);
+    }
+}
+
+int
+ipx_trace_export(const char *path)
+{
+    if (!trace.enabled) {
+        return IPX_ERR_DENIED;
+    }
+
+    pthread_mutex_lock(&trace.lock);
+    const size_t cnt_max = (size_t) (trace.bufs_cnt * trace.buf_size);
+    struct trace_span *spans = malloc((cnt_max + 1) * sizeof(*spans));
+    if (!spans) {
+        pthread_mutex_unlock(&trace.lock);
+        return IPX_ERR_NOMEM;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(comp_str, "Failed to create the trace file '%s': %s", path, err_str);
+        pthread_mutex_unlock(&trace.lock);
+        free(spans);
+        return IPX_ERR_DENIED;
+    }
+
+    // Thread names and spans of all buffers
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ipfixcol2\"}}",
+        file);
+
+    size_t cnt = 0;
+    for (const struct trace_buf *buf = trace.bufs; buf != NULL; buf = buf->next) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32
+            ",\"args\":{\"name\":", buf->tid);
+        trace_json_str(file, buf->name);
+        fputs("}}", file);
+
+        const size_t buf_cnt = trace_buf_copy(buf, &spans[cnt]);
+        for (size_t i = 0; i < buf_cnt; ++i) {
+            spans[cnt + i].tid = buf->tid;
+        }
+        cnt += buf_cnt;
+    }
+    pthread_mutex_unlock(&trace.lock);
+
+    uint64_t base = UINT64_MAX;
+    for (size_t i = 0; i < cnt; ++i) {
+        if (spans[i].start < base) {
+            base = spans[i].start;
+        }
+    }
+
+    qsort(spans, cnt, sizeof(*spans), &trace_span_cmp);
+    trace_json_spans(file, spans, cnt, base);
+    fputs("\n]}\n", file);
+    free(spans);
+
+    if (fclose(file) != 0) {
+        IPX_ERROR(comp_str, "Failed to write the trace file '%s'.", path);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_INFO(comp_str, "Trace with %zu span(s) has been written to '%s'.", cnt, path);
+    return IPX_OK;
+}
@@ -0,0 +1,143 @@
+/**
+ * \file src/core/trace.h
+ * \author agent <agent@local>
+ * \brief Tracing of the lifecycle of messages (internal header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_TRACE_H
+#define IPFIXCOL_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxTrace Tracing of messages
+ * \brief Spans of a sample of IPFIX Messages recorded at each stage of the pipeline
+ *
+ * Input instances select a sample of IPFIX Messages and assign them a unique trace ID. Threads
+ * of instances record spans (receiving, waiting in a ring buffer, processing) of these messages
+ * into their private trace buffers. Each buffer is written only by its thread (i.e. without any
+ * locks) and the oldest spans are overwritten when the buffer is full. Buffers can be exported
+ * at any time as a trace in the Chrome JSON format (compatible with Perfetto UI and
+ * chrome://tracing).
+ * @{
+ */
+
+/**
+ * \brief Enable tracing (must be called before threads of instances are started)
+ * \param[in] sampling Trace one of N IPFIX Messages received by each input instance (at least 1)
+ * \param[in] buf_size Number of spans kept per thread (rounded up to a power of two)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if a parameter is invalid
+ */
+IPX_API int
+ipx_trace_enable(uint32_t sampling, size_t buf_size);
+
+/**
+ * \brief Check if tracing is enabled
+ * \return True or false
+ */
+IPX_API bool
+ipx_trace_enabled();
+
+/**
+ * \brief Create a trace buffer of the calling thread
+ *
+ * Spans recorded by the thread without a buffer are ignored. The buffer is preserved after
+ * termination of the thread until ipx_trace_cleanup() is called.
+ * \param[in] name Name of the thread (e.g. name of the instance)
+ * \return #IPX_OK on success (or if tracing is disabled)
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_trace_thread_init(const char *name);
+
+/**
+ * \brief Decide if the next message of the calling thread should be traced
+ * \return Unique trace ID of the message or 0 (do not trace)
+ */
+IPX_API uint32_t
+ipx_trace_sample();
+
+/**
+ * \brief Record a span of a traced message into the buffer of the calling thread
+ * \param[in] id    Trace ID of the message
+ * \param[in] name  Name of the span (must be a string literal)
+ * \param[in] start Start of the span (see ipx_trace_now())
+ * \param[in] end   End of the span (see ipx_trace_now())
+ */
+IPX_API void
+ipx_trace_span(uint32_t id, const char *name, uint64_t start, uint64_t end);
+
+/**
+ * \brief Export all trace buffers as a trace in the Chrome JSON format
+ *
+ * Buffers are not modified, i.e. threads can keep recording spans during the export.
+ * \param[in] path Output file
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if tracing is disabled or the file cannot be written
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_trace_export(const char *path);
+
+/**
+ * \brief Disable tracing and free all trace buffers
+ * \warning Threads that record spans must not be running!
+ */
+IPX_API void
+ipx_trace_cleanup();
+
+/**
+ * \brief Get the current timestamp for spans
+ * \return Monotonic time in nanoseconds
+ */
+static inline uint64_t
+ipx_trace_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+/**@}*/
+
+#endif // IPFIXCOL_TRACE_H
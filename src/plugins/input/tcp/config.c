@@ -48,13 +48,37 @@
  * <params>
  *  <localPort>...</localPort>                    <!-- optional        -->
  *  <localIPAddress>...</localIPAddress>          <!-- optional, multiple times -->
+ *  <tls>                                         <!-- optional        -->
+ *    <certificateFile>...</certificateFile>      <!-- mandatory       -->
+ *    <privateKeyFile>...</privateKeyFile>        <!-- mandatory       -->
+ *    <caFile>...</caFile>                        <!-- optional        -->
+ *    <verifyPeer>...</verifyPeer>                <!-- optional        -->
+ *    <kernelOffload>...</kernelOffload>          <!-- optional        -->
+ *  </tls>
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_PORT = 1,
-    NODE_IPADDR
+    NODE_IPADDR,
+    NODE_TLS,
+
+    TLS_CERT,
+    TLS_KEY,
+    TLS_CA,
+    TLS_VERIFY,
+    TLS_KTLS
+};
+
+/** Definition of the \<tls\> node  */
+static const struct fds_xml_args args_tls[] = {
+    FDS_OPTS_ELEM(TLS_CERT,   "certificateFile", FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(TLS_KEY,    "privateKeyFile",  FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(TLS_CA,     "caFile",          FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(TLS_VERIFY, "verifyPeer",      FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(TLS_KTLS,   "kernelOffload",   FDS_OPTS_T_BOOL,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
 };
 
 /** Definition of the \<params\> node  */
@@ -62,6 +86,7 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(NODE_PORT,   "localPort",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_IPADDR, "localIPAddress", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(NODE_TLS,  "tls",            args_tls,          FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -109,6 +134,76 @@ config_add_addr(ipx_ctx_t *ctx, struct tcp_config *cfg, const char *addr)
     return IPX_OK;
 }
 
+/**
+ * \brief Process \<tls\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] tls  XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_tls(ipx_ctx_t *ctx, fds_xml_ctx_t *tls, struct tcp_tls_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(tls, &content) != FDS_EOC) {
+        char **str_dst = NULL;
+
+        switch (content->id) {
+        case TLS_CERT:
+            // Certificate of the collector
+            str_dst = &cfg->cert_file;
+            break;
+        case TLS_KEY:
+            // Private key of the collector
+            str_dst = &cfg->key_file;
+            break;
+        case TLS_CA:
+            // Trusted Certificate Authorities
+            str_dst = &cfg->ca_file;
+            break;
+        case TLS_VERIFY:
+            // Verification of exporters
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->verify_peer = content->val_bool;
+            break;
+        case TLS_KTLS:
+            // Kernel TLS offload
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->ktls = content->val_bool;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+
+        if (!str_dst) {
+            continue;
+        }
+
+        assert(content->type == FDS_OPTS_T_STRING);
+        if (strlen(content->ptr_string) == 0) {
+            IPX_CTX_ERROR(ctx, "TLS file paths must not be empty!", '\0');
+            return IPX_ERR_FORMAT;
+        }
+
+        free(*str_dst);
+        *str_dst = strdup(content->ptr_string);
+        if (!*str_dst) {
+            IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    if (cfg->verify_peer && !cfg->ca_file) {
+        IPX_CTX_ERROR(ctx, "Verification of exporters' certificates requires <caFile>!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    cfg->enabled = true;
+    return IPX_OK;
+}
+
 /**
  * \brief Process \<params\> node
  * \param[in] ctx  Plugin context
@@ -139,6 +234,13 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct tcp_config *cfg)
                 return IPX_ERR_FORMAT;
             }
             break;
+        case NODE_TLS:
+            // Transport Layer Security
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            if (config_parser_tls(ctx, content->ptr_ctx, &cfg->tls) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
         default:
             // Internal error
             assert(false);
@@ -157,6 +259,9 @@ config_default_set(struct tcp_config *cfg)
 {
     cfg->local_port = 4739; // Default port
     cfg->local_addrs.cnt = 0;
+    cfg->tls.enabled = false;
+    cfg->tls.verify_peer = false;
+    cfg->tls.ktls = true;
 }
 
 struct tcp_config *
@@ -209,5 +314,8 @@ void
 config_destroy(struct tcp_config *cfg)
 {
     free(cfg->local_addrs.addrs);
+    free(cfg->tls.cert_file);
+    free(cfg->tls.key_file);
+    free(cfg->tls.ca_file);
     free(cfg);
 }
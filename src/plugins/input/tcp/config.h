@@ -43,6 +43,7 @@
 #define CONFIG_H
 
 #include <ipfixcol2.h>
+#include <stdbool.h>
 #include "stdint.h"
 
 /** Parsed IP address */
@@ -56,6 +57,22 @@ struct tcp_ipaddr_rec {
     };
 };
 
+/** Configuration of Transport Layer Security                                                   */
+struct tcp_tls_config {
+    /** TLS is enabled                                                                           */
+    bool enabled;
+    /** Path to a certificate of the collector (PEM)                                             */
+    char *cert_file;
+    /** Path to a private key of the collector (PEM)                                             */
+    char *key_file;
+    /** Path to certificates of trusted CAs (PEM, can be NULL)                                   */
+    char *ca_file;
+    /** Require and verify certificates of exporters                                             */
+    bool verify_peer;
+    /** Try to offload decryption to the kernel (kTLS)                                           */
+    bool ktls;
+};
+
 /** Configuration of a instance of the dummy plugin                                              */
 struct tcp_config {
     /** Local port                                                                               */
@@ -67,6 +84,9 @@ struct tcp_config {
         /** Array of local IP addresses                                                          */
         struct tcp_ipaddr_rec *addrs;
     } local_addrs; /**< Local addresses                                                          */
+
+    /** Transport Layer Security                                                                 */
+    struct tcp_tls_config tls;
 };
 
 /**
@@ -46,13 +46,17 @@
 #include <sys/epoll.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <stdlib.h>
 #include <pthread.h>
+#include <signal.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <time.h>
 #include "config.h"
+#include "tls.h"
 
 /** Identification of an invalid socket descriptor                                               */
 #define INVALID_FD        (-1)
@@ -64,6 +68,8 @@
 #define GETTER_MAX_EVENTS (16)
 /** Timeout to read whole IPFIX Message after at least part has been received (in microseconds)  */
 #define GETTER_RECV_TIMEOUT (500000)
+/** Maximum duration of a TLS handshake (in seconds)                                             */
+#define HANDSHAKE_TIMEOUT (10)
 /** Default size of a buffer prepared for new IPFIX/NetFlow message (bytes)                      */
 #define DEF_MSG_SIZE      (4096)
 
@@ -91,6 +97,14 @@ struct tcp_pair {
     struct ipx_session *session;
     /** No message has been received from the Session yet                                        */
     bool new_connection;
+    /** TLS connection (NULL if TLS is disabled)                                                 */
+    tls_conn_t *tls;
+    /** TLS handshake is in progress (the socket is in non-blocking mode)                        */
+    bool handshake;
+    /** Events of the socket registered on the epoll instance                                    */
+    uint32_t events;
+    /** Deadline of the TLS handshake (CLOCK_MONOTONIC)                                          */
+    struct timespec hs_deadline;
 };
 
 /** Instance data                                                                                */
@@ -99,6 +113,10 @@ struct tcp_data {
     struct tcp_config *config;
     /** Reference to the plugin context                                                          */
     ipx_ctx_t *ctx;
+    /** TLS server context (NULL if TLS is disabled)                                             */
+    tls_server_t *tls;
+    /** SIGPIPE has been blocked in the thread of the getter (see tls_sigpipe_block())           */
+    bool tls_sigpipe;
 
     struct {
         /** Size of the array                                                                    */
@@ -122,6 +140,10 @@ struct tcp_data {
 
         /** Epoll file descriptor                                                                */
         int epoll_fd;
+        /** Timeout of the getter (zero in the low-latency mode) [in milliseconds]               */
+        int timeout;
+        /** Number of connections with a TLS handshake in progress (atomic access)               */
+        size_t handshakes;
     } active; /**< Active connections                                                            */
 };
 
@@ -130,17 +152,19 @@ struct tcp_data {
  *
  * The function creates for a file descriptor and a Transport Session new pair that is inserted
  * into the list of active sessions. The file descriptor is also registered on epoll instance
- * of active connections.
+ * of active connections. If the Transport Session is secured by TLS, the handshake is
+ * performed later by the getter (see socket_handshake()) and must be finished in time.
  *
  * \param[in] data    Instance data
  * \param[in] sd      Socket descriptor of the Transport Session
+ * \param[in] tls     TLS connection of the Transport Session (can be NULL)
  * \param[in] session Description of the Transport Session
  * \return #IPX_OK on success (the pair is added and the socket is registered)
  * \return #IPX_ERR_NOMEM in case of a memory allocation error
  * \return #IPX_ERR_DENIED if the epoll failed to register the socket and the pair is not added
  */
 static int
-active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
+active_session_add(struct tcp_data *data, int sd, tls_conn_t *tls, struct ipx_session *session)
 {
     // Create a new pair
     struct tcp_pair *pair = malloc(sizeof(*pair));
@@ -151,6 +175,11 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
     pair->fd = sd;
     pair->session = session;
     pair->new_connection = true;
+    pair->tls = tls;
+    pair->handshake = (tls != NULL);
+    pair->events = EPOLLIN;
+    clock_gettime(CLOCK_MONOTONIC, &pair->hs_deadline);
+    pair->hs_deadline.tv_sec += HANDSHAKE_TIMEOUT;
 
     pthread_mutex_lock(&data->active.lock);
 
@@ -170,7 +199,7 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
 
     // Add the session to the poll
     struct epoll_event ev;
-    ev.events = EPOLLIN;
+    ev.events = pair->events;
     ev.data.ptr = pair; // Pointer to the pair instead of FD
     if (epoll_ctl(data->active.epoll_fd, EPOLL_CTL_ADD, sd, &ev) == -1) {
         // Failed to register the socket
@@ -184,6 +213,10 @@ active_session_add(struct tcp_data *data, int sd, struct ipx_session *session)
         return IPX_ERR_DENIED;
     }
 
+    if (pair->handshake) {
+        __atomic_add_fetch(&data->active.handshakes, 1, __ATOMIC_RELAXED);
+    }
+
     pthread_mutex_unlock(&data->active.lock);
     return IPX_OK;
 }
@@ -243,6 +276,12 @@ active_session_remove_aux(struct tcp_data *data, size_t idx)
     }
 
     // Close internal structures an remove it from the list (do NOT free SESSION)
+    if (pair->handshake) {
+        __atomic_sub_fetch(&data->active.handshakes, 1, __ATOMIC_RELAXED);
+    }
+    if (pair->tls != NULL) {
+        tls_conn_close(pair->tls);
+    }
     close(pair->fd);
     free(pair);
 
@@ -293,6 +332,24 @@ active_session_remove_by_session(struct tcp_data *data, const struct ipx_session
     return IPX_OK;
 }
 
+/**
+ * \brief Enable or disable non-blocking mode of a socket
+ * \param[in] sd     Socket descriptor
+ * \param[in] enable Enable/disable
+ * \return 0 on success, -1 on failure (errno is set)
+ */
+static int
+socket_nonblock_set(int sd, bool enable)
+{
+    int flags = fcntl(sd, F_GETFL);
+    if (flags == -1) {
+        return -1;
+    }
+
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(sd, F_SETFL, flags);
+}
+
 /**
  * \brief Add a new connection
  *
@@ -319,6 +376,15 @@ listener_add_connection(struct tcp_data *data, int sd)
             err_str);
     }
 
+    // Busy polling of the socket in the low-latency mode
+    int busy_poll = (int) ipx_ctx_busy_poll_get(data->ctx);
+    if (busy_poll > 0
+            && setsockopt(sd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Listener: Failed to enable busy polling of a socket: %s",
+            err_str);
+    }
+
     // Get the description of the remove address
     struct sockaddr_storage src_addr;
     socklen_t src_addrlen = sizeof(src_addr);
@@ -381,14 +447,42 @@ listener_add_connection(struct tcp_data *data, int sd)
     char src_addr_str[INET6_ADDRSTRLEN] = {0};
     inet_ntop(net.l3_proto, &net.addr_src, src_addr_str, INET6_ADDRSTRLEN);
 
+    tls_conn_t *tls = NULL;
+    if (data->tls != NULL) {
+        // Writes of the TLS library (alerts, key updates, ...) must not block forever
+        struct timeval snd_timeout = rcv_timeout;
+        if (setsockopt(sd, SOL_SOCKET, SO_SNDTIMEO, &snd_timeout, sizeof(snd_timeout)) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(data->ctx, "Listener: Failed to specify sending timeout of a socket: "
+                "%s", err_str);
+        }
+
+        // The handshake is driven by the getter, a slow exporter must not block others
+        if (socket_nonblock_set(sd, true) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(data->ctx, "Listener: Failed to switch a socket to non-blocking mode: "
+                "%s", err_str);
+            return IPX_ERR_DENIED;
+        }
+
+        tls = tls_conn_create(data->tls, sd);
+        if (!tls) {
+            IPX_CTX_WARNING(data->ctx, "Listener: Connection from '%s' rejected.", src_addr_str);
+            return IPX_ERR_DENIED;
+        }
+    }
+
     struct ipx_session *session = ipx_session_new_tcp(&net);
-    if (!session || active_session_add(data, sd, session) != IPX_OK) {
+    if (!session || active_session_add(data, sd, tls, session) != IPX_OK) {
         // Failed to add the session
         IPX_CTX_ERROR(data->ctx, "Listener: Failed to add internal information about a new "
             "Transport Session from '%s'! Connection rejected.", src_addr_str);
         if (session != NULL) {
             ipx_session_destroy(session);
         }
+        if (tls != NULL) {
+            tls_conn_close(tls);
+        }
         return IPX_ERR_DENIED;
     }
 
@@ -396,6 +490,29 @@ listener_add_connection(struct tcp_data *data, int sd)
     return IPX_OK;
 }
 
+/**
+ * \brief Block SIGPIPE signal in the calling thread
+ *
+ * The TLS library writes to sockets (handshake, alerts, etc.) without MSG_NOSIGNAL flag.
+ * If the exporter has already closed the connection, the write would raise SIGPIPE that
+ * terminates the whole collector. When the signal is blocked, the write fails with EPIPE.
+ * \param[in] ctx Instance context (only for logs!)
+ */
+static void
+tls_sigpipe_block(ipx_ctx_t *ctx)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+
+    int rc = pthread_sigmask(SIG_BLOCK, &set, NULL);
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_CTX_WARNING(ctx, "Failed to block SIGPIPE signal: %s", err_str);
+    }
+}
+
 /**
  * \brief Thread function of connection acceptor
  *
@@ -408,6 +525,9 @@ static void *
 listener_thread(void *cfg)
 {
     struct tcp_data *data = (struct tcp_data *) cfg;
+    if (data->tls != NULL) {
+        tls_sigpipe_block(data->ctx);
+    }
 
     // Always process only one request
     static const int ev_size = 1;
@@ -781,6 +901,7 @@ active_init(ipx_ctx_t *ctx, struct tcp_data *instance)
     instance->active.cnt = 0;
     instance->active.pairs = NULL;
     instance->active.epoll_fd = epoll_fd;
+    instance->active.handshakes = 0;
     return IPX_OK;
 }
 
@@ -809,6 +930,114 @@ active_destroy(ipx_ctx_t *ctx, struct tcp_data *instance)
     instance->active.cnt = 0;
 }
 
+/**
+ * \brief Perform the next step of a TLS handshake of a connection
+ *
+ * The socket is in non-blocking mode during the handshake, therefore, only data already
+ * available are processed and the epoll instance is updated to wait for the next step. After
+ * a successful handshake, the socket is switched back to blocking mode with the receive timeout.
+ * \param[in] data Instance data
+ * \param[in] pair Connection pair with the handshake in progress
+ * \return #IPX_OK on success (the handshake is completed or waits for the exporter)
+ * \return #IPX_ERR_DENIED if the handshake failed and the connection MUST be closed
+ */
+static int
+socket_handshake(struct tcp_data *data, struct tcp_pair *pair)
+{
+    const char *err_str;
+    uint32_t events;
+
+    switch (tls_conn_handshake(pair->tls, pair->session->ident)) {
+    case TLS_HS_DONE:
+        if (socket_nonblock_set(pair->fd, false) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(data->ctx, "Connection from '%s' closed due to failure to switch "
+                "its socket to blocking mode: %s", pair->session->ident, err_str);
+            return IPX_ERR_DENIED;
+        }
+
+        pair->handshake = false;
+        __atomic_sub_fetch(&data->active.handshakes, 1, __ATOMIC_RELAXED);
+        events = EPOLLIN;
+        break;
+    case TLS_HS_WANT_READ:
+        events = EPOLLIN;
+        break;
+    case TLS_HS_WANT_WRITE:
+        events = EPOLLOUT;
+        break;
+    default:
+        return IPX_ERR_DENIED;
+    }
+
+    if (pair->events == events) {
+        return IPX_OK;
+    }
+
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = pair;
+    if (epoll_ctl(data->active.epoll_fd, EPOLL_CTL_MOD, pair->fd, &ev) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(data->ctx, "Connection from '%s' closed due to failure to modify its "
+            "registration. epoll_ctl() failed: %s", pair->session->ident, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    pair->events = events;
+    return IPX_OK;
+}
+
+/**
+ * \brief Close connections with a TLS handshake that hasn't been completed in time
+ *
+ * Exporters that stall in the middle of the handshake would otherwise occupy the connection
+ * forever.
+ * \param[in] data Instance data
+ */
+static void
+active_handshakes_expire(struct tcp_data *data)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&data->active.lock);
+    size_t idx = 0;
+    while (idx < data->active.cnt) {
+        struct tcp_pair *pair = data->active.pairs[idx];
+        const struct timespec *deadline = &pair->hs_deadline;
+        if (!pair->handshake || deadline->tv_sec > now.tv_sec
+                || (deadline->tv_sec == now.tv_sec && deadline->tv_nsec > now.tv_nsec)) {
+            idx++;
+            continue;
+        }
+
+        IPX_CTX_WARNING(data->ctx, "TLS handshake with '%s' failed: not completed within %d "
+            "seconds.", pair->session->ident, HANDSHAKE_TIMEOUT);
+        // The last pair is moved to the index of the removed one
+        active_session_remove_aux(data, idx);
+    }
+    pthread_mutex_unlock(&data->active.lock);
+}
+
+/**
+ * \brief Receive exactly \p len bytes from a connection
+ * \param[in]  pair Connection pair (socket descriptor, session and TLS connection)
+ * \param[out] buf  Output buffer
+ * \param[in]  len  Number of bytes to receive
+ * \return Number of received bytes, 0 if the connection has been closed or -1 on failure
+ *   (errno is set)
+ */
+static inline ssize_t
+socket_recv(struct tcp_pair *pair, void *buf, size_t len)
+{
+    if (pair->tls != NULL) {
+        return tls_conn_recv(pair->tls, buf, len);
+    }
+
+    return recv(pair->fd, buf, len, MSG_WAITALL);
+}
+
 /**
  * \brief Get an IPFIX message from a socket and pass it
  *
@@ -826,8 +1055,8 @@ socket_process(ipx_ctx_t *ctx, struct tcp_pair *pair)
     struct fds_ipfix_msg_hdr hdr;
     static_assert(sizeof(hdr) == FDS_IPFIX_MSG_HDR_LEN, "Invalid size of IPFIX Message header");
 
-    // Get the message header (do not move pointer)
-    ssize_t len = recv(pair->fd, &hdr, FDS_IPFIX_MSG_HDR_LEN, MSG_WAITALL | MSG_PEEK);
+    // Get the message header
+    ssize_t len = socket_recv(pair, &hdr, FDS_IPFIX_MSG_HDR_LEN);
     if (len == 0) {
         // Connection terminated
         IPX_CTX_INFO(ctx, "Connection from '%s' closed.", pair->session->ident);
@@ -864,8 +1093,11 @@ socket_process(ipx_ctx_t *ctx, struct tcp_pair *pair)
         return IPX_ERR_NOMEM;
     }
 
-    len = recv(pair->fd, buffer, msg_size, MSG_WAITALL);
-    if (len != msg_size) {
+    // The header has been already consumed, read only the rest of the message
+    const size_t rest_size = msg_size - FDS_IPFIX_MSG_HDR_LEN;
+    memcpy(buffer, &hdr, FDS_IPFIX_MSG_HDR_LEN);
+    len = (rest_size > 0) ? socket_recv(pair, buffer + FDS_IPFIX_MSG_HDR_LEN, rest_size) : 0;
+    if (len != (ssize_t) rest_size) {
         int error_code = (len == -1) ? errno : ETIMEDOUT;
         ipx_strerror(error_code, err_str);
         IPX_CTX_ERROR(ctx, "Connection from '%s' closed due to failure while reading from "
@@ -874,6 +1106,12 @@ socket_process(ipx_ctx_t *ctx, struct tcp_pair *pair)
         return IPX_ERR_FORMAT;
     }
 
+    if (!ipx_ctx_odid_wanted(ctx, msg_odid)) {
+        // The message must be consumed from the stream, but nobody is interested in it
+        free(buffer);
+        return IPX_OK;
+    }
+
     if (pair->new_connection) {
         // Send information about the new Transport Session
         pair->new_connection = false;
@@ -917,6 +1155,7 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
     data->ctx = ctx;
+    data->active.timeout = (ipx_ctx_busy_poll_get(ctx) > 0) ? 0 : GETTER_TIMEOUT;
 
     // Parse configuration
     data->config = config_parse(ctx, params);
@@ -925,8 +1164,21 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Load certificates and keys (if TLS is enabled)
+    if (data->config->tls.enabled) {
+        data->tls = tls_server_create(ctx, &data->config->tls);
+        if (!data->tls) {
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+    }
+
     // Initialize structures of the listener (and bind to the local addresses)
     if (listener_init(ctx, data) != IPX_OK) {
+        if (data->tls != NULL) {
+            tls_server_destroy(data->tls);
+        }
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
@@ -935,6 +1187,9 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     // Initialize structures of active connections
     if (active_init(ctx, data) != IPX_OK) {
         listener_destroy(data);
+        if (data->tls != NULL) {
+            tls_server_destroy(data->tls);
+        }
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
@@ -944,6 +1199,9 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     if (listener_start(ctx, data) != IPX_OK) {
         active_destroy(ctx, data);
         listener_destroy(data);
+        if (data->tls != NULL) {
+            tls_server_destroy(data->tls);
+        }
         config_destroy(data->config);
         free(data);
         return IPX_ERR_DENIED;
@@ -966,6 +1224,9 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     active_destroy(ctx, data);
 
     // Final cleanup
+    if (data->tls != NULL) {
+        tls_server_destroy(data->tls);
+    }
     config_destroy(data->config);
     free(data);
 }
@@ -976,9 +1237,20 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     struct tcp_data *data = (struct tcp_data *) cfg;
     const char *err_str;
 
+    if (data->tls != NULL && !data->tls_sigpipe) {
+        // The getter is always called by the same thread
+        tls_sigpipe_block(ctx);
+        data->tls_sigpipe = true;
+    }
+
+    if (__atomic_load_n(&data->active.handshakes, __ATOMIC_RELAXED) > 0) {
+        // Close stalled handshakes before any event of their sockets is returned
+        active_handshakes_expire(data);
+    }
+
     // Process messages from up to 16 sockets
     struct epoll_event ev[GETTER_MAX_EVENTS];
-    int ev_valid = epoll_wait(data->active.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
+    int ev_valid = epoll_wait(data->active.epoll_fd, ev, GETTER_MAX_EVENTS, data->active.timeout);
     if (ev_valid == -1) {
         // Failed
         int error_code = errno;
@@ -1000,7 +1272,24 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     assert(ev_valid > 0 && ev_valid <= GETTER_MAX_EVENTS);
     for (int i = 0; i < ev_valid; ++i) {
         struct tcp_pair *pair = (struct tcp_pair *) ev[i].data.ptr;
-        if (socket_process(ctx, pair) == IPX_OK) {
+        int rc = IPX_OK;
+        if (pair->handshake) {
+            // Application data can be received only after the handshake
+            rc = socket_handshake(data, pair);
+            if (rc == IPX_OK && (pair->handshake || !tls_conn_pending(pair->tls))) {
+                continue;
+            }
+        }
+
+        while (rc == IPX_OK) {
+            rc = socket_process(ctx, pair);
+            // Data already decrypted by the TLS library are not signaled by epoll
+            if (pair->tls == NULL || !tls_conn_pending(pair->tls)) {
+                break;
+            }
+        }
+
+        if (rc == IPX_OK) {
             // Success
             continue;
         }
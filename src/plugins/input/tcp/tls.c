@@ -0,0 +1,412 @@
+/**
+ * \file src/plugins/input/tcp/tls.c
+ * \author agent <agent@local>
+ * \brief Transport Layer Security of TCP input plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include "tls.h"
+
+#ifdef HAVE_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+/** TLS server context                                                                           */
+struct tls_server {
+    /** Instance context (only for logs!)                                                        */
+    ipx_ctx_t *ctx;
+    /** OpenSSL context                                                                          */
+    SSL_CTX *ssl_ctx;
+};
+
+/** TLS connection                                                                               */
+struct tls_conn {
+    /** Instance context (only for logs!)                                                        */
+    ipx_ctx_t *ctx;
+    /** OpenSSL connection                                                                       */
+    SSL *ssl;
+    /** Socket descriptor                                                                        */
+    int fd;
+    /** Decryption is offloaded to the kernel                                                    */
+    bool ktls;
+};
+
+/**
+ * \brief Get a description of the last OpenSSL error
+ * \param[out] buf  Output buffer
+ * \param[in]  size Size of the buffer
+ * \return Pointer to the buffer
+ */
+static const char *
+tls_last_err(char *buf, size_t size)
+{
+    unsigned long code = ERR_get_error();
+    if (code == 0) {
+        snprintf(buf, size, "%s", "unknown error");
+    } else {
+        ERR_error_string_n(code, buf, size);
+    }
+
+    ERR_clear_error();
+    return buf;
+}
+
+tls_server_t *
+tls_server_create(ipx_ctx_t *ctx, const struct tcp_tls_config *cfg)
+{
+    char err_buf[256];
+    assert(cfg->enabled && cfg->cert_file != NULL && cfg->key_file != NULL);
+
+    struct tls_server *server = calloc(1, sizeof(*server));
+    if (!server) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+    server->ctx = ctx;
+
+    server->ssl_ctx = SSL_CTX_new(TLS_server_method());
+    if (!server->ssl_ctx) {
+        IPX_CTX_ERROR(ctx, "Failed to create a TLS context: %s",
+            tls_last_err(err_buf, sizeof(err_buf)));
+        free(server);
+        return NULL;
+    }
+
+    SSL_CTX_set_min_proto_version(server->ssl_ctx, TLS1_2_VERSION);
+    // Exporters never resume sessions (connections are long-lived)
+    SSL_CTX_set_session_cache_mode(server->ssl_ctx, SSL_SESS_CACHE_OFF);
+    SSL_CTX_set_options(server->ssl_ctx, SSL_OP_NO_TICKET | SSL_OP_NO_RENEGOTIATION);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    // OpenSSL 3.0+ reports EOF without close notification as a protocol error otherwise
+    SSL_CTX_set_options(server->ssl_ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    if (cfg->ktls) {
+        SSL_CTX_set_options(server->ssl_ctx, SSL_OP_ENABLE_KTLS);
+    }
+#else
+    if (cfg->ktls) {
+        IPX_CTX_INFO(ctx, "Kernel TLS offload is not supported by the TLS library. Using "
+            "userspace decryption.", '\0');
+    }
+#endif
+
+    if (SSL_CTX_use_certificate_chain_file(server->ssl_ctx, cfg->cert_file) != 1) {
+        IPX_CTX_ERROR(ctx, "Failed to load a certificate from '%s': %s", cfg->cert_file,
+            tls_last_err(err_buf, sizeof(err_buf)));
+        goto error;
+    }
+
+    if (SSL_CTX_use_PrivateKey_file(server->ssl_ctx, cfg->key_file, SSL_FILETYPE_PEM) != 1) {
+        IPX_CTX_ERROR(ctx, "Failed to load a private key from '%s': %s", cfg->key_file,
+            tls_last_err(err_buf, sizeof(err_buf)));
+        goto error;
+    }
+
+    if (SSL_CTX_check_private_key(server->ssl_ctx) != 1) {
+        IPX_CTX_ERROR(ctx, "The private key doesn't match the certificate: %s",
+            tls_last_err(err_buf, sizeof(err_buf)));
+        goto error;
+    }
+
+    if (cfg->ca_file != NULL
+            && SSL_CTX_load_verify_locations(server->ssl_ctx, cfg->ca_file, NULL) != 1) {
+        IPX_CTX_ERROR(ctx, "Failed to load trusted certificates from '%s': %s", cfg->ca_file,
+            tls_last_err(err_buf, sizeof(err_buf)));
+        goto error;
+    }
+
+    if (cfg->verify_peer) {
+        const int mode = SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
+        SSL_CTX_set_verify(server->ssl_ctx, mode, NULL);
+    }
+
+    return server;
+
+error:
+    SSL_CTX_free(server->ssl_ctx);
+    free(server);
+    return NULL;
+}
+
+void
+tls_server_destroy(tls_server_t *server)
+{
+    SSL_CTX_free(server->ssl_ctx);
+    free(server);
+}
+
+tls_conn_t *
+tls_conn_create(tls_server_t *server, int sd)
+{
+    char err_buf[256];
+    struct tls_conn *conn = calloc(1, sizeof(*conn));
+    if (!conn) {
+        IPX_CTX_ERROR(server->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    conn->ctx = server->ctx;
+    conn->fd = sd;
+    conn->ssl = SSL_new(server->ssl_ctx);
+    if (!conn->ssl || SSL_set_fd(conn->ssl, sd) != 1) {
+        IPX_CTX_ERROR(server->ctx, "Failed to create a TLS connection: %s",
+            tls_last_err(err_buf, sizeof(err_buf)));
+        SSL_free(conn->ssl);
+        free(conn);
+        return NULL;
+    }
+
+    SSL_set_accept_state(conn->ssl);
+    return conn;
+}
+
+enum tls_handshake
+tls_conn_handshake(tls_conn_t *conn, const char *peer)
+{
+    char err_buf[256];
+    errno = 0;
+    int ret = SSL_do_handshake(conn->ssl);
+    if (ret != 1) {
+        const int ssl_err = SSL_get_error(conn->ssl, ret);
+        const char *reason;
+        switch (ssl_err) {
+        case SSL_ERROR_WANT_READ:
+            // Nothing else to process until more data arrive
+            ERR_clear_error();
+            return TLS_HS_WANT_READ;
+        case SSL_ERROR_WANT_WRITE:
+            ERR_clear_error();
+            return TLS_HS_WANT_WRITE;
+        case SSL_ERROR_SYSCALL:
+            ipx_strerror((errno != 0) ? errno : ECONNRESET, reason);
+            break;
+        default:
+            reason = tls_last_err(err_buf, sizeof(err_buf));
+            break;
+        }
+
+        IPX_CTX_WARNING(conn->ctx, "TLS handshake with '%s' failed: %s", peer, reason);
+        ERR_clear_error();
+        return TLS_HS_FAILED;
+    }
+
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+    conn->ktls = BIO_get_ktls_recv(SSL_get_rbio(conn->ssl)) != 0;
+#else
+    conn->ktls = false;
+#endif
+
+    IPX_CTX_INFO(conn->ctx, "TLS connection with '%s' established (%s, %s, %s decryption).",
+        peer, SSL_get_version(conn->ssl), SSL_get_cipher_name(conn->ssl),
+        conn->ktls ? "kernel" : "userspace");
+    return TLS_HS_DONE;
+}
+
+/**
+ * \brief Read application data using the TLS library
+ * \param[in]  conn TLS connection
+ * \param[out] buf  Output buffer
+ * \param[in]  len  Maximum number of bytes to read
+ * \return Number of read bytes (> 0) on success
+ * \return 0 if the connection has been closed by the exporter
+ * \return -1 on failure (errno is set)
+ */
+static ssize_t
+tls_conn_read(tls_conn_t *conn, void *buf, size_t len)
+{
+    const int to_read = (len > INT32_MAX) ? INT32_MAX : (int) len;
+    errno = 0;
+    int ret = SSL_read(conn->ssl, buf, to_read);
+    if (ret > 0) {
+        return ret;
+    }
+
+    switch (SSL_get_error(conn->ssl, ret)) {
+    case SSL_ERROR_ZERO_RETURN:
+        // Close notification
+        return 0;
+    case SSL_ERROR_SYSCALL:
+        if (errno == 0) {
+            // Unexpected EOF (without close notification)
+            return 0;
+        }
+        return -1;
+    case SSL_ERROR_WANT_READ:
+        // Receive timeout
+        errno = ETIMEDOUT;
+        return -1;
+    default:
+        ERR_clear_error();
+        errno = EPROTO;
+        return -1;
+    }
+}
+
+ssize_t
+tls_conn_recv(tls_conn_t *conn, void *buf, size_t len)
+{
+    uint8_t *ptr = buf;
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t ret;
+
+        if (conn->ktls) {
+            // Decrypted data are copied by the kernel directly into the buffer
+            ret = recv(conn->fd, ptr + done, len - done, MSG_WAITALL);
+            if (ret == -1 && errno == EIO) {
+                // A control record (alert, key update, ...) -> let the library to process it
+                ret = tls_conn_read(conn, ptr + done, len - done);
+            }
+        } else {
+            ret = tls_conn_read(conn, ptr + done, len - done);
+        }
+
+        if (ret > 0) {
+            done += (size_t) ret;
+            continue;
+        }
+
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (ret == 0 && done > 0) {
+            // Closed in the middle of a message
+            errno = ECONNRESET;
+            return -1;
+        }
+
+        return ret;
+    }
+
+    return (ssize_t) done;
+}
+
+bool
+tls_conn_pending(const tls_conn_t *conn)
+{
+    return !conn->ktls && SSL_pending(conn->ssl) > 0;
+}
+
+bool
+tls_conn_ktls(const tls_conn_t *conn)
+{
+    return conn->ktls;
+}
+
+void
+tls_conn_close(tls_conn_t *conn)
+{
+    // Best effort, do not wait for the response of the exporter
+    SSL_shutdown(conn->ssl);
+    SSL_free(conn->ssl);
+    ERR_clear_error();
+    free(conn);
+}
+
+#else // HAVE_OPENSSL
+
+tls_server_t *
+tls_server_create(ipx_ctx_t *ctx, const struct tcp_tls_config *cfg)
+{
+    (void) cfg;
+    IPX_CTX_ERROR(ctx, "TLS is not supported because the plugin has been built without "
+        "OpenSSL!", '\0');
+    return NULL;
+}
+
+void
+tls_server_destroy(tls_server_t *server)
+{
+    (void) server;
+}
+
+tls_conn_t *
+tls_conn_create(tls_server_t *server, int sd)
+{
+    (void) server;
+    (void) sd;
+    return NULL;
+}
+
+enum tls_handshake
+tls_conn_handshake(tls_conn_t *conn, const char *peer)
+{
+    (void) conn;
+    (void) peer;
+    return TLS_HS_FAILED;
+}
+
+ssize_t
+tls_conn_recv(tls_conn_t *conn, void *buf, size_t len)
+{
+    (void) conn;
+    (void) buf;
+    (void) len;
+    errno = ENOTSUP;
+    return -1;
+}
+
+bool
+tls_conn_pending(const tls_conn_t *conn)
+{
+    (void) conn;
+    return false;
+}
+
+bool
+tls_conn_ktls(const tls_conn_t *conn)
+{
+    (void) conn;
+    return false;
+}
+
+void
+tls_conn_close(tls_conn_t *conn)
+{
+    (void) conn;
+}
+
+#endif // HAVE_OPENSSL
@@ -0,0 +1,157 @@
+/**
+ * \file src/plugins/input/tcp/tls.h
+ * \author agent <agent@local>
+ * \brief Transport Layer Security of TCP input plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef TCP_TLS_H
+#define TCP_TLS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <ipfixcol2.h>
+#include "config.h"
+
+/** TLS server context (shared by all connections)                                               */
+typedef struct tls_server tls_server_t;
+/** TLS connection                                                                               */
+typedef struct tls_conn tls_conn_t;
+
+/**
+ * \brief Create a TLS server context
+ *
+ * Load the certificate, the private key and (optionally) trusted Certificate Authorities.
+ * \param[in] ctx Instance context (only for logs!)
+ * \param[in] cfg TLS configuration
+ * \return Pointer to the context or NULL (an error message is printed)
+ */
+tls_server_t *
+tls_server_create(ipx_ctx_t *ctx, const struct tcp_tls_config *cfg);
+
+/**
+ * \brief Destroy a TLS server context
+ * \warning All connections created by the context MUST be already closed.
+ * \param[in] server Server context
+ */
+void
+tls_server_destroy(tls_server_t *server);
+
+/** Result of a step of a TLS handshake                                                          */
+enum tls_handshake {
+    /** The handshake has been completed                                                         */
+    TLS_HS_DONE,
+    /** The handshake cannot continue until the socket is readable                               */
+    TLS_HS_WANT_READ,
+    /** The handshake cannot continue until the socket is writable                               */
+    TLS_HS_WANT_WRITE,
+    /** The handshake failed (an error message is printed)                                       */
+    TLS_HS_FAILED
+};
+
+/**
+ * \brief Create a TLS connection on a newly accepted socket
+ *
+ * No data are exchanged with the exporter. The handshake must be performed by one or more calls
+ * of tls_conn_handshake() before any application data can be received.
+ * \param[in] server Server context
+ * \param[in] sd     Socket descriptor of the connection
+ * \return Pointer to the connection or NULL (an error message is printed)
+ */
+tls_conn_t *
+tls_conn_create(tls_server_t *server, int sd);
+
+/**
+ * \brief Perform the next step of a TLS handshake
+ *
+ * The function processes all data available on the socket and returns as soon as the handshake
+ * cannot continue. If the socket is in non-blocking mode, the caller should wait until the socket
+ * is readable (#TLS_HS_WANT_READ) or writable (#TLS_HS_WANT_WRITE) and call the function again.
+ * On a blocking socket, these codes mean that a receive/send timeout of the socket expired.
+ *
+ * After a successful handshake, the function tries to hand over decryption of the connection to
+ * the kernel (kTLS). If the offload is available, application data are decrypted directly into
+ * buffers passed to tls_conn_recv() without any further involvement of the TLS library.
+ * Otherwise, the data are decrypted in userspace.
+ * \param[in] conn TLS connection
+ * \param[in] peer Identification of the exporter (only for logs)
+ * \return Status of the handshake
+ */
+enum tls_handshake
+tls_conn_handshake(tls_conn_t *conn, const char *peer);
+
+/**
+ * \brief Receive exactly \p len bytes of application data
+ * \param[in]  conn TLS connection
+ * \param[out] buf  Output buffer
+ * \param[in]  len  Number of bytes to receive
+ * \return Number of received bytes (i.e. \p len) on success
+ * \return 0 if the connection has been closed by the exporter before any data were received
+ * \return -1 on failure (errno is set)
+ */
+ssize_t
+tls_conn_recv(tls_conn_t *conn, void *buf, size_t len);
+
+/**
+ * \brief Check if already decrypted data wait for reading
+ *
+ * Data buffered inside the TLS library are not signaled by the socket. The caller should read
+ * them before waiting for new events on the socket.
+ * \param[in] conn TLS connection
+ * \return True or false
+ */
+bool
+tls_conn_pending(const tls_conn_t *conn);
+
+/**
+ * \brief Check if decryption of the connection is offloaded to the kernel
+ * \param[in] conn TLS connection
+ * \return True or false
+ */
+bool
+tls_conn_ktls(const tls_conn_t *conn);
+
+/**
+ * \brief Close the TLS connection (send close notification) and free its resources
+ * \note The socket is NOT closed.
+ * \param[in] conn TLS connection
+ */
+void
+tls_conn_close(tls_conn_t *conn);
+
+#endif // TCP_TLS_H
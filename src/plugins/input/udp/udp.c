@@ -176,6 +176,8 @@ struct udp_data {
         int epoll_fd;
         /** Timer file descriptor (#INVALID_FD if not valid)                                     */
         int timer_fd;
+        /** Timeout of the getter (zero in the low-latency mode) [in milliseconds]               */
+        int timeout;
     } listen; /**< Sockets to listen for data                                                    */
 
     struct {
@@ -276,6 +278,15 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
         }
     }
 
+    // Busy polling of the socket in the low-latency mode
+    int busy_poll = (int) ipx_ctx_busy_poll_get(ctx);
+    if (busy_poll > 0
+            && setsockopt(sd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Unable to enable busy polling of a socket (local IP %s). "
+            "setsockopt() failed: %s", addr_str, err_str);
+    }
+
     // Bind
     if (bind(sd, addr, addrlen) == -1) {
         ipx_strerror(errno, err_str);
@@ -1016,6 +1027,12 @@ process_socket(struct udp_data *instance, int sd)
         return;
     }
 
+    if (!ipx_ctx_odid_wanted(instance->ctx, msg_odid)) {
+        // No output instance processes the Observation Domain
+        free(buffer);
+        return;
+    }
+
     if (source->new_connection) {
         // Send information about the new Transport Session
         source->new_connection = false;
@@ -1060,6 +1077,7 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     data->ctx = ctx;
     data->active.cnt = 0;
     data->active.sources = NULL;
+    data->listen.timeout = (ipx_ctx_busy_poll_get(ctx) > 0) ? 0 : GETTER_TIMEOUT;
 
     // Parse configuration
     data->config = config_parse(ctx, params);
@@ -1105,7 +1123,7 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
 
     // Process messages from up to 16 sockets (including the timer)
     struct epoll_event ev[GETTER_MAX_EVENTS];
-    int ev_valid = epoll_wait(data->listen.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
+    int ev_valid = epoll_wait(data->listen.epoll_fd, ev, GETTER_MAX_EVENTS, data->listen.timeout);
     if (ev_valid == -1) {
         // Failed
         int error_code = errno;
@@ -0,0 +1,359 @@
+/**
+ * \file src/plugins/input/unix/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of Unix socket input plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/un.h>
+#include "config.h"
+
+/** Minimal connection timeout                                                                   */
+#define CONN_TIMEOUT_MIN (10)
+/** Default connection timeout                                                                   */
+#define CONN_TIMEOUT_DEF (600)
+/** Default Template Lifetime                                                                    */
+#define LIFETIME_DATA_DEF (1800)
+/** Default Options Template Lifetime                                                            */
+#define LIFETIME_OPTS_DEF (1800)
+/** Default permissions of the socket file                                                       */
+#define PERMISSIONS_DEF (0660)
+
+/*
+ * <params>
+ *  <path>...</path>                              <!-- mandatory                 -->
+ *  <socketType>...</socketType>                  <!-- optional                  -->
+ *  <permissions>...</permissions>                <!-- optional                  -->
+ *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
+ *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
+ *  <connectionTimeout>...</connectionTimeout>    <!-- optional                  -->
+ *  <exporter>                                    <!-- optional, multiple times  -->
+ *    <name>...</name>                            <!-- mandatory                 -->
+ *    <uid>...</uid>                              <!-- optional                  -->
+ *    <process>...</process>                      <!-- optional                  -->
+ *  </exporter>
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_PATH = 1,
+    NODE_TYPE,
+    NODE_PERMS,
+    NODE_LT_DATA,
+    NODE_LT_OPTS,
+    NODE_TIMEOUT,
+    NODE_EXPORTER,
+
+    EXP_NAME,
+    EXP_UID,
+    EXP_PROCESS
+};
+
+/** Definition of the \<exporter\> node  */
+static const struct fds_xml_args args_exporter[] = {
+    FDS_OPTS_ELEM(EXP_NAME,    "name",    FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(EXP_UID,     "uid",     FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(EXP_PROCESS, "process", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_PATH,    "path",                    FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_TYPE,    "socketType",              FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_PERMS,   "permissions",             FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LT_DATA, "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LT_OPTS, "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIMEOUT, "connectionTimeout",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_EXPORTER, "exporter", args_exporter,
+        FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Process \<exporter\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_exporter(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct ux_config *cfg)
+{
+    const size_t alloc_size = (cfg->exporters.cnt + 1) * sizeof(struct ux_exporter);
+    struct ux_exporter *new_items = realloc(cfg->exporters.items, alloc_size);
+    if (!new_items) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+
+    cfg->exporters.items = new_items;
+    struct ux_exporter *exp = &new_items[cfg->exporters.cnt++];
+    memset(exp, 0, sizeof(*exp));
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case EXP_NAME:
+            // Name of the exporter
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strlen(content->ptr_string) == 0) {
+                IPX_CTX_ERROR(ctx, "Name of an exporter must not be empty!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            exp->name = strdup(content->ptr_string);
+            if (!exp->name) {
+                IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case EXP_UID:
+            // User ID of the exporting process
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "User ID of an exporter is out of range!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            exp->uid = (uid_t) content->val_uint;
+            exp->uid_set = true;
+            break;
+        case EXP_PROCESS:
+            // Name of the exporting process
+            assert(content->type == FDS_OPTS_T_STRING);
+            exp->process = strdup(content->ptr_string);
+            if (!exp->process) {
+                IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    if (!exp->uid_set && !exp->process) {
+        IPX_CTX_ERROR(ctx, "Exporter '%s' must be identified by a user ID and/or a process name!",
+            exp->name);
+        return IPX_ERR_FORMAT;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct ux_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    char *end;
+
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_PATH:
+            // Path of the socket
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strlen(content->ptr_string) == 0
+                    || strlen(content->ptr_string) >= sizeof(((struct sockaddr_un *) 0)->sun_path)) {
+                IPX_CTX_ERROR(ctx, "Path of the socket must not be empty or longer than %zu "
+                    "characters!", sizeof(((struct sockaddr_un *) 0)->sun_path) - 1);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->path = strdup(content->ptr_string);
+            if (!cfg->path) {
+                IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_TYPE:
+            // Type of the socket
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "datagram") == 0) {
+                cfg->type = UX_TYPE_DGRAM;
+            } else if (strcasecmp(content->ptr_string, "seqpacket") == 0) {
+                cfg->type = UX_TYPE_SEQPACKET;
+            } else {
+                IPX_CTX_ERROR(ctx, "Unknown socket type '%s'!", content->ptr_string);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_PERMS:
+            // Permissions of the socket file (octal)
+            assert(content->type == FDS_OPTS_T_STRING);
+            errno = 0;
+            unsigned long perms = strtoul(content->ptr_string, &end, 8);
+            if (errno != 0 || *end != '\0' || end == content->ptr_string || perms > 0777) {
+                IPX_CTX_ERROR(ctx, "Permissions '%s' are not a valid octal number (e.g. 660)!",
+                    content->ptr_string);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->permissions = (mode_t) perms;
+            break;
+        case NODE_LT_DATA:
+            // Template Lifetime
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Template Lifetime must be between 0..%" PRIu16, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->lifetime_data = (uint16_t) content->val_uint;
+            break;
+        case NODE_LT_OPTS:
+            // Options Template Lifetime
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Options Template Lifetime must be between 0..%" PRIu16,
+                    UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->lifetime_opts = (uint16_t) content->val_uint;
+            break;
+        case NODE_TIMEOUT:
+            // Connection timeout
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < CONN_TIMEOUT_MIN || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Connection timeout must be between %" PRIu16 "..%" PRIu16,
+                    (uint16_t) CONN_TIMEOUT_MIN, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->timeout_conn = (uint16_t) content->val_uint;
+            break;
+        case NODE_EXPORTER:
+            // Named exporter
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            if (config_parser_exporter(ctx, content->ptr_ctx, cfg) != IPX_OK) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Set default parameters of the configuration
+ * \param[in] cfg Configuration
+ */
+static void
+config_default_set(struct ux_config *cfg)
+{
+    cfg->type = UX_TYPE_DGRAM;
+    cfg->permissions = PERMISSIONS_DEF;
+    cfg->timeout_conn = CONN_TIMEOUT_DEF;
+    cfg->lifetime_data = LIFETIME_DATA_DEF;
+    cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->exporters.cnt = 0;
+    cfg->exporters.items = NULL;
+}
+
+struct ux_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct ux_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    config_default_set(cfg);
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct ux_config *cfg)
+{
+    for (size_t i = 0; i < cfg->exporters.cnt; ++i) {
+        free(cfg->exporters.items[i].name);
+        free(cfg->exporters.items[i].process);
+    }
+
+    free(cfg->exporters.items);
+    free(cfg->path);
+    free(cfg);
+}
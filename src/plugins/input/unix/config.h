@@ -0,0 +1,111 @@
+/**
+ * \file src/plugins/input/unix/config.h
+ * \author agent <agent@local>
+ * \brief Configuration parser of Unix socket input plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <ipfixcol2.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/** Type of the listening socket                                                                 */
+enum ux_socket_type {
+    /** SOCK_DGRAM - each datagram is identified by credentials of the sending process           */
+    UX_TYPE_DGRAM,
+    /** SOCK_SEQPACKET - each connection is a separate Transport Session                         */
+    UX_TYPE_SEQPACKET
+};
+
+/** Name of an exporter identified by credentials of its process                                 */
+struct ux_exporter {
+    /** Name of the exporter (used as the identification of the Transport Session)               */
+    char *name;
+    /** User ID of the process (only if #uid_set)                                                */
+    uid_t uid;
+    /** The user ID is defined                                                                   */
+    bool uid_set;
+    /** Name of the process, i.e. /proc/[pid]/comm (NULL if not defined)                         */
+    char *process;
+};
+
+/** Configuration of an instance of the Unix socket plugin                                       */
+struct ux_config {
+    /** Path of the socket                                                                       */
+    char *path;
+    /** Type of the socket                                                                       */
+    enum ux_socket_type type;
+    /** Permissions of the socket file                                                           */
+    mode_t permissions;
+
+    /** Data template lifetime                                                                   */
+    uint16_t lifetime_data;
+    /** Options Template lifetime                                                                */
+    uint16_t lifetime_opts;
+    /** Connection timeout (datagram sockets only)                                               */
+    uint16_t timeout_conn;
+
+    struct {
+        /** Size of the array                                                                    */
+        size_t cnt;
+        /** Array of named exporters                                                             */
+        struct ux_exporter *items;
+    } exporters; /**< Named exporters                                                            */
+};
+
+/**
+ * \brief Parse configuration of the plugin
+ * \param[in] ctx    Instance context
+ * \param[in] params XML parameters
+ * \return Pointer to the parse configuration of the instance on success
+ * \return NULL if arguments are not valid or if a memory allocation error has occurred
+ */
+struct ux_config *
+config_parse(ipx_ctx_t *ctx, const char *params);
+
+/**
+ * \brief Destroy parsed configuration
+ * \param[in] cfg Parsed configuration
+ */
+void
+config_destroy(struct ux_config *cfg);
+
+#endif // CONFIG_H
@@ -0,0 +1,1078 @@
+/**
+ * \file src/plugins/input/unix/unix.c
+ * \author agent <agent@local>
+ * \brief Unix domain socket input plugin for IPFIXcol 2
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#define _GNU_SOURCE // recvmmsg(), accept4(), struct ucred
+
+#include <ipfixcol2.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "config.h"
+
+/** Identification of an invalid socket descriptor                                               */
+#define INVALID_FD        (-1)
+/** Timeout for a getter operation - i.e. epoll_wait timeout [in milliseconds]                   */
+#define GETTER_TIMEOUT    (10)
+/** Max sockets events processed in the getter - i.e. epoll_wait array size                      */
+#define GETTER_MAX_EVENTS (16)
+/** Number of seconds between timer events [seconds]                                             */
+#define TIMER_INTERVAL    (2)
+/** Maximum number of messages received by one system call                                       */
+#define UX_BATCH          (32)
+/** Size of a receive buffer of a message [bytes] (i.e. the maximum size of a message)           */
+#define UX_BUFFER_SIZE    (UINT16_MAX)
+/** Maximum length of a process name (see proc(5), /proc/[pid]/comm)                             */
+#define UX_COMM_LEN       (16)
+/** Backlog of the listening socket (SOCK_SEQPACKET only)                                        */
+#define UX_BACKLOG        (16)
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "unix",
+    // Brief description of plugin
+    .dsc = "Input plugin for IPFIX/NetFlow v5/v9 over Unix domain sockets.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.1.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.1.0"
+};
+
+/**
+ * @struct nf5_msg_hdr
+ * @brief NetFlow v5 Packet Header structure
+ * @warning All values are stored in Network Byte Order!
+ */
+struct __attribute__((__packed__)) nf5_msg_hdr {
+    /// NetFlow export format version number
+    uint16_t version;
+    /// Number of flows exported in this packet (1 - 30)
+    uint16_t count;
+    /// Current time in milliseconds since the export device booted
+    uint32_t sys_uptime;
+    /// Current count of seconds since 0000 UTC 1970
+    uint32_t unix_sec;
+    /// Residual nanoseconds since 0000 UTC 1970
+    uint32_t unix_nsec;
+    /// Sequence counter of total flows seen
+    uint32_t flow_seq;
+    /// Type of flow-switching engine
+    uint8_t  engine_type;
+    /// Slot number of the flow-switching engine
+    uint8_t  engine_id;
+    /// First two bits hold the sampling mode. Remaining 14 bits hold value of sampling interval
+    uint16_t sampling_interval;
+};
+
+/** Version identification in NetFlow v5 header                                                  */
+#define NF5_HDR_VERSION   (5)
+/** Length of NetFlow v5 header (in bytes)                                                       */
+#define NF5_HDR_LEN       (sizeof(struct nf5_msg_hdr))
+
+/**
+ * @struct nf9_msg_hdr
+ * @brief NetFlow v9 Packet Header structure
+ * @warning All values are stored in Network Byte Order!
+ */
+struct __attribute__((__packed__)) nf9_msg_hdr {
+    /// Version of Flow Record format exported in this packet
+    uint16_t version;
+    /// The total number of records in the Export Packet
+    uint16_t count;
+    /// Time in milliseconds since this device was first booted
+    uint32_t sys_uptime;
+    /// Time in seconds since 0000 UTC 1970, at which the Export Packet leaves the Exporter
+    uint32_t unix_sec;
+    /// Incremental sequence counter of all Export Packets by the Exporter
+    uint32_t seq_number;
+    /// Exporter Observation Domain
+    uint32_t source_id;
+};
+
+/** Version identification in NetFlow v9 header                                                  */
+#define NF9_HDR_VERSION   (9)
+/** Length of NetFlow v9 header (in bytes)                                                       */
+#define NF9_HDR_LEN       (sizeof(struct nf9_msg_hdr))
+
+/** Description of a Transport Session of a local exporter                                       */
+struct ux_source {
+    /** Connected socket (SOCK_SEQPACKET only, otherwise #INVALID_FD)                            */
+    int fd;
+    /** Credentials of the exporting process                                                     */
+    struct ucred cred;
+
+    /** Description of the Transport Session                                                     */
+    struct ipx_session *session;
+
+    /** Timestamp of check when the source was last seen                                         */
+    time_t last_seen;
+    /** Number of received messages since last check                                             */
+    uint32_t msg_cnt;
+    /** No message has been received from the Session yet                                        */
+    bool new_connection;
+};
+
+/** Instance data                                                                                */
+struct ux_data {
+    /** Parsed configuration parameters                                                          */
+    struct ux_config *config;
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+
+    struct {
+        /** Listening socket                                                                     */
+        int sd;
+        /** Epoll file descriptor (listening socket, connected sockets and timer)                */
+        int epoll_fd;
+        /** Timer file descriptor (#INVALID_FD if not valid)                                     */
+        int timer_fd;
+        /** Timeout of the getter (zero in the low-latency mode) [in milliseconds]               */
+        int timeout;
+    } listen; /**< Socket to listen for data                                                     */
+
+    struct {
+        /** Message headers of recvmmsg()                                                        */
+        struct mmsghdr hdrs[UX_BATCH];
+        /** Vectors pointing to the receive buffers                                              */
+        struct iovec iovs[UX_BATCH];
+        /** Receive buffers (#UX_BATCH x #UX_BUFFER_SIZE bytes)                                  */
+        uint8_t *data;
+        /** Control buffers for credentials of the sender                                        */
+        union {
+            char buf[CMSG_SPACE(sizeof(struct ucred))];
+            struct cmsghdr align;
+        } ctrl[UX_BATCH];
+    } batch; /**< Buffers for batched reception of messages                                      */
+
+    struct {
+        /** Size of the array                                                                    */
+        size_t cnt;
+        /** Array of active sources (identification and corresponding Transport Session)         */
+        struct ux_source **sources;
+    } active; /**< Active connections                                                            */
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Add a file descriptor to the epoll instance
+ * \param[in] instance Instance data
+ * \param[in] fd       File descriptor
+ * \param[in] events   Events to watch
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+epoll_add(struct ux_data *instance, int fd, uint32_t events)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to add a descriptor to epoll: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Create a new socket and bind it to the configured path
+ *
+ * A stale socket file (e.g. left by a previous run of the collector) is removed. Other types
+ * of files are never removed. Datagram sockets are configured to receive credentials of the
+ * sending process with each message. Sequenced-packet sockets are switched to the listening
+ * mode.
+ * \param[in] instance Instance data
+ * \return On failure returns #INVALID_FD. Otherwise returns valid socket descriptor.
+ */
+static int
+listener_bind(struct ux_data *instance)
+{
+    const struct ux_config *cfg = instance->config;
+    const int type = (cfg->type == UX_TYPE_DGRAM) ? SOCK_DGRAM : SOCK_SEQPACKET;
+    const char *err_str;
+    int on = 1;
+
+    // Remove a stale socket
+    struct stat st;
+    if (lstat(cfg->path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            IPX_CTX_ERROR(instance->ctx, "Unable to create a socket '%s': the file already exists "
+                "and it is not a socket!", cfg->path);
+            return INVALID_FD;
+        }
+
+        if (unlink(cfg->path) == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Unable to remove an old socket '%s': %s", cfg->path,
+                err_str);
+            return INVALID_FD;
+        }
+    }
+
+    // Create a socket
+    int sd = socket(AF_UNIX, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a socket: %s", err_str);
+        return INVALID_FD;
+    }
+
+    // Receive credentials of the sender with each datagram
+    if (type == SOCK_DGRAM && setsockopt(sd, SOL_SOCKET, SO_PASSCRED, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Cannot turn on socket option SO_PASSCRED: %s", err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+
+    // Bind
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, cfg->path, sizeof(addr.sun_path) - 1);
+
+    if (bind(sd, (const struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Cannot bind to a socket '%s': %s", cfg->path, err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+
+    if (chmod(cfg->path, cfg->permissions) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(instance->ctx, "Unable to change permissions of the socket '%s' to %o. "
+            "Exporters may not be able to connect. (error: %s)", cfg->path,
+            (unsigned int) cfg->permissions, err_str);
+    }
+
+    if (type == SOCK_SEQPACKET && listen(sd, UX_BACKLOG) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Cannot listen on a socket '%s': %s", cfg->path, err_str);
+        close(sd);
+        unlink(cfg->path);
+        return INVALID_FD;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "Bind succeed on '%s' (%s)", cfg->path,
+        (type == SOCK_DGRAM) ? "datagram" : "seqpacket");
+    return sd;
+}
+
+/**
+ * \brief Prepare buffers for batched reception of messages
+ *
+ * Each message header points to its own receive buffer and control buffer.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on memory allocation error
+ */
+static int
+batch_init(struct ux_data *instance)
+{
+    instance->batch.data = malloc(UX_BATCH * UX_BUFFER_SIZE * sizeof(uint8_t));
+    if (!instance->batch.data) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    memset(instance->batch.hdrs, 0, sizeof(instance->batch.hdrs));
+    for (size_t i = 0; i < UX_BATCH; ++i) {
+        instance->batch.iovs[i].iov_base = &instance->batch.data[i * UX_BUFFER_SIZE];
+        instance->batch.iovs[i].iov_len = UX_BUFFER_SIZE;
+        instance->batch.hdrs[i].msg_hdr.msg_iov = &instance->batch.iovs[i];
+        instance->batch.hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Reset message headers before the next call of recvmmsg()
+ *
+ * Sizes of control buffers and flags are overwritten by the previous call.
+ * \param[in] instance Instance data
+ * \param[in] creds    Receive credentials of the sender (control messages)
+ */
+static inline void
+batch_reset(struct ux_data *instance, bool creds)
+{
+    for (size_t i = 0; i < UX_BATCH; ++i) {
+        struct msghdr *hdr = &instance->batch.hdrs[i].msg_hdr;
+        hdr->msg_control = creds ? instance->batch.ctrl[i].buf : NULL;
+        hdr->msg_controllen = creds ? sizeof(instance->batch.ctrl[i].buf) : 0;
+        hdr->msg_flags = 0;
+        instance->batch.hdrs[i].msg_len = 0;
+    }
+}
+
+/**
+ * \brief Initialize the listening socket
+ *
+ * Based on parsed configuration, the socket is created and a timer that regularly checks
+ * inactive connections is armed.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (typically failed to bind to a path)
+ */
+static int
+listener_init(struct ux_data *instance)
+{
+    const char *err_str;
+
+    if (batch_init(instance) != IPX_OK) {
+        return IPX_ERR_DENIED;
+    }
+
+    // Create epoll and bind the socket
+    instance->listen.epoll_fd = epoll_create(1);
+    if (instance->listen.epoll_fd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "epoll() failed: %s", err_str);
+        free(instance->batch.data);
+        return IPX_ERR_DENIED;
+    }
+
+    instance->listen.sd = listener_bind(instance);
+    if (instance->listen.sd == INVALID_FD) {
+        close(instance->listen.epoll_fd);
+        free(instance->batch.data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (epoll_add(instance, instance->listen.sd, EPOLLIN) != IPX_OK) {
+        goto err_socket;
+    }
+
+    // Create a timer and arms it
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (timer_fd == INVALID_FD) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a timer. timerfd_create() failed: %s",
+            err_str);
+        goto err_socket;
+    }
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_interval.tv_sec = TIMER_INTERVAL;
+    spec.it_interval.tv_nsec = 0;
+    spec.it_value.tv_sec = TIMER_INTERVAL;
+    spec.it_value.tv_nsec = 0;
+
+    if (timerfd_settime(timer_fd, 0, &spec, NULL) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to arm a timer. timerfd_settime() failed: %s", err_str);
+        close(timer_fd);
+        goto err_socket;
+    }
+
+    // Add the timer on the epoll instance
+    if (epoll_add(instance, timer_fd, EPOLLIN) != IPX_OK) {
+        close(timer_fd);
+        goto err_socket;
+    }
+
+    instance->listen.timer_fd = timer_fd;
+    return IPX_OK;
+
+err_socket:
+    close(instance->listen.sd);
+    unlink(instance->config->path);
+    close(instance->listen.epoll_fd);
+    free(instance->batch.data);
+    return IPX_ERR_DENIED;
+}
+
+/**
+ * \brief Destroy the listener structure of the instance
+ *
+ * The listening socket is closed and its file is removed. The timer and epoll are destroyed too.
+ * \param[in] instance Instance data
+ */
+static void
+listener_destroy(struct ux_data *instance)
+{
+    close(instance->listen.sd);
+    unlink(instance->config->path);
+    close(instance->listen.epoll_fd);
+    close(instance->listen.timer_fd);
+    free(instance->batch.data);
+}
+
+/**
+ * \brief Get the name of a process
+ * \param[in]  pid  Process ID
+ * \param[out] name Buffer for the name (at least #UX_COMM_LEN bytes)
+ * \return True on success, false if the process doesn't exist (anymore) or its name is unknown.
+ */
+static bool
+process_name(pid_t pid, char *name)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%ld/comm", (long) pid);
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    bool ret = (fgets(name, UX_COMM_LEN, f) != NULL);
+    fclose(f);
+    if (!ret) {
+        return false;
+    }
+
+    name[strcspn(name, "\n")] = '\0';
+    return name[0] != '\0';
+}
+
+/**
+ * \brief Create identification of a local exporter
+ *
+ * If the credentials match a named exporter of the configuration, its name is used. Otherwise,
+ * the identification consists of the name of the process (if known) and its process ID.
+ * \param[in]  instance Instance data
+ * \param[in]  cred     Credentials of the exporting process
+ * \param[out] ident    Buffer for the identification
+ * \param[in]  size     Size of the buffer
+ */
+static void
+source_ident(const struct ux_data *instance, const struct ucred *cred, char *ident, size_t size)
+{
+    char comm[UX_COMM_LEN];
+    const bool comm_valid = process_name(cred->pid, comm);
+
+    const struct ux_config *cfg = instance->config;
+    for (size_t i = 0; i < cfg->exporters.cnt; ++i) {
+        const struct ux_exporter *exp = &cfg->exporters.items[i];
+        if (exp->uid_set && exp->uid != cred->uid) {
+            continue;
+        }
+
+        if (exp->process != NULL && (!comm_valid || strcmp(exp->process, comm) != 0)) {
+            continue;
+        }
+
+        snprintf(ident, size, "%s (pid %ld)", exp->name, (long) cred->pid);
+        return;
+    }
+
+    if (comm_valid) {
+        snprintf(ident, size, "%s (pid %ld)", comm, (long) cred->pid);
+    } else {
+        snprintf(ident, size, "pid %ld", (long) cred->pid);
+    }
+}
+
+/**
+ * \brief Add a new record of a Transport Session
+ *
+ * New record is added into the list of active connections. The Transport Session is described
+ * as a UDP session (i.e. templates are managed as in the case of UDP) from the loopback address
+ * and the source port is equal to the (truncated) process ID of the exporter.
+ * \param[in] instance Instance data
+ * \param[in] fd       Connected socket (SOCK_SEQPACKET) or #INVALID_FD
+ * \param[in] cred     Credentials of the exporting process
+ * \return Pointer to the newly added record or NULL (memory allocation error)
+ */
+static struct ux_source *
+active_add(struct ux_data *instance, int fd, const struct ucred *cred)
+{
+    struct ipx_session_net net;
+    memset(&net, 0, sizeof(net));
+    net.l3_proto = AF_INET;
+    net.addr_src.ipv4.s_addr = htonl(INADDR_LOOPBACK);
+    net.addr_dst.ipv4.s_addr = htonl(INADDR_LOOPBACK);
+    net.port_src = (uint16_t) cred->pid;
+    net.port_dst = 0;
+
+    char ident[128];
+    source_ident(instance, cred, ident, sizeof(ident));
+
+    const struct ux_config *cfg = instance->config;
+    struct ipx_session *session = ipx_session_new_udp_named(&net, ident, cfg->lifetime_data,
+        cfg->lifetime_opts);
+    if (!session) {
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a Transport Session description of '%s'.",
+            ident);
+        return NULL;
+    }
+
+    // Create a new record
+    struct ux_source *rec2add = calloc(1, sizeof(*rec2add));
+    if (!rec2add) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    rec2add->fd = fd;
+    rec2add->cred = *cred;
+    rec2add->session = session;
+    rec2add->last_seen = time(NULL); // now!
+    rec2add->msg_cnt = 0;
+    rec2add->new_connection = true; // Session Message hasn't been send yet
+
+    // Append the list of active connections
+    const size_t new_size = (instance->active.cnt + 1) * sizeof(struct ux_source *);
+    struct ux_source **new_sources = realloc(instance->active.sources, new_size);
+    if (!new_sources) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(rec2add);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "New exporter connected: '%s' (uid %ld).", session->ident,
+        (long) cred->uid);
+    new_sources[instance->active.cnt] = rec2add;
+    instance->active.sources = new_sources;
+    instance->active.cnt++;
+    return rec2add;
+}
+
+/**
+ * \brief Remove an active Transport Session with a given index
+ *
+ * Generate and pass a Session Message - close event (if necessary), close the connected socket
+ * (if any) and remove the corresponding session (defined by an index) from the list.
+ * \param[in] instance Instance data
+ * \param[in] idx      Index of the instance to remove
+ */
+static void
+active_remove_by_id(struct ux_data *instance, size_t idx)
+{
+    struct ux_source *src = instance->active.sources[idx];
+    IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
+
+    if (src->fd != INVALID_FD) {
+        epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+        close(src->fd);
+    }
+
+    // Have we received at least one valid record?
+    if (src->new_connection) {
+        // No messages have been passed with a reference to this session -> destroy immediately
+        ipx_session_destroy(src->session);
+    } else {
+        // Generate a Session message (order of the messages MUST be preserved)
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(src->session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the closed Transport Session '%s' (%s:%d)",
+                src->session->ident, __FILE__, __LINE__);
+            // Do not pass and definitely do NOT free the session structure (see UDP plugin)
+        } else {
+            // Pass the message and put the Session into the garbage
+            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg_sess));
+
+            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(src->session, cb);
+            if (!msg_garbage) {
+                IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            } else {
+                ipx_ctx_msg_pass(instance->ctx, ipx_msg_garbage2base(msg_garbage));
+            }
+        }
+    }
+
+    // Now we can free the wrapper and replace it with the last one
+    free(src);
+    instance->active.sources[idx] = instance->active.sources[instance->active.cnt - 1];
+    instance->active.cnt--;
+}
+
+/**
+ * \brief Find an index of an active Transport Session by its connected socket
+ * \param[in] instance Instance data
+ * \param[in] fd       Connected socket
+ * \return Index of the session or a value equal to the number of active sessions (not found)
+ */
+static size_t
+active_find_fd(const struct ux_data *instance, int fd)
+{
+    size_t idx;
+    for (idx = 0; idx < instance->active.cnt; ++idx) {
+        if (instance->active.sources[idx]->fd == fd) {
+            break;
+        }
+    }
+
+    return idx;
+}
+
+/**
+ * \brief Get a reference to a Transport Session of a datagram sender
+ *
+ * First, try to find in among already active Transport Sessions. If it is not present, create
+ * a new one and store it into the array of active Sessions.
+ * \param[in] instance Instance data
+ * \param[in] cred     Credentials of the sender
+ * \return Pointer to the Session or NULL (typically memory allocation error)
+ */
+static struct ux_source *
+active_get(struct ux_data *instance, const struct ucred *cred)
+{
+    for (size_t idx = 0; idx < instance->active.cnt; ++idx) {
+        struct ux_source *src = instance->active.sources[idx];
+        if (src->cred.pid == cred->pid && src->cred.uid == cred->uid) {
+            return src;
+        }
+    }
+
+    // Not found, add a new record
+    return active_add(instance, INVALID_FD, cred);
+}
+
+/**
+ * \brief Process a timer event
+ *
+ * Close inactive Transport Sessions of datagram senders. Sessions of connected sockets are
+ * closed only when the exporter closes the connection.
+ * \param[in] instance Instance data
+ * \param[in] fd       File descriptor of a timer
+ */
+static void
+process_timer(struct ux_data *instance, int fd)
+{
+    assert(fd == instance->listen.timer_fd);
+    // Read the event
+    uint64_t event_cnt;
+    ssize_t ret = read(fd, &event_cnt, sizeof(event_cnt));
+    if (ret == -1 || ((size_t) ret) != sizeof(event_cnt)) {
+        int error_code = (ret == -1) ? errno : EINTR;
+        const char *err_str;
+        ipx_strerror(error_code, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Unable to get status of a timer, read() failed: %s", err_str);
+        return;
+    }
+
+    const time_t now = time(NULL);
+    size_t idx = 0;
+    while (idx < instance->active.cnt) {
+        struct ux_source *src = instance->active.sources[idx];
+        if (src->msg_cnt != 0) {
+            // Still active
+            src->last_seen = now;
+            src->msg_cnt = 0;
+        }
+
+        if (src->fd != INVALID_FD || src->last_seen + instance->config->timeout_conn >= now) {
+            idx++;
+            continue;
+        }
+
+        // Remove and generate Session message - close event, if necessary
+        active_remove_by_id(instance, idx);
+    }
+
+    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
+        instance->active.cnt);
+}
+
+/**
+ * \brief Accept a new connection of an exporter (SOCK_SEQPACKET only)
+ * \param[in] instance Instance data
+ */
+static void
+process_accept(struct ux_data *instance)
+{
+    const char *err_str;
+    int fd = accept4(instance->listen.sd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == INVALID_FD) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        }
+
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to accept a new connection. accept4() failed: %s",
+            err_str);
+        return;
+    }
+
+    struct ucred cred;
+    socklen_t cred_len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Unable to get credentials of a new connection. "
+            "getsockopt() failed: %s", err_str);
+        close(fd);
+        return;
+    }
+
+    if (active_add(instance, fd, &cred) == NULL) {
+        close(fd);
+        return;
+    }
+
+    if (epoll_add(instance, fd, EPOLLIN | EPOLLRDHUP) != IPX_OK) {
+        // The session is the last one in the array and it will close the socket
+        active_remove_by_id(instance, instance->active.cnt - 1);
+    }
+}
+
+/**
+ * \brief Pass an IPFIX/NetFlow message of a Transport Session
+ *
+ * The content of the receive buffer is copied into a new buffer of the exact size because
+ * the message is passed to other plugins and the receive buffer is reused.
+ * \param[in] instance Instance data
+ * \param[in] source   Transport Session
+ * \param[in] data     Receive buffer with the message
+ * \param[in] size     Size of the message
+ */
+static void
+process_msg(struct ux_data *instance, struct ux_source *source, const uint8_t *data,
+    size_t size)
+{
+    if (size < sizeof(uint16_t)) {
+        IPX_CTX_WARNING(instance->ctx, "Received an invalid message (%zu bytes long) from '%s'",
+            size, source->session->ident);
+        return;
+    }
+
+    // Check NetFlow/IPFIX header length and extract ODID/Source ID
+    const uint16_t msg_ver = ntohs(*(const uint16_t *) data);
+    uint32_t msg_odid = 0;
+    bool is_len_ok = true;
+
+    switch (msg_ver) {
+    case FDS_IPFIX_VERSION: // IPFIX
+        if (size < FDS_IPFIX_MSG_HDR_LEN) {
+            is_len_ok = false;
+            break;
+        }
+
+        msg_odid = ntohl(((const struct fds_ipfix_msg_hdr *) data)->odid);
+        break;
+    case NF9_HDR_VERSION: // NetFlow v9
+        if (size < NF9_HDR_LEN) {
+            is_len_ok = false;
+            break;
+        }
+
+        msg_odid = ntohl(((const struct nf9_msg_hdr *) data)->source_id);
+        break;
+    case NF5_HDR_VERSION: // NetFlow v5
+        if (size < NF5_HDR_LEN) {
+            is_len_ok = false;
+            break;
+        }
+
+        // Source ID is not available in NetFlow v5 -> always 0
+        msg_odid = 0;
+        break;
+    default:
+        is_len_ok = false;
+        break;
+    }
+
+    if (!is_len_ok) {
+        IPX_CTX_ERROR(instance->ctx, "Received an invalid NetFlow/IPFIX Message header from '%s'. "
+            "The message will be dropped!", source->session->ident);
+        return;
+    }
+
+    if (!ipx_ctx_odid_wanted(instance->ctx, msg_odid)) {
+        // No output instance processes the Observation Domain
+        return;
+    }
+
+    uint8_t *buffer = malloc(size * sizeof(uint8_t));
+    if (!buffer) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+    memcpy(buffer, data, size);
+
+    if (source->new_connection) {
+        // Send information about the new Transport Session
+        source->new_connection = false;
+        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
+                source->session->ident, __FILE__, __LINE__);
+        } else {
+            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg));
+        }
+    }
+
+    // Create a message wrapper and pass the message
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = source->session;
+    msg_ctx.odid = msg_odid;
+    msg_ctx.stream = 0; // Streams are not supported
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, (uint16_t) size);
+    if (!msg) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(buffer);
+        return;
+    }
+
+    ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
+    source->msg_cnt++;
+}
+
+/**
+ * \brief Get credentials of the sender of a datagram
+ * \param[in]  hdr  Message header filled by recvmmsg()
+ * \param[out] cred Credentials
+ * \return True on success, false if the credentials are not available.
+ */
+static bool
+msg_cred(struct msghdr *hdr, struct ucred *cred)
+{
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_CREDENTIALS) {
+            continue;
+        }
+
+        memcpy(cred, CMSG_DATA(cmsg), sizeof(*cred));
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Receive a batch of IPFIX/NetFlow messages from a socket and pass them
+ *
+ * In case of the datagram socket, each message is assigned to a Transport Session based on
+ * credentials of the sending process. In case of a connected sequenced-packet socket, all
+ * messages belong to the session of the connection. Zero-length messages are returned when
+ * the exporter has closed the connection.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ * \param[in] events   Epoll events of the socket
+ */
+static void
+process_socket(struct ux_data *instance, int sd, uint32_t events)
+{
+    const char *err_str;
+    size_t conn_idx = instance->active.cnt;
+    struct ux_source *conn = NULL;
+
+    if (sd != instance->listen.sd) {
+        // Connected socket of an exporter
+        conn_idx = active_find_fd(instance, sd);
+        if (conn_idx == instance->active.cnt) {
+            IPX_CTX_ERROR(instance->ctx, "Received data on an unknown socket! (%s:%d)",
+                __FILE__, __LINE__);
+            return;
+        }
+        conn = instance->active.sources[conn_idx];
+    }
+
+    const bool hangup = (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+    batch_reset(instance, conn == NULL);
+    int ret = recvmmsg(sd, instance->batch.hdrs, UX_BATCH, MSG_DONTWAIT, NULL);
+    if (ret == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(instance->ctx, "Failed to receive messages. recvmmsg() failed: %s",
+                err_str);
+        } else if (!hangup) {
+            return;
+        }
+
+        if (conn != NULL) {
+            active_remove_by_id(instance, conn_idx);
+        }
+        return;
+    }
+
+    bool eof = false;
+    for (int i = 0; i < ret; ++i) {
+        struct mmsghdr *mhdr = &instance->batch.hdrs[i];
+        const uint8_t *data = instance->batch.iovs[i].iov_base;
+        const size_t size = mhdr->msg_len;
+
+        if (size == 0) {
+            eof = true;
+            continue;
+        }
+
+        if ((mhdr->msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            IPX_CTX_WARNING(instance->ctx, "Received a message larger than %d bytes. The message "
+                "will be dropped!", UX_BUFFER_SIZE);
+            continue;
+        }
+
+        struct ux_source *source = conn;
+        if (source == NULL) {
+            struct ucred cred;
+            if (!msg_cred(&mhdr->msg_hdr, &cred)) {
+                IPX_CTX_WARNING(instance->ctx, "Received a message without credentials of the "
+                    "sender. The message will be dropped!", '\0');
+                continue;
+            }
+
+            source = active_get(instance, &cred);
+            if (!source) { // Memory allocation error!
+                continue;
+            }
+        }
+
+        process_msg(instance, source, data, size);
+    }
+
+    if (conn != NULL && eof && hangup) {
+        // All messages before the end of the connection have been processed
+        active_remove_by_id(instance, conn_idx);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct ux_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = ctx;
+    data->active.cnt = 0;
+    data->active.sources = NULL;
+    data->listen.timeout = (ipx_ctx_busy_poll_get(ctx) > 0) ? 0 : GETTER_TIMEOUT;
+
+    // Parse configuration
+    data->config = config_parse(ctx, params);
+    if (!data->config) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Bind to the path and arm a timer
+    if (listener_init(data) != IPX_OK) {
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct ux_data *data = (struct ux_data *) cfg;
+
+    // Close all Transport Session (this generates Session messages per each active Session)
+    while (data->active.cnt > 0) {
+        active_remove_by_id(data, 0);
+    }
+    free(data->active.sources);
+
+    // Close the listening socket and disarm the timer
+    listener_destroy(data);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    struct ux_data *data = (struct ux_data *) cfg;
+
+    // Process messages from up to 16 sockets (including the timer)
+    struct epoll_event ev[GETTER_MAX_EVENTS];
+    int ev_valid = epoll_wait(data->listen.epoll_fd, ev, GETTER_MAX_EVENTS, data->listen.timeout);
+    if (ev_valid == -1) {
+        // Failed
+        int error_code = errno;
+        const char *err_str;
+        ipx_strerror(error_code, err_str);
+        IPX_CTX_ERROR(ctx, "epoll_wait() failed: %s", err_str);
+        if (error_code == EINTR) {
+            return IPX_OK;
+        }
+        // Fatal error -> stop the plugin
+        return IPX_ERR_DENIED;
+    }
+
+    // Process all events
+    assert(ev_valid >= 0 && ev_valid <= GETTER_MAX_EVENTS);
+    for (int i = 0; i < ev_valid; ++i) {
+        int fd = ev[i].data.fd;
+
+        if (fd == data->listen.timer_fd) {
+            // Timer event
+            process_timer(data, fd);
+            continue;
+        }
+
+        if (fd == data->listen.sd && data->config->type == UX_TYPE_SEQPACKET) {
+            // New connection
+            process_accept(data);
+            continue;
+        }
+
+        process_socket(data, fd, ev[i].events);
+    }
+
+    return IPX_OK;
+}
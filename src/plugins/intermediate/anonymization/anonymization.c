@@ -55,8 +55,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "anonymization",
     // Brief description of plugin
     .dsc = "IPv4/IPv6 address anonymization plugin",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (IP addresses are modified in place)
+    .flags = IPX_PF_MSG_MODIFY,
     // Plugin version string (like "1.2.3")
     .version = "2.0.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -189,6 +189,9 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
     }
 
+    // Flow keys derived by previous plugins (if any) don't match the modified records
+    ipx_msg_ipfix_flow_info_reset(ipfix_msg);
+
     // Always pass the message
     ipx_ctx_msg_pass(ctx, msg);
     return IPX_OK;
@@ -0,0 +1,615 @@
+/**
+ * \file src/plugins/intermediate/classifier/automaton.c
+ * \author agent <agent@local>
+ * \brief Aho-Corasick automaton for multi-pattern matching (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "automaton.h"
+
+/** Undefined state/key/edge                                          */
+#define AC_NONE UINT32_MAX
+/** Index of the root state                                           */
+#define AC_ROOT 0U
+/** Number of input symbols                                           */
+#define AC_SYMS 256U
+/** Class of symbols that don't occur in any pattern                  */
+#define AC_CLASS_OTHER 0U
+/** Number of edges of a state that are searched linearly             */
+#define AC_LINEAR_MAX 8U
+/** Memory limit of full transition tables (bytes)                    */
+#define AC_DENSE_SIZE (1024U * 1024U)
+
+/** State of the trie under construction */
+struct ac_bstate {
+    /** Key of the pattern that ends in the state (#AC_NONE == none)   */
+    uint32_t key;
+    /** The first edge of the state (#AC_NONE == none)                 */
+    uint32_t edge;
+};
+
+/** Edge of the trie under construction */
+struct ac_bedge {
+    /** Target state                                                   */
+    uint32_t target;
+    /** The next edge of the same source state (#AC_NONE == none)      */
+    uint32_t sibling;
+    /** Symbol (already folded)                                        */
+    uint8_t sym;
+};
+
+struct ac_builder {
+    /** States (the first one is the root)                             */
+    struct ac_bstate *states;
+    /** Number of states                                               */
+    size_t states_cnt;
+    /** Number of allocated states                                     */
+    size_t states_alloc;
+    /** Edges                                                          */
+    struct ac_bedge *edges;
+    /** Number of edges                                                */
+    size_t edges_cnt;
+    /** Number of allocated edges                                      */
+    size_t edges_alloc;
+    /** Symbols used by patterns                                       */
+    bool used[AC_SYMS];
+};
+
+/** State of the compiled automaton */
+struct ac_state {
+    /** Failure link (the longest proper suffix that is a prefix of a pattern) */
+    uint32_t fail;
+    /** The nearest state on the chain of failure links with a key (#AC_NONE == none) */
+    uint32_t dict;
+    /** Key of the pattern that ends in the state (#AC_NONE == none)   */
+    uint32_t key;
+    /** Index of the first edge of the state                           */
+    uint32_t edges;
+    /** Number of edges of the state                                   */
+    uint32_t edges_cnt;
+};
+
+struct ac_automaton {
+    /** Classes of input symbols (case-insensitive)                    */
+    uint8_t classes[AC_SYMS];
+    /** Number of classes (including #AC_CLASS_OTHER)                  */
+    uint32_t classes_cnt;
+
+    /** States in breadth-first order (the first one is the root)      */
+    struct ac_state *states;
+    /** Number of states                                               */
+    size_t states_cnt;
+    /** Classes of edges (edges of each state are sorted by class)     */
+    uint8_t *edge_class;
+    /** Target states of edges                                         */
+    uint32_t *edge_target;
+
+    /**
+     * Full transition tables of the states closest to the root (i.e. the first states in
+     * breadth-first order). The table of the state N starts at index N * classes_cnt.
+     */
+    uint32_t *dense;
+    /** Number of states with a full transition table                  */
+    size_t dense_cnt;
+};
+
+/**
+ * \brief Convert a symbol to lower case (ASCII only)
+ * \param[in] sym Symbol
+ */
+static inline uint8_t
+ac_fold(uint8_t sym)
+{
+    return (sym >= 'A' && sym <= 'Z') ? (uint8_t) (sym + ('a' - 'A')) : sym;
+}
+
+/**
+ * \brief Initialize the builder (only the root state)
+ * \param[in] builder Builder
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+ac_builder_init(ac_builder_t *builder)
+{
+    memset(builder, 0, sizeof(*builder));
+    builder->states = malloc(sizeof(*builder->states));
+    if (!builder->states) {
+        return IPX_ERR_NOMEM;
+    }
+
+    builder->states[AC_ROOT].key = AC_NONE;
+    builder->states[AC_ROOT].edge = AC_NONE;
+    builder->states_cnt = builder->states_alloc = 1;
+    return IPX_OK;
+}
+
+/**
+ * \brief Release the content of the builder
+ * \param[in] builder Builder
+ */
+static void
+ac_builder_clear(ac_builder_t *builder)
+{
+    free(builder->states);
+    free(builder->edges);
+    memset(builder, 0, sizeof(*builder));
+}
+
+ac_builder_t *
+ac_builder_create()
+{
+    ac_builder_t *builder = malloc(sizeof(*builder));
+    if (!builder) {
+        return NULL;
+    }
+
+    if (ac_builder_init(builder) != IPX_OK) {
+        free(builder);
+        return NULL;
+    }
+
+    return builder;
+}
+
+void
+ac_builder_destroy(ac_builder_t *builder)
+{
+    ac_builder_clear(builder);
+    free(builder);
+}
+
+/**
+ * \brief Add a new state with an incoming edge to the trie
+ * \param[in]  builder Builder
+ * \param[in]  parent  Source state of the edge
+ * \param[in]  sym     Symbol of the edge
+ * \param[out] state   New state
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (or too many states)
+ */
+static int
+ac_builder_state_add(ac_builder_t *builder, uint32_t parent, uint8_t sym, uint32_t *state)
+{
+    if (builder->states_cnt >= AC_NONE - 1) {
+        return IPX_ERR_NOMEM;
+    }
+
+    if (builder->states_cnt == builder->states_alloc) {
+        const size_t alloc_new = 2 * builder->states_alloc;
+        struct ac_bstate *states_new = realloc(builder->states, alloc_new * sizeof(*states_new));
+        if (!states_new) {
+            return IPX_ERR_NOMEM;
+        }
+        builder->states = states_new;
+        builder->states_alloc = alloc_new;
+    }
+
+    if (builder->edges_cnt == builder->edges_alloc) {
+        const size_t alloc_new = (builder->edges_alloc != 0) ? 2 * builder->edges_alloc : 256;
+        struct ac_bedge *edges_new = realloc(builder->edges, alloc_new * sizeof(*edges_new));
+        if (!edges_new) {
+            return IPX_ERR_NOMEM;
+        }
+        builder->edges = edges_new;
+        builder->edges_alloc = alloc_new;
+    }
+
+    const uint32_t new_state = (uint32_t) builder->states_cnt++;
+    builder->states[new_state].key = AC_NONE;
+    builder->states[new_state].edge = AC_NONE;
+
+    // The new edge is the first one, so the next lookup of sorted patterns is fast
+    const uint32_t new_edge = (uint32_t) builder->edges_cnt++;
+    struct ac_bedge *edge = &builder->edges[new_edge];
+    edge->target = new_state;
+    edge->sym = sym;
+    edge->sibling = builder->states[parent].edge;
+    builder->states[parent].edge = new_edge;
+    builder->used[sym] = true;
+
+    *state = new_state;
+    return IPX_OK;
+}
+
+int
+ac_builder_add(ac_builder_t *builder, const uint8_t *data, size_t len, uint32_t key)
+{
+    if (len == 0) {
+        return IPX_ERR_ARG;
+    }
+
+    if (!builder->states) {
+        // Reinitialization after the last compilation failed
+        return IPX_ERR_NOMEM;
+    }
+
+    uint32_t state = AC_ROOT;
+    for (size_t i = 0; i < len; ++i) {
+        const uint8_t sym = ac_fold(data[i]);
+        uint32_t edge = builder->states[state].edge;
+        while (edge != AC_NONE && builder->edges[edge].sym != sym) {
+            edge = builder->edges[edge].sibling;
+        }
+
+        if (edge != AC_NONE) {
+            state = builder->edges[edge].target;
+            continue;
+        }
+
+        int rc = ac_builder_state_add(builder, state, sym, &state);
+        if (rc != IPX_OK) {
+            return rc;
+        }
+    }
+
+    if (builder->states[state].key != AC_NONE) {
+        return IPX_ERR_EXISTS;
+    }
+
+    builder->states[state].key = key;
+    return IPX_OK;
+}
+
+/**
+ * \brief Find a target state of an edge of a state
+ * \param[in] ac    Automaton
+ * \param[in] state State
+ * \param[in] cls   Class of the input symbol
+ * \return Target state or #AC_NONE
+ */
+static inline uint32_t
+ac_edge_find(const ac_automaton_t *ac, const struct ac_state *state, uint8_t cls)
+{
+    const uint8_t *classes = &ac->edge_class[state->edges];
+    const uint32_t *targets = &ac->edge_target[state->edges];
+    uint32_t low = 0;
+    uint32_t high = state->edges_cnt;
+
+    if (high <= AC_LINEAR_MAX) {
+        for (uint32_t i = 0; i < high; ++i) {
+            if (classes[i] == cls) {
+                return targets[i];
+            }
+        }
+        return AC_NONE;
+    }
+
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (classes[mid] == cls) {
+            return targets[mid];
+        }
+
+        if (classes[mid] < cls) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return AC_NONE;
+}
+
+/**
+ * \brief Get the next state of the automaton
+ *
+ * Failure links always lead to shallower states, so the search usually ends in a state
+ * with a full transition table.
+ * \param[in] ac    Automaton
+ * \param[in] state Current state
+ * \param[in] cls   Class of the input symbol
+ * \return Next state
+ */
+static inline uint32_t
+ac_next(const ac_automaton_t *ac, uint32_t state, uint8_t cls)
+{
+    while (true) {
+        if (state < ac->dense_cnt) {
+            return ac->dense[state * ac->classes_cnt + cls];
+        }
+
+        const struct ac_state *ptr = &ac->states[state];
+        uint32_t target;
+        if (ptr->edges_cnt != 0 && (target = ac_edge_find(ac, ptr, cls)) != AC_NONE) {
+            return target;
+        }
+
+        if (state == AC_ROOT) {
+            return AC_ROOT;
+        }
+        state = ptr->fail;
+    }
+}
+
+/**
+ * \brief Compare symbols of edges (for qsort)
+ */
+static int
+ac_bedge_cmp(const void *p1, const void *p2)
+{
+    const struct ac_bedge *edge1 = p1;
+    const struct ac_bedge *edge2 = p2;
+    return (int) edge1->sym - (int) edge2->sym;
+}
+
+/**
+ * \brief Assign classes to input symbols
+ *
+ * Each symbol used by patterns has its own class (upper case letters share the class with
+ * lower case letters). All other symbols share #AC_CLASS_OTHER, which always leads to the root.
+ * Classes are assigned in order of symbols, so the order of edges is preserved.
+ * \param[in] builder Builder
+ * \param[in] ac      Automaton
+ */
+static void
+ac_build_classes(const ac_builder_t *builder, ac_automaton_t *ac)
+{
+    uint32_t cnt = AC_CLASS_OTHER + 1;
+    for (uint32_t sym = 0; sym < AC_SYMS; ++sym) {
+        ac->classes[sym] = (builder->used[sym]) ? (uint8_t) cnt++ : AC_CLASS_OTHER;
+    }
+
+    for (uint32_t sym = 'A'; sym <= 'Z'; ++sym) {
+        ac->classes[sym] = ac->classes[ac_fold((uint8_t) sym)];
+    }
+
+    ac->classes_cnt = cnt;
+}
+
+/**
+ * \brief Get the breadth-first order of states of the trie
+ * \param[in]  builder Builder
+ * \param[out] order   Indexes of states of the builder in breadth-first order
+ * \param[out] map     Mapping of indexes of states of the builder to the order
+ */
+static void
+ac_build_order(const ac_builder_t *builder, uint32_t *order, uint32_t *map)
+{
+    size_t head = 0;
+    size_t tail = 0;
+    order[tail++] = AC_ROOT;
+
+    while (head < tail) {
+        const uint32_t idx = order[head];
+        map[idx] = (uint32_t) head++;
+
+        const struct ac_bstate *bstate = &builder->states[idx];
+        for (uint32_t edge = bstate->edge; edge != AC_NONE; edge = builder->edges[edge].sibling) {
+            order[tail++] = builder->edges[edge].target;
+        }
+    }
+}
+
+/**
+ * \brief Convert the trie of the builder to states and sorted edges of the automaton
+ *
+ * States are stored in breadth-first order, so the states close to the root, which are
+ * visited most often, are next to each other.
+ * \param[in] builder Builder
+ * \param[in] ac      Automaton (arrays of states and edges must be allocated)
+ * \param[in] order   Indexes of states of the builder in breadth-first order
+ * \param[in] map     Mapping of indexes of states of the builder to the order
+ */
+static void
+ac_build_trie(const ac_builder_t *builder, ac_automaton_t *ac, const uint32_t *order,
+    const uint32_t *map)
+{
+    struct ac_bedge tmp[AC_SYMS];
+    uint32_t edges_cnt = 0;
+
+    for (uint32_t i = 0; i < builder->states_cnt; ++i) {
+        const struct ac_bstate *bstate = &builder->states[order[i]];
+        struct ac_state *state = &ac->states[i];
+        state->fail = AC_ROOT;
+        state->dict = AC_NONE;
+        state->key = bstate->key;
+        state->edges = edges_cnt;
+
+        // Each symbol has at most one edge, therefore, the array cannot overflow
+        uint32_t cnt = 0;
+        for (uint32_t edge = bstate->edge; edge != AC_NONE; edge = builder->edges[edge].sibling) {
+            tmp[cnt++] = builder->edges[edge];
+        }
+
+        qsort(tmp, cnt, sizeof(*tmp), &ac_bedge_cmp);
+        for (uint32_t e = 0; e < cnt; ++e) {
+            ac->edge_class[edges_cnt + e] = ac->classes[tmp[e].sym];
+            ac->edge_target[edges_cnt + e] = map[tmp[e].target];
+        }
+
+        state->edges_cnt = cnt;
+        edges_cnt += cnt;
+    }
+}
+
+/**
+ * \brief Fill the full transition table of the next state
+ *
+ * Failure links of the state must be already known.
+ * \param[in] ac Automaton
+ */
+static void
+ac_build_dense(ac_automaton_t *ac)
+{
+    const uint32_t state = (uint32_t) ac->dense_cnt;
+    const struct ac_state *ptr = &ac->states[state];
+    uint32_t *table = &ac->dense[state * ac->classes_cnt];
+
+    table[AC_CLASS_OTHER] = AC_ROOT;
+    for (uint32_t cls = AC_CLASS_OTHER + 1; cls < ac->classes_cnt; ++cls) {
+        uint32_t target = ac_edge_find(ac, ptr, (uint8_t) cls);
+        if (target == AC_NONE) {
+            target = (state == AC_ROOT) ? AC_ROOT : ac_next(ac, ptr->fail, (uint8_t) cls);
+        }
+        table[cls] = target;
+    }
+
+    // Failure links lead to shallower states, which already have their tables
+    ac->dense_cnt++;
+}
+
+/**
+ * \brief Compute failure and dictionary links of all states
+ *
+ * States are processed in breadth-first order, therefore, the failure link of a state
+ * always refers to an already processed state.
+ * \param[in] ac Automaton
+ */
+static void
+ac_build_links(ac_automaton_t *ac)
+{
+    for (uint32_t parent = 0; parent < ac->states_cnt; ++parent) {
+        const struct ac_state *parent_ptr = &ac->states[parent];
+
+        for (uint32_t e = 0; e < parent_ptr->edges_cnt; ++e) {
+            const uint32_t child = ac->edge_target[parent_ptr->edges + e];
+            const uint8_t cls = ac->edge_class[parent_ptr->edges + e];
+            struct ac_state *child_ptr = &ac->states[child];
+
+            // Links of shallower states are already known
+            uint32_t fail = AC_ROOT;
+            if (parent != AC_ROOT) {
+                fail = ac_next(ac, parent_ptr->fail, cls);
+            }
+
+            const struct ac_state *fail_ptr = &ac->states[fail];
+            child_ptr->fail = fail;
+            child_ptr->dict = (fail_ptr->key != AC_NONE) ? fail : fail_ptr->dict;
+        }
+    }
+}
+
+ac_automaton_t *
+ac_builder_build(ac_builder_t *builder)
+{
+    const size_t states_cnt = builder->states_cnt;
+    const size_t edges_cnt = builder->edges_cnt;
+
+    ac_automaton_t *ac = calloc(1, sizeof(*ac));
+    uint32_t *order = malloc(states_cnt * sizeof(*order));
+    uint32_t *map = malloc(states_cnt * sizeof(*map));
+    if (!ac || !order || !map) {
+        free(ac);
+        free(order);
+        free(map);
+        return NULL;
+    }
+
+    ac->states_cnt = states_cnt;
+    ac->states = malloc(states_cnt * sizeof(*ac->states));
+    // Allocate at least one item even if there are no edges
+    ac->edge_class = malloc(edges_cnt + 1);
+    ac->edge_target = malloc((edges_cnt + 1) * sizeof(*ac->edge_target));
+    if (!ac->states || !ac->edge_class || !ac->edge_target) {
+        free(order);
+        free(map);
+        ac_destroy(ac);
+        return NULL;
+    }
+
+    ac_build_order(builder, order, map);
+    ac_build_classes(builder, ac);
+    ac_build_trie(builder, ac, order, map);
+    ac_build_links(ac);
+    free(order);
+    free(map);
+
+    // Full transition tables of the first states in breadth-first order
+    size_t dense_cnt = AC_DENSE_SIZE / (ac->classes_cnt * sizeof(*ac->dense));
+    dense_cnt = (dense_cnt < states_cnt) ? dense_cnt : states_cnt;
+    ac->dense = malloc(dense_cnt * ac->classes_cnt * sizeof(*ac->dense));
+    if (!ac->dense) {
+        ac_destroy(ac);
+        return NULL;
+    }
+
+    while (ac->dense_cnt < dense_cnt) {
+        ac_build_dense(ac);
+    }
+
+    // Make the builder reusable (if it fails, the next insertion fails)
+    ac_builder_clear(builder);
+    (void) ac_builder_init(builder);
+    return ac;
+}
+
+void
+ac_destroy(ac_automaton_t *ac)
+{
+    free(ac->states);
+    free(ac->edge_class);
+    free(ac->edge_target);
+    free(ac->dense);
+    free(ac);
+}
+
+size_t
+ac_states_cnt(const ac_automaton_t *ac)
+{
+    return ac->states_cnt;
+}
+
+void
+ac_match(const ac_automaton_t *ac, const uint8_t *data, size_t len, ac_match_cb cb, void *arg)
+{
+    uint32_t state = AC_ROOT;
+
+    for (size_t i = 0; i < len; ++i) {
+        const uint8_t cls = ac->classes[data[i]];
+        if (cls == AC_CLASS_OTHER) {
+            // The symbol is not part of any pattern
+            state = AC_ROOT;
+            continue;
+        }
+
+        state = ac_next(ac, state, cls);
+        const struct ac_state *ptr = &ac->states[state];
+        if (ptr->key != AC_NONE) {
+            cb(ptr->key, i, arg);
+        }
+
+        for (uint32_t dict = ptr->dict; dict != AC_NONE; dict = ac->states[dict].dict) {
+            cb(ac->states[dict].key, i, arg);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * \file src/plugins/intermediate/classifier/automaton.h
+ * \author agent <agent@local>
+ * \brief Aho-Corasick automaton for multi-pattern matching (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CLASSIFIER_AUTOMATON_H
+#define CLASSIFIER_AUTOMATON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \defgroup clAutomaton Multi-pattern automaton
+ * \brief Aho-Corasick automaton that finds all occurrences of many patterns in one pass
+ *
+ * Patterns are matched case-insensitively (only ASCII letters are folded). States close to
+ * the root, which are visited most often, have full transition tables. Other states have only
+ * sorted arrays of edges, so the automaton remains compact even for hundreds of thousands of
+ * patterns.
+ * @{
+ */
+
+/** Builder of an automaton   */
+typedef struct ac_builder ac_builder_t;
+/** Compiled automaton        */
+typedef struct ac_automaton ac_automaton_t;
+
+/**
+ * \brief Callback called for each occurrence of a pattern
+ * \param[in] key  Key of the pattern (see ac_builder_add())
+ * \param[in] end  Position of the last byte of the occurrence in the data
+ * \param[in] arg  User defined argument
+ */
+typedef void (*ac_match_cb)(uint32_t key, size_t end, void *arg);
+
+/**
+ * \brief Create a builder of an automaton
+ * \return Pointer to the builder or NULL (memory allocation error)
+ */
+ac_builder_t *
+ac_builder_create();
+
+/**
+ * \brief Destroy a builder
+ * \param[in] builder Builder
+ */
+void
+ac_builder_destroy(ac_builder_t *builder);
+
+/**
+ * \brief Add a pattern
+ *
+ * Patterns are inserted faster if they are added in lexicographical order.
+ * \param[in] builder Builder
+ * \param[in] data    Pattern
+ * \param[in] len     Length of the pattern (non-zero)
+ * \param[in] key     Key reported when the pattern is found
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the pattern is empty
+ * \return #IPX_ERR_EXISTS if the same pattern (case-insensitively) has been already added
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+ac_builder_add(ac_builder_t *builder, const uint8_t *data, size_t len, uint32_t key);
+
+/**
+ * \brief Compile the automaton from added patterns
+ *
+ * The builder is empty after a successful compilation and can be reused.
+ * \param[in] builder Builder
+ * \return Pointer to the automaton or NULL (memory allocation error)
+ */
+ac_automaton_t *
+ac_builder_build(ac_builder_t *builder);
+
+/**
+ * \brief Destroy an automaton
+ * \param[in] ac Automaton
+ */
+void
+ac_destroy(ac_automaton_t *ac);
+
+/**
+ * \brief Get the number of states of an automaton
+ * \param[in] ac Automaton
+ */
+size_t
+ac_states_cnt(const ac_automaton_t *ac);
+
+/**
+ * \brief Find all occurrences of patterns in data
+ *
+ * Occurrences are reported in order of their end positions. Occurrences with the same end
+ * position are reported from the longest to the shortest pattern.
+ * \param[in] ac   Automaton
+ * \param[in] data Data
+ * \param[in] len  Size of the data
+ * \param[in] cb   Callback called for each occurrence
+ * \param[in] arg  User defined argument of the callback
+ */
+void
+ac_match(const ac_automaton_t *ac, const uint8_t *data, size_t len, ac_match_cb cb, void *arg);
+
+/**@}*/
+#endif // CLASSIFIER_AUTOMATON_H
@@ -0,0 +1,867 @@
+/**
+ * \file src/plugins/intermediate/classifier/classifier.c
+ * \author agent <agent@local>
+ * \brief Classification of flow records by multi-pattern matching of string fields (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../common/builder.h"
+#include "config.h"
+#include "patterns.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "classifier",
+    // Brief description of plugin
+    .dsc = "Tagging of flow records by matching string fields against a set of patterns",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.1.0"
+};
+
+/** Size of a field specifier with an Enterprise Number  */
+#define CL_TFIELD_LEN_EN  8U
+/** Size of a field specifier without an Enterprise Number */
+#define CL_TFIELD_LEN     4U
+/** Maximal size of a raw Template Record                */
+#define CL_TREC_MAX       (IM_MSG_MAX - FDS_IPFIX_MSG_HDR_LEN - FDS_IPFIX_SET_HDR_LEN)
+/** Maximal number of fields of a template               */
+#define CL_FIELDS_MAX     ((CL_TREC_MAX - 4U) / CL_TFIELD_LEN)
+/** Maximal length of the value of the field with tags   */
+#define CL_TAGS_LEN       1024U
+/** Size of an error message of the loader              */
+#define CL_ERR_SIZE       512U
+/** Interval between checks of the loader (milliseconds) */
+#define CL_TICK_INTERVAL  1000U
+
+/** Value of a field of a Data Record */
+struct cl_value {
+    /** Pointer to the value                            */
+    const uint8_t *data;
+    /** Size of the value                               */
+    uint16_t len;
+};
+
+/** Description of records of a source template */
+struct cl_entry {
+    /** Common part of the description (Template ID and the raw source template)  */
+    struct im_entry base;
+    /** Template of output records (owned by the template manager of the domain)  */
+    const struct fds_template *tmplt;
+
+    /** Records are classified (i.e. the field with tags is appended)             */
+    bool classify;
+    /** Indexes of classified fields in the source template (ascending)           */
+    uint16_t *fields;
+    /** Number of classified fields                                               */
+    uint16_t fields_cnt;
+    /** Index of the field where the search for classified fields starts          */
+    uint16_t walk;
+};
+
+/** Identification of a version of a file */
+struct cl_file_id {
+    /** Device                                            */
+    dev_t dev;
+    /** Inode                                             */
+    ino_t ino;
+    /** Size                                              */
+    off_t size;
+    /** Time of the last modification                    */
+    struct timespec mtime;
+};
+
+/** Background reload of the pattern set */
+struct cl_reload {
+    /** Loader thread                                                 */
+    pthread_t thread;
+    /** The thread has been started and it hasn't been joined yet     */
+    bool running;
+    /** The thread has finished (written by the thread)               */
+    bool done;
+    /** Path to the file with patterns                                */
+    const char *path;
+    /** Version of the file being loaded                              */
+    struct cl_file_id file_new;
+    /** Loaded pattern set (NULL on failure)                          */
+    struct cl_pset *pset;
+    /** Error message of the loader                                   */
+    char err[CL_ERR_SIZE];
+
+    /** Version of the file of the current pattern set                */
+    struct cl_file_id file;
+    /** Time of the last check of the file (seconds)                  */
+    time_t last_check;
+};
+
+/** Instance */
+struct instance_data {
+    /** Plugin context                                    */
+    ipx_ctx_t *ctx;
+    /** Parsed configuration of the instance              */
+    struct cl_config *config;
+    /** Current pattern set                               */
+    struct cl_pset *pset;
+    /** Background reload of the pattern set              */
+    struct cl_reload reload;
+    /** Observation Domains with classified records       */
+    struct im_domains domains;
+    /** Builder of output messages                        */
+    struct im_builder builder;
+    /** Tags of the current record                        */
+    struct cl_tags tags;
+    /** Values of classified fields of the current record */
+    struct cl_value *values;
+    /** Buffer for raw templates (#CL_TREC_MAX bytes)     */
+    uint8_t *tbuf;
+    /** Buffer for the value of the field with tags       */
+    char tag_buf[CL_TAGS_LEN];
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Get the version of the file with patterns
+ * \param[in]  path Path to the file
+ * \param[out] id   Version of the file
+ * \return True on success, false if the file is not accessible
+ */
+static bool
+file_id_get(const char *path, struct cl_file_id *id)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+
+    memset(id, 0, sizeof(*id));
+    id->dev = st.st_dev;
+    id->ino = st.st_ino;
+    id->size = st.st_size;
+    id->mtime = st.st_mtim;
+    return true;
+}
+
+/**
+ * \brief Compare versions of a file
+ * \return True if the versions are the same
+ */
+static bool
+file_id_eq(const struct cl_file_id *id1, const struct cl_file_id *id2)
+{
+    return id1->dev == id2->dev && id1->ino == id2->ino && id1->size == id2->size
+        && id1->mtime.tv_sec == id2->mtime.tv_sec && id1->mtime.tv_nsec == id2->mtime.tv_nsec;
+}
+
+/**
+ * \brief Loader thread
+ * \param[in] arg Background reload of the pattern set
+ * \return NULL
+ */
+static void *
+reload_thread(void *arg)
+{
+    struct cl_reload *reload = arg;
+    reload->pset = cl_pset_load(reload->path, reload->err, sizeof(reload->err));
+    __atomic_store_n(&reload->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * \brief Replace the current pattern set
+ * \param[in] inst Instance data
+ * \param[in] pset New pattern set
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the pattern set is destroyed)
+ */
+static int
+pset_replace(struct instance_data *inst, struct cl_pset *pset)
+{
+    if (cl_tags_prepare(&inst->tags, pset) != IPX_OK) {
+        cl_pset_destroy(pset);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (inst->pset) {
+        cl_pset_destroy(inst->pset);
+    }
+    inst->pset = pset;
+
+    IPX_CTX_INFO(inst->ctx, "Loaded %zu patterns with %" PRIu32 " tags (%zu states of the "
+        "automaton) from '%s'.", pset->rules_cnt, pset->tags_cnt, ac_states_cnt(pset->ac),
+        inst->config->patterns);
+    return IPX_OK;
+}
+
+/**
+ * \brief Collect a pattern set loaded by the loader thread
+ *
+ * If loading failed, the current pattern set is kept.
+ * \param[in] inst Instance data
+ */
+static void
+reload_finish(struct instance_data *inst)
+{
+    struct cl_reload *reload = &inst->reload;
+    pthread_join(reload->thread, NULL);
+    reload->running = false;
+
+    // The same version of the file is not loaded again, even if it's invalid
+    reload->file = reload->file_new;
+    if (!reload->pset) {
+        IPX_CTX_ERROR(inst->ctx, "Failed to reload patterns: %s. Previous patterns are still "
+            "used.", reload->err);
+        return;
+    }
+
+    if (pset_replace(inst, reload->pset) != IPX_OK) {
+        IPX_CTX_ERROR(inst->ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+    reload->pset = NULL;
+}
+
+/**
+ * \brief Start loading of the pattern set in the background, if the file has been modified
+ * \param[in] inst Instance data
+ */
+static void
+reload_check(struct instance_data *inst)
+{
+    struct cl_reload *reload = &inst->reload;
+    struct cl_file_id file;
+    if (!file_id_get(reload->path, &file) || file_id_eq(&file, &reload->file)) {
+        // Not accessible (e.g. being replaced) or not modified
+        return;
+    }
+
+    reload->file_new = file;
+    reload->done = false;
+    reload->pset = NULL;
+    if (pthread_create(&reload->thread, NULL, &reload_thread, reload) != 0) {
+        IPX_CTX_ERROR(inst->ctx, "Failed to start a thread for reloading of patterns.", '\0');
+        return;
+    }
+
+    reload->running = true;
+    IPX_CTX_INFO(inst->ctx, "File '%s' has been modified, reloading patterns...", reload->path);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Check if a template contains a field to classify
+ *
+ * Templates that already contain the field with tags (e.g. records classified by another
+ * instance) are never classified again.
+ * \param[in] arg   Configuration
+ * \param[in] tmplt Template
+ * \return True if records of the template should be classified
+ */
+static bool
+tmplt_needs(const void *arg, const struct fds_template *tmplt)
+{
+    const struct cl_config *cfg = arg;
+    if (tmplt->type != FDS_TYPE_TEMPLATE) {
+        return false;
+    }
+
+    bool found = false;
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (field->en == cfg->tag.en && field->id == cfg->tag.id) {
+            return false;
+        }
+
+        for (size_t f = 0; f < cfg->fields_cnt && !found; ++f) {
+            found = (field->en == cfg->fields[f].en && field->id == cfg->fields[f].id);
+        }
+    }
+
+    return found;
+}
+
+/**
+ * \brief Create a template of classified records (the source template with the field with tags)
+ * \param[in]  inst  Instance data
+ * \param[in]  src   Source template
+ * \param[out] tmplt Parsed template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the template would be too long
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+tmplt_create(struct instance_data *inst, const struct fds_template *src,
+    struct fds_template **tmplt)
+{
+    const struct cl_elem *tag = &inst->config->tag;
+    const uint32_t spec_len = (tag->en != 0) ? CL_TFIELD_LEN_EN : CL_TFIELD_LEN;
+    const uint32_t len = src->raw.length + spec_len;
+    if (len > CL_TREC_MAX || src->fields_cnt_total >= CL_FIELDS_MAX) {
+        return IPX_ERR_FORMAT;
+    }
+
+    // The field with tags is appended to the end of the template
+    uint8_t *buf = inst->tbuf;
+    memcpy(buf, src->raw.data, src->raw.length);
+    im_set16(&buf[2], (uint16_t) (src->fields_cnt_total + 1));
+
+    uint8_t *spec = &buf[src->raw.length];
+    im_set16(&spec[0], (uint16_t) ((tag->en != 0) ? (tag->id | 0x8000U) : tag->id));
+    im_set16(&spec[2], FDS_IPFIX_VAR_IE_LEN);
+    if (tag->en != 0) {
+        im_set16(&spec[4], (uint16_t) (tag->en >> 16));
+        im_set16(&spec[6], (uint16_t) tag->en);
+    }
+
+    uint16_t tmplt_len = (uint16_t) len;
+    switch (fds_template_parse(FDS_TYPE_TEMPLATE, buf, &tmplt_len, tmplt)) {
+    case FDS_OK:
+        return IPX_OK;
+    case FDS_ERR_NOMEM:
+        return IPX_ERR_NOMEM;
+    default:
+        // For example, the total size of records is too long
+        return IPX_ERR_FORMAT;
+    }
+}
+
+/**
+ * \brief Destroy a description of a source template
+ * \param[in] base Description
+ */
+static void
+entry_destroy(struct im_entry *base)
+{
+    struct cl_entry *entry = (struct cl_entry *) base;
+    free(entry->fields);
+    free(base->raw);
+    free(entry);
+}
+
+/**
+ * \brief Prepare positions of classified fields of a source template
+ * \param[in] cfg   Configuration
+ * \param[in] src   Source template
+ * \param[in] entry Description to fill
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+entry_fields(const struct cl_config *cfg, const struct fds_template *src, struct cl_entry *entry)
+{
+    entry->fields = malloc(src->fields_cnt_total * sizeof(*entry->fields));
+    if (!entry->fields) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (uint16_t i = 0; i < src->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &src->fields[i];
+        for (size_t f = 0; f < cfg->fields_cnt; ++f) {
+            if (field->en == cfg->fields[f].en && field->id == cfg->fields[f].id) {
+                entry->fields[entry->fields_cnt++] = i;
+                break;
+            }
+        }
+    }
+
+    // Offsets of fields are known only until the first field after a variable-length field
+    uint16_t walk = entry->fields[0];
+    while (src->fields[walk].offset == FDS_IPFIX_VAR_IE_LEN) {
+        walk--;
+    }
+    entry->walk = walk;
+    return IPX_OK;
+}
+
+/**
+ * \brief Create a description of a source template
+ * \param[in]  inst   Instance data
+ * \param[in]  domain Observation Domain
+ * \param[in]  src    Source template
+ * \param[out] entry  Created description (inserted into the domain)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+entry_create(struct instance_data *inst, struct im_domain *domain,
+    const struct fds_template *src, struct cl_entry **entry)
+{
+    struct cl_entry *new_entry = calloc(1, sizeof(*new_entry));
+    if (!new_entry) {
+        return IPX_ERR_NOMEM;
+    }
+
+    if (im_entry_init(&new_entry->base, src) != IPX_OK) {
+        entry_destroy(&new_entry->base);
+        return IPX_ERR_NOMEM;
+    }
+
+    int rc;
+    struct fds_template *tmplt = NULL;
+    if (tmplt_needs(inst->config, src)) {
+        rc = tmplt_create(inst, src, &tmplt);
+        if (rc == IPX_OK) {
+            rc = entry_fields(inst->config, src, new_entry);
+            new_entry->classify = true;
+        } else if (rc == IPX_ERR_FORMAT) {
+            IPX_CTX_WARNING(inst->ctx, "[ODID: %" PRIu32 "] Unable to append tags to records of "
+                "Template ID %" PRIu16 " (the template is too long). Records are passed "
+                "unmodified.", domain->odid, src->id);
+            rc = IPX_OK;
+        }
+
+        if (rc != IPX_OK) {
+            if (tmplt) {
+                fds_template_destroy(tmplt);
+            }
+            entry_destroy(&new_entry->base);
+            return rc;
+        }
+    }
+
+    if (!tmplt && (tmplt = fds_template_copy(src)) == NULL) {
+        entry_destroy(&new_entry->base);
+        return IPX_ERR_NOMEM;
+    }
+
+    if ((rc = im_builder_tmplt_add(&inst->builder, tmplt)) != IPX_OK) {
+        entry_destroy(&new_entry->base);
+        return rc;
+    }
+    new_entry->tmplt = tmplt;
+
+    if (im_domain_entry_insert(domain, &new_entry->base) != IPX_OK) {
+        entry_destroy(&new_entry->base);
+        return IPX_ERR_NOMEM;
+    }
+
+    *entry = new_entry;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get a description of the template of a Data Record
+ *
+ * The description is created if it doesn't exist or if the template has been redefined.
+ * \param[in]  inst   Instance data
+ * \param[in]  domain Observation Domain
+ * \param[in]  src    Template of the Data Record
+ * \param[out] entry  Description
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+entry_get(struct instance_data *inst, struct im_domain *domain, const struct fds_template *src,
+    struct cl_entry **entry)
+{
+    struct im_entry *found = im_domain_entry_match(domain, src);
+    if (found != NULL) {
+        *entry = (struct cl_entry *) found;
+        return IPX_OK;
+    }
+
+    return entry_create(inst, domain, src, entry);
+}
+
+/**
+ * \brief Locate values of classified fields of a Data Record
+ *
+ * Fields are walked only from the last field with a known offset before the first
+ * classified field.
+ * \param[in]  entry  Description of the template of the record
+ * \param[in]  rec    Data Record
+ * \param[out] values Values of the classified fields
+ * \return True on success, false if the record is malformed
+ */
+static bool
+rec_values(const struct cl_entry *entry, const struct fds_drec *rec, struct cl_value *values)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    uint32_t offset = tmplt->fields[entry->walk].offset;
+    uint16_t next = 0;
+
+    for (uint16_t i = entry->walk; next < entry->fields_cnt; ++i) {
+        uint32_t data_off = offset;
+        uint32_t data_len = tmplt->fields[i].length;
+
+        if (data_len == FDS_IPFIX_VAR_IE_LEN) {
+            if (offset + 1U > rec->size) {
+                return false;
+            }
+
+            data_len = rec->data[offset];
+            data_off = offset + 1U;
+            if (data_len == 255U) {
+                if (offset + 3U > rec->size) {
+                    return false;
+                }
+                data_len = im_get16(&rec->data[offset + 1U]);
+                data_off = offset + 3U;
+            }
+        }
+
+        if (data_off + data_len > rec->size) {
+            return false;
+        }
+
+        if (i == entry->fields[next]) {
+            values[next].data = &rec->data[data_off];
+            values[next].len = (uint16_t) data_len;
+            next++;
+        }
+        offset = data_off + data_len;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Convert tags of the current record to a comma separated list
+ *
+ * Tags that don't fit into the buffer are omitted.
+ * \param[in] inst Instance data
+ * \return Length of the list
+ */
+static uint16_t
+tags_format(struct instance_data *inst)
+{
+    const struct cl_tags *tags = &inst->tags;
+    char *buf = inst->tag_buf;
+    size_t len = 0;
+
+    for (size_t i = 0; i < tags->cnt; ++i) {
+        const char *name = cl_pset_tag_name(inst->pset, tags->list[i]);
+        const size_t name_len = strlen(name);
+        const size_t sep_len = (len != 0) ? 1 : 0;
+        if (len + sep_len + name_len > CL_TAGS_LEN) {
+            continue;
+        }
+
+        if (sep_len != 0) {
+            buf[len++] = ',';
+        }
+        memcpy(&buf[len], name, name_len);
+        len += name_len;
+    }
+
+    return (uint16_t) len;
+}
+
+/**
+ * \brief Copy or classify a Data Record to the output message
+ * \param[in] inst   Instance data
+ * \param[in] entry  Description of the template of the record
+ * \param[in] rec    Data Record
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the record cannot be processed (it's dropped)
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+rec_process(struct instance_data *inst, const struct cl_entry *entry, const struct fds_drec *rec)
+{
+    uint8_t *out;
+    int rc;
+
+    if (!entry->classify) {
+        if ((rc = im_builder_reserve(&inst->builder, entry->tmplt, rec->size, &out)) == IPX_OK) {
+            memcpy(out, rec->data, rec->size);
+        }
+        return rc;
+    }
+
+    if (!rec_values(entry, rec, inst->values)) {
+        return IPX_ERR_FORMAT;
+    }
+
+    cl_tags_clear(&inst->tags);
+    for (uint16_t i = 0; i < entry->fields_cnt; ++i) {
+        const struct cl_value *value = &inst->values[i];
+        if (value->len != 0) {
+            cl_pset_match(inst->pset, value->data, value->len, &inst->tags);
+        }
+    }
+
+    // The field with tags is a variable-length string appended to the end of the record
+    const uint16_t tags_len = tags_format(inst);
+    const uint32_t prefix_len = (tags_len < 255U) ? 1U : 3U;
+    const uint32_t size = rec->size + prefix_len + tags_len;
+    if ((rc = im_builder_reserve(&inst->builder, entry->tmplt, size, &out)) != IPX_OK) {
+        return rc;
+    }
+
+    memcpy(out, rec->data, rec->size);
+    out += rec->size;
+    if (prefix_len == 1U) {
+        out[0] = (uint8_t) tags_len;
+    } else {
+        out[0] = 255U;
+        im_set16(&out[1], tags_len);
+    }
+    memcpy(&out[prefix_len], inst->tag_buf, tags_len);
+    return IPX_OK;
+}
+
+/**
+ * \brief Process an IPFIX Message
+ *
+ * If the message contains records to classify, it's replaced by one or more new messages.
+ * Records of an Observation Domain are classified (or copied) under templates of a private
+ * template manager of the domain since the first message that required classification.
+ * \param[in] ctx  Plugin context
+ * \param[in] inst Instance data
+ * \param[in] msg  IPFIX Message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+process_ipfix(ipx_ctx_t *ctx, struct instance_data *inst, ipx_msg_ipfix_t *msg)
+{
+    struct im_domain *domain;
+    int rc = im_domains_msg_get(&inst->domains, ctx, msg, &tmplt_needs, inst->config, &domain);
+    if (rc != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+    if (!domain) {
+        // Nothing to classify
+        ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
+        return rc;
+    }
+
+    im_builder_start(&inst->builder, domain, msg);
+
+    uint32_t dropped = 0;
+    struct cl_entry *entry = NULL;
+    const struct fds_template *entry_src = NULL;
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+
+    for (uint32_t i = 0; i < rec_cnt && rc != IPX_ERR_NOMEM; ++i) {
+        const struct fds_drec *rec = &ipx_msg_ipfix_get_drec(msg, i)->rec;
+        if (rec->tmplt != entry_src) {
+            if ((rc = entry_get(inst, domain, rec->tmplt, &entry)) != IPX_OK) {
+                break;
+            }
+            entry_src = rec->tmplt;
+        }
+
+        if ((rc = rec_process(inst, entry, rec)) == IPX_ERR_FORMAT) {
+            dropped++;
+        }
+    }
+
+    rc = im_builder_finish(&inst->builder, msg, rc);
+    if (dropped != 0) {
+        IPX_CTX_WARNING(ctx, "[ODID: %" PRIu32 "] %" PRIu32 " malformed or too long record(s) "
+            "have been dropped.", domain->odid, dropped);
+    }
+
+    if (rc == IPX_ERR_NOMEM) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+    return rc;
+}
+
+/**
+ * \brief Destroy instance data
+ * \param[in] inst Instance data
+ */
+static void
+instance_destroy(struct instance_data *inst)
+{
+    if (inst->reload.running) {
+        pthread_join(inst->reload.thread, NULL);
+        if (inst->reload.pset) {
+            cl_pset_destroy(inst->reload.pset);
+        }
+    }
+
+    im_domains_clear(&inst->domains);
+    im_builder_free(&inst->builder);
+    cl_tags_free(&inst->tags);
+    if (inst->pset) {
+        cl_pset_destroy(inst->pset);
+    }
+    free(inst->values);
+    free(inst->tbuf);
+    if (inst->config) {
+        config_destroy(inst->config);
+    }
+    free(inst);
+}
+
+/**
+ * \brief Load the initial pattern set
+ * \param[in] inst Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+instance_pset_load(struct instance_data *inst)
+{
+    struct cl_reload *reload = &inst->reload;
+    reload->path = inst->config->patterns;
+    if (!file_id_get(reload->path, &reload->file)) {
+        memset(&reload->file, 0, sizeof(reload->file));
+    }
+
+    char err[CL_ERR_SIZE];
+    struct cl_pset *pset = cl_pset_load(reload->path, err, sizeof(err));
+    if (!pset) {
+        IPX_CTX_ERROR(inst->ctx, "Failed to load patterns: %s", err);
+        return IPX_ERR_DENIED;
+    }
+
+    if (pset_replace(inst, pset) != IPX_OK) {
+        IPX_CTX_ERROR(inst->ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = ctx;
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    im_domains_init(&data->domains, sizeof(struct im_domain), &entry_destroy);
+    const int bld_rc = im_builder_init(&data->builder, ctx);
+    data->values = malloc(CL_FIELDS_MAX * sizeof(*data->values));
+    data->tbuf = malloc(CL_TREC_MAX);
+    if (bld_rc != IPX_OK || !data->values || !data->tbuf) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (instance_pset_load(data) != IPX_OK) {
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Modifications of the file with patterns are checked periodically
+    const uint32_t reload_ms = data->config->reload * 1000U;
+    const uint32_t tick = (reload_ms < CL_TICK_INTERVAL) ? reload_ms : CL_TICK_INTERVAL;
+    if (tick != 0 && ipx_ctx_tick_set(ctx, tick) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to enable periodic checks of the file with patterns.", '\0');
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Subscribe to receive IPFIX and Transport Session Messages
+    const ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to subscribe to receive IPFIX and Transport Session Messages.",
+            '\0');
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx; // Suppress warnings
+    instance_destroy((struct instance_data *) cfg);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    switch (ipx_msg_get_type(msg)) {
+    case IPX_MSG_IPFIX:
+        return process_ipfix(ctx, data, ipx_msg_base2ipfix(msg));
+    case IPX_MSG_SESSION:
+        im_domains_session(&data->domains, ctx, ipx_msg_base2session(msg));
+        return IPX_OK;
+    default:
+        ipx_ctx_msg_pass(ctx, msg);
+        return IPX_OK;
+    }
+}
+
+void
+ipx_plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now)
+{
+    (void) ctx; // Suppress warnings
+    struct instance_data *data = (struct instance_data *) cfg;
+    struct cl_reload *reload = &data->reload;
+
+    if (reload->running) {
+        // Replace the pattern set as soon as the loader is finished
+        if (__atomic_load_n(&reload->done, __ATOMIC_ACQUIRE)) {
+            reload_finish(data);
+        }
+        return;
+    }
+
+    if (now->tv_sec - reload->last_check < (time_t) data->config->reload) {
+        return;
+    }
+
+    reload->last_check = now->tv_sec;
+    reload_check(data);
+}
@@ -0,0 +1,270 @@
+/**
+ * \file src/plugins/intermediate/classifier/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of classifier plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+/*
+ * <params>
+ *  <patterns>...</patterns>
+ *  <field>...</field>                                          <!-- multiple -->
+ *  <tagElement>...</tagElement>
+ *  <reloadInterval>...</reloadInterval>                        <!-- optional -->
+ * </params>
+ */
+
+/** Default interval of checks of modification of the file with patterns (seconds) */
+#define CL_RELOAD_DEF 10U
+
+/** XML nodes */
+enum params_xml_nodes {
+    CL_PATTERNS = 1,
+    CL_FIELD,
+    CL_TAG_ELEM,
+    CL_RELOAD
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(CL_PATTERNS, "patterns",       FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(CL_FIELD,    "field",          FDS_OPTS_T_STRING, FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(CL_TAG_ELEM, "tagElement",     FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(CL_RELOAD,   "reloadInterval", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Find definition of an Information Element
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the element (e.g. "iana:octetDeltaCount")
+ * \return Pointer to the definition or NULL (an error message is printed)
+ */
+static const struct fds_iemgr_elem *
+config_elem_find(ipx_ctx_t *ctx, const char *name)
+{
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(ctx);
+    const struct fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, name);
+    if (!elem) {
+        IPX_CTX_ERROR(ctx, "Unknown Information Element '%s'!", name);
+        return NULL;
+    }
+
+    return elem;
+}
+
+/**
+ * \brief Process \<field\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the field
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_field(ipx_ctx_t *ctx, const char *name, struct cl_config *cfg)
+{
+    const struct fds_iemgr_elem *elem = config_elem_find(ctx, name);
+    if (!elem) {
+        return IPX_ERR_FORMAT;
+    }
+
+    if (elem->data_type != FDS_ET_STRING && elem->data_type != FDS_ET_OCTET_ARRAY) {
+        IPX_CTX_ERROR(ctx, "Field '%s' is not a string or octetArray!", elem->name);
+        return IPX_ERR_FORMAT;
+    }
+
+    for (size_t i = 0; i < cfg->fields_cnt; ++i) {
+        if (cfg->fields[i].en == elem->scope->pen && cfg->fields[i].id == elem->id) {
+            IPX_CTX_ERROR(ctx, "Field '%s' is defined multiple times!", elem->name);
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    const size_t new_size = (cfg->fields_cnt + 1) * sizeof(*cfg->fields);
+    struct cl_elem *new_array = realloc(cfg->fields, new_size);
+    if (!new_array) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_FORMAT;
+    }
+
+    cfg->fields = new_array;
+    cfg->fields[cfg->fields_cnt].en = elem->scope->pen;
+    cfg->fields[cfg->fields_cnt].id = elem->id;
+    cfg->fields_cnt++;
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<tagElement\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the element
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_tag(ipx_ctx_t *ctx, const char *name, struct cl_config *cfg)
+{
+    const struct fds_iemgr_elem *elem = config_elem_find(ctx, name);
+    if (!elem) {
+        return IPX_ERR_FORMAT;
+    }
+
+    if (elem->data_type != FDS_ET_STRING) {
+        IPX_CTX_ERROR(ctx, "Tag element '%s' is not a string!", elem->name);
+        return IPX_ERR_FORMAT;
+    }
+
+    cfg->tag.en = elem->scope->pen;
+    cfg->tag.id = elem->id;
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct cl_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        int rc = IPX_OK;
+
+        switch (content->id) {
+        case CL_PATTERNS:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strlen(content->ptr_string) == 0) {
+                IPX_CTX_ERROR(ctx, "Path to the file with patterns must not be empty!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            if ((cfg->patterns = strdup(content->ptr_string)) == NULL) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case CL_FIELD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            rc = config_parser_field(ctx, content->ptr_string, cfg);
+            break;
+        case CL_TAG_ELEM:
+            assert(content->type == FDS_OPTS_T_STRING);
+            rc = config_parser_tag(ctx, content->ptr_string, cfg);
+            break;
+        case CL_RELOAD:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX / 1000U) {
+                IPX_CTX_ERROR(ctx, "Reload interval is too long!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->reload = (uint32_t) content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+
+        if (rc != IPX_OK) {
+            return rc;
+        }
+    }
+
+    return IPX_OK;
+}
+
+struct cl_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct cl_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    cfg->reload = CL_RELOAD_DEF;
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct cl_config *cfg)
+{
+    free(cfg->patterns);
+    free(cfg->fields);
+    free(cfg);
+}
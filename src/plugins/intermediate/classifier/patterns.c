@@ -0,0 +1,589 @@
+/**
+ * \file src/plugins/intermediate/classifier/patterns.c
+ * \author agent <agent@local>
+ * \brief Pattern set of the classifier plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "patterns.h"
+
+/** Undefined tag ID (empty slot of the hash table of tags) */
+#define CL_TAG_NONE UINT32_MAX
+
+/** Pattern loaded from a file */
+struct cl_item {
+    /** Pattern without anchors (lower case, valid after loading of all patterns) */
+    const char *str;
+    /** Offset of the pattern in the buffer of strings   */
+    size_t offset;
+    /** Length of the pattern                            */
+    uint32_t len;
+    /** Line of the file                                 */
+    uint32_t line;
+    /** Assigned tag and anchors                         */
+    struct cl_rule rule;
+};
+
+/** Loader of a pattern set */
+struct cl_loader {
+    /** Loaded patterns                                  */
+    struct cl_item *items;
+    /** Number of loaded patterns                        */
+    size_t items_cnt;
+    /** Number of allocated patterns                     */
+    size_t items_alloc;
+    /** Buffer of strings of patterns                    */
+    char *strs;
+    /** Used size of the buffer of strings               */
+    size_t strs_len;
+    /** Allocated size of the buffer of strings          */
+    size_t strs_alloc;
+
+    /** Names of tags (null-terminated)                  */
+    char *tags;
+    /** Used size of the buffer of names                 */
+    size_t tags_len;
+    /** Allocated size of the buffer of names            */
+    size_t tags_alloc;
+    /** Offsets of names (indexed by tag ID)             */
+    uint32_t *tag_offsets;
+    /** Number of allocated offsets                      */
+    size_t tag_offsets_alloc;
+    /** Number of tags                                   */
+    uint32_t tags_cnt;
+    /** Hash table of tag IDs (open addressing)          */
+    uint32_t *table;
+    /** Size of the hash table (power of two)            */
+    uint32_t table_size;
+};
+
+/**
+ * \brief Fill an error message
+ * \param[out] err      Buffer for the message
+ * \param[in]  err_size Size of the buffer
+ * \param[in]  fmt      Format string
+ */
+static void
+cl_error(char *err, size_t err_size, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(err, err_size, fmt, args);
+    va_end(args);
+}
+
+/**
+ * \brief Make sure that a dynamic array has space for more items
+ * \param[in,out] array Array
+ * \param[in]     cnt   Number of used items
+ * \param[in,out] alloc Number of allocated items
+ * \param[in]     add   Number of items to add
+ * \param[in]     size  Size of an item
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+cl_reserve(void **array, size_t cnt, size_t *alloc, size_t add, size_t size)
+{
+    if (cnt + add <= *alloc) {
+        return IPX_OK;
+    }
+
+    size_t alloc_new = (*alloc != 0) ? *alloc : 64;
+    while (alloc_new < cnt + add) {
+        alloc_new *= 2;
+    }
+
+    void *array_new = realloc(*array, alloc_new * size);
+    if (!array_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    *array = array_new;
+    *alloc = alloc_new;
+    return IPX_OK;
+}
+
+/**
+ * \brief Hash a name of a tag (FNV-1a)
+ * \param[in] name Name
+ * \param[in] len  Length of the name
+ */
+static uint32_t
+cl_hash(const char *name, size_t len)
+{
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (uint8_t) name[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * \brief Insert a tag ID into the hash table
+ * \param[in] loader Loader
+ * \param[in] tag    Tag ID
+ */
+static void
+cl_table_insert(struct cl_loader *loader, uint32_t tag)
+{
+    const char *name = &loader->tags[loader->tag_offsets[tag]];
+    const uint32_t mask = loader->table_size - 1;
+    uint32_t idx = cl_hash(name, strlen(name)) & mask;
+    while (loader->table[idx] != CL_TAG_NONE) {
+        idx = (idx + 1) & mask;
+    }
+    loader->table[idx] = tag;
+}
+
+/**
+ * \brief Get an ID of a tag (a new ID is assigned to an unknown tag)
+ * \param[in]  loader Loader
+ * \param[in]  name   Name of the tag
+ * \param[in]  len    Length of the name
+ * \param[out] tag    Tag ID
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+cl_tag_get(struct cl_loader *loader, const char *name, size_t len, uint32_t *tag)
+{
+    // Keep the load factor of the hash table under 50%
+    if (2 * ((size_t) loader->tags_cnt + 1) > loader->table_size) {
+        const uint32_t size_new = (loader->table_size != 0) ? 2 * loader->table_size : 64;
+        uint32_t *table_new = malloc(size_new * sizeof(*table_new));
+        if (!table_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        free(loader->table);
+        loader->table = table_new;
+        loader->table_size = size_new;
+        for (uint32_t i = 0; i < size_new; ++i) {
+            table_new[i] = CL_TAG_NONE;
+        }
+        for (uint32_t i = 0; i < loader->tags_cnt; ++i) {
+            cl_table_insert(loader, i);
+        }
+    }
+
+    const uint32_t mask = loader->table_size - 1;
+    uint32_t idx = cl_hash(name, len) & mask;
+    for (; loader->table[idx] != CL_TAG_NONE; idx = (idx + 1) & mask) {
+        const char *known = &loader->tags[loader->tag_offsets[loader->table[idx]]];
+        if (strncmp(known, name, len) == 0 && known[len] == '\0') {
+            *tag = loader->table[idx];
+            return IPX_OK;
+        }
+    }
+
+    if (cl_reserve((void **) &loader->tags, loader->tags_len, &loader->tags_alloc, len + 1, 1)
+            != IPX_OK
+            || cl_reserve((void **) &loader->tag_offsets, loader->tags_cnt,
+                &loader->tag_offsets_alloc, 1, sizeof(*loader->tag_offsets)) != IPX_OK) {
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(&loader->tags[loader->tags_len], name, len);
+    loader->tags[loader->tags_len + len] = '\0';
+    loader->tag_offsets[loader->tags_cnt] = (uint32_t) loader->tags_len;
+    loader->tags_len += len + 1;
+
+    *tag = loader->tags_cnt++;
+    loader->table[idx] = *tag;
+    return IPX_OK;
+}
+
+/**
+ * \brief Parse a line of a file with patterns
+ * \param[in]  loader   Loader
+ * \param[in]  line     Line (without the newline character)
+ * \param[in]  line_num Line number
+ * \param[out] err      Buffer for an error message
+ * \param[in]  err_size Size of the buffer
+ * \return #IPX_OK on success (or if the line is empty or a comment)
+ * \return #IPX_ERR_FORMAT if the line is malformed (the error message is filled)
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the error message is filled)
+ */
+static int
+cl_line_parse(struct cl_loader *loader, char *line, uint32_t line_num, char *err,
+    size_t err_size)
+{
+    const char *delim = " \t\r";
+    char *save_ptr = NULL;
+    char *pattern = strtok_r(line, delim, &save_ptr);
+    if (!pattern || pattern[0] == '#') {
+        return IPX_OK;
+    }
+
+    char *tag = strtok_r(NULL, delim, &save_ptr);
+    if (!tag || strtok_r(NULL, delim, &save_ptr) != NULL) {
+        cl_error(err, err_size, "line %" PRIu32 ": expected a pattern and a tag", line_num);
+        return IPX_ERR_FORMAT;
+    }
+
+    uint8_t flags = 0;
+    size_t len = strlen(pattern);
+    if (pattern[0] == '^') {
+        flags |= CL_ANCHOR_BEGIN;
+        pattern++;
+        len--;
+    }
+    if (len > 0 && pattern[len - 1] == '$') {
+        flags |= CL_ANCHOR_END;
+        len--;
+    }
+
+    if (len == 0 || len > CL_PATTERN_MAX) {
+        cl_error(err, err_size, "line %" PRIu32 ": the pattern is empty or too long (max. %u "
+            "characters)", line_num, CL_PATTERN_MAX);
+        return IPX_ERR_FORMAT;
+    }
+
+    const size_t tag_len = strlen(tag);
+    if (tag_len > CL_TAG_MAX) {
+        cl_error(err, err_size, "line %" PRIu32 ": the tag is too long (max. %u characters)",
+            line_num, CL_TAG_MAX);
+        return IPX_ERR_FORMAT;
+    }
+    for (size_t i = 0; i < tag_len; ++i) {
+        if (!isgraph((unsigned char) tag[i]) || tag[i] == ',') {
+            cl_error(err, err_size, "line %" PRIu32 ": the tag contains an invalid character "
+                "(commas are not allowed)", line_num);
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    struct cl_item *item;
+    if (cl_reserve((void **) &loader->items, loader->items_cnt, &loader->items_alloc, 1,
+            sizeof(*loader->items)) != IPX_OK
+            || cl_reserve((void **) &loader->strs, loader->strs_len, &loader->strs_alloc, len,
+                1) != IPX_OK) {
+        cl_error(err, err_size, "memory allocation error");
+        return IPX_ERR_NOMEM;
+    }
+
+    item = &loader->items[loader->items_cnt];
+    if (cl_tag_get(loader, tag, tag_len, &item->rule.tag) != IPX_OK) {
+        cl_error(err, err_size, "memory allocation error");
+        return IPX_ERR_NOMEM;
+    }
+
+    // Matching is case-insensitive
+    for (size_t i = 0; i < len; ++i) {
+        loader->strs[loader->strs_len + i] = (char) tolower((unsigned char) pattern[i]);
+    }
+
+    item->offset = loader->strs_len;
+    item->len = (uint32_t) len;
+    item->line = line_num;
+    item->rule.flags = flags;
+    loader->strs_len += len;
+    loader->items_cnt++;
+    return IPX_OK;
+}
+
+/**
+ * \brief Compare patterns by their strings (for qsort)
+ *
+ * Patterns with the same string are sorted by line numbers, so the sort is stable.
+ */
+static int
+cl_item_cmp(const void *p1, const void *p2)
+{
+    const struct cl_item *item1 = p1;
+    const struct cl_item *item2 = p2;
+    const uint32_t len = (item1->len < item2->len) ? item1->len : item2->len;
+
+    int rc = memcmp(item1->str, item2->str, len);
+    if (rc != 0) {
+        return rc;
+    }
+    if (item1->len != item2->len) {
+        return (item1->len < item2->len) ? -1 : 1;
+    }
+    return (item1->line < item2->line) ? -1 : (item1->line > item2->line);
+}
+
+/**
+ * \brief Read all patterns of a file
+ * \param[in]  loader   Loader
+ * \param[in]  path     Path to the file
+ * \param[out] err      Buffer for an error message
+ * \param[in]  err_size Size of the buffer
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT, #IPX_ERR_NOMEM or #IPX_ERR_NOTFOUND on failure (the error
+ *   message is filled)
+ */
+static int
+cl_file_read(struct cl_loader *loader, const char *path, char *err, size_t err_size)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        cl_error(err, err_size, "failed to open file '%s': %s", path, err_str);
+        return IPX_ERR_NOTFOUND;
+    }
+
+    int rc = IPX_OK;
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t line_len;
+    uint32_t line_num = 0;
+
+    while (rc == IPX_OK && (line_len = getline(&line, &line_size, file)) != -1) {
+        line_num++;
+        if (line_len > 0 && line[line_len - 1] == '\n') {
+            line[line_len - 1] = '\0';
+        }
+        rc = cl_line_parse(loader, line, line_num, err, err_size);
+    }
+
+    if (rc == IPX_OK && ferror(file)) {
+        cl_error(err, err_size, "failed to read file '%s'", path);
+        rc = IPX_ERR_FORMAT;
+    }
+
+    free(line);
+    fclose(file);
+    return rc;
+}
+
+/**
+ * \brief Compile loaded patterns
+ * \param[in]  loader   Loader
+ * \param[in]  pset     Pattern set to fill
+ * \param[out] err      Buffer for an error message
+ * \param[in]  err_size Size of the buffer
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the error message is filled)
+ */
+static int
+cl_compile(struct cl_loader *loader, struct cl_pset *pset, char *err, size_t err_size)
+{
+    // Pointers to strings are valid only after all reallocations of the buffer
+    for (size_t i = 0; i < loader->items_cnt; ++i) {
+        loader->items[i].str = &loader->strs[loader->items[i].offset];
+    }
+
+    // Patterns with the same string are next to each other and the automaton is built faster
+    if (loader->items_cnt > 1) {
+        qsort(loader->items, loader->items_cnt, sizeof(*loader->items), &cl_item_cmp);
+    }
+
+    pset->rules = malloc((loader->items_cnt + 1) * sizeof(*pset->rules));
+    pset->keys = malloc((loader->items_cnt + 1) * sizeof(*pset->keys));
+    ac_builder_t *builder = ac_builder_create();
+    if (!pset->rules || !pset->keys || !builder) {
+        if (builder) {
+            ac_builder_destroy(builder);
+        }
+        cl_error(err, err_size, "memory allocation error");
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < loader->items_cnt; ++i) {
+        const struct cl_item *item = &loader->items[i];
+        pset->rules[pset->rules_cnt++] = item->rule;
+
+        struct cl_key *key = (pset->keys_cnt != 0) ? &pset->keys[pset->keys_cnt - 1] : NULL;
+        if (key != NULL && key->len == item->len
+                && memcmp(loader->items[i - 1].str, item->str, item->len) == 0) {
+            key->rules_cnt++;
+            continue;
+        }
+
+        key = &pset->keys[pset->keys_cnt];
+        key->len = item->len;
+        key->rules = (uint32_t) i;
+        key->rules_cnt = 1;
+
+        const uint32_t key_id = (uint32_t) pset->keys_cnt++;
+        if (ac_builder_add(builder, (const uint8_t *) item->str, item->len, key_id) != IPX_OK) {
+            // Strings are already unique and non-empty, so only memory allocation can fail
+            ac_builder_destroy(builder);
+            cl_error(err, err_size, "memory allocation error");
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    pset->ac = ac_builder_build(builder);
+    ac_builder_destroy(builder);
+    if (!pset->ac) {
+        cl_error(err, err_size, "memory allocation error");
+        return IPX_ERR_NOMEM;
+    }
+
+    // Names of tags are moved to the pattern set
+    pset->tag_names = loader->tags;
+    pset->tag_offsets = loader->tag_offsets;
+    pset->tags_cnt = loader->tags_cnt;
+    loader->tags = NULL;
+    loader->tag_offsets = NULL;
+    return IPX_OK;
+}
+
+struct cl_pset *
+cl_pset_load(const char *path, char *err, size_t err_size)
+{
+    struct cl_loader loader;
+    memset(&loader, 0, sizeof(loader));
+
+    struct cl_pset *pset = calloc(1, sizeof(*pset));
+    if (!pset) {
+        cl_error(err, err_size, "memory allocation error");
+        return NULL;
+    }
+
+    int rc = cl_file_read(&loader, path, err, err_size);
+    if (rc == IPX_OK) {
+        rc = cl_compile(&loader, pset, err, err_size);
+    }
+
+    free(loader.items);
+    free(loader.strs);
+    free(loader.tags);
+    free(loader.tag_offsets);
+    free(loader.table);
+
+    if (rc != IPX_OK) {
+        cl_pset_destroy(pset);
+        return NULL;
+    }
+
+    return pset;
+}
+
+void
+cl_pset_destroy(struct cl_pset *pset)
+{
+    if (pset->ac) {
+        ac_destroy(pset->ac);
+    }
+
+    free(pset->keys);
+    free(pset->rules);
+    free(pset->tag_names);
+    free(pset->tag_offsets);
+    free(pset);
+}
+
+/** Context of matching of a value */
+struct cl_match_ctx {
+    /** Pattern set                                      */
+    const struct cl_pset *pset;
+    /** Length of the value                              */
+    size_t len;
+    /** Tags of the current record                       */
+    struct cl_tags *tags;
+};
+
+/**
+ * \brief Process an occurrence of a string of patterns (callback of the automaton)
+ * \param[in] key Key of the string
+ * \param[in] end Position of the last byte of the occurrence
+ * \param[in] arg Context of matching
+ */
+static void
+cl_match_cb(uint32_t key, size_t end, void *arg)
+{
+    struct cl_match_ctx *mctx = arg;
+    struct cl_tags *tags = mctx->tags;
+    const struct cl_key *key_ptr = &mctx->pset->keys[key];
+    const bool at_begin = (end + 1 == key_ptr->len);
+    const bool at_end = (end + 1 == mctx->len);
+
+    for (uint32_t i = 0; i < key_ptr->rules_cnt; ++i) {
+        const struct cl_rule *rule = &mctx->pset->rules[key_ptr->rules + i];
+        if (((rule->flags & CL_ANCHOR_BEGIN) && !at_begin)
+                || ((rule->flags & CL_ANCHOR_END) && !at_end)) {
+            continue;
+        }
+
+        if (tags->stamps[rule->tag] == tags->stamp || tags->cnt == CL_TAGS_MAX) {
+            // Already known tag or too many tags
+            continue;
+        }
+
+        tags->stamps[rule->tag] = tags->stamp;
+        tags->list[tags->cnt++] = rule->tag;
+    }
+}
+
+void
+cl_pset_match(const struct cl_pset *pset, const uint8_t *data, size_t len,
+    struct cl_tags *tags)
+{
+    struct cl_match_ctx mctx = {.pset = pset, .len = len, .tags = tags};
+    ac_match(pset->ac, data, len, &cl_match_cb, &mctx);
+}
+
+int
+cl_tags_prepare(struct cl_tags *tags, const struct cl_pset *pset)
+{
+    // Stamps of a previous pattern set are meaningless
+    uint32_t *stamps_new = calloc(pset->tags_cnt + 1, sizeof(*stamps_new));
+    if (!stamps_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    free(tags->stamps);
+    tags->stamps = stamps_new;
+    tags->stamps_cnt = pset->tags_cnt;
+    tags->stamp = 1;
+    tags->cnt = 0;
+    return IPX_OK;
+}
+
+void
+cl_tags_free(struct cl_tags *tags)
+{
+    free(tags->stamps);
+    tags->stamps = NULL;
+    tags->stamps_cnt = 0;
+}
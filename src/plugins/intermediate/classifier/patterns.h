@@ -0,0 +1,196 @@
+/**
+ * \file src/plugins/intermediate/classifier/patterns.h
+ * \author agent <agent@local>
+ * \brief Pattern set of the classifier plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef CLASSIFIER_PATTERNS_H
+#define CLASSIFIER_PATTERNS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "automaton.h"
+
+/** Maximum length of a pattern                          */
+#define CL_PATTERN_MAX 1024U
+/** Maximum length of a tag                              */
+#define CL_TAG_MAX     64U
+/** Maximum number of different tags of one record       */
+#define CL_TAGS_MAX    64U
+
+/** The pattern must match at the beginning of a value   */
+#define CL_ANCHOR_BEGIN 0x01U
+/** The pattern must match at the end of a value         */
+#define CL_ANCHOR_END   0x02U
+
+/** Tag assigned by a pattern */
+struct cl_rule {
+    /** Tag ID                                            */
+    uint32_t tag;
+    /** Anchors (#CL_ANCHOR_BEGIN and/or #CL_ANCHOR_END)  */
+    uint8_t flags;
+};
+
+/** Unique string of patterns (a key of the automaton) */
+struct cl_key {
+    /** Length of the string                              */
+    uint32_t len;
+    /** Index of the first rule of the string             */
+    uint32_t rules;
+    /** Number of rules of the string                     */
+    uint32_t rules_cnt;
+};
+
+/** Compiled set of patterns */
+struct cl_pset {
+    /** Automaton of all unique strings                   */
+    ac_automaton_t *ac;
+    /** Unique strings (indexed by keys of the automaton) */
+    struct cl_key *keys;
+    /** Number of unique strings                          */
+    size_t keys_cnt;
+    /** Rules (grouped by unique strings)                 */
+    struct cl_rule *rules;
+    /** Number of rules (i.e. patterns)                   */
+    size_t rules_cnt;
+
+    /** Names of tags (null-terminated, one after another) */
+    char *tag_names;
+    /** Offsets of names of tags (indexed by tag ID)      */
+    uint32_t *tag_offsets;
+    /** Number of tags                                    */
+    uint32_t tags_cnt;
+};
+
+/** Tags found in a record */
+struct cl_tags {
+    /** Tag IDs (in order of occurrence)                   */
+    uint32_t list[CL_TAGS_MAX];
+    /** Number of tags                                     */
+    size_t cnt;
+    /** Stamps of already found tags (indexed by tag ID)   */
+    uint32_t *stamps;
+    /** Number of stamps                                   */
+    uint32_t stamps_cnt;
+    /** Stamp of the current record                        */
+    uint32_t stamp;
+};
+
+/**
+ * \brief Load and compile a set of patterns from a file
+ *
+ * Each non-empty line of the file, which doesn't start with '#', consists of a pattern and
+ * a tag separated by whitespace. The pattern can start with '^' and/or end with '$' to match
+ * only at the beginning and/or the end of a value.
+ * \param[in]  path     Path to the file
+ * \param[out] err      Buffer for an error message
+ * \param[in]  err_size Size of the buffer
+ * \return Pointer to the pattern set or NULL (the error message is filled)
+ */
+struct cl_pset *
+cl_pset_load(const char *path, char *err, size_t err_size);
+
+/**
+ * \brief Destroy a set of patterns
+ * \param[in] pset Pattern set
+ */
+void
+cl_pset_destroy(struct cl_pset *pset);
+
+/**
+ * \brief Get the name of a tag
+ * \param[in] pset Pattern set
+ * \param[in] tag  Tag ID
+ * \return Null-terminated name
+ */
+static inline const char *
+cl_pset_tag_name(const struct cl_pset *pset, uint32_t tag)
+{
+    return &pset->tag_names[pset->tag_offsets[tag]];
+}
+
+/**
+ * \brief Find tags of all patterns that match a value
+ *
+ * New tags are added to the list of tags of the current record.
+ * \param[in] pset Pattern set
+ * \param[in] data Value
+ * \param[in] len  Length of the value
+ * \param[in] tags Tags of the current record
+ */
+void
+cl_pset_match(const struct cl_pset *pset, const uint8_t *data, size_t len,
+    struct cl_tags *tags);
+
+/**
+ * \brief Prepare a list of tags for a pattern set
+ * \param[in] tags List of tags (zeroed before the first call)
+ * \param[in] pset Pattern set
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+cl_tags_prepare(struct cl_tags *tags, const struct cl_pset *pset);
+
+/**
+ * \brief Clear a list of tags (i.e. start a new record)
+ * \param[in] tags List of tags
+ */
+static inline void
+cl_tags_clear(struct cl_tags *tags)
+{
+    tags->cnt = 0;
+    if (++tags->stamp == 0) {
+        // All stamps must be invalidated after an overflow
+        for (uint32_t i = 0; i < tags->stamps_cnt; ++i) {
+            tags->stamps[i] = 0;
+        }
+        tags->stamp = 1;
+    }
+}
+
+/**
+ * \brief Release a list of tags
+ * \param[in] tags List of tags
+ */
+void
+cl_tags_free(struct cl_tags *tags);
+
+#endif // CLASSIFIER_PATTERNS_H
@@ -0,0 +1,347 @@
+/**
+ * \file src/plugins/intermediate/common/builder.c
+ * \author agent <agent@local>
+ * \brief Builder of IPFIX Messages of intermediate plugins (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "builder.h"
+
+/**
+ * \brief Close the open Data Set of the builder
+ * \param[in] bld Builder
+ */
+static void
+builder_set_close(struct im_builder *bld)
+{
+    if (bld->set_id == 0) {
+        return;
+    }
+
+    im_set16(&bld->data[bld->set_offset + 2], (uint16_t) (bld->data_len - bld->set_offset));
+    bld->set_id = 0;
+}
+
+/**
+ * \brief Get the size of the message under construction
+ * \param[in] bld Builder
+ */
+static inline uint32_t
+builder_size(const struct im_builder *bld)
+{
+    return FDS_IPFIX_MSG_HDR_LEN + bld->tsets_len[0] + bld->tsets_len[1] + bld->data_len;
+}
+
+/**
+ * \brief Discard the content of the builder
+ * \param[in] bld Builder
+ */
+static void
+builder_clear(struct im_builder *bld)
+{
+    for (size_t i = 0; i < bld->recs_cnt; ++i) {
+        const uint16_t id = bld->recs[i].tmplt->id;
+        bld->ids[id / 8] = 0;
+    }
+
+    bld->recs_cnt = 0;
+    bld->tmplts_cnt = 0;
+    bld->tsets_len[0] = bld->tsets_len[1] = 0;
+    bld->data_len = 0;
+    bld->set_id = 0;
+}
+
+/**
+ * \brief Create an IPFIX Message from the content of the builder and pass it
+ *
+ * New templates are placed into the (Options) Template Sets at the beginning of the message.
+ * If the builder is empty, nothing happens.
+ * \param[in] bld Builder
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the content is discarded)
+ */
+static int
+builder_flush(struct im_builder *bld)
+{
+    if (bld->recs_cnt == 0 && bld->tmplts_cnt == 0) {
+        return IPX_OK;
+    }
+
+    builder_set_close(bld);
+    const uint32_t size = builder_size(bld);
+    uint8_t *raw = malloc(size);
+    if (!raw) {
+        builder_clear(bld);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Header, (Options) Template Sets and Data Sets
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) raw;
+    memcpy(hdr, &bld->hdr, FDS_IPFIX_MSG_HDR_LEN);
+    hdr->length = htons((uint16_t) size);
+
+    uint32_t offset = FDS_IPFIX_MSG_HDR_LEN;
+    const enum fds_template_type types[] = {FDS_TYPE_TEMPLATE, FDS_TYPE_TEMPLATE_OPTS};
+    const uint16_t set_ids[] = {FDS_IPFIX_SET_TMPLT, FDS_IPFIX_SET_OPTS_TMPLT};
+    for (size_t t = 0; t < 2; ++t) {
+        if (bld->tsets_len[t] == 0) {
+            continue;
+        }
+
+        im_set16(&raw[offset], set_ids[t]);
+        im_set16(&raw[offset + 2], (uint16_t) bld->tsets_len[t]);
+        uint32_t pos = offset + FDS_IPFIX_SET_HDR_LEN;
+        for (size_t i = 0; i < bld->tmplts_cnt; ++i) {
+            const struct fds_template *tmplt = bld->tmplts[i];
+            if (tmplt->type != types[t]) {
+                continue;
+            }
+            memcpy(&raw[pos], tmplt->raw.data, tmplt->raw.length);
+            pos += tmplt->raw.length;
+        }
+        offset += bld->tsets_len[t];
+    }
+
+    const uint32_t data_offset = offset;
+    memcpy(&raw[data_offset], bld->data, bld->data_len);
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(bld->ctx, &bld->msg_ctx, raw, (uint16_t) size);
+    if (!msg) {
+        free(raw);
+        builder_clear(bld);
+        return IPX_ERR_NOMEM;
+    }
+
+    // The snapshot contains all templates of the Data Sets and Data Records
+    const fds_tsnapshot_t *snap;
+    if (fds_tmgr_snapshot_get(bld->domain->tmgr, &snap) != FDS_OK) {
+        ipx_msg_ipfix_destroy(msg);
+        builder_clear(bld);
+        return IPX_ERR_NOMEM;
+    }
+
+    // References to all Sets
+    for (offset = FDS_IPFIX_MSG_HDR_LEN; offset < size; offset += im_get16(&raw[offset + 2])) {
+        struct ipx_ipfix_set *set_ref = ipx_msg_ipfix_add_set_ref(msg);
+        if (!set_ref) {
+            ipx_msg_ipfix_destroy(msg);
+            builder_clear(bld);
+            return IPX_ERR_NOMEM;
+        }
+        set_ref->ptr = (struct fds_ipfix_set_hdr *) &raw[offset];
+
+        const uint16_t set_id = im_get16(&raw[offset]);
+        if (set_id >= FDS_IPFIX_SET_MIN_DSET) {
+            set_ref->tmplt = fds_tsnapshot_template_get(snap, set_id);
+            set_ref->snap = snap;
+        }
+    }
+
+    // References to all Data Records
+    for (size_t i = 0; i < bld->recs_cnt; ++i) {
+        const struct im_out_rec *out = &bld->recs[i];
+        struct ipx_ipfix_record *drec = ipx_msg_ipfix_add_drec_ref(&msg);
+        if (!drec) {
+            ipx_msg_ipfix_destroy(msg);
+            builder_clear(bld);
+            return IPX_ERR_NOMEM;
+        }
+
+        drec->rec.data = &raw[data_offset + out->offset];
+        drec->rec.size = out->size;
+        drec->rec.tmplt = out->tmplt;
+        drec->rec.snap = snap;
+    }
+
+    builder_clear(bld);
+    ipx_ctx_msg_pass(bld->ctx, ipx_msg_ipfix2base(msg));
+    return IPX_OK;
+}
+
+int
+im_builder_init(struct im_builder *bld, ipx_ctx_t *ctx)
+{
+    bld->ctx = ctx;
+    bld->data = malloc(IM_MSG_MAX);
+    return (bld->data != NULL) ? IPX_OK : IPX_ERR_NOMEM;
+}
+
+void
+im_builder_free(struct im_builder *bld)
+{
+    free(bld->data);
+    free(bld->recs);
+    free(bld->tmplts);
+}
+
+void
+im_builder_start(struct im_builder *bld, struct im_domain *domain, ipx_msg_ipfix_t *msg)
+{
+    const struct fds_ipfix_msg_hdr *hdr = (const struct fds_ipfix_msg_hdr *)
+        ipx_msg_ipfix_get_packet(msg);
+    const uint32_t exp_time = ntohl(hdr->export_time);
+    if (exp_time > domain->time) {
+        domain->time = exp_time;
+    }
+    fds_tmgr_set_time(domain->tmgr, domain->time);
+
+    bld->domain = domain;
+    bld->msg_ctx = *ipx_msg_ipfix_get_ctx(msg);
+    memcpy(&bld->hdr, hdr, FDS_IPFIX_MSG_HDR_LEN);
+}
+
+int
+im_builder_reserve(struct im_builder *bld, const struct fds_template *tmplt, uint32_t size,
+    uint8_t **ptr)
+{
+    uint32_t set_len = (bld->set_id == tmplt->id) ? 0 : FDS_IPFIX_SET_HDR_LEN;
+
+    if (builder_size(bld) + set_len + size > IM_MSG_MAX) {
+        if (bld->recs_cnt == 0 && bld->tmplts_cnt == 0) {
+            return IPX_ERR_FORMAT;
+        }
+
+        int rc = builder_flush(bld);
+        if (rc != IPX_OK) {
+            return rc;
+        }
+
+        set_len = FDS_IPFIX_SET_HDR_LEN;
+        if (builder_size(bld) + set_len + size > IM_MSG_MAX) {
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    if (bld->recs_cnt == bld->recs_alloc) {
+        const size_t alloc_new = (bld->recs_alloc != 0) ? 2 * bld->recs_alloc : 64;
+        struct im_out_rec *recs_new = realloc(bld->recs, alloc_new * sizeof(*recs_new));
+        if (!recs_new) {
+            return IPX_ERR_NOMEM;
+        }
+        bld->recs = recs_new;
+        bld->recs_alloc = alloc_new;
+    }
+
+    if (set_len != 0) {
+        builder_set_close(bld);
+        bld->set_offset = bld->data_len;
+        bld->set_id = tmplt->id;
+        im_set16(&bld->data[bld->data_len], tmplt->id);
+        bld->data_len += FDS_IPFIX_SET_HDR_LEN;
+    }
+
+    struct im_out_rec *out = &bld->recs[bld->recs_cnt++];
+    out->tmplt = tmplt;
+    out->offset = bld->data_len;
+    out->size = (uint16_t) size;
+    im_id_set(bld->ids, tmplt->id);
+
+    *ptr = &bld->data[bld->data_len];
+    bld->data_len += size;
+    return IPX_OK;
+}
+
+int
+im_builder_tmplt_add(struct im_builder *bld, struct fds_template *tmplt)
+{
+    const size_t type_idx = (tmplt->type == FDS_TYPE_TEMPLATE) ? 0 : 1;
+    const uint32_t tset_len = (bld->tsets_len[type_idx] == 0) ? FDS_IPFIX_SET_HDR_LEN : 0;
+    int rc;
+
+    if (im_id_test(bld->ids, tmplt->id)
+            || builder_size(bld) + tset_len + tmplt->raw.length > IM_MSG_MAX) {
+        if ((rc = builder_flush(bld)) != IPX_OK) {
+            fds_template_destroy(tmplt);
+            return rc;
+        }
+    }
+
+    if (bld->tmplts_cnt == bld->tmplts_alloc) {
+        const size_t alloc_new = (bld->tmplts_alloc != 0) ? 2 * bld->tmplts_alloc : 16;
+        const struct fds_template **tmplts_new = realloc(bld->tmplts,
+            alloc_new * sizeof(*tmplts_new));
+        if (!tmplts_new) {
+            fds_template_destroy(tmplt);
+            return IPX_ERR_NOMEM;
+        }
+        bld->tmplts = tmplts_new;
+        bld->tmplts_alloc = alloc_new;
+    }
+
+    if (fds_tmgr_template_add(bld->domain->tmgr, tmplt) != FDS_OK) {
+        fds_template_destroy(tmplt);
+        return IPX_ERR_NOMEM;
+    }
+
+    // The template must be defined in the message (only for outputs that use raw messages)
+    bld->tmplts[bld->tmplts_cnt++] = tmplt;
+    bld->tsets_len[type_idx] += ((bld->tsets_len[type_idx] == 0) ? FDS_IPFIX_SET_HDR_LEN : 0)
+        + tmplt->raw.length;
+    return IPX_OK;
+}
+
+int
+im_builder_finish(struct im_builder *bld, ipx_msg_ipfix_t *msg, int rc)
+{
+    if (rc == IPX_ERR_NOMEM) {
+        builder_clear(bld);
+    } else {
+        rc = builder_flush(bld);
+    }
+
+    // All records have been copied, the original message is not required anymore
+    ipx_msg_ipfix_destroy(msg);
+
+    // Replaced templates can be still referenced by messages in the pipeline
+    fds_tgarbage_t *tgarbage;
+    if (fds_tmgr_garbage_get(bld->domain->tmgr, &tgarbage) == FDS_OK && tgarbage != NULL) {
+        ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy;
+        ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(tgarbage, cb);
+        if (garbage != NULL) {
+            ipx_ctx_msg_pass(bld->ctx, ipx_msg_garbage2base(garbage));
+        } else {
+            // Memory leak, but templates cannot be freed yet
+            IPX_CTX_ERROR(bld->ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        }
+    }
+
+    return rc;
+}
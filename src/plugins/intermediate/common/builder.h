@@ -0,0 +1,210 @@
+/**
+ * \file src/plugins/intermediate/common/builder.h
+ * \author agent <agent@local>
+ * \brief Builder of IPFIX Messages of intermediate plugins (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INTERMEDIATE_COMMON_BUILDER_H
+#define INTERMEDIATE_COMMON_BUILDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "domain.h"
+
+/** Maximal size of an IPFIX Message */
+#define IM_MSG_MAX UINT16_MAX
+
+/** Record of a message under construction */
+struct im_out_rec {
+    /** Template of the record                          */
+    const struct fds_template *tmplt;
+    /** Offset of the record in the buffer of Data Sets */
+    uint32_t offset;
+    /** Size of the record                              */
+    uint16_t size;
+};
+
+/**
+ * \brief Builder of output messages
+ *
+ * Records of an original IPFIX Message are written (converted or copied) into new messages
+ * under templates of the private template manager of its Observation Domain. New templates
+ * are defined in the message where they are used for the first time.
+ */
+struct im_builder {
+    /** Plugin context                                                */
+    ipx_ctx_t *ctx;
+    /** Observation Domain of the message under construction          */
+    struct im_domain *domain;
+    /** Context of the original message                               */
+    struct ipx_msg_ctx msg_ctx;
+    /** Header of the original message                                */
+    struct fds_ipfix_msg_hdr hdr;
+
+    /** Buffer of Data Sets (#IM_MSG_MAX bytes)                       */
+    uint8_t *data;
+    /** Used size of the buffer                                       */
+    uint32_t data_len;
+    /** Offset of the open Data Set                                   */
+    uint32_t set_offset;
+    /** Set ID of the open Data Set (0 == no open Set)                */
+    uint16_t set_id;
+
+    /** Records of the message                                        */
+    struct im_out_rec *recs;
+    /** Number of records                                             */
+    size_t recs_cnt;
+    /** Number of allocated records                                   */
+    size_t recs_alloc;
+
+    /** New (Options) Templates to define in the message              */
+    const struct fds_template **tmplts;
+    /** Number of new templates                                       */
+    size_t tmplts_cnt;
+    /** Number of allocated templates                                 */
+    size_t tmplts_alloc;
+    /** Size of Template Sets and Options Template Sets (with headers) */
+    uint32_t tsets_len[2];
+
+    /** Bitmap of Template IDs used by the records                    */
+    uint8_t ids[IM_ID_BITMAP_SIZE];
+};
+
+/**
+ * \brief Read an unsigned 16-bit value in network byte order
+ * \param[in] ptr Pointer to the value
+ */
+static inline uint16_t
+im_get16(const uint8_t *ptr)
+{
+    return (uint16_t) ((ptr[0] << 8) | ptr[1]);
+}
+
+/**
+ * \brief Write an unsigned 16-bit value in network byte order
+ * \param[in] ptr   Pointer to the value
+ * \param[in] value Value to write
+ */
+static inline void
+im_set16(uint8_t *ptr, uint16_t value)
+{
+    ptr[0] = (uint8_t) (value >> 8);
+    ptr[1] = (uint8_t) value;
+}
+
+/**
+ * \brief Initialize a builder
+ *
+ * The builder must be zeroed before. It must be freed by im_builder_free() even on failure.
+ * \param[in] bld Builder
+ * \param[in] ctx Plugin context (output messages are passed through it)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+im_builder_init(struct im_builder *bld, ipx_ctx_t *ctx);
+
+/**
+ * \brief Free resources of a builder
+ * \param[in] bld Builder
+ */
+void
+im_builder_free(struct im_builder *bld);
+
+/**
+ * \brief Start rebuilding of an IPFIX Message
+ *
+ * The export time of the template manager of the domain is updated to the export time of
+ * the message (it never goes back).
+ * \param[in] bld    Builder (empty)
+ * \param[in] domain Observation Domain of the message
+ * \param[in] msg    Original IPFIX Message
+ */
+void
+im_builder_start(struct im_builder *bld, struct im_domain *domain, ipx_msg_ipfix_t *msg);
+
+/**
+ * \brief Reserve space for a Data Record in the message under construction
+ *
+ * If the record doesn't fit into the message, the message is flushed first.
+ * \param[in]  bld   Builder
+ * \param[in]  tmplt Template of the record
+ * \param[in]  size  Size of the record
+ * \param[out] ptr   Space for the record
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the record is too long
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+im_builder_reserve(struct im_builder *bld, const struct fds_template *tmplt, uint32_t size,
+    uint8_t **ptr);
+
+/**
+ * \brief Add a new template to the template manager of the Observation Domain
+ *
+ * If the Template ID is used by records of the message under construction, the message is
+ * flushed first, so the records are always interpreted by the right template.
+ * \param[in] bld   Builder
+ * \param[in] tmplt Template (the function takes ownership)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the template is destroyed)
+ */
+int
+im_builder_tmplt_add(struct im_builder *bld, struct fds_template *tmplt);
+
+/**
+ * \brief Finish rebuilding of an IPFIX Message
+ *
+ * The rest of the message under construction is passed (or discarded after a memory
+ * allocation error) and the original message is destroyed. Templates replaced in the template
+ * manager of the domain are passed in a garbage message as they can be still referenced by
+ * messages in the pipeline.
+ * \param[in] bld Builder
+ * \param[in] msg Original IPFIX Message
+ * \param[in] rc  Result of processing of the records of the message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if processing of the records failed or in case of a memory
+ *   allocation error
+ */
+int
+im_builder_finish(struct im_builder *bld, ipx_msg_ipfix_t *msg, int rc);
+
+#endif // INTERMEDIATE_COMMON_BUILDER_H
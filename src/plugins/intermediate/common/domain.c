@@ -0,0 +1,379 @@
+/**
+ * \file src/plugins/intermediate/common/domain.c
+ * \author agent <agent@local>
+ * \brief Observation Domains of intermediate plugins that rebuild messages (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "domain.h"
+
+/** Domains removed from a collection (waiting for destruction) */
+struct im_garbage {
+    /** Array of domains                                                          */
+    struct im_domain **items;
+    /** Number of domains                                                         */
+    size_t cnt;
+};
+
+int
+im_entry_init(struct im_entry *entry, const struct fds_template *src)
+{
+    if ((entry->raw = malloc(src->raw.length)) == NULL) {
+        return IPX_ERR_NOMEM;
+    }
+
+    memcpy(entry->raw, src->raw.data, src->raw.length);
+    entry->raw_len = src->raw.length;
+    entry->id = src->id;
+    return IPX_OK;
+}
+
+/**
+ * \brief Find a position of a Template ID in the sorted array of descriptions
+ * \param[in]  domain Observation Domain
+ * \param[in]  id     Source Template ID
+ * \param[out] pos    Position of the description or position where it should be inserted
+ * \return True if the description has been found
+ */
+static bool
+im_domain_entry_pos(const struct im_domain *domain, uint16_t id, size_t *pos)
+{
+    size_t low = 0;
+    size_t high = domain->entries_cnt;
+
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const uint16_t mid_id = domain->entries[mid]->id;
+        if (mid_id == id) {
+            *pos = mid;
+            return true;
+        }
+
+        if (mid_id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *pos = low;
+    return false;
+}
+
+struct im_entry *
+im_domain_entry_match(const struct im_domain *domain, const struct fds_template *src)
+{
+    size_t pos;
+    if (!im_domain_entry_pos(domain, src->id, &pos)) {
+        return NULL;
+    }
+
+    struct im_entry *entry = domain->entries[pos];
+    if (entry->raw_len != src->raw.length
+            || memcmp(entry->raw, src->raw.data, src->raw.length) != 0) {
+        return NULL;
+    }
+
+    return entry;
+}
+
+int
+im_domain_entry_insert(struct im_domain *domain, struct im_entry *entry)
+{
+    size_t pos;
+    if (im_domain_entry_pos(domain, entry->id, &pos)) {
+        domain->entry_destroy(domain->entries[pos]);
+        domain->entries[pos] = entry;
+        return IPX_OK;
+    }
+
+    const size_t size_new = (domain->entries_cnt + 1) * sizeof(*domain->entries);
+    struct im_entry **entries_new = realloc(domain->entries, size_new);
+    if (!entries_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    domain->entries = entries_new;
+    memmove(&domain->entries[pos + 1], &domain->entries[pos],
+        (domain->entries_cnt - pos) * sizeof(*domain->entries));
+    domain->entries[pos] = entry;
+    domain->entries_cnt++;
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy an Observation Domain
+ * \param[in] domain Domain
+ */
+static void
+im_domain_destroy(struct im_domain *domain)
+{
+    for (size_t i = 0; i < domain->entries_cnt; ++i) {
+        domain->entry_destroy(domain->entries[i]);
+    }
+
+    free(domain->entries);
+    fds_tmgr_destroy(domain->tmgr);
+    free(domain);
+}
+
+/**
+ * \brief Create an Observation Domain
+ * \param[in] domains Collection of domains
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] iemgr   Manager of Information Elements
+ * \return Pointer to the domain or NULL (memory allocation error)
+ */
+static struct im_domain *
+im_domain_create(const struct im_domains *domains, const struct ipx_session *session,
+    uint32_t odid, const fds_iemgr_t *iemgr)
+{
+    struct im_domain *domain = calloc(1, domains->domain_size);
+    if (!domain) {
+        return NULL;
+    }
+
+    // Templates are defined only by the plugin, therefore, they never expire
+    domain->tmgr = fds_tmgr_create(FDS_SESSION_UDP);
+    if (!domain->tmgr
+            || fds_tmgr_set_udp_timeouts(domain->tmgr, 0, 0) != FDS_OK
+            || fds_tmgr_set_iemgr(domain->tmgr, iemgr) != FDS_OK) {
+        if (domain->tmgr) {
+            fds_tmgr_destroy(domain->tmgr);
+        }
+        free(domain);
+        return NULL;
+    }
+
+    domain->session = session;
+    domain->odid = odid;
+    domain->entry_destroy = domains->entry_destroy;
+    return domain;
+}
+
+void
+im_domains_init(struct im_domains *domains, size_t domain_size,
+    im_entry_destroy_cb entry_destroy)
+{
+    memset(domains, 0, sizeof(*domains));
+    domains->domain_size = domain_size;
+    domains->entry_destroy = entry_destroy;
+}
+
+struct im_domain *
+im_domains_get(struct im_domains *domains, const struct ipx_session *session, uint32_t odid,
+    const fds_iemgr_t *iemgr, bool create)
+{
+    struct im_domain *last = domains->last;
+    if (last != NULL && last->session == session && last->odid == odid) {
+        return last;
+    }
+
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        struct im_domain *domain = domains->items[i];
+        if (domain->session == session && domain->odid == odid) {
+            domains->last = domain;
+            return domain;
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    const size_t items_size = (domains->cnt + 1) * sizeof(*domains->items);
+    struct im_domain **items_new = realloc(domains->items, items_size);
+    if (!items_new) {
+        return NULL;
+    }
+    domains->items = items_new;
+
+    struct im_domain *domain = im_domain_create(domains, session, odid, iemgr);
+    if (!domain) {
+        return NULL;
+    }
+
+    domains->items[domains->cnt++] = domain;
+    domains->last = domain;
+    return domain;
+}
+
+/**
+ * \brief Check if an IPFIX Message contains a record modified by the plugin
+ * \param[in] msg   IPFIX Message
+ * \param[in] needs Check of templates
+ * \param[in] cfg   Configuration of the plugin
+ */
+static bool
+im_msg_needs(ipx_msg_ipfix_t *msg, im_tmplt_needs_cb needs, const void *cfg)
+{
+    const struct fds_template *last = NULL;
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        const struct fds_template *tmplt = ipx_msg_ipfix_get_drec(msg, i)->rec.tmplt;
+        if (tmplt == last) {
+            continue;
+        }
+
+        if (needs(cfg, tmplt)) {
+            return true;
+        }
+        last = tmplt;
+    }
+
+    return false;
+}
+
+int
+im_domains_msg_get(struct im_domains *domains, ipx_ctx_t *ctx, ipx_msg_ipfix_t *msg,
+    im_tmplt_needs_cb needs, const void *cfg, struct im_domain **domain)
+{
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    *domain = im_domains_get(domains, msg_ctx->session, msg_ctx->odid, NULL, false);
+    if (*domain != NULL || !im_msg_needs(msg, needs, cfg)) {
+        return IPX_OK;
+    }
+
+    *domain = im_domains_get(domains, msg_ctx->session, msg_ctx->odid, ipx_ctx_iemgr_get(ctx),
+        true);
+    return (*domain != NULL) ? IPX_OK : IPX_ERR_NOMEM;
+}
+
+/**
+ * \brief Remove all Observation Domains of a Transport Session
+ * \param[in] domains Collection of domains
+ * \param[in] session Transport Session
+ * \return Removed domains or NULL (no domain found or memory allocation error, in that case
+ *   the domains are kept in the collection)
+ */
+static struct im_garbage *
+im_domains_remove(struct im_domains *domains, const struct ipx_session *session)
+{
+    size_t cnt = 0;
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        if (domains->items[i]->session == session) {
+            cnt++;
+        }
+    }
+
+    if (cnt == 0) {
+        return NULL;
+    }
+
+    struct im_garbage *garbage = malloc(sizeof(*garbage));
+    struct im_domain **items = malloc(cnt * sizeof(*items));
+    if (!garbage || !items) {
+        free(garbage);
+        free(items);
+        return NULL;
+    }
+
+    garbage->items = items;
+    garbage->cnt = 0;
+
+    size_t idx = 0;
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        struct im_domain *domain = domains->items[i];
+        if (domain->session != session) {
+            domains->items[idx++] = domain;
+            continue;
+        }
+
+        garbage->items[garbage->cnt++] = domain;
+    }
+
+    domains->cnt = idx;
+    domains->last = NULL;
+    return garbage;
+}
+
+/**
+ * \brief Destroy removed Observation Domains
+ * \param[in] garbage Removed domains
+ */
+static void
+im_garbage_destroy(struct im_garbage *garbage)
+{
+    for (size_t i = 0; i < garbage->cnt; ++i) {
+        im_domain_destroy(garbage->items[i]);
+    }
+
+    free(garbage->items);
+    free(garbage);
+}
+
+void
+im_domains_clear(struct im_domains *domains)
+{
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        im_domain_destroy(domains->items[i]);
+    }
+
+    free(domains->items);
+    domains->items = NULL;
+    domains->cnt = 0;
+    domains->last = NULL;
+}
+
+void
+im_domains_session(struct im_domains *domains, ipx_ctx_t *ctx, ipx_msg_session_t *msg)
+{
+    struct im_garbage *removed = NULL;
+    if (ipx_msg_session_get_event(msg) == IPX_MSG_SESSION_CLOSE) {
+        removed = im_domains_remove(domains, ipx_msg_session_get_session(msg));
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg));
+    if (!removed) {
+        return;
+    }
+
+    ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &im_garbage_destroy;
+    ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(removed, cb);
+    if (!garbage) {
+        // Memory leak, but templates cannot be freed yet
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(garbage));
+}
@@ -0,0 +1,228 @@
+/**
+ * \file src/plugins/intermediate/common/domain.h
+ * \author agent <agent@local>
+ * \brief Observation Domains of intermediate plugins that rebuild messages (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INTERMEDIATE_COMMON_DOMAIN_H
+#define INTERMEDIATE_COMMON_DOMAIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+/** Size of a bitmap of all Template IDs */
+#define IM_ID_BITMAP_SIZE ((UINT16_MAX + 1) / 8)
+
+/**
+ * \brief Common part of descriptions of source templates
+ *
+ * Plugins extend the description by their own structure with this one as the first member.
+ */
+struct im_entry {
+    /** Source Template ID                                                        */
+    uint16_t id;
+    /** Copy of the raw source template (to detect redefinitions)                 */
+    uint8_t *raw;
+    /** Size of the raw source template                                           */
+    uint16_t raw_len;
+};
+
+/** Destructor of a description of a source template */
+typedef void (*im_entry_destroy_cb)(struct im_entry *entry);
+
+/**
+ * \brief Observation Domain of a Transport Session
+ *
+ * Plugins can extend the domain by their own structure with this one as the first member.
+ * Additional members are zeroed when the domain is created.
+ */
+struct im_domain {
+    /** Transport Session                                                         */
+    const struct ipx_session *session;
+    /** Observation Domain ID                                                     */
+    uint32_t odid;
+
+    /** Template manager of output messages                                       */
+    fds_tmgr_t *tmgr;
+    /** Export time of the template manager                                       */
+    uint32_t time;
+
+    /** Descriptions of source templates (sorted by Template ID)                  */
+    struct im_entry **entries;
+    /** Number of descriptions                                                    */
+    size_t entries_cnt;
+    /** Destructor of descriptions                                                */
+    im_entry_destroy_cb entry_destroy;
+};
+
+/** Collection of Observation Domains */
+struct im_domains {
+    /** Array of domains                                                          */
+    struct im_domain **items;
+    /** Number of domains                                                         */
+    size_t cnt;
+    /** Last accessed domain (fast path)                                          */
+    struct im_domain *last;
+
+    /** Size of a domain (including the extension of the plugin)                 */
+    size_t domain_size;
+    /** Destructor of descriptions                                                */
+    im_entry_destroy_cb entry_destroy;
+};
+
+/** Check if records of a template are modified by a plugin */
+typedef bool (*im_tmplt_needs_cb)(const void *cfg, const struct fds_template *tmplt);
+
+/**
+ * \brief Test a Template ID in a bitmap
+ * \param[in] map Bitmap
+ * \param[in] id  Template ID
+ */
+static inline bool
+im_id_test(const uint8_t *map, uint16_t id)
+{
+    return (map[id / 8] & (1U << (id % 8))) != 0;
+}
+
+/**
+ * \brief Set a Template ID in a bitmap
+ * \param[in] map Bitmap
+ * \param[in] id  Template ID
+ */
+static inline void
+im_id_set(uint8_t *map, uint16_t id)
+{
+    map[id / 8] |= (uint8_t) (1U << (id % 8));
+}
+
+/**
+ * \brief Initialize the common part of a description of a source template
+ * \param[in] entry Description (zeroed)
+ * \param[in] src   Source template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+im_entry_init(struct im_entry *entry, const struct fds_template *src);
+
+/**
+ * \brief Find a description of a source template with the same definition
+ * \param[in] domain Observation Domain
+ * \param[in] src    Source template
+ * \return Pointer to the description or NULL (not found or the template has been redefined)
+ */
+struct im_entry *
+im_domain_entry_match(const struct im_domain *domain, const struct fds_template *src);
+
+/**
+ * \brief Insert a description into an Observation Domain
+ *
+ * A previous description of the same Template ID is destroyed.
+ * \param[in] domain Observation Domain
+ * \param[in] entry  Description (the domain takes ownership)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the description is not inserted)
+ */
+int
+im_domain_entry_insert(struct im_domain *domain, struct im_entry *entry);
+
+/**
+ * \brief Initialize an empty collection of Observation Domains
+ * \param[in] domains       Collection of domains
+ * \param[in] domain_size   Size of a domain (at least the size of struct im_domain)
+ * \param[in] entry_destroy Destructor of descriptions
+ */
+void
+im_domains_init(struct im_domains *domains, size_t domain_size,
+    im_entry_destroy_cb entry_destroy);
+
+/**
+ * \brief Find or create an Observation Domain
+ * \param[in] domains Collection of domains
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] iemgr   Manager of Information Elements (for newly created domains)
+ * \param[in] create  Create the domain if it doesn't exist
+ * \return Pointer to the domain or NULL (not found or memory allocation error)
+ */
+struct im_domain *
+im_domains_get(struct im_domains *domains, const struct ipx_session *session, uint32_t odid,
+    const fds_iemgr_t *iemgr, bool create);
+
+/**
+ * \brief Find the Observation Domain of an IPFIX Message
+ *
+ * The domain is created only if the message contains a record modified by the plugin.
+ * Otherwise, records of the domain are passed unmodified until such a record appears.
+ * \param[in]  domains Collection of domains
+ * \param[in]  ctx     Plugin context
+ * \param[in]  msg     IPFIX Message
+ * \param[in]  needs   Check of templates
+ * \param[in]  cfg     Configuration of the plugin (argument of the check)
+ * \param[out] domain  Pointer to the domain or NULL (nothing to modify)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+im_domains_msg_get(struct im_domains *domains, ipx_ctx_t *ctx, ipx_msg_ipfix_t *msg,
+    im_tmplt_needs_cb needs, const void *cfg, struct im_domain **domain);
+
+/**
+ * \brief Destroy all Observation Domains in a collection
+ * \param[in] domains Collection of domains
+ */
+void
+im_domains_clear(struct im_domains *domains);
+
+/**
+ * \brief Process a Transport Session Message
+ *
+ * The message is passed. If the session is closed, its domains are removed from the collection
+ * and destroyed by a garbage message passed after the session message, as their templates can
+ * be still referenced by messages in the pipeline.
+ * \param[in] domains Collection of domains
+ * \param[in] ctx     Plugin context
+ * \param[in] msg     Transport Session Message
+ */
+void
+im_domains_session(struct im_domains *domains, ipx_ctx_t *ctx, ipx_msg_session_t *msg);
+
+#endif // INTERMEDIATE_COMMON_DOMAIN_H
@@ -0,0 +1,346 @@
+/**
+ * \file src/plugins/intermediate/flatten/config.c
+ * \author agent <agent@local>
+ * \brief Configuration parser of flattening plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+/*
+ * <params>
+ *  <basicList>                                                 <!-- multiple -->
+ *    <element>...</element>
+ *    <positions>...</positions>
+ *    <size>...</size>                                          <!-- optional -->
+ *  </basicList>
+ *  <childRecords>                                              <!-- multiple -->
+ *    <field>...</field>
+ *  </childRecords>
+ * </params>
+ */
+
+/** Maximum number of positional fields of a list */
+#define FL_POSITIONS_MAX 64
+
+/** XML nodes */
+enum params_xml_nodes {
+    FL_BLIST = 1,
+    FL_SPLIT,
+    BLIST_ELEMENT,
+    BLIST_POSITIONS,
+    BLIST_SIZE,
+    SPLIT_FIELD
+};
+
+/** Definition of the \<basicList\> node  */
+static const struct fds_xml_args args_blist[] = {
+    FDS_OPTS_ELEM(BLIST_ELEMENT,   "element",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(BLIST_POSITIONS, "positions", FDS_OPTS_T_UINT,   0),
+    FDS_OPTS_ELEM(BLIST_SIZE,      "size",      FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<childRecords\> node  */
+static const struct fds_xml_args args_split[] = {
+    FDS_OPTS_ELEM(SPLIT_FIELD, "field", FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_NESTED(FL_BLIST, "basicList",    args_blist, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_NESTED(FL_SPLIT, "childRecords", args_split, FDS_OPTS_P_OPT | FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Find definition of an Information Element
+ * \param[in] ctx  Plugin context
+ * \param[in] name Name of the element (e.g. "iana:octetDeltaCount")
+ * \return Pointer to the definition or NULL (an error message is printed)
+ */
+static const struct fds_iemgr_elem *
+config_elem_find(ipx_ctx_t *ctx, const char *name)
+{
+    const fds_iemgr_t *iemgr = ipx_ctx_iemgr_get(ctx);
+    const struct fds_iemgr_elem *elem = fds_iemgr_elem_find_name(iemgr, name);
+    if (!elem) {
+        IPX_CTX_ERROR(ctx, "Unknown Information Element '%s'!", name);
+        return NULL;
+    }
+
+    return elem;
+}
+
+/**
+ * \brief Process \<basicList\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] rule Rule to fill
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_blist(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct fl_blist_rule *rule)
+{
+    const struct fds_iemgr_elem *elem = NULL;
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case BLIST_ELEMENT:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if ((elem = config_elem_find(ctx, content->ptr_string)) == NULL) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case BLIST_POSITIONS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > FL_POSITIONS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of positions must be in range 1..%u!",
+                    FL_POSITIONS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            rule->positions = (uint16_t) content->val_uint;
+            break;
+        case BLIST_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint >= FDS_IPFIX_VAR_IE_LEN) {
+                IPX_CTX_ERROR(ctx, "Invalid size of positional fields!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            rule->size = (uint16_t) content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    switch (elem->data_type) {
+    case FDS_ET_BASIC_LIST:
+    case FDS_ET_SUB_TEMPLATE_LIST:
+    case FDS_ET_SUB_TEMPLATE_MULTILIST:
+        IPX_CTX_ERROR(ctx, "Element '%s' of a basicList cannot be a structured data type!",
+            elem->name);
+        return IPX_ERR_FORMAT;
+    case FDS_ET_SIGNED_8:
+    case FDS_ET_SIGNED_16:
+    case FDS_ET_SIGNED_32:
+    case FDS_ET_SIGNED_64:
+        rule->is_signed = true;
+        // fall through
+    case FDS_ET_UNSIGNED_8:
+    case FDS_ET_UNSIGNED_16:
+    case FDS_ET_UNSIGNED_32:
+    case FDS_ET_UNSIGNED_64:
+        rule->numeric = true;
+        break;
+    default:
+        break;
+    }
+
+    rule->en = elem->scope->pen;
+    rule->id = elem->id;
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<childRecords\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] rule Rule to fill
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_split(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct fl_split_rule *rule)
+{
+    const struct fds_iemgr_elem *elem = NULL;
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case SPLIT_FIELD:
+            assert(content->type == FDS_OPTS_T_STRING);
+            if ((elem = config_elem_find(ctx, content->ptr_string)) == NULL) {
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    if (elem->data_type != FDS_ET_SUB_TEMPLATE_LIST
+            && elem->data_type != FDS_ET_SUB_TEMPLATE_MULTILIST) {
+        IPX_CTX_ERROR(ctx, "Field '%s' is not a subTemplateList or subTemplateMultiList!",
+            elem->name);
+        return IPX_ERR_FORMAT;
+    }
+
+    rule->en = elem->scope->pen;
+    rule->id = elem->id;
+    rule->multi = (elem->data_type == FDS_ET_SUB_TEMPLATE_MULTILIST);
+    return IPX_OK;
+}
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct fl_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        int rc;
+        size_t new_size;
+        void *new_array;
+
+        switch (content->id) {
+        case FL_BLIST:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            new_size = (cfg->blists_cnt + 1) * sizeof(*cfg->blists);
+            if ((new_array = realloc(cfg->blists, new_size)) == NULL) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->blists = new_array;
+            memset(&cfg->blists[cfg->blists_cnt], 0, sizeof(*cfg->blists));
+            rc = config_parser_blist(ctx, content->ptr_ctx, &cfg->blists[cfg->blists_cnt]);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+            cfg->blists_cnt++;
+            break;
+        case FL_SPLIT:
+            assert(content->type == FDS_OPTS_T_CONTEXT);
+            new_size = (cfg->splits_cnt + 1) * sizeof(*cfg->splits);
+            if ((new_array = realloc(cfg->splits, new_size)) == NULL) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->splits = new_array;
+            memset(&cfg->splits[cfg->splits_cnt], 0, sizeof(*cfg->splits));
+            rc = config_parser_split(ctx, content->ptr_ctx, &cfg->splits[cfg->splits_cnt]);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+            cfg->splits_cnt++;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    // Check for duplicates
+    for (size_t i = 0; i < cfg->blists_cnt; ++i) {
+        for (size_t j = i + 1; j < cfg->blists_cnt; ++j) {
+            if (cfg->blists[i].en == cfg->blists[j].en && cfg->blists[i].id == cfg->blists[j].id) {
+                IPX_CTX_ERROR(ctx, "Multiple basicList rules with the same element!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+        }
+    }
+
+    if (cfg->blists_cnt == 0 && cfg->splits_cnt == 0) {
+        IPX_CTX_ERROR(ctx, "At least one basicList or childRecords rule must be defined!", '\0');
+        return IPX_ERR_FORMAT;
+    }
+
+    return IPX_OK;
+}
+
+struct fl_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct fl_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct fl_config *cfg)
+{
+    free(cfg->blists);
+    free(cfg->splits);
+    free(cfg);
+}
@@ -0,0 +1,105 @@
+/**
+ * \file src/plugins/intermediate/flatten/config.h
+ * \author agent <agent@local>
+ * \brief Configuration parser of flattening plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef FLATTEN_CONFIG_H
+#define FLATTEN_CONFIG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/** Rule for flattening of basicList fields into positional fields */
+struct fl_blist_rule {
+    /** Private Enterprise Number of the list element       */
+    uint32_t en;
+    /** Information Element ID of the list element          */
+    uint16_t id;
+    /** Number of positional fields                         */
+    uint16_t positions;
+    /** Size of each positional field (0 == list header)    */
+    uint16_t size;
+    /** The element is a number (signed or unsigned)        */
+    bool numeric;
+    /** The element is a signed number                      */
+    bool is_signed;
+};
+
+/** Rule for splitting of subTemplateList/subTemplateMultiList fields into child records */
+struct fl_split_rule {
+    /** Private Enterprise Number of the list field         */
+    uint32_t en;
+    /** Information Element ID of the list field            */
+    uint16_t id;
+    /** The list is a subTemplateMultiList                  */
+    bool multi;
+};
+
+/** Configuration of an instance of the plugin */
+struct fl_config {
+    /** Rules for basicList fields                          */
+    struct fl_blist_rule *blists;
+    /** Number of rules for basicList fields                */
+    size_t blists_cnt;
+    /** Rules for subTemplate(Multi)List fields             */
+    struct fl_split_rule *splits;
+    /** Number of rules for subTemplate(Multi)List fields   */
+    size_t splits_cnt;
+};
+
+/**
+ * \brief Parse configuration of the plugin
+ * \param[in] ctx    Instance context
+ * \param[in] params XML parameters
+ * \return Pointer to the parse configuration of the instance on success
+ * \return NULL if arguments are not valid or if a memory allocation error has occurred
+ */
+struct fl_config *
+config_parse(ipx_ctx_t *ctx, const char *params);
+
+/**
+ * \brief Destroy parsed configuration
+ * \param[in] cfg Parsed configuration
+ */
+void
+config_destroy(struct fl_config *cfg);
+
+#endif // FLATTEN_CONFIG_H
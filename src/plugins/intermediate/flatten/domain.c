@@ -0,0 +1,110 @@
+/**
+ * \file src/plugins/intermediate/flatten/domain.c
+ * \author agent <agent@local>
+ * \brief Observation Domains of flattening plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "domain.h"
+
+/** Minimal Template ID of derived templates */
+#define FL_ID_MIN FDS_IPFIX_SET_MIN_DSET
+
+void
+fl_entry_destroy(struct im_entry *base)
+{
+    struct fl_entry *entry = (struct fl_entry *) base;
+    for (size_t i = 0; i < entry->variants_cnt; ++i) {
+        free(entry->variants[i].child_raw);
+    }
+
+    free(entry->variants);
+    free(entry->actions);
+    free(base->raw);
+    free(entry);
+}
+
+int
+fl_domain_entry_insert(struct fl_domain *domain, struct fl_entry *entry)
+{
+    if (im_domain_entry_insert(&domain->base, &entry->base) != IPX_OK) {
+        return IPX_ERR_NOMEM;
+    }
+
+    im_id_set(domain->ids_src, entry->base.id);
+    return IPX_OK;
+}
+
+bool
+fl_domain_id_alloc(struct fl_domain *domain, uint16_t *id)
+{
+    for (uint32_t i = UINT16_MAX - domain->id_used; i >= FL_ID_MIN; --i) {
+        const uint16_t candidate = (uint16_t) i;
+        if (im_id_test(domain->ids_src, candidate) || im_id_test(domain->ids_derived, candidate)) {
+            continue;
+        }
+
+        im_id_set(domain->ids_derived, candidate);
+        domain->id_used = UINT16_MAX - i + 1;
+        *id = candidate;
+        return true;
+    }
+
+    domain->id_used = UINT16_MAX - FL_ID_MIN + 1;
+    return false;
+}
+
+void
+fl_domain_variants_reset(struct fl_domain *domain)
+{
+    for (size_t i = 0; i < domain->base.entries_cnt; ++i) {
+        struct fl_entry *entry = (struct fl_entry *) domain->base.entries[i];
+        for (size_t v = 0; v < entry->variants_cnt; ++v) {
+            free(entry->variants[v].child_raw);
+        }
+
+        free(entry->variants);
+        entry->variants = NULL;
+        entry->variants_cnt = 0;
+    }
+
+    memset(domain->ids_derived, 0, sizeof(domain->ids_derived));
+    domain->id_used = 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * \file src/plugins/intermediate/flatten/domain.h
+ * \author agent <agent@local>
+ * \brief Observation Domains of flattening plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef FLATTEN_DOMAIN_H
+#define FLATTEN_DOMAIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+#include "../common/domain.h"
+#include "config.h"
+
+/** Conversion of a field of a source record into field(s) of a flat record */
+struct fl_action {
+    /** Index of the field in the source template                                  */
+    uint16_t idx;
+    /** Rule for positional flattening (NULL == copy the field as it is)           */
+    const struct fl_blist_rule *rule;
+    /** Size of each positional field (only if the rule is defined)                */
+    uint16_t size;
+};
+
+/** Derived template for child records of a particular child template */
+struct fl_variant {
+    /** Child template (NULL == records without any child record)                  */
+    const struct fds_template *child;
+    /** Copy of the raw child template (to detect redefinitions)                  */
+    uint8_t *child_raw;
+    /** Size of the raw child template                                            */
+    uint16_t child_len;
+    /** Derived template (owned by the template manager of the domain)            */
+    const struct fds_template *tmplt;
+};
+
+/** Type of conversion of records */
+enum fl_entry_type {
+    /** Records are copied as they are                                            */
+    FL_ENTRY_COPY,
+    /** basicList fields are converted to positional fields                       */
+    FL_ENTRY_FLAT,
+    /** Each child record of a list is converted to a separate record             */
+    FL_ENTRY_SPLIT
+};
+
+/** Conversion description of records of a source template */
+struct fl_entry {
+    /** Common part of the description (Template ID and the raw source template)  */
+    struct im_entry base;
+    /** Type of conversion                                                        */
+    enum fl_entry_type type;
+    /** Template of output records (COPY and FLAT only)                           */
+    const struct fds_template *tmplt;
+
+    /** Conversion of fields of the source records (FLAT and SPLIT only)          */
+    struct fl_action *actions;
+    /** Number of actions                                                         */
+    uint16_t actions_cnt;
+    /** Index of the split field in the source template (SPLIT only)              */
+    uint16_t split_idx;
+    /** Rule for splitting (SPLIT only)                                           */
+    const struct fl_split_rule *split;
+    /** Derived templates for child templates (SPLIT only)                        */
+    struct fl_variant *variants;
+    /** Number of derived templates                                               */
+    size_t variants_cnt;
+};
+
+/** Observation Domain of a Transport Session (extension of the common domain) */
+struct fl_domain {
+    /** Common part of the domain                                                 */
+    struct im_domain base;
+
+    /** Bitmap of Template IDs used by the exporter                               */
+    uint8_t ids_src[IM_ID_BITMAP_SIZE];
+    /** Bitmap of Template IDs allocated for derived templates                    */
+    uint8_t ids_derived[IM_ID_BITMAP_SIZE];
+    /** Number of the highest Template IDs already tried (allocated downwards)    */
+    uint32_t id_used;
+};
+
+/**
+ * \brief Insert a conversion description into an Observation Domain
+ *
+ * A previous description of the same Template ID is destroyed.
+ * \param[in] domain Observation Domain
+ * \param[in] entry  Description (the domain takes ownership)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error (the description is not inserted)
+ */
+int
+fl_domain_entry_insert(struct fl_domain *domain, struct fl_entry *entry);
+
+/**
+ * \brief Destroy a conversion description
+ * \param[in] entry Description
+ */
+void
+fl_entry_destroy(struct im_entry *entry);
+
+/**
+ * \brief Allocate a Template ID for a derived template
+ *
+ * The ID is not used by the exporter nor by other derived templates.
+ * \param[in]  domain Observation Domain
+ * \param[out] id     Template ID
+ * \return True on success, false if all IDs are exhausted
+ */
+bool
+fl_domain_id_alloc(struct fl_domain *domain, uint16_t *id);
+
+/**
+ * \brief Forget all derived templates of split records
+ *
+ * All Template IDs of derived templates are released and the templates are created again
+ * when necessary. Definitions in the template manager are kept until their IDs are reused.
+ * \param[in] domain Observation Domain
+ */
+void
+fl_domain_variants_reset(struct fl_domain *domain);
+
+#endif // FLATTEN_DOMAIN_H
@@ -0,0 +1,952 @@
+/**
+ * \file src/plugins/intermediate/flatten/flatten.c
+ * \author agent <agent@local>
+ * \brief Flattening of structured data into plain records (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/builder.h"
+#include "config.h"
+#include "domain.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "flatten",
+    // Brief description of plugin
+    .dsc = "Flattening of structured data (basicList, subTemplateList) into plain records",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.1.0"
+};
+
+/** Size of a header of a Template Record             */
+#define FL_TREC_HDR_LEN   4U
+/** Size of a field specifier with an Enterprise Number */
+#define FL_TFIELD_LEN_EN  8U
+/** Size of a field specifier without an Enterprise Number */
+#define FL_TFIELD_LEN     4U
+/** Maximal size of a raw Template Record            */
+#define FL_TREC_MAX       (IM_MSG_MAX - FDS_IPFIX_MSG_HDR_LEN - FDS_IPFIX_SET_HDR_LEN)
+/** Maximal number of fields of a template           */
+#define FL_FIELDS_MAX     ((FL_TREC_MAX - FL_TREC_HDR_LEN) / FL_TFIELD_LEN)
+
+/** Position of a field in a Data Record */
+struct fl_loc {
+    /** Offset of the field (including the length prefix of variable-length fields) */
+    uint16_t raw_off;
+    /** Size of the field (including the length prefix of variable-length fields)   */
+    uint16_t raw_len;
+    /** Offset of the value                                                          */
+    uint16_t data_off;
+    /** Size of the value                                                            */
+    uint16_t data_len;
+};
+
+/** Instance */
+struct instance_data {
+    /** Plugin context                                    */
+    ipx_ctx_t *ctx;
+    /** Parsed configuration of the instance              */
+    struct fl_config *config;
+    /** Observation Domains with converted records        */
+    struct im_domains domains;
+    /** Builder of output messages                        */
+    struct im_builder builder;
+    /** Positions of fields of a source record            */
+    struct fl_loc *locs;
+    /** Buffer for raw templates (#FL_TREC_MAX bytes)     */
+    uint8_t *tbuf;
+};
+
+/** Header of a basicList */
+struct fl_blist_hdr {
+    /** Private Enterprise Number of the list element     */
+    uint32_t en;
+    /** Information Element ID of the list element        */
+    uint16_t id;
+    /** Size of the list element                          */
+    uint16_t elem_len;
+    /** Size of the header                                */
+    uint16_t len;
+};
+
+/**
+ * \brief Find a basicList rule of a list element
+ * \param[in] cfg Configuration
+ * \param[in] en  Private Enterprise Number of the list element
+ * \param[in] id  Information Element ID of the list element
+ * \return Pointer to the rule or NULL
+ */
+static const struct fl_blist_rule *
+rule_blist_find(const struct fl_config *cfg, uint32_t en, uint16_t id)
+{
+    for (size_t i = 0; i < cfg->blists_cnt; ++i) {
+        if (cfg->blists[i].en == en && cfg->blists[i].id == id) {
+            return &cfg->blists[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Find a split rule of a template field
+ * \param[in] cfg   Configuration
+ * \param[in] field Template field
+ * \return Pointer to the rule or NULL
+ */
+static const struct fl_split_rule *
+rule_split_find(const struct fl_config *cfg, const struct fds_tfield *field)
+{
+    for (size_t i = 0; i < cfg->splits_cnt; ++i) {
+        if (cfg->splits[i].en == field->en && cfg->splits[i].id == field->id) {
+            return &cfg->splits[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Check if records of a template can be affected by the configuration
+ *
+ * Only templates with fields of subTemplate(Multi)Lists to split or with any basicList field
+ * (the list element is known only from the list header) can be affected.
+ * \param[in] arg   Configuration
+ * \param[in] tmplt Template
+ */
+static bool
+tmplt_needs(const void *arg, const struct fds_template *tmplt)
+{
+    const struct fl_config *cfg = arg;
+    if (tmplt->type != FDS_TYPE_TEMPLATE) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (cfg->blists_cnt != 0 && field->def != NULL
+                && field->def->data_type == FDS_ET_BASIC_LIST) {
+            return true;
+        }
+        if (rule_split_find(cfg, field) != NULL) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Determine positions of all fields of a Data Record
+ * \param[in]  tmplt Template of the record
+ * \param[in]  data  Data of the record
+ * \param[in]  size  Size of the record
+ * \param[out] locs  Positions of the fields (at least the number of fields of the template)
+ * \return True on success, false if the record is malformed
+ */
+static bool
+fields_locate(const struct fds_template *tmplt, const uint8_t *data, uint16_t size,
+    struct fl_loc *locs)
+{
+    uint32_t offset = 0;
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const uint32_t raw_off = offset;
+        uint32_t len = tmplt->fields[i].length;
+
+        if (len == FDS_IPFIX_VAR_IE_LEN) {
+            // Variable-length field
+            if (offset + 1U > size) {
+                return false;
+            }
+            len = data[offset++];
+            if (len == 255U) {
+                if (offset + 2U > size) {
+                    return false;
+                }
+                len = im_get16(&data[offset]);
+                offset += 2U;
+            }
+        }
+
+        if (offset + len > size) {
+            return false;
+        }
+
+        locs[i].raw_off = (uint16_t) raw_off;
+        locs[i].raw_len = (uint16_t) (offset + len - raw_off);
+        locs[i].data_off = (uint16_t) offset;
+        locs[i].data_len = (uint16_t) len;
+        offset += len;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Parse a header of a basicList
+ * \param[in]  data Data of the list
+ * \param[in]  size Size of the list
+ * \param[out] hdr  Parsed header
+ * \return True on success, false if the list is malformed
+ */
+static bool
+blist_hdr_parse(const uint8_t *data, uint16_t size, struct fl_blist_hdr *hdr)
+{
+    // Semantic (1B), Field ID (2B), Element Length (2B), [Enterprise Number (4B)]
+    if (size < 5U) {
+        return false;
+    }
+
+    uint16_t id = im_get16(&data[1]);
+    hdr->elem_len = im_get16(&data[3]);
+    hdr->en = 0;
+    hdr->len = 5U;
+
+    if ((id & 0x8000U) != 0) {
+        if (size < 9U) {
+            return false;
+        }
+        hdr->en = ((uint32_t) im_get16(&data[5]) << 16) | im_get16(&data[7]);
+        hdr->len = 9U;
+        id &= 0x7FFFU;
+    }
+
+    hdr->id = id;
+    return true;
+}
+
+/**
+ * \brief Write a value of a list element into a positional field
+ *
+ * Numbers are aligned to the right (and extended by the sign if necessary), other values are
+ * aligned to the left and padded with zeros.
+ * \param[in]  rule Rule of the list
+ * \param[in]  src  Value of the list element
+ * \param[in]  len  Size of the value
+ * \param[out] dst  Positional field (filled with zeros)
+ * \param[in]  size Size of the positional field
+ */
+static void
+blist_value_write(const struct fl_blist_rule *rule, const uint8_t *src, uint16_t len,
+    uint8_t *dst, uint16_t size)
+{
+    if (!rule->numeric) {
+        memcpy(dst, src, (len < size) ? len : size);
+        return;
+    }
+
+    if (len >= size) {
+        // Keep the least significant bytes
+        memcpy(dst, &src[len - size], size);
+        return;
+    }
+
+    if (rule->is_signed && len > 0 && (src[0] & 0x80U) != 0) {
+        memset(dst, 0xFF, size - len);
+    }
+    memcpy(&dst[size - len], src, len);
+}
+
+/**
+ * \brief Write a basicList as positional fields
+ *
+ * Missing positions and lists of a different element are filled with zeros.
+ * \param[in]  act  Action of the field
+ * \param[in]  data Data of the list
+ * \param[in]  size Size of the list
+ * \param[out] out  Output buffer (positions * size of positional fields)
+ */
+static void
+blist_write(const struct fl_action *act, const uint8_t *data, uint16_t size, uint8_t *out)
+{
+    const struct fl_blist_rule *rule = act->rule;
+    memset(out, 0, (size_t) rule->positions * act->size);
+
+    struct fl_blist_hdr hdr;
+    if (!blist_hdr_parse(data, size, &hdr) || hdr.en != rule->en || hdr.id != rule->id) {
+        return;
+    }
+
+    uint32_t offset = hdr.len;
+    for (uint16_t i = 0; i < rule->positions && offset < size; ++i) {
+        uint32_t len = hdr.elem_len;
+        if (len == FDS_IPFIX_VAR_IE_LEN) {
+            len = data[offset++];
+            if (len == 255U) {
+                if (offset + 2U > size) {
+                    return;
+                }
+                len = im_get16(&data[offset]);
+                offset += 2U;
+            }
+        }
+
+        if (offset + len > size) {
+            return;
+        }
+
+        blist_value_write(rule, &data[offset], (uint16_t) len, &out[i * act->size], act->size);
+        offset += len;
+    }
+}
+
+/**
+ * \brief Prepare an action of a basicList field
+ *
+ * The element of the list is known only from the list header, therefore, it is determined
+ * from the first record of the template. If the size of positional fields is not configured,
+ * the size of the list element is used (variable-length elements cannot be flattened).
+ * \param[in]  cfg  Configuration
+ * \param[in]  data Data of the list (from the first record)
+ * \param[in]  size Size of the list
+ * \param[out] act  Action to update
+ */
+static void
+blist_action(const struct fl_config *cfg, const uint8_t *data, uint16_t size,
+    struct fl_action *act)
+{
+    struct fl_blist_hdr hdr;
+    if (!blist_hdr_parse(data, size, &hdr)) {
+        return;
+    }
+
+    const struct fl_blist_rule *rule = rule_blist_find(cfg, hdr.en, hdr.id);
+    if (!rule) {
+        return;
+    }
+
+    const uint16_t pos_size = (rule->size != 0) ? rule->size : hdr.elem_len;
+    if (pos_size == FDS_IPFIX_VAR_IE_LEN || pos_size == 0) {
+        return;
+    }
+
+    act->rule = rule;
+    act->size = pos_size;
+}
+
+/**
+ * \brief Create a derived template
+ *
+ * Fields are given by actions of the source template and (optionally) by all fields of
+ * a child template.
+ * \param[in]  inst  Instance data
+ * \param[in]  id    Template ID of the derived template
+ * \param[in]  entry Conversion description (actions)
+ * \param[in]  src   Source template
+ * \param[in]  child Child template (can be NULL)
+ * \param[out] tmplt Parsed template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the template is too long
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+tmplt_create(struct instance_data *inst, uint16_t id, const struct fl_entry *entry,
+    const struct fds_template *src, const struct fds_template *child,
+    struct fds_template **tmplt)
+{
+    uint8_t *buf = inst->tbuf;
+    uint32_t len = FL_TREC_HDR_LEN;
+    uint32_t cnt = 0;
+
+    // Add a field specifier (returns false if the template would be too long)
+#define FL_TFIELD_ADD(f_en, f_id, f_len) do {                                           \
+        const uint32_t spec_len = ((f_en) != 0) ? FL_TFIELD_LEN_EN : FL_TFIELD_LEN;    \
+        if (len + spec_len > FL_TREC_MAX || cnt == FL_FIELDS_MAX) {                     \
+            return IPX_ERR_FORMAT;                                                      \
+        }                                                                               \
+        im_set16(&buf[len], (uint16_t) (((f_en) != 0) ? ((f_id) | 0x8000U) : (f_id)));  \
+        im_set16(&buf[len + 2], (f_len));                                               \
+        if ((f_en) != 0) {                                                              \
+            im_set16(&buf[len + 4], (uint16_t) ((f_en) >> 16));                         \
+            im_set16(&buf[len + 6], (uint16_t) (f_en));                                 \
+        }                                                                               \
+        len += spec_len;                                                                \
+        cnt++;                                                                          \
+    } while (0)
+
+    for (uint16_t i = 0; i < entry->actions_cnt; ++i) {
+        const struct fl_action *act = &entry->actions[i];
+        const struct fds_tfield *field = &src->fields[act->idx];
+        if (!act->rule) {
+            FL_TFIELD_ADD(field->en, field->id, field->length);
+            continue;
+        }
+
+        for (uint16_t p = 0; p < act->rule->positions; ++p) {
+            FL_TFIELD_ADD(act->rule->en, act->rule->id, act->size);
+        }
+    }
+
+    for (uint16_t i = 0; child != NULL && i < child->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &child->fields[i];
+        FL_TFIELD_ADD(field->en, field->id, field->length);
+    }
+#undef FL_TFIELD_ADD
+
+    im_set16(&buf[0], id);
+    im_set16(&buf[2], (uint16_t) cnt);
+
+    uint16_t tmplt_len = (uint16_t) len;
+    switch (fds_template_parse(FDS_TYPE_TEMPLATE, buf, &tmplt_len, tmplt)) {
+    case FDS_OK:
+        return IPX_OK;
+    case FDS_ERR_NOMEM:
+        return IPX_ERR_NOMEM;
+    default:
+        // For example, the total size of records is too long
+        return IPX_ERR_FORMAT;
+    }
+}
+
+/**
+ * \brief Create a conversion description of a source template
+ * \param[in]  inst   Instance data
+ * \param[in]  domain Observation Domain
+ * \param[in]  rec    The first Data Record of the template
+ * \param[out] entry  Created description (inserted into the domain)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+entry_create(struct instance_data *inst, struct fl_domain *domain, const struct fds_drec *rec,
+    struct fl_entry **entry)
+{
+    const struct fl_config *cfg = inst->config;
+    const struct fds_template *src = rec->tmplt;
+    struct fl_entry *new_entry = calloc(1, sizeof(*new_entry));
+    if (!new_entry) {
+        return IPX_ERR_NOMEM;
+    }
+
+    new_entry->type = FL_ENTRY_COPY;
+    if (im_entry_init(&new_entry->base, src) != IPX_OK) {
+        fl_entry_destroy(&new_entry->base);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (tmplt_needs(cfg, src) && fields_locate(src, rec->data, rec->size, inst->locs)) {
+        // Prepare actions of fields
+        new_entry->actions = malloc(src->fields_cnt_total * sizeof(*new_entry->actions));
+        if (!new_entry->actions) {
+            fl_entry_destroy(&new_entry->base);
+            return IPX_ERR_NOMEM;
+        }
+
+        bool flat = false;
+        for (uint16_t i = 0; i < src->fields_cnt_total; ++i) {
+            const struct fds_tfield *field = &src->fields[i];
+            const struct fl_split_rule *split;
+            if (new_entry->split == NULL && (split = rule_split_find(cfg, field)) != NULL) {
+                // Only the first list is split
+                new_entry->split = split;
+                new_entry->split_idx = i;
+                continue;
+            }
+
+            struct fl_action *act = &new_entry->actions[new_entry->actions_cnt++];
+            act->idx = i;
+            act->rule = NULL;
+            act->size = 0;
+            if (cfg->blists_cnt != 0 && field->def != NULL
+                    && field->def->data_type == FDS_ET_BASIC_LIST) {
+                const struct fl_loc *loc = &inst->locs[i];
+                blist_action(cfg, &rec->data[loc->data_off], loc->data_len, act);
+                flat |= (act->rule != NULL);
+            }
+        }
+
+        if (new_entry->split != NULL) {
+            new_entry->type = FL_ENTRY_SPLIT;
+        } else if (flat) {
+            new_entry->type = FL_ENTRY_FLAT;
+        }
+    }
+
+    // The source Template ID is now used by the exporter, derived templates must not use it
+    if (im_id_test(domain->ids_derived, src->id)) {
+        fl_domain_variants_reset(domain);
+    }
+
+    int rc;
+    struct fds_template *tmplt = NULL;
+    if (new_entry->type == FL_ENTRY_FLAT) {
+        rc = tmplt_create(inst, src->id, new_entry, src, NULL, &tmplt);
+        if (rc == IPX_ERR_FORMAT) {
+            IPX_CTX_WARNING(inst->ctx, "[ODID: %" PRIu32 "] Unable to flatten records of "
+                "Template ID %" PRIu16 " (too many positional fields). Records are passed "
+                "unmodified.", domain->base.odid, src->id);
+            new_entry->type = FL_ENTRY_COPY;
+        } else if (rc != IPX_OK) {
+            fl_entry_destroy(&new_entry->base);
+            return rc;
+        }
+    }
+
+    if (new_entry->type == FL_ENTRY_COPY) {
+        free(new_entry->actions);
+        new_entry->actions = NULL;
+        new_entry->actions_cnt = 0;
+        if ((tmplt = fds_template_copy(src)) == NULL) {
+            fl_entry_destroy(&new_entry->base);
+            return IPX_ERR_NOMEM;
+        }
+    }
+
+    if (tmplt != NULL) {
+        if ((rc = im_builder_tmplt_add(&inst->builder, tmplt)) != IPX_OK) {
+            fl_entry_destroy(&new_entry->base);
+            return rc;
+        }
+        new_entry->tmplt = tmplt;
+    }
+
+    if (fl_domain_entry_insert(domain, new_entry) != IPX_OK) {
+        fl_entry_destroy(&new_entry->base);
+        return IPX_ERR_NOMEM;
+    }
+
+    *entry = new_entry;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get a conversion description of the template of a Data Record
+ *
+ * The description is created if it doesn't exist or if the template has been redefined.
+ * \param[in]  inst   Instance data
+ * \param[in]  domain Observation Domain
+ * \param[in]  rec    Data Record
+ * \param[out] entry  Description
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+entry_get(struct instance_data *inst, struct fl_domain *domain, const struct fds_drec *rec,
+    struct fl_entry **entry)
+{
+    const struct fds_template *src = rec->tmplt;
+    struct im_entry *found = im_domain_entry_match(&domain->base, src);
+    if (found != NULL) {
+        *entry = (struct fl_entry *) found;
+        return IPX_OK;
+    }
+
+    return entry_create(inst, domain, rec, entry);
+}
+
+/**
+ * \brief Get a derived template for child records of a particular child template
+ * \param[in]  inst    Instance data
+ * \param[in]  domain  Observation Domain
+ * \param[in]  entry   Conversion description of the parent template
+ * \param[in]  src     Parent template
+ * \param[in]  child   Child template (NULL for records without child records)
+ * \param[out] tmplt   Derived template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the template cannot be created (too long, no free ID)
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+variant_get(struct instance_data *inst, struct fl_domain *domain, struct fl_entry *entry,
+    const struct fds_template *src, const struct fds_template *child,
+    const struct fds_template **tmplt)
+{
+    // Child templates are compared by content (a refreshed template can be a new object)
+    for (size_t i = 0; i < entry->variants_cnt; ++i) {
+        struct fl_variant *var = &entry->variants[i];
+        if (child == NULL || var->child == NULL) {
+            if (var->child != child) {
+                continue;
+            }
+        } else if (var->child_len != child->raw.length
+                || memcmp(var->child_raw, child->raw.data, child->raw.length) != 0) {
+            continue;
+        }
+
+        var->child = child;
+        *tmplt = var->tmplt;
+        return IPX_OK;
+    }
+
+    uint16_t id;
+    if (!fl_domain_id_alloc(domain, &id)) {
+        // All IDs are exhausted, start from scratch
+        fl_domain_variants_reset(domain);
+        if (!fl_domain_id_alloc(domain, &id)) {
+            return IPX_ERR_FORMAT;
+        }
+    }
+
+    uint8_t *child_raw = NULL;
+    if (child != NULL && (child_raw = malloc(child->raw.length)) == NULL) {
+        return IPX_ERR_NOMEM;
+    }
+
+    const size_t size_new = (entry->variants_cnt + 1) * sizeof(*entry->variants);
+    struct fl_variant *variants_new = realloc(entry->variants, size_new);
+    if (!variants_new) {
+        free(child_raw);
+        return IPX_ERR_NOMEM;
+    }
+    entry->variants = variants_new;
+
+    struct fds_template *tmplt_new;
+    int rc = tmplt_create(inst, id, entry, src, child, &tmplt_new);
+    if (rc == IPX_OK) {
+        rc = im_builder_tmplt_add(&inst->builder, tmplt_new);
+    }
+    if (rc != IPX_OK) {
+        free(child_raw);
+        return rc;
+    }
+
+    struct fl_variant *var = &entry->variants[entry->variants_cnt++];
+    var->child = child;
+    var->child_raw = child_raw;
+    var->child_len = 0;
+    var->tmplt = tmplt_new;
+    if (child != NULL) {
+        memcpy(child_raw, child->raw.data, child->raw.length);
+        var->child_len = child->raw.length;
+    }
+
+    *tmplt = tmplt_new;
+    return IPX_OK;
+}
+
+/**
+ * \brief Get the size of fields of a source record after conversion
+ * \param[in] entry Conversion description
+ * \param[in] locs  Positions of fields of the record
+ */
+static uint32_t
+actions_size(const struct fl_entry *entry, const struct fl_loc *locs)
+{
+    uint32_t size = 0;
+    for (uint16_t i = 0; i < entry->actions_cnt; ++i) {
+        const struct fl_action *act = &entry->actions[i];
+        size += (act->rule != NULL)
+            ? (uint32_t) act->rule->positions * act->size
+            : locs[act->idx].raw_len;
+    }
+
+    return size;
+}
+
+/**
+ * \brief Write fields of a source record after conversion
+ * \param[in]  entry Conversion description
+ * \param[in]  data  Data of the source record
+ * \param[in]  locs  Positions of fields of the record
+ * \param[out] out   Output buffer (see actions_size())
+ */
+static void
+actions_write(const struct fl_entry *entry, const uint8_t *data, const struct fl_loc *locs,
+    uint8_t *out)
+{
+    for (uint16_t i = 0; i < entry->actions_cnt; ++i) {
+        const struct fl_action *act = &entry->actions[i];
+        const struct fl_loc *loc = &locs[act->idx];
+        if (!act->rule) {
+            memcpy(out, &data[loc->raw_off], loc->raw_len);
+            out += loc->raw_len;
+            continue;
+        }
+
+        blist_write(act, &data[loc->data_off], loc->data_len, out);
+        out += (size_t) act->rule->positions * act->size;
+    }
+}
+
+/**
+ * \brief Add a record made of converted fields of a source record and a child record
+ * \param[in] inst   Instance data
+ * \param[in] domain Observation Domain
+ * \param[in] entry  Conversion description
+ * \param[in] rec    Source record
+ * \param[in] size   Size of converted fields of the source record
+ * \param[in] child  Child record (can be NULL)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the record cannot be converted
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+split_add(struct instance_data *inst, struct fl_domain *domain, struct fl_entry *entry,
+    const struct fds_drec *rec, uint32_t size, const struct fds_drec *child)
+{
+    const struct fds_template *tmplt;
+    int rc = variant_get(inst, domain, entry, rec->tmplt, (child) ? child->tmplt : NULL, &tmplt);
+    if (rc != IPX_OK) {
+        return rc;
+    }
+
+    uint8_t *out;
+    const uint32_t child_size = (child) ? child->size : 0;
+    if ((rc = im_builder_reserve(&inst->builder, tmplt, size + child_size, &out)) != IPX_OK) {
+        return rc;
+    }
+
+    actions_write(entry, rec->data, inst->locs, out);
+    if (child != NULL) {
+        memcpy(&out[size], child->data, child_size);
+    }
+    return IPX_OK;
+}
+
+/**
+ * \brief Convert a Data Record to records of the output message
+ * \param[in] inst   Instance data
+ * \param[in] domain Observation Domain
+ * \param[in] entry  Conversion description of the template of the record
+ * \param[in] rec    Data Record
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the record cannot be converted (it's dropped)
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+rec_process(struct instance_data *inst, struct fl_domain *domain, struct fl_entry *entry,
+    struct fds_drec *rec)
+{
+    uint8_t *out;
+    int rc;
+
+    if (entry->type == FL_ENTRY_COPY) {
+        if ((rc = im_builder_reserve(&inst->builder, entry->tmplt, rec->size, &out)) == IPX_OK) {
+            memcpy(out, rec->data, rec->size);
+        }
+        return rc;
+    }
+
+    if (!fields_locate(rec->tmplt, rec->data, rec->size, inst->locs)) {
+        return IPX_ERR_FORMAT;
+    }
+
+    const uint32_t size = actions_size(entry, inst->locs);
+    if (entry->type == FL_ENTRY_FLAT) {
+        if ((rc = im_builder_reserve(&inst->builder, entry->tmplt, size, &out)) == IPX_OK) {
+            actions_write(entry, rec->data, inst->locs, out);
+        }
+        return rc;
+    }
+
+    // Split the list into child records
+    const struct fl_loc *loc = &inst->locs[entry->split_idx];
+    struct fds_drec_field field;
+    field.data = &rec->data[loc->data_off];
+    field.size = loc->data_len;
+    field.info = &rec->tmplt->fields[entry->split_idx];
+    bool any = false;
+
+    if (!entry->split->multi) {
+        struct fds_stlist_iter it;
+        fds_stlist_iter_init(&it, &field, rec->snap, FDS_STL_TIGNORE);
+        while (fds_stlist_iter_next(&it) == FDS_OK) {
+            if ((rc = split_add(inst, domain, entry, rec, size, &it.rec)) == IPX_ERR_NOMEM) {
+                return rc;
+            }
+            any = true;
+        }
+    } else {
+        struct fds_stmlist_iter it;
+        fds_stmlist_iter_init(&it, &field, rec->snap, FDS_STL_TIGNORE);
+        while (fds_stmlist_iter_next_block(&it) == FDS_OK) {
+            while (fds_stmlist_iter_next_rec(&it) == FDS_OK) {
+                if ((rc = split_add(inst, domain, entry, rec, size, &it.rec)) == IPX_ERR_NOMEM) {
+                    return rc;
+                }
+                any = true;
+            }
+        }
+    }
+
+    // Records without (known) child records are preserved
+    return any ? IPX_OK : split_add(inst, domain, entry, rec, size, NULL);
+}
+
+/**
+ * \brief Process an IPFIX Message
+ *
+ * If the message contains records to convert, it's replaced by one or more new messages.
+ * Records of an Observation Domain are converted (or copied) under templates of a private
+ * template manager of the domain since the first message that required flattening.
+ * \param[in] ctx  Plugin context
+ * \param[in] inst Instance data
+ * \param[in] msg  IPFIX Message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+process_ipfix(ipx_ctx_t *ctx, struct instance_data *inst, ipx_msg_ipfix_t *msg)
+{
+    struct im_domain *base;
+    int rc = im_domains_msg_get(&inst->domains, ctx, msg, &tmplt_needs, inst->config, &base);
+    if (rc != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+    if (!base) {
+        // Nothing to convert
+        ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
+        return rc;
+    }
+
+    struct fl_domain *domain = (struct fl_domain *) base;
+    im_builder_start(&inst->builder, base, msg);
+
+    uint32_t dropped = 0;
+    struct fl_entry *entry = NULL;
+    const struct fds_template *entry_src = NULL;
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+
+    for (uint32_t i = 0; i < rec_cnt && rc != IPX_ERR_NOMEM; ++i) {
+        struct fds_drec *rec = &ipx_msg_ipfix_get_drec(msg, i)->rec;
+        if (rec->tmplt != entry_src) {
+            if ((rc = entry_get(inst, domain, rec, &entry)) != IPX_OK) {
+                break;
+            }
+            entry_src = rec->tmplt;
+        }
+
+        if ((rc = rec_process(inst, domain, entry, rec)) == IPX_ERR_FORMAT) {
+            dropped++;
+        }
+    }
+
+    rc = im_builder_finish(&inst->builder, msg, rc);
+    if (dropped != 0) {
+        IPX_CTX_WARNING(ctx, "[ODID: %" PRIu32 "] %" PRIu32 " record(s) couldn't be converted "
+            "and have been dropped.", base->odid, dropped);
+    }
+
+    if (rc == IPX_ERR_NOMEM) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+    }
+    return rc;
+}
+
+/**
+ * \brief Destroy instance data
+ * \param[in] inst Instance data
+ */
+static void
+instance_destroy(struct instance_data *inst)
+{
+    im_domains_clear(&inst->domains);
+    im_builder_free(&inst->builder);
+    free(inst->locs);
+    free(inst->tbuf);
+    if (inst->config) {
+        config_destroy(inst->config);
+    }
+    free(inst);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = ctx;
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    im_domains_init(&data->domains, sizeof(struct fl_domain), &fl_entry_destroy);
+    const int bld_rc = im_builder_init(&data->builder, ctx);
+    data->locs = malloc(FL_FIELDS_MAX * sizeof(*data->locs));
+    data->tbuf = malloc(FL_TREC_MAX);
+    if (bld_rc != IPX_OK || !data->locs || !data->tbuf) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Subscribe to receive IPFIX and Transport Session Messages
+    const ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to subscribe to receive IPFIX and Transport Session Messages.",
+            '\0');
+        instance_destroy(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx; // Suppress warnings
+    instance_destroy((struct instance_data *) cfg);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    switch (ipx_msg_get_type(msg)) {
+    case IPX_MSG_IPFIX:
+        return process_ipfix(ctx, data, ipx_msg_base2ipfix(msg));
+    case IPX_MSG_SESSION:
+        im_domains_session(&data->domains, ctx, ipx_msg_base2session(msg));
+        return IPX_OK;
+    default:
+        ipx_ctx_msg_pass(ctx, msg);
+        return IPX_OK;
+    }
+}
@@ -0,0 +1,199 @@
+/**
+ * \file src/plugins/intermediate/optcache/cache.c
+ * \author agent <agent@local>
+ * \brief Lookup tables of options data (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+
+/** Number of entries added to a lookup table at once */
+#define OC_TABLE_STEP 16U
+
+/**
+ * \brief Find position of a key in a lookup table (binary search)
+ * \param[in]  tbl Lookup table
+ * \param[in]  key Key
+ * \param[out] pos Position of the entry or position where the entry should be inserted
+ * \return True if the entry exists
+ */
+static bool
+oc_table_pos(const struct oc_table *tbl, uint64_t key, size_t *pos)
+{
+    size_t low = 0;
+    size_t high = tbl->cnt;
+
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const uint64_t mid_key = tbl->items[mid].key;
+        if (mid_key == key) {
+            *pos = mid;
+            return true;
+        }
+
+        if (mid_key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *pos = low;
+    return false;
+}
+
+const struct oc_entry *
+oc_table_find(const struct oc_table *tbl, uint64_t key)
+{
+    size_t pos;
+    return oc_table_pos(tbl, key, &pos) ? &tbl->items[pos] : NULL;
+}
+
+struct oc_entry *
+oc_table_set(struct oc_table *tbl, uint64_t key)
+{
+    size_t pos;
+    if (oc_table_pos(tbl, key, &pos)) {
+        return &tbl->items[pos];
+    }
+
+    if (tbl->cnt == tbl->alloc) {
+        const size_t alloc_new = tbl->alloc + OC_TABLE_STEP;
+        struct oc_entry *items_new = realloc(tbl->items, alloc_new * sizeof(*items_new));
+        if (!items_new) {
+            return NULL;
+        }
+
+        tbl->items = items_new;
+        tbl->alloc = alloc_new;
+    }
+
+    // Make space for the new entry (options records are rare, therefore, it is cheap enough)
+    memmove(&tbl->items[pos + 1], &tbl->items[pos], (tbl->cnt - pos) * sizeof(*tbl->items));
+    tbl->cnt++;
+
+    struct oc_entry *entry = &tbl->items[pos];
+    memset(entry, 0, sizeof(*entry));
+    entry->key = key;
+    return entry;
+}
+
+/**
+ * \brief Destroy an Observation Domain
+ * \param[in] domain Domain
+ */
+static void
+oc_domain_destroy(struct oc_domain *domain)
+{
+    free(domain->ifaces.items);
+    free(domain->vrfs.items);
+    free(domain->samplers.items);
+    free(domain);
+}
+
+struct oc_domain *
+oc_domains_get(struct oc_domains *domains, const struct ipx_session *session, uint32_t odid,
+    bool create)
+{
+    struct oc_domain *last = domains->last;
+    if (last != NULL && last->session == session && last->odid == odid) {
+        return last;
+    }
+
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        struct oc_domain *domain = domains->items[i];
+        if (domain->session == session && domain->odid == odid) {
+            domains->last = domain;
+            return domain;
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    const size_t items_size = (domains->cnt + 1) * sizeof(*domains->items);
+    struct oc_domain **items_new = realloc(domains->items, items_size);
+    if (!items_new) {
+        return NULL;
+    }
+    domains->items = items_new;
+
+    struct oc_domain *domain = calloc(1, sizeof(*domain));
+    if (!domain) {
+        return NULL;
+    }
+
+    domain->session = session;
+    domain->odid = odid;
+    domains->items[domains->cnt++] = domain;
+    domains->last = domain;
+    return domain;
+}
+
+void
+oc_domains_remove(struct oc_domains *domains, const struct ipx_session *session)
+{
+    size_t idx = 0;
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        struct oc_domain *domain = domains->items[i];
+        if (domain->session != session) {
+            domains->items[idx++] = domain;
+            continue;
+        }
+
+        oc_domain_destroy(domain);
+    }
+
+    domains->cnt = idx;
+    domains->last = NULL;
+}
+
+void
+oc_domains_clear(struct oc_domains *domains)
+{
+    for (size_t i = 0; i < domains->cnt; ++i) {
+        oc_domain_destroy(domains->items[i]);
+    }
+
+    free(domains->items);
+    domains->items = NULL;
+    domains->cnt = 0;
+    domains->last = NULL;
+}
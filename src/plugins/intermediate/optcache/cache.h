@@ -0,0 +1,146 @@
+/**
+ * \file src/plugins/intermediate/optcache/cache.h
+ * \author agent <agent@local>
+ * \brief Lookup tables of options data (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef OPTCACHE_CACHE_H
+#define OPTCACHE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ipfixcol2.h>
+#include "optcache.h"
+
+/** Entry of a lookup table */
+struct oc_entry {
+    /** Key (interface index, VRF ID, sampler ID)   */
+    uint64_t key;
+    /** Numeric value (sampling interval)           */
+    uint32_t value;
+    /** Name (can be empty)                         */
+    char name[OPTCACHE_NAME_LEN];
+};
+
+/** Lookup table (entries are sorted by key) */
+struct oc_table {
+    /** Array of entries                            */
+    struct oc_entry *items;
+    /** Number of valid entries                     */
+    size_t cnt;
+    /** Number of allocated entries                 */
+    size_t alloc;
+};
+
+/** Options data of an Observation Domain of a Transport Session */
+struct oc_domain {
+    /** Transport Session                           */
+    const struct ipx_session *session;
+    /** Observation Domain ID                       */
+    uint32_t odid;
+
+    /** Interfaces (key: ingressInterface/egressInterface)     */
+    struct oc_table ifaces;
+    /** VRFs (key: ingressVRFID/egressVRFID)                   */
+    struct oc_table vrfs;
+    /** Samplers (key: samplerId/selectorId)                   */
+    struct oc_table samplers;
+    /** Sampling of the whole domain (without a sampler ID)    */
+    struct oc_entry sampling;
+};
+
+/** Collection of all Observation Domains */
+struct oc_domains {
+    /** Array of domains                            */
+    struct oc_domain **items;
+    /** Number of domains                           */
+    size_t cnt;
+    /** Last accessed domain (can be NULL)          */
+    struct oc_domain *last;
+};
+
+/**
+ * \brief Find an entry in a lookup table
+ * \param[in] tbl Lookup table
+ * \param[in] key Key
+ * \return Pointer to the entry or NULL
+ */
+const struct oc_entry *
+oc_table_find(const struct oc_table *tbl, uint64_t key);
+
+/**
+ * \brief Get an entry of a lookup table for modification (create it, if missing)
+ *
+ * Newly created entry has zero value and empty name.
+ * \warning Pointers to entries are invalidated by adding a new entry!
+ * \param[in] tbl Lookup table
+ * \param[in] key Key
+ * \return Pointer to the entry or NULL (memory allocation error)
+ */
+struct oc_entry *
+oc_table_set(struct oc_table *tbl, uint64_t key);
+
+/**
+ * \brief Get options data of an Observation Domain
+ * \param[in] domains Collection of domains
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \param[in] create  Create the domain if missing
+ * \return Pointer to the domain or NULL (not found or memory allocation error)
+ */
+struct oc_domain *
+oc_domains_get(struct oc_domains *domains, const struct ipx_session *session, uint32_t odid,
+    bool create);
+
+/**
+ * \brief Remove all Observation Domains of a Transport Session
+ * \param[in] domains Collection of domains
+ * \param[in] session Transport Session
+ */
+void
+oc_domains_remove(struct oc_domains *domains, const struct ipx_session *session);
+
+/**
+ * \brief Remove all Observation Domains
+ * \param[in] domains Collection of domains
+ */
+void
+oc_domains_clear(struct oc_domains *domains);
+
+#endif // OPTCACHE_CACHE_H
@@ -0,0 +1,525 @@
+/**
+ * \file src/plugins/intermediate/optcache/optcache.c
+ * \author agent <agent@local>
+ * \brief Options cache plugin (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cache.h"
+#include "config.h"
+#include "optcache.h"
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INTERMEDIATE,
+    // Plugin identification name
+    .name = "optcache",
+    // Brief description of plugin
+    .dsc = "Annotation of flow records with exporter metadata from Options Template records",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.1.0"
+};
+
+/** IANA Information Elements used by the plugin */
+enum oc_ie {
+    OC_IE_INGRESS_IF    = 10,  /**< ingressInterface          */
+    OC_IE_EGRESS_IF     = 14,  /**< egressInterface           */
+    OC_IE_SAMP_INTERVAL = 34,  /**< samplingInterval          */
+    OC_IE_SAMPLER_ID    = 48,  /**< samplerId                 */
+    OC_IE_SAMP_RANDOM   = 50,  /**< samplerRandomInterval     */
+    OC_IE_IF_NAME       = 82,  /**< interfaceName             */
+    OC_IE_IF_DESC       = 83,  /**< interfaceDescription      */
+    OC_IE_SAMPLER_NAME  = 84,  /**< samplerName               */
+    OC_IE_INGRESS_VRF   = 234, /**< ingressVRFID              */
+    OC_IE_EGRESS_VRF    = 235, /**< egressVRFID               */
+    OC_IE_VRF_NAME      = 236, /**< VRFname                   */
+    OC_IE_SELECTOR_ID   = 302, /**< selectorId                */
+    OC_IE_PKT_INTERVAL  = 305, /**< samplingPacketInterval    */
+    OC_IE_PKT_SPACE     = 306, /**< samplingPacketSpace       */
+    OC_IE_SELECTOR_NAME = 335  /**< selectorName              */
+};
+
+/** Fields of Data Records that refer to options data */
+enum oc_field {
+    OC_F_IN_IF,      /**< ingressInterface                 */
+    OC_F_OUT_IF,     /**< egressInterface                  */
+    OC_F_IN_VRF,     /**< ingressVRFID                     */
+    OC_F_OUT_VRF,    /**< egressVRFID                      */
+    OC_F_SAMPLER,    /**< samplerId (or selectorId)        */
+    OC_F_CNT         /**< Number of fields (must be last)  */
+};
+
+/** Precomputed positions of the referencing fields in a template */
+struct oc_tmplt_pos {
+    /** Template (NULL == not prepared yet)                                               */
+    const struct fds_template *tmplt;
+    /** At least one field is present                                                     */
+    bool any;
+    /** Description of fields (NULL == not present)                                       */
+    const struct fds_tfield *fields[OC_F_CNT];
+};
+
+/** Instance */
+struct instance_data {
+    /** Parsed configuration of the instance    */
+    struct oc_config *config;
+    /** Produced record extension               */
+    ipx_ctx_rext_t *rext;
+    /** Options data of Observation Domains     */
+    struct oc_domains domains;
+};
+
+/**
+ * \brief Get an unsigned value of a field of a Data Record
+ * \param[in]  rec   Data Record
+ * \param[in]  id    Information Element ID (IANA)
+ * \param[out] value Value
+ * \return True on success, false if the field is missing or invalid
+ */
+static bool
+drec_get_uint(struct fds_drec *rec, uint16_t id, uint64_t *value)
+{
+    struct fds_drec_field field;
+    if (fds_drec_find(rec, 0, id, &field) == FDS_EOC) {
+        return false;
+    }
+
+    return fds_get_uint_be(field.data, field.size, value) == FDS_OK;
+}
+
+/**
+ * \brief Copy a string field of a Data Record
+ *
+ * The name is truncated if necessary and always null-terminated.
+ * \param[in]  rec  Data Record
+ * \param[in]  id   Information Element ID (IANA)
+ * \param[out] name Output buffer
+ * \return True if the field is present, false otherwise (the buffer is not modified)
+ */
+static bool
+drec_get_name(struct fds_drec *rec, uint16_t id, char name[OPTCACHE_NAME_LEN])
+{
+    struct fds_drec_field field;
+    if (fds_drec_find(rec, 0, id, &field) == FDS_EOC) {
+        return false;
+    }
+
+    // Strings in IPFIX are not null-terminated, however, some exporters add padding
+    size_t len = (field.size < OPTCACHE_NAME_LEN - 1) ? field.size : OPTCACHE_NAME_LEN - 1;
+    const uint8_t *end = memchr(field.data, '\0', len);
+    if (end != NULL) {
+        len = (size_t) (end - field.data);
+    }
+
+    memcpy(name, field.data, len);
+    name[len] = '\0';
+    return true;
+}
+
+/**
+ * \brief Get a sampling interval described by an options record
+ * \param[in]  rec      Data Record (based on an Options Template)
+ * \param[out] interval Sampling interval (1 out of N packets)
+ * \return True if the record describes a sampling interval
+ */
+static bool
+opts_sampling(struct fds_drec *rec, uint32_t *interval)
+{
+    uint64_t value;
+    if (drec_get_uint(rec, OC_IE_SAMP_INTERVAL, &value)
+            || drec_get_uint(rec, OC_IE_SAMP_RANDOM, &value)) {
+        *interval = (uint32_t) value;
+        return true;
+    }
+
+    // Systematic count-based sampling (RFC 5477): N packets selected, M packets skipped
+    uint64_t selected, skipped;
+    if (drec_get_uint(rec, OC_IE_PKT_INTERVAL, &selected)
+            && drec_get_uint(rec, OC_IE_PKT_SPACE, &skipped) && selected != 0) {
+        *interval = (uint32_t) ((selected + skipped) / selected);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Update lookup tables using a record based on an Options Template
+ * \param[in] ctx    Plugin context (only for log)
+ * \param[in] domain Options data of the Observation Domain
+ * \param[in] rec    Data Record (based on an Options Template)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+opts_process(ipx_ctx_t *ctx, struct oc_domain *domain, struct fds_drec *rec)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    struct oc_table *tbl = NULL;
+    uint16_t scope_id = 0;
+
+    // Determine the table based on the scope fields
+    for (uint16_t i = 0; i < tmplt->fields_cnt_scope && tbl == NULL; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (field->en != 0) {
+            continue;
+        }
+
+        switch (field->id) {
+        case OC_IE_INGRESS_IF:
+        case OC_IE_EGRESS_IF:
+            tbl = &domain->ifaces;
+            break;
+        case OC_IE_INGRESS_VRF:
+        case OC_IE_EGRESS_VRF:
+            tbl = &domain->vrfs;
+            break;
+        case OC_IE_SAMPLER_ID:
+        case OC_IE_SELECTOR_ID:
+            tbl = &domain->samplers;
+            break;
+        default:
+            continue;
+        }
+
+        scope_id = field->id;
+    }
+
+    uint32_t interval;
+    if (tbl == NULL) {
+        // Sampling configuration of the whole Observation Domain (e.g. from NetFlow v9)
+        if (opts_sampling(rec, &interval)) {
+            domain->sampling.value = interval;
+            drec_get_name(rec, OC_IE_SAMPLER_NAME, domain->sampling.name);
+        }
+        return IPX_OK;
+    }
+
+    uint64_t key;
+    if (!drec_get_uint(rec, scope_id, &key)) {
+        return IPX_OK;
+    }
+
+    struct oc_entry *entry = oc_table_set(tbl, key);
+    if (!entry) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (tbl == &domain->ifaces) {
+        if (!drec_get_name(rec, OC_IE_IF_NAME, entry->name)) {
+            drec_get_name(rec, OC_IE_IF_DESC, entry->name);
+        }
+    } else if (tbl == &domain->vrfs) {
+        drec_get_name(rec, OC_IE_VRF_NAME, entry->name);
+    } else {
+        if (opts_sampling(rec, &interval)) {
+            entry->value = interval;
+        }
+        if (!drec_get_name(rec, OC_IE_SAMPLER_NAME, entry->name)) {
+            drec_get_name(rec, OC_IE_SELECTOR_NAME, entry->name);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Prepare positions of fields that refer to options data
+ * \param[out] pos   Positions to fill
+ * \param[in]  tmplt Template of Data Records
+ */
+static void
+tmplt_pos_prepare(struct oc_tmplt_pos *pos, const struct fds_template *tmplt)
+{
+    memset(pos, 0, sizeof(*pos));
+    pos->tmplt = tmplt;
+
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (field->en != 0) {
+            continue;
+        }
+
+        enum oc_field idx;
+        switch (field->id) {
+        case OC_IE_INGRESS_IF:  idx = OC_F_IN_IF;   break;
+        case OC_IE_EGRESS_IF:   idx = OC_F_OUT_IF;  break;
+        case OC_IE_INGRESS_VRF: idx = OC_F_IN_VRF;  break;
+        case OC_IE_EGRESS_VRF:  idx = OC_F_OUT_VRF; break;
+        case OC_IE_SAMPLER_ID:
+        case OC_IE_SELECTOR_ID: idx = OC_F_SAMPLER; break;
+        default:
+            continue;
+        }
+
+        if (pos->fields[idx] == NULL) {
+            // Only the first occurrence is used
+            pos->fields[idx] = field;
+            pos->any = true;
+        }
+    }
+}
+
+/**
+ * \brief Get a value of a referencing field of a Data Record
+ *
+ * If the offset of the field is known, the value is read directly. Otherwise, the field must
+ * be found (i.e. a variable-length field is placed before the field).
+ * \param[in]  pos   Precomputed positions of the template
+ * \param[in]  idx   Field to get
+ * \param[in]  rec   Data Record
+ * \param[out] value Value of the field
+ * \return True on success, false if the field is missing
+ */
+static inline bool
+tmplt_pos_get(const struct oc_tmplt_pos *pos, enum oc_field idx, struct fds_drec *rec,
+    uint64_t *value)
+{
+    const struct fds_tfield *field = pos->fields[idx];
+    if (!field) {
+        return false;
+    }
+
+    if (field->offset != FDS_IPFIX_VAR_IE_LEN) {
+        return fds_get_uint_be(rec->data + field->offset, field->length, value) == FDS_OK;
+    }
+
+    return drec_get_uint(rec, field->id, value);
+}
+
+/**
+ * \brief Fill a name from a lookup table
+ * \param[in]  tbl   Lookup table
+ * \param[in]  pos   Precomputed positions of the template
+ * \param[in]  idx   Field with the key
+ * \param[in]  rec   Data Record
+ * \param[out] name  Output name (empty if not found)
+ * \return True if the name has been found
+ */
+static inline bool
+meta_name(const struct oc_table *tbl, const struct oc_tmplt_pos *pos, enum oc_field idx,
+    struct fds_drec *rec, char name[OPTCACHE_NAME_LEN])
+{
+    uint64_t key;
+    const struct oc_entry *entry;
+    if (tbl->cnt == 0 || !tmplt_pos_get(pos, idx, rec, &key)
+            || (entry = oc_table_find(tbl, key)) == NULL) {
+        name[0] = '\0';
+        return false;
+    }
+
+    memcpy(name, entry->name, OPTCACHE_NAME_LEN);
+    return true;
+}
+
+/**
+ * \brief Resolve exporter metadata of a Data Record
+ * \param[in]  domain Options data of the Observation Domain
+ * \param[in]  pos    Precomputed positions of the template of the record
+ * \param[in]  rec    Data Record
+ * \param[out] meta   Metadata to fill
+ * \return True if at least one piece of metadata is known
+ */
+static bool
+meta_resolve(const struct oc_domain *domain, const struct oc_tmplt_pos *pos,
+    struct fds_drec *rec, struct optcache_meta *meta)
+{
+    bool found = false;
+    found |= meta_name(&domain->ifaces, pos, OC_F_IN_IF, rec, meta->in_if_name);
+    found |= meta_name(&domain->ifaces, pos, OC_F_OUT_IF, rec, meta->out_if_name);
+    found |= meta_name(&domain->vrfs, pos, OC_F_IN_VRF, rec, meta->in_vrf_name);
+    found |= meta_name(&domain->vrfs, pos, OC_F_OUT_VRF, rec, meta->out_vrf_name);
+
+    uint64_t key;
+    const struct oc_entry *sampler = NULL;
+    if (domain->samplers.cnt != 0 && tmplt_pos_get(pos, OC_F_SAMPLER, rec, &key)) {
+        sampler = oc_table_find(&domain->samplers, key);
+    }
+    if (!sampler && domain->sampling.value != 0) {
+        sampler = &domain->sampling;
+    }
+
+    if (sampler != NULL) {
+        memcpy(meta->sampler_name, sampler->name, OPTCACHE_NAME_LEN);
+        meta->sampling_interval = sampler->value;
+        found = true;
+    } else {
+        meta->sampler_name[0] = '\0';
+        meta->sampling_interval = 0;
+    }
+
+    return found;
+}
+
+/**
+ * \brief Process an IPFIX Message
+ * \param[in] ctx  Plugin context
+ * \param[in] data Instance data
+ * \param[in] msg  IPFIX Message
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+process_ipfix(ipx_ctx_t *ctx, struct instance_data *data, ipx_msg_ipfix_t *msg)
+{
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
+    struct oc_domain *domain = oc_domains_get(&data->domains, msg_ctx->session, msg_ctx->odid,
+        false);
+    // Positions are valid only within the message (templates can be freed later)
+    struct oc_tmplt_pos pos = {.tmplt = NULL};
+
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, i);
+        const struct fds_template *tmplt = rec->rec.tmplt;
+
+        if (tmplt->type == FDS_TYPE_TEMPLATE_OPTS) {
+            if (!domain) {
+                domain = oc_domains_get(&data->domains, msg_ctx->session, msg_ctx->odid, true);
+                if (!domain) {
+                    IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                    return IPX_ERR_NOMEM;
+                }
+            }
+
+            int rc = opts_process(ctx, domain, &rec->rec);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+            continue;
+        }
+
+        if (!domain) {
+            // No options data of the Observation Domain yet
+            continue;
+        }
+
+        if (tmplt != pos.tmplt) {
+            tmplt_pos_prepare(&pos, tmplt);
+        }
+
+        void *ext_data;
+        ipx_ctx_rext_get(data->rext, rec, &ext_data, NULL);
+        if (pos.any && meta_resolve(domain, &pos, &rec->rec, ext_data)) {
+            ipx_ctx_rext_set_filled(data->rext, rec);
+        }
+    }
+
+    return IPX_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    // Create a private data
+    struct instance_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        return IPX_ERR_DENIED;
+    }
+
+    if ((data->config = config_parse(ctx, params)) == NULL) {
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    const size_t ext_size = sizeof(struct optcache_meta);
+    if (ipx_ctx_rext_producer(ctx, OPTCACHE_EXT_TYPE, data->config->ext_name, ext_size,
+            &data->rext) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to register the record extension.", '\0');
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Subscribe to receive IPFIX and Transport Session Messages
+    const ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to subscribe to receive IPFIX and Transport Session Messages.",
+            '\0');
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx; // Suppress warnings
+    struct instance_data *data = (struct instance_data *) cfg;
+
+    oc_domains_clear(&data->domains);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    struct instance_data *data = (struct instance_data *) cfg;
+    int rc = IPX_OK;
+
+    const enum ipx_msg_type type = ipx_msg_get_type(msg);
+    if (type == IPX_MSG_IPFIX) {
+        rc = process_ipfix(ctx, data, ipx_msg_base2ipfix(msg));
+    } else if (type == IPX_MSG_SESSION) {
+        // Options data of closed sessions are not valid anymore
+        ipx_msg_session_t *session_msg = ipx_msg_base2session(msg);
+        if (ipx_msg_session_get_event(session_msg) == IPX_MSG_SESSION_CLOSE) {
+            oc_domains_remove(&data->domains, ipx_msg_session_get_session(session_msg));
+        }
+    }
+
+    // Always pass the message
+    ipx_ctx_msg_pass(ctx, msg);
+    return rc;
+}
@@ -0,0 +1,86 @@
+/**
+ * \file src/plugins/intermediate/optcache/optcache.h
+ * \author agent <agent@local>
+ * \brief Exporter metadata produced by the options cache plugin (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_OPTCACHE_H
+#define IPX_OPTCACHE_H
+
+#include <stdint.h>
+
+/**
+ * \defgroup optcacheExt Exporter metadata extension
+ * \brief Record extension produced by the options cache plugin
+ *
+ * The plugin attaches the structure to each Data Record for which at least one piece of metadata
+ * is known. A consumer (e.g. an output plugin) can get it using ipx_ctx_rext_consumer() with
+ * the type #OPTCACHE_EXT_TYPE and the name from the plugin configuration.
+ * @{
+ */
+
+/** Type of the record extension                                    */
+#define OPTCACHE_EXT_TYPE "exporter-meta"
+/** Default name of the record extension                            */
+#define OPTCACHE_EXT_NAME "exporter-meta"
+/** Maximum length of a name (including the terminating null byte)  */
+#define OPTCACHE_NAME_LEN 32
+
+/**
+ * \brief Exporter metadata of a Data Record
+ *
+ * Unknown (or not referenced) names are empty strings, unknown sampling interval is 0.
+ * Longer names are truncated.
+ */
+struct optcache_meta {
+    /** Name of the ingress interface (ingressInterface -> interfaceName)   */
+    char in_if_name[OPTCACHE_NAME_LEN];
+    /** Name of the egress interface (egressInterface -> interfaceName)     */
+    char out_if_name[OPTCACHE_NAME_LEN];
+    /** Name of the ingress VRF (ingressVRFID -> VRFname)                   */
+    char in_vrf_name[OPTCACHE_NAME_LEN];
+    /** Name of the egress VRF (egressVRFID -> VRFname)                     */
+    char out_vrf_name[OPTCACHE_NAME_LEN];
+    /** Name of the sampler (samplerId/selectorId -> samplerName)           */
+    char sampler_name[OPTCACHE_NAME_LEN];
+    /** Sampling interval (i.e. 1 out of N packets is sampled)              */
+    uint32_t sampling_interval;
+};
+
+/**@}*/
+#endif // IPX_OPTCACHE_H
@@ -54,8 +54,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "dummy",
     // Brief description of plugin
     .dsc = "Example output plugin.",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (Data Records are never accessed)
+    .flags = IPX_PF_SET_LEVEL,
     // Plugin version string (like "1.2.3")
     .version = "2.0.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -82,6 +82,7 @@ Storage::window_close()
 {
     m_file.reset();
     m_session2params.clear();
+    m_last = last_ctx();
 }
 
 void
@@ -92,46 +93,57 @@ Storage::process_msg(ipx_msg_ipfix_t *msg)
         return;
     }
 
+    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
+    if (rec_cnt == 0) {
+        // Nothing to store (e.g. only (Options) Template Sets or all records have been filtered)
+        return;
+    }
+
     // Specify a Transport Session context
     struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg);
-    session_ctx &file_ctx = session_get(msg_ctx->session);
+    struct snap_info &snap_last = snap_get(msg_ctx->session, msg_ctx->odid);
 
     auto hdr_ptr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg));
     assert(ntohs(hdr_ptr->version) == FDS_IPFIX_VERSION && "Unexpected packet version");
     const uint32_t exp_time = ntohl(hdr_ptr->export_time);
 
-    if (fds_file_write_ctx(m_file.get(), file_ctx.id, msg_ctx->odid, exp_time) != FDS_OK) {
-        const char *err_msg = fds_file_error(m_file.get());
+    fds_file_t *file = m_file.get();
+    if (fds_file_write_ctx(file, m_last.session->id, msg_ctx->odid, exp_time) != FDS_OK) {
+        const char *err_msg = fds_file_error(file);
         throw FDS_exception("Failed to configure the writer: " + std::string(err_msg));
     }
 
-    // Get info about the last seen Template snapshot
-    struct snap_info &snap_last = file_ctx.odid2snap[msg_ctx->odid];
-
-    // For each Data Record in the file
-    const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg);
-    for (uint32_t i = 0; i < rec_cnt; ++i) {
-        ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg, i);
+    // Data Records are processed in runs of consecutive records of the same Template (typically
+    // all records of a Data Set), therefore, the Template snapshot is checked only once per run
+    uint32_t idx = 0;
+    while (idx < rec_cnt) {
+        const struct fds_drec *rec = &ipx_msg_ipfix_get_drec(msg, idx)->rec;
+        const struct fds_template *run_tmplt = rec->tmplt;
+        const fds_tsnapshot_t *run_snap = rec->snap;
 
         // Check if the templates has been changed (detected by change of template snapshots)
-        if (rec_ptr->rec.snap != snap_last.ptr) {
+        if (run_snap != snap_last.ptr) {
             const char *session_name = msg_ctx->session->ident;
             uint32_t session_odid = msg_ctx->odid;
             IPX_CTX_DEBUG(m_ctx, "Template snapshot of '%s' [ODID %" PRIu32 "] has been changed. "
                 "Updating template definitions...", session_name, session_odid);
 
-            tmplts_update(snap_last, rec_ptr->rec.snap);
+            tmplts_update(snap_last, run_snap);
         }
 
-        // Write the Data Record
-        const uint8_t *rec_data = rec_ptr->rec.data;
-        uint16_t rec_size = rec_ptr->rec.size;
-        uint16_t tmplt_id = rec_ptr->rec.tmplt->id;
-
-        if (fds_file_write_rec(m_file.get(), tmplt_id, rec_data, rec_size) != FDS_OK) {
-            const char *err_msg = fds_file_error(m_file.get());
-            throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
-        }
+        // Write all Data Records of the run
+        const uint16_t tmplt_id = run_tmplt->id;
+        do {
+            if (fds_file_write_rec(file, tmplt_id, rec->data, rec->size) != FDS_OK) {
+                const char *err_msg = fds_file_error(file);
+                throw FDS_exception("Failed to add a Data Record: " + std::string(err_msg));
+            }
+
+            if (++idx == rec_cnt) {
+                break;
+            }
+            rec = &ipx_msg_ipfix_get_drec(msg, idx)->rec;
+        } while (rec->tmplt == run_tmplt && rec->snap == run_snap);
     }
 }
 
@@ -372,6 +384,33 @@ Storage::session_get(const struct ipx_session *sptr)
     return ctx;
 }
 
+/**
+ * @brief Get information about the last seen Template snapshot of a Transport Session and ODID
+ *
+ * Messages of the same combination usually come in long sequences, therefore, the result of
+ * the previous lookup is reused without searching the maps. The file identification of
+ * the Transport Session is also remembered (see \ref m_last).
+ *
+ * @param[in] sptr Transport Session
+ * @param[in] odid Observation Domain ID
+ * @return Information about the snapshot
+ * @throw FDS_exception if the function failed to add a new Transport Session
+ */
+struct Storage::snap_info &
+Storage::snap_get(const struct ipx_session *sptr, uint32_t odid)
+{
+    if (m_last.sptr == sptr && m_last.odid == odid && m_last.snap != nullptr) {
+        return *m_last.snap;
+    }
+
+    struct session_ctx &ctx = session_get(sptr);
+    m_last.sptr = sptr;
+    m_last.odid = odid;
+    m_last.session = &ctx;
+    m_last.snap = &ctx.odid2snap[odid];
+    return *m_last.snap;
+}
+
 /**
  * @brief Convert IPFIXcol representation of a Transport Session to FDS representation
  * @param[in]  ipx_desc IPFIXcol specific representation
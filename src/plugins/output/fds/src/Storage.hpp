@@ -96,6 +96,18 @@ private:
         std::map<uint32_t, struct snap_info> odid2snap;
     };
 
+    /// Result of the last lookup of a Transport Session and ODID (pointers to the maps above)
+    struct last_ctx {
+        /// Transport Session (NULL if undefined)
+        const struct ipx_session *sptr = nullptr;
+        /// Observation Domain ID
+        uint32_t odid = 0;
+        /// Parameters of the Transport Session
+        struct session_ctx *session = nullptr;
+        /// Last seen snapshot of the ODID
+        struct snap_info *snap = nullptr;
+    };
+
     /// Plugin context only for logging!
     ipx_ctx_t *m_ctx;
     /// Storage path
@@ -107,6 +119,8 @@ private:
     std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
     /// Mapping of Transport Sessions to FDS specific parameters
     std::map<const struct ipx_session *, struct session_ctx> m_session2params;
+    /// Cached result of the last lookup in the map above (elements of maps are never moved)
+    struct last_ctx m_last;
 
     std::string
     filename_gen(const time_t &ts);
@@ -114,6 +128,8 @@ private:
     ipv4toipv6(const uint8_t *in, uint8_t *out);
     struct session_ctx &
     session_get(const struct ipx_session *sptr);
+    struct snap_info &
+    snap_get(const struct ipx_session *sptr, uint32_t odid);
     void
     session_ipx2fds(const struct ipx_session *ipx_desc, struct fds_file_session *fds_desc);
     void
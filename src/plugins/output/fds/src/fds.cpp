@@ -33,6 +33,9 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     "2.1.0"
 };
 
+/// Interval of periodic checks of the time window (milliseconds)
+#define WINDOW_CHECK_INTERVAL 250
+
 /// Instance
 struct Instance {
     /// Parsed configuration
@@ -43,13 +46,17 @@ struct Instance {
     time_t window_start = 0;
 };
 
+/**
+ * \brief Close the current time window and create a new one, if the window has expired
+ * \param[in] inst Plugin instance
+ * \param[in] now  Current time
+ */
 static void
-window_check(struct Instance &inst)
+window_check(struct Instance &inst, time_t now)
 {
     const Config &cfg = *inst.config_ptr;
 
     // Decide whether close file and create a new time window
-    time_t now = time(NULL);
     if (difftime(now, inst.window_start) < cfg.m_window.size) {
         // Nothing to do
         return;
@@ -73,7 +80,11 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         std::unique_ptr<Instance> instance(new Instance);
         instance->config_ptr.reset(new Config(params));
         instance->storage_ptr.reset(new Storage(ctx, *instance->config_ptr));
-        window_check(*instance);
+        window_check(*instance, time(NULL));
+        // Expiration of the window is checked periodically, not for each message
+        if (ipx_ctx_tick_set(ctx, WINDOW_CHECK_INTERVAL) != IPX_OK) {
+            throw FDS_exception("Failed to enable periodic checks of the time window");
+        }
         // Everything seems OK
         ipx_ctx_private_set(ctx, instance.release());
     } catch (const FDS_exception &ex) {
@@ -109,8 +120,6 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     bool failed = false;
 
     try {
-        // Check if the current time window should be closed
-        window_check(*inst);
         ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
         inst->storage_ptr->process_msg(msg_ipfix);
     } catch (const FDS_exception &ex) {
@@ -133,3 +142,20 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
     return IPX_OK;
 }
+
+void
+ipx_plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now)
+{
+    auto *inst = reinterpret_cast<Instance *>(cfg);
+
+    try {
+        // Check if the current time window should be closed
+        window_check(*inst, now->tv_sec);
+    } catch (const FDS_exception &ex) {
+        IPX_CTX_ERROR(ctx, "%s", ex.what());
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Unexpected error has occurred: %s", ex.what());
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!");
+    }
+}
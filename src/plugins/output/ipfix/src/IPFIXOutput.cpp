@@ -348,6 +348,29 @@ IPFIXOutput::get_odid(uint32_t odid, const ipx_session *session)
     return nullptr;
 }
 
+/**
+ * \brief Get number of Data Records in a Data Set (without splitting the whole message)
+ * \param[in] set   Data Set
+ * \param[in] tmplt Template of the Data Set
+ * \return Number of records
+ */
+static uint32_t
+dset_rec_cnt(struct fds_ipfix_set_hdr *set, const struct fds_template *tmplt)
+{
+    if ((tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0 && tmplt->data_length > 0) {
+        // Fixed size records (anything shorter than a record is padding)
+        return (ntohs(set->length) - FDS_IPFIX_SET_HDR_LEN) / tmplt->data_length;
+    }
+
+    uint32_t cnt = 0;
+    struct fds_dset_iter it;
+    fds_dset_iter_init(&it, set, tmplt);
+    while (fds_dset_iter_next(&it) == FDS_OK) {
+        cnt++;
+    }
+    return cnt;
+}
+
 /**
  * \brief Processes an incoming IPFIX message from the collector
  * \param[in] message  The IPFIX message
@@ -382,12 +405,14 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
         new_file(time_now); // This will make sure that templates will be written to the file
     }
 
-    // We need a templates snapshot from a Data Record, so at least one is needed!
-    const uint32_t drec_cnt = ipx_msg_ipfix_get_drec_cnt(message);
+    // We need a templates snapshot from a Data Set, so at least one with a known Template is needed!
+    struct ipx_ipfix_set *sets_data;
+    size_t sets_count;
+    ipx_msg_ipfix_get_sets(message, &sets_data, &sets_count);
+
     const fds_tsnapshot_t *tsnap = nullptr;
-    if (drec_cnt > 0) {
-        const auto *drec = ipx_msg_ipfix_get_drec(message, 0);
-        tsnap = drec->rec.snap;
+    for (size_t i = 0; i < sets_count && tsnap == nullptr; ++i) {
+        tsnap = sets_data[i].snap;
     }
 
     // Write all (Options) Templates, if required
@@ -399,22 +424,26 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
     // If we don't have to look for unknown Data Sets, just copy the whole message -> FAST PATH
     if (config->preserve_original) {
-        std::fwrite(msg_hdr, msg_size, 1, output_file);
+        // Note: the message can be segmented (e.g. converted NetFlow)
+        const struct iovec *msg_segs;
+        size_t msg_segs_cnt;
+        ipx_msg_ipfix_get_segs(message, &msg_segs, &msg_segs_cnt);
+        write_segments(msg_segs, msg_segs_cnt);
         return;
     }
 
     // SLOW PATH - check if the IPFIX Message is fully known and modify it, if necessary
+    // Only the header is copied, known Sets are written directly from the original message
 
     // Copy the IPFIX Message header to the buffer
     auto *new_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(buffer.get());
     std::memcpy(buffer.get(), msg_hdr, FDS_IPFIX_MSG_HDR_LEN);
     uint16_t new_pos = FDS_IPFIX_MSG_HDR_LEN;
+    segments.clear();
+    segments.push_back({buffer.get(), FDS_IPFIX_MSG_HDR_LEN});
 
     // Iterate over all IPFIX Sets in the IPFIX Message
-    struct ipx_ipfix_set *sets_data;
-    size_t sets_count;
-    ipx_msg_ipfix_get_sets(message, &sets_data, &sets_count);
-
+    uint32_t drec_cnt = 0;
     for (size_t i = 0; i < sets_count; ++i) {
         const struct fds_ipfix_set_hdr *set = sets_data[i].ptr;
         const uint16_t set_id = ntohs(set->flowset_id);
@@ -422,38 +451,19 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
 
         if (set_id < FDS_IPFIX_SET_MIN_DSET) {
             // Not a Data Sets -> just copy
-            std::memcpy(buffer.get() + new_pos, set, set_len);
+            segments.push_back({const_cast<fds_ipfix_set_hdr *>(set), set_len});
             new_pos += set_len;
             continue;
         }
 
-        // Data Sets only
-        const uint8_t *set_start = reinterpret_cast<const uint8_t *>(set);
-        const uint8_t *set_end = set_start + set_len;
-
-        // Check if at least one parsed Data Record is in the Data Set
-        bool found = false;
-        for (uint32_t rec_id = 0; rec_id < drec_cnt; ++rec_id) {
-            const ipx_ipfix_record *rec_info = ipx_msg_ipfix_get_drec(message, rec_id);
-            if (rec_info->rec.data < set_start) {
-                // The record is in any previous Data Sets -> try next record
-                continue;
-            }
-
-            if (rec_info->rec.data > set_end) {
-                // The record is in any following Data Sets -> stop searching
-                break;
-            }
-
-            // Found
-            found = true;
-            break;
-        }
+        // Data Sets only (their Template must be known)
+        const bool found = (sets_data[i].tmplt != nullptr);
 
         if (found) {
             // Copy the Data Set
-            std::memcpy(buffer.get() + new_pos, set, set_len);
+            segments.push_back({const_cast<fds_ipfix_set_hdr *>(set), set_len});
             new_pos += set_len;
+            drec_cnt += dset_rec_cnt(sets_data[i].ptr, sets_data[i].tmplt);
         } else {
             // Skip the Data Set
             IPX_CTX_DEBUG(plugin_context, "Unknown Template of Data Set (ID %" PRIu16 ")", set_id);
@@ -466,7 +476,23 @@ IPFIXOutput::on_ipfix_message(ipx_msg_ipfix *message)
     new_hdr->seq_num = htonl(odid_context->sequence_number);
     odid_context->sequence_number += drec_cnt;
 
-    std::fwrite(buffer.get(), new_pos, 1, output_file);
+    write_segments(segments.data(), segments.size());
+}
+
+/**
+ * \brief Write parts of an IPFIX Message to the output file
+ *
+ * \note The file is buffered by the standard library, therefore, the parts are passed
+ *   one by one without creating a contiguous copy of the message.
+ * \param[in] iov     Array of parts
+ * \param[in] iov_cnt Number of parts
+ */
+void
+IPFIXOutput::write_segments(const struct iovec *iov, size_t iov_cnt)
+{
+    for (size_t i = 0; i < iov_cnt; ++i) {
+        std::fwrite(iov[i].iov_base, iov[i].iov_len, 1, output_file);
+    }
 }
 
 /**
@@ -49,6 +49,7 @@
 #include <vector>
 #include <cstdio>
 #include <ctime>
+#include <sys/uio.h>
 
 #include <ipfixcol2.h>
 #include <libfds.h>
@@ -75,6 +76,8 @@ private:
 
     /// Memory for editing IPFIX Messages
     std::unique_ptr<uint8_t[]> buffer = nullptr;
+    /// Parts of the current IPFIX Message to write (reused to avoid reallocations)
+    std::vector<struct iovec> segments;
     /// Map of known Observation Domain IDs (ODIDs)
     std::map<uint32_t, odid_context_s> odid_contexts;
     /// Current output file
@@ -94,6 +97,8 @@ private:
     close_file();
     void
     write_templates(const fds_tsnapshot_t *snap, uint32_t odid, uint32_t exp_time, uint32_t seq_num);
+    void
+    write_segments(const struct iovec *iov, size_t iov_cnt);
 
 public:
     /**
@@ -61,8 +61,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     "IPFIX output plugin",
     // Plugin type
     IPX_PT_OUTPUT,
-    // Configuration flags (reserved for future use)
-    0,
+    // Configuration flags (only IPFIX Sets are processed)
+    IPX_PF_SET_LEVEL,
     // Plugin version string (like "1.2.3")
     "2.0.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -0,0 +1,721 @@
+/**
+ * \file src/plugins/output/json/src/Binary.cpp
+ * \author agent <agent@local>
+ * \brief Converter of IPFIX records to binary encodings (source file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <endian.h>
+#include <arpa/inet.h>
+#include <libfds.h>
+
+#include "Binary.hpp"
+
+/** Base size of the conversion buffer                 */
+#define BUFFER_BASE 4096
+
+// CBOR major types (RFC 8949)
+#define CBOR_UINT   0U
+#define CBOR_NINT   1U
+#define CBOR_BYTES  2U
+#define CBOR_TEXT   3U
+#define CBOR_ARRAY  4U
+#define CBOR_MAP    5U
+#define CBOR_TAG    6U
+// CBOR simple values and tags
+#define CBOR_FALSE  0xF4U
+#define CBOR_TRUE   0xF5U
+#define CBOR_NULL   0xF6U
+#define CBOR_DOUBLE 0xFBU
+#define CBOR_TAG_EPOCH 1U   ///< Epoch-based date/time (RFC 8949)
+#define CBOR_TAG_IPV4  52U  ///< IPv4 address (RFC 9164)
+#define CBOR_TAG_IPV6  54U  ///< IPv6 address (RFC 9164)
+
+// MessagePack format types
+#define MPACK_NIL     0xC0U
+#define MPACK_FALSE   0xC2U
+#define MPACK_TRUE    0xC3U
+#define MPACK_BIN8    0xC4U
+#define MPACK_BIN16   0xC5U
+#define MPACK_BIN32   0xC6U
+#define MPACK_EXT8    0xC7U
+#define MPACK_DOUBLE  0xCBU
+#define MPACK_UINT8   0xCCU
+#define MPACK_UINT16  0xCDU
+#define MPACK_UINT32  0xCEU
+#define MPACK_UINT64  0xCFU
+#define MPACK_INT8    0xD0U
+#define MPACK_INT16   0xD1U
+#define MPACK_INT32   0xD2U
+#define MPACK_INT64   0xD3U
+#define MPACK_FIXEXT4 0xD6U
+#define MPACK_FIXEXT8 0xD7U
+#define MPACK_STR8    0xD9U
+#define MPACK_STR16   0xDAU
+#define MPACK_STR32   0xDBU
+#define MPACK_ARRAY32 0xDDU
+#define MPACK_MAP32   0xDFU
+#define MPACK_EXT_TIMESTAMP 0xFFU ///< Timestamp extension type (-1)
+
+Binary::Binary(const struct cfg_format &fmt) : m_enc(fmt.encoding), m_format(fmt)
+{
+    m_iter_flags = 0;
+    if (m_format.ignore_unknown) {
+        m_iter_flags |= FDS_DREC_UNKNOWN_SKIP;
+    }
+    if (m_format.split_biflow) {
+        m_iter_flags |= FDS_DREC_REVERSE_SKIP;
+    }
+}
+
+Binary::~Binary()
+{
+    free(m_buffer);
+}
+
+/**
+ * \brief Reserve memory of the conversion buffer
+ * \param[in] n Minimal size of the buffer
+ * \throws bad_alloc in case of a memory allocation error
+ */
+void
+Binary::reserve(size_t n)
+{
+    if (n <= m_alloc) {
+        return;
+    }
+
+    const size_t new_size = ((n / BUFFER_BASE) + 1) * BUFFER_BASE;
+    uint8_t *new_buffer = (uint8_t *) realloc(m_buffer, new_size);
+    if (!new_buffer) {
+        throw std::bad_alloc();
+    }
+
+    m_buffer = new_buffer;
+    m_alloc = new_size;
+}
+
+/** \brief Append raw data to the buffer */
+void
+Binary::put_raw(const void *data, size_t size)
+{
+    reserve(m_used + size);
+    memcpy(m_buffer + m_used, data, size);
+    m_used += size;
+}
+
+/** \brief Append a byte to the buffer */
+void
+Binary::put_u8(uint8_t value)
+{
+    reserve(m_used + 1);
+    m_buffer[m_used++] = value;
+}
+
+/** \brief Append a 16-bit unsigned integer (big endian) to the buffer */
+void
+Binary::put_u16(uint16_t value)
+{
+    value = htobe16(value);
+    put_raw(&value, sizeof(value));
+}
+
+/** \brief Append a 32-bit unsigned integer (big endian) to the buffer */
+void
+Binary::put_u32(uint32_t value)
+{
+    value = htobe32(value);
+    put_raw(&value, sizeof(value));
+}
+
+/** \brief Append a 64-bit unsigned integer (big endian) to the buffer */
+void
+Binary::put_u64(uint64_t value)
+{
+    value = htobe64(value);
+    put_raw(&value, sizeof(value));
+}
+
+/**
+ * \brief Append a head of a CBOR data item (the shortest form)
+ * \param[in] major Major type
+ * \param[in] value Argument (value, length, count or tag)
+ */
+void
+Binary::put_cbor_head(uint8_t major, uint64_t value)
+{
+    const uint8_t type = major << 5;
+    if (value < 24U) {
+        put_u8(type | uint8_t(value));
+    } else if (value <= UINT8_MAX) {
+        put_u8(type | 24U);
+        put_u8(uint8_t(value));
+    } else if (value <= UINT16_MAX) {
+        put_u8(type | 25U);
+        put_u16(uint16_t(value));
+    } else if (value <= UINT32_MAX) {
+        put_u8(type | 26U);
+        put_u32(uint32_t(value));
+    } else {
+        put_u8(type | 27U);
+        put_u64(value);
+    }
+}
+
+/**
+ * \brief Start a map or an array with an unknown number of items
+ *
+ * The number of items must be filled by end_container().
+ * \param[in] map Map (true) or array (false)
+ * \return Position of the container in the buffer
+ */
+size_t
+Binary::add_container(bool map)
+{
+    const size_t pos = m_used;
+    if (m_enc == encoding::CBOR) {
+        put_u8(((map ? CBOR_MAP : CBOR_ARRAY) << 5) | 26U);
+    } else {
+        put_u8(map ? MPACK_MAP32 : MPACK_ARRAY32);
+    }
+
+    put_u32(0);
+    return pos;
+}
+
+/**
+ * \brief Fill the number of items of a map or an array
+ * \param[in] pos Position of the container (see add_container())
+ * \param[in] cnt Number of items (key/value pairs in case of maps)
+ */
+void
+Binary::end_container(size_t pos, uint32_t cnt)
+{
+    cnt = htobe32(cnt);
+    memcpy(m_buffer + pos + 1, &cnt, sizeof(cnt));
+}
+
+/** \brief Add an unsigned integer */
+void
+Binary::add_uint(uint64_t value)
+{
+    if (m_enc == encoding::CBOR) {
+        put_cbor_head(CBOR_UINT, value);
+        return;
+    }
+
+    if (value < 128U) {
+        put_u8(uint8_t(value)); // positive fixint
+    } else if (value <= UINT8_MAX) {
+        put_u8(MPACK_UINT8);
+        put_u8(uint8_t(value));
+    } else if (value <= UINT16_MAX) {
+        put_u8(MPACK_UINT16);
+        put_u16(uint16_t(value));
+    } else if (value <= UINT32_MAX) {
+        put_u8(MPACK_UINT32);
+        put_u32(uint32_t(value));
+    } else {
+        put_u8(MPACK_UINT64);
+        put_u64(value);
+    }
+}
+
+/** \brief Add a signed integer */
+void
+Binary::add_int(int64_t value)
+{
+    if (value >= 0) {
+        add_uint(uint64_t(value));
+        return;
+    }
+
+    if (m_enc == encoding::CBOR) {
+        put_cbor_head(CBOR_NINT, uint64_t(-1 - value));
+        return;
+    }
+
+    if (value >= -32) {
+        put_u8(uint8_t(int8_t(value))); // negative fixint
+    } else if (value >= INT8_MIN) {
+        put_u8(MPACK_INT8);
+        put_u8(uint8_t(int8_t(value)));
+    } else if (value >= INT16_MIN) {
+        put_u8(MPACK_INT16);
+        put_u16(uint16_t(int16_t(value)));
+    } else if (value >= INT32_MIN) {
+        put_u8(MPACK_INT32);
+        put_u32(uint32_t(int32_t(value)));
+    } else {
+        put_u8(MPACK_INT64);
+        put_u64(uint64_t(value));
+    }
+}
+
+/** \brief Add a floating point number (double precision) */
+void
+Binary::add_double(double value)
+{
+    uint64_t raw;
+    static_assert(sizeof(raw) == sizeof(value), "Unexpected size of double");
+    memcpy(&raw, &value, sizeof(raw));
+    put_u8((m_enc == encoding::CBOR) ? CBOR_DOUBLE : MPACK_DOUBLE);
+    put_u64(raw);
+}
+
+/** \brief Add a boolean value */
+void
+Binary::add_bool(bool value)
+{
+    if (m_enc == encoding::CBOR) {
+        put_u8(value ? CBOR_TRUE : CBOR_FALSE);
+    } else {
+        put_u8(value ? MPACK_TRUE : MPACK_FALSE);
+    }
+}
+
+/** \brief Add a null value */
+void
+Binary::add_null()
+{
+    put_u8((m_enc == encoding::CBOR) ? CBOR_NULL : MPACK_NIL);
+}
+
+/**
+ * \brief Append a head of a text string
+ * \param[in] len Length of the string (in bytes)
+ */
+void
+Binary::put_str_head(size_t len)
+{
+    if (m_enc == encoding::CBOR) {
+        put_cbor_head(CBOR_TEXT, len);
+    } else if (len < 32U) {
+        put_u8(0xA0U | uint8_t(len)); // fixstr
+    } else if (len <= UINT8_MAX) {
+        put_u8(MPACK_STR8);
+        put_u8(uint8_t(len));
+    } else if (len <= UINT16_MAX) {
+        put_u8(MPACK_STR16);
+        put_u16(uint16_t(len));
+    } else {
+        put_u8(MPACK_STR32);
+        put_u32(uint32_t(len));
+    }
+}
+
+/** \brief Add a text string (must be valid UTF-8) */
+void
+Binary::add_str(const char *str, size_t len)
+{
+    put_str_head(len);
+    put_raw(str, len);
+}
+
+/** \brief Add a null-terminated text string (must be valid UTF-8) */
+void
+Binary::add_str(const char *str)
+{
+    add_str(str, strlen(str));
+}
+
+/** \brief Add a byte string */
+void
+Binary::add_bytes(const uint8_t *data, size_t size)
+{
+    if (m_enc == encoding::CBOR) {
+        put_cbor_head(CBOR_BYTES, size);
+    } else if (size <= UINT8_MAX) {
+        put_u8(MPACK_BIN8);
+        put_u8(uint8_t(size));
+    } else if (size <= UINT16_MAX) {
+        put_u8(MPACK_BIN16);
+        put_u16(uint16_t(size));
+    } else {
+        put_u8(MPACK_BIN32);
+        put_u32(uint32_t(size));
+    }
+
+    put_raw(data, size);
+}
+
+/** \brief Add an IPv4 (4 bytes) or IPv6 (16 bytes) address in network byte order */
+void
+Binary::add_ip(const uint8_t *data, size_t size)
+{
+    if (m_enc == encoding::CBOR) {
+        put_cbor_head(CBOR_TAG, (size == 4U) ? CBOR_TAG_IPV4 : CBOR_TAG_IPV6);
+    }
+
+    add_bytes(data, size);
+}
+
+/** \brief Add a timestamp */
+void
+Binary::add_time(const struct timespec &ts)
+{
+    const uint64_t sec = uint64_t(ts.tv_sec);
+    const uint32_t nsec = uint32_t(ts.tv_nsec);
+
+    if (m_enc == encoding::CBOR) {
+        put_cbor_head(CBOR_TAG, CBOR_TAG_EPOCH);
+        if (nsec == 0) {
+            add_uint(sec);
+        } else {
+            add_double(double(sec) + double(nsec) / 1e9);
+        }
+        return;
+    }
+
+    // MessagePack timestamp extension (32, 64 or 96 bits)
+    if ((sec >> 34) == 0) {
+        const uint64_t value = (uint64_t(nsec) << 34) | sec;
+        if ((value >> 32) == 0) {
+            put_u8(MPACK_FIXEXT4);
+            put_u8(MPACK_EXT_TIMESTAMP);
+            put_u32(uint32_t(value));
+        } else {
+            put_u8(MPACK_FIXEXT8);
+            put_u8(MPACK_EXT_TIMESTAMP);
+            put_u64(value);
+        }
+    } else {
+        put_u8(MPACK_EXT8);
+        put_u8(12U);
+        put_u8(MPACK_EXT_TIMESTAMP);
+        put_u32(nsec);
+        put_u64(sec);
+    }
+}
+
+/**
+ * \brief Check if a string is valid UTF-8
+ * \param[in] data String
+ * \param[in] size Size of the string
+ */
+static bool
+utf8_valid(const uint8_t *data, size_t size)
+{
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t c = data[i];
+        size_t cont;
+        if (c < 0x80U) {
+            i++;
+            continue;
+        } else if ((c & 0xE0U) == 0xC0U && c >= 0xC2U) {
+            cont = 1;
+        } else if ((c & 0xF0U) == 0xE0U) {
+            cont = 2;
+        } else if ((c & 0xF8U) == 0xF0U && c <= 0xF4U) {
+            cont = 3;
+        } else {
+            return false;
+        }
+
+        if (i + cont >= size) {
+            return false;
+        }
+
+        for (size_t x = 1; x <= cont; ++x) {
+            if ((data[i + x] & 0xC0U) != 0x80U) {
+                return false;
+            }
+        }
+        i += cont + 1;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Add a key of a field (the same as used by the JSON converter)
+ * \param[in] info Description of the field
+ */
+void
+Binary::add_key(const struct fds_tfield *info)
+{
+    const struct fds_iemgr_elem *def = info->def;
+    if (m_format.numeric_names || def == nullptr) {
+        char key[32];
+        int len = snprintf(key, sizeof(key), "en%" PRIu32 ":id%" PRIu16, info->en, info->id);
+        add_str(key, size_t(len));
+        return;
+    }
+
+    // "<scope>:<name>"
+    const size_t scope_len = strlen(def->scope->name);
+    const size_t name_len = strlen(def->name);
+    put_str_head(scope_len + 1 + name_len);
+    put_raw(def->scope->name, scope_len);
+    put_u8(':');
+    put_raw(def->name, name_len);
+}
+
+/**
+ * \brief Add a value of a field
+ *
+ * If the conversion fails (e.g. invalid size of the field), null is added.
+ * \param[in] field Field to convert
+ */
+void
+Binary::add_value(const struct fds_drec_field &field)
+{
+    const enum fds_iemgr_element_type type = (field.info->def != nullptr)
+        ? field.info->def->data_type : FDS_ET_OCTET_ARRAY;
+    int rc = FDS_OK;
+
+    switch (type) {
+    case FDS_ET_UNSIGNED_8:
+    case FDS_ET_UNSIGNED_16:
+    case FDS_ET_UNSIGNED_32:
+    case FDS_ET_UNSIGNED_64: {
+        uint64_t value;
+        if ((rc = fds_get_uint_be(field.data, field.size, &value)) == FDS_OK) {
+            add_uint(value);
+        }
+        } break;
+    case FDS_ET_SIGNED_8:
+    case FDS_ET_SIGNED_16:
+    case FDS_ET_SIGNED_32:
+    case FDS_ET_SIGNED_64: {
+        int64_t value;
+        if ((rc = fds_get_int_be(field.data, field.size, &value)) == FDS_OK) {
+            add_int(value);
+        }
+        } break;
+    case FDS_ET_FLOAT_32:
+    case FDS_ET_FLOAT_64: {
+        double value;
+        if ((rc = fds_get_float_be(field.data, field.size, &value)) == FDS_OK) {
+            add_double(value);
+        }
+        } break;
+    case FDS_ET_BOOLEAN: {
+        bool value;
+        if ((rc = fds_get_bool(field.data, field.size, &value)) == FDS_OK) {
+            add_bool(value);
+        }
+        } break;
+    case FDS_ET_DATE_TIME_SECONDS:
+    case FDS_ET_DATE_TIME_MILLISECONDS:
+    case FDS_ET_DATE_TIME_MICROSECONDS:
+    case FDS_ET_DATE_TIME_NANOSECONDS: {
+        struct timespec ts;
+        if ((rc = fds_get_datetime_hp_be(field.data, field.size, type, &ts)) == FDS_OK) {
+            add_time(ts);
+        }
+        } break;
+    case FDS_ET_IPV4_ADDRESS:
+    case FDS_ET_IPV6_ADDRESS:
+        if (field.size == 4U || field.size == 16U) {
+            add_ip(field.data, field.size);
+        } else {
+            rc = FDS_ERR_ARG;
+        }
+        break;
+    case FDS_ET_STRING:
+        if (utf8_valid(field.data, field.size)) {
+            add_str(reinterpret_cast<const char *>(field.data), field.size);
+        } else {
+            add_bytes(field.data, field.size);
+        }
+        break;
+    case FDS_ET_OCTET_ARRAY:
+        if (m_format.octets_as_uint && field.size <= 8U && field.size > 0) {
+            uint64_t value;
+            if ((rc = fds_get_uint_be(field.data, field.size, &value)) == FDS_OK) {
+                add_uint(value);
+            }
+            break;
+        }
+        add_bytes(field.data, field.size);
+        break;
+    default:
+        // MAC addresses, structured data types (lists), etc.
+        add_bytes(field.data, field.size);
+        break;
+    }
+
+    if (rc != FDS_OK) {
+        add_null();
+    }
+}
+
+/**
+ * \brief Add detailed information about the record
+ * \param[in] hdr      IPFIX Message header (can be NULL)
+ * \param[in] src_addr Exporter address (can be NULL)
+ * \return Number of added key/value pairs
+ */
+uint32_t
+Binary::add_detailed(const struct fds_ipfix_msg_hdr *hdr, const char *src_addr)
+{
+    uint32_t cnt = 0;
+    if (hdr != nullptr) {
+        add_str("ipfix:exportTime");
+        add_uint(ntohl(hdr->export_time));
+        add_str("ipfix:seqNumber");
+        add_uint(ntohl(hdr->seq_num));
+        add_str("ipfix:odid");
+        add_uint(ntohl(hdr->odid));
+        add_str("ipfix:msgLength");
+        add_uint(ntohs(hdr->length));
+        cnt += 4;
+    }
+
+    if (src_addr != nullptr) {
+        add_str("ipfix:srcAddr");
+        add_str(src_addr);
+        cnt++;
+    }
+
+    return cnt;
+}
+
+void
+Binary::convert(struct fds_drec &rec, const struct fds_ipfix_msg_hdr *hdr, const char *src_addr,
+    bool reverse)
+{
+    m_used = 0;
+    m_multi.clear();
+
+    const size_t map_pos = add_container(true);
+    uint32_t map_cnt = 1;
+    add_str("@type");
+    add_str((rec.tmplt->type == FDS_TYPE_TEMPLATE_OPTS) ? "ipfix.optionsEntry" : "ipfix.entry");
+
+    uint16_t flags = m_iter_flags;
+    flags |= reverse ? FDS_DREC_BIFLOW_REV : FDS_DREC_BIFLOW_FWD;
+
+    struct fds_drec_iter it;
+    fds_drec_iter_init(&it, &rec, flags);
+    while (fds_drec_iter_next(&it) != FDS_EOC) {
+        const struct fds_tfield *info = it.field.info;
+        if ((info->flags & FDS_TFIELD_MULTI_IE) == 0) {
+            add_key(info);
+            add_value(it.field);
+            map_cnt++;
+            continue;
+        }
+
+        // Multiple occurrences of the same field are converted to an array
+        const std::pair<uint32_t, uint16_t> id(info->en, info->id);
+        bool done = false;
+        for (const auto &item : m_multi) {
+            if (item == id) {
+                done = true;
+                break;
+            }
+        }
+        if (done) {
+            continue;
+        }
+        m_multi.push_back(id);
+
+        add_key(info);
+        const size_t arr_pos = add_container(false);
+        uint32_t arr_cnt = 1;
+        add_value(it.field);
+
+        struct fds_drec_iter it_next = it;
+        while (fds_drec_iter_find(&it_next, info->en, info->id) != FDS_EOC) {
+            add_value(it_next.field);
+            arr_cnt++;
+        }
+
+        end_container(arr_pos, arr_cnt);
+        map_cnt++;
+    }
+
+    if (m_format.detailed_info) {
+        map_cnt += add_detailed(hdr, src_addr);
+        add_str("ipfix:templateId");
+        add_uint(rec.tmplt->id);
+        map_cnt++;
+    }
+
+    end_container(map_pos, map_cnt);
+}
+
+void
+Binary::convert_tmplt(const struct fds_template *tmplt, const struct fds_ipfix_msg_hdr *hdr,
+    const char *src_addr)
+{
+    m_used = 0;
+    const bool opts = (tmplt->type == FDS_TYPE_TEMPLATE_OPTS);
+
+    const size_t map_pos = add_container(true);
+    uint32_t map_cnt = 2;
+    add_str("@type");
+    add_str(opts ? "ipfix.optionsTemplate" : "ipfix.template");
+    add_str("ipfix:templateId");
+    add_uint(tmplt->id);
+
+    if (opts) {
+        add_str("ipfix:scopeCount");
+        add_uint(tmplt->fields_cnt_scope);
+        map_cnt++;
+    }
+
+    if (m_format.detailed_info) {
+        map_cnt += add_detailed(hdr, src_addr);
+    }
+
+    add_str("ipfix:fields");
+    const size_t arr_pos = add_container(false);
+    for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+        const struct fds_tfield &field = tmplt->fields[i];
+        const size_t field_pos = add_container(true);
+        add_str("ipfix:elementId");
+        add_uint(field.id);
+        add_str("ipfix:enterpriseId");
+        add_uint(field.en);
+        add_str("ipfix:fieldLength");
+        add_uint(field.length);
+        end_container(field_pos, 3);
+    }
+    end_container(arr_pos, tmplt->fields_cnt_total);
+    map_cnt++;
+
+    end_container(map_pos, map_cnt);
+}
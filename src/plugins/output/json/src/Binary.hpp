@@ -0,0 +1,150 @@
+/**
+ * \file src/plugins/output/json/src/Binary.hpp
+ * \author agent <agent@local>
+ * \brief Converter of IPFIX records to binary encodings (header file)
+ * \date 2026
+ */
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_BINARY_H
+#define JSON_BINARY_H
+
+#include <cstdint>
+#include <ctime>
+#include <utility>
+#include <vector>
+#include <ipfixcol2.h>
+#include "Config.hpp"
+
+/**
+ * \brief Converter of IPFIX records to binary encodings (CBOR or MessagePack)
+ *
+ * Records are converted to maps with the same keys as the JSON records. However, values are
+ * stored as native types of the encoding (i.e. integers, floats, booleans, byte strings) without
+ * any string formatting. IPv4/IPv6 addresses are stored as byte strings in network byte
+ * order (CBOR: tagged by tags 52/54 of RFC 9164) and timestamps are stored as native time types
+ * (CBOR: epoch-based date/time of RFC 8949, MessagePack: timestamp extension type).
+ *
+ * Records are stored as definite-length maps/arrays. Since the number of items is not known
+ * in advance, counts are always stored as 32-bit integers and filled at the end.
+ */
+class Binary {
+public:
+    /**
+     * \brief Create a converter
+     * \param[in] fmt Formatting options (selects the encoding and field names)
+     */
+    explicit Binary(const struct cfg_format &fmt);
+    /** \brief Destructor */
+    ~Binary();
+
+    // Disable copy constructors
+    Binary(const Binary &) = delete;
+    Binary &operator=(const Binary &) = delete;
+
+    /**
+     * \brief Convert a Data Record
+     * \param[in] rec      Data Record to convert
+     * \param[in] hdr      IPFIX Message header (only for detailed info, can be NULL)
+     * \param[in] src_addr Exporter address (only for detailed info, can be NULL)
+     * \param[in] reverse  Convert from reverse point of view (affects only biflow records)
+     * \throw bad_alloc in case of a memory allocation error
+     */
+    void
+    convert(struct fds_drec &rec, const struct fds_ipfix_msg_hdr *hdr, const char *src_addr,
+        bool reverse);
+
+    /**
+     * \brief Convert a (Options) Template
+     * \param[in] tmplt    Parsed template
+     * \param[in] hdr      IPFIX Message header (only for detailed info, can be NULL)
+     * \param[in] src_addr Exporter address (only for detailed info, can be NULL)
+     * \throw bad_alloc in case of a memory allocation error
+     */
+    void
+    convert_tmplt(const struct fds_template *tmplt, const struct fds_ipfix_msg_hdr *hdr,
+        const char *src_addr);
+
+    /** \brief Get the converted record */
+    const char *data() const {return reinterpret_cast<const char *>(m_buffer);};
+    /** \brief Get the size of the converted record */
+    size_t size() const {return m_used;};
+
+private:
+    /** Selected encoding                                                                        */
+    enum encoding m_enc;
+    /** Formatting options                                                                       */
+    struct cfg_format m_format;
+    /** Flags of the record iterator                                                             */
+    uint16_t m_iter_flags;
+
+    /** Conversion buffer                                                                        */
+    uint8_t *m_buffer = nullptr;
+    /** Allocated size of the buffer                                                             */
+    size_t m_alloc = 0;
+    /** Used size of the buffer                                                                  */
+    size_t m_used = 0;
+    /** Multi-occurrence fields already converted in the current record                          */
+    std::vector<std::pair<uint32_t, uint16_t>> m_multi;
+
+    void reserve(size_t n);
+    void put_raw(const void *data, size_t size);
+    void put_u8(uint8_t value);
+    void put_u16(uint16_t value);
+    void put_u32(uint32_t value);
+    void put_u64(uint64_t value);
+    void put_cbor_head(uint8_t major, uint64_t value);
+    void put_str_head(size_t len);
+
+    size_t add_container(bool map);
+    void end_container(size_t pos, uint32_t cnt);
+    void add_uint(uint64_t value);
+    void add_int(int64_t value);
+    void add_double(double value);
+    void add_bool(bool value);
+    void add_null();
+    void add_str(const char *str, size_t len);
+    void add_str(const char *str);
+    void add_bytes(const uint8_t *data, size_t size);
+    void add_ip(const uint8_t *data, size_t size);
+    void add_time(const struct timespec &ts);
+
+    void add_key(const struct fds_tfield *info);
+    void add_value(const struct fds_drec_field &field);
+    uint32_t add_detailed(const struct fds_ipfix_msg_hdr *hdr, const char *src_addr);
+};
+
+#endif // JSON_BINARY_H
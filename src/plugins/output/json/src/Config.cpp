@@ -51,6 +51,7 @@
 /** XML nodes */
 enum params_xml_nodes {
     // Formatting parameters
+    FMT_ENCODING,      /**< Encoding of records             */
     FMT_TFLAGS,        /**< TCP flags                       */
     FMT_TIMESTAMP,     /**< Timestamp                       */
     FMT_PROTO,         /**< Protocol                        */
@@ -136,6 +137,7 @@ static const struct fds_xml_args args_outputs[] = {
 /** Definition of the \<params\> node  */
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(FMT_ENCODING,  "format",    FDS_OPTS_T_STRING,      FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_TFLAGS,    "tcpFlags",  FDS_OPTS_T_STRING,      FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_TIMESTAMP, "timestamp", FDS_OPTS_T_STRING,      FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(FMT_PROTO,     "protocol",  FDS_OPTS_T_STRING,      FDS_OPTS_P_OPT),
@@ -446,6 +448,19 @@ Config::parse_params(fds_xml_ctx_t *params)
     const struct fds_xml_cont *content;
     while (fds_xml_next(params, &content) != FDS_EOC) {
         switch (content->id) {
+        case FMT_ENCODING: // Encoding of records
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strcasecmp(content->ptr_string, "json") == 0) {
+                format.encoding = encoding::JSON;
+            } else if (strcasecmp(content->ptr_string, "cbor") == 0) {
+                format.encoding = encoding::CBOR;
+            } else if (strcasecmp(content->ptr_string, "msgpack") == 0) {
+                format.encoding = encoding::MSGPACK;
+            } else {
+                const std::string inv_str = content->ptr_string;
+                throw std::invalid_argument("Unknown output format '" + inv_str + "'");
+            }
+            break;
         case FMT_TFLAGS:   // Format TCP flags
             assert(content->type == FDS_OPTS_T_STRING);
             format.tcp_flags = check_or("tcpFlags", content->ptr_string, "formatted", "raw");
@@ -506,6 +521,7 @@ Config::parse_params(fds_xml_ctx_t *params)
 void
 Config::default_set()
 {
+    format.encoding = encoding::JSON;
     format.proto = true;
     format.tcp_flags = true;
     format.timestamp = true;
@@ -46,8 +46,17 @@
 #include <vector>
 #include <ipfixcol2.h>
 
+/** Encoding of converted records                                                              */
+enum class encoding {
+    JSON,   ///< JSON text
+    CBOR,   ///< Concise Binary Object Representation (RFC 8949)
+    MSGPACK ///< MessagePack
+};
+
 /** Configuration of output format                                                               */
 struct cfg_format {
+    /** Encoding of records                                                                      */
+    enum encoding encoding;
     /** TCP flags format - true (formatted), false (raw)                                         */
     bool tcp_flags;
     /** Timestamp format - true (formatted), false (UNIX)                                        */
@@ -50,7 +50,6 @@ Printer::Printer(const struct cfg_print &cfg, ipx_ctx_t *ctx) : Output(cfg.name,
 int
 Printer::process(const char *str, size_t len)
 {
-    (void) len;
-    std::cout << str;
+    std::cout.write(str, len);
     return IPX_OK;
 }
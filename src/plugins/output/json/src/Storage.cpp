@@ -86,6 +86,10 @@ Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     if (!m_format.octets_as_uint) {
         m_flags |= FDS_CD2J_OCTETS_NOINT;
     }
+
+    if (m_format.encoding != encoding::JSON) {
+        m_binary.reset(new Binary(m_format));
+    }
 }
 
 Storage::~Storage()
@@ -148,6 +152,30 @@ Storage::output_add(Output *output)
     m_outputs.push_back(output);
 }
 
+/**
+ * \brief Pass the converted record to all outputs
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the record
+ */
+int
+Storage::outputs_process()
+{
+    const char *data = m_record.buffer;
+    size_t size = m_record.size_used;
+    if (m_binary) {
+        data = m_binary->data();
+        size = m_binary->size();
+    }
+
+    for (Output *output : m_outputs) {
+        if (output->process(data, size) != IPX_OK) {
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    return IPX_OK;
+}
+
 /**
  * \brief Get IP address from Transport Session
  *
@@ -199,12 +227,10 @@ Storage::convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id, con
     enum fds_template_type type;
     void *ptr;
     if (set_id == FDS_IPFIX_SET_TMPLT) {
-        buffer_append("{\"@type\":\"ipfix.template\",");
         type = FDS_TYPE_TEMPLATE;
         ptr = tset_iter->ptr.trec;
     } else {
         assert(set_id == FDS_IPFIX_SET_OPTS_TMPLT);
-        buffer_append("{\"@type\":\"ipfix.optionsTemplate\",");
         type = FDS_TYPE_TEMPLATE_OPTS;
         ptr = tset_iter->ptr.opts_trec;
     }
@@ -218,7 +244,15 @@ Storage::convert_tmplt_rec(struct fds_tset_iter *tset_iter, uint16_t set_id, con
         throw std::runtime_error("Parsing failed due to memory allocation error or the format of template is invalid!");
     }
 
+    if (m_binary) {
+        m_binary->convert_tmplt(tmplt, m_format.detailed_info ? hdr : nullptr, m_src_addr);
+        fds_template_destroy(tmplt);
+        return;
+    }
+
     // Printing out the header
+    buffer_append((type == FDS_TYPE_TEMPLATE)
+        ? "{\"@type\":\"ipfix.template\"," : "{\"@type\":\"ipfix.optionsTemplate\",");
     char field[LOCAL_BSIZE];
     snprintf(field, LOCAL_BSIZE, "\"ipfix:templateId\":%" PRIu16, tmplt->id);
     buffer_append(field);
@@ -280,10 +314,8 @@ Storage::convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr
         convert_tmplt_rec(&tset_iter, set_id, hdr);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                return IPX_ERR_DENIED;
-            }
+        if (outputs_process() != IPX_OK) {
+            return IPX_ERR_DENIED;
         }
 
         // Buffer is empty
@@ -347,11 +379,9 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         convert(ipfix_rec->rec, iemgr, hdr, false);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        if (outputs_process() != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
         }
 
         if (!m_format.split_biflow || (ipfix_rec->rec.tmplt->flags & FDS_TEMPLATE_BIFLOW) == 0) {
@@ -363,11 +393,9 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         convert(ipfix_rec->rec, iemgr, hdr, true);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        if (outputs_process() != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
         }
     }
 
@@ -424,6 +452,12 @@ Storage::addDetailedInfo(const struct fds_ipfix_msg_hdr *hdr)
 void
 Storage::convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, fds_ipfix_msg_hdr *hdr, bool reverse)
 {
+    if (m_binary) {
+        // Binary encoding
+        m_binary->convert(rec, m_format.detailed_info ? hdr : nullptr, m_src_addr, reverse);
+        return;
+    }
+
     // Convert the record
     uint32_t flags = m_flags;
     flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
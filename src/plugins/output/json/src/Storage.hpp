@@ -42,11 +42,13 @@
 #ifndef JSON_STORAGE_H
 #define JSON_STORAGE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <arpa/inet.h>
 #include <ipfixcol2.h>
 #include "Config.hpp"
+#include "Binary.hpp"
 
 /** Base class                                                                                   */
 class Output {
@@ -67,8 +69,9 @@ public:
     ~Output() {};
 
     /**
-     * \brief Process a converted JSON
-     * \param[in] str JSON Record
+     * \brief Process a converted record
+     * \note In case of binary encodings, the record is not null-terminated.
+     * \param[in] str JSON Record (or binary encoded record)
      * \param[in] len Length of the record (excluding the terminating null byte '\0')
      * \return #IPX_OK on success
      * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
@@ -96,6 +99,8 @@ private:
     uint32_t m_flags;
     /** IPv4/IPv6 exporter address of the current message (can be nullptr)                       */
     const char *m_src_addr = nullptr;
+    /** Binary converter (only if a binary encoding is selected)                                  */
+    std::unique_ptr<Binary> m_binary;
 
     struct {
         char *buffer;
@@ -103,6 +108,8 @@ private:
         size_t size_used;
     } m_record; /**< Converted JSON record                                                       */
 
+    // Pass the converted record to all outputs
+    int outputs_process();
     // Convert an IPFIX record to a JSON string
     void convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, struct fds_ipfix_msg_hdr *hdr, bool reverse = false);
 
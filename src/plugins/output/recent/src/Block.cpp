@@ -0,0 +1,267 @@
+/**
+ * \file src/plugins/output/recent/src/Block.cpp
+ * \author agent <agent@local>
+ * \brief Compressed block of flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include "Block.hpp"
+
+/// Prefix of IPv4-mapped IPv6 addresses
+static const uint8_t IPV4_MAPPED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+
+/**
+ * @brief Append an unsigned integer in variable-length encoding (LEB128)
+ * @param[in]  value Value to append
+ * @param[out] out   Output buffer
+ */
+static inline void
+varint_put(uint64_t value, std::vector<uint8_t> &out)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief Read an unsigned integer in variable-length encoding (LEB128)
+ * @param[in,out] ptr Position in a buffer (moved behind the value)
+ * @return Value
+ */
+static inline uint64_t
+varint_get(const uint8_t *&ptr)
+{
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+
+    do {
+        byte = *(ptr++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+/// Convert a signed difference to an unsigned value with small magnitude (zig-zag encoding)
+static inline uint64_t
+zigzag_enc(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+/// Convert a zig-zag encoded value back to the signed difference
+static inline int64_t
+zigzag_dec(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief Encode a numeric column
+ * @param[in]  flows  Flow records
+ * @param[in]  member Member of the record to encode
+ * @param[in]  delta  Store differences between consecutive values
+ * @param[out] out    Output buffer
+ */
+template <typename T>
+static void
+enc_uint(const std::vector<Flow> &flows, T Flow::*member, bool delta, std::vector<uint8_t> &out)
+{
+    uint64_t prev = 0;
+    for (const Flow &flow : flows) {
+        const uint64_t value = flow.*member;
+        if (delta) {
+            varint_put(zigzag_enc(static_cast<int64_t>(value - prev)), out);
+            prev = value;
+        } else {
+            varint_put(value, out);
+        }
+    }
+}
+
+/**
+ * @brief Decode a numeric column
+ * @param[in]  ptr    Start of the encoded column
+ * @param[in]  member Member of the record to fill
+ * @param[in]  delta  Values are stored as differences
+ * @param[out] flows  Flow records (already resized)
+ */
+template <typename T>
+static void
+dec_uint(const uint8_t *ptr, T Flow::*member, bool delta, std::vector<Flow> &flows)
+{
+    uint64_t prev = 0;
+    for (Flow &flow : flows) {
+        uint64_t value = varint_get(ptr);
+        if (delta) {
+            value = prev + static_cast<uint64_t>(zigzag_dec(value));
+            prev = value;
+        }
+        flow.*member = static_cast<T>(value);
+    }
+}
+
+/// Hash function of IP addresses
+struct ip_hash {
+    size_t
+    operator()(const std::array<uint8_t, 16> &addr) const
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ULL;
+        for (uint8_t byte : addr) {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+/// Pointer to an IP address member of the record
+using ip_member = uint8_t (Flow::*)[16];
+
+/**
+ * @brief Encode a column of IP addresses
+ *
+ * Unique addresses are stored in a dictionary (IPv4-mapped addresses occupy only 4 bytes) and
+ * each record refers to an item of the dictionary.
+ * @param[in]  flows  Flow records
+ * @param[in]  member Member of the record to encode
+ * @param[out] out    Output buffer
+ */
+static void
+enc_ip(const std::vector<Flow> &flows, ip_member member, std::vector<uint8_t> &out)
+{
+    std::unordered_map<std::array<uint8_t, 16>, uint32_t, ip_hash> dict;
+    std::vector<const uint8_t *> dict_items;
+    std::vector<uint32_t> idxs;
+    idxs.reserve(flows.size());
+
+    std::array<uint8_t, 16> key;
+    for (const Flow &flow : flows) {
+        std::memcpy(key.data(), flow.*member, key.size());
+        auto res = dict.emplace(key, static_cast<uint32_t>(dict_items.size()));
+        if (res.second) {
+            dict_items.push_back(flow.*member);
+        }
+        idxs.push_back(res.first->second);
+    }
+
+    varint_put(dict_items.size(), out);
+    for (const uint8_t *addr : dict_items) {
+        if (std::memcmp(addr, IPV4_MAPPED, sizeof(IPV4_MAPPED)) == 0) {
+            out.push_back(4U);
+            out.insert(out.end(), addr + sizeof(IPV4_MAPPED), addr + 16);
+        } else {
+            out.push_back(16U);
+            out.insert(out.end(), addr, addr + 16);
+        }
+    }
+
+    for (uint32_t idx : idxs) {
+        varint_put(idx, out);
+    }
+}
+
+/**
+ * @brief Decode a column of IP addresses
+ * @param[in]  ptr    Start of the encoded column
+ * @param[in]  member Member of the record to fill
+ * @param[out] flows  Flow records (already resized)
+ */
+static void
+dec_ip(const uint8_t *ptr, ip_member member, std::vector<Flow> &flows)
+{
+    const uint64_t dict_size = varint_get(ptr);
+    std::vector<std::array<uint8_t, 16>> dict(dict_size);
+
+    for (auto &addr : dict) {
+        const uint8_t len = *(ptr++);
+        if (len == 4U) {
+            std::memcpy(addr.data(), IPV4_MAPPED, sizeof(IPV4_MAPPED));
+            std::memcpy(addr.data() + sizeof(IPV4_MAPPED), ptr, 4U);
+        } else {
+            assert(len == 16U && "Unexpected address length");
+            std::memcpy(addr.data(), ptr, 16U);
+        }
+        ptr += len;
+    }
+
+    for (Flow &flow : flows) {
+        const uint64_t idx = varint_get(ptr);
+        assert(idx < dict_size && "Dictionary index out of range");
+        std::memcpy(flow.*member, dict[idx].data(), 16U);
+    }
+}
+
+Block::Block(const std::vector<Flow> &flows, time_t created)
+    : m_cnt(static_cast<uint32_t>(flows.size())), m_created(created)
+{
+    assert(!flows.empty() && "Block cannot be empty");
+
+    m_ts_min = UINT64_MAX;
+    m_ts_max = 0;
+    for (const Flow &flow : flows) {
+        m_ts_min = std::min(m_ts_min, flow.ts_first);
+        m_ts_max = std::max(m_ts_max, flow.ts_last);
+    }
+
+    for (unsigned i = 0; i < COLUMN_CNT; ++i) {
+        m_offsets[i] = m_data.size();
+
+        switch (static_cast<Column>(i)) {
+        case Column::TS_FIRST:  enc_uint(flows, &Flow::ts_first, true, m_data);   break;
+        case Column::TS_LAST:   enc_uint(flows, &Flow::ts_last, true, m_data);    break;
+        case Column::BYTES:     enc_uint(flows, &Flow::bytes, false, m_data);     break;
+        case Column::PACKETS:   enc_uint(flows, &Flow::packets, false, m_data);   break;
+        case Column::SRC_IP:    enc_ip(flows, &Flow::src_ip, m_data);             break;
+        case Column::DST_IP:    enc_ip(flows, &Flow::dst_ip, m_data);             break;
+        case Column::ODID:      enc_uint(flows, &Flow::odid, true, m_data);       break;
+        case Column::SRC_PORT:  enc_uint(flows, &Flow::src_port, false, m_data);  break;
+        case Column::DST_PORT:  enc_uint(flows, &Flow::dst_port, false, m_data);  break;
+        case Column::PROTO:     enc_uint(flows, &Flow::proto, false, m_data);     break;
+        case Column::TCP_FLAGS: enc_uint(flows, &Flow::tcp_flags, false, m_data); break;
+        }
+    }
+
+    m_offsets[COLUMN_CNT] = m_data.size();
+    m_data.shrink_to_fit();
+}
+
+void
+Block::decode(ColumnMask cols, std::vector<Flow> &out) const
+{
+    out.resize(m_cnt);
+
+    for (unsigned i = 0; i < COLUMN_CNT; ++i) {
+        const Column col = static_cast<Column>(i);
+        if ((cols & column_bit(col)) == 0) {
+            continue;
+        }
+
+        const uint8_t *ptr = m_data.data() + m_offsets[i];
+        switch (col) {
+        case Column::TS_FIRST:  dec_uint(ptr, &Flow::ts_first, true, out);   break;
+        case Column::TS_LAST:   dec_uint(ptr, &Flow::ts_last, true, out);    break;
+        case Column::BYTES:     dec_uint(ptr, &Flow::bytes, false, out);     break;
+        case Column::PACKETS:   dec_uint(ptr, &Flow::packets, false, out);   break;
+        case Column::SRC_IP:    dec_ip(ptr, &Flow::src_ip, out);             break;
+        case Column::DST_IP:    dec_ip(ptr, &Flow::dst_ip, out);             break;
+        case Column::ODID:      dec_uint(ptr, &Flow::odid, true, out);       break;
+        case Column::SRC_PORT:  dec_uint(ptr, &Flow::src_port, false, out);  break;
+        case Column::DST_PORT:  dec_uint(ptr, &Flow::dst_port, false, out);  break;
+        case Column::PROTO:     dec_uint(ptr, &Flow::proto, false, out);     break;
+        case Column::TCP_FLAGS: dec_uint(ptr, &Flow::tcp_flags, false, out); break;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * \file src/plugins/output/recent/src/Block.hpp
+ * \author agent <agent@local>
+ * \brief Compressed block of flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_BLOCK_HPP
+#define IPFIXCOL2_RECENT_BLOCK_HPP
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+/// Flow record in the unified schema of the cache
+struct Flow {
+    uint64_t ts_first;   ///< Start of the flow (milliseconds since the Epoch)
+    uint64_t ts_last;    ///< End of the flow (milliseconds since the Epoch)
+    uint64_t bytes;      ///< Number of octets
+    uint64_t packets;    ///< Number of packets
+    uint8_t src_ip[16];  ///< Source IPv6 address (or IPv4-mapped IPv6 address)
+    uint8_t dst_ip[16];  ///< Destination IPv6 address (or IPv4-mapped IPv6 address)
+    uint32_t odid;       ///< Observation Domain ID
+    uint16_t src_port;   ///< Source port
+    uint16_t dst_port;   ///< Destination port
+    uint8_t proto;       ///< Protocol identifier
+    uint8_t tcp_flags;   ///< TCP flags
+};
+
+/// Columns of the unified schema
+enum class Column : unsigned {
+    TS_FIRST = 0,
+    TS_LAST,
+    BYTES,
+    PACKETS,
+    SRC_IP,
+    DST_IP,
+    ODID,
+    SRC_PORT,
+    DST_PORT,
+    PROTO,
+    TCP_FLAGS
+};
+
+/// Number of columns
+constexpr unsigned COLUMN_CNT = static_cast<unsigned>(Column::TCP_FLAGS) + 1;
+/// Bit mask of columns
+using ColumnMask = uint32_t;
+/// Mask with all columns
+constexpr ColumnMask COLUMNS_ALL = (1U << COLUMN_CNT) - 1U;
+
+/**
+ * @brief Get a bit of a column in a mask of columns
+ * @param[in] col Column
+ */
+constexpr ColumnMask
+column_bit(Column col)
+{
+    return 1U << static_cast<unsigned>(col);
+}
+
+/**
+ * @brief Immutable block of flow records stored in columnar compressed form
+ *
+ * Each column is encoded separately, therefore, only columns required by a query have to be
+ * decoded. Timestamps are delta encoded, other numeric columns are stored as variable-length
+ * integers and IP addresses are replaced by indexes into a block specific dictionary.
+ */
+class Block {
+public:
+    /**
+     * @brief Create a block from flow records
+     * @param[in] flows   Flow records (must not be empty)
+     * @param[in] created Time of creation (used for expiration of the block)
+     */
+    Block(const std::vector<Flow> &flows, time_t created);
+    ~Block() = default;
+
+    // Disable copy constructors
+    Block(const Block &other) = delete;
+    Block &operator=(const Block &other) = delete;
+
+    /// Get number of records in the block
+    uint32_t
+    count() const {return m_cnt;};
+    /// Get the earliest start of all flows (milliseconds since the Epoch)
+    uint64_t
+    ts_min() const {return m_ts_min;};
+    /// Get the latest end of all flows (milliseconds since the Epoch)
+    uint64_t
+    ts_max() const {return m_ts_max;};
+    /// Get time of creation
+    time_t
+    created() const {return m_created;};
+    /// Get approximate amount of memory occupied by the block (in bytes)
+    size_t
+    memory() const {return sizeof(*this) + m_data.capacity();};
+
+    /**
+     * @brief Decode selected columns of the block
+     *
+     * @note Fields of columns that are not selected are undefined!
+     * @param[in]  cols Mask of columns to decode
+     * @param[out] out  Decoded flow records (resized to the number of records in the block)
+     */
+    void
+    decode(ColumnMask cols, std::vector<Flow> &out) const;
+
+private:
+    /// Number of records
+    uint32_t m_cnt;
+    /// The earliest flow start
+    uint64_t m_ts_min;
+    /// The latest flow end
+    uint64_t m_ts_max;
+    /// Time of creation
+    time_t m_created;
+    /// Encoded columns
+    std::vector<uint8_t> m_data;
+    /// Offsets of the columns in the encoded data (the last item is the total size)
+    std::array<size_t, COLUMN_CNT + 1> m_offsets;
+};
+
+#endif // IPFIXCOL2_RECENT_BLOCK_HPP
@@ -0,0 +1,109 @@
+/**
+ * \file src/plugins/output/recent/src/Cache.cpp
+ * \author agent <agent@local>
+ * \brief Time-bounded cache of recent flows (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Cache.hpp"
+
+Cache::Cache(const Config &cfg) : m_window(static_cast<time_t>(cfg.m_window)),
+    m_mem_limit(cfg.m_mem_limit), m_block_size(cfg.m_block_size)
+{
+    m_stats = {0, 0, 0, 0};
+    m_pending.reserve(m_block_size);
+    m_pending_since = 0;
+}
+
+void
+Cache::add(const Flow &flow, time_t now)
+{
+    if (m_pending.empty()) {
+        m_pending_since = now;
+    }
+
+    m_pending.push_back(flow);
+    if (m_pending.size() >= m_block_size) {
+        flush(now);
+    }
+}
+
+void
+Cache::update(time_t now)
+{
+    if (!m_pending.empty() && now - m_pending_since >= FLUSH_INTERVAL) {
+        flush(now);
+    }
+
+    expire(now);
+}
+
+void
+Cache::expire(time_t now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evict(now);
+}
+
+BlockList
+Cache::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return BlockList(m_blocks.begin(), m_blocks.end());
+}
+
+struct Cache::stats
+Cache::stats_get() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+/**
+ * @brief Convert pending records into a new block
+ *
+ * The block is compressed before the lock is acquired, so running queries are not blocked.
+ * @param[in] now Current time
+ */
+void
+Cache::flush(time_t now)
+{
+    if (m_pending.empty()) {
+        return;
+    }
+
+    std::shared_ptr<const Block> block = std::make_shared<const Block>(m_pending, now);
+    m_pending.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_blocks.push_back(block);
+    m_stats.blocks++;
+    m_stats.records += block->count();
+    m_stats.memory += block->memory();
+    evict(now);
+}
+
+/**
+ * @brief Remove the oldest blocks out of the time window or over the memory limit
+ * @note The mutex must be locked by the caller!
+ * @param[in] now Current time
+ */
+void
+Cache::evict(time_t now)
+{
+    while (!m_blocks.empty()) {
+        const Block &oldest = *m_blocks.front();
+        if (now - oldest.created() <= m_window && m_stats.memory <= m_mem_limit) {
+            break;
+        }
+
+        m_stats.blocks--;
+        m_stats.records -= oldest.count();
+        m_stats.memory -= oldest.memory();
+        m_stats.evicted += oldest.count();
+        m_blocks.pop_front();
+    }
+}
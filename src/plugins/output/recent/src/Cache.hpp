@@ -0,0 +1,124 @@
+/**
+ * \file src/plugins/output/recent/src/Cache.hpp
+ * \author agent <agent@local>
+ * \brief Time-bounded cache of recent flows (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_CACHE_HPP
+#define IPFIXCOL2_RECENT_CACHE_HPP
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Block.hpp"
+#include "Config.hpp"
+
+/// List of blocks shared with queries
+using BlockList = std::vector<std::shared_ptr<const Block>>;
+
+/**
+ * @brief Ring of compressed blocks of recent flow records
+ *
+ * New records are collected in a pending buffer which is converted into an immutable block when
+ * it is full or when it is older than a flush interval. Blocks are removed (from the oldest one)
+ * when they exceed the time window or when the memory limit is reached.
+ *
+ * @note
+ *   Functions add() and update() must be called only from a single (writer) thread. Other
+ *   functions are thread-safe. Queries work with a snapshot of blocks (see snapshot()), therefore,
+ *   eviction of a block doesn't affect running queries.
+ */
+class Cache {
+public:
+    /// Statistics of the cache
+    struct stats {
+        uint64_t blocks;   ///< Number of blocks
+        uint64_t records;  ///< Number of records in the blocks
+        uint64_t memory;   ///< Memory occupied by the blocks (in bytes)
+        uint64_t evicted;  ///< Number of evicted records since the start
+    };
+
+    /**
+     * @brief Create an empty cache
+     * @param[in] cfg Configuration
+     */
+    Cache(const Config &cfg);
+    ~Cache() = default;
+
+    // Disable copy constructors
+    Cache(const Cache &other) = delete;
+    Cache &operator=(const Cache &other) = delete;
+
+    /**
+     * @brief Add a flow record
+     *
+     * @note The record is not visible to queries until the pending buffer is flushed.
+     * @param[in] flow Flow record
+     * @param[in] now  Current time
+     */
+    void
+    add(const Flow &flow, time_t now);
+
+    /**
+     * @brief Flush the pending buffer (if it's too old) and remove expired blocks
+     * @param[in] now Current time
+     */
+    void
+    update(time_t now);
+
+    /**
+     * @brief Remove expired blocks
+     * @param[in] now Current time
+     */
+    void
+    expire(time_t now);
+
+    /**
+     * @brief Get the list of current blocks
+     * @return Blocks from the oldest to the newest one
+     */
+    BlockList
+    snapshot() const;
+
+    /**
+     * @brief Get statistics
+     */
+    struct stats
+    stats_get() const;
+
+private:
+    /// Maximum age of the pending buffer (in seconds)
+    static const time_t FLUSH_INTERVAL = 1;
+
+    /// Maximum age of blocks (in seconds)
+    const time_t m_window;
+    /// Memory limit (in bytes)
+    const uint64_t m_mem_limit;
+    /// Maximum number of records per block
+    const size_t m_block_size;
+
+    /// Mutex for the list of blocks and statistics
+    mutable std::mutex m_mutex;
+    /// Blocks from the oldest to the newest one
+    std::deque<std::shared_ptr<const Block>> m_blocks;
+    /// Statistics
+    struct stats m_stats;
+
+    /// Records waiting to be converted into a block (writer thread only)
+    std::vector<Flow> m_pending;
+    /// Time when the first pending record has been added
+    time_t m_pending_since;
+
+    void
+    flush(time_t now);
+    void
+    evict(time_t now);
+};
+
+#endif // IPFIXCOL2_RECENT_CACHE_HPP
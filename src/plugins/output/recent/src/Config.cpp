@@ -0,0 +1,170 @@
+/**
+ * \file src/plugins/output/recent/src/Config.cpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Config.hpp"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+
+/*
+ * <params>
+ *   <socketPath>...</socketPath>
+ *   <timeWindow>...</timeWindow>         <!-- optional -->
+ *   <memoryLimit>...</memoryLimit>       <!-- optional -->
+ *   <blockSize>...</blockSize>           <!-- optional -->
+ *   <queryThreads>...</queryThreads>     <!-- optional -->
+ * </params>
+ */
+
+/// XML nodes
+enum params_xml_nodes {
+    NODE_SOCKET = 1,
+    NODE_WINDOW,
+    NODE_MEMORY,
+    NODE_BLOCK,
+    NODE_THREADS
+};
+
+/// Definition of the \<params\> node
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_SOCKET,  "socketPath",   FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_WINDOW,  "timeWindow",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MEMORY,  "memoryLimit",  FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BLOCK,   "blockSize",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS, "queryThreads", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+Config::Config(const char *params)
+{
+    set_default();
+
+    // Create XML parser
+    std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
+    if (!xml) {
+        throw std::runtime_error("Failed to create an XML parser!");
+    }
+
+    if (fds_xml_set_args(xml.get(), args_params) != FDS_OK) {
+        throw std::runtime_error("Failed to parse the description of an XML document!");
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(xml.get(), params, true);
+    if (!params_ctx) {
+        std::string err = fds_xml_last_err(xml.get());
+        throw std::runtime_error("Failed to parse the configuration: " + err);
+    }
+
+    // Parse parameters and check configuration
+    try {
+        parse_root(params_ctx);
+        validate();
+    } catch (std::exception &ex) {
+        throw std::runtime_error("Failed to parse the configuration: " + std::string(ex.what()));
+    }
+}
+
+/**
+ * @brief Set default parameters
+ */
+void
+Config::set_default()
+{
+    m_socket.clear();
+    m_window = WINDOW_SIZE;
+    m_mem_limit = MEM_LIMIT * 1024U * 1024U;
+    m_block_size = BLOCK_SIZE;
+    m_threads = THREADS;
+}
+
+/**
+ * @brief Check if the configuration is valid
+ * @throw runtime_error if the configuration breaks some rules
+ */
+void
+Config::validate()
+{
+    if (m_socket.empty()) {
+        throw std::runtime_error("Socket path cannot be empty!");
+    }
+
+    if (m_window == 0) {
+        throw std::runtime_error("Time window cannot be zero!");
+    }
+
+    if (m_mem_limit == 0) {
+        throw std::runtime_error("Memory limit cannot be zero!");
+    }
+
+    if (m_block_size == 0) {
+        throw std::runtime_error("Block size cannot be zero!");
+    }
+
+    if (m_threads == 0 || m_threads > THREADS_MAX) {
+        throw std::runtime_error("Number of query threads must be between 1 and "
+            + std::to_string(THREADS_MAX) + "!");
+    }
+}
+
+/**
+ * @brief Process \<params\> node
+ * @param[in] ctx XML context to process
+ * @throw runtime_error if the parser fails
+ */
+void
+Config::parse_root(fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_SOCKET:
+            // Socket path
+            assert(content->type == FDS_OPTS_T_STRING);
+            m_socket = content->ptr_string;
+            break;
+        case NODE_WINDOW:
+            // Time window
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Time window is too long!");
+            }
+            m_window = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_MEMORY:
+            // Memory limit (in MiB)
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > (UINT64_MAX >> 20)) {
+                throw std::runtime_error("Memory limit is too big!");
+            }
+            m_mem_limit = content->val_uint << 20;
+            break;
+        case NODE_BLOCK:
+            // Records per block
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Block size is too big!");
+            }
+            m_block_size = static_cast<uint32_t>(content->val_uint);
+            break;
+        case NODE_THREADS:
+            // Query threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                throw std::runtime_error("Number of query threads is too big!");
+            }
+            m_threads = static_cast<uint32_t>(content->val_uint);
+            break;
+        default:
+            // Internal error
+            throw std::runtime_error("Unknown XML node");
+        }
+    }
+}
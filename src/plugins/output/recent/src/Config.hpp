@@ -0,0 +1,62 @@
+/**
+ * \file src/plugins/output/recent/src/Config.hpp
+ * \author agent <agent@local>
+ * \brief Parser of XML configuration (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_CONFIG_HPP
+#define IPFIXCOL2_RECENT_CONFIG_HPP
+
+#include <string>
+#include <libfds.h>
+
+/**
+ * @brief Plugin configuration parser
+ */
+class Config {
+public:
+    /**
+     * @brief Parse configuration of the plugin
+     * @param[in] params XML parameters to parse
+     * @throw runtime_exception on error
+     */
+    Config(const char *params);
+    ~Config() = default;
+
+    /// Path of the Unix domain socket for queries
+    std::string m_socket;
+    /// Maximum age of cached flows (in seconds)
+    uint32_t m_window;
+    /// Memory limit of the cache (in bytes)
+    uint64_t m_mem_limit;
+    /// Maximum number of records per block
+    uint32_t m_block_size;
+    /// Number of threads used to scan blocks during a query
+    uint32_t m_threads;
+
+private:
+    /// Default time window (in seconds)
+    static const uint32_t WINDOW_SIZE = 900U;
+    /// Default memory limit (in MiB)
+    static const uint64_t MEM_LIMIT = 512U;
+    /// Default number of records per block
+    static const uint32_t BLOCK_SIZE = 16384U;
+    /// Default number of query threads
+    static const uint32_t THREADS = 4U;
+    /// Maximum number of query threads
+    static const uint32_t THREADS_MAX = 64U;
+
+    void
+    set_default();
+    void
+    validate();
+
+    void
+    parse_root(fds_xml_ctx_t *ctx);
+};
+
+#endif // IPFIXCOL2_RECENT_CONFIG_HPP
@@ -0,0 +1,34 @@
+/**
+ * \file src/plugins/output/recent/src/Exception.hpp
+ * \author agent <agent@local>
+ * \brief Plugin specific exception (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_EXCEPTION_HPP
+#define IPFIXCOL2_RECENT_EXCEPTION_HPP
+
+#include <stdexcept>
+#include <string>
+
+/// Plugin specific exception
+class Recent_exception : public std::runtime_error {
+public:
+    /**
+     * @brief Constructor
+     * @param[in] str Error message
+     */
+    Recent_exception(const std::string &str) : std::runtime_error(str) {};
+    /**
+     * @brief Constructor
+     * @param[in] str Error message
+     */
+    Recent_exception(const char *str) : std::runtime_error(str) {};
+    // Default destructor
+    ~Recent_exception() = default;
+};
+
+#endif // IPFIXCOL2_RECENT_EXCEPTION_HPP
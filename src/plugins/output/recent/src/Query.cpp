@@ -0,0 +1,565 @@
+/**
+ * \file src/plugins/output/recent/src/Query.cpp
+ * \author agent <agent@local>
+ * \brief Queries over cached flow records (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <strings.h>
+
+#include "Exception.hpp"
+#include "Query.hpp"
+
+/// Default maximum number of records returned by "flows" query
+static const uint64_t FLOWS_LIMIT = 100U;
+/// Prefix of IPv4-mapped IPv6 addresses
+static const uint8_t IPV4_MAPPED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+
+/// Aggregation key (IPv6 address or numeric value)
+using AggrKey = std::array<uint8_t, 16>;
+
+/// Hash function of aggregation keys
+struct AggrHash {
+    size_t
+    operator()(const AggrKey &key) const
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ULL;
+        for (uint8_t byte : key) {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+/// Aggregated counters
+struct AggrVal {
+    uint64_t flows;
+    uint64_t packets;
+    uint64_t bytes;
+};
+
+struct Query::Partial {
+    /// Matching flow records ("flows" query)
+    std::vector<Flow> flows;
+    /// Aggregated records ("aggregate" query)
+    std::unordered_map<AggrKey, AggrVal, AggrHash> aggr;
+};
+
+/**
+ * @brief Compare an IP address with a prefix
+ * @param[in] addr   Address to check
+ * @param[in] net    Network address
+ * @param[in] prefix Prefix length (0 - 128)
+ */
+static inline bool
+ip_match(const uint8_t *addr, const uint8_t *net, unsigned prefix)
+{
+    const unsigned bytes = prefix / 8;
+    const unsigned bits = prefix % 8;
+
+    if (std::memcmp(addr, net, bytes) != 0) {
+        return false;
+    }
+
+    if (bits == 0) {
+        return true;
+    }
+
+    const uint8_t mask = static_cast<uint8_t>(0xFF << (8 - bits));
+    return (addr[bytes] & mask) == (net[bytes] & mask);
+}
+
+/**
+ * @brief Convert an IP address to string
+ * @param[in] addr IPv6 or IPv4-mapped IPv6 address
+ */
+static std::string
+ip2str(const uint8_t *addr)
+{
+    char buffer[INET6_ADDRSTRLEN];
+    if (std::memcmp(addr, IPV4_MAPPED, sizeof(IPV4_MAPPED)) == 0) {
+        inet_ntop(AF_INET, addr + sizeof(IPV4_MAPPED), buffer, sizeof(buffer));
+    } else {
+        inet_ntop(AF_INET6, addr, buffer, sizeof(buffer));
+    }
+
+    return buffer;
+}
+
+bool
+Query::Cond::match(const Flow &flow) const
+{
+    switch (field) {
+    case Field::SRC_IP:
+        return ip_match(flow.src_ip, addr, prefix);
+    case Field::DST_IP:
+        return ip_match(flow.dst_ip, addr, prefix);
+    case Field::ANY_IP:
+        return ip_match(flow.src_ip, addr, prefix) || ip_match(flow.dst_ip, addr, prefix);
+    case Field::SRC_PORT:
+        return flow.src_port == value;
+    case Field::DST_PORT:
+        return flow.dst_port == value;
+    case Field::ANY_PORT:
+        return flow.src_port == value || flow.dst_port == value;
+    case Field::PROTO:
+        return flow.proto == value;
+    case Field::ODID:
+        return flow.odid == value;
+    }
+
+    return false;
+}
+
+Query::Query(const std::string &str)
+{
+    m_key = Key::SRC_IP;
+    m_order = Order::BYTES;
+    m_limit = 0;
+    m_last = 0;
+
+    std::istringstream stream(str);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (stream >> token) {
+        tokens.push_back(token);
+    }
+
+    if (tokens.empty()) {
+        throw Recent_exception("Empty query");
+    }
+
+    size_t idx = 0;
+    auto next = [&tokens, &idx](const char *what) -> const std::string & {
+        if (idx >= tokens.size()) {
+            throw Recent_exception("Missing " + std::string(what));
+        }
+        return tokens[idx++];
+    };
+    auto is = [](const std::string &token, const char *keyword) {
+        return strcasecmp(token.c_str(), keyword) == 0;
+    };
+
+    // Command
+    const std::string &cmd = next("command");
+    if (is(cmd, "flows")) {
+        m_type = Type::FLOWS;
+        m_limit = FLOWS_LIMIT;
+    } else if (is(cmd, "aggregate")) {
+        m_type = Type::AGGREGATE;
+        m_key = parse_key(next("aggregation key"));
+    } else if (is(cmd, "top")) {
+        m_type = Type::AGGREGATE;
+        m_limit = parse_uint(next("number of records"), UINT32_MAX);
+        m_key = parse_key(next("aggregation key"));
+    } else if (is(cmd, "stats")) {
+        m_type = Type::STATS;
+    } else {
+        throw Recent_exception("Unknown command '" + cmd + "'");
+    }
+
+    // Options
+    while (idx < tokens.size()) {
+        const std::string &opt = next("option");
+        if (is(opt, "last")) {
+            m_last = parse_uint(next("number of seconds"), UINT32_MAX);
+        } else if (is(opt, "limit")) {
+            m_limit = parse_uint(next("number of records"), UINT32_MAX);
+        } else if (is(opt, "by") && m_type == Type::AGGREGATE) {
+            const std::string &order = next("sort order");
+            if (is(order, "bytes")) {
+                m_order = Order::BYTES;
+            } else if (is(order, "packets")) {
+                m_order = Order::PACKETS;
+            } else if (is(order, "flows")) {
+                m_order = Order::FLOWS;
+            } else {
+                throw Recent_exception("Unknown sort order '" + order + "'");
+            }
+        } else if (is(opt, "where") || (is(opt, "and") && !m_conds.empty())) {
+            m_conds.push_back(parse_cond(next("condition")));
+        } else {
+            throw Recent_exception("Unexpected token '" + opt + "'");
+        }
+    }
+}
+
+/**
+ * @brief Parse an aggregation key
+ * @param[in] str Name of the key
+ * @throw Recent_exception if the name is not valid
+ */
+Query::Key
+Query::parse_key(const std::string &str)
+{
+    static const struct {
+        const char *name;
+        Key key;
+    } keys[] = {
+        {"src_ip", Key::SRC_IP}, {"dst_ip", Key::DST_IP}, {"src_port", Key::SRC_PORT},
+        {"dst_port", Key::DST_PORT}, {"proto", Key::PROTO}, {"odid", Key::ODID}
+    };
+
+    for (const auto &item : keys) {
+        if (strcasecmp(item.name, str.c_str()) == 0) {
+            return item.key;
+        }
+    }
+
+    throw Recent_exception("Unknown aggregation key '" + str + "'");
+}
+
+/**
+ * @brief Parse a filter condition
+ * @param[in] str Condition in format "<field>=<value>"
+ * @throw Recent_exception if the condition is not valid
+ */
+Query::Cond
+Query::parse_cond(const std::string &str)
+{
+    static const struct {
+        const char *name;
+        Cond::Field field;
+        uint64_t max;   // 0 == IP address
+    } fields[] = {
+        {"src_ip", Cond::Field::SRC_IP, 0}, {"dst_ip", Cond::Field::DST_IP, 0},
+        {"ip", Cond::Field::ANY_IP, 0}, {"src_port", Cond::Field::SRC_PORT, UINT16_MAX},
+        {"dst_port", Cond::Field::DST_PORT, UINT16_MAX}, {"port", Cond::Field::ANY_PORT, UINT16_MAX},
+        {"proto", Cond::Field::PROTO, UINT8_MAX}, {"odid", Cond::Field::ODID, UINT32_MAX}
+    };
+
+    const size_t pos = str.find('=');
+    if (pos == std::string::npos) {
+        throw Recent_exception("Invalid condition '" + str + "' (expected <field>=<value>)");
+    }
+
+    const std::string name = str.substr(0, pos);
+    const std::string value = str.substr(pos + 1);
+
+    for (const auto &item : fields) {
+        if (strcasecmp(item.name, name.c_str()) != 0) {
+            continue;
+        }
+
+        Cond cond;
+        std::memset(&cond, 0, sizeof(cond));
+        cond.field = item.field;
+        if (item.max == 0) {
+            parse_ip(value, cond.addr, cond.prefix);
+        } else {
+            cond.value = parse_uint(value, item.max);
+        }
+        return cond;
+    }
+
+    throw Recent_exception("Unknown field '" + name + "'");
+}
+
+/**
+ * @brief Parse an unsigned integer
+ * @param[in] str String to parse
+ * @param[in] max Maximum allowed value
+ * @throw Recent_exception if the value is not valid
+ */
+uint64_t
+Query::parse_uint(const std::string &str, uint64_t max)
+{
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(str.c_str(), &end, 10);
+    if (str.empty() || *end != '\0' || errno != 0 || str[0] == '-' || value > max) {
+        throw Recent_exception("Invalid number '" + str + "'");
+    }
+
+    return static_cast<uint64_t>(value);
+}
+
+/**
+ * @brief Parse an IP address with optional prefix length
+ * @param[in]  str    Address (e.g. "10.0.0.1", "10.0.0.0/8", "2001:db8::/32")
+ * @param[out] addr   IPv6 or IPv4-mapped IPv6 address
+ * @param[out] prefix Prefix length (in the IPv6 address space)
+ * @throw Recent_exception if the address is not valid
+ */
+void
+Query::parse_ip(const std::string &str, uint8_t *addr, unsigned &prefix)
+{
+    const size_t pos = str.find('/');
+    const std::string ip_str = str.substr(0, pos);
+
+    unsigned max;
+    if (inet_pton(AF_INET, ip_str.c_str(), addr + sizeof(IPV4_MAPPED)) == 1) {
+        std::memcpy(addr, IPV4_MAPPED, sizeof(IPV4_MAPPED));
+        max = 32;
+    } else if (inet_pton(AF_INET6, ip_str.c_str(), addr) == 1) {
+        max = 128;
+    } else {
+        throw Recent_exception("Invalid IP address '" + ip_str + "'");
+    }
+
+    prefix = max;
+    if (pos != std::string::npos) {
+        prefix = static_cast<unsigned>(parse_uint(str.substr(pos + 1), max));
+    }
+
+    prefix += 128 - max;
+}
+
+/**
+ * @brief Get mask of columns required by the query
+ */
+ColumnMask
+Query::columns() const
+{
+    ColumnMask mask = 0;
+
+    if (m_type == Type::FLOWS) {
+        return COLUMNS_ALL;
+    }
+
+    switch (m_key) {
+    case Key::SRC_IP:   mask |= column_bit(Column::SRC_IP);   break;
+    case Key::DST_IP:   mask |= column_bit(Column::DST_IP);   break;
+    case Key::SRC_PORT: mask |= column_bit(Column::SRC_PORT); break;
+    case Key::DST_PORT: mask |= column_bit(Column::DST_PORT); break;
+    case Key::PROTO:    mask |= column_bit(Column::PROTO);    break;
+    case Key::ODID:     mask |= column_bit(Column::ODID);     break;
+    }
+
+    mask |= column_bit(Column::BYTES) | column_bit(Column::PACKETS);
+    if (m_last != 0) {
+        mask |= column_bit(Column::TS_LAST);
+    }
+
+    for (const Cond &cond : m_conds) {
+        switch (cond.field) {
+        case Cond::Field::SRC_IP:   mask |= column_bit(Column::SRC_IP);   break;
+        case Cond::Field::DST_IP:   mask |= column_bit(Column::DST_IP);   break;
+        case Cond::Field::SRC_PORT: mask |= column_bit(Column::SRC_PORT); break;
+        case Cond::Field::DST_PORT: mask |= column_bit(Column::DST_PORT); break;
+        case Cond::Field::PROTO:    mask |= column_bit(Column::PROTO);    break;
+        case Cond::Field::ODID:     mask |= column_bit(Column::ODID);     break;
+        case Cond::Field::ANY_IP:
+            mask |= column_bit(Column::SRC_IP) | column_bit(Column::DST_IP);
+            break;
+        case Cond::Field::ANY_PORT:
+            mask |= column_bit(Column::SRC_PORT) | column_bit(Column::DST_PORT);
+            break;
+        }
+    }
+
+    return mask;
+}
+
+/**
+ * @brief Scan a block and add matching records to a partial result
+ * @param[in]     block  Block to scan
+ * @param[in]     since  Ignore flows that ended before this timestamp (in milliseconds)
+ * @param[in]     buffer Auxiliary buffer for decoded records
+ * @param[in,out] res    Partial result
+ */
+void
+Query::scan(const Block &block, uint64_t since, std::vector<Flow> &buffer, Partial &res) const
+{
+    if (block.ts_max() < since) {
+        // All flows are too old
+        return;
+    }
+
+    block.decode(columns(), buffer);
+
+    for (const Flow &flow : buffer) {
+        if (m_last != 0 && flow.ts_last < since) {
+            continue;
+        }
+
+        bool match = true;
+        for (const Cond &cond : m_conds) {
+            if (!cond.match(flow)) {
+                match = false;
+                break;
+            }
+        }
+
+        if (!match) {
+            continue;
+        }
+
+        if (m_type == Type::FLOWS) {
+            res.flows.push_back(flow);
+            continue;
+        }
+
+        AggrKey key;
+        key.fill(0);
+        switch (m_key) {
+        case Key::SRC_IP:   std::memcpy(key.data(), flow.src_ip, key.size()); break;
+        case Key::DST_IP:   std::memcpy(key.data(), flow.dst_ip, key.size()); break;
+        case Key::SRC_PORT: key[0] = flow.src_port >> 8; key[1] = flow.src_port & 0xFF; break;
+        case Key::DST_PORT: key[0] = flow.dst_port >> 8; key[1] = flow.dst_port & 0xFF; break;
+        case Key::PROTO:    key[0] = flow.proto; break;
+        case Key::ODID:     std::memcpy(key.data(), &flow.odid, sizeof(flow.odid)); break;
+        }
+
+        AggrVal &val = res.aggr[key];
+        val.flows++;
+        val.packets += flow.packets;
+        val.bytes += flow.bytes;
+    }
+
+    if (m_type == Type::FLOWS && m_limit != 0 && res.flows.size() > m_limit) {
+        // Keep only the most recent flows
+        auto cmp = [](const Flow &lhs, const Flow &rhs) {return lhs.ts_last > rhs.ts_last;};
+        std::nth_element(res.flows.begin(), res.flows.begin() + m_limit, res.flows.end(), cmp);
+        res.flows.resize(m_limit);
+    }
+}
+
+std::string
+Query::execute(const BlockList &blocks, unsigned threads, time_t now) const
+{
+    const uint64_t now_sec = static_cast<uint64_t>(now);
+    const uint64_t since = (m_last != 0 && m_last < now_sec) ? (now_sec - m_last) * 1000U : 0;
+    const size_t workers_cnt = std::max<size_t>(1U, std::min<size_t>(threads, blocks.size()));
+
+    // Scan blocks in parallel (blocks are assigned dynamically to balance the load)
+    std::vector<Partial> results(workers_cnt);
+    std::atomic<size_t> block_idx(0);
+    auto worker = [&](size_t id) {
+        std::vector<Flow> buffer;
+        size_t idx;
+        while ((idx = block_idx.fetch_add(1)) < blocks.size()) {
+            scan(*blocks[idx], since, buffer, results[id]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workers_cnt; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    // Merge partial results
+    Partial &res = results[0];
+    for (size_t i = 1; i < workers_cnt; ++i) {
+        Partial &part = results[i];
+        if (m_type == Type::FLOWS) {
+            res.flows.insert(res.flows.end(), part.flows.begin(), part.flows.end());
+            continue;
+        }
+
+        for (const auto &item : part.aggr) {
+            AggrVal &val = res.aggr[item.first];
+            val.flows += item.second.flows;
+            val.packets += item.second.packets;
+            val.bytes += item.second.bytes;
+        }
+    }
+
+    return (m_type == Type::FLOWS) ? format_flows(res.flows) : format_aggr(res);
+}
+
+/**
+ * @brief Sort, limit and format flow records
+ * @param[in] flows Flow records
+ */
+std::string
+Query::format_flows(std::vector<Flow> &flows) const
+{
+    auto cmp = [](const Flow &lhs, const Flow &rhs) {return lhs.ts_last > rhs.ts_last;};
+    if (m_limit != 0 && flows.size() > m_limit) {
+        std::partial_sort(flows.begin(), flows.begin() + m_limit, flows.end(), cmp);
+        flows.resize(m_limit);
+    } else {
+        std::sort(flows.begin(), flows.end(), cmp);
+    }
+
+    std::ostringstream out;
+    out << "#ts_first\tts_last\tsrc_ip\tdst_ip\tsrc_port\tdst_port\tproto\ttcp_flags"
+        "\tpackets\tbytes\todid\n";
+    for (const Flow &flow : flows) {
+        out << flow.ts_first << '\t' << flow.ts_last << '\t'
+            << ip2str(flow.src_ip) << '\t' << ip2str(flow.dst_ip) << '\t'
+            << flow.src_port << '\t' << flow.dst_port << '\t'
+            << unsigned(flow.proto) << '\t' << unsigned(flow.tcp_flags) << '\t'
+            << flow.packets << '\t' << flow.bytes << '\t' << flow.odid << '\n';
+    }
+
+    return out.str();
+}
+
+/**
+ * @brief Sort, limit and format aggregated records
+ * @param[in] res Merged result
+ */
+std::string
+Query::format_aggr(Partial &res) const
+{
+    using item_t = std::pair<AggrKey, AggrVal>;
+    std::vector<item_t> items(res.aggr.begin(), res.aggr.end());
+
+    const Order order = m_order;
+    auto cmp = [order](const item_t &lhs, const item_t &rhs) {
+        switch (order) {
+        case Order::PACKETS: return lhs.second.packets > rhs.second.packets;
+        case Order::FLOWS:   return lhs.second.flows > rhs.second.flows;
+        default:             return lhs.second.bytes > rhs.second.bytes;
+        }
+    };
+
+    if (m_limit != 0 && items.size() > m_limit) {
+        std::partial_sort(items.begin(), items.begin() + m_limit, items.end(), cmp);
+        items.resize(m_limit);
+    } else {
+        std::sort(items.begin(), items.end(), cmp);
+    }
+
+    static const char *key_names[] = {"src_ip", "dst_ip", "src_port", "dst_port", "proto", "odid"};
+    std::ostringstream out;
+    out << '#' << key_names[static_cast<unsigned>(m_key)] << "\tflows\tpackets\tbytes\n";
+    for (const item_t &item : items) {
+        const AggrKey &key = item.first;
+        switch (m_key) {
+        case Key::SRC_IP:
+        case Key::DST_IP:
+            out << ip2str(key.data());
+            break;
+        case Key::SRC_PORT:
+        case Key::DST_PORT:
+            out << ((unsigned(key[0]) << 8) | key[1]);
+            break;
+        case Key::PROTO:
+            out << unsigned(key[0]);
+            break;
+        case Key::ODID: {
+            uint32_t odid;
+            std::memcpy(&odid, key.data(), sizeof(odid));
+            out << odid;
+            break;
+            }
+        }
+
+        out << '\t' << item.second.flows << '\t' << item.second.packets << '\t'
+            << item.second.bytes << '\n';
+    }
+
+    return out.str();
+}
@@ -0,0 +1,124 @@
+/**
+ * \file src/plugins/output/recent/src/Query.hpp
+ * \author agent <agent@local>
+ * \brief Queries over cached flow records (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_QUERY_HPP
+#define IPFIXCOL2_RECENT_QUERY_HPP
+
+#include <string>
+#include <vector>
+
+#include "Block.hpp"
+#include "Cache.hpp"
+
+/**
+ * @brief Parsed query
+ *
+ * Syntax (keywords are case insensitive):
+ * @code
+ *   flows                [last <sec>] [where <cond> [and <cond>]...] [limit <n>]
+ *   aggregate <key>      [by <order>] [last <sec>] [where ...] [limit <n>]
+ *   top <n> <key>        [by <order>] [last <sec>] [where ...]
+ *   stats
+ * @endcode
+ * where \<key\> is one of src_ip, dst_ip, src_port, dst_port, proto, odid; \<order\> is one of
+ * bytes, packets, flows and \<cond\> is "<field>=<value>" (field is one of src_ip, dst_ip, ip,
+ * src_port, dst_port, port, proto, odid; IP addresses can be followed by a prefix length).
+ */
+class Query {
+public:
+    /// Type of the query
+    enum class Type {
+        FLOWS,      ///< List of matching flow records
+        AGGREGATE,  ///< Aggregation (and top-N) of matching flow records
+        STATS       ///< Statistics of the cache
+    };
+
+    /**
+     * @brief Parse a query
+     * @param[in] str Query string
+     * @throw Recent_exception if the query is malformed
+     */
+    Query(const std::string &str);
+    ~Query() = default;
+
+    /// Get the type of the query
+    Type
+    type() const {return m_type;};
+
+    /**
+     * @brief Execute the query (except ::Type::STATS)
+     *
+     * Blocks are distributed among worker threads and each worker scans (and decodes only
+     * required columns of) its blocks. Partial results are merged afterwards.
+     * @param[in] blocks  Blocks to scan
+     * @param[in] threads Maximum number of worker threads
+     * @param[in] now     Current time (used by "last" condition)
+     * @return Formatted result (tab separated values, one record per line)
+     */
+    std::string
+    execute(const BlockList &blocks, unsigned threads, time_t now) const;
+
+private:
+    /// Aggregation key
+    enum class Key {SRC_IP, DST_IP, SRC_PORT, DST_PORT, PROTO, ODID};
+    /// Sort order of aggregated records
+    enum class Order {BYTES, PACKETS, FLOWS};
+
+    /// Filter condition
+    struct Cond {
+        /// Field to compare
+        enum class Field {SRC_IP, DST_IP, ANY_IP, SRC_PORT, DST_PORT, ANY_PORT, PROTO, ODID} field;
+        /// IP address (IPv6 or IPv4-mapped IPv6)
+        uint8_t addr[16];
+        /// Prefix length of the address
+        unsigned prefix;
+        /// Numeric value
+        uint64_t value;
+
+        bool
+        match(const Flow &flow) const;
+    };
+
+    /// Result of a worker thread
+    struct Partial;
+
+    /// Type of the query
+    Type m_type;
+    /// Aggregation key
+    Key m_key;
+    /// Sort order of aggregated records
+    Order m_order;
+    /// Maximum number of result records (0 == unlimited)
+    uint64_t m_limit;
+    /// Only flows that ended in the last N seconds (0 == all)
+    uint64_t m_last;
+    /// Filter conditions (all must match)
+    std::vector<Cond> m_conds;
+
+    ColumnMask
+    columns() const;
+    void
+    scan(const Block &block, uint64_t since, std::vector<Flow> &buffer, Partial &res) const;
+    std::string
+    format_flows(std::vector<Flow> &flows) const;
+    std::string
+    format_aggr(Partial &res) const;
+
+    static Key
+    parse_key(const std::string &str);
+    static Cond
+    parse_cond(const std::string &str);
+    static uint64_t
+    parse_uint(const std::string &str, uint64_t max);
+    static void
+    parse_ip(const std::string &str, uint8_t *addr, unsigned &prefix);
+};
+
+#endif // IPFIXCOL2_RECENT_QUERY_HPP
@@ -0,0 +1,217 @@
+/**
+ * \file src/plugins/output/recent/src/Server.cpp
+ * \author agent <agent@local>
+ * \brief Local query server (source file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Exception.hpp"
+#include "Query.hpp"
+#include "Server.hpp"
+
+/// How many pending connections queue will hold
+#define BACKLOG (10)
+/// Maximum length of a query (in bytes)
+#define QUERY_MAX (4096U)
+/// Timeout of the server loop (in milliseconds)
+#define LOOP_TIMEOUT (100)
+/// Timeout for receiving a query from a client (in seconds)
+#define CLIENT_TIMEOUT (5)
+
+Server::Server(ipx_ctx_t *ctx, const Config &cfg, Cache &cache)
+    : m_ctx(ctx), m_cache(cache), m_path(cfg.m_socket), m_threads(cfg.m_threads), m_fd(-1),
+    m_stop(false)
+{
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (m_path.size() >= sizeof(addr.sun_path)) {
+        throw Recent_exception("Socket path '" + m_path + "' is too long!");
+    }
+    std::strcpy(addr.sun_path, m_path.c_str());
+
+    // Remove a socket left by a previous instance (other files are not touched)
+    struct stat file_info;
+    if (lstat(m_path.c_str(), &file_info) == 0 && S_ISSOCK(file_info.st_mode)) {
+        unlink(m_path.c_str());
+    }
+
+    m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        throw Recent_exception("socket() failed: " + std::string(err_str));
+    }
+
+    if (bind(m_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1
+            || listen(m_fd, BACKLOG) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        close(m_fd);
+        throw Recent_exception("Failed to bind socket '" + m_path + "': " + err_str);
+    }
+
+    try {
+        m_thread = std::thread(&Server::run, this);
+    } catch (...) {
+        close(m_fd);
+        unlink(m_path.c_str());
+        throw Recent_exception("Failed to start the server thread!");
+    }
+}
+
+Server::~Server()
+{
+    m_stop = true;
+    m_thread.join();
+    close(m_fd);
+    unlink(m_path.c_str());
+}
+
+/**
+ * @brief Server thread
+ *
+ * Waits for new clients, processes their queries and removes expired blocks from the cache.
+ */
+void
+Server::run()
+{
+    IPX_CTX_INFO(m_ctx, "Waiting for queries on '%s'...", m_path.c_str());
+
+    struct pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+
+    while (!m_stop) {
+        int ret = poll(&pfd, 1, LOOP_TIMEOUT);
+        m_cache.expire(time(NULL));
+
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(m_ctx, "poll() failed: %s", err_str);
+            break;
+        }
+
+        if (ret == 0) {
+            // Timeout
+            continue;
+        }
+
+        int client_fd = accept(m_fd, nullptr, nullptr);
+        if (client_fd == -1) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(m_ctx, "accept() failed: %s", err_str);
+            continue;
+        }
+
+        client_process(client_fd);
+        close(client_fd);
+    }
+
+    IPX_CTX_INFO(m_ctx, "Query server terminated.", '\0');
+}
+
+/**
+ * @brief Receive a query from a client and send back the result
+ * @param[in] fd Client socket
+ */
+void
+Server::client_process(int fd)
+{
+    struct timeval tv;
+    tv.tv_sec = CLIENT_TIMEOUT;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // Receive the query (up to the first newline)
+    std::string query;
+    char buffer[512];
+    while (query.size() < QUERY_MAX && query.find('\n') == std::string::npos) {
+        ssize_t ret = recv(fd, buffer, sizeof(buffer), 0);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        query.append(buffer, static_cast<size_t>(ret));
+    }
+
+    size_t pos = query.find('\n');
+    if (pos != std::string::npos) {
+        query.resize(pos);
+    } else if (query.size() >= QUERY_MAX) {
+        query.clear();
+    }
+
+    const std::string result = query_process(query);
+
+    // Send the result
+    const char *ptr = result.data();
+    size_t todo = result.size();
+    while (todo > 0) {
+        ssize_t ret = send(fd, ptr, todo, MSG_NOSIGNAL);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            IPX_CTX_INFO(m_ctx, "Failed to send a query result (client disconnected)", '\0');
+            return;
+        }
+
+        ptr += ret;
+        todo -= static_cast<size_t>(ret);
+    }
+}
+
+/**
+ * @brief Parse and execute a query
+ * @param[in] str Query
+ * @return Result of the query or an error message
+ */
+std::string
+Server::query_process(const std::string &str)
+{
+    try {
+        Query query(str);
+        IPX_CTX_DEBUG(m_ctx, "Processing query '%s'", str.c_str());
+
+        if (query.type() == Query::Type::STATS) {
+            const struct Cache::stats stats = m_cache.stats_get();
+            std::ostringstream out;
+            out << "blocks\t" << stats.blocks << '\n'
+                << "records\t" << stats.records << '\n'
+                << "memory\t" << stats.memory << '\n'
+                << "evicted\t" << stats.evicted << '\n';
+            return out.str();
+        }
+
+        return query.execute(m_cache.snapshot(), m_threads, time(NULL));
+    } catch (const Recent_exception &ex) {
+        return "ERROR: " + std::string(ex.what()) + "\n";
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(m_ctx, "Query '%s' failed: %s", str.c_str(), ex.what());
+        return "ERROR: Internal error\n";
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * \file src/plugins/output/recent/src/Server.hpp
+ * \author agent <agent@local>
+ * \brief Local query server (header file)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL2_RECENT_SERVER_HPP
+#define IPFIXCOL2_RECENT_SERVER_HPP
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <ipfixcol2.h>
+
+#include "Cache.hpp"
+#include "Config.hpp"
+
+/**
+ * @brief Query server on a Unix domain socket
+ *
+ * A client connects to the socket, sends a single query terminated by a newline (or by
+ * shutting down its writing side) and receives the result. The connection is closed after the
+ * result is sent. Failed queries are reported by a line with "ERROR: " prefix.
+ *
+ * The server thread also periodically removes expired blocks from the cache, so the memory is
+ * released even if no flow records are received.
+ */
+class Server {
+public:
+    /**
+     * @brief Create the socket and start the server thread
+     * @param[in] ctx   Plugin context (only for log)
+     * @param[in] cfg   Configuration
+     * @param[in] cache Cache of flow records
+     * @throw Recent_exception on failure
+     */
+    Server(ipx_ctx_t *ctx, const Config &cfg, Cache &cache);
+    /**
+     * @brief Stop the server thread and remove the socket
+     */
+    ~Server();
+
+    // Disable copy constructors
+    Server(const Server &other) = delete;
+    Server &operator=(const Server &other) = delete;
+
+private:
+    /// Plugin context only for logging!
+    ipx_ctx_t *m_ctx;
+    /// Cache of flow records
+    Cache &m_cache;
+    /// Path of the socket
+    std::string m_path;
+    /// Number of threads per query
+    unsigned m_threads;
+
+    /// Listening socket
+    int m_fd;
+    /// Stop flag of the thread
+    std::atomic<bool> m_stop;
+    /// Server thread
+    std::thread m_thread;
+
+    void
+    run();
+    void
+    client_process(int fd);
+    std::string
+    query_process(const std::string &str);
+};
+
+#endif // IPFIXCOL2_RECENT_SERVER_HPP
@@ -0,0 +1,202 @@
+/**
+ * \file src/plugins/output/recent/src/recent.cpp
+ * \author agent <agent@local>
+ * \brief In-memory cache of recent flows (output plugin)
+ * \date 2026
+ *
+ * Copyright(c) 2026 CESNET z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <ipfixcol2.h>
+
+#include "Cache.hpp"
+#include "Config.hpp"
+#include "Exception.hpp"
+#include "Server.hpp"
+
+/// Plugin description
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin identification name
+    "recent",
+    // Brief description of plugin
+    "In-memory cache of recent flows with a local query interface",
+    // Plugin type
+    IPX_PT_OUTPUT,
+    // Configuration flags (reserved for future use)
+    0,
+    // Plugin version string (like "1.2.3")
+    "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    "2.1.0"
+};
+
+/// Interval of periodic flushes of pending records (milliseconds)
+#define FLUSH_CHECK_INTERVAL 250
+
+/// Instance
+struct Instance {
+    /// Parsed configuration
+    std::unique_ptr<Config> config_ptr = nullptr;
+    /// Cache of flow records
+    std::unique_ptr<Cache> cache_ptr = nullptr;
+    /// Query server
+    std::unique_ptr<Server> server_ptr = nullptr;
+};
+
+/// IANA Information Elements not covered by the flow information of the collector
+enum iana_ie {
+    IE_OCTETS = 1,
+    IE_PACKETS = 2,
+    IE_TCP_FLAGS = 6
+};
+
+/**
+ * @brief Get an unsigned integer field of a Data Record
+ * @param[in] rec Data Record
+ * @param[in] id  IANA Information Element ID
+ * @return Value or 0 (not present or invalid)
+ */
+static uint64_t
+drec_get_uint(struct fds_drec *rec, uint16_t id)
+{
+    struct fds_drec_field field;
+    uint64_t value;
+
+    if (fds_drec_find(rec, 0, id, &field) == FDS_EOC
+            || fds_get_uint_be(field.data, field.size, &value) != FDS_OK) {
+        return 0;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Convert an IPFIX Data Record to the unified schema
+ *
+ * The flow key and timestamps are taken from the flow information derived by the collector.
+ * @param[in]  rec     Data Record
+ * @param[in]  info    Flow information of the record
+ * @param[in]  odid    Observation Domain ID
+ * @param[in]  ts_def  Default timestamp (milliseconds since the Epoch)
+ * @param[out] flow    Flow record
+ */
+static void
+flow_from_drec(struct fds_drec *rec, const struct ipx_flow_info &info, uint32_t odid,
+    uint64_t ts_def, Flow &flow)
+{
+    flow.ts_first = (info.flags & IPX_FLOW_START) ? (info.start / 1000000U) : ts_def;
+    flow.ts_last = (info.flags & IPX_FLOW_END) ? (info.end / 1000000U) : flow.ts_first;
+    flow.bytes = drec_get_uint(rec, IE_OCTETS);
+    flow.packets = drec_get_uint(rec, IE_PACKETS);
+    std::memcpy(flow.src_ip, info.src_addr, sizeof(info.src_addr));
+    std::memcpy(flow.dst_ip, info.dst_addr, sizeof(info.dst_addr));
+    flow.odid = odid;
+    flow.src_port = info.src_port;
+    flow.dst_port = info.dst_port;
+    flow.proto = info.proto;
+    flow.tcp_flags = static_cast<uint8_t>(drec_get_uint(rec, IE_TCP_FLAGS));
+}
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    try {
+        // Parse configuration, create the cache and start the query server
+        std::unique_ptr<Instance> instance(new Instance);
+        instance->config_ptr.reset(new Config(params));
+        instance->cache_ptr.reset(new Cache(*instance->config_ptr));
+        instance->server_ptr.reset(new Server(ctx, *instance->config_ptr, *instance->cache_ptr));
+        // Pending records must become visible even if no more messages are received
+        if (ipx_ctx_tick_set(ctx, FLUSH_CHECK_INTERVAL) != IPX_OK) {
+            throw Recent_exception("Failed to enable periodic flushes of pending records");
+        }
+        // Everything seems OK
+        ipx_ctx_private_set(ctx, instance.release());
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Initialization failed: %s", ex.what());
+        return IPX_ERR_DENIED;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx; // Suppress warnings
+
+    try {
+        auto inst = reinterpret_cast<Instance *>(cfg);
+        // The server must be stopped first, it refers to the cache
+        inst->server_ptr.reset();
+        inst->cache_ptr.reset();
+        inst->config_ptr.reset();
+        delete inst;
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Something bad happened during plugin destruction", '\0');
+    }
+}
+
+int
+ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    auto *inst = reinterpret_cast<Instance *>(cfg);
+    Cache &cache = *inst->cache_ptr;
+    const time_t now = time(NULL);
+
+    try {
+        ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg_ipfix);
+        auto hdr_ptr = reinterpret_cast<fds_ipfix_msg_hdr *>(ipx_msg_ipfix_get_packet(msg_ipfix));
+        const uint64_t exp_time = static_cast<uint64_t>(ntohl(hdr_ptr->export_time)) * 1000U;
+
+        Flow flow;
+        const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(msg_ipfix);
+        for (uint32_t i = 0; i < rec_cnt; ++i) {
+            struct ipx_ipfix_record *rec_ptr = ipx_msg_ipfix_get_drec(msg_ipfix, i);
+            if (rec_ptr->rec.tmplt->type != FDS_TYPE_TEMPLATE) {
+                // Options records are not flows
+                continue;
+            }
+
+            const struct ipx_flow_info *info = ipx_msg_ipfix_get_flow_info(msg_ipfix, i);
+            if (!info) {
+                throw Recent_exception("Failed to derive flow information (memory allocation error)");
+            }
+
+            flow_from_drec(&rec_ptr->rec, *info, msg_ctx->odid, exp_time, flow);
+            cache.add(flow, now);
+        }
+
+        // Make new records visible and remove old ones
+        cache.update(now);
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Unexpected error has occurred: %s", ex.what());
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now)
+{
+    auto *inst = reinterpret_cast<Instance *>(cfg);
+
+    try {
+        // Make pending records visible and remove old ones
+        inst->cache_ptr->update(now->tv_sec);
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(ctx, "Unexpected error has occurred: %s", ex.what());
+    } catch (...) {
+        IPX_CTX_ERROR(ctx, "Unknown error has occurred!", '\0');
+    }
+}
@@ -99,6 +99,18 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Only flowStart... and flowEnd... timestamps are checked
+    const uint32_t pens[] = {PEN_IANA, PEN_IANA_REV};
+    for (size_t i = 0; i < sizeof(pens) / sizeof(pens[0]); ++i) {
+        for (uint16_t id = 150U; id <= 157U; ++id) {
+            if (ipx_ctx_ie_demand(ctx, pens[i], id) != IPX_OK) {
+                config_destroy(data->config);
+                free(data);
+                return IPX_ERR_DENIED;
+            }
+        }
+    }
+
     data->ctx = ctx;
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
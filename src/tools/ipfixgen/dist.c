@@ -0,0 +1,215 @@
+/**
+ * \file ipfixgen/dist.c
+ * \author agent <agent@local>
+ * \brief Random generator and value distributions (source file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "dist.h"
+
+/**
+ * \brief SplitMix64 generator (used only for seeding)
+ * \param[in,out] state State of the generator
+ */
+static uint64_t
+splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void
+rng_init(struct rng *rng, uint64_t seed)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+
+/**
+ * \brief Build an alias table from (non-normalized) weights
+ * \param[out] alias   Alias table
+ * \param[in]  weights Weights of outcomes (content is modified!)
+ * \param[in]  cnt     Number of outcomes
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+alias_build(struct dist_alias *alias, double *weights, uint32_t cnt)
+{
+    double sum = 0.0;
+    for (uint32_t i = 0; i < cnt; ++i) {
+        sum += weights[i];
+    }
+    if (cnt == 0 || !(sum > 0.0)) {
+        return 1;
+    }
+
+    alias->cnt = cnt;
+    alias->prob = malloc(cnt * sizeof(*alias->prob));
+    alias->alias = malloc(cnt * sizeof(*alias->alias));
+    uint32_t *work = malloc(cnt * sizeof(*work));
+    if (!alias->prob || !alias->alias || !work) {
+        free(alias->prob);
+        free(alias->alias);
+        free(work);
+        alias->prob = NULL;
+        alias->alias = NULL;
+        return 1;
+    }
+
+    // Split outcomes into "small" (from the beginning) and "large" (from the end) ones
+    uint32_t small_cnt = 0;
+    uint32_t large_idx = cnt;
+    for (uint32_t i = 0; i < cnt; ++i) {
+        weights[i] = weights[i] * cnt / sum;
+        if (weights[i] < 1.0) {
+            work[small_cnt++] = i;
+        } else {
+            work[--large_idx] = i;
+        }
+    }
+
+    while (small_cnt > 0 && large_idx < cnt) {
+        const uint32_t small = work[--small_cnt];
+        const uint32_t large = work[large_idx];
+
+        alias->prob[small] = (float) weights[small];
+        alias->alias[small] = large;
+        weights[large] -= (1.0 - weights[small]);
+        if (weights[large] < 1.0) {
+            // The large one became small (replace it in the "large" part)
+            large_idx++;
+            work[small_cnt++] = large;
+        }
+    }
+
+    // Remaining outcomes (incl. rounding errors) are always kept
+    while (small_cnt > 0) {
+        const uint32_t idx = work[--small_cnt];
+        alias->prob[idx] = 1.0f;
+        alias->alias[idx] = idx;
+    }
+    while (large_idx < cnt) {
+        const uint32_t idx = work[large_idx++];
+        alias->prob[idx] = 1.0f;
+        alias->alias[idx] = idx;
+    }
+
+    free(work);
+    return 0;
+}
+
+int
+dist_init(struct dist *dist, enum dist_type type, const struct dist_item *items, size_t cnt,
+    double exponent)
+{
+    memset(dist, 0, sizeof(*dist));
+    if (cnt == 0 || (type != DIST_MIX && cnt != 1) || cnt > UINT32_MAX) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        if (items[i].min > items[i].max) {
+            return 1;
+        }
+    }
+
+    dist->type = type;
+    dist->items_cnt = cnt;
+    dist->items = malloc(cnt * sizeof(*items));
+    if (!dist->items) {
+        return 1;
+    }
+    memcpy(dist->items, items, cnt * sizeof(*items));
+
+    double *weights = NULL;
+    uint32_t weights_cnt = 0;
+
+    switch (type) {
+    case DIST_CONST:
+    case DIST_UNIFORM:
+        return 0;
+    case DIST_ZIPF: {
+        const uint64_t range = items[0].max - items[0].min;
+        if (range >= DIST_ZIPF_MAX || !(exponent > 0.0)) {
+            break;
+        }
+        weights_cnt = (uint32_t) range + 1;
+        weights = malloc(weights_cnt * sizeof(*weights));
+        if (!weights) {
+            break;
+        }
+        for (uint32_t i = 0; i < weights_cnt; ++i) {
+            weights[i] = 1.0 / pow((double) i + 1.0, exponent);
+        }
+        }
+        break;
+    case DIST_MIX:
+        weights_cnt = (uint32_t) cnt;
+        weights = malloc(weights_cnt * sizeof(*weights));
+        if (!weights) {
+            break;
+        }
+        for (uint32_t i = 0; i < weights_cnt; ++i) {
+            weights[i] = (items[i].weight > 0.0) ? items[i].weight : 0.0;
+        }
+        break;
+    }
+
+    if (!weights || alias_build(&dist->alias, weights, weights_cnt) != 0) {
+        free(weights);
+        dist_clear(dist);
+        return 1;
+    }
+
+    free(weights);
+    return 0;
+}
+
+void
+dist_clear(struct dist *dist)
+{
+    free(dist->items);
+    free(dist->alias.prob);
+    free(dist->alias.alias);
+    memset(dist, 0, sizeof(*dist));
+}
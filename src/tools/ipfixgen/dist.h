@@ -0,0 +1,215 @@
+/**
+ * \file ipfixgen/dist.h
+ * \author agent <agent@local>
+ * \brief Random generator and value distributions (header file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef IPFIXGEN_DIST_H
+#define IPFIXGEN_DIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * \brief Fast pseudo-random generator (xoshiro256**)
+ *
+ * Each generator thread has its own instance, therefore, no synchronization is required.
+ */
+struct rng {
+    uint64_t s[4];
+};
+
+/**
+ * \brief Initialize a generator
+ * \param[out] rng  Generator
+ * \param[in]  seed Seed (different seeds produce independent sequences)
+ */
+void
+rng_init(struct rng *rng, uint64_t seed);
+
+/**
+ * \brief Get next 64-bit random number
+ * \param[in] rng Generator
+ */
+static inline uint64_t
+rng_next(struct rng *rng)
+{
+    uint64_t *s = rng->s;
+    const uint64_t x = s[1] * 5;
+    const uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+/**
+ * \brief Get a random number from the interval [0, n)
+ * \note If \p n is 0, the whole 64-bit range is used.
+ * \param[in] rng Generator
+ * \param[in] n   Upper bound (exclusive)
+ */
+static inline uint64_t
+rng_below(struct rng *rng, uint64_t n)
+{
+    const uint64_t r = rng_next(rng);
+    return (n == 0) ? r : (uint64_t) (((unsigned __int128) r * n) >> 64);
+}
+
+/**
+ * \brief Get a random number from the interval [0, 1)
+ * \param[in] rng Generator
+ */
+static inline double
+rng_unit(struct rng *rng)
+{
+    return (rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/** Type of a distribution */
+enum dist_type {
+    DIST_CONST,    ///< Constant value
+    DIST_UNIFORM,  ///< Uniform distribution over an interval
+    DIST_ZIPF,     ///< Zipf distribution over an interval (the lowest value is the most popular)
+    DIST_MIX       ///< Weighted mix of values and intervals
+};
+
+/** Maximum number of distinct values of a Zipf distribution */
+#define DIST_ZIPF_MAX (1U << 22)
+
+/**
+ * \brief Interval of values [min, max] with a weight
+ */
+struct dist_item {
+    uint64_t min;    ///< Lower bound (inclusive)
+    uint64_t max;    ///< Upper bound (inclusive)
+    double weight;   ///< Relative weight
+};
+
+/**
+ * \brief Alias table (Vose's method) for O(1) sampling of discrete distributions
+ */
+struct dist_alias {
+    uint32_t cnt;    ///< Number of outcomes
+    float *prob;     ///< Probability of keeping the outcome
+    uint32_t *alias; ///< Alternative outcome
+};
+
+/**
+ * \brief Distribution of 64-bit values
+ *
+ * The distribution is read-only after initialization and can be shared by multiple threads.
+ */
+struct dist {
+    /** Type of the distribution                           */
+    enum dist_type type;
+    /** Intervals (CONST/UNIFORM/ZIPF: 1, MIX: any)        */
+    struct dist_item *items;
+    /** Number of intervals                                */
+    size_t items_cnt;
+    /** Alias table (ZIPF: ranks, MIX: items)              */
+    struct dist_alias alias;
+};
+
+/**
+ * \brief Initialize a distribution
+ *
+ * \note Weights of \p items are used only by the MIX distribution. The ZIPF distribution supports
+ *   at most ::DIST_ZIPF_MAX distinct values.
+ * \param[out] dist     Distribution
+ * \param[in]  type     Type of the distribution
+ * \param[in]  items    Intervals (the content is copied)
+ * \param[in]  cnt      Number of intervals (CONST/UNIFORM/ZIPF: must be 1)
+ * \param[in]  exponent Exponent of the ZIPF distribution (ignored by other types)
+ * \return 0 on success, otherwise non-zero (invalid arguments or memory allocation error)
+ */
+int
+dist_init(struct dist *dist, enum dist_type type, const struct dist_item *items, size_t cnt,
+    double exponent);
+
+/**
+ * \brief Free resources of a distribution
+ * \param[in] dist Distribution
+ */
+void
+dist_clear(struct dist *dist);
+
+/**
+ * \brief Sample an outcome of an alias table
+ * \param[in] alias Alias table
+ * \param[in] rng   Generator
+ */
+static inline uint32_t
+dist_alias_sample(const struct dist_alias *alias, struct rng *rng)
+{
+    const uint64_t r = rng_next(rng);
+    const uint32_t idx = (uint32_t) (((r >> 32) * alias->cnt) >> 32);
+    const float coin = (float) (r & 0xFFFFFFU) * (1.0f / 16777216.0f);
+    return (coin < alias->prob[idx]) ? idx : alias->alias[idx];
+}
+
+/**
+ * \brief Get a random value of a distribution
+ * \param[in] dist Distribution
+ * \param[in] rng  Generator
+ */
+static inline uint64_t
+dist_sample(const struct dist *dist, struct rng *rng)
+{
+    const struct dist_item *item;
+
+    switch (dist->type) {
+    case DIST_CONST:
+        return dist->items[0].min;
+    case DIST_UNIFORM:
+        item = &dist->items[0];
+        return item->min + rng_below(rng, item->max - item->min + 1);
+    case DIST_ZIPF:
+        return dist->items[0].min + dist_alias_sample(&dist->alias, rng);
+    case DIST_MIX:
+    default:
+        item = &dist->items[dist_alias_sample(&dist->alias, rng)];
+        return item->min + rng_below(rng, item->max - item->min + 1);
+    }
+}
+
+#endif // IPFIXGEN_DIST_H
@@ -0,0 +1,543 @@
+/**
+ * \file ipfixgen/encoder.c
+ * \author agent <agent@local>
+ * \brief Encoders of IPFIX and NetFlow packets (source file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <endian.h>
+#include <libfds.h>
+
+#include "encoder.h"
+
+/** Private Enterprise Number of reverse Information Elements (RFC 5103) */
+#define REVERSE_PEN 29305U
+/** IPFIX: flowStartMilliseconds                         */
+#define IPFIX_IE_FLOW_START 152U
+/** IPFIX: flowEndMilliseconds                           */
+#define IPFIX_IE_FLOW_END   153U
+/** NetFlow v9: FIRST_SWITCHED                           */
+#define NF9_IE_FIRST        22U
+/** NetFlow v9: LAST_SWITCHED                            */
+#define NF9_IE_LAST         21U
+/** Template ID of uniflow records                       */
+#define TMPLT_ID_UNI        256U
+/** Template ID of biflow records                        */
+#define TMPLT_ID_BI         257U
+/** Maximum number of records in a NetFlow v5 packet     */
+#define NF5_MAX_RECS        30U
+
+/** NetFlow v5 packet header */
+struct __attribute__((__packed__)) nf5_hdr {
+    uint16_t version;
+    uint16_t count;
+    uint32_t sys_uptime;
+    uint32_t unix_sec;
+    uint32_t unix_nsec;
+    uint32_t flow_seq;
+    uint8_t  engine_type;
+    uint8_t  engine_id;
+    uint16_t sampling_interval;
+};
+
+/** NetFlow v5 record */
+struct __attribute__((__packed__)) nf5_rec {
+    uint32_t addr_src;
+    uint32_t addr_dst;
+    uint32_t nexthop;
+    uint16_t snmp_input;
+    uint16_t snmp_output;
+    uint32_t delta_pkts;
+    uint32_t delta_octets;
+    uint32_t ts_first;
+    uint32_t ts_last;
+    uint16_t port_src;
+    uint16_t port_dst;
+    uint8_t  _pad1;
+    uint8_t  tcp_flags;
+    uint8_t  proto;
+    uint8_t  tos;
+    uint16_t as_src;
+    uint16_t as_dst;
+    uint8_t  mask_src;
+    uint8_t  mask_dst;
+    uint16_t _pad2;
+};
+
+/** NetFlow v9 packet header */
+struct __attribute__((__packed__)) nf9_hdr {
+    uint16_t version;
+    uint16_t count;
+    uint32_t sys_uptime;
+    uint32_t unix_sec;
+    uint32_t seq_number;
+    uint32_t source_id;
+};
+
+/** Size of a (Flow)Set header (the same in IPFIX and NetFlow v9) */
+#define SET_HDR_LEN (sizeof(struct fds_ipfix_set_hdr))
+
+/**
+ * \brief Write an unsigned integer in network byte order
+ * \param[out] ptr   Output
+ * \param[in]  value Value
+ * \param[in]  size  Size of the field (1, 2, 4 or 8 bytes)
+ */
+static inline void
+put_uint(uint8_t *ptr, uint64_t value, uint16_t size)
+{
+    uint16_t u16;
+    uint32_t u32;
+
+    switch (size) {
+    case 1:
+        *ptr = (uint8_t) value;
+        break;
+    case 2:
+        u16 = htobe16((uint16_t) value);
+        memcpy(ptr, &u16, sizeof(u16));
+        break;
+    case 4:
+        u32 = htobe32((uint32_t) value);
+        memcpy(ptr, &u32, sizeof(u32));
+        break;
+    default:
+        value = htobe64(value);
+        memcpy(ptr, &value, sizeof(value));
+        break;
+    }
+}
+
+/**
+ * \brief Generate timestamps of a flow
+ * \param[in]  enc    Encoder
+ * \param[in]  rng    Random generator
+ * \param[in]  now_ms Current time (ms)
+ * \param[out] start  Flow start (ms)
+ * \param[out] end    Flow end (ms)
+ */
+static inline void
+flow_times(const struct encoder *enc, struct rng *rng, uint64_t now_ms, uint64_t *start,
+    uint64_t *end)
+{
+    *start = now_ms - rng_below(rng, enc->profile->flow_age);
+    *end = *start + rng_below(rng, now_ms - *start + 1);
+}
+
+/**
+ * \brief Write values of all profile fields (in the template order)
+ * \param[in]  enc Encoder
+ * \param[in]  rng Random generator
+ * \param[out] ptr Output
+ * \return Pointer after the last written field
+ */
+static inline uint8_t *
+fields_write(const struct encoder *enc, struct rng *rng, uint8_t *ptr)
+{
+    const struct profile *profile = enc->profile;
+
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        const struct profile_field *field = &profile->fields[i];
+        const struct field_def *def = field_def_get(field->id);
+        const uint64_t value = dist_sample(&field->dist, rng);
+
+        if (def->type == FIELD_T_IPV6) {
+            memcpy(ptr, field->ip6_prefix, 8U);
+            put_uint(ptr + 8U, value, 8U);
+        } else {
+            put_uint(ptr, value, def->size);
+        }
+        ptr += def->size;
+    }
+
+    return ptr;
+}
+
+/**
+ * \brief Write reverse counters of a biflow record
+ * \param[in]  enc Encoder
+ * \param[in]  rng Random generator
+ * \param[out] ptr Output
+ * \return Pointer after the last written field
+ */
+static inline uint8_t *
+fields_write_rev(const struct encoder *enc, struct rng *rng, uint8_t *ptr)
+{
+    const struct profile *profile = enc->profile;
+
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        const struct profile_field *field = &profile->fields[i];
+        const struct field_def *def = field_def_get(field->id);
+        if (def->rev_id == 0) {
+            continue;
+        }
+
+        put_uint(ptr, dist_sample(&field->dist, rng), def->size);
+        ptr += def->size;
+    }
+
+    return ptr;
+}
+
+/**
+ * \brief Write a Template Record
+ * \param[in]  enc   Encoder
+ * \param[in]  id    Template ID
+ * \param[in]  biflow Add reverse counters
+ * \param[out] ptr   Output
+ * \return Pointer after the Template Record
+ */
+static uint8_t *
+tmplt_write(const struct encoder *enc, uint16_t id, bool biflow, uint8_t *ptr)
+{
+    const struct profile *profile = enc->profile;
+    const bool nf9 = (profile->format == PROFILE_FMT_NF9);
+    uint8_t *cnt_ptr = ptr + 2U;
+    uint16_t cnt = 0;
+
+    put_uint(ptr, id, 2U);
+    ptr += 4U;
+
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        const struct field_def *def = field_def_get(profile->fields[i].id);
+        put_uint(ptr, def->ie_id, 2U);
+        put_uint(ptr + 2U, def->size, 2U);
+        ptr += 4U;
+        cnt++;
+    }
+
+    put_uint(ptr, nf9 ? NF9_IE_LAST : IPFIX_IE_FLOW_START, 2U);
+    put_uint(ptr + 2U, nf9 ? 4U : 8U, 2U);
+    put_uint(ptr + 4U, nf9 ? NF9_IE_FIRST : IPFIX_IE_FLOW_END, 2U);
+    put_uint(ptr + 6U, nf9 ? 4U : 8U, 2U);
+    ptr += 8U;
+    cnt += 2;
+
+    for (size_t i = 0; biflow && i < profile->fields_cnt; ++i) {
+        const struct field_def *def = field_def_get(profile->fields[i].id);
+        if (def->rev_id == 0) {
+            continue;
+        }
+        put_uint(ptr, 0x8000U | def->rev_id, 2U);
+        put_uint(ptr + 2U, def->size, 2U);
+        put_uint(ptr + 4U, REVERSE_PEN, 4U);
+        ptr += 8U;
+        cnt++;
+    }
+
+    put_uint(cnt_ptr, cnt, 2U);
+    return ptr;
+}
+
+int
+encoder_init(struct encoder *enc, const struct profile *profile)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->profile = profile;
+
+    if (profile->format == PROFILE_FMT_NF5) {
+        enc->rec_size[0] = enc->rec_size[1] = sizeof(struct nf5_rec);
+        return 0;
+    }
+
+    const bool nf9 = (profile->format == PROFILE_FMT_NF9);
+    const bool biflow = (profile->biflow_share > 0.0);
+    size_t size_uni = nf9 ? 8U : 16U; // timestamps
+    size_t size_rev = 0;
+    size_t fields_rev = 0;
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        const struct field_def *def = field_def_get(profile->fields[i].id);
+        size_uni += def->size;
+        if (def->rev_id != 0) {
+            size_rev += def->size;
+            fields_rev++;
+        }
+    }
+    enc->rec_size[0] = (uint16_t) size_uni;
+    enc->rec_size[1] = (uint16_t) (size_uni + size_rev);
+
+    // Template Set (header + uniflow template + optional biflow template)
+    size_t tset_size = SET_HDR_LEN + 4U + 4U * (profile->fields_cnt + 2U);
+    if (biflow) {
+        tset_size += 4U + 4U * (profile->fields_cnt + 2U) + 8U * fields_rev;
+    }
+
+    const size_t hdr_size = nf9 ? sizeof(struct nf9_hdr) : FDS_IPFIX_MSG_HDR_LEN;
+    if (hdr_size + tset_size + 2U * SET_HDR_LEN + enc->rec_size[1] > profile->mtu) {
+        fprintf(stderr, "MTU is too small for the defined fields\n");
+        return 1;
+    }
+
+    enc->tset = malloc(tset_size);
+    if (!enc->tset) {
+        fprintf(stderr, "Memory allocation error\n");
+        return 1;
+    }
+
+    uint8_t *ptr = enc->tset + SET_HDR_LEN;
+    ptr = tmplt_write(enc, TMPLT_ID_UNI, false, ptr);
+    enc->tset_recs = 1;
+    if (biflow) {
+        ptr = tmplt_write(enc, TMPLT_ID_BI, true, ptr);
+        enc->tset_recs++;
+    }
+
+    put_uint(enc->tset, nf9 ? 0U : FDS_IPFIX_SET_TMPLT, 2U);
+    put_uint(enc->tset + 2U, tset_size, 2U);
+    enc->tset_size = (uint16_t) tset_size;
+    return 0;
+}
+
+void
+encoder_clear(struct encoder *enc)
+{
+    free(enc->tset);
+    enc->tset = NULL;
+}
+
+/**
+ * \brief Check whether templates must be (re)sent in the next packet of an exporter
+ * \param[in] enc Encoder
+ * \param[in] exp Exporter
+ */
+static inline bool
+tmplt_needed(const struct encoder *enc, const struct exporter *exp)
+{
+    const uint32_t refresh = enc->profile->tmplt_refresh;
+    return exp->pkts == 0 || (refresh != 0 && (exp->pkts % refresh) == 0);
+}
+
+/**
+ * \brief Generate a NetFlow v5 packet
+ * \copydetails encoder_packet
+ */
+static uint16_t
+packet_nf5(const struct encoder *enc, struct exporter *exp, struct rng *rng, uint64_t now_ms,
+    uint32_t max_recs, uint8_t *buffer, uint32_t *recs)
+{
+    const struct profile *profile = enc->profile;
+    uint32_t cnt = (profile->mtu - sizeof(struct nf5_hdr)) / sizeof(struct nf5_rec);
+    cnt = (cnt > NF5_MAX_RECS) ? NF5_MAX_RECS : cnt;
+    cnt = (cnt > max_recs) ? max_recs : cnt;
+
+    struct nf5_hdr *hdr = (struct nf5_hdr *) buffer;
+    hdr->version = htobe16(5U);
+    hdr->count = htobe16((uint16_t) cnt);
+    hdr->sys_uptime = htobe32((uint32_t) (now_ms - exp->boot_ms));
+    hdr->unix_sec = htobe32((uint32_t) (now_ms / 1000U));
+    hdr->unix_nsec = htobe32((uint32_t) ((now_ms % 1000U) * 1000000U));
+    hdr->flow_seq = htobe32(exp->seq);
+    hdr->engine_type = 0;
+    hdr->engine_id = (uint8_t) exp->odid;
+    hdr->sampling_interval = 0;
+
+    struct nf5_rec *rec = (struct nf5_rec *) (buffer + sizeof(*hdr));
+    memset(rec, 0, cnt * sizeof(*rec));
+
+    for (uint32_t i = 0; i < cnt; ++i, ++rec) {
+        uint64_t start, end;
+        flow_times(enc, rng, now_ms, &start, &end);
+        rec->ts_first = htobe32((uint32_t) (start - exp->boot_ms));
+        rec->ts_last = htobe32((uint32_t) (end - exp->boot_ms));
+
+        for (size_t f = 0; f < profile->fields_cnt; ++f) {
+            const struct profile_field *field = &profile->fields[f];
+            const uint64_t value = dist_sample(&field->dist, rng);
+
+            switch (field->id) {
+            case FIELD_SRC_ADDR4: rec->addr_src = htobe32((uint32_t) value); break;
+            case FIELD_DST_ADDR4: rec->addr_dst = htobe32((uint32_t) value); break;
+            case FIELD_SRC_PORT:  rec->port_src = htobe16((uint16_t) value); break;
+            case FIELD_DST_PORT:  rec->port_dst = htobe16((uint16_t) value); break;
+            case FIELD_PROTOCOL:  rec->proto = (uint8_t) value; break;
+            case FIELD_TCP_FLAGS: rec->tcp_flags = (uint8_t) value; break;
+            case FIELD_TOS:       rec->tos = (uint8_t) value; break;
+            case FIELD_BYTES:     rec->delta_octets = htobe32((uint32_t) value); break;
+            case FIELD_PACKETS:   rec->delta_pkts = htobe32((uint32_t) value); break;
+            case FIELD_IN_IF:     rec->snmp_input = htobe16((uint16_t) value); break;
+            case FIELD_OUT_IF:    rec->snmp_output = htobe16((uint16_t) value); break;
+            case FIELD_SRC_AS:    rec->as_src = htobe16((uint16_t) value); break;
+            case FIELD_DST_AS:    rec->as_dst = htobe16((uint16_t) value); break;
+            default:
+                // IPv6 addresses are refused by the profile parser
+                break;
+            }
+        }
+    }
+
+    exp->seq += cnt;
+    *recs = cnt;
+    return (uint16_t) (sizeof(*hdr) + cnt * sizeof(struct nf5_rec));
+}
+
+/**
+ * \brief Generate a NetFlow v9 packet
+ * \copydetails encoder_packet
+ */
+static uint16_t
+packet_nf9(const struct encoder *enc, struct exporter *exp, struct rng *rng, uint64_t now_ms,
+    uint32_t max_recs, uint8_t *buffer, uint32_t *recs)
+{
+    const struct profile *profile = enc->profile;
+    struct nf9_hdr *hdr = (struct nf9_hdr *) buffer;
+    uint8_t *ptr = buffer + sizeof(*hdr);
+    uint16_t tmplts = 0;
+
+    if (tmplt_needed(enc, exp)) {
+        memcpy(ptr, enc->tset, enc->tset_size);
+        ptr += enc->tset_size;
+        tmplts = enc->tset_recs;
+    }
+
+    const size_t space = profile->mtu - (size_t) (ptr - buffer) - SET_HDR_LEN;
+    uint32_t cnt = (uint32_t) (space / enc->rec_size[0]);
+    cnt = (cnt > max_recs) ? max_recs : cnt;
+
+    uint8_t *set = ptr;
+    ptr += SET_HDR_LEN;
+    for (uint32_t i = 0; i < cnt; ++i) {
+        uint64_t start, end;
+        ptr = fields_write(enc, rng, ptr);
+        flow_times(enc, rng, now_ms, &start, &end);
+        put_uint(ptr, end - exp->boot_ms, 4U);
+        put_uint(ptr + 4U, start - exp->boot_ms, 4U);
+        ptr += 8U;
+    }
+    put_uint(set, TMPLT_ID_UNI, 2U);
+    put_uint(set + 2U, (uint64_t) (ptr - set), 2U);
+
+    hdr->version = htobe16(9U);
+    hdr->count = htobe16((uint16_t) (cnt + tmplts));
+    hdr->sys_uptime = htobe32((uint32_t) (now_ms - exp->boot_ms));
+    hdr->unix_sec = htobe32((uint32_t) (now_ms / 1000U));
+    hdr->seq_number = htobe32(exp->seq);
+    hdr->source_id = htobe32(exp->odid);
+
+    exp->seq++;
+    *recs = cnt;
+    return (uint16_t) (ptr - buffer);
+}
+
+/**
+ * \brief Generate an IPFIX Message
+ * \copydetails encoder_packet
+ */
+static uint16_t
+packet_ipfix(const struct encoder *enc, struct exporter *exp, struct rng *rng, uint64_t now_ms,
+    uint32_t max_recs, uint8_t *buffer, uint32_t *recs)
+{
+    const struct profile *profile = enc->profile;
+    struct fds_ipfix_msg_hdr *hdr = (struct fds_ipfix_msg_hdr *) buffer;
+    uint8_t *ptr = buffer + FDS_IPFIX_MSG_HDR_LEN;
+
+    if (tmplt_needed(enc, exp)) {
+        memcpy(ptr, enc->tset, enc->tset_size);
+        ptr += enc->tset_size;
+    }
+
+    // Decide the number of uniflow and biflow records that fit into the message
+    uint32_t cnt[2] = {0, 0};
+    size_t used = (size_t) (ptr - buffer);
+    while (cnt[0] + cnt[1] < max_recs) {
+        const int bi = (profile->biflow_share > 0.0 && rng_unit(rng) < profile->biflow_share);
+        const size_t cost = enc->rec_size[bi] + ((cnt[bi] == 0) ? SET_HDR_LEN : 0U);
+        if (used + cost > profile->mtu) {
+            break;
+        }
+        used += cost;
+        cnt[bi]++;
+    }
+
+    for (int bi = 0; bi < 2; ++bi) {
+        if (cnt[bi] == 0) {
+            continue;
+        }
+
+        uint8_t *set = ptr;
+        ptr += SET_HDR_LEN;
+        for (uint32_t i = 0; i < cnt[bi]; ++i) {
+            uint64_t start, end;
+            ptr = fields_write(enc, rng, ptr);
+            flow_times(enc, rng, now_ms, &start, &end);
+            put_uint(ptr, start, 8U);
+            put_uint(ptr + 8U, end, 8U);
+            ptr += 16U;
+            if (bi) {
+                ptr = fields_write_rev(enc, rng, ptr);
+            }
+        }
+        put_uint(set, bi ? TMPLT_ID_BI : TMPLT_ID_UNI, 2U);
+        put_uint(set + 2U, (uint64_t) (ptr - set), 2U);
+    }
+
+    const uint16_t size = (uint16_t) (ptr - buffer);
+    hdr->version = htobe16(FDS_IPFIX_VERSION);
+    hdr->length = htobe16(size);
+    hdr->export_time = htobe32((uint32_t) (now_ms / 1000U));
+    hdr->seq_num = htobe32(exp->seq);
+    hdr->odid = htobe32(exp->odid);
+
+    exp->seq += cnt[0] + cnt[1];
+    *recs = cnt[0] + cnt[1];
+    return size;
+}
+
+uint16_t
+encoder_packet(const struct encoder *enc, struct exporter *exp, struct rng *rng, uint64_t now_ms,
+    uint32_t max_recs, uint8_t *buffer, uint32_t *recs)
+{
+    uint16_t size;
+
+    switch (enc->profile->format) {
+    case PROFILE_FMT_NF5:
+        size = packet_nf5(enc, exp, rng, now_ms, max_recs, buffer, recs);
+        break;
+    case PROFILE_FMT_NF9:
+        size = packet_nf9(enc, exp, rng, now_ms, max_recs, buffer, recs);
+        break;
+    case PROFILE_FMT_IPFIX:
+    default:
+        size = packet_ipfix(enc, exp, rng, now_ms, max_recs, buffer, recs);
+        break;
+    }
+
+    exp->pkts++;
+    return size;
+}
@@ -0,0 +1,113 @@
+/**
+ * \file ipfixgen/encoder.h
+ * \author agent <agent@local>
+ * \brief Encoders of IPFIX and NetFlow packets (header file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef IPFIXGEN_ENCODER_H
+#define IPFIXGEN_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dist.h"
+#include "profile.h"
+
+/** State of a simulated exporter */
+struct exporter {
+    /** Socket connected to the collector (each exporter has its own source port)      */
+    int fd;
+    /** Observation Domain ID (NetFlow v9: Source ID, NetFlow v5: Engine ID)           */
+    uint32_t odid;
+    /** Sequence number (IPFIX/v5: number of sent flows, v9: number of sent packets)   */
+    uint32_t seq;
+    /** Number of generated packets                                                    */
+    uint64_t pkts;
+    /** Wall-clock time of the simulated boot of the exporter (ms, for NetFlow)        */
+    uint64_t boot_ms;
+};
+
+/** Packet encoder (read-only after initialization, i.e. shareable by threads) */
+struct encoder {
+    /** Traffic profile                                                                */
+    const struct profile *profile;
+    /** Size of a data record (0: uniflow, 1: biflow)                                  */
+    uint16_t rec_size[2];
+    /** Pre-built Template Set (IPFIX) or Template FlowSet (NetFlow v9)                */
+    uint8_t *tset;
+    /** Size of the Template Set                                                       */
+    uint16_t tset_size;
+    /** Number of Template Records in the Template Set                                 */
+    uint16_t tset_recs;
+};
+
+/**
+ * \brief Initialize an encoder
+ * \param[out] enc     Encoder
+ * \param[in]  profile Traffic profile (must exist until the encoder is cleared)
+ * \return 0 on success, otherwise non-zero (an error message is printed)
+ */
+int
+encoder_init(struct encoder *enc, const struct profile *profile);
+
+/**
+ * \brief Free resources of an encoder
+ * \param[in] enc Encoder
+ */
+void
+encoder_clear(struct encoder *enc);
+
+/**
+ * \brief Generate a new packet of an exporter
+ *
+ * The packet is filled with as many records as fit into the MTU of the profile. Templates are
+ * prepended based on the refresh interval of the profile. The state of the exporter (sequence
+ * number, etc.) is updated.
+ * \param[in]  enc      Encoder
+ * \param[in]  exp      Exporter
+ * \param[in]  rng      Random generator
+ * \param[in]  now_ms   Current wall-clock time (ms)
+ * \param[in]  max_recs Maximum number of records in the packet (must be > 0)
+ * \param[out] buffer   Output buffer (at least MTU bytes)
+ * \param[out] recs     Number of generated records
+ * \return Size of the packet
+ */
+uint16_t
+encoder_packet(const struct encoder *enc, struct exporter *exp, struct rng *rng, uint64_t now_ms,
+    uint32_t max_recs, uint8_t *buffer, uint32_t *recs);
+
+#endif // IPFIXGEN_ENCODER_H
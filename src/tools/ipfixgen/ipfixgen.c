@@ -0,0 +1,537 @@
+/**
+ * \file ipfixgen/ipfixgen.c
+ * \author agent <agent@local>
+ * \brief Generator of synthetic IPFIX and NetFlow traffic
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#define _GNU_SOURCE // sendmmsg()
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "dist.h"
+#include "profile.h"
+#include "encoder.h"
+
+/** Default destination IP                         */
+#define DEFAULT_IP "127.0.0.1"
+/** Default destination port                       */
+#define DEFAULT_PORT "4739"
+/** Default number of packets per sendmmsg() call  */
+#define DEFAULT_BATCH 64
+/** Maximum number of packets per sendmmsg() call  */
+#define MAX_BATCH 1024
+/** Requested size of socket send buffers          */
+#define SOCKET_SNDBUF (4 * 1024 * 1024)
+/** Interval of checks in the main thread (ns)     */
+#define MAIN_CHECK_TIME 100000000LL
+
+/** Global stop signal                             */
+static volatile sig_atomic_t stop = 0;
+
+/** Context of a generator thread */
+struct gen_thread {
+    /** Thread identification                         */
+    pthread_t thread;
+    /** Shared encoder                                */
+    const struct encoder *enc;
+    /** Exporters owned by the thread                 */
+    struct exporter *exps;
+    /** Number of exporters                           */
+    size_t exps_cnt;
+    /** Maximum number of records (0 == unlimited)    */
+    uint64_t rec_limit;
+    /** Maximum records per second (0 == unlimited)   */
+    double rate;
+    /** Number of packets per sendmmsg() call         */
+    unsigned int batch;
+    /** Seed of the random generator                  */
+    uint64_t seed;
+
+    /** Sent records                                  */
+    uint64_t stat_recs;
+    /** Sent packets                                  */
+    uint64_t stat_pkts;
+    /** Sent bytes                                    */
+    uint64_t stat_bytes;
+    /** Dropped packets (send failures)               */
+    uint64_t stat_drops;
+    /** The thread has finished                       */
+    bool done;
+};
+
+/** \brief Print usage                     */
+static void usage()
+{
+    printf("\n");
+    printf("Usage: ipfixgen [options]\n");
+    printf("  -h         Show this help\n");
+    printf("  -f path    Traffic profile (XML)\n");
+    printf("  -d ip      Destination IP address (default: %s)\n", DEFAULT_IP);
+    printf("  -p port    Destination port number (default: %s)\n", DEFAULT_PORT);
+    printf("  -t num     Number of generator threads (default: 1)\n");
+    printf("  -n num     Stop after sending 'num' records (default: unlimited)\n");
+    printf("  -T sec     Stop after 'sec' seconds (default: unlimited)\n");
+    printf("  -r num     Speed limit in records/s (default: unlimited)\n");
+    printf("  -b num     Packets per sendmmsg() call (default: %d, max: %d)\n", DEFAULT_BATCH,
+        MAX_BATCH);
+    printf("  -s seed    Seed of random generators (default: based on time)\n");
+    printf("\n");
+}
+
+/**
+ * \brief Termination signal handler
+ * \param[in] signal Signal to process
+ */
+static void handler(int signal)
+{
+    (void) signal; // skip compiler warning
+    stop = 1;
+}
+
+/**
+ * \brief Get current time in milliseconds
+ * \param[in] clk_id Clock
+ */
+static uint64_t
+time_ms(clockid_t clk_id)
+{
+    struct timespec ts;
+    clock_gettime(clk_id, &ts);
+    return (uint64_t) ts.tv_sec * 1000U + (uint64_t) ts.tv_nsec / 1000000U;
+}
+
+/**
+ * \brief Send a batch of packets of an exporter
+ *
+ * Packets that cannot be delivered (e.g. the collector is not running) are dropped.
+ * \param[in] ctx  Thread context
+ * \param[in] exp  Exporter
+ * \param[in] msgs Packets
+ * \param[in] recs Number of records in each packet
+ * \param[in] cnt  Number of packets
+ */
+static void
+batch_send(struct gen_thread *ctx, const struct exporter *exp, struct mmsghdr *msgs,
+    const uint32_t *recs, unsigned int cnt)
+{
+    unsigned int pos = 0;
+    while (pos < cnt && !stop) {
+        int ret = sendmmsg(exp->fd, &msgs[pos], cnt - pos, 0);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == ENOBUFS) {
+                continue;
+            }
+
+            // For example, ECONNREFUSED reported after an ICMP message
+            ctx->stat_drops++;
+            pos++;
+            continue;
+        }
+
+        for (int i = 0; i < ret; ++i, ++pos) {
+            ctx->stat_recs += recs[pos];
+            ctx->stat_bytes += msgs[pos].msg_hdr.msg_iov->iov_len;
+        }
+        ctx->stat_pkts += (uint64_t) ret;
+    }
+}
+
+/**
+ * \brief Main function of a generator thread
+ * \param[in] arg Thread context
+ */
+static void *
+gen_thread_main(void *arg)
+{
+    struct gen_thread *ctx = arg;
+    const uint16_t mtu = ctx->enc->profile->mtu;
+    struct rng rng;
+    rng_init(&rng, ctx->seed);
+
+    uint8_t *buffer = malloc((size_t) ctx->batch * mtu);
+    struct mmsghdr *msgs = calloc(ctx->batch, sizeof(*msgs));
+    struct iovec *iovs = calloc(ctx->batch, sizeof(*iovs));
+    uint32_t *recs = calloc(ctx->batch, sizeof(*recs));
+    if (!buffer || !msgs || !iovs || !recs) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto end;
+    }
+
+    for (unsigned int i = 0; i < ctx->batch; ++i) {
+        iovs[i].iov_base = buffer + (size_t) i * mtu;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const uint64_t begin_ms = time_ms(CLOCK_MONOTONIC);
+    uint64_t generated = 0;
+    size_t exp_idx = 0;
+
+    while (!stop && (ctx->rec_limit == 0 || generated < ctx->rec_limit)) {
+        struct exporter *exp = &ctx->exps[exp_idx];
+        exp_idx = (exp_idx + 1 == ctx->exps_cnt) ? 0 : exp_idx + 1;
+
+        // Fill the batch
+        const uint64_t now_ms = time_ms(CLOCK_REALTIME);
+        unsigned int cnt;
+        for (cnt = 0; cnt < ctx->batch; ++cnt) {
+            uint32_t max_recs = UINT32_MAX;
+            if (ctx->rec_limit != 0) {
+                const uint64_t rem = ctx->rec_limit - generated;
+                if (rem == 0) {
+                    break;
+                }
+                max_recs = (rem < UINT32_MAX) ? (uint32_t) rem : UINT32_MAX;
+            }
+
+            uint8_t *pkt = iovs[cnt].iov_base;
+            iovs[cnt].iov_len = encoder_packet(ctx->enc, exp, &rng, now_ms, max_recs, pkt,
+                &recs[cnt]);
+            generated += recs[cnt];
+        }
+
+        batch_send(ctx, exp, msgs, recs, cnt);
+
+        if (ctx->rate <= 0.0) {
+            continue;
+        }
+
+        // Speed limitation
+        const uint64_t expected_ms = (uint64_t) (generated * 1000.0 / ctx->rate);
+        const uint64_t elapsed_ms = time_ms(CLOCK_MONOTONIC) - begin_ms;
+        if (expected_ms > elapsed_ms) {
+            const uint64_t diff = expected_ms - elapsed_ms;
+            struct timespec sleep_time = {(time_t) (diff / 1000U), (long) (diff % 1000U) * 1000000L};
+            nanosleep(&sleep_time, NULL);
+        }
+    }
+
+end:
+    free(recs);
+    free(iovs);
+    free(msgs);
+    free(buffer);
+    __atomic_store_n(&ctx->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * \brief Create sockets of all exporters
+ *
+ * Each exporter has its own socket, therefore, the collector sees it as a separate Transport
+ * Session (different source port).
+ * \param[in] exps    Exporters
+ * \param[in] cnt     Number of exporters
+ * \param[in] ip      Destination address
+ * \param[in] port    Destination port
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+exporters_connect(struct exporter *exps, size_t cnt, const char *ip, const char *port)
+{
+    struct addrinfo hints, *addr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    int ret = getaddrinfo(ip, port, &hints, &addr);
+    if (ret != 0) {
+        fprintf(stderr, "Failed to resolve the destination: %s\n", gai_strerror(ret));
+        return 1;
+    }
+
+    size_t i;
+    for (i = 0; i < cnt; ++i) {
+        exps[i].fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (exps[i].fd < 0) {
+            break;
+        }
+
+        int sndbuf = SOCKET_SNDBUF;
+        setsockopt(exps[i].fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        if (connect(exps[i].fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+            close(exps[i].fd);
+            break;
+        }
+    }
+
+    freeaddrinfo(addr);
+    if (i == cnt) {
+        return 0;
+    }
+
+    fprintf(stderr, "Failed to create a socket: %s\n", strerror(errno));
+    while (i-- > 0) {
+        close(exps[i].fd);
+    }
+    return 1;
+}
+
+/**
+ * \brief Print throughput statistics
+ * \param[in] threads Generator threads
+ * \param[in] cnt     Number of threads
+ * \param[in] elapsed Elapsed time (seconds)
+ */
+static void
+print_stats(const struct gen_thread *threads, size_t cnt, double elapsed)
+{
+    uint64_t recs = 0, pkts = 0, bytes = 0, drops = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+        recs += threads[i].stat_recs;
+        pkts += threads[i].stat_pkts;
+        bytes += threads[i].stat_bytes;
+        drops += threads[i].stat_drops;
+    }
+
+    printf("Sent records: %" PRIu64 "\n", recs);
+    printf("Sent packets: %" PRIu64 "\n", pkts);
+    printf("Sent bytes:   %" PRIu64 "\n", bytes);
+    printf("Dropped:      %" PRIu64 " packets\n", drops);
+    printf("Elapsed time: %.3f s\n", elapsed);
+    if (elapsed > 0.0) {
+        printf("Throughput:   %.0f records/s, %.0f packets/s, %.2f Mbit/s\n",
+            recs / elapsed, pkts / elapsed, (bytes * 8.0) / (elapsed * 1e6));
+    }
+}
+
+/**
+ * \brief Main function
+ * \param[in] argc Number of arguments
+ * \param[in] argv Array of arguments
+ */
+int main(int argc, char** argv)
+{
+    const char *ip = DEFAULT_IP;
+    const char *port = DEFAULT_PORT;
+    const char *path = NULL;
+    long threads_cnt = 1;
+    long long rec_limit = 0;
+    long duration = 0;
+    double rate = 0.0;
+    long batch = DEFAULT_BATCH;
+    uint64_t seed = (uint64_t) time(NULL);
+
+    if (argc == 1) {
+        usage();
+        return 0;
+    }
+
+    // Parse parameters
+    int c;
+    while ((c = getopt(argc, argv, "hf:d:p:t:n:T:r:b:s:")) != -1) {
+        switch (c) {
+        case 'h':
+            usage();
+            return 0;
+        case 'f':
+            path = optarg;
+            break;
+        case 'd':
+            ip = optarg;
+            break;
+        case 'p':
+            port = optarg;
+            break;
+        case 't':
+            threads_cnt = atol(optarg);
+            break;
+        case 'n':
+            rec_limit = atoll(optarg);
+            break;
+        case 'T':
+            duration = atol(optarg);
+            break;
+        case 'r':
+            rate = atof(optarg);
+            break;
+        case 'b':
+            batch = atol(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "Unknown option.\n");
+            return 1;
+        }
+    }
+
+    // Parameters check
+    if (!path) {
+        fprintf(stderr, "Profile file must be set!\n");
+        return 1;
+    }
+    if (threads_cnt <= 0 || rec_limit < 0 || duration < 0 || rate < 0.0) {
+        fprintf(stderr, "Invalid value of a parameter.\n");
+        return 1;
+    }
+    if (batch <= 0 || batch > MAX_BATCH) {
+        fprintf(stderr, "Invalid batch size. Must be in range (1 .. %d)\n", MAX_BATCH);
+        return 1;
+    }
+
+    struct profile *profile = profile_load(path);
+    if (!profile) {
+        return 1;
+    }
+
+    struct encoder enc;
+    if (encoder_init(&enc, profile) != 0) {
+        profile_destroy(profile);
+        return 1;
+    }
+
+    if ((uint32_t) threads_cnt > profile->exporters) {
+        fprintf(stderr, "Number of threads reduced to the number of exporters (%" PRIu32 ")\n",
+            profile->exporters);
+        threads_cnt = profile->exporters;
+    }
+
+    // Prepare exporters
+    struct exporter *exps = calloc(profile->exporters, sizeof(*exps));
+    struct gen_thread *threads = calloc((size_t) threads_cnt, sizeof(*threads));
+    if (!exps || !threads) {
+        fprintf(stderr, "Memory allocation error\n");
+        free(threads);
+        free(exps);
+        encoder_clear(&enc);
+        profile_destroy(profile);
+        return 1;
+    }
+
+    const uint64_t boot_ms = time_ms(CLOCK_REALTIME) - profile->flow_age - 60000U;
+    for (uint32_t i = 0; i < profile->exporters; ++i) {
+        exps[i].odid = profile->odid_base + i;
+        exps[i].boot_ms = boot_ms;
+    }
+
+    if (exporters_connect(exps, profile->exporters, ip, port) != 0) {
+        free(threads);
+        free(exps);
+        encoder_clear(&enc);
+        profile_destroy(profile);
+        return 1;
+    }
+
+    signal(SIGINT, handler);
+    signal(SIGTERM, handler);
+
+    // Start threads (exporters and limits are split evenly)
+    struct timespec ts_begin, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_begin);
+
+    size_t exp_offset = 0;
+    long started;
+    for (started = 0; started < threads_cnt; ++started) {
+        struct gen_thread *thread = &threads[started];
+        thread->enc = &enc;
+        thread->exps = &exps[exp_offset];
+        thread->exps_cnt = profile->exporters / threads_cnt
+            + ((uint32_t) started < profile->exporters % threads_cnt ? 1 : 0);
+        thread->rec_limit = rec_limit / threads_cnt
+            + (started < rec_limit % threads_cnt ? 1 : 0);
+        thread->rate = rate / threads_cnt;
+        thread->batch = (unsigned int) batch;
+        thread->seed = seed + (uint64_t) started;
+        exp_offset += thread->exps_cnt;
+
+        if (rec_limit != 0 && thread->rec_limit == 0) {
+            // Nothing to do
+            thread->done = true;
+            continue;
+        }
+
+        int ret = pthread_create(&thread->thread, NULL, gen_thread_main, thread);
+        if (ret != 0) {
+            fprintf(stderr, "Failed to start a thread: %s\n", strerror(ret));
+            stop = 1;
+            break;
+        }
+    }
+
+    // Wait until all threads are finished, the time limit expires or a signal is received
+    while (!stop) {
+        bool all_done = true;
+        for (long i = 0; i < started; ++i) {
+            all_done &= __atomic_load_n(&threads[i].done, __ATOMIC_ACQUIRE);
+        }
+        if (all_done) {
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        if (duration > 0 && ts_end.tv_sec - ts_begin.tv_sec >= duration) {
+            break;
+        }
+
+        struct timespec sleep_time = {0, MAIN_CHECK_TIME};
+        nanosleep(&sleep_time, NULL);
+    }
+
+    stop = 1;
+    for (long i = 0; i < started; ++i) {
+        if (threads[i].exps_cnt == 0 || (rec_limit != 0 && threads[i].rec_limit == 0)) {
+            continue;
+        }
+        pthread_join(threads[i].thread, NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    double elapsed = (ts_end.tv_sec - ts_begin.tv_sec) + (ts_end.tv_nsec - ts_begin.tv_nsec) / 1e9;
+    print_stats(threads, (size_t) started, elapsed);
+
+    for (uint32_t i = 0; i < profile->exporters; ++i) {
+        close(exps[i].fd);
+    }
+    free(threads);
+    free(exps);
+    encoder_clear(&enc);
+    profile_destroy(profile);
+    return 0;
+}
@@ -0,0 +1,603 @@
+/**
+ * \file ipfixgen/profile.c
+ * \author agent <agent@local>
+ * \brief Declarative traffic profile (source file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <endian.h>
+#include <arpa/inet.h>
+#include <libfds.h>
+
+#include "profile.h"
+
+/** Default number of exporters                       */
+#define DEF_EXPORTERS     1
+/** Default ODID of the first exporter                */
+#define DEF_ODID_BASE     1
+/** Default maximum size of packets                   */
+#define DEF_MTU           1400
+/** Minimum size of packets                           */
+#define MIN_MTU           512
+/** Default template refresh interval (packets)       */
+#define DEF_TMPLT_REFRESH 4096
+/** Default maximum age of flows (ms)                 */
+#define DEF_FLOW_AGE      30000
+/** Default exponent of the Zipf distribution         */
+#define DEF_ZIPF_EXPONENT 1.0
+
+/** Catalog of known fields (must match ::field_id)   */
+static const struct field_def field_catalog[FIELD_CNT] = {
+    [FIELD_SRC_ADDR4] = {"srcAddr4",  FIELD_T_IPV4,  8,  4, 0},
+    [FIELD_DST_ADDR4] = {"dstAddr4",  FIELD_T_IPV4, 12,  4, 0},
+    [FIELD_SRC_ADDR6] = {"srcAddr6",  FIELD_T_IPV6, 27, 16, 0},
+    [FIELD_DST_ADDR6] = {"dstAddr6",  FIELD_T_IPV6, 28, 16, 0},
+    [FIELD_SRC_PORT]  = {"srcPort",   FIELD_T_UINT,  7,  2, 0},
+    [FIELD_DST_PORT]  = {"dstPort",   FIELD_T_UINT, 11,  2, 0},
+    [FIELD_PROTOCOL]  = {"protocol",  FIELD_T_UINT,  4,  1, 0},
+    [FIELD_TCP_FLAGS] = {"tcpFlags",  FIELD_T_UINT,  6,  1, 0},
+    [FIELD_TOS]       = {"tos",       FIELD_T_UINT,  5,  1, 0},
+    [FIELD_BYTES]     = {"bytes",     FIELD_T_UINT,  1,  8, 1},
+    [FIELD_PACKETS]   = {"packets",   FIELD_T_UINT,  2,  8, 2},
+    [FIELD_IN_IF]     = {"inIf",      FIELD_T_UINT, 10,  4, 0},
+    [FIELD_OUT_IF]    = {"outIf",     FIELD_T_UINT, 14,  4, 0},
+    [FIELD_SRC_AS]    = {"srcAS",     FIELD_T_UINT, 16,  4, 0},
+    [FIELD_DST_AS]    = {"dstAS",     FIELD_T_UINT, 17,  4, 0},
+};
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_FORMAT = 1,
+    NODE_EXPORTERS,
+    NODE_ODID_BASE,
+    NODE_MTU,
+    NODE_TMPLT_REFRESH,
+    NODE_BIFLOW_SHARE,
+    NODE_FLOW_AGE,
+    NODE_FIELDS,
+    FIELDS_FIELD,
+    FIELD_NAME,
+    FIELD_DIST,
+    FIELD_VALUE,
+    FIELD_EXPONENT
+};
+
+/** Definition of the \<field\> node  */
+static const struct fds_xml_args args_field[] = {
+    FDS_OPTS_ELEM(FIELD_NAME,     "name",         FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(FIELD_DIST,     "distribution", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(FIELD_VALUE,    "value",        FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(FIELD_EXPONENT, "exponent",     FDS_OPTS_T_DOUBLE, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<fields\> node  */
+static const struct fds_xml_args args_fields[] = {
+    FDS_OPTS_NESTED(FIELDS_FIELD, "field", args_field, FDS_OPTS_P_MULTI),
+    FDS_OPTS_END
+};
+
+/** Definition of the \<profile\> node  */
+static const struct fds_xml_args args_profile[] = {
+    FDS_OPTS_ROOT("profile"),
+    FDS_OPTS_ELEM(NODE_FORMAT,        "format",          FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_EXPORTERS,     "exporters",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ODID_BASE,     "odidBase",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_MTU,           "mtu",             FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TMPLT_REFRESH, "templateRefresh", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BIFLOW_SHARE,  "biflowShare",     FDS_OPTS_T_DOUBLE, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_FLOW_AGE,      "flowAge",         FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_NESTED(NODE_FIELDS,      "fields",          args_fields,       0),
+    FDS_OPTS_END
+};
+
+const struct field_def *
+field_def_get(enum field_id id)
+{
+    return &field_catalog[id];
+}
+
+/**
+ * \brief Parse a single value of a field
+ * \param[in]  field Field (IPv6: the prefix is set by the first parsed value)
+ * \param[in]  str   String to parse
+ * \param[in]  first The value is the first value of the field
+ * \param[out] res   Parsed value
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+value_parse(struct profile_field *field, const char *str, bool first, uint64_t *res)
+{
+    const struct field_def *def = field_def_get(field->id);
+    uint8_t addr[16];
+    uint32_t addr4;
+    uint64_t addr6_low;
+    char *end;
+
+    switch (def->type) {
+    case FIELD_T_UINT: {
+        errno = 0;
+        unsigned long long value = strtoull(str, &end, 10);
+        if (errno != 0 || end == str || *end != '\0' || str[0] == '-') {
+            return 1;
+        }
+        if (def->size < 8 && value >= (1ULL << (8U * def->size))) {
+            return 1;
+        }
+        *res = value;
+        return 0;
+        }
+    case FIELD_T_IPV4:
+        if (inet_pton(AF_INET, str, addr) != 1) {
+            return 1;
+        }
+        memcpy(&addr4, addr, sizeof(addr4));
+        *res = ntohl(addr4);
+        return 0;
+    case FIELD_T_IPV6:
+        if (inet_pton(AF_INET6, str, addr) != 1) {
+            return 1;
+        }
+        if (first) {
+            memcpy(field->ip6_prefix, addr, 8U);
+        } else if (memcmp(field->ip6_prefix, addr, 8U) != 0) {
+            // Only the lower 64 bits can be random
+            return 1;
+        }
+        memcpy(&addr6_low, &addr[8], sizeof(addr6_low));
+        *res = be64toh(addr6_low);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Parse an interval (in format "value" or "min-max") with an optional weight ("@weight")
+ * \param[in]  field  Field
+ * \param[in]  str    String to parse (it is modified!)
+ * \param[in]  first  The interval is the first interval of the field
+ * \param[out] item   Parsed interval
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+item_parse(struct profile_field *field, char *str, bool first, struct dist_item *item)
+{
+    char *weight = strchr(str, '@');
+    item->weight = 1.0;
+    if (weight != NULL) {
+        char *end;
+        *(weight++) = '\0';
+        item->weight = strtod(weight, &end);
+        if (end == weight || *end != '\0' || !(item->weight > 0.0)) {
+            return 1;
+        }
+    }
+
+    char *max = strchr(str, '-');
+    if (max != NULL) {
+        *(max++) = '\0';
+    }
+
+    if (value_parse(field, str, first, &item->min) != 0) {
+        return 1;
+    }
+    if (max == NULL) {
+        item->max = item->min;
+        return 0;
+    }
+    if (value_parse(field, max, false, &item->max) != 0 || item->max < item->min) {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * \brief Initialize the distribution of a field
+ * \param[in] field    Field
+ * \param[in] dist     Name of the distribution
+ * \param[in] value    Description of values
+ * \param[in] exponent Exponent of the Zipf distribution
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+field_dist_init(struct profile_field *field, const char *dist, const char *value, double exponent)
+{
+    enum dist_type type;
+    if (strcasecmp(dist, "const") == 0) {
+        type = DIST_CONST;
+    } else if (strcasecmp(dist, "uniform") == 0) {
+        type = DIST_UNIFORM;
+    } else if (strcasecmp(dist, "zipf") == 0) {
+        type = DIST_ZIPF;
+    } else if (strcasecmp(dist, "mix") == 0) {
+        type = DIST_MIX;
+    } else {
+        fprintf(stderr, "Unknown distribution '%s'\n", dist);
+        return 1;
+    }
+
+    char *copy = strdup(value);
+    size_t items_max = 1;
+    for (const char *pos = value; *pos != '\0'; ++pos) {
+        items_max += (*pos == ',') ? 1 : 0;
+    }
+    struct dist_item *items = calloc(items_max, sizeof(*items));
+    if (!copy || !items) {
+        fprintf(stderr, "Memory allocation error\n");
+        free(copy);
+        free(items);
+        return 1;
+    }
+
+    size_t items_cnt = 0;
+    char *save_ptr = NULL;
+    for (char *tok = strtok_r(copy, ", \t\n", &save_ptr); tok != NULL;
+            tok = strtok_r(NULL, ", \t\n", &save_ptr)) {
+        if (item_parse(field, tok, items_cnt == 0, &items[items_cnt]) != 0) {
+            fprintf(stderr, "Invalid value '%s' of the field '%s'\n", tok,
+                field_def_get(field->id)->name);
+            free(copy);
+            free(items);
+            return 1;
+        }
+        items_cnt++;
+    }
+
+    int rc = 1;
+    if (items_cnt == 0) {
+        fprintf(stderr, "Missing value of the field '%s'\n", field_def_get(field->id)->name);
+    } else if (type != DIST_MIX && items_cnt != 1) {
+        fprintf(stderr, "Only a mix distribution accepts multiple values (field '%s')\n",
+            field_def_get(field->id)->name);
+    } else if (type == DIST_CONST && items[0].min != items[0].max) {
+        fprintf(stderr, "A const distribution accepts only a single value (field '%s')\n",
+            field_def_get(field->id)->name);
+    } else if (dist_init(&field->dist, type, items, items_cnt, exponent) != 0) {
+        fprintf(stderr, "Failed to initialize the distribution of the field '%s' (note: a zipf "
+            "distribution supports at most %u values and a positive exponent)\n",
+            field_def_get(field->id)->name, DIST_ZIPF_MAX);
+    } else {
+        rc = 0;
+    }
+
+    free(copy);
+    free(items);
+    return rc;
+}
+
+/**
+ * \brief Parse a \<field\> node and add the field to the profile
+ * \param[in] profile Profile
+ * \param[in] ctx     XML context of the node
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+profile_parse_field(struct profile *profile, fds_xml_ctx_t *ctx)
+{
+    const char *name = NULL;
+    const char *dist = "const";
+    const char *value = NULL;
+    double exponent = DEF_ZIPF_EXPONENT;
+
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case FIELD_NAME:
+            name = content->ptr_string;
+            break;
+        case FIELD_DIST:
+            dist = content->ptr_string;
+            break;
+        case FIELD_VALUE:
+            value = content->ptr_string;
+            break;
+        case FIELD_EXPONENT:
+            exponent = content->val_double;
+            break;
+        default:
+            // Unexpected node
+            return 1;
+        }
+    }
+
+    size_t id;
+    for (id = 0; id < FIELD_CNT; ++id) {
+        if (strcasecmp(name, field_catalog[id].name) == 0) {
+            break;
+        }
+    }
+    if (id == FIELD_CNT) {
+        fprintf(stderr, "Unknown field '%s'\n", name);
+        return 1;
+    }
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        if (profile->fields[i].id == id) {
+            fprintf(stderr, "Field '%s' is defined multiple times\n", name);
+            return 1;
+        }
+    }
+
+    struct profile_field *field = &profile->fields[profile->fields_cnt];
+    memset(field, 0, sizeof(*field));
+    field->id = (enum field_id) id;
+    if (field_dist_init(field, dist, value, exponent) != 0) {
+        return 1;
+    }
+
+    profile->fields_cnt++;
+    return 0;
+}
+
+/**
+ * \brief Parse the \<fields\> node
+ * \param[in] profile Profile
+ * \param[in] ctx     XML context of the node
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+profile_parse_fields(struct profile *profile, fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        if (content->id != FIELDS_FIELD) {
+            return 1;
+        }
+        if (profile->fields_cnt == FIELD_CNT) {
+            fprintf(stderr, "Too many fields\n");
+            return 1;
+        }
+        if (profile_parse_field(profile, content->ptr_ctx) != 0) {
+            return 1;
+        }
+    }
+
+    if (profile->fields_cnt == 0) {
+        fprintf(stderr, "At least one field must be defined\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * \brief Parse the \<profile\> node
+ * \param[in] profile Profile
+ * \param[in] ctx     XML context of the node
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+profile_parse_root(struct profile *profile, fds_xml_ctx_t *ctx)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(ctx, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_FORMAT:
+            if (strcasecmp(content->ptr_string, "ipfix") == 0) {
+                profile->format = PROFILE_FMT_IPFIX;
+            } else if (strcasecmp(content->ptr_string, "netflow5") == 0) {
+                profile->format = PROFILE_FMT_NF5;
+            } else if (strcasecmp(content->ptr_string, "netflow9") == 0) {
+                profile->format = PROFILE_FMT_NF9;
+            } else {
+                fprintf(stderr, "Unknown format '%s'\n", content->ptr_string);
+                return 1;
+            }
+            break;
+        case NODE_EXPORTERS:
+            if (content->val_uint == 0 || content->val_uint > UINT16_MAX) {
+                fprintf(stderr, "Number of exporters must be in range 1..%u\n", UINT16_MAX);
+                return 1;
+            }
+            profile->exporters = (uint32_t) content->val_uint;
+            break;
+        case NODE_ODID_BASE:
+            if (content->val_uint > UINT32_MAX) {
+                fprintf(stderr, "Invalid ODID base\n");
+                return 1;
+            }
+            profile->odid_base = (uint32_t) content->val_uint;
+            break;
+        case NODE_MTU:
+            if (content->val_uint < MIN_MTU || content->val_uint > UINT16_MAX) {
+                fprintf(stderr, "MTU must be in range %u..%u\n", MIN_MTU, UINT16_MAX);
+                return 1;
+            }
+            profile->mtu = (uint16_t) content->val_uint;
+            break;
+        case NODE_TMPLT_REFRESH:
+            if (content->val_uint > UINT32_MAX) {
+                fprintf(stderr, "Invalid template refresh interval\n");
+                return 1;
+            }
+            profile->tmplt_refresh = (uint32_t) content->val_uint;
+            break;
+        case NODE_BIFLOW_SHARE:
+            if (!(content->val_double >= 0.0 && content->val_double <= 1.0)) {
+                fprintf(stderr, "Biflow share must be in range 0.0..1.0\n");
+                return 1;
+            }
+            profile->biflow_share = content->val_double;
+            break;
+        case NODE_FLOW_AGE:
+            if (content->val_uint == 0 || content->val_uint > UINT32_MAX) {
+                fprintf(stderr, "Invalid maximum age of flows\n");
+                return 1;
+            }
+            profile->flow_age = (uint32_t) content->val_uint;
+            break;
+        case NODE_FIELDS:
+            if (profile_parse_fields(profile, content->ptr_ctx) != 0) {
+                return 1;
+            }
+            break;
+        default:
+            // Unexpected node
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Check that the profile can be exported using the selected protocol
+ * \param[in] profile Profile
+ * \return 0 on success, otherwise non-zero
+ */
+static int
+profile_check(const struct profile *profile)
+{
+    bool has_counter = false;
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        const struct field_def *def = field_def_get(profile->fields[i].id);
+        if (def->rev_id != 0) {
+            has_counter = true;
+        }
+        if (profile->format == PROFILE_FMT_NF5 && def->type == FIELD_T_IPV6) {
+            fprintf(stderr, "NetFlow v5 doesn't support the field '%s'\n", def->name);
+            return 1;
+        }
+    }
+
+    if (profile->biflow_share > 0.0) {
+        if (profile->format != PROFILE_FMT_IPFIX) {
+            fprintf(stderr, "Biflow records are supported only by IPFIX\n");
+            return 1;
+        }
+        if (!has_counter) {
+            fprintf(stderr, "Biflow records require 'bytes' and/or 'packets' fields\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Load content of a file into memory
+ * \param[in] path Path to the file
+ * \return Pointer to a null-terminated string or NULL
+ */
+static char *
+file_load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open '%s': %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    char *buffer = NULL;
+    long size;
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET)) {
+        fprintf(stderr, "Failed to get the size of '%s'\n", path);
+    } else if ((buffer = malloc((size_t) size + 1)) == NULL) {
+        fprintf(stderr, "Memory allocation error\n");
+    } else if (fread(buffer, 1, (size_t) size, file) != (size_t) size) {
+        fprintf(stderr, "Failed to read '%s'\n", path);
+        free(buffer);
+        buffer = NULL;
+    } else {
+        buffer[size] = '\0';
+    }
+
+    fclose(file);
+    return buffer;
+}
+
+struct profile *
+profile_load(const char *path)
+{
+    char *content = file_load(path);
+    if (!content) {
+        return NULL;
+    }
+
+    struct profile *profile = calloc(1, sizeof(*profile));
+    struct profile_field *fields = calloc(FIELD_CNT, sizeof(*fields));
+    fds_xml_t *parser = fds_xml_create();
+    if (!profile || !fields || !parser) {
+        fprintf(stderr, "Memory allocation error\n");
+        fds_xml_destroy(parser);
+        free(fields);
+        free(profile);
+        free(content);
+        return NULL;
+    }
+
+    profile->exporters = DEF_EXPORTERS;
+    profile->odid_base = DEF_ODID_BASE;
+    profile->mtu = DEF_MTU;
+    profile->tmplt_refresh = DEF_TMPLT_REFRESH;
+    profile->biflow_share = 0.0;
+    profile->flow_age = DEF_FLOW_AGE;
+    profile->fields = fields;
+
+    int rc = 1;
+    fds_xml_ctx_t *root;
+    if (fds_xml_set_args(parser, args_profile) != FDS_OK) {
+        fprintf(stderr, "Failed to parse the description of an XML document!\n");
+    } else if ((root = fds_xml_parse_mem(parser, content, true)) == NULL) {
+        fprintf(stderr, "Failed to parse the profile: %s\n", fds_xml_last_err(parser));
+    } else if (profile_parse_root(profile, root) == 0 && profile_check(profile) == 0) {
+        rc = 0;
+    }
+
+    fds_xml_destroy(parser);
+    free(content);
+    if (rc != 0) {
+        profile_destroy(profile);
+        return NULL;
+    }
+
+    return profile;
+}
+
+void
+profile_destroy(struct profile *profile)
+{
+    for (size_t i = 0; i < profile->fields_cnt; ++i) {
+        dist_clear(&profile->fields[i].dist);
+    }
+
+    free(profile->fields);
+    free(profile);
+}
@@ -0,0 +1,150 @@
+/**
+ * \file ipfixgen/profile.h
+ * \author agent <agent@local>
+ * \brief Declarative traffic profile (header file)
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef IPFIXGEN_PROFILE_H
+#define IPFIXGEN_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dist.h"
+
+/** Export protocol */
+enum profile_format {
+    PROFILE_FMT_IPFIX,  ///< IPFIX (RFC 7011)
+    PROFILE_FMT_NF5,    ///< NetFlow v5
+    PROFILE_FMT_NF9     ///< NetFlow v9 (RFC 3954)
+};
+
+/** Data type of a field */
+enum field_type {
+    FIELD_T_UINT,   ///< Unsigned integer
+    FIELD_T_IPV4,   ///< IPv4 address
+    FIELD_T_IPV6    ///< IPv6 address
+};
+
+/** Identification of a field (see the catalog in profile.c) */
+enum field_id {
+    FIELD_SRC_ADDR4,
+    FIELD_DST_ADDR4,
+    FIELD_SRC_ADDR6,
+    FIELD_DST_ADDR6,
+    FIELD_SRC_PORT,
+    FIELD_DST_PORT,
+    FIELD_PROTOCOL,
+    FIELD_TCP_FLAGS,
+    FIELD_TOS,
+    FIELD_BYTES,
+    FIELD_PACKETS,
+    FIELD_IN_IF,
+    FIELD_OUT_IF,
+    FIELD_SRC_AS,
+    FIELD_DST_AS,
+    FIELD_CNT       ///< Number of known fields
+};
+
+/** Description of a known field */
+struct field_def {
+    const char *name;      ///< Name of the field in the profile
+    enum field_type type;  ///< Data type
+    uint16_t ie_id;        ///< IPFIX/NetFlow v9 Information Element ID
+    uint16_t size;         ///< Size of the field in IPFIX/NetFlow v9 records
+    uint16_t rev_id;       ///< Reverse IE ID (PEN 29305) of counters (0 == not a counter)
+};
+
+/**
+ * \brief Get a definition of a known field
+ * \param[in] id Field identification
+ */
+const struct field_def *
+field_def_get(enum field_id id);
+
+/** Field of generated records */
+struct profile_field {
+    /** Field identification                                                 */
+    enum field_id id;
+    /** Distribution of values (IPv6: only the lower 64 bits)                */
+    struct dist dist;
+    /** Upper 64 bits of IPv6 addresses (in network byte order)               */
+    uint8_t ip6_prefix[8];
+};
+
+/** Traffic profile */
+struct profile {
+    /** Export protocol                                                          */
+    enum profile_format format;
+    /** Number of simulated exporters                                            */
+    uint32_t exporters;
+    /** Observation Domain ID (or NetFlow Source ID) of the first exporter       */
+    uint32_t odid_base;
+    /** Maximum size of a packet (bytes)                                         */
+    uint16_t mtu;
+    /** Refresh templates every N packets of an exporter (0 == only once)        */
+    uint32_t tmplt_refresh;
+    /** Share of biflow records (0.0 - 1.0, IPFIX only)                          */
+    double biflow_share;
+    /** Maximum age of flows (ms), i.e. the range of flow start timestamps       */
+    uint32_t flow_age;
+
+    /** Fields of records (in the order of the template)                         */
+    struct profile_field *fields;
+    /** Number of fields                                                         */
+    size_t fields_cnt;
+};
+
+/**
+ * \brief Load a profile from a file
+ *
+ * In case of an error, an error message is printed on standard error output.
+ * \param[in] path Path to the XML file
+ * \return Pointer to the profile or NULL
+ */
+struct profile *
+profile_load(const char *path);
+
+/**
+ * \brief Destroy a profile
+ * \param[in] profile Profile
+ */
+void
+profile_destroy(struct profile *profile);
+
+#endif // IPFIXGEN_PROFILE_H
@@ -48,6 +48,7 @@
 #include <sys/ioctl.h>
 #include <linux/sockios.h>
 #include <time.h>
+#include <inttypes.h>
 
 #include "siso.h"
 #include "reader.h"
@@ -79,7 +80,7 @@ void usage()
     printf("  -i path    IPFIX input file\n");
     printf("  -d ip      Destination IP address (default: %s)\n", DEFAULT_IP);
     printf("  -p port    Destination port number (default: %s)\n", DEFAULT_PORT);
-    printf("  -t type    Connection type (UDP or TCP) (default: UDP)\n");
+    printf("  -t type    Connection type (UDP, TCP or TLS) (default: UDP)\n");
     printf("  -c         Precache input file (for performance tests)\n");
     printf("  -n num     How many times the file should be sent (default: infinity)\n");
     printf("  -s speed   Maximum data sending speed/s\n");
@@ -88,6 +89,7 @@ void usage()
     printf("  -R num     Real-time sending\n");
     printf("             Allow speed-up sending 'num' times (realtime: 1.0)\n");
     printf("  -O num     Rewrite Observation Domain ID (ODID)\n");
+    printf("  -P         Print throughput statistics at exit (for performance tests)\n");
     printf("\n");
 }
 
@@ -102,6 +104,25 @@ void handler(int signal)
     stop = 1;
 }
 
+/**
+ * \brief Print throughput statistics
+ * \param[in] sender Sender
+ * \param[in] begin  Start of the transfer
+ * \param[in] end    End of the transfer
+ */
+static void print_stats(sisoconf *sender, const struct timespec *begin,
+    const struct timespec *end)
+{
+    double elapsed = (end->tv_sec - begin->tv_sec) + (end->tv_nsec - begin->tv_nsec) / 1e9;
+    uint64_t bytes = siso_get_sent(sender);
+
+    printf("Sent bytes:   %" PRIu64 "\n", bytes);
+    printf("Elapsed time: %.3f s\n", elapsed);
+    if (elapsed > 0.0) {
+        printf("Throughput:   %.2f Mbit/s\n", (bytes * 8.0) / (elapsed * 1e6));
+    }
+}
+
 /**
  * \brief Main function
  * \param[in] argc Number of arguments
@@ -119,6 +140,7 @@ int main(int argc, char** argv)
     int     packets_s = 0;
     double  realtime_s = 0.0;
     bool    precache = false;
+    bool    stats = false;
 
     bool    odid_rewrite = false;
     long    odid_new;
@@ -130,7 +152,7 @@ int main(int argc, char** argv)
 
     // Parse parameters
     int c;
-    while ((c = getopt(argc, argv, "hci:d:p:t:n:s:S:R:O:")) != -1) {
+    while ((c = getopt(argc, argv, "hcPi:d:p:t:n:s:S:R:O:")) != -1) {
         switch (c) {
         case 'h':
             usage();
@@ -147,6 +169,9 @@ int main(int argc, char** argv)
         case 't':
             type = optarg;
             break;
+        case 'P':
+            stats = true;
+            break;
         case 'c':
             precache = true;
             break;
@@ -245,6 +270,8 @@ int main(int argc, char** argv)
     }
 
     // Send packets
+    struct timespec ts_begin, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_begin);
     int i;
     for (i = 0; !stop && (loops == INFINITY_LOOPS || i < loops); ++i) {
         reader_rewind(reader);
@@ -278,6 +305,11 @@ int main(int argc, char** argv)
         nanosleep(&sleep_time, NULL);
     }
 
+    if (stats) {
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        print_stats(sender, &ts_begin, &ts_end);
+    }
+
     siso_destroy(sender);
     return 0;
 }
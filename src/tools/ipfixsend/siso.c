@@ -56,6 +56,11 @@
 #include <stdio.h>
 #include <strings.h>
 
+#ifdef HAVE_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#endif
+
 /**
  * \brief Check that a pointer is not null. Otherwise returns #SISO_ERR
  * \param[in] ptr Pointer to check
@@ -85,6 +90,7 @@ enum siso_conn_type {
    SC_UDP,
    SC_TCP,
    SC_SCTP,
+   SC_TLS,
    SC_UNKNOWN,
 };
 
@@ -93,7 +99,8 @@ enum SISO_ERRORS {
     SISO_ERR_OK,
     SISO_ERR_TYPE,
     SISO_ERR_CONNECT,
-    SISO_ERR_CONFIG
+    SISO_ERR_CONFIG,
+    SISO_ERR_TLS
 };
 
 /** Error message  */
@@ -101,14 +108,16 @@ static const char *siso_messages[] = {
     [SISO_ERR_OK]      = "Everything OK",
     [SISO_ERR_TYPE]    = "Unknown connection type",
     [SISO_ERR_CONNECT] = "Unable to create a new socket and connect to a destination.",
-    [SISO_ERR_CONFIG]  = "Configuration information is missing."
+    [SISO_ERR_CONFIG]  = "Configuration information is missing.",
+    [SISO_ERR_TLS]     = "TLS error (handshake failed or not supported by this build)."
 };
 
 /** Supported connection types      */
 static const char *siso_sc_types[] = {
     [SC_UDP]  = "UDP",
     [SC_TCP]  = "TCP",
-    [SC_SCTP] = "SCTP"
+    [SC_SCTP] = "SCTP",
+    [SC_TLS]  = "TLS"
 };
 
 /**
@@ -122,6 +131,11 @@ struct sisoconf_s {
     uint64_t max_speed;         /**< max sending speed */
     uint64_t act_speed;         /**< actual speed */
     struct timeval begin, end;  /**< start/end time for limited transfers */
+    uint64_t sent;              /**< total number of sent bytes */
+#ifdef HAVE_OPENSSL
+    SSL_CTX *ssl_ctx;           /**< TLS context */
+    SSL *ssl;                   /**< TLS connection */
+#endif
 };
 
 /**
@@ -153,6 +167,9 @@ void siso_destroy(sisoconf *conf)
         freeaddrinfo(conf->servinfo);
     }
 
+#ifdef HAVE_OPENSSL
+    SSL_CTX_free(conf->ssl_ctx);
+#endif
     free(conf);
 }
 
@@ -179,6 +196,7 @@ inline int siso_get_socket(sisoconf *conf)		{ return conf->sockfd; }
 inline int siso_get_conn_type(sisoconf *conf)   { return conf->type; }
 inline uint64_t siso_get_speed(sisoconf *conf)  { return conf->max_speed; }
 inline const char *siso_get_last_err(sisoconf *conf){ return conf->last_error; }
+inline uint64_t siso_get_sent(sisoconf *conf)   { return conf->sent; }
 
 // Check if a destination is connected
 int siso_is_connected(const sisoconf *conf)
@@ -256,6 +274,7 @@ int siso_getaddrinfo(sisoconf *conf, const char *ip, const char *port)
         hints.ai_protocol = IPPROTO_UDP;
         break;
     case SC_TCP:
+    case SC_TLS:
         hints.ai_socktype = SOCK_STREAM;
         hints.ai_protocol = IPPROTO_TCP;
         break;
@@ -280,6 +299,39 @@ int siso_getaddrinfo(sisoconf *conf, const char *ip, const char *port)
     return SISO_OK;
 }
 
+/**
+ * \brief Establish a TLS connection over the connected socket
+ * \note Certificates of the collector are not verified (testing purposes only)
+ */
+static int siso_tls_connect(sisoconf *conf)
+{
+#ifdef HAVE_OPENSSL
+    if (!conf->ssl_ctx) {
+        conf->ssl_ctx = SSL_CTX_new(TLS_client_method());
+        if (!conf->ssl_ctx) {
+            conf->last_error = siso_messages[SISO_ERR_TLS];
+            return SISO_ERR;
+        }
+        SSL_CTX_set_verify(conf->ssl_ctx, SSL_VERIFY_NONE, NULL);
+    }
+
+    conf->ssl = SSL_new(conf->ssl_ctx);
+    if (!conf->ssl || SSL_set_fd(conf->ssl, conf->sockfd) != 1
+            || SSL_connect(conf->ssl) != 1) {
+        ERR_print_errors_fp(stderr);
+        conf->last_error = siso_messages[SISO_ERR_TLS];
+        siso_close_connection(conf);
+        return SISO_ERR;
+    }
+
+    return SISO_OK;
+#else
+    conf->last_error = siso_messages[SISO_ERR_TLS];
+    siso_close_connection(conf);
+    return SISO_ERR;
+#endif
+}
+
 /**
  * \brief Create new socket
  */
@@ -309,6 +361,10 @@ int siso_create_socket(sisoconf *conf)
     }
 
     conf->sockfd = new_fd;
+    if (conf->type == SC_TLS) {
+        return siso_tls_connect(conf);
+    }
+
     return SISO_OK;
 }
 
@@ -345,6 +401,13 @@ int siso_create_connection(sisoconf* conf, const char* ip, const char *port, con
 void siso_close_connection(sisoconf *conf)
 {
     if (conf && conf->sockfd > 0) {
+#ifdef HAVE_OPENSSL
+        if (conf->ssl) {
+            SSL_shutdown(conf->ssl);
+            SSL_free(conf->ssl);
+            conf->ssl = NULL;
+        }
+#endif
         close(conf->sockfd);
         conf->sockfd = -1;
     }
@@ -389,6 +452,17 @@ int siso_send(sisoconf *conf, const char *data, ssize_t length)
         case SC_SCTP:
             sent_now = send(conf->sockfd, ptr, todo, MSG_NOSIGNAL);
             break;
+#ifdef HAVE_OPENSSL
+        case SC_TLS:
+            sent_now = SSL_write(conf->ssl, ptr, (int) SISO_MIN(todo, INT32_MAX));
+            if (sent_now <= 0) {
+                if (SSL_get_error(conf->ssl, (int) sent_now) != SSL_ERROR_SYSCALL) {
+                    errno = EPIPE;
+                }
+                sent_now = -1;
+            }
+            break;
+#endif
         default:
             break;
         }
@@ -409,6 +483,7 @@ int siso_send(sisoconf *conf, const char *data, ssize_t length)
         // Skip sent data
         ptr  += sent_now;
         todo -= sent_now;
+        conf->sent += sent_now;
 
         // check speed limit
         conf->act_speed += sent_now;
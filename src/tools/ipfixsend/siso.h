@@ -118,6 +118,14 @@ uint64_t siso_get_speed(sisoconf *conf);
  */
 const char *siso_get_last_err(sisoconf *conf);
 
+/**
+ * \brief Get total number of sent bytes
+ *
+ * \param[in] conf sisoconf configuration
+ * \return Number of bytes
+ */
+uint64_t siso_get_sent(sisoconf *conf);
+
 /**
  * \brief Set unlimited speed
  *
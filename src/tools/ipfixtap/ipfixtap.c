@@ -0,0 +1,297 @@
+/**
+ * \file ipfixtap.c
+ * \author agent <agent@local>
+ * \brief Tool that shows Data Records tapped from a running collector
+ *
+ * Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is, and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/** Default path of the socket of the collector */
+#define DEFAULT_SOCKET "/tmp/ipfixcol2_tap.sock"
+/** Default sampling rate (i.e. all records)    */
+#define DEFAULT_SAMPLING "1"
+/** Maximum size of a received packet          */
+#define PACKET_SIZE (1024U * 1024U)
+
+/** Global stop signal                          */
+static volatile sig_atomic_t stop = 0;
+
+/** \brief Print usage                          */
+void usage()
+{
+    printf("\n");
+    printf("Usage: ipfixtap [options] -p point\n");
+    printf("       ipfixtap [options] -l\n");
+    printf("  -h         Show this help\n");
+    printf("  -s path    Socket of the collector (default: %s)\n", DEFAULT_SOCKET);
+    printf("  -l         List available tap points\n");
+    printf("  -p point   Tap point (name of a parser or an intermediate instance)\n");
+    printf("  -f filter  Show only records that match the filter expression\n");
+    printf("  -r num     Show one of 'num' matching records (default: %s)\n", DEFAULT_SAMPLING);
+    printf("  -n num     Exit after 'num' shown records (default: unlimited)\n");
+    printf("\n");
+}
+
+/**
+ * \brief Termination signal handler
+ * \param[in] signal Signal to process
+ */
+void handler(int signal)
+{
+    (void) signal; // skip compiler warning
+    stop = 1;
+}
+
+/**
+ * \brief Connect to the tap server of the collector
+ * \param[in] path Path of the socket
+ * \return Socket or -1 on failure
+ */
+static int connect_server(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Path of the socket is too long!\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd == -1) {
+        fprintf(stderr, "Failed to create a socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (connect(fd, (const struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Failed to connect to '%s': %s\n"
+            "Is the collector running with an enabled tap (<tap>)?\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * \brief Send a request and check the reply of the server
+ * \param[in] fd  Socket
+ * \param[in] req Request
+ * \return 0 on success, non-zero on failure
+ */
+static int request(int fd, const char *req)
+{
+    if (send(fd, req, strlen(req), MSG_NOSIGNAL) == -1) {
+        fprintf(stderr, "Failed to send a request: %s\n", strerror(errno));
+        return 1;
+    }
+
+    char reply[4096];
+    ssize_t len = recv(fd, reply, sizeof(reply) - 1, 0);
+    if (len <= 0) {
+        fprintf(stderr, "The collector closed the connection.\n");
+        return 1;
+    }
+    reply[len] = '\0';
+
+    if (strcmp(reply, "OK") != 0) {
+        fprintf(stderr, "The request was refused: %s\n",
+            (strncmp(reply, "ERR ", 4) == 0) ? reply + 4 : reply);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Print received packets (one per line) until the connection is closed
+ * \param[in] fd    Socket
+ * \param[in] limit Maximum number of printed records (0 == unlimited)
+ * \return 0 on success, non-zero on failure
+ */
+static int receive(int fd, uint64_t limit)
+{
+    char *packet = malloc(PACKET_SIZE);
+    if (!packet) {
+        fprintf(stderr, "Memory allocation error\n");
+        return 1;
+    }
+
+    uint64_t cnt = 0;
+    while (!stop && (limit == 0 || cnt < limit)) {
+        ssize_t len = recv(fd, packet, PACKET_SIZE, 0);
+        if (len == -1 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            break;
+        }
+
+        if (packet[0] == '#') {
+            // Notification of the server
+            uint64_t dropped;
+            if (sscanf(packet, "#dropped %" SCNu64, &dropped) == 1) {
+                fprintf(stderr, "Warning: %" PRIu64 " record(s) dropped (the output is too "
+                    "slow)\n", dropped);
+            }
+            continue;
+        }
+
+        fwrite(packet, 1, (size_t) len, stdout);
+        fputc('\n', stdout);
+        cnt++;
+    }
+
+    fflush(stdout);
+    free(packet);
+    return 0;
+}
+
+/**
+ * \brief Main function
+ * \param[in] argc Number of arguments
+ * \param[in] argv Array of arguments
+ */
+int main(int argc, char** argv)
+{
+    const char *path = DEFAULT_SOCKET;
+    const char *point = NULL;
+    const char *filter = "";
+    const char *sampling = DEFAULT_SAMPLING;
+    bool list = false;
+    long long limit = 0;
+
+    if (argc == 1) {
+        usage();
+        return 0;
+    }
+
+    // Parse parameters
+    int c;
+    while ((c = getopt(argc, argv, "hls:p:f:r:n:")) != -1) {
+        switch (c) {
+        case 'h':
+            usage();
+            return 0;
+        case 'l':
+            list = true;
+            break;
+        case 's':
+            path = optarg;
+            break;
+        case 'p':
+            point = optarg;
+            break;
+        case 'f':
+            filter = optarg;
+            break;
+        case 'r':
+            sampling = optarg;
+            break;
+        case 'n':
+            limit = atoll(optarg);
+            break;
+        default:
+            fprintf(stderr, "Unknown option.\n");
+            return 1;
+        }
+    }
+
+    // Parameters check
+    if (!list && !point) {
+        fprintf(stderr, "Tap point must be set!\n");
+        return 1;
+    }
+
+    if (point && strchr(point, '\n') != NULL) {
+        fprintf(stderr, "Invalid name of the tap point.\n");
+        return 1;
+    }
+
+    if (atol(sampling) <= 0) {
+        fprintf(stderr, "Invalid value of the sampling rate.\n");
+        return 1;
+    }
+
+    if (limit < 0) {
+        fprintf(stderr, "Invalid value of the record limit.\n");
+        return 1;
+    }
+
+    // Interrupt blocking recv() on termination
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int fd = connect_server(path);
+    if (fd == -1) {
+        return 1;
+    }
+
+    char req[4096];
+    if (list) {
+        snprintf(req, sizeof(req), "LIST");
+    } else {
+        int len = snprintf(req, sizeof(req), "ATTACH\n%s\n%s\n%s", point, sampling, filter);
+        if (len < 0 || (size_t) len >= sizeof(req)) {
+            fprintf(stderr, "The filter expression is too long.\n");
+            close(fd);
+            return 1;
+        }
+    }
+
+    int ret = request(fd, req);
+    if (ret == 0) {
+        ret = receive(fd, list ? 0 : (uint64_t) limit);
+    }
+
+    // The collector detaches the client when the connection is closed
+    close(fd);
+    return ret;
+}
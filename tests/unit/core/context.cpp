@@ -0,0 +1,383 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/message_ipfix.h>
+    #include <core/message_terminate.h>
+    #include <core/ring.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_iemgr = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using unique_ring = std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)>;
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+
+/** Body of the plugin constructor of the next initialized instance */
+static std::function<int(ipx_ctx_t *)> init_body;
+
+static int
+plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+    ipx_ctx_private_set(ctx, ctx);
+    return init_body ? init_body(ctx) : IPX_OK;
+}
+
+static void
+plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    (void) cfg;
+}
+
+static int
+plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) cfg;
+    ipx_ctx_msg_pass(ctx, msg);
+    return IPX_OK;
+}
+
+/** Number of ticks delivered to instances                                      */
+static std::atomic<unsigned int> tick_cnt{0};
+/** Timestamps of the delivered ticks (read only after the instance is terminated) */
+static std::vector<struct timespec> tick_times;
+
+static void
+plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now)
+{
+    (void) ctx;
+    (void) cfg;
+    tick_times.push_back(*now);
+    tick_cnt++;
+}
+
+/** Pipeline of instances (initialized, but started only by some tests) */
+class Context : public ::testing::Test {
+protected:
+    unique_iemgr iemgr{fds_iemgr_create(), &fds_iemgr_destroy};
+    // Rings must outlive contexts (destroyed in reverse order)
+    std::vector<unique_ring> rings;
+    std::vector<unique_ctx> ctxs;
+    // Plugin descriptions and callbacks must outlive contexts too
+    std::vector<std::unique_ptr<struct ipx_plugin_info>> infos;
+    std::vector<std::unique_ptr<struct ipx_ctx_callbacks>> cbs;
+
+    void TearDown() override {
+        init_body = nullptr;
+        tick_cnt = 0;
+        tick_times.clear();
+        ctxs.clear();
+        rings.clear();
+    }
+
+    /** Create a new (not initialized) instance of a plugin type (optionally with ticks) */
+    ipx_ctx_t *create(uint16_t type, bool tick = false) {
+        infos.emplace_back(new struct ipx_plugin_info());
+        struct ipx_plugin_info *info = infos.back().get();
+        info->name = "dummy";
+        info->dsc = "Dummy plugin";
+        info->type = type;
+        info->version = "1.0.0";
+        info->ipx_min = "2.0.0";
+
+        cbs.emplace_back(new struct ipx_ctx_callbacks());
+        struct ipx_ctx_callbacks *cb = cbs.back().get();
+        cb->info = info;
+        cb->init = &plugin_init;
+        cb->destroy = &plugin_destroy;
+        cb->process = &plugin_process;
+        cb->tick = tick ? &plugin_tick : nullptr;
+
+        ctxs.emplace_back(ipx_ctx_create("dummy", cb), &ipx_ctx_destroy);
+        ipx_ctx_t *ctx = ctxs.back().get();
+        EXPECT_NE(ctx, nullptr);
+        ipx_ctx_iemgr_set(ctx, iemgr.get());
+
+        rings.emplace_back(ipx_ring_init(8, false), &ipx_ring_destroy);
+        ipx_ctx_ring_src_set(ctx, rings.back().get());
+        if (type == IPX_PT_INTERMEDIATE) {
+            rings.emplace_back(ipx_ring_init(8, false), &ipx_ring_destroy);
+            ipx_ctx_ring_dst_set(ctx, rings.back().get());
+        }
+        return ctx;
+    }
+
+    /** Create and initialize an instance, the constructor calls \p body */
+    ipx_ctx_t *init(uint16_t type, const std::function<int(ipx_ctx_t *)> &body,
+        bool tick = false) {
+        ipx_ctx_t *ctx = create(type, tick);
+        init_body = body;
+        EXPECT_EQ(ipx_ctx_init(ctx, nullptr), IPX_OK);
+        init_body = nullptr;
+        return ctx;
+    }
+};
+
+/** Data Record with reserved space for extensions */
+class RextRecord {
+public:
+    explicit RextRecord(size_t rec_size) : m_buffer((rec_size + 7) / 8, 0) {}
+    struct ipx_ipfix_record *get() {
+        return reinterpret_cast<struct ipx_ipfix_record *>(m_buffer.data());
+    }
+private:
+    std::vector<uint64_t> m_buffer;
+};
+
+// Only Intermediate instances can produce extensions and only within their constructors
+TEST_F(Context, rextProducerPermissions)
+{
+    ipx_ctx_rext_t *rext = nullptr;
+    ipx_ctx_t *inter = create(IPX_PT_INTERMEDIATE);
+    EXPECT_EQ(ipx_ctx_rext_producer(inter, "type", "name", 8, &rext), IPX_ERR_DENIED);
+
+    init(IPX_PT_INTERMEDIATE, [](ipx_ctx_t *ctx) {
+        ipx_ctx_rext_t *ref = nullptr;
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "name", 8, &ref), IPX_OK);
+        EXPECT_NE(ref, nullptr);
+        return IPX_OK;
+    });
+
+    init(IPX_PT_OUTPUT, [](ipx_ctx_t *ctx) {
+        ipx_ctx_rext_t *ref = nullptr;
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "name", 8, &ref), IPX_ERR_DENIED);
+        return IPX_OK;
+    });
+
+    // After initialization
+    ipx_ctx_t *done = init(IPX_PT_INTERMEDIATE, nullptr);
+    EXPECT_EQ(ipx_ctx_rext_producer(done, "type", "name", 8, &rext), IPX_ERR_DENIED);
+    EXPECT_EQ(ipx_ctx_rext_consumer(done, "type", "name", &rext), IPX_ERR_DENIED);
+}
+
+// Invalid arguments and duplicate registrations
+TEST_F(Context, rextArguments)
+{
+    init(IPX_PT_INTERMEDIATE, [](ipx_ctx_t *ctx) {
+        ipx_ctx_rext_t *ref = nullptr;
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, nullptr, "name", 8, &ref), IPX_ERR_ARG);
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", nullptr, 8, &ref), IPX_ERR_ARG);
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "name", 0, &ref), IPX_ERR_ARG);
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "name", 8, nullptr), IPX_ERR_ARG);
+        EXPECT_EQ(ipx_ctx_rext_consumer(ctx, nullptr, "name", &ref), IPX_ERR_ARG);
+        EXPECT_EQ(ipx_ctx_rext_consumer(ctx, "type", "name", nullptr), IPX_ERR_ARG);
+
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "name", 8, &ref), IPX_OK);
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "name", 16, &ref), IPX_ERR_EXISTS);
+        EXPECT_EQ(ipx_ctx_rext_consumer(ctx, "type", "name", &ref), IPX_ERR_EXISTS);
+        // Type and name together identify the extension
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "type", "other", 8, &ref), IPX_OK);
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "other", "name", 8, &ref), IPX_OK);
+        return IPX_OK;
+    });
+}
+
+// Consumers are connected to the producers placed before them and data are shared
+TEST_F(Context, rextResolve)
+{
+    ipx_ctx_rext_t *prod_a = nullptr;
+    ipx_ctx_rext_t *prod_b = nullptr;
+    ipx_ctx_rext_t *cons_inter = nullptr;
+    ipx_ctx_rext_t *cons_out = nullptr;
+
+    std::vector<ipx_ctx_t *> pipeline;
+    pipeline.push_back(init(IPX_PT_INTERMEDIATE, [&](ipx_ctx_t *ctx) {
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "meta", "a", 5, &prod_a), IPX_OK);
+        return IPX_OK;
+    }));
+    pipeline.push_back(init(IPX_PT_INTERMEDIATE, [&](ipx_ctx_t *ctx) {
+        EXPECT_EQ(ipx_ctx_rext_consumer(ctx, "meta", "a", &cons_inter), IPX_OK);
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "meta", "b", 12, &prod_b), IPX_OK);
+        return IPX_OK;
+    }));
+    pipeline.push_back(init(IPX_PT_OUTPUT, [&](ipx_ctx_t *ctx) {
+        EXPECT_EQ(ipx_ctx_rext_consumer(ctx, "meta", "b", &cons_out), IPX_OK);
+        return IPX_OK;
+    }));
+
+    size_t rec_size = 0;
+    ASSERT_EQ(ipx_ctx_rext_resolve(pipeline.data(), pipeline.size(), &rec_size), IPX_OK);
+    // Each extension is aligned to 8 bytes
+    EXPECT_EQ(rec_size, IPX_MSG_IPFIX_BASE_REC_SIZE + 8U + 16U);
+
+    RextRecord rec(rec_size);
+    void *data_a;
+    void *data_b;
+    void *data_cons;
+    size_t size;
+
+    // Nothing is filled yet, but the producer can write the data
+    EXPECT_EQ(ipx_ctx_rext_get(prod_a, rec.get(), &data_a, &size), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(size, 5U);
+    EXPECT_EQ(ipx_ctx_rext_get(prod_b, rec.get(), &data_b, &size), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(size, 12U);
+    EXPECT_NE(data_a, data_b);
+    memcpy(data_a, "abcde", 5);
+    memcpy(data_b, "0123456789AB", 12);
+
+    ipx_ctx_rext_set_filled(prod_a, rec.get());
+    ASSERT_EQ(ipx_ctx_rext_get(cons_inter, rec.get(), &data_cons, &size), IPX_OK);
+    EXPECT_EQ(size, 5U);
+    EXPECT_EQ(data_cons, data_a);
+    EXPECT_EQ(memcmp(data_cons, "abcde", 5), 0);
+    EXPECT_EQ(ipx_ctx_rext_get(cons_out, rec.get(), &data_cons, nullptr), IPX_ERR_NOTFOUND);
+
+    ipx_ctx_rext_set_filled(prod_b, rec.get());
+    ASSERT_EQ(ipx_ctx_rext_get(cons_out, rec.get(), &data_cons, &size), IPX_OK);
+    EXPECT_EQ(size, 12U);
+    EXPECT_EQ(data_cons, data_b);
+    EXPECT_EQ(memcmp(data_cons, "0123456789AB", 12), 0);
+}
+
+// Consumer without a producer placed before it in the pipeline
+TEST_F(Context, rextResolveMissing)
+{
+    std::vector<ipx_ctx_t *> pipeline;
+    pipeline.push_back(init(IPX_PT_INTERMEDIATE, [](ipx_ctx_t *ctx) {
+        ipx_ctx_rext_t *ref;
+        EXPECT_EQ(ipx_ctx_rext_consumer(ctx, "meta", "a", &ref), IPX_OK);
+        return IPX_OK;
+    }));
+    pipeline.push_back(init(IPX_PT_INTERMEDIATE, [](ipx_ctx_t *ctx) {
+        ipx_ctx_rext_t *ref;
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "meta", "a", 8, &ref), IPX_OK);
+        return IPX_OK;
+    }));
+
+    size_t rec_size;
+    EXPECT_EQ(ipx_ctx_rext_resolve(pipeline.data(), pipeline.size(), &rec_size),
+        IPX_ERR_NOTFOUND);
+    // The producer alone is fine
+    EXPECT_EQ(ipx_ctx_rext_resolve(pipeline.data() + 1, 1, &rec_size), IPX_OK);
+    EXPECT_EQ(rec_size, IPX_MSG_IPFIX_BASE_REC_SIZE + 8U);
+}
+
+// Only one instance can produce the same extension
+TEST_F(Context, rextResolveDuplicate)
+{
+    std::vector<ipx_ctx_t *> pipeline;
+    for (int i = 0; i < 2; ++i) {
+        pipeline.push_back(init(IPX_PT_INTERMEDIATE, [](ipx_ctx_t *ctx) {
+            ipx_ctx_rext_t *ref;
+            EXPECT_EQ(ipx_ctx_rext_producer(ctx, "meta", "a", 8, &ref), IPX_OK);
+            return IPX_OK;
+        }));
+    }
+
+    size_t rec_size;
+    EXPECT_EQ(ipx_ctx_rext_resolve(pipeline.data(), pipeline.size(), &rec_size), IPX_ERR_EXISTS);
+}
+
+// Extensions registered by a failed constructor are removed
+TEST_F(Context, rextInitFailed)
+{
+    ipx_ctx_t *ctx = create(IPX_PT_INTERMEDIATE);
+    init_body = [](ipx_ctx_t *ctx) {
+        ipx_ctx_rext_t *ref;
+        EXPECT_EQ(ipx_ctx_rext_producer(ctx, "meta", "a", 8, &ref), IPX_OK);
+        return IPX_ERR_DENIED;
+    };
+    EXPECT_EQ(ipx_ctx_init(ctx, nullptr), IPX_ERR_DENIED);
+    init_body = nullptr;
+
+    size_t rec_size;
+    EXPECT_EQ(ipx_ctx_rext_resolve(&ctx, 1, &rec_size), IPX_OK);
+    EXPECT_EQ(rec_size, IPX_MSG_IPFIX_BASE_REC_SIZE);
+}
+
+// Only Intermediate and Output instances with the tick callback can request ticks and only
+// within their constructors
+TEST_F(Context, tickPermissions)
+{
+    ipx_ctx_t *inter = create(IPX_PT_INTERMEDIATE, true);
+    EXPECT_EQ(ipx_ctx_tick_set(inter, 100), IPX_ERR_DENIED);
+
+    for (uint16_t type : {IPX_PT_INTERMEDIATE, IPX_PT_OUTPUT}) {
+        init(type, [](ipx_ctx_t *ctx) {
+            EXPECT_EQ(ipx_ctx_tick_set(ctx, 100), IPX_OK);
+            EXPECT_EQ(ipx_ctx_tick_set(ctx, 1), IPX_OK);
+            // Ticks can be disabled again
+            EXPECT_EQ(ipx_ctx_tick_set(ctx, 0), IPX_OK);
+            return IPX_OK;
+        }, true);
+    }
+
+    // The tick callback is required to enable ticks
+    init(IPX_PT_INTERMEDIATE, [](ipx_ctx_t *ctx) {
+        EXPECT_EQ(ipx_ctx_tick_set(ctx, 100), IPX_ERR_DENIED);
+        EXPECT_EQ(ipx_ctx_tick_set(ctx, 0), IPX_OK);
+        return IPX_OK;
+    });
+
+    // After initialization
+    ipx_ctx_t *done = init(IPX_PT_OUTPUT, nullptr, true);
+    EXPECT_EQ(ipx_ctx_tick_set(done, 100), IPX_ERR_DENIED);
+}
+
+// Ticks are delivered periodically between messages and only if requested
+TEST_F(Context, tickDelivery)
+{
+    for (uint32_t interval : {10U, 0U}) {
+        SCOPED_TRACE("interval " + std::to_string(interval));
+        ipx_ctx_t *ctx = init(IPX_PT_INTERMEDIATE, [interval](ipx_ctx_t *ctx) {
+            return ipx_ctx_tick_set(ctx, interval);
+        }, true);
+        ipx_ring_t *ring_in = rings[rings.size() - 2].get();
+        ipx_ring_t *ring_out = rings.back().get();
+        size_t rec_size;
+        ASSERT_EQ(ipx_ctx_rext_resolve(&ctx, 1, &rec_size), IPX_OK);
+        ipx_ctx_recsize_set(ctx, rec_size);
+        ASSERT_EQ(ipx_ctx_run(ctx), IPX_OK);
+
+        // Ticks are delivered even if there are no messages
+        const auto start = std::chrono::steady_clock::now();
+        const auto timeout = std::chrono::milliseconds(interval != 0 ? 5000 : 50);
+        while ((interval == 0 || tick_cnt < 5)
+                && std::chrono::steady_clock::now() - start < timeout) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // Stop the instance (the termination message is passed as the last one)
+        ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+        ipx_ring_push(ring_in, ipx_msg_terminate2base(msg));
+        ipx_msg_t *out = ipx_ring_pop(ring_out);
+        EXPECT_EQ(ipx_msg_get_type(out), IPX_MSG_TERMINATE);
+        ipx_msg_termiante_destroy(ipx_msg_base2terminate(out));
+
+        if (interval == 0) {
+            EXPECT_EQ(tick_cnt, 0U);
+            continue;
+        }
+
+        // Ticks are (at least) the interval apart
+        ASSERT_GE(tick_times.size(), 5U);
+        for (size_t i = 1; i < tick_times.size(); ++i) {
+            const int64_t diff_ms =
+                (tick_times[i].tv_sec - tick_times[i - 1].tv_sec) * 1000
+                + (tick_times[i].tv_nsec - tick_times[i - 1].tv_nsec) / 1000000;
+            EXPECT_GE(diff_ms, static_cast<int64_t>(interval) - 1);
+        }
+        tick_cnt = 0;
+        tick_times.clear();
+    }
+}
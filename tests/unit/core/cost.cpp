@@ -0,0 +1,127 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/cost.h>
+    #include <core/message_ipfix.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_cost = std::unique_ptr<ipx_cost_t, decltype(&ipx_cost_destroy)>;
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+
+// Costs of the same combination are accumulated and the most expensive ones are reported first
+TEST(Cost, top)
+{
+    unique_cost cost(ipx_cost_create(), &ipx_cost_destroy);
+    ASSERT_NE(cost, nullptr);
+
+    EXPECT_EQ(ipx_cost_add(cost.get(), "exporter A", 1, 256, 100, 10), IPX_OK);
+    EXPECT_EQ(ipx_cost_add(cost.get(), "exporter A", 1, 257, 280, 20), IPX_OK);
+    EXPECT_EQ(ipx_cost_add(cost.get(), "exporter B", 1, 256, 250, 30), IPX_OK);
+    EXPECT_EQ(ipx_cost_add(cost.get(), "exporter A", 2, 256, 50, 40), IPX_OK);
+    EXPECT_EQ(ipx_cost_add(cost.get(), "exporter A", 1, 256, 200, 50), IPX_OK);
+    EXPECT_EQ(ipx_cost_cnt(cost.get()), 4U);
+    EXPECT_EQ(ipx_cost_total(cost.get()), 880U);
+
+    struct ipx_cost_entry top[3];
+    ASSERT_EQ(ipx_cost_top(cost.get(), top, 3), 3U);
+    EXPECT_STREQ(top[0].session, "exporter A");
+    EXPECT_EQ(top[0].odid, 1U);
+    EXPECT_EQ(top[0].set_id, 256U);
+    EXPECT_EQ(top[0].cost, 300U);
+    EXPECT_EQ(top[0].bytes, 60U);
+    EXPECT_EQ(top[1].set_id, 257U);
+    EXPECT_STREQ(top[2].session, "exporter B");
+
+    // Less combinations than requested
+    struct ipx_cost_entry all[10];
+    EXPECT_EQ(ipx_cost_top(cost.get(), all, 10), 4U);
+    EXPECT_EQ(all[3].odid, 2U);
+}
+
+// Combinations that don't fit into the table are accumulated together
+TEST(Cost, limit)
+{
+    unique_cost cost(ipx_cost_create(), &ipx_cost_destroy);
+    ASSERT_NE(cost, nullptr);
+
+    for (uint32_t i = 0; i < IPX_COST_MAX_ENTRIES + 10; ++i) {
+        ASSERT_EQ(ipx_cost_add(cost.get(), "exporter", i, 256, 1, 1), IPX_OK);
+    }
+    ASSERT_EQ(ipx_cost_add(cost.get(), "exporter", 0, 256, 1000, 1), IPX_OK);
+    EXPECT_EQ(ipx_cost_cnt(cost.get()), IPX_COST_MAX_ENTRIES);
+
+    struct ipx_cost_entry top[2];
+    ASSERT_EQ(ipx_cost_top(cost.get(), top, 2), 2U);
+    EXPECT_STREQ(top[0].session, "exporter");
+    EXPECT_EQ(top[0].cost, 1001U);
+    EXPECT_EQ(top[1].session, nullptr); // Other sources
+    EXPECT_EQ(top[1].cost, 10U);
+}
+
+// Measured time is split among Sets of a message proportionally to their size
+TEST(Cost, measure)
+{
+    unique_ctx ctx(ipx_ctx_create("test", nullptr), &ipx_ctx_destroy);
+    ASSERT_NE(ctx, nullptr);
+    unique_cost cost(ipx_cost_create(), &ipx_cost_destroy);
+    ASSERT_NE(cost, nullptr);
+
+    // Message with 2 Data Sets (Template IDs 256 and 300, 16 and 48 bytes long)
+    const uint16_t msg_size = FDS_IPFIX_MSG_HDR_LEN + 64U;
+    uint8_t *raw = static_cast<uint8_t *>(calloc(1, msg_size));
+    ASSERT_NE(raw, nullptr);
+    auto *set1 = reinterpret_cast<struct fds_ipfix_set_hdr *>(raw + FDS_IPFIX_MSG_HDR_LEN);
+    auto *set2 = reinterpret_cast<struct fds_ipfix_set_hdr *>(raw + FDS_IPFIX_MSG_HDR_LEN + 16);
+    set1->flowset_id = htons(256);
+    set1->length = htons(16);
+    set2->flowset_id = htons(300);
+    set2->length = htons(48);
+
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = nullptr;
+    msg_ctx.odid = 5;
+    msg_ctx.stream = 0;
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx.get(), &msg_ctx, raw, msg_size);
+    ASSERT_NE(msg, nullptr);
+    ipx_msg_ipfix_add_set_ref(msg)->ptr = set1;
+    ipx_msg_ipfix_add_set_ref(msg)->ptr = set2;
+
+    ASSERT_EQ(ipx_cost_begin(cost.get(), msg), IPX_OK);
+    ipx_msg_ipfix_destroy(msg); // The message is not required anymore
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < 20000000ULL; ++i) {
+        sum = sum + i;
+    }
+    ipx_cost_end(cost.get());
+
+    const uint64_t total = ipx_cost_total(cost.get());
+    ASSERT_GT(total, 0U);
+
+    struct ipx_cost_entry top[2];
+    ASSERT_EQ(ipx_cost_top(cost.get(), top, 2), 2U);
+    EXPECT_STREQ(top[0].session, "");
+    EXPECT_EQ(top[0].odid, 5U);
+    EXPECT_EQ(top[0].set_id, 300U);
+    EXPECT_EQ(top[0].bytes, 48U);
+    EXPECT_EQ(top[1].set_id, 256U);
+    EXPECT_EQ(top[1].bytes, 16U);
+    EXPECT_EQ(top[0].cost + top[1].cost, total);
+    EXPECT_NEAR(static_cast<double>(top[0].cost) / total, 0.75, 0.01);
+}
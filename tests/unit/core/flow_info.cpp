@@ -0,0 +1,261 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+extern "C" {
+    #include <core/flow_info.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_plans = std::unique_ptr<ipx_flow_plans_t, decltype(&ipx_flow_plans_destroy)>;
+using unique_tmplt = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+
+/** Export Time of all messages (2019-09-01 00:00:00 UTC) */
+static const uint32_t EXP_TIME = 1567296000U;
+
+/** Simple builder of a raw Template and its Data Record */
+class Builder {
+public:
+    Builder() {put16(m_tmplt, 256); put16(m_tmplt, 0);}
+
+    /** Add a field and its value (empty size == variable-length field) */
+    void
+    add(uint16_t id, std::vector<uint8_t> value, bool var = false)
+    {
+        put16(m_tmplt, id);
+        put16(m_tmplt, var ? 65535 : static_cast<uint16_t>(value.size()));
+        const uint16_t cnt = static_cast<uint16_t>((m_tmplt[2] << 8) | m_tmplt[3]) + 1;
+        m_tmplt[2] = static_cast<uint8_t>(cnt >> 8);
+        m_tmplt[3] = static_cast<uint8_t>(cnt);
+
+        if (var) {
+            m_rec.push_back(static_cast<uint8_t>(value.size()));
+        }
+        m_rec.insert(m_rec.end(), value.begin(), value.end());
+    }
+
+    /** Parse the Template */
+    unique_tmplt
+    tmplt()
+    {
+        struct fds_template *ptr = nullptr;
+        uint16_t len = static_cast<uint16_t>(m_tmplt.size());
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, m_tmplt.data(), &len, &ptr), FDS_OK);
+        return unique_tmplt(ptr, &fds_template_destroy);
+    }
+
+    /** Get the Data Record */
+    struct fds_drec
+    rec(const struct fds_template *tmplt)
+    {
+        struct fds_drec rec;
+        rec.data = m_rec.data();
+        rec.size = static_cast<uint16_t>(m_rec.size());
+        rec.tmplt = tmplt;
+        rec.snap = nullptr;
+        return rec;
+    }
+
+private:
+    static void
+    put16(std::vector<uint8_t> &vec, uint16_t value)
+    {
+        vec.push_back(static_cast<uint8_t>(value >> 8));
+        vec.push_back(static_cast<uint8_t>(value));
+    }
+
+    std::vector<uint8_t> m_tmplt;
+    std::vector<uint8_t> m_rec;
+};
+
+/** Encode an unsigned integer in network byte order */
+static std::vector<uint8_t>
+be(uint64_t value, size_t size)
+{
+    std::vector<uint8_t> result(size);
+    for (size_t i = 0; i < size; ++i) {
+        result[size - 1 - i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return result;
+}
+
+/** Derive flow information of a single record */
+static struct ipx_flow_info
+derive(ipx_flow_plans_t *plans, Builder &builder, const struct fds_template *tmplt)
+{
+    struct ipx_flow_info info;
+    struct fds_drec rec = builder.rec(tmplt);
+    ipx_flow_plans_begin(plans);
+    EXPECT_EQ(ipx_flow_info_fill(plans, &rec, EXP_TIME, &info), IPX_OK);
+    ipx_flow_info_hash(&info, 1);
+    return info;
+}
+
+/** Build a typical IPv4 record */
+static Builder
+ipv4_flow(uint32_t src, uint32_t dst, uint16_t sport, uint16_t dport)
+{
+    Builder builder;
+    builder.add(8, be(src, 4));
+    builder.add(12, be(dst, 4));
+    builder.add(7, be(sport, 2));
+    builder.add(11, be(dport, 2));
+    builder.add(4, be(6, 1));
+    builder.add(152, be(EXP_TIME * 1000ULL - 2000U, 8));
+    builder.add(153, be(EXP_TIME * 1000ULL - 500U, 8));
+    return builder;
+}
+
+TEST(FlowInfo, ipv4)
+{
+    unique_plans plans(ipx_flow_plans_create(), &ipx_flow_plans_destroy);
+    ASSERT_NE(plans, nullptr);
+
+    Builder builder = ipv4_flow(0x0A000001, 0xC0A80102, 1234, 80);
+    unique_tmplt tmplt = builder.tmplt();
+    ASSERT_NE(tmplt, nullptr);
+    const struct ipx_flow_info info = derive(plans.get(), builder, tmplt.get());
+
+    const uint8_t src[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 10, 0, 0, 1};
+    const uint8_t dst[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 192, 168, 1, 2};
+    EXPECT_EQ(info.flags, IPX_FLOW_ADDR | IPX_FLOW_IPV4 | IPX_FLOW_PORTS | IPX_FLOW_PROTO
+        | IPX_FLOW_START | IPX_FLOW_END);
+    EXPECT_EQ(memcmp(info.src_addr, src, 16), 0);
+    EXPECT_EQ(memcmp(info.dst_addr, dst, 16), 0);
+    EXPECT_EQ(info.src_port, 1234);
+    EXPECT_EQ(info.dst_port, 80);
+    EXPECT_EQ(info.proto, 6);
+    EXPECT_EQ(info.start, (EXP_TIME * 1000ULL - 2000U) * 1000000ULL);
+    EXPECT_EQ(info.end, (EXP_TIME * 1000ULL - 500U) * 1000000ULL);
+}
+
+// Both directions of a flow must have the same hash, different flows should not
+TEST(FlowInfo, hash)
+{
+    unique_plans plans(ipx_flow_plans_create(), &ipx_flow_plans_destroy);
+    ASSERT_NE(plans, nullptr);
+
+    Builder fwd = ipv4_flow(0x0A000001, 0xC0A80102, 1234, 80);
+    Builder rev = ipv4_flow(0xC0A80102, 0x0A000001, 80, 1234);
+    Builder other = ipv4_flow(0x0A000001, 0xC0A80102, 1235, 80);
+    Builder same_addr = ipv4_flow(0x0A000001, 0x0A000001, 80, 1234);
+    Builder same_addr_rev = ipv4_flow(0x0A000001, 0x0A000001, 1234, 80);
+    unique_tmplt tmplt = fwd.tmplt();
+
+    const uint64_t hash_fwd = derive(plans.get(), fwd, tmplt.get()).hash;
+    EXPECT_EQ(hash_fwd, derive(plans.get(), rev, tmplt.get()).hash);
+    EXPECT_NE(hash_fwd, derive(plans.get(), other, tmplt.get()).hash);
+    EXPECT_EQ(derive(plans.get(), same_addr, tmplt.get()).hash,
+        derive(plans.get(), same_addr_rev, tmplt.get()).hash);
+}
+
+// Fields after a variable-length field, IPv6 addresses and high-precision timestamps
+TEST(FlowInfo, varlenIpv6)
+{
+    unique_plans plans(ipx_flow_plans_create(), &ipx_flow_plans_destroy);
+    ASSERT_NE(plans, nullptr);
+
+    std::vector<uint8_t> src6(16, 0);
+    std::vector<uint8_t> dst6(16, 0);
+    src6[0] = 0x20;
+    src6[15] = 1;
+    dst6[0] = 0x20;
+    dst6[15] = 2;
+
+    // NTP timestamp: 1.5 seconds after the Export Time
+    const uint64_t ntp = ((EXP_TIME + 2208988800ULL) << 32) | 0x80000000ULL;
+
+    Builder builder;
+    builder.add(82, {'e', 't', 'h', '0'}, true); // interfaceName
+    builder.add(27, src6);
+    builder.add(94, {'x'}, true);                // applicationDescription
+    builder.add(28, dst6);
+    builder.add(150, be(EXP_TIME, 4));           // less preferred than nanoseconds
+    builder.add(156, be(ntp, 8));
+    builder.add(159, be(250000, 4));             // 250 ms before the Export Time
+    unique_tmplt tmplt = builder.tmplt();
+    ASSERT_NE(tmplt, nullptr);
+    const struct ipx_flow_info info = derive(plans.get(), builder, tmplt.get());
+
+    EXPECT_EQ(info.flags, IPX_FLOW_ADDR | IPX_FLOW_START | IPX_FLOW_END);
+    EXPECT_EQ(memcmp(info.src_addr, src6.data(), 16), 0);
+    EXPECT_EQ(memcmp(info.dst_addr, dst6.data(), 16), 0);
+    EXPECT_EQ(info.src_port, 0);
+    EXPECT_EQ(info.start, EXP_TIME * 1000000000ULL + 500000000ULL);
+    EXPECT_EQ(info.end, EXP_TIME * 1000000000ULL - 250000000ULL);
+}
+
+// Uptime timestamps require the system initialization time
+TEST(FlowInfo, sysUpTime)
+{
+    unique_plans plans(ipx_flow_plans_create(), &ipx_flow_plans_destroy);
+    ASSERT_NE(plans, nullptr);
+
+    Builder without;
+    without.add(22, be(1000, 4));
+    without.add(21, be(3000, 4));
+    unique_tmplt tmplt1 = without.tmplt();
+    EXPECT_EQ(derive(plans.get(), without, tmplt1.get()).flags, 0);
+
+    Builder with;
+    with.add(22, be(1000, 4));
+    with.add(21, be(3000, 4));
+    with.add(160, be(EXP_TIME * 1000ULL, 8));
+    unique_tmplt tmplt2 = with.tmplt();
+    const struct ipx_flow_info info = derive(plans.get(), with, tmplt2.get());
+    EXPECT_EQ(info.flags, IPX_FLOW_START | IPX_FLOW_END);
+    EXPECT_EQ(info.start, (EXP_TIME * 1000ULL + 1000U) * 1000000ULL);
+    EXPECT_EQ(info.end, (EXP_TIME * 1000ULL + 3000U) * 1000000ULL);
+}
+
+// A cached plan must not be used for a different Template at the same address
+TEST(FlowInfo, templateReuse)
+{
+    unique_plans plans(ipx_flow_plans_create(), &ipx_flow_plans_destroy);
+    ASSERT_NE(plans, nullptr);
+
+    for (uint16_t port = 1; port <= 50; ++port) {
+        Builder builder;
+        // Different positions of the port in each iteration
+        for (uint16_t i = 0; i < port % 5; ++i) {
+            builder.add(1, be(i, 4));
+        }
+        builder.add(7, be(port, 2));
+        unique_tmplt tmplt = builder.tmplt();
+        const struct ipx_flow_info info = derive(plans.get(), builder, tmplt.get());
+        EXPECT_EQ(info.src_port, port);
+        EXPECT_EQ(info.flags, 0); // Destination port is missing
+    }
+}
+
+// Truncated variable-length fields must not be read
+TEST(FlowInfo, malformed)
+{
+    unique_plans plans(ipx_flow_plans_create(), &ipx_flow_plans_destroy);
+    ASSERT_NE(plans, nullptr);
+
+    Builder builder;
+    builder.add(4, be(17, 1));
+    builder.add(82, {'e', 't', 'h'}, true);
+    builder.add(7, be(53, 2));
+    unique_tmplt tmplt = builder.tmplt();
+
+    struct ipx_flow_info info;
+    struct fds_drec rec = builder.rec(tmplt.get());
+    rec.size = 3; // The record ends inside the string
+    ipx_flow_plans_begin(plans.get());
+    ASSERT_EQ(ipx_flow_info_fill(plans.get(), &rec, EXP_TIME, &info), IPX_OK);
+    EXPECT_EQ(info.flags, IPX_FLOW_PROTO);
+    EXPECT_EQ(info.src_port, 0);
+}
@@ -0,0 +1,106 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+
+extern "C" {
+    #include <core/ie_demand.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_demand = std::unique_ptr<ipx_ie_demand_t, decltype(&ipx_ie_demand_destroy)>;
+
+static unique_demand
+demand_new()
+{
+    unique_demand demand(ipx_ie_demand_create(), &ipx_ie_demand_destroy);
+    EXPECT_NE(demand, nullptr);
+    return demand;
+}
+
+TEST(IeDemand, empty)
+{
+    unique_demand demand = demand_new();
+    EXPECT_FALSE(ipx_ie_demand_is_all(demand.get()));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 0, 1));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 29305, 1));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 8057, 1000));
+}
+
+TEST(IeDemand, addIana)
+{
+    unique_demand demand = demand_new();
+    ASSERT_EQ(ipx_ie_demand_add(demand.get(), 0, 8), IPX_OK);
+    ASSERT_EQ(ipx_ie_demand_add(demand.get(), 0, 32767), IPX_OK);
+
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 0, 8));
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 0, 32767));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 0, 7));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 0, 9));
+    // Reverse elements are different elements
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 29305, 8));
+    // The enterprise bit is ignored
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 0, 0x8008));
+    EXPECT_FALSE(ipx_ie_demand_is_all(demand.get()));
+}
+
+TEST(IeDemand, addEnterprise)
+{
+    unique_demand demand = demand_new();
+    // Insert in a random order and with duplicates
+    const uint32_t pens[] = {8057, 29305, 6871, 8057, 29305, 1};
+    for (uint32_t pen : pens) {
+        ASSERT_EQ(ipx_ie_demand_add(demand.get(), pen, 10), IPX_OK);
+        ASSERT_EQ(ipx_ie_demand_add(demand.get(), pen, 5), IPX_OK);
+    }
+
+    for (uint32_t pen : pens) {
+        EXPECT_TRUE(ipx_ie_demand_has(demand.get(), pen, 5));
+        EXPECT_TRUE(ipx_ie_demand_has(demand.get(), pen, 10));
+        EXPECT_FALSE(ipx_ie_demand_has(demand.get(), pen, 6));
+    }
+
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 0, 10));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 2, 10));
+}
+
+TEST(IeDemand, all)
+{
+    unique_demand demand = demand_new();
+    ASSERT_EQ(ipx_ie_demand_add(demand.get(), 0, 1), IPX_OK);
+    ipx_ie_demand_add_all(demand.get());
+
+    EXPECT_TRUE(ipx_ie_demand_is_all(demand.get()));
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 0, 2));
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 8057, 100));
+}
+
+TEST(IeDemand, merge)
+{
+    unique_demand demand = demand_new();
+    unique_demand other = demand_new();
+    ASSERT_EQ(ipx_ie_demand_add(demand.get(), 0, 1), IPX_OK);
+    ASSERT_EQ(ipx_ie_demand_add(other.get(), 0, 2), IPX_OK);
+    ASSERT_EQ(ipx_ie_demand_add(other.get(), 8057, 3), IPX_OK);
+
+    ASSERT_EQ(ipx_ie_demand_merge(demand.get(), other.get()), IPX_OK);
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 0, 1));
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 0, 2));
+    EXPECT_TRUE(ipx_ie_demand_has(demand.get(), 8057, 3));
+    EXPECT_FALSE(ipx_ie_demand_has(demand.get(), 8057, 1));
+    EXPECT_FALSE(ipx_ie_demand_is_all(demand.get()));
+
+    // The other demand is not modified
+    EXPECT_FALSE(ipx_ie_demand_has(other.get(), 0, 1));
+
+    // NULL represents all Information Elements
+    ASSERT_EQ(ipx_ie_demand_merge(demand.get(), nullptr), IPX_OK);
+    EXPECT_TRUE(ipx_ie_demand_is_all(demand.get()));
+}
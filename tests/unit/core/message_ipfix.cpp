@@ -0,0 +1,156 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/message_ipfix.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+
+/** Size of the raw message (header + one Data Set with two 8 byte records) */
+static const uint16_t MSG_SIZE = FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN + 16U;
+
+/**
+ * \brief Create a message with one Data Set and two Data Records
+ *
+ * Records are not interpreted, therefore, no Template is required.
+ */
+static ipx_msg_ipfix_t *
+msg_create(const ipx_ctx_t *ctx)
+{
+    uint8_t *raw = static_cast<uint8_t *>(malloc(MSG_SIZE));
+    for (uint16_t i = 0; i < MSG_SIZE; ++i) {
+        raw[i] = static_cast<uint8_t>(i);
+    }
+
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = nullptr;
+    msg_ctx.odid = 10;
+    msg_ctx.stream = 0;
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, raw, MSG_SIZE);
+    EXPECT_NE(msg, nullptr);
+
+    struct ipx_ipfix_set *set = ipx_msg_ipfix_add_set_ref(msg);
+    EXPECT_NE(set, nullptr);
+    set->ptr = reinterpret_cast<struct fds_ipfix_set_hdr *>(raw + FDS_IPFIX_MSG_HDR_LEN);
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_add_drec_ref(&msg);
+        EXPECT_NE(rec, nullptr);
+        rec->rec.data = raw + FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN + (i * 8U);
+        rec->rec.size = 8;
+        rec->rec.tmplt = nullptr;
+        rec->rec.snap = nullptr;
+        rec->ext_mask = i + 1;
+    }
+
+    return msg;
+}
+
+// A message used only by one instance is never copied
+TEST(MsgIpfixUnshare, notShared)
+{
+    unique_ctx ctx(ipx_ctx_create("test", nullptr), &ipx_ctx_destroy);
+    ASSERT_NE(ctx, nullptr);
+
+    ipx_msg_ipfix_t *msg = msg_create(ctx.get());
+    EXPECT_EQ(ipx_msg_ipfix_unshare(msg), msg);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// A shared message is copied and all references point to the copy of the raw message
+TEST(MsgIpfixUnshare, shared)
+{
+    unique_ctx ctx(ipx_ctx_create("test", nullptr), &ipx_ctx_destroy);
+    ASSERT_NE(ctx, nullptr);
+
+    ipx_msg_ipfix_t *msg = msg_create(ctx.get());
+    ipx_msg_header_cnt_share(ipx_msg_ipfix2base(msg), 2);
+
+    ipx_msg_ipfix_t *copy = ipx_msg_ipfix_unshare(msg);
+    ASSERT_NE(copy, nullptr);
+    ASSERT_NE(copy, msg);
+    EXPECT_FALSE(ipx_msg_header_is_shared(ipx_msg_ipfix2base(copy)));
+    EXPECT_FALSE(ipx_msg_header_is_shared(ipx_msg_ipfix2base(msg))); // One reference released
+
+    uint8_t *raw_orig = ipx_msg_ipfix_get_packet(msg);
+    uint8_t *raw_copy = ipx_msg_ipfix_get_packet(copy);
+    ASSERT_NE(raw_copy, raw_orig);
+    EXPECT_EQ(memcmp(raw_copy, raw_orig, MSG_SIZE), 0);
+    EXPECT_EQ(ipx_msg_ipfix_get_ctx(copy)->odid, 10U);
+
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(copy, &sets, &sets_cnt);
+    ASSERT_EQ(sets_cnt, 1U);
+    EXPECT_EQ(reinterpret_cast<uint8_t *>(sets[0].ptr), raw_copy + FDS_IPFIX_MSG_HDR_LEN);
+
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(copy), 2U);
+    for (uint32_t i = 0; i < 2; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(copy, i);
+        EXPECT_EQ(rec->rec.data, raw_copy + FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN + i * 8);
+        EXPECT_EQ(rec->ext_mask, i + 1U);
+    }
+
+    // Modification of the copy is not visible to the original message
+    raw_copy[FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN] ^= 0xFF;
+    EXPECT_NE(ipx_msg_ipfix_get_drec(msg, 0)->rec.data[0],
+        ipx_msg_ipfix_get_drec(copy, 0)->rec.data[0]);
+
+    ipx_msg_ipfix_destroy(copy);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Segments of the raw message are merged into a contiguous copy
+TEST(MsgIpfixUnshare, segmented)
+{
+    unique_ctx ctx(ipx_ctx_create("test", nullptr), &ipx_ctx_destroy);
+    ASSERT_NE(ctx, nullptr);
+
+    // The new message consists of a new header and the Data Set of the original message
+    ipx_msg_ipfix_t *msg = msg_create(ctx.get());
+    uint8_t *raw_orig = ipx_msg_ipfix_get_packet(msg);
+    uint8_t *hdr = static_cast<uint8_t *>(calloc(1, FDS_IPFIX_MSG_HDR_LEN));
+    struct iovec iov[2];
+    iov[0].iov_base = hdr;
+    iov[0].iov_len = FDS_IPFIX_MSG_HDR_LEN;
+    iov[1].iov_base = raw_orig + FDS_IPFIX_MSG_HDR_LEN;
+    iov[1].iov_len = MSG_SIZE - FDS_IPFIX_MSG_HDR_LEN;
+    ASSERT_EQ(ipx_msg_ipfix_raw_replace_segs(msg, hdr, iov, 2), IPX_OK);
+    ipx_msg_header_cnt_share(ipx_msg_ipfix2base(msg), 3);
+
+    ipx_msg_ipfix_t *copy = ipx_msg_ipfix_unshare(msg);
+    ASSERT_NE(copy, nullptr);
+
+    const struct iovec *copy_iov;
+    size_t copy_iov_cnt;
+    ipx_msg_ipfix_get_segs(copy, &copy_iov, &copy_iov_cnt);
+    ASSERT_EQ(copy_iov_cnt, 1U);
+    ASSERT_EQ(copy_iov[0].iov_len, MSG_SIZE);
+
+    uint8_t *raw_copy = ipx_msg_ipfix_get_packet(copy);
+    EXPECT_EQ(copy_iov[0].iov_base, raw_copy);
+    EXPECT_EQ(memcmp(raw_copy, hdr, FDS_IPFIX_MSG_HDR_LEN), 0);
+    EXPECT_EQ(memcmp(raw_copy + FDS_IPFIX_MSG_HDR_LEN, raw_orig + FDS_IPFIX_MSG_HDR_LEN,
+        MSG_SIZE - FDS_IPFIX_MSG_HDR_LEN), 0);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(copy, 1)->rec.data,
+        raw_copy + FDS_IPFIX_MSG_HDR_LEN + FDS_IPFIX_SET_HDR_LEN + 8);
+
+    ipx_msg_ipfix_destroy(copy);
+    ipx_msg_ipfix_destroy(msg); // Still used by another branch
+    EXPECT_FALSE(ipx_msg_header_is_shared(ipx_msg_ipfix2base(msg)));
+    ipx_msg_ipfix_destroy(msg);
+}
@@ -1,6 +1,7 @@
 #include <arpa/inet.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <vector>
 
 #include <ipfixcol2.h>
 #include <libfds/ipfix_parsers.h>
@@ -86,6 +87,34 @@ protected:
         ASSERT_NE(m_msg, nullptr);
     }
 
+    /**
+     * @brief Get the converted IPFIX Message as a continuous block of memory
+     *
+     * The converted message can consist of multiple segments (unmodified NetFlow Data FlowSets
+     * are only referenced), therefore, all segments are copied into an internal buffer.
+     * @return Pointer to the IPFIX Message (valid until the next call)
+     */
+    uint8_t *
+    msg_flatten()
+    {
+        const struct iovec *iov;
+        size_t iov_cnt;
+        ipx_msg_ipfix_get_segs(m_msg.get(), &iov, &iov_cnt);
+        EXPECT_GE(iov_cnt, 1U);
+        EXPECT_EQ(iov[0].iov_base, ipx_msg_ipfix_get_packet(m_msg.get()));
+        EXPECT_GE(iov[0].iov_len, FDS_IPFIX_MSG_HDR_LEN);
+
+        m_flat.clear();
+        for (size_t i = 0; i < iov_cnt; ++i) {
+            const uint8_t *seg = reinterpret_cast<const uint8_t *>(iov[i].iov_base);
+            m_flat.insert(m_flat.end(), seg, seg + iov[i].iov_len);
+        }
+
+        const auto *hdr = reinterpret_cast<const struct fds_ipfix_msg_hdr *>(m_flat.data());
+        EXPECT_EQ(ntohs(hdr->length), m_flat.size());
+        return m_flat.data();
+    }
+
     std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>
     parse_template(const fds_tset_iter &it, enum fds_template_type type)
     {
@@ -113,6 +142,8 @@ protected:
     // NetFlow v5 to IPFIX converter
     std::unique_ptr<ipx_nf9_conv_t, decltype(&ipx_nf9_conv_destroy)>
         m_conv = {nullptr, &ipx_nf9_conv_destroy};
+    // Copy of the (possibly segmented) converted IPFIX Message
+    std::vector<uint8_t> m_flat;
 };
 
 class Rec_base {
@@ -714,7 +745,7 @@ TEST_F(MsgBase, emptyMessage)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Check the IPFIX Message
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     const auto *ipfix_hdr = reinterpret_cast<const struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_EQ(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -785,7 +816,7 @@ TEST_F(MsgBase, oneTemplateOneDataRecord)
                 ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
                 // Try to parse the message
-                msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+                msg_data = msg_flatten();
                 auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
                 EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
                 EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -888,7 +919,7 @@ TEST_F(MsgBase, oneOptionsTemplateOneDataRecord)
                 ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
                 // Try to parse the message
-                msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+                msg_data = msg_flatten();
                 auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
                 EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
                 EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -961,7 +992,7 @@ TEST_F(MsgBase, unsupportedOptionsTemplateRecord)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the message
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1025,7 +1056,7 @@ TEST_F(MsgBase, onlyTemplatesInMsg)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1121,7 +1152,7 @@ TEST_F(MsgBase, simpleMessageSequence)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1187,7 +1218,7 @@ TEST_F(MsgBase, simpleMessageSequence)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1266,7 +1297,7 @@ TEST_F(MsgBase, simpleMessageSequence)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1362,7 +1393,7 @@ TEST_F(MsgBase, templateRefresh)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1445,7 +1476,7 @@ TEST_F(MsgBase, templateRefresh)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1550,7 +1581,7 @@ TEST_F(MsgBase, templateRedefine)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1629,7 +1660,7 @@ TEST_F(MsgBase, templateRedefine)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1729,7 +1760,7 @@ TEST_F(MsgBase, missingTemplateDefinitions)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1776,7 +1807,7 @@ TEST_F(MsgBase, missingTemplateDefinitions)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1851,7 +1882,7 @@ TEST_F(MsgBase, missingTemplateDefinitions)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1936,7 +1967,7 @@ TEST_F(MsgBase, outOfOrderMessages)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -1990,7 +2021,7 @@ TEST_F(MsgBase, outOfOrderMessages)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -2037,7 +2068,7 @@ TEST_F(MsgBase, outOfOrderMessages)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_EQ(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -2066,7 +2097,7 @@ TEST_F(MsgBase, outOfOrderMessages)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the header
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -2145,7 +2176,7 @@ TEST_F(MsgBase, unknownFlowSets)
     ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
 
     // Try to parse the message
-    msg_data = ipx_msg_ipfix_get_packet(m_msg.get());
+    msg_data = msg_flatten();
     auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr*>(msg_data);
     EXPECT_EQ(ntohs(ipfix_hdr->version), FDS_IPFIX_VERSION);
     EXPECT_GE(ntohs(ipfix_hdr->length), FDS_IPFIX_MSG_HDR_LEN);
@@ -2621,4 +2652,245 @@ TEST_F(MsgBase, unexpectedEndOfDataSet)
     }
 
     free(msg_data);
-}
\ No newline at end of file
+}
+// -----------------------------------------------------------------------------
+// Segmented messages (Data FlowSets that need no conversion are only referenced)
+
+/// Maximum number of references to the NetFlow Message (see CONV_REFS_MAX in netflow9.c)
+static const size_t REFS_MAX = 64U;
+
+// Converted message without any references consists of a single segment
+TEST_F(MsgBase, segmentsNoReference)
+{
+    const uint32_t VALUE_EXPORT = 1562857357U; // 2019-07-11T15:02:37+00:00
+    const uint32_t VALUE_UPTIME = 10001;
+    const uint32_t VALUE_ODID = 10;
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), VALUE_ODID, 0};
+
+    uint16_t tid = 256;
+    Rec_norm_basic rec(tid); // Timestamps must be converted
+
+    nf9_set nf9_tset(IPX_NF9_SET_TMPLT);
+    nf9_tset.add_rec(rec.get_nf9_template());
+    nf9_set nf9_dset(tid);
+    nf9_dset.add_rec(rec.get_nf9_record());
+    nf9_msg nf9;
+    nf9.set_odid(VALUE_ODID);
+    nf9.set_time_unix(VALUE_EXPORT);
+    nf9.set_time_uptime(VALUE_UPTIME);
+    nf9.add_set(nf9_tset);
+    nf9.add_set(nf9_dset);
+
+    uint16_t msg_size = nf9.size();
+    uint8_t *msg_data = (uint8_t *) nf9.release();
+    prepare_msg(&msg_ctx, msg_data, msg_size);
+    ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+
+    const struct iovec *iov = nullptr;
+    size_t iov_cnt = 0;
+    ipx_msg_ipfix_get_segs(m_msg.get(), &iov, &iov_cnt);
+    ASSERT_EQ(iov_cnt, 1U);
+    uint8_t *packet = ipx_msg_ipfix_get_packet(m_msg.get());
+    EXPECT_EQ(iov[0].iov_base, packet);
+    const auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(packet);
+    EXPECT_EQ(iov[0].iov_len, ntohs(ipfix_hdr->length));
+
+    // Output parameters are optional
+    const struct iovec *iov_only = nullptr;
+    size_t cnt_only = 0;
+    ipx_msg_ipfix_get_segs(m_msg.get(), &iov_only, nullptr);
+    ipx_msg_ipfix_get_segs(m_msg.get(), nullptr, &cnt_only);
+    EXPECT_EQ(iov_only, iov);
+    EXPECT_EQ(cnt_only, 1U);
+}
+
+// Data FlowSets of identity Templates are referenced in the original NetFlow Message
+TEST_F(MsgBase, segmentsIdentityReference)
+{
+    const uint32_t VALUE_EXPORT = 1562857357U; // 2019-07-11T15:02:37+00:00
+    const uint32_t VALUE_UPTIME = 10001;
+    const uint32_t VALUE_ODID = 10;
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), VALUE_ODID, 0};
+
+    uint16_t tid_ident = 256;
+    uint16_t tid_conv = 257;
+    Rec_norm_nots rec_ident(tid_ident); // The same NetFlow and IPFIX record
+    Rec_norm_basic rec_conv(tid_conv);  // Timestamps must be converted
+
+    nf9_set nf9_tset(IPX_NF9_SET_TMPLT);
+    nf9_tset.add_rec(rec_ident.get_nf9_template());
+    nf9_tset.add_rec(rec_conv.get_nf9_template());
+    nf9_set nf9_dset1(tid_ident);
+    nf9_dset1.add_rec(rec_ident.get_nf9_record());
+    nf9_dset1.add_rec(rec_ident.get_nf9_record());
+    nf9_dset1.add_padding(3);
+    nf9_set nf9_dset2(tid_conv);
+    nf9_dset2.add_rec(rec_conv.get_nf9_record());
+    nf9_set nf9_dset3(tid_ident);
+    nf9_dset3.add_rec(rec_ident.get_nf9_record());
+
+    nf9_msg nf9;
+    nf9.set_odid(VALUE_ODID);
+    nf9.set_time_unix(VALUE_EXPORT);
+    nf9.set_time_uptime(VALUE_UPTIME);
+    nf9.add_set(nf9_tset);
+    nf9.add_set(nf9_dset1);
+    nf9.add_set(nf9_dset2);
+    nf9.add_set(nf9_dset3);
+
+    uint16_t msg_size = nf9.size();
+    uint8_t *msg_data = (uint8_t *) nf9.release();
+    prepare_msg(&msg_ctx, msg_data, msg_size);
+    ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+
+    // Header + Template Set | ref. to FlowSet 1 | converted FlowSet 2 | ref. to FlowSet 3
+    const struct iovec *iov = nullptr;
+    size_t iov_cnt = 0;
+    ipx_msg_ipfix_get_segs(m_msg.get(), &iov, &iov_cnt);
+    ASSERT_EQ(iov_cnt, 4U);
+
+    // The original NetFlow Message is still owned by the wrapper
+    const uint8_t *dset1 = msg_data + IPX_NF9_MSG_HDR_LEN + nf9_tset.size();
+    const uint8_t *dset3 = dset1 + nf9_dset1.size() + nf9_dset2.size();
+    EXPECT_EQ(iov[1].iov_base, dset1);
+    EXPECT_EQ(iov[1].iov_len, nf9_dset1.size());
+    EXPECT_EQ(iov[3].iov_base, dset3);
+    EXPECT_EQ(iov[3].iov_len, nf9_dset3.size());
+    for (size_t i : {0U, 2U}) {
+        const uint8_t *seg = reinterpret_cast<const uint8_t *>(iov[i].iov_base);
+        EXPECT_TRUE(seg + iov[i].iov_len <= msg_data || seg >= msg_data + msg_size) << i;
+    }
+
+    // Parse the whole message
+    msg_data = msg_flatten();
+    auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(msg_data);
+    EXPECT_EQ(ntohl(ipfix_hdr->odid), VALUE_ODID);
+    EXPECT_EQ(ntohl(ipfix_hdr->export_time), VALUE_EXPORT);
+
+    struct fds_sets_iter it_set;
+    fds_sets_iter_init(&it_set, ipfix_hdr);
+    ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+    ASSERT_EQ(ntohs(it_set.set->flowset_id), FDS_IPFIX_SET_TMPLT);
+    fds_tset_iter it_tset;
+    fds_tset_iter_init(&it_tset, it_set.set);
+    ASSERT_EQ(fds_tset_iter_next(&it_tset), FDS_OK);
+    auto tmplt_ident = parse_template(it_tset, FDS_TYPE_TEMPLATE);
+    rec_ident.compare_template(tmplt_ident.get());
+    ASSERT_EQ(fds_tset_iter_next(&it_tset), FDS_OK);
+    auto tmplt_conv = parse_template(it_tset, FDS_TYPE_TEMPLATE);
+    rec_conv.compare_template(tmplt_conv.get());
+    EXPECT_EQ(fds_tset_iter_next(&it_tset), FDS_EOC);
+
+    // Data Sets in the original order
+    struct {
+        uint16_t tid;
+        Rec_base *rec;
+        struct fds_template *tmplt;
+        unsigned int rec_cnt;
+    } dsets[] = {
+        {tid_ident, &rec_ident, tmplt_ident.get(), 2},
+        {tid_conv, &rec_conv, tmplt_conv.get(), 1},
+        {tid_ident, &rec_ident, tmplt_ident.get(), 1}
+    };
+
+    for (const auto &dset : dsets) {
+        ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+        ASSERT_EQ(ntohs(it_set.set->flowset_id), dset.tid);
+        struct fds_dset_iter it_dset;
+        fds_dset_iter_init(&it_dset, it_set.set, dset.tmplt);
+        for (unsigned int i = 0; i < dset.rec_cnt; ++i) {
+            ASSERT_EQ(fds_dset_iter_next(&it_dset), FDS_OK);
+            struct fds_drec drec = {it_dset.rec, it_dset.size, dset.tmplt, nullptr};
+            dset.rec->compare_data(&drec, VALUE_EXPORT, VALUE_UPTIME);
+        }
+        EXPECT_EQ(fds_dset_iter_next(&it_dset), FDS_EOC);
+    }
+    EXPECT_EQ(fds_sets_iter_next(&it_set), FDS_EOC);
+
+    // Referenced records are counted in the sequence number of the next message
+    nf9_msg nf9_next;
+    nf9_next.set_odid(VALUE_ODID);
+    nf9_next.set_seq(1);
+    nf9_next.set_time_unix(VALUE_EXPORT);
+    nf9_next.set_time_uptime(VALUE_UPTIME);
+    msg_size = nf9_next.size();
+    msg_data = (uint8_t *) nf9_next.release();
+    prepare_msg(&msg_ctx, msg_data, msg_size);
+    ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+    ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(msg_flatten());
+    EXPECT_EQ(ntohl(ipfix_hdr->seq_num), 4U);
+}
+
+// When the maximum number of references is reached, remaining FlowSets are copied
+TEST_F(MsgBase, segmentsReferenceLimit)
+{
+    const uint32_t VALUE_EXPORT = 1562857357U; // 2019-07-11T15:02:37+00:00
+    const uint32_t VALUE_UPTIME = 10001;
+    const uint32_t VALUE_ODID = 10;
+    const size_t DSET_CNT = REFS_MAX + 6U;
+    struct ipx_msg_ctx msg_ctx = {m_session.get(), VALUE_ODID, 0};
+
+    uint16_t tid = 256;
+    Rec_norm_nots rec(tid);
+
+    nf9_set nf9_tset(IPX_NF9_SET_TMPLT);
+    nf9_tset.add_rec(rec.get_nf9_template());
+    nf9_set nf9_dset(tid);
+    nf9_dset.add_rec(rec.get_nf9_record());
+
+    nf9_msg nf9;
+    nf9.set_odid(VALUE_ODID);
+    nf9.set_time_unix(VALUE_EXPORT);
+    nf9.set_time_uptime(VALUE_UPTIME);
+    nf9.add_set(nf9_tset);
+    for (size_t i = 0; i < DSET_CNT; ++i) {
+        nf9.add_set(nf9_dset);
+    }
+
+    uint16_t msg_size = nf9.size();
+    uint8_t *msg_data = (uint8_t *) nf9.release();
+    prepare_msg(&msg_ctx, msg_data, msg_size);
+    ASSERT_EQ(ipx_nf9_conv_process(m_conv.get(), m_msg.get()), IPX_OK);
+
+    // Header + Template Set | REFS_MAX references | copies of the remaining FlowSets
+    const struct iovec *iov = nullptr;
+    size_t iov_cnt = 0;
+    ipx_msg_ipfix_get_segs(m_msg.get(), &iov, &iov_cnt);
+    ASSERT_EQ(iov_cnt, REFS_MAX + 2U);
+
+    const uint8_t *dset = msg_data + IPX_NF9_MSG_HDR_LEN + nf9_tset.size();
+    for (size_t i = 1; i <= REFS_MAX; ++i) {
+        EXPECT_EQ(iov[i].iov_base, dset) << i;
+        EXPECT_EQ(iov[i].iov_len, nf9_dset.size()) << i;
+        dset += nf9_dset.size();
+    }
+
+    const uint8_t *last = reinterpret_cast<const uint8_t *>(iov[REFS_MAX + 1U].iov_base);
+    EXPECT_TRUE(last >= msg_data + msg_size || last + iov[REFS_MAX + 1U].iov_len <= msg_data);
+    EXPECT_EQ(iov[REFS_MAX + 1U].iov_len, (DSET_CNT - REFS_MAX) * nf9_dset.size());
+
+    // All records are present (referenced and copied)
+    msg_data = msg_flatten();
+    auto *ipfix_hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(msg_data);
+    struct fds_sets_iter it_set;
+    fds_sets_iter_init(&it_set, ipfix_hdr);
+    ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+    ASSERT_EQ(ntohs(it_set.set->flowset_id), FDS_IPFIX_SET_TMPLT);
+    fds_tset_iter it_tset;
+    fds_tset_iter_init(&it_tset, it_set.set);
+    ASSERT_EQ(fds_tset_iter_next(&it_tset), FDS_OK);
+    auto tmplt = parse_template(it_tset, FDS_TYPE_TEMPLATE);
+
+    for (size_t i = 0; i < DSET_CNT; ++i) {
+        SCOPED_TRACE("Data Set index: " + std::to_string(i));
+        ASSERT_EQ(fds_sets_iter_next(&it_set), FDS_OK);
+        ASSERT_EQ(ntohs(it_set.set->flowset_id), tid);
+        struct fds_dset_iter it_dset;
+        fds_dset_iter_init(&it_dset, it_set.set, tmplt.get());
+        ASSERT_EQ(fds_dset_iter_next(&it_dset), FDS_OK);
+        struct fds_drec drec = {it_dset.rec, it_dset.size, tmplt.get(), nullptr};
+        rec.compare_data(&drec, VALUE_EXPORT, VALUE_UPTIME);
+        EXPECT_EQ(fds_dset_iter_next(&it_dset), FDS_EOC);
+    }
+    EXPECT_EQ(fds_sets_iter_next(&it_set), FDS_EOC);
+}
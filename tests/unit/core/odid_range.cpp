@@ -0,0 +1,116 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+
+extern "C" {
+    #include <core/odid_range.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_orange = std::unique_ptr<ipx_orange_t, decltype(&ipx_orange_destroy)>;
+
+static unique_orange
+orange_new(const char *expr = nullptr)
+{
+    unique_orange range(ipx_orange_create(), &ipx_orange_destroy);
+    EXPECT_NE(range, nullptr);
+    if (expr != nullptr) {
+        EXPECT_EQ(ipx_orange_parse(range.get(), expr), IPX_OK);
+    }
+    return range;
+}
+
+TEST(OdidRange, parse)
+{
+    unique_orange range = orange_new("1-5, 7, 10-");
+    EXPECT_FALSE(ipx_orange_in(range.get(), 0));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 1));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 5));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 6));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 7));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 9));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 10));
+    EXPECT_TRUE(ipx_orange_in(range.get(), UINT32_MAX));
+    EXPECT_FALSE(ipx_orange_full(range.get()));
+}
+
+TEST(OdidRange, parseOverlapping)
+{
+    unique_orange range = orange_new("-10, 5-20, 21-");
+    EXPECT_TRUE(ipx_orange_full(range.get()));
+}
+
+TEST(OdidRange, parseInvalid)
+{
+    unique_orange range = orange_new();
+    EXPECT_EQ(ipx_orange_parse(range.get(), "1-a"), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_orange_parse(range.get(), "10-5"), IPX_ERR_FORMAT);
+}
+
+TEST(OdidRange, addOnly)
+{
+    unique_orange range = orange_new();
+    unique_orange filter1 = orange_new("1-5");
+    unique_orange filter2 = orange_new("4-8, 100");
+
+    EXPECT_FALSE(ipx_orange_in(range.get(), 1));
+    ASSERT_EQ(ipx_orange_add(range.get(), IPX_ODID_FILTER_ONLY, filter1.get()), IPX_OK);
+    ASSERT_EQ(ipx_orange_add(range.get(), IPX_ODID_FILTER_ONLY, filter2.get()), IPX_OK);
+
+    EXPECT_FALSE(ipx_orange_in(range.get(), 0));
+    for (uint32_t odid = 1; odid <= 8; ++odid) {
+        EXPECT_TRUE(ipx_orange_in(range.get(), odid));
+    }
+    EXPECT_FALSE(ipx_orange_in(range.get(), 9));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 99));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 100));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 101));
+    EXPECT_FALSE(ipx_orange_full(range.get()));
+}
+
+TEST(OdidRange, addExcept)
+{
+    unique_orange range = orange_new("5");
+    unique_orange filter = orange_new("0, 3-10, 20-");
+
+    ASSERT_EQ(ipx_orange_add(range.get(), IPX_ODID_FILTER_EXCEPT, filter.get()), IPX_OK);
+    EXPECT_FALSE(ipx_orange_in(range.get(), 0));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 1));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 2));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 3));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 5));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 10));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 11));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 19));
+    EXPECT_FALSE(ipx_orange_in(range.get(), 20));
+    EXPECT_FALSE(ipx_orange_in(range.get(), UINT32_MAX));
+}
+
+TEST(OdidRange, addComplement)
+{
+    // Union of a filter and its complement is the whole range
+    unique_orange range = orange_new();
+    unique_orange filter = orange_new("10-20, 30");
+
+    ASSERT_EQ(ipx_orange_add(range.get(), IPX_ODID_FILTER_ONLY, filter.get()), IPX_OK);
+    EXPECT_FALSE(ipx_orange_full(range.get()));
+    ASSERT_EQ(ipx_orange_add(range.get(), IPX_ODID_FILTER_EXCEPT, filter.get()), IPX_OK);
+    EXPECT_TRUE(ipx_orange_full(range.get()));
+}
+
+TEST(OdidRange, addNone)
+{
+    unique_orange range = orange_new();
+    ASSERT_EQ(ipx_orange_add(range.get(), IPX_ODID_FILTER_NONE, nullptr), IPX_OK);
+    EXPECT_TRUE(ipx_orange_full(range.get()));
+    EXPECT_TRUE(ipx_orange_in(range.get(), 0));
+    EXPECT_TRUE(ipx_orange_in(range.get(), UINT32_MAX));
+}
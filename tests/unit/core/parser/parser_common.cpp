@@ -161,5 +161,93 @@ TEST_P(Common, simple)
     ipx_msg_ipfix_destroy(ipfix_msg);
 }
 
+// Deferred splitting of Data Sets (fixed and variable length records)
+TEST_P(Common, splitDefer)
+{
+    const uint16_t tid_fixed = 256;
+    const uint16_t tid_var = 257;
+    ipfix_trec trec_fixed(tid_fixed);
+    trec_fixed.add_field(1, 4);  // bytes
+    trec_fixed.add_field(2, 4);  // packets
+    ipfix_trec trec_var(tid_var);
+    trec_var.add_field(1, 4);    // bytes
+    trec_var.add_field(82, ipfix_trec::SIZE_VAR); // interfaceName
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec_fixed);
+    set_tmplts.add_rec(trec_var);
+
+    ipfix_set set_fixed(tid_fixed);
+    for (uint64_t i = 0; i < 3; ++i) {
+        ipfix_drec drec;
+        drec.append_uint(100 + i, 4);
+        drec.append_uint(i, 4);
+        set_fixed.add_rec(drec);
+    }
+
+    ipfix_set set_var(tid_var);
+    for (uint64_t i = 0; i < 2; ++i) {
+        ipfix_drec drec;
+        drec.append_uint(200 + i, 4);
+        drec.append_string(std::string(i + 1, 'a'));
+        set_var.add_rec(drec);
+    }
+
+    ipfix_set set_unknown(300); // Missing template
+    ipfix_drec drec_unknown;
+    drec_unknown.append_uint(0, 4);
+    set_unknown.add_rec(drec_unknown);
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_fixed);
+    msg.add_set(set_var);
+    msg.add_set(set_unknown);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_parser_split_defer(parser, true);
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+
+    // Templates of Data Sets must be available without splitting
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(ipfix_msg, &sets, &sets_cnt);
+    ASSERT_EQ(sets_cnt, 4U);
+    EXPECT_EQ(sets[0].tmplt, nullptr);
+    ASSERT_NE(sets[1].tmplt, nullptr);
+    EXPECT_EQ(sets[1].tmplt->id, tid_fixed);
+    EXPECT_NE(sets[1].snap, nullptr);
+    ASSERT_NE(sets[2].tmplt, nullptr);
+    EXPECT_EQ(sets[2].tmplt->id, tid_var);
+    EXPECT_EQ(sets[3].tmplt, nullptr);
+
+    // Records are split on demand
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 5U);
+    const uint64_t expected[] = {100, 101, 102, 200, 201};
+    for (uint32_t i = 0; i < 5; ++i) {
+        ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        ASSERT_NE(rec, nullptr);
+        EXPECT_EQ(rec->ext_mask, 0U);
+
+        fds_drec_field field;
+        ASSERT_GE(fds_drec_find(&rec->rec, 0, 1, &field), 0); // bytes
+        uint64_t value;
+        ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+        EXPECT_EQ(value, expected[i]);
+    }
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(ipfix_msg, 5), nullptr);
+
+    ipx_msg_ipfix_destroy(ipfix_msg);
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+}
+
 
 // Max message (65000 records in one message)...
\ No newline at end of file
@@ -0,0 +1,228 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+extern "C" {
+    #include <core/replicator.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_repl = std::unique_ptr<ipx_repl_t, decltype(&ipx_repl_destroy)>;
+using unique_session = std::unique_ptr<struct ipx_session, decltype(&ipx_session_destroy)>;
+using unique_tmgr = std::unique_ptr<fds_tmgr_t, decltype(&fds_tmgr_destroy)>;
+
+/** Template (ID 256): sourceIPv4Address, destinationIPv4Address */
+static const uint8_t TMPLT_DATA[] = {
+    0x01, 0x00, 0x00, 0x02,
+    0x00, 0x08, 0x00, 0x04,
+    0x00, 0x0C, 0x00, 0x04
+};
+
+/** Options Template (ID 257): scope observationDomainId, exportedMessageTotalCount */
+static const uint8_t TMPLT_OPTS[] = {
+    0x01, 0x01, 0x00, 0x02, 0x00, 0x01,
+    0x00, 0x95, 0x00, 0x04,
+    0x00, 0x29, 0x00, 0x08
+};
+
+/** Primary and standby replicators connected via a Unix domain socket */
+class Replicator : public ::testing::Test {
+protected:
+    std::string path;
+    unique_repl standby{nullptr, &ipx_repl_destroy};
+    unique_repl primary{nullptr, &ipx_repl_destroy};
+
+    void SetUp() override {
+        path = "/tmp/ipfixcol2_repl_test_" + std::to_string(getpid()) + ".sock";
+        standby_start();
+
+        struct ipx_repl_cfg cfg = {IPX_REPL_PRIMARY, path.c_str(), nullptr, 0};
+        primary.reset(ipx_repl_create("primary", &cfg));
+        ASSERT_NE(primary, nullptr);
+        EXPECT_EQ(ipx_repl_role_get(primary.get()), IPX_REPL_PRIMARY);
+    }
+
+    void TearDown() override {
+        primary.reset();
+        standby.reset();
+        EXPECT_NE(access(path.c_str(), F_OK), 0); // The socket must be removed
+    }
+
+    /** Create a standby replicator */
+    void standby_start() {
+        struct ipx_repl_cfg cfg = {IPX_REPL_STANDBY, path.c_str(), nullptr, 0};
+        standby.reset(ipx_repl_create("standby", &cfg));
+        ASSERT_NE(standby, nullptr);
+        EXPECT_EQ(ipx_repl_role_get(standby.get()), IPX_REPL_STANDBY);
+    }
+
+    /** Wait (at most 5 seconds) until a condition is true */
+    static bool wait_for(const std::function<bool()> &cond) {
+        for (int i = 0; i < 500; ++i) {
+            if (cond()) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    /** Create an UDP Transport Session of an exporter */
+    static unique_session session(const char *addr, uint16_t port_src, uint16_t port_dst = 4739) {
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = port_src;
+        net.port_dst = port_dst;
+        EXPECT_EQ(inet_pton(AF_INET, addr, &net.addr_src.ipv4), 1);
+        EXPECT_EQ(inet_pton(AF_INET, "192.168.0.1", &net.addr_dst.ipv4), 1);
+        return unique_session(ipx_session_new_udp(&net, 0, 0), &ipx_session_destroy);
+    }
+
+    /** Result of seeding a new template manager */
+    struct seed_result {
+        bool seq_valid;
+        uint32_t seq_num;
+        unsigned int tmplts;
+        bool has_tmplt;
+        bool has_opts;
+    };
+
+    /** Seed a new template manager with the replicated state of a session */
+    seed_result seed(const struct ipx_session *s, uint32_t odid) {
+        seed_result res = {false, 0, 0, false, false};
+        unique_tmgr tmgr(fds_tmgr_create(FDS_SESSION_UDP), &fds_tmgr_destroy);
+        EXPECT_NE(tmgr, nullptr);
+        EXPECT_EQ(fds_tmgr_set_time(tmgr.get(), 1000), FDS_OK);
+
+        res.seq_valid = ipx_repl_seed(standby.get(), s, odid, tmgr.get(), &res.seq_num,
+            &res.tmplts);
+        const struct fds_template *tmplt;
+        res.has_tmplt = fds_tmgr_template_get(tmgr.get(), 256, &tmplt) == FDS_OK;
+        res.has_opts = fds_tmgr_template_get(tmgr.get(), 257, &tmplt) == FDS_OK;
+        return res;
+    }
+
+    /** Wait for a connection and send the full state of a session */
+    void send_state(const struct ipx_session *s, uint32_t odid, uint32_t seq_num) {
+        ASSERT_TRUE(wait_for([this]() { return ipx_repl_resync_needed(primary.get()); }));
+        // The request is cleared
+        EXPECT_FALSE(ipx_repl_resync_needed(primary.get()));
+
+        ipx_repl_reset(primary.get());
+        ipx_repl_session(primary.get(), s);
+        ipx_repl_tmplt(primary.get(), s, odid, FDS_TYPE_TEMPLATE, TMPLT_DATA, sizeof(TMPLT_DATA));
+        ipx_repl_tmplt(primary.get(), s, odid, FDS_TYPE_TEMPLATE_OPTS, TMPLT_OPTS,
+            sizeof(TMPLT_OPTS));
+        ipx_repl_seq(primary.get(), s, odid, seq_num);
+    }
+};
+
+// Templates and sequence numbers are delivered to the standby
+TEST_F(Replicator, delivery)
+{
+    unique_session s = session("10.0.0.1", 50000);
+    ASSERT_NE(s, nullptr);
+    send_state(s.get(), 1, 1000);
+
+    ASSERT_TRUE(wait_for([&]() { return seed(s.get(), 1).seq_valid; }));
+    seed_result res = seed(s.get(), 1);
+    EXPECT_EQ(res.seq_num, 1000U);
+    EXPECT_EQ(res.tmplts, 2U);
+    EXPECT_TRUE(res.has_tmplt);
+    EXPECT_TRUE(res.has_opts);
+
+    // Updates after the full state
+    ipx_repl_seq(primary.get(), s.get(), 1, 2000);
+    EXPECT_TRUE(wait_for([&]() { return seed(s.get(), 1).seq_num == 2000U; }));
+
+    // Sessions are matched by the exporter only (the collector's port may differ)
+    unique_session s_moved = session("10.0.0.1", 50000, 4740);
+    res = seed(s_moved.get(), 1);
+    EXPECT_TRUE(res.seq_valid);
+    EXPECT_EQ(res.tmplts, 2U);
+
+    // Different ODID or exporter
+    unique_session s_other = session("10.0.0.2", 50000);
+    EXPECT_FALSE(seed(s.get(), 2).seq_valid);
+    EXPECT_EQ(seed(s.get(), 2).tmplts, 0U);
+    EXPECT_FALSE(seed(s_other.get(), 1).seq_valid);
+    EXPECT_EQ(seed(s_other.get(), 1).tmplts, 0U);
+}
+
+// Closed sessions and a new full state remove the replicated state
+TEST_F(Replicator, closeAndReset)
+{
+    unique_session s1 = session("10.0.0.1", 50000);
+    unique_session s2 = session("10.0.0.2", 50000);
+    send_state(s1.get(), 1, 10);
+    ipx_repl_seq(primary.get(), s2.get(), 5, 20);
+    ASSERT_TRUE(wait_for([&]() { return seed(s2.get(), 5).seq_valid; }));
+    EXPECT_TRUE(seed(s1.get(), 1).seq_valid);
+
+    ipx_repl_close(primary.get(), s1.get());
+    EXPECT_TRUE(wait_for([&]() { return !seed(s1.get(), 1).seq_valid; }));
+    EXPECT_EQ(seed(s1.get(), 1).tmplts, 0U);
+    EXPECT_TRUE(seed(s2.get(), 5).seq_valid);
+
+    ipx_repl_reset(primary.get());
+    EXPECT_TRUE(wait_for([&]() { return !seed(s2.get(), 5).seq_valid; }));
+}
+
+// The primary reconnects to a restarted standby and requests the full state again
+TEST_F(Replicator, reconnect)
+{
+    unique_session s = session("10.0.0.1", 50000);
+    send_state(s.get(), 1, 1000);
+    ASSERT_TRUE(wait_for([&]() { return seed(s.get(), 1).seq_valid; }));
+
+    standby.reset();
+    standby_start();
+    EXPECT_FALSE(seed(s.get(), 1).seq_valid);
+
+    send_state(s.get(), 1, 3000);
+    ASSERT_TRUE(wait_for([&]() { return seed(s.get(), 1).seq_valid; }));
+    EXPECT_EQ(seed(s.get(), 1).seq_num, 3000U);
+    EXPECT_EQ(seed(s.get(), 1).tmplts, 2U);
+}
+
+// Updates without a connection are dropped
+TEST(ReplicatorPrimary, notConnected)
+{
+    const std::string path = "/tmp/ipfixcol2_repl_none_" + std::to_string(getpid()) + ".sock";
+    struct ipx_repl_cfg cfg = {IPX_REPL_PRIMARY, path.c_str(), nullptr, 0};
+    unique_repl primary(ipx_repl_create("primary", &cfg), &ipx_repl_destroy);
+    ASSERT_NE(primary, nullptr);
+
+    struct ipx_session_net net;
+    memset(&net, 0, sizeof(net));
+    net.l3_proto = AF_INET;
+    unique_session s(ipx_session_new_udp(&net, 0, 0), &ipx_session_destroy);
+    ipx_repl_reset(primary.get());
+    ipx_repl_seq(primary.get(), s.get(), 1, 1);
+    EXPECT_FALSE(ipx_repl_resync_needed(primary.get()));
+}
+
+// Standby cannot listen on an invalid socket path
+TEST(ReplicatorStandby, invalidSocket)
+{
+    struct ipx_repl_cfg cfg = {IPX_REPL_STANDBY, "/nonexistent/dir/repl.sock", nullptr, 0};
+    EXPECT_EQ(ipx_repl_create("standby", &cfg), nullptr);
+}
@@ -0,0 +1,325 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include <core/ring.h>
+    #include <core/message_base.h>
+    #include <core/message_terminate.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_ring = std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)>;
+using bench_clock = std::chrono::steady_clock;
+
+/** The ring only passes pointers, therefore, messages are just encoded numbers */
+static inline ipx_msg_t *
+num2msg(uintptr_t num)
+{
+    return reinterpret_cast<ipx_msg_t *>(num + 1);
+}
+
+static inline uintptr_t
+msg2num(ipx_msg_t *msg)
+{
+    return reinterpret_cast<uintptr_t>(msg) - 1;
+}
+
+/** Parameters of the tests: (busy polling mode, multi-writer mode) */
+class Ring : public ::testing::TestWithParam<std::tuple<bool, bool> > {};
+
+INSTANTIATE_TEST_CASE_P(Modes, Ring, ::testing::Combine(::testing::Bool(), ::testing::Bool()));
+
+// All messages must be received in the same order as they have been sent
+TEST_P(Ring, order)
+{
+    const bool busy_mode = std::get<0>(GetParam());
+    const bool mw_mode = std::get<1>(GetParam());
+    const unsigned int writers = mw_mode ? 4 : 1;
+    const uintptr_t msg_cnt = 25000;
+
+    unique_ring ring(ipx_ring_init(128, mw_mode), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_busy_mode(ring.get(), busy_mode);
+
+    // Each writer encodes its ID into the highest bits of the message
+    std::vector<std::thread> threads;
+    for (uintptr_t id = 0; id < writers; ++id) {
+        threads.emplace_back([&ring, id, msg_cnt]() {
+            for (uintptr_t i = 0; i < msg_cnt; ++i) {
+                ipx_ring_push(ring.get(), num2msg((id << 32) | i));
+            }
+        });
+    }
+
+    std::vector<uintptr_t> expected(writers, 0);
+    for (uintptr_t i = 0; i < writers * msg_cnt; ++i) {
+        const uintptr_t num = msg2num(ipx_ring_pop(ring.get()));
+        const uintptr_t id = num >> 32;
+        ASSERT_LT(id, writers);
+        ASSERT_EQ(num & UINT32_MAX, expected[id]);
+        expected[id]++;
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * \brief Measure latency of passing messages through the ring
+ *
+ * A writer sends messages with a short gap between them (i.e. the reader usually waits for
+ * the next message). The function returns sorted latencies in nanoseconds.
+ */
+static std::vector<int64_t>
+latency_measure(bool busy_mode)
+{
+    const size_t msg_cnt = 2000;
+    const auto gap = std::chrono::microseconds(50);
+
+    unique_ring ring(ipx_ring_init(128, false), &ipx_ring_destroy);
+    EXPECT_NE(ring, nullptr);
+    ipx_ring_busy_mode(ring.get(), busy_mode);
+
+    std::vector<bench_clock::time_point> sent(msg_cnt);
+    std::vector<int64_t> result(msg_cnt);
+
+    std::thread writer([&]() {
+        for (size_t i = 0; i < msg_cnt; ++i) {
+            const auto next = bench_clock::now() + gap;
+            while (bench_clock::now() < next) {
+                // Busy wait, sleeping is too inaccurate
+            }
+
+            sent[i] = bench_clock::now();
+            ipx_ring_push(ring.get(), num2msg(i));
+        }
+    });
+
+    for (size_t i = 0; i < msg_cnt; ++i) {
+        const uintptr_t num = msg2num(ipx_ring_pop(ring.get()));
+        const auto now = bench_clock::now();
+        EXPECT_EQ(num, i);
+        result[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent[i]).count();
+    }
+
+    writer.join();
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Compare latency of the default and busy polling mode. It's a benchmark without any
+// assertions, run it explicitly with "--gtest_also_run_disabled_tests".
+TEST(RingLatency, DISABLED_busyPoll)
+{
+    if (std::thread::hardware_concurrency() < 2) {
+        // Spinning threads compete for the same CPU, the results are meaningless
+        std::cout << "Note: Only 1 CPU available, busy polling cannot perform well!" << std::endl;
+    }
+
+    const std::vector<int64_t> def = latency_measure(false);
+    const std::vector<int64_t> busy = latency_measure(true);
+
+    auto percentile = [](const std::vector<int64_t> &vec, double p) {
+        return vec[static_cast<size_t>(p * (vec.size() - 1))];
+    };
+
+    std::cout << "Latency (ns)     p50       p99       max\n"
+        << "default:   " << std::setw(9) << percentile(def, 0.50)
+        << " " << std::setw(9) << percentile(def, 0.99) << " " << std::setw(9) << def.back()
+        << "\n"
+        << "busy poll: " << std::setw(9) << percentile(busy, 0.50)
+        << " " << std::setw(9) << percentile(busy, 0.99) << " " << std::setw(9) << busy.back()
+        << std::endl;
+
+    RecordProperty("default_p99_ns", std::to_string(percentile(def, 0.99)));
+    RecordProperty("busy_p99_ns", std::to_string(percentile(busy, 0.99)));
+}
+
+/** Get a deadline after a number of milliseconds from now */
+static struct timespec
+deadline_after(long ms)
+{
+    struct timespec deadline;
+    EXPECT_EQ(clock_gettime(CLOCK_MONOTONIC, &deadline), 0);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+// A busy polling reader waiting on an empty ring is woken up by a writer
+TEST(RingBusy, wakeup)
+{
+    // A small ring, so the writer also waits for the reader
+    unique_ring ring(ipx_ring_init(4, false), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_busy_mode(ring.get(), true);
+
+    // Bursts of messages separated by gaps, the reader finds the ring empty before each burst
+    const uintptr_t bursts = 20;
+    const uintptr_t burst_size = 50;
+    std::thread writer([&ring, bursts, burst_size]() {
+        for (uintptr_t b = 0; b < bursts; ++b) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            for (uintptr_t i = 0; i < burst_size; ++i) {
+                ipx_ring_push(ring.get(), num2msg(b * burst_size + i));
+            }
+        }
+    });
+
+    // Each message is delivered exactly once and in order
+    for (uintptr_t i = 0; i < bursts * burst_size; ++i) {
+        ipx_msg_t *msg = ipx_ring_pop(ring.get());
+        ASSERT_EQ(msg2num(msg), i);
+    }
+    writer.join();
+
+    // No other messages, the busy wait ends with the deadline
+    struct timespec deadline = deadline_after(20);
+    const auto start = bench_clock::now();
+    EXPECT_EQ(ipx_ring_pop_timed(ring.get(), &deadline), nullptr);
+    EXPECT_GE(bench_clock::now() - start, std::chrono::milliseconds(15));
+
+    // A message committed during the busy wait is received before the deadline
+    deadline = deadline_after(5000);
+    writer = std::thread([&ring]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ipx_ring_push(ring.get(), num2msg(12345));
+    });
+    EXPECT_EQ(msg2num(ipx_ring_pop_timed(ring.get(), &deadline)), 12345U);
+    writer.join();
+}
+
+// Waiting for a message with a deadline
+TEST(RingTimed, deadline)
+{
+    unique_ring ring(ipx_ring_init(16, false), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+
+    // Empty ring -> NULL after the deadline
+    struct timespec deadline;
+    ASSERT_EQ(clock_gettime(CLOCK_MONOTONIC, &deadline), 0);
+    deadline.tv_nsec += 20000000L; // 20 ms
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    const auto start = bench_clock::now();
+    EXPECT_EQ(ipx_ring_pop_timed(ring.get(), &deadline), nullptr);
+    EXPECT_GE(bench_clock::now() - start, std::chrono::milliseconds(15));
+
+    // Expired deadline must not prevent getting already available messages
+    ipx_ring_push(ring.get(), num2msg(1));
+    ipx_ring_push(ring.get(), num2msg(2));
+    EXPECT_EQ(msg2num(ipx_ring_pop_timed(ring.get(), &deadline)), 1U);
+    EXPECT_EQ(msg2num(ipx_ring_pop_timed(ring.get(), &deadline)), 2U);
+    EXPECT_EQ(ipx_ring_pop_timed(ring.get(), &deadline), nullptr);
+
+    // A message sent before the deadline is received
+    ASSERT_EQ(clock_gettime(CLOCK_MONOTONIC, &deadline), 0);
+    deadline.tv_sec += 5;
+    std::thread writer([&ring]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ipx_ring_push(ring.get(), num2msg(3));
+    });
+    EXPECT_EQ(msg2num(ipx_ring_pop_timed(ring.get(), &deadline)), 3U);
+    writer.join();
+}
+
+// Small control messages are copied into slots of the ring buffer in the inline mode
+TEST(RingInline, copies)
+{
+    unique_ring ring(ipx_ring_init(16, false), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_inline_mode(ring.get(), true);
+    EXPECT_EQ(ipx_ring_info(ring.get()), nullptr); // Nothing has been read yet
+
+    // Sessions are never accessed by the ring, any non-NULL pointer is fine
+    const auto *session = reinterpret_cast<const struct ipx_session *>(&ring);
+    ipx_msg_session_t *msg_session = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+    ipx_msg_terminate_t *msg_term = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+    ASSERT_NE(msg_session, nullptr);
+    ASSERT_NE(msg_term, nullptr);
+
+    // The caller still owns the original messages
+    EXPECT_TRUE(ipx_ring_push(ring.get(), ipx_msg_session2base(msg_session)));
+    EXPECT_TRUE(ipx_ring_push(ring.get(), ipx_msg_terminate2base(msg_term)));
+    ipx_msg_session_destroy(msg_session);
+    ipx_msg_termiante_destroy(msg_term);
+
+    ipx_msg_t *msg = ipx_ring_pop(ring.get());
+    const struct ipx_ring_info *info = ipx_ring_info(ring.get());
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->type, IPX_MSG_SESSION);
+    EXPECT_EQ(info->odid, 0U);
+    EXPECT_EQ(ipx_msg_get_type(msg), IPX_MSG_SESSION);
+    EXPECT_NE(msg, ipx_msg_session2base(msg_session));
+    EXPECT_TRUE(ipx_msg_header_is_inline(msg));
+    ipx_msg_session_t *copy_session = ipx_msg_base2session(msg);
+    EXPECT_EQ(ipx_msg_session_get_event(copy_session), IPX_MSG_SESSION_CLOSE);
+    EXPECT_EQ(ipx_msg_session_get_session(copy_session), session);
+    ipx_msg_session_destroy(copy_session); // Must not free anything
+
+    msg = ipx_ring_pop(ring.get());
+    info = ipx_ring_info(ring.get());
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->type, IPX_MSG_TERMINATE);
+    ipx_msg_terminate_t *copy_term = ipx_msg_base2terminate(msg);
+    EXPECT_EQ(ipx_msg_terminate_get_type(copy_term), IPX_MSG_TERMINATE_INSTANCE);
+
+    // A copy passed to another ring buffer is copied again
+    unique_ring next(ipx_ring_init(16, false), &ipx_ring_destroy);
+    ASSERT_NE(next, nullptr);
+    ipx_ring_inline_mode(next.get(), true);
+    EXPECT_TRUE(ipx_ring_push(next.get(), msg));
+    ipx_msg_destroy(msg);
+
+    msg = ipx_ring_pop(next.get());
+    EXPECT_EQ(ipx_ring_info(next.get())->type, IPX_MSG_TERMINATE);
+    EXPECT_EQ(ipx_msg_terminate_get_type(ipx_msg_base2terminate(msg)),
+        IPX_MSG_TERMINATE_INSTANCE);
+    ipx_msg_destroy(msg);
+}
+
+// Garbage messages are always passed by reference (their destructor must be called once)
+TEST(RingInline, garbage)
+{
+    unique_ring ring(ipx_ring_init(16, false), &ipx_ring_destroy);
+    ASSERT_NE(ring, nullptr);
+    ipx_ring_inline_mode(ring.get(), true);
+
+    static int calls = 0;
+    auto cb = [](void *) {calls++;};
+    ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(&calls, cb);
+    ASSERT_NE(garbage, nullptr);
+
+    EXPECT_FALSE(ipx_ring_push(ring.get(), ipx_msg_garbage2base(garbage)));
+    ipx_msg_t *msg = ipx_ring_pop(ring.get());
+    EXPECT_EQ(msg, ipx_msg_garbage2base(garbage));
+    EXPECT_EQ(ipx_ring_info(ring.get())->type, IPX_MSG_GARBAGE);
+    EXPECT_FALSE(ipx_msg_header_is_inline(msg));
+    ipx_msg_destroy(msg);
+    EXPECT_EQ(calls, 1);
+}
@@ -0,0 +1,109 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/tap.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using unique_tap = std::unique_ptr<ipx_tap_t, decltype(&ipx_tap_destroy)>;
+
+/** Running tap server with two tap points */
+class Tap : public ::testing::Test {
+protected:
+    std::string path;
+    unique_ctx parser{nullptr, &ipx_ctx_destroy};
+    unique_ctx inter{nullptr, &ipx_ctx_destroy};
+    unique_tap tap{nullptr, &ipx_tap_destroy};
+
+    void SetUp() override {
+        path = "/tmp/ipfixcol2_tap_test_" + std::to_string(getpid()) + ".sock";
+        parser.reset(ipx_ctx_create("udp (parser)", nullptr));
+        inter.reset(ipx_ctx_create("anonymizer", nullptr));
+        ASSERT_NE(parser, nullptr);
+        ASSERT_NE(inter, nullptr);
+
+        tap.reset(ipx_tap_create(path.c_str()));
+        ASSERT_NE(tap, nullptr);
+        ASSERT_EQ(ipx_tap_point_add(tap.get(), parser.get()), IPX_OK);
+        ASSERT_EQ(ipx_tap_point_add(tap.get(), inter.get()), IPX_OK);
+        ASSERT_EQ(ipx_tap_start(tap.get()), IPX_OK);
+    }
+
+    void TearDown() override {
+        tap.reset();
+        EXPECT_NE(access(path.c_str(), F_OK), 0); // The socket must be removed
+    }
+
+    /** Send a request and return all replies until the server closes the connection */
+    std::vector<std::string> request(const std::string &req) {
+        std::vector<std::string> result;
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        EXPECT_NE(fd, -1);
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path.c_str());
+        EXPECT_EQ(connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)), 0);
+        EXPECT_EQ(send(fd, req.data(), req.size(), 0), static_cast<ssize_t>(req.size()));
+
+        char buffer[4096];
+        ssize_t len;
+        while ((len = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            result.emplace_back(buffer, static_cast<size_t>(len));
+        }
+
+        close(fd);
+        return result;
+    }
+};
+
+// Names of all tap points can be listed
+TEST_F(Tap, list)
+{
+    std::vector<std::string> reply = request("LIST");
+    ASSERT_EQ(reply.size(), 3U);
+    EXPECT_EQ(reply[0], "OK");
+    EXPECT_EQ(reply[1], "udp (parser)");
+    EXPECT_EQ(reply[2], "anonymizer");
+}
+
+// Invalid requests are refused and the connection is closed
+TEST_F(Tap, invalid)
+{
+    const std::vector<std::string> requests = {
+        "HELLO",
+        "ATTACH\nanonymizer",
+        "ATTACH\nunknown\n1\n",
+        "ATTACH\nanonymizer\n0\n",
+        "ATTACH\nanonymizer\nten\n"
+    };
+
+    for (const auto &req : requests) {
+        std::vector<std::string> reply = request(req);
+        ASSERT_EQ(reply.size(), 1U) << req;
+        EXPECT_EQ(reply[0].compare(0, 4, "ERR "), 0) << req;
+    }
+
+    EXPECT_FALSE(ipx_ctx_tap_attached(inter.get()));
+}
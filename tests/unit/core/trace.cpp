@@ -0,0 +1,147 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+extern "C" {
+    #include <core/trace.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Tracing is a global state, each test starts with disabled tracing */
+class Trace : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        char tmp[] = "/tmp/ipfixcol2_trace_XXXXXX";
+        int fd = mkstemp(tmp);
+        ASSERT_NE(fd, -1);
+        close(fd);
+        path = tmp;
+    }
+
+    void TearDown() override {
+        ipx_trace_cleanup();
+        unlink(path.c_str());
+    }
+
+    /** Export the trace and return the content of the file */
+    std::string dump() {
+        EXPECT_EQ(ipx_trace_export(path.c_str()), IPX_OK);
+        std::ifstream file(path);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    /** Count occurrences of a substring */
+    static size_t count(const std::string &str, const std::string &what) {
+        size_t cnt = 0;
+        size_t pos = 0;
+        while ((pos = str.find(what, pos)) != std::string::npos) {
+            cnt++;
+            pos++;
+        }
+        return cnt;
+    }
+};
+
+// Without enabled tracing, nothing is sampled and nothing can be exported
+TEST_F(Trace, disabled)
+{
+    EXPECT_FALSE(ipx_trace_enabled());
+    EXPECT_EQ(ipx_trace_thread_init("test"), IPX_OK);
+    EXPECT_EQ(ipx_trace_sample(), 0U);
+    EXPECT_EQ(ipx_trace_export(path.c_str()), IPX_ERR_DENIED);
+    EXPECT_EQ(ipx_trace_enable(0, 16), IPX_ERR_ARG);
+    EXPECT_EQ(ipx_trace_enable(1, 0), IPX_ERR_ARG);
+}
+
+// One of N messages gets a unique trace ID
+TEST_F(Trace, sampling)
+{
+    ASSERT_EQ(ipx_trace_enable(3, 16), IPX_OK);
+    ASSERT_EQ(ipx_trace_thread_init("input"), IPX_OK);
+
+    uint32_t last = 0;
+    for (unsigned int i = 1; i <= 9; ++i) {
+        const uint32_t id = ipx_trace_sample();
+        if (i % 3 != 0) {
+            EXPECT_EQ(id, 0U);
+            continue;
+        }
+
+        EXPECT_NE(id, 0U);
+        EXPECT_NE(id, last);
+        last = id;
+    }
+}
+
+// Spans of multiple threads are exported with names of threads and connected by flow events
+TEST_F(Trace, spans)
+{
+    ASSERT_EQ(ipx_trace_enable(1, 16), IPX_OK);
+    ASSERT_EQ(ipx_trace_thread_init("input \"udp\""), IPX_OK);
+
+    const uint32_t id = ipx_trace_sample();
+    ASSERT_NE(id, 0U);
+    const uint64_t now = ipx_trace_now();
+    ipx_trace_span(id, "receive", now, now + 1500);
+
+    std::thread worker([id, now]() {
+        ASSERT_EQ(ipx_trace_thread_init("output"), IPX_OK);
+        ipx_trace_span(id, "queue", now + 1500, now + 4000);
+        ipx_trace_span(id, "process", now + 4000, now + 10000);
+    });
+    worker.join();
+
+    // Buffers are preserved after termination of threads
+    const std::string json = dump();
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0U);
+    EXPECT_NE(json.find("\"input \\\"udp\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"output\""), std::string::npos);
+    EXPECT_EQ(count(json, "\"ph\":\"X\""), 3U);
+    EXPECT_NE(json.find("\"ts\":0.000,\"dur\":1.500"), std::string::npos);
+    EXPECT_NE(json.find("\"ts\":4.000,\"dur\":6.000"), std::string::npos);
+    EXPECT_EQ(count(json, "\"ph\":\"s\""), 1U);
+    EXPECT_EQ(count(json, "\"ph\":\"t\""), 1U);
+    EXPECT_EQ(count(json, "\"ph\":\"f\""), 1U);
+}
+
+// Only the newest spans are kept when the buffer is full (the slot that can be overwritten by
+// the next span of the owner is never exported)
+TEST_F(Trace, overwrite)
+{
+    ASSERT_EQ(ipx_trace_enable(1, 3), IPX_OK); // Rounded up to 4 spans
+    ASSERT_EQ(ipx_trace_thread_init("input"), IPX_OK);
+
+    const uint64_t now = ipx_trace_now();
+    std::vector<uint32_t> ids;
+    for (uint64_t i = 0; i < 10; ++i) {
+        ids.push_back(ipx_trace_sample());
+        ipx_trace_span(ids.back(), "receive", now + i * 1000, now + i * 1000 + 500);
+    }
+
+    const std::string json = dump();
+    EXPECT_EQ(count(json, "\"ph\":\"X\""), 3U);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const bool found = json.find("\"message\":" + std::to_string(ids[i]) + "}")
+            != std::string::npos;
+        EXPECT_EQ(found, i >= 7);
+    }
+}
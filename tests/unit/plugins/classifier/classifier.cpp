@@ -0,0 +1,653 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/message_ipfix.h>
+    #include <core/message_terminate.h>
+    #include <core/ring.h>
+    #include <plugins/intermediate/classifier/automaton.h>
+    #include <plugins/intermediate/classifier/patterns.h>
+
+    // Callbacks of the plugin (the plugin is linked into the test)
+    extern struct ipx_plugin_info ipx_plugin_info;
+    int ipx_plugin_init(ipx_ctx_t *ctx, const char *params);
+    void ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg);
+    int ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
+    void ipx_plugin_tick(ipx_ctx_t *ctx, void *cfg, const struct timespec *now);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_builder = std::unique_ptr<ac_builder_t, decltype(&ac_builder_destroy)>;
+using unique_ac = std::unique_ptr<ac_automaton_t, decltype(&ac_destroy)>;
+using unique_pset = std::unique_ptr<struct cl_pset, decltype(&cl_pset_destroy)>;
+using unique_iemgr = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using unique_ring = std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)>;
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using unique_tmplt = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using unique_session = std::unique_ptr<struct ipx_session, decltype(&ipx_session_destroy)>;
+using bytes = std::vector<uint8_t>;
+
+/** Occurrence of a pattern (key, end position) */
+using match = std::pair<uint32_t, size_t>;
+
+static void
+match_cb(uint32_t key, size_t end, void *arg)
+{
+    static_cast<std::vector<match> *>(arg)->emplace_back(key, end);
+}
+
+/** Find all occurrences of patterns in a string */
+static std::vector<match>
+find(const ac_automaton_t *ac, const std::string &str)
+{
+    std::vector<match> result;
+    ac_match(ac, reinterpret_cast<const uint8_t *>(str.data()), str.size(), &match_cb, &result);
+    return result;
+}
+
+/** Add a pattern to a builder */
+static int
+add(ac_builder_t *builder, const std::string &pattern, uint32_t key)
+{
+    return ac_builder_add(builder, reinterpret_cast<const uint8_t *>(pattern.data()),
+        pattern.size(), key);
+}
+
+/** Temporary file removed with the object */
+class TmpFile {
+public:
+    explicit TmpFile(const std::string &content) {
+        char path[] = "/tmp/ipfixcol2_classifier_XXXXXX";
+        int fd = mkstemp(path);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(write(fd, content.data(), content.size()),
+            static_cast<ssize_t>(content.size()));
+        close(fd);
+        m_path = path;
+    }
+    ~TmpFile() {
+        unlink(m_path.c_str());
+    }
+    const char *path() const {
+        return m_path.c_str();
+    }
+private:
+    std::string m_path;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Automaton
+
+// Overlapping occurrences are reported by end positions, the longest pattern first
+TEST(ClassifierAutomaton, overlapping)
+{
+    unique_builder builder(ac_builder_create(), &ac_builder_destroy);
+    ASSERT_NE(builder, nullptr);
+    ASSERT_EQ(add(builder.get(), "he", 0), IPX_OK);
+    ASSERT_EQ(add(builder.get(), "she", 1), IPX_OK);
+    ASSERT_EQ(add(builder.get(), "his", 2), IPX_OK);
+    ASSERT_EQ(add(builder.get(), "hers", 3), IPX_OK);
+
+    unique_ac ac(ac_builder_build(builder.get()), &ac_destroy);
+    ASSERT_NE(ac, nullptr);
+    EXPECT_GT(ac_states_cnt(ac.get()), 1U);
+
+    EXPECT_EQ(find(ac.get(), "ushers"), (std::vector<match>{{1, 3}, {0, 3}, {3, 5}}));
+    EXPECT_EQ(find(ac.get(), "ahishe"), (std::vector<match>{{2, 3}, {1, 5}, {0, 5}}));
+    EXPECT_TRUE(find(ac.get(), "").empty());
+    EXPECT_TRUE(find(ac.get(), "xyz").empty());
+}
+
+// Only ASCII letters are folded, other bytes (including zeros) are compared as they are
+TEST(ClassifierAutomaton, caseInsensitive)
+{
+    unique_builder builder(ac_builder_create(), &ac_builder_destroy);
+    ASSERT_NE(builder, nullptr);
+    ASSERT_EQ(add(builder.get(), "Example.COM", 0), IPX_OK);
+    ASSERT_EQ(add(builder.get(), std::string("a\0b", 3), 1), IPX_OK);
+    ASSERT_EQ(add(builder.get(), "\xC3\x81", 2), IPX_OK); // non-ASCII "A" with an acute
+
+    unique_ac ac(ac_builder_build(builder.get()), &ac_destroy);
+    ASSERT_NE(ac, nullptr);
+    EXPECT_EQ(find(ac.get(), "www.EXAMPLE.com"), (std::vector<match>{{0, 14}}));
+    EXPECT_EQ(find(ac.get(), std::string("xA\0Bx", 5)), (std::vector<match>{{1, 3}}));
+    EXPECT_TRUE(find(ac.get(), "a b").empty());
+    EXPECT_EQ(find(ac.get(), "\xC3\x81"), (std::vector<match>{{2, 1}}));
+    EXPECT_TRUE(find(ac.get(), "\xC3\xA1").empty());
+}
+
+// Invalid and duplicate patterns are refused, the builder can be reused
+TEST(ClassifierAutomaton, builder)
+{
+    unique_builder builder(ac_builder_create(), &ac_builder_destroy);
+    ASSERT_NE(builder, nullptr);
+    EXPECT_EQ(add(builder.get(), "", 0), IPX_ERR_ARG);
+    EXPECT_EQ(add(builder.get(), "abc", 0), IPX_OK);
+    EXPECT_EQ(add(builder.get(), "ABC", 1), IPX_ERR_EXISTS);
+
+    unique_ac ac1(ac_builder_build(builder.get()), &ac_destroy);
+    ASSERT_NE(ac1, nullptr);
+    EXPECT_EQ(find(ac1.get(), "abc"), (std::vector<match>{{0, 2}}));
+
+    // The builder is empty after the compilation
+    EXPECT_EQ(add(builder.get(), "abc", 7), IPX_OK);
+    unique_ac ac2(ac_builder_build(builder.get()), &ac_destroy);
+    ASSERT_NE(ac2, nullptr);
+    EXPECT_EQ(find(ac2.get(), "abcabc"), (std::vector<match>{{7, 2}, {7, 5}}));
+    EXPECT_EQ(find(ac1.get(), "abc"), (std::vector<match>{{0, 2}}));
+
+    // An empty automaton finds nothing
+    unique_ac ac3(ac_builder_build(builder.get()), &ac_destroy);
+    ASSERT_NE(ac3, nullptr);
+    EXPECT_TRUE(find(ac3.get(), "abc").empty());
+}
+
+// The automaton finds exactly the same occurrences as a naive search
+TEST(ClassifierAutomaton, naive)
+{
+    std::mt19937 rng(12345);
+    auto random_str = [&rng](size_t len_min, size_t len_max) {
+        const size_t len = std::uniform_int_distribution<size_t>(len_min, len_max)(rng);
+        std::string str(len, 'a');
+        for (auto &c : str) {
+            // Small alphabet -> many overlapping occurrences (in both cases)
+            c = "abcAB."[std::uniform_int_distribution<int>(0, 5)(rng)];
+        }
+        return str;
+    };
+    auto lower = [](std::string str) {
+        std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+        return str;
+    };
+
+    // Enough patterns, so both full and sparse states are used
+    std::vector<std::string> patterns;
+    unique_builder builder(ac_builder_create(), &ac_builder_destroy);
+    ASSERT_NE(builder, nullptr);
+    for (int i = 0; i < 3000; ++i) {
+        const std::string pattern = random_str(1, 8);
+        const int rc = add(builder.get(), pattern, static_cast<uint32_t>(patterns.size()));
+        if (rc == IPX_ERR_EXISTS) {
+            continue;
+        }
+        ASSERT_EQ(rc, IPX_OK);
+        patterns.push_back(lower(pattern));
+    }
+
+    unique_ac ac(ac_builder_build(builder.get()), &ac_destroy);
+    ASSERT_NE(ac, nullptr);
+
+    for (int t = 0; t < 200; ++t) {
+        const std::string text = random_str(0, 64);
+        const std::string text_lower = lower(text);
+
+        // By end position, then from the longest to the shortest pattern
+        std::vector<std::tuple<size_t, size_t, uint32_t>> exp;
+        for (uint32_t key = 0; key < patterns.size(); ++key) {
+            const std::string &pattern = patterns[key];
+            for (size_t pos = text_lower.find(pattern); pos != std::string::npos;
+                    pos = text_lower.find(pattern, pos + 1)) {
+                exp.emplace_back(pos + pattern.size() - 1, SIZE_MAX - pattern.size(), key);
+            }
+        }
+        std::sort(exp.begin(), exp.end());
+
+        std::vector<match> exp_matches;
+        for (const auto &item : exp) {
+            exp_matches.emplace_back(std::get<2>(item), std::get<0>(item));
+        }
+        ASSERT_EQ(find(ac.get(), text), exp_matches) << "text: " << text;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Pattern sets
+
+/** Pattern set and tags of the current record */
+class ClassifierPatterns : public ::testing::Test {
+protected:
+    unique_pset pset{nullptr, &cl_pset_destroy};
+    struct cl_tags tags;
+
+    void SetUp() override {
+        memset(&tags, 0, sizeof(tags));
+    }
+
+    void TearDown() override {
+        cl_tags_free(&tags);
+    }
+
+    void load(const std::string &content) {
+        TmpFile file(content);
+        char err[256];
+        pset.reset(cl_pset_load(file.path(), err, sizeof(err)));
+        ASSERT_NE(pset, nullptr) << err;
+        ASSERT_EQ(cl_tags_prepare(&tags, pset.get()), IPX_OK);
+    }
+
+    /** Match values of a record and get the names of the tags */
+    std::vector<std::string> record(const std::vector<std::string> &values) {
+        cl_tags_clear(&tags);
+        for (const auto &value : values) {
+            cl_pset_match(pset.get(), reinterpret_cast<const uint8_t *>(value.data()),
+                value.size(), &tags);
+        }
+
+        std::vector<std::string> names;
+        for (size_t i = 0; i < tags.cnt; ++i) {
+            names.emplace_back(cl_pset_tag_name(pset.get(), tags.list[i]));
+        }
+        return names;
+    }
+};
+
+using names = std::vector<std::string>;
+
+// Tags of all values of a record in order of occurrence, each tag only once
+TEST_F(ClassifierPatterns, tags)
+{
+    load(
+        "# Pattern          Tag\n"
+        "\n"
+        "doubleclick.net$   ads\n"
+        ".googlesyndication ads\n"
+        "^tracker.          tracking\n"
+        "facebook           social\n"
+        "FaceBook           tracking\n"
+        "\tcdn \t           infra\r\n"
+    );
+    ASSERT_EQ(pset->tags_cnt, 4U);
+    EXPECT_EQ(pset->rules_cnt, 6U);
+    // The same pattern (case-insensitively) is a single key with multiple rules
+    EXPECT_EQ(pset->keys_cnt, 5U);
+
+    EXPECT_EQ(record({"www.facebook.com"}), (names{"social", "tracking"}));
+    EXPECT_EQ(record({"ad.doubleclick.net"}), (names{"ads"}));
+    EXPECT_EQ(record({"pagead2.GoogleSyndication.com"}), (names{"ads"}));
+    EXPECT_EQ(record({"example.org"}), names{});
+    EXPECT_EQ(record({}), names{});
+
+    // Anchors
+    EXPECT_EQ(record({"tracker.example.org"}), (names{"tracking"}));
+    EXPECT_EQ(record({"mytracker.example.org"}), names{});
+    EXPECT_EQ(record({"doubleclick.net.example.org"}), names{});
+
+    // Tags of all values are merged
+    EXPECT_EQ(record({"cdn.example.org", "static.doubleclick.net", "cdn.facebook.com"}),
+        (names{"infra", "ads", "social", "tracking"}));
+    EXPECT_EQ(record({"cdn.cdn.cdn", "CDN"}), (names{"infra"}));
+
+    // Tags of the previous record are forgotten
+    EXPECT_EQ(record({"cdn"}), (names{"infra"}));
+}
+
+// Errors are reported with the line of the file
+TEST_F(ClassifierPatterns, invalid)
+{
+    const std::vector<std::pair<std::string, std::string>> files = {
+        {"ok tag\nmissing\n", "line 2"},
+        {"too many words\n", "line 1"},
+        {"^$ tag\n", "empty"},
+        {"ok tag\nok a,b\n", "commas"},
+        {"ok " + std::string(CL_TAG_MAX + 1, 't') + "\n", "too long"},
+        {std::string(CL_PATTERN_MAX + 1, 'p') + " tag\n", "too long"},
+    };
+
+    for (const auto &file : files) {
+        SCOPED_TRACE(file.first);
+        TmpFile tmp(file.first);
+        char err[256] = "";
+        EXPECT_EQ(cl_pset_load(tmp.path(), err, sizeof(err)), nullptr);
+        EXPECT_NE(strstr(err, file.second.c_str()), nullptr) << err;
+    }
+
+    char err[256] = "";
+    EXPECT_EQ(cl_pset_load("/nonexistent/patterns.txt", err, sizeof(err)), nullptr);
+    EXPECT_NE(strstr(err, "/nonexistent/patterns.txt"), nullptr) << err;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Plugin instance
+
+/** Append a 16-bit value in network byte order */
+static void
+put16(bytes &out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/** Append a 32-bit value in network byte order */
+static void
+put32(bytes &out, uint32_t value)
+{
+    put16(out, static_cast<uint16_t>(value >> 16));
+    put16(out, static_cast<uint16_t>(value));
+}
+
+/** Append a variable-length string (with the long length prefix, if necessary) */
+static void
+put_str(bytes &out, const std::string &str)
+{
+    if (str.size() < 255) {
+        out.push_back(static_cast<uint8_t>(str.size()));
+    } else {
+        out.push_back(255);
+        put16(out, static_cast<uint16_t>(str.size()));
+    }
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+// Information Elements used by the tests
+static constexpr uint16_t IE_SRC_IP = 8;        // sourceIPv4Address (4B)
+static constexpr uint16_t IE_IFACE_NAME = 82;   // interfaceName (string)
+static constexpr uint16_t IE_APP_DSC = 94;      // applicationDescription (string, tags)
+static constexpr uint16_t IE_APP_NAME = 96;     // applicationName (string)
+static constexpr uint16_t VAR = FDS_IPFIX_VAR_IE_LEN;
+
+/** Data Record and its Template */
+struct drec {
+    const struct fds_template *tmplt;
+    bytes data;
+};
+
+/** Instance of the plugin running in its own thread */
+class Classifier : public ::testing::Test {
+protected:
+    unique_iemgr iemgr{fds_iemgr_create(), &fds_iemgr_destroy};
+    unique_ring ring_in{ipx_ring_init(8, false), &ipx_ring_destroy};
+    unique_ring ring_out{ipx_ring_init(8, false), &ipx_ring_destroy};
+    struct ipx_ctx_callbacks cbs;
+    unique_ctx plugin{nullptr, &ipx_ctx_destroy};
+    bool running = false;
+    std::vector<unique_tmplt> tmplts;
+    unique_session session{nullptr, &ipx_session_destroy};
+    std::unique_ptr<TmpFile> patterns;
+
+    void SetUp() override {
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr.get(), fds_api_cfg_dir()), FDS_OK);
+        memset(&cbs, 0, sizeof(cbs));
+        cbs.info = &ipx_plugin_info;
+        cbs.init = &ipx_plugin_init;
+        cbs.destroy = &ipx_plugin_destroy;
+        cbs.process = &ipx_plugin_process;
+        cbs.tick = &ipx_plugin_tick;
+
+        plugin.reset(ipx_ctx_create("classifier", &cbs));
+        ASSERT_NE(plugin, nullptr);
+        ipx_ctx_iemgr_set(plugin.get(), iemgr.get());
+        ipx_ctx_ring_src_set(plugin.get(), ring_in.get());
+        ipx_ctx_ring_dst_set(plugin.get(), ring_out.get());
+
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = 50000;
+        net.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "10.0.0.1", &net.addr_src.ipv4), 1);
+        session.reset(ipx_session_new_udp(&net, 0, 0));
+        ASSERT_NE(session, nullptr);
+
+        patterns.reset(new TmpFile(
+            "doubleclick.net$   ads\n"
+            "^tracker.          tracking\n"
+            "facebook           social\n"
+            "eth                iface\n"
+        ));
+    }
+
+    void TearDown() override {
+        if (running) {
+            // Stop the thread and wait for the termination message
+            ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+            ipx_ring_push(ring_in.get(), ipx_msg_terminate2base(msg));
+            ipx_msg_t *out = ipx_ring_pop(ring_out.get());
+            EXPECT_EQ(ipx_msg_get_type(out), IPX_MSG_TERMINATE);
+            ipx_msg_termiante_destroy(ipx_msg_base2terminate(out));
+        }
+
+        plugin.reset();
+    }
+
+    /** Initialize the instance with the configured fields and start its thread */
+    void start(const std::vector<std::string> &fields) {
+        std::string params = "<params><patterns>" + std::string(patterns->path())
+            + "</patterns>";
+        for (const auto &field : fields) {
+            params += "<field>" + field + "</field>";
+        }
+        params += "<tagElement>iana:applicationDescription</tagElement>"
+            "<reloadInterval>0</reloadInterval></params>";
+
+        ASSERT_EQ(ipx_ctx_init(plugin.get(), params.c_str()), IPX_OK);
+        ipx_ctx_t *pipeline[] = {plugin.get()};
+        size_t rec_size;
+        ASSERT_EQ(ipx_ctx_rext_resolve(pipeline, 1, &rec_size), IPX_OK);
+        ipx_ctx_recsize_set(plugin.get(), rec_size);
+        ASSERT_EQ(ipx_ctx_run(plugin.get()), IPX_OK);
+        running = true;
+    }
+
+    /** Parse a Template (fields are pairs of an ID and a length) */
+    const struct fds_template *
+    tmplt_add(uint16_t id, const std::vector<std::pair<uint16_t, uint16_t>> &fields) {
+        bytes raw;
+        put16(raw, id);
+        put16(raw, static_cast<uint16_t>(fields.size()));
+        for (const auto &field : fields) {
+            put16(raw, field.first);
+            put16(raw, field.second);
+        }
+
+        uint16_t len = static_cast<uint16_t>(raw.size());
+        struct fds_template *tmplt;
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &len, &tmplt), FDS_OK);
+        tmplts.emplace_back(tmplt, &fds_template_destroy);
+        return tmplt;
+    }
+
+    /**
+     * \brief Pass an IPFIX Message with the Data Records through the instance
+     *
+     * A Transport Session Message is sent after the IPFIX Message, so all produced messages
+     * can be collected without waiting.
+     * \return Produced IPFIX Messages (garbage messages are destroyed)
+     */
+    std::vector<ipx_msg_ipfix_t *> process(const std::vector<drec> &recs,
+        ipx_msg_ipfix_t **in = nullptr) {
+        size_t size = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            size += rec.data.size();
+        }
+
+        uint8_t *raw = static_cast<uint8_t *>(calloc(1, size));
+        auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(raw);
+        hdr->version = htons(FDS_IPFIX_VERSION);
+        hdr->length = htons(static_cast<uint16_t>(size));
+        struct ipx_msg_ctx msg_ctx;
+        msg_ctx.session = session.get();
+        msg_ctx.odid = 1;
+        msg_ctx.stream = 0;
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(plugin.get(), &msg_ctx, raw,
+            static_cast<uint16_t>(size));
+        EXPECT_NE(msg, nullptr);
+
+        size_t offset = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            memcpy(raw + offset, rec.data.data(), rec.data.size());
+            struct ipx_ipfix_record *ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            EXPECT_NE(ref, nullptr);
+            ref->rec.data = raw + offset;
+            ref->rec.size = static_cast<uint16_t>(rec.data.size());
+            ref->rec.tmplt = rec.tmplt;
+            ref->rec.snap = nullptr;
+            offset += rec.data.size();
+        }
+        if (in != nullptr) {
+            *in = msg;
+        }
+
+        ipx_msg_session_t *marker = ipx_msg_session_create(session.get(), IPX_MSG_SESSION_OPEN);
+        EXPECT_EQ(ipx_ring_push(ring_in.get(), ipx_msg_ipfix2base(msg)), IPX_OK);
+        EXPECT_EQ(ipx_ring_push(ring_in.get(), ipx_msg_session2base(marker)), IPX_OK);
+
+        std::vector<ipx_msg_ipfix_t *> result;
+        while (true) {
+            ipx_msg_t *out = ipx_ring_pop(ring_out.get());
+            switch (ipx_msg_get_type(out)) {
+            case IPX_MSG_IPFIX:
+                result.push_back(ipx_msg_base2ipfix(out));
+                break;
+            case IPX_MSG_GARBAGE:
+                ipx_msg_garbage_destroy(ipx_msg_base2garbage(out));
+                break;
+            case IPX_MSG_SESSION:
+                ipx_msg_session_destroy(ipx_msg_base2session(out));
+                return result;
+            default:
+                ADD_FAILURE() << "Unexpected message type";
+                return result;
+            }
+        }
+    }
+
+    /** Destroy produced IPFIX Messages */
+    static void destroy(std::vector<ipx_msg_ipfix_t *> &msgs) {
+        for (auto *msg : msgs) {
+            ipx_msg_ipfix_destroy(msg);
+        }
+        msgs.clear();
+    }
+};
+
+/** Get a Data Record of a message */
+static const struct fds_drec *
+rec_get(ipx_msg_ipfix_t *msg, uint32_t idx)
+{
+    return &ipx_msg_ipfix_get_drec(msg, idx)->rec;
+}
+
+/** Get the value of the last field of a record (i.e. the list of tags) */
+static std::string
+rec_tags(const struct fds_drec *rec)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    EXPECT_EQ(tmplt->fields[tmplt->fields_cnt_total - 1].id, IE_APP_DSC);
+    struct fds_drec_field field;
+    if (fds_drec_find(const_cast<struct fds_drec *>(rec), 0, IE_APP_DSC, &field) == FDS_EOC) {
+        ADD_FAILURE() << "The field with tags is missing";
+        return "";
+    }
+    return std::string(reinterpret_cast<const char *>(field.data), field.size);
+}
+
+// Records are labeled with tags of all configured fields and the original fields are kept
+TEST_F(Classifier, labels)
+{
+    start({"iana:applicationName", "iana:interfaceName"});
+    const struct fds_template *t_flow = tmplt_add(256,
+        {{IE_APP_NAME, VAR}, {IE_SRC_IP, 4}, {IE_IFACE_NAME, VAR}});
+    const struct fds_template *t_other = tmplt_add(257, {{IE_SRC_IP, 4}});
+
+    auto flow = [t_flow](const std::string &app, const std::string &iface) {
+        drec rec{t_flow, {}};
+        put_str(rec.data, app);
+        put32(rec.data, 0x0A000001);
+        put_str(rec.data, iface);
+        return rec;
+    };
+    drec other{t_other, {}};
+    put32(other.data, 0x0A000002);
+
+    const std::vector<drec> recs = {
+        flow("www.facebook.com", "eth0"),
+        flow("tracker.ad.doubleclick.net", "lo"),
+        flow("mytracker.example.org", "wlan0"),   // no match (anchored pattern)
+        flow("", "ETH1"),                          // an empty value
+        flow(std::string(300, 'x') + "facebook", "eth0"), // long value
+        other,
+    };
+    auto msgs = process(recs);
+    ASSERT_EQ(msgs.size(), 1U);
+    ipx_msg_ipfix_t *msg = msgs[0];
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), recs.size());
+
+    const std::vector<std::string> exp_tags = {
+        "social,iface", "tracking,ads", "", "iface", "social,iface"};
+    for (size_t i = 0; i < exp_tags.size(); ++i) {
+        SCOPED_TRACE("record " + std::to_string(i));
+        const struct fds_drec *rec = rec_get(msg, static_cast<uint32_t>(i));
+
+        // The source template followed by the field with tags under the same Template ID
+        const struct fds_template *tmplt = rec->tmplt;
+        ASSERT_NE(tmplt, nullptr);
+        EXPECT_EQ(tmplt->id, 256U);
+        ASSERT_EQ(tmplt->fields_cnt_total, 4U);
+        EXPECT_EQ(tmplt->fields[0].id, IE_APP_NAME);
+        EXPECT_EQ(tmplt->fields[1].id, IE_SRC_IP);
+        EXPECT_EQ(tmplt->fields[2].id, IE_IFACE_NAME);
+        EXPECT_EQ(tmplt->fields[3].id, IE_APP_DSC);
+        EXPECT_EQ(tmplt->fields[3].length, VAR);
+
+        // The original record is followed by the list of tags
+        const bytes &src = recs[i].data;
+        ASSERT_GT(rec->size, src.size());
+        EXPECT_EQ(bytes(rec->data, rec->data + src.size()), src);
+        EXPECT_EQ(rec_tags(rec), exp_tags[i]);
+        EXPECT_EQ(rec->data[src.size()], exp_tags[i].size());
+    }
+
+    // Records without any configured field are copied as they are
+    const struct fds_drec *rec = rec_get(msg, 5);
+    EXPECT_EQ(rec->tmplt->id, 257U);
+    EXPECT_EQ(rec->tmplt->fields_cnt_total, 1U);
+    EXPECT_EQ(bytes(rec->data, rec->data + rec->size), other.data);
+    destroy(msgs);
+}
+
+// Messages without any record to classify are passed unchanged
+TEST_F(Classifier, passThrough)
+{
+    start({"iana:applicationName"});
+    const struct fds_template *t_other = tmplt_add(257, {{IE_SRC_IP, 4}, {IE_IFACE_NAME, VAR}});
+    // Records that already have tags are never classified again
+    const struct fds_template *t_done = tmplt_add(258, {{IE_APP_NAME, VAR}, {IE_APP_DSC, VAR}});
+
+    drec other{t_other, {}};
+    put32(other.data, 0x0A000002);
+    put_str(other.data, "eth0");
+    drec done{t_done, {}};
+    put_str(done.data, "www.facebook.com");
+    put_str(done.data, "");
+
+    ipx_msg_ipfix_t *in;
+    auto msgs = process({other, done}, &in);
+    ASSERT_EQ(msgs.size(), 1U);
+    EXPECT_EQ(msgs[0], in);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msgs[0]), 2U);
+    EXPECT_EQ(rec_get(msgs[0], 1)->tmplt, t_done);
+    destroy(msgs);
+}
@@ -0,0 +1,379 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <ftw.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+#include <plugins/output/fds/src/Storage.hpp>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/message_ipfix.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_tmgr = std::unique_ptr<fds_tmgr_t, decltype(&fds_tmgr_destroy)>;
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using unique_session = std::unique_ptr<struct ipx_session, decltype(&ipx_session_destroy)>;
+using unique_msg = std::unique_ptr<ipx_msg_ipfix_t, decltype(&ipx_msg_ipfix_destroy)>;
+using unique_file = std::unique_ptr<fds_file_t, decltype(&fds_file_close)>;
+using bytes = std::vector<uint8_t>;
+
+// Information Elements used by the tests
+static constexpr uint16_t IE_PROTO = 4;            // protocolIdentifier (1B)
+static constexpr uint16_t IE_SRC_PORT = 7;         // sourceTransportPort (2B)
+static constexpr uint16_t IE_SRC_IP = 8;           // sourceIPv4Address (4B)
+
+/** Field of a template (ID and length) */
+struct tfield {
+    uint16_t id;
+    uint16_t length;
+};
+
+/** Data Record to write (snapshot, ID of its Template and content) */
+struct wrec {
+    const fds_tsnapshot_t *snap;
+    uint16_t tid;
+    bytes data;
+};
+
+/** Data Record read from a file together with its context */
+struct rrec {
+    /// Source port of the Transport Session (identifies the session in the tests)
+    uint16_t port;
+    uint32_t odid;
+    uint32_t exp_time;
+    uint16_t tid;
+    /// IDs of the fields of the Template definition
+    std::vector<uint16_t> fields;
+    bytes data;
+};
+
+/** Remove a file or an empty directory (callback of nftw()) */
+static int
+remove_cb(const char *path, const struct stat *, int, struct FTW *)
+{
+    return remove(path);
+}
+
+/** Storage of a temporary directory */
+class FdsStorage : public ::testing::Test {
+protected:
+    unique_ctx ctx{nullptr, &ipx_ctx_destroy};
+    unique_session session1{nullptr, &ipx_session_destroy};
+    unique_session session2{nullptr, &ipx_session_destroy};
+    std::unique_ptr<Storage> storage;
+    /** Template managers of the snapshots (snapshots are valid until they are destroyed) */
+    std::vector<unique_tmgr> tmgrs;
+    std::string dir;
+
+    void SetUp() override {
+        char dir_tmp[] = "/tmp/ipx_fds_XXXXXX";
+        ASSERT_NE(mkdtemp(dir_tmp), nullptr);
+        dir = dir_tmp;
+
+        ctx.reset(ipx_ctx_create("fds", nullptr));
+        ASSERT_NE(ctx, nullptr);
+
+        const std::string params = "<params><storagePath>" + dir + "</storagePath>"
+            "<asyncIO>false</asyncIO></params>";
+        Config cfg(params.c_str());
+        storage.reset(new Storage(ctx.get(), cfg));
+
+        session1.reset(session_new(50000));
+        session2.reset(session_new(50001));
+        ASSERT_NE(session1, nullptr);
+        ASSERT_NE(session2, nullptr);
+    }
+
+    void TearDown() override {
+        storage.reset();
+        nftw(dir.c_str(), &remove_cb, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    /** Create a UDP Transport Session identified by its source port */
+    static struct ipx_session *session_new(uint16_t port) {
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = port;
+        net.port_dst = 4739;
+        if (inet_pton(AF_INET, "10.0.0.1", &net.addr_src.ipv4) != 1) {
+            return nullptr;
+        }
+        return ipx_session_new_udp(&net, 0, 0);
+    }
+
+    /** Create a snapshot with Templates (IDs and fields) */
+    const fds_tsnapshot_t *snapshot(const std::vector<std::pair<uint16_t,
+            std::vector<tfield>>> &tmplts) {
+        unique_tmgr tmgr(fds_tmgr_create(FDS_SESSION_FILE), &fds_tmgr_destroy);
+        EXPECT_NE(tmgr, nullptr);
+        EXPECT_EQ(fds_tmgr_set_time(tmgr.get(), 0), FDS_OK);
+
+        for (const auto &tmplt_def : tmplts) {
+            bytes raw;
+            put16(raw, tmplt_def.first);
+            put16(raw, static_cast<uint16_t>(tmplt_def.second.size()));
+            for (const auto &field : tmplt_def.second) {
+                put16(raw, field.id);
+                put16(raw, field.length);
+            }
+
+            uint16_t len = static_cast<uint16_t>(raw.size());
+            struct fds_template *tmplt;
+            EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &len, &tmplt), FDS_OK);
+            EXPECT_EQ(fds_tmgr_template_add(tmgr.get(), tmplt), FDS_OK);
+        }
+
+        const fds_tsnapshot_t *snap = nullptr;
+        EXPECT_EQ(fds_tmgr_snapshot_get(tmgr.get(), &snap), FDS_OK);
+        tmgrs.push_back(std::move(tmgr));
+        return snap;
+    }
+
+    /** Create an IPFIX Message of a Transport Session with the Data Records */
+    unique_msg message(struct ipx_session *session, uint32_t odid, uint32_t exp_time,
+        const std::vector<wrec> &recs) {
+        size_t size = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            size += rec.data.size();
+        }
+
+        uint8_t *raw = static_cast<uint8_t *>(calloc(1, size));
+        auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(raw);
+        hdr->version = htons(FDS_IPFIX_VERSION);
+        hdr->length = htons(static_cast<uint16_t>(size));
+        hdr->export_time = htonl(exp_time);
+        hdr->odid = htonl(odid);
+        struct ipx_msg_ctx msg_ctx;
+        msg_ctx.session = session;
+        msg_ctx.odid = odid;
+        msg_ctx.stream = 0;
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx.get(), &msg_ctx, raw,
+            static_cast<uint16_t>(size));
+        EXPECT_NE(msg, nullptr);
+
+        size_t offset = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            memcpy(raw + offset, rec.data.data(), rec.data.size());
+            struct ipx_ipfix_record *ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            EXPECT_NE(ref, nullptr);
+            ref->rec.data = raw + offset;
+            ref->rec.size = static_cast<uint16_t>(rec.data.size());
+            ref->rec.tmplt = fds_tsnapshot_template_get(rec.snap, rec.tid);
+            ref->rec.snap = rec.snap;
+            EXPECT_NE(ref->rec.tmplt, nullptr);
+            offset += rec.data.size();
+        }
+
+        return unique_msg(msg, &ipx_msg_ipfix_destroy);
+    }
+
+    /** Write an IPFIX Message of a Transport Session with the Data Records */
+    void write(struct ipx_session *session, uint32_t odid, uint32_t exp_time,
+        const std::vector<wrec> &recs) {
+        unique_msg msg = message(session, odid, exp_time, recs);
+        storage->process_msg(msg.get());
+    }
+
+    /** Read all Data Records of a window (the window must be closed) */
+    std::vector<rrec> read(time_t ts) {
+        char name[64];
+        struct tm utc_time;
+        gmtime_r(&ts, &utc_time);
+        strftime(name, sizeof(name), "/%Y/%m/%d/flows.%Y%m%d%H%M%S.fds", &utc_time);
+        const std::string path = dir + name;
+
+        std::vector<rrec> result;
+        unique_file file(fds_file_init(), &fds_file_close);
+        EXPECT_NE(file, nullptr);
+        if (fds_file_open(file.get(), path.c_str(), FDS_FILE_READ) != FDS_OK) {
+            ADD_FAILURE() << "Failed to open '" << path << "': " << fds_file_error(file.get());
+            return result;
+        }
+
+        struct fds_drec rec;
+        const struct fds_file_read_ctx *rec_ctx;
+        int rc;
+        while ((rc = fds_file_read_rec(file.get(), &rec, &rec_ctx)) == FDS_OK) {
+            const struct fds_file_session *info;
+            EXPECT_EQ(fds_file_session_get(file.get(), rec_ctx->sid, &info), FDS_OK);
+
+            rrec item;
+            item.port = info->port_src;
+            item.odid = rec_ctx->odid;
+            item.exp_time = rec_ctx->exp_time;
+            item.tid = rec.tmplt->id;
+            for (uint16_t i = 0; i < rec.tmplt->fields_cnt_total; ++i) {
+                item.fields.push_back(rec.tmplt->fields[i].id);
+            }
+            item.data.assign(rec.data, rec.data + rec.size);
+            result.push_back(std::move(item));
+        }
+
+        EXPECT_EQ(rc, FDS_EOC) << fds_file_error(file.get());
+        return result;
+    }
+
+    /** Append a 16-bit value in network byte order */
+    static void put16(bytes &out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+};
+
+/** Check a Data Record read from a file */
+static void
+rec_check(const rrec &rec, uint16_t port, uint32_t odid, uint16_t tid,
+    const std::vector<uint16_t> &fields, const bytes &data)
+{
+    EXPECT_EQ(rec.port, port);
+    EXPECT_EQ(rec.odid, odid);
+    EXPECT_EQ(rec.tid, tid);
+    EXPECT_EQ(rec.fields, fields);
+    EXPECT_EQ(rec.data, data);
+}
+
+// Template 256 (source address and port), 257 (protocol) and redefined 256 (source port only)
+static const std::vector<tfield> T256_V1 = {{IE_SRC_IP, 4}, {IE_SRC_PORT, 2}};
+static const std::vector<tfield> T256_V2 = {{IE_SRC_PORT, 2}};
+static const std::vector<tfield> T257 = {{IE_PROTO, 1}};
+
+static const bytes R1 = {10, 0, 0, 1, 0, 80};
+static const bytes R2 = {10, 0, 0, 2, 1, 187};
+static const bytes R3 = {6};
+static const bytes R4 = {0, 53};
+static const bytes R5 = {0, 22};
+
+// Records of a message are written in the original order, even if the message contains runs
+// of different Templates and snapshots (i.e. a Template has been redefined inside the message)
+TEST_F(FdsStorage, mixedRuns)
+{
+    const fds_tsnapshot_t *snap_a = snapshot({{256, T256_V1}, {257, T257}});
+    const fds_tsnapshot_t *snap_b = snapshot({{256, T256_V2}});
+
+    storage->window_new(0);
+    write(session1.get(), 1, 10, {
+        {snap_a, 256, R1}, {snap_a, 256, R2}, {snap_a, 257, R3},  // 2 runs of the snapshot A
+        {snap_b, 256, R4}, {snap_b, 256, R5},                     // redefinition of 256
+        {snap_a, 256, R2}, {snap_a, 257, R3},                     // the original definition
+        {snap_b, 256, R4}                                         // the last record only
+    });
+    storage->window_close();
+
+    const std::vector<uint16_t> f256_v1 = {IE_SRC_IP, IE_SRC_PORT};
+    const std::vector<uint16_t> f256_v2 = {IE_SRC_PORT};
+    const std::vector<uint16_t> f257 = {IE_PROTO};
+
+    std::vector<rrec> recs = read(0);
+    ASSERT_EQ(recs.size(), 8U);
+    rec_check(recs[0], 50000, 1, 256, f256_v1, R1);
+    rec_check(recs[1], 50000, 1, 256, f256_v1, R2);
+    rec_check(recs[2], 50000, 1, 257, f257, R3);
+    rec_check(recs[3], 50000, 1, 256, f256_v2, R4);
+    rec_check(recs[4], 50000, 1, 256, f256_v2, R5);
+    rec_check(recs[5], 50000, 1, 256, f256_v1, R2);
+    rec_check(recs[6], 50000, 1, 257, f257, R3);
+    rec_check(recs[7], 50000, 1, 256, f256_v2, R4);
+    for (const auto &rec : recs) {
+        EXPECT_EQ(rec.exp_time, 10U);
+    }
+}
+
+// Template definitions are kept separately for each combination of a Transport Session and
+// ODID, even if the combinations are interleaved (i.e. the cached lookup must be replaced)
+TEST_F(FdsStorage, sessionsAndOdids)
+{
+    const fds_tsnapshot_t *snap_a = snapshot({{256, T256_V1}, {257, T257}});
+    const fds_tsnapshot_t *snap_b = snapshot({{256, T256_V2}});
+
+    storage->window_new(0);
+    write(session1.get(), 1, 10, {{snap_a, 256, R1}});
+    write(session1.get(), 2, 11, {{snap_b, 256, R4}});
+    write(session2.get(), 1, 12, {{snap_b, 256, R5}});
+    write(session1.get(), 1, 13, {{snap_a, 256, R2}, {snap_a, 257, R3}});
+    write(session1.get(), 1, 14, {{snap_a, 256, R1}});  // the same combination again
+    write(session1.get(), 2, 15, {{snap_b, 256, R5}});
+    write(session2.get(), 1, 16, {{snap_a, 256, R2}});  // new snapshot of the session 2
+    storage->window_close();
+
+    const std::vector<uint16_t> f256_v1 = {IE_SRC_IP, IE_SRC_PORT};
+    const std::vector<uint16_t> f256_v2 = {IE_SRC_PORT};
+    const std::vector<uint16_t> f257 = {IE_PROTO};
+
+    std::vector<rrec> recs = read(0);
+    ASSERT_EQ(recs.size(), 8U);
+    rec_check(recs[0], 50000, 1, 256, f256_v1, R1);
+    rec_check(recs[1], 50000, 2, 256, f256_v2, R4);
+    rec_check(recs[2], 50001, 1, 256, f256_v2, R5);
+    rec_check(recs[3], 50000, 1, 256, f256_v1, R2);
+    rec_check(recs[4], 50000, 1, 257, f257, R3);
+    rec_check(recs[5], 50000, 1, 256, f256_v1, R1);
+    rec_check(recs[6], 50000, 2, 256, f256_v2, R5);
+    rec_check(recs[7], 50001, 1, 256, f256_v1, R2);
+
+    const std::vector<uint32_t> exp_times = {10, 11, 12, 13, 13, 14, 15, 16};
+    for (size_t i = 0; i < recs.size(); ++i) {
+        EXPECT_EQ(recs[i].exp_time, exp_times[i]) << "record " << i;
+    }
+}
+
+// A new window must not reuse the cached Transport Session and Templates of the previous file
+TEST_F(FdsStorage, windowReopen)
+{
+    const fds_tsnapshot_t *snap_a = snapshot({{256, T256_V1}, {257, T257}});
+
+    storage->window_new(0);
+    write(session1.get(), 1, 10, {{snap_a, 256, R1}});
+    storage->window_new(300);
+    write(session1.get(), 1, 310, {{snap_a, 256, R2}, {snap_a, 257, R3}});
+    storage->window_close();
+
+    const std::vector<uint16_t> f256_v1 = {IE_SRC_IP, IE_SRC_PORT};
+    const std::vector<uint16_t> f257 = {IE_PROTO};
+
+    std::vector<rrec> recs = read(0);
+    ASSERT_EQ(recs.size(), 1U);
+    rec_check(recs[0], 50000, 1, 256, f256_v1, R1);
+
+    recs = read(300);
+    ASSERT_EQ(recs.size(), 2U);
+    rec_check(recs[0], 50000, 1, 256, f256_v1, R2);
+    rec_check(recs[1], 50000, 1, 257, f257, R3);
+    EXPECT_EQ(recs[0].exp_time, 310U);
+}
+
+// Messages without a window or without Data Records are ignored
+TEST_F(FdsStorage, nothingToStore)
+{
+    const fds_tsnapshot_t *snap_a = snapshot({{256, T256_V1}, {257, T257}});
+
+    EXPECT_NO_THROW(write(session1.get(), 1, 10, {{snap_a, 256, R1}}));
+    storage->window_new(0);
+    EXPECT_NO_THROW(write(session1.get(), 1, 11, {}));
+    write(session2.get(), 1, 12, {{snap_a, 257, R3}});
+    storage->window_close();
+    EXPECT_NO_THROW(write(session1.get(), 1, 13, {{snap_a, 256, R2}}));
+
+    std::vector<rrec> recs = read(0);
+    ASSERT_EQ(recs.size(), 1U);
+    rec_check(recs[0], 50001, 1, 257, {IE_PROTO}, R3);
+    EXPECT_EQ(recs[0].exp_time, 12U);
+}
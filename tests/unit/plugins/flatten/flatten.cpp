@@ -0,0 +1,604 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/message_ipfix.h>
+    #include <core/message_terminate.h>
+    #include <core/ring.h>
+
+    // Callbacks of the plugin (the plugin is linked into the test)
+    extern struct ipx_plugin_info ipx_plugin_info;
+    int ipx_plugin_init(ipx_ctx_t *ctx, const char *params);
+    void ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg);
+    int ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_iemgr = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using unique_tmgr = std::unique_ptr<fds_tmgr_t, decltype(&fds_tmgr_destroy)>;
+using unique_ring = std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)>;
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using unique_session = std::unique_ptr<struct ipx_session, decltype(&ipx_session_destroy)>;
+using bytes = std::vector<uint8_t>;
+
+// Information Elements used by the tests
+static constexpr uint16_t IE_SRC_PORT = 7;         // sourceTransportPort (2B)
+static constexpr uint16_t IE_SRC_IP = 8;           // sourceIPv4Address (4B)
+static constexpr uint16_t IE_MPLS_LABEL = 70;      // mplsLabelStackSection (3B)
+static constexpr uint16_t IE_IFACE_NAME = 82;      // interfaceName (string)
+static constexpr uint16_t IE_APP_NAME = 96;        // applicationName (string)
+static constexpr uint16_t IE_VRF_ID = 234;         // ingressVRFID (4B)
+static constexpr uint16_t IE_BLIST = 291;          // basicList
+static constexpr uint16_t IE_STLIST = 292;         // subTemplateList
+static constexpr uint16_t VAR = FDS_IPFIX_VAR_IE_LEN;
+
+/** Append a 16-bit value in network byte order */
+static void
+put16(bytes &out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/** Append a 32-bit value in network byte order */
+static void
+put32(bytes &out, uint32_t value)
+{
+    put16(out, static_cast<uint16_t>(value >> 16));
+    put16(out, static_cast<uint16_t>(value));
+}
+
+/** Append a 24-bit value in network byte order */
+static void
+put24(bytes &out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    put16(out, static_cast<uint16_t>(value));
+}
+
+/** Append a variable-length value (with the short length prefix) */
+static void
+put_var(bytes &out, const bytes &value)
+{
+    out.push_back(static_cast<uint8_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+/** Append a variable-length string (with the short length prefix) */
+static void
+put_str(bytes &out, const std::string &str)
+{
+    put_var(out, bytes(str.begin(), str.end()));
+}
+
+/** Create a basicList of 3-byte MPLS labels (or of an other element) */
+static bytes
+blist(const std::vector<uint32_t> &labels, uint16_t id = IE_MPLS_LABEL)
+{
+    bytes out;
+    out.push_back(0x03); // allOf
+    put16(out, id);
+    put16(out, 3);
+    for (uint32_t label : labels) {
+        put24(out, label);
+    }
+    return out;
+}
+
+/** Create a subTemplateList of records of a template */
+static bytes
+stlist(uint16_t tid, const std::vector<bytes> &recs)
+{
+    bytes out;
+    out.push_back(0x03); // allOf
+    put16(out, tid);
+    for (const auto &rec : recs) {
+        out.insert(out.end(), rec.begin(), rec.end());
+    }
+    return out;
+}
+
+/** Child record of the template with sourceTransportPort and interfaceName */
+static bytes
+child(uint16_t port, const std::string &name)
+{
+    bytes out;
+    put16(out, port);
+    put_str(out, name);
+    return out;
+}
+
+/** Data Record and the ID of its Template */
+struct drec {
+    uint16_t tid;
+    bytes data;
+};
+
+/** Field of a template (ID and length) */
+struct tfield {
+    uint16_t id;
+    uint16_t length;
+};
+
+/** Instance of the plugin running in its own thread */
+class Flatten : public ::testing::Test {
+protected:
+    unique_iemgr iemgr{fds_iemgr_create(), &fds_iemgr_destroy};
+    unique_ring ring_in{ipx_ring_init(8, false), &ipx_ring_destroy};
+    unique_ring ring_out{ipx_ring_init(8, false), &ipx_ring_destroy};
+    struct ipx_ctx_callbacks cbs;
+    unique_ctx plugin{nullptr, &ipx_ctx_destroy};
+    bool running = false;
+    unique_session session{nullptr, &ipx_session_destroy};
+    /** Templates of the exporter (input records refer to its snapshots)          */
+    unique_tmgr tmgr{nullptr, &fds_tmgr_destroy};
+
+    void SetUp() override {
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr.get(), fds_api_cfg_dir()), FDS_OK);
+        memset(&cbs, 0, sizeof(cbs));
+        cbs.info = &ipx_plugin_info;
+        cbs.init = &ipx_plugin_init;
+        cbs.destroy = &ipx_plugin_destroy;
+        cbs.process = &ipx_plugin_process;
+
+        plugin.reset(ipx_ctx_create("flatten", &cbs));
+        ASSERT_NE(plugin, nullptr);
+        ipx_ctx_iemgr_set(plugin.get(), iemgr.get());
+        ipx_ctx_ring_src_set(plugin.get(), ring_in.get());
+        ipx_ctx_ring_dst_set(plugin.get(), ring_out.get());
+
+        tmgr.reset(fds_tmgr_create(FDS_SESSION_FILE));
+        ASSERT_NE(tmgr, nullptr);
+        ASSERT_EQ(fds_tmgr_set_iemgr(tmgr.get(), iemgr.get()), FDS_OK);
+        ASSERT_EQ(fds_tmgr_set_time(tmgr.get(), 0), FDS_OK);
+
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = 50000;
+        net.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "10.0.0.1", &net.addr_src.ipv4), 1);
+        session.reset(ipx_session_new_udp(&net, 0, 0));
+        ASSERT_NE(session, nullptr);
+    }
+
+    void TearDown() override {
+        if (running) {
+            // Stop the thread and wait for the termination message
+            ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+            ipx_ring_push(ring_in.get(), ipx_msg_terminate2base(msg));
+            ipx_msg_t *out = ipx_ring_pop(ring_out.get());
+            EXPECT_EQ(ipx_msg_get_type(out), IPX_MSG_TERMINATE);
+            ipx_msg_termiante_destroy(ipx_msg_base2terminate(out));
+        }
+
+        plugin.reset();
+    }
+
+    /** Initialize the instance and start its thread */
+    void start(const std::string &params) {
+        ASSERT_EQ(ipx_ctx_init(plugin.get(), params.c_str()), IPX_OK);
+        ipx_ctx_t *pipeline[] = {plugin.get()};
+        size_t rec_size;
+        ASSERT_EQ(ipx_ctx_rext_resolve(pipeline, 1, &rec_size), IPX_OK);
+        ipx_ctx_recsize_set(plugin.get(), rec_size);
+        ASSERT_EQ(ipx_ctx_run(plugin.get()), IPX_OK);
+        running = true;
+    }
+
+    /** Define a Template of the exporter (fields are pairs of an ID and a length) */
+    void tmplt_add(enum fds_template_type type, uint16_t id, uint16_t scope_cnt,
+        const std::vector<tfield> &fields) {
+        bytes raw;
+        put16(raw, id);
+        put16(raw, static_cast<uint16_t>(fields.size()));
+        if (type == FDS_TYPE_TEMPLATE_OPTS) {
+            put16(raw, scope_cnt);
+        }
+        for (const auto &field : fields) {
+            put16(raw, field.id);
+            put16(raw, field.length);
+        }
+
+        uint16_t len = static_cast<uint16_t>(raw.size());
+        struct fds_template *tmplt;
+        ASSERT_EQ(fds_template_parse(type, raw.data(), &len, &tmplt), FDS_OK);
+        ASSERT_EQ(fds_tmgr_template_add(tmgr.get(), tmplt), FDS_OK);
+    }
+
+    /**
+     * \brief Pass an IPFIX Message with the Data Records through the instance
+     *
+     * A Transport Session Message is sent after the IPFIX Message, so all messages produced
+     * by the instance (IPFIX and garbage messages) can be collected without waiting.
+     * \return Produced IPFIX Messages (the garbage messages are destroyed)
+     */
+    std::vector<ipx_msg_ipfix_t *> process(uint32_t odid, const std::vector<drec> &recs,
+        ipx_msg_ipfix_t **in = nullptr) {
+        const fds_tsnapshot_t *snap;
+        EXPECT_EQ(fds_tmgr_snapshot_get(tmgr.get(), &snap), FDS_OK);
+
+        size_t size = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            size += rec.data.size();
+        }
+
+        uint8_t *raw = static_cast<uint8_t *>(calloc(1, size));
+        auto *hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(raw);
+        hdr->version = htons(FDS_IPFIX_VERSION);
+        hdr->length = htons(static_cast<uint16_t>(size));
+        hdr->odid = htonl(odid);
+        struct ipx_msg_ctx msg_ctx;
+        msg_ctx.session = session.get();
+        msg_ctx.odid = odid;
+        msg_ctx.stream = 0;
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(plugin.get(), &msg_ctx, raw,
+            static_cast<uint16_t>(size));
+        EXPECT_NE(msg, nullptr);
+
+        size_t offset = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            memcpy(raw + offset, rec.data.data(), rec.data.size());
+            struct ipx_ipfix_record *ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            EXPECT_NE(ref, nullptr);
+            ref->rec.data = raw + offset;
+            ref->rec.size = static_cast<uint16_t>(rec.data.size());
+            ref->rec.tmplt = fds_tsnapshot_template_get(snap, rec.tid);
+            ref->rec.snap = snap;
+            EXPECT_NE(ref->rec.tmplt, nullptr);
+            offset += rec.data.size();
+        }
+        if (in != nullptr) {
+            *in = msg;
+        }
+
+        ipx_msg_session_t *marker = ipx_msg_session_create(session.get(), IPX_MSG_SESSION_OPEN);
+        EXPECT_EQ(ipx_ring_push(ring_in.get(), ipx_msg_ipfix2base(msg)), IPX_OK);
+        EXPECT_EQ(ipx_ring_push(ring_in.get(), ipx_msg_session2base(marker)), IPX_OK);
+        return collect();
+    }
+
+    /** Collect IPFIX Messages produced by the instance up to a Transport Session Message */
+    std::vector<ipx_msg_ipfix_t *> collect() {
+        std::vector<ipx_msg_ipfix_t *> result;
+        while (true) {
+            ipx_msg_t *out = ipx_ring_pop(ring_out.get());
+            switch (ipx_msg_get_type(out)) {
+            case IPX_MSG_IPFIX:
+                result.push_back(ipx_msg_base2ipfix(out));
+                break;
+            case IPX_MSG_GARBAGE:
+                ipx_msg_garbage_destroy(ipx_msg_base2garbage(out));
+                break;
+            case IPX_MSG_SESSION:
+                ipx_msg_session_destroy(ipx_msg_base2session(out));
+                return result;
+            default:
+                ADD_FAILURE() << "Unexpected message type";
+                return result;
+            }
+        }
+    }
+
+    /** Destroy produced IPFIX Messages */
+    static void destroy(std::vector<ipx_msg_ipfix_t *> &msgs) {
+        for (auto *msg : msgs) {
+            ipx_msg_ipfix_destroy(msg);
+        }
+        msgs.clear();
+    }
+};
+
+/** Get a record of a message */
+static const struct fds_drec *
+rec_get(ipx_msg_ipfix_t *msg, uint32_t idx)
+{
+    return &ipx_msg_ipfix_get_drec(msg, idx)->rec;
+}
+
+/** Get the raw content of a record */
+static bytes
+rec_data(const struct fds_drec *rec)
+{
+    return bytes(rec->data, rec->data + rec->size);
+}
+
+/** Get IDs of all Sets of a message */
+static std::vector<uint16_t>
+set_ids(ipx_msg_ipfix_t *msg)
+{
+    struct ipx_ipfix_set *sets;
+    size_t cnt;
+    ipx_msg_ipfix_get_sets(msg, &sets, &cnt);
+
+    std::vector<uint16_t> ids;
+    for (size_t i = 0; i < cnt; ++i) {
+        ids.push_back(ntohs(sets[i].ptr->flowset_id));
+    }
+    return ids;
+}
+
+/** Check the Template ID and fields of a template */
+static void
+tmplt_check(const struct fds_template *tmplt, uint16_t id, const std::vector<tfield> &fields)
+{
+    ASSERT_NE(tmplt, nullptr);
+    EXPECT_EQ(tmplt->id, id);
+    EXPECT_EQ(tmplt->type, FDS_TYPE_TEMPLATE);
+    ASSERT_EQ(tmplt->fields_cnt_total, fields.size());
+    for (size_t i = 0; i < fields.size(); ++i) {
+        SCOPED_TRACE("field " + std::to_string(i));
+        EXPECT_EQ(tmplt->fields[i].en, 0U);
+        EXPECT_EQ(tmplt->fields[i].id, fields[i].id);
+        EXPECT_EQ(tmplt->fields[i].length, fields[i].length);
+    }
+}
+
+static const char *PARAMS_BLIST =
+    "<params><basicList>"
+    "<element>iana:mplsLabelStackSection</element><positions>3</positions>"
+    "</basicList></params>";
+static const char *PARAMS_SPLIT =
+    "<params><childRecords><field>iana:subTemplateList</field></childRecords></params>";
+
+// Invalid configurations are refused
+TEST_F(Flatten, invalidParams)
+{
+    const std::vector<std::string> params = {
+        "<params/>",
+        "<params><basicList><element>iana:mplsLabelStackSection</element>"
+            "<positions>0</positions></basicList></params>",
+        "<params><basicList><element>iana:unknownElement</element>"
+            "<positions>1</positions></basicList></params>",
+        "<params><basicList><element>iana:subTemplateList</element>"
+            "<positions>1</positions></basicList></params>",
+        "<params><childRecords><field>iana:sourceIPv4Address</field></childRecords></params>",
+    };
+
+    for (const auto &param : params) {
+        SCOPED_TRACE(param);
+        EXPECT_NE(ipx_plugin_init(plugin.get(), param.c_str()), IPX_OK);
+    }
+}
+
+// basicLists are replaced by positional fields under the source Template ID
+TEST_F(Flatten, positionalFields)
+{
+    start(PARAMS_BLIST);
+    tmplt_add(FDS_TYPE_TEMPLATE, 256, 0, {{IE_SRC_IP, 4}, {IE_BLIST, VAR}, {IE_APP_NAME, VAR}});
+
+    auto rec = [](uint32_t ip, const bytes &list, const std::string &name) {
+        drec out{256, {}};
+        put32(out.data, ip);
+        put_var(out.data, list);
+        put_str(out.data, name);
+        return out;
+    };
+
+    auto msgs = process(1, {
+        rec(0x0A000001, blist({16, 17}), "http"),          // missing position
+        rec(0x0A000002, blist({1, 2, 3, 4}), "dns"),       // items over the positions
+        rec(0x0A000003, blist({5}, IE_VRF_ID), ""),        // different list element
+    });
+    ASSERT_EQ(msgs.size(), 1U);
+    ipx_msg_ipfix_t *msg = msgs[0];
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 3U);
+
+    // The derived template is defined at the beginning of the message
+    const auto *hdr = reinterpret_cast<const struct fds_ipfix_msg_hdr *>(
+        ipx_msg_ipfix_get_packet(msg));
+    EXPECT_EQ(ntohs(hdr->version), FDS_IPFIX_VERSION);
+    EXPECT_EQ(ntohl(hdr->odid), 1U);
+    EXPECT_EQ(set_ids(msg), (std::vector<uint16_t>{FDS_IPFIX_SET_TMPLT, 256}));
+
+    const std::vector<tfield> layout = {{IE_SRC_IP, 4}, {IE_MPLS_LABEL, 3}, {IE_MPLS_LABEL, 3},
+        {IE_MPLS_LABEL, 3}, {IE_APP_NAME, VAR}};
+    for (uint32_t i = 0; i < 3; ++i) {
+        SCOPED_TRACE("record " + std::to_string(i));
+        tmplt_check(rec_get(msg, i)->tmplt, 256, layout);
+        EXPECT_NE(rec_get(msg, i)->snap, nullptr);
+    }
+
+    bytes exp;
+    put32(exp, 0x0A000001);
+    put24(exp, 16);
+    put24(exp, 17);
+    put24(exp, 0);
+    put_str(exp, "http");
+    EXPECT_EQ(rec_data(rec_get(msg, 0)), exp);
+
+    exp.clear();
+    put32(exp, 0x0A000002);
+    put24(exp, 1);
+    put24(exp, 2);
+    put24(exp, 3);
+    put_str(exp, "dns");
+    EXPECT_EQ(rec_data(rec_get(msg, 1)), exp);
+
+    exp.clear();
+    put32(exp, 0x0A000003);
+    exp.insert(exp.end(), 9, 0);
+    put_str(exp, "");
+    EXPECT_EQ(rec_data(rec_get(msg, 2)), exp);
+    destroy(msgs);
+
+    // Following messages reuse the template (it's not defined again)
+    msgs = process(1, {rec(0x0A000004, blist({}), "ntp")});
+    ASSERT_EQ(msgs.size(), 1U);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msgs[0]), 1U);
+    EXPECT_EQ(set_ids(msgs[0]), std::vector<uint16_t>{256});
+    tmplt_check(rec_get(msgs[0], 0)->tmplt, 256, layout);
+    exp.clear();
+    put32(exp, 0x0A000004);
+    exp.insert(exp.end(), 9, 0);
+    put_str(exp, "ntp");
+    EXPECT_EQ(rec_data(rec_get(msgs[0], 0)), exp);
+    destroy(msgs);
+}
+
+// Child records are merged with the other fields of the parent record
+TEST_F(Flatten, childRecords)
+{
+    start(PARAMS_SPLIT);
+    tmplt_add(FDS_TYPE_TEMPLATE, 300, 0, {{IE_SRC_PORT, 2}, {IE_IFACE_NAME, VAR}});
+    tmplt_add(FDS_TYPE_TEMPLATE, 301, 0, {{IE_VRF_ID, 4}});
+    tmplt_add(FDS_TYPE_TEMPLATE, 256, 0, {{IE_SRC_IP, 4}, {IE_STLIST, VAR}, {IE_APP_NAME, VAR}});
+
+    auto rec = [](uint32_t ip, const bytes &list, const std::string &name) {
+        drec out{256, {}};
+        put32(out.data, ip);
+        put_var(out.data, list);
+        put_str(out.data, name);
+        return out;
+    };
+
+    bytes vrf;
+    put32(vrf, 7);
+    auto msgs = process(1, {
+        rec(0x0A000001, stlist(300, {child(80, "eth0"), child(443, "eth1")}), "http"),
+        rec(0x0A000002, stlist(300, {}), "dns"),
+        rec(0x0A000003, stlist(301, {vrf}), ""),
+    });
+    ASSERT_EQ(msgs.size(), 1U);
+    ipx_msg_ipfix_t *msg = msgs[0];
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 4U);
+
+    // Fields of the parent (without the list) followed by fields of the child template
+    const std::vector<tfield> parent = {{IE_SRC_IP, 4}, {IE_APP_NAME, VAR}};
+    std::vector<tfield> with_iface = parent;
+    with_iface.push_back({IE_SRC_PORT, 2});
+    with_iface.push_back({IE_IFACE_NAME, VAR});
+    std::vector<tfield> with_vrf = parent;
+    with_vrf.push_back({IE_VRF_ID, 4});
+
+    tmplt_check(rec_get(msg, 0)->tmplt, 65535, with_iface);
+    EXPECT_EQ(rec_get(msg, 1)->tmplt, rec_get(msg, 0)->tmplt);
+    tmplt_check(rec_get(msg, 2)->tmplt, 65534, parent);
+    tmplt_check(rec_get(msg, 3)->tmplt, 65533, with_vrf);
+
+    bytes exp;
+    put32(exp, 0x0A000001);
+    put_str(exp, "http");
+    put16(exp, 80);
+    put_str(exp, "eth0");
+    EXPECT_EQ(rec_data(rec_get(msg, 0)), exp);
+
+    exp.clear();
+    put32(exp, 0x0A000001);
+    put_str(exp, "http");
+    put16(exp, 443);
+    put_str(exp, "eth1");
+    EXPECT_EQ(rec_data(rec_get(msg, 1)), exp);
+
+    // A parent without child records is preserved without the list
+    exp.clear();
+    put32(exp, 0x0A000002);
+    put_str(exp, "dns");
+    EXPECT_EQ(rec_data(rec_get(msg, 2)), exp);
+
+    exp.clear();
+    put32(exp, 0x0A000003);
+    put_str(exp, "");
+    put32(exp, 7);
+    EXPECT_EQ(rec_data(rec_get(msg, 3)), exp);
+
+    // All derived templates are defined in the message
+    EXPECT_EQ(set_ids(msg), (std::vector<uint16_t>{FDS_IPFIX_SET_TMPLT, 65535, 65534, 65533}));
+    destroy(msgs);
+
+    // Derived templates are cached per child template
+    msgs = process(1, {rec(0x0A000004, stlist(300, {child(22, "lo")}), "ssh")});
+    ASSERT_EQ(msgs.size(), 1U);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msgs[0]), 1U);
+    tmplt_check(rec_get(msgs[0], 0)->tmplt, 65535, with_iface);
+    exp.clear();
+    put32(exp, 0x0A000004);
+    put_str(exp, "ssh");
+    put16(exp, 22);
+    put_str(exp, "lo");
+    EXPECT_EQ(rec_data(rec_get(msgs[0], 0)), exp);
+    destroy(msgs);
+}
+
+// Messages without anything to convert are passed as they are, once a domain is converted,
+// other records (including Options records) are copied under their own templates
+TEST_F(Flatten, passThrough)
+{
+    start(PARAMS_BLIST);
+    tmplt_add(FDS_TYPE_TEMPLATE, 256, 0, {{IE_SRC_IP, 4}, {IE_BLIST, VAR}});
+    tmplt_add(FDS_TYPE_TEMPLATE, 257, 0, {{IE_SRC_IP, 4}, {IE_APP_NAME, VAR}});
+    tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 258, 1, {{IE_VRF_ID, 4}, {IE_BLIST, VAR}});
+
+    drec plain{257, {}};
+    put32(plain.data, 0x0A000001);
+    put_str(plain.data, "http");
+    drec opts{258, {}};
+    put32(opts.data, 1);
+    put_var(opts.data, blist({5, 6}));
+    drec flow{256, {}};
+    put32(flow.data, 0x0A000002);
+    put_var(flow.data, blist({5, 6}));
+
+    // Nothing to convert (the options record is never converted)
+    ipx_msg_ipfix_t *in;
+    auto msgs = process(1, {plain, opts}, &in);
+    ASSERT_EQ(msgs.size(), 1U);
+    EXPECT_EQ(msgs[0], in);
+    destroy(msgs);
+
+    // The domain requires conversion, the message is rebuilt
+    msgs = process(1, {plain, flow, opts}, &in);
+    ASSERT_EQ(msgs.size(), 1U);
+    ipx_msg_ipfix_t *msg = msgs[0];
+    EXPECT_NE(msg, in);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 3U);
+
+    tmplt_check(rec_get(msg, 0)->tmplt, 257, {{IE_SRC_IP, 4}, {IE_APP_NAME, VAR}});
+    EXPECT_EQ(rec_data(rec_get(msg, 0)), plain.data);
+    tmplt_check(rec_get(msg, 1)->tmplt, 256, {{IE_SRC_IP, 4}, {IE_MPLS_LABEL, 3},
+        {IE_MPLS_LABEL, 3}, {IE_MPLS_LABEL, 3}});
+    const struct fds_template *t_opts = rec_get(msg, 2)->tmplt;
+    ASSERT_NE(t_opts, nullptr);
+    EXPECT_EQ(t_opts->type, FDS_TYPE_TEMPLATE_OPTS);
+    EXPECT_EQ(t_opts->id, 258U);
+    EXPECT_EQ(t_opts->fields_cnt_scope, 1U);
+    EXPECT_EQ(rec_data(rec_get(msg, 2)), opts.data);
+
+    // Both Template Set and Options Template Set are defined
+    EXPECT_EQ(set_ids(msg), (std::vector<uint16_t>{FDS_IPFIX_SET_TMPLT,
+        FDS_IPFIX_SET_OPTS_TMPLT, 257, 256, 258}));
+    destroy(msgs);
+
+    // Other Observation Domains are not affected
+    msgs = process(2, {plain}, &in);
+    ASSERT_EQ(msgs.size(), 1U);
+    EXPECT_EQ(msgs[0], in);
+    destroy(msgs);
+
+    // After the session is closed, the domain is converted from scratch
+    ipx_msg_session_t *close = ipx_msg_session_create(session.get(), IPX_MSG_SESSION_CLOSE);
+    ASSERT_EQ(ipx_ring_push(ring_in.get(), ipx_msg_session2base(close)), IPX_OK);
+    EXPECT_TRUE(collect().empty());
+    msgs = process(1, {plain}, &in);
+    ASSERT_EQ(msgs.size(), 1U);
+    EXPECT_EQ(msgs[0], in);
+    destroy(msgs);
+}
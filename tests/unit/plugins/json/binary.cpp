@@ -0,0 +1,405 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <libfds.h>
+#include <plugins/output/json/src/Binary.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_tmplt = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using bytes = std::vector<uint8_t>;
+using elem_scope = std::remove_pointer<decltype(fds_iemgr_elem::scope)>::type;
+
+/** Append bytes */
+static bytes &
+operator<<(bytes &out, const bytes &in)
+{
+    out.insert(out.end(), in.begin(), in.end());
+    return out;
+}
+
+/** Append a 16-bit value in network byte order */
+static void
+put16(bytes &out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/** Definition of an Information Element used by the tests */
+struct elem_def {
+    uint32_t en;
+    uint16_t id;
+    const char *name;
+    enum fds_iemgr_element_type type;
+};
+
+/** Converter of records with Templates made of known Information Elements */
+class Encoder : public ::testing::TestWithParam<enum encoding> {
+protected:
+    elem_scope scope_iana;
+    elem_scope scope_test;
+    std::vector<std::unique_ptr<struct fds_iemgr_elem>> elems;
+    std::vector<unique_tmplt> tmplts;
+    struct cfg_format fmt;
+
+    void SetUp() override {
+        memset(&scope_iana, 0, sizeof(scope_iana));
+        memset(&scope_test, 0, sizeof(scope_test));
+        scope_iana.name = const_cast<char *>("iana");
+        scope_test.name = const_cast<char *>("test");
+
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.encoding = GetParam();
+    }
+
+    bool cbor() const {
+        return GetParam() == encoding::CBOR;
+    }
+
+    /** Encoded text string (shorter than 256 bytes) */
+    bytes text(const std::string &str) const {
+        const uint8_t len = static_cast<uint8_t>(str.size());
+        bytes out;
+        if (cbor()) {
+            out = (len < 24) ? bytes{static_cast<uint8_t>(0x60 | len)} : bytes{0x78, len};
+        } else {
+            out = (len < 32) ? bytes{static_cast<uint8_t>(0xA0 | len)} : bytes{0xD9, len};
+        }
+        out.insert(out.end(), str.begin(), str.end());
+        return out;
+    }
+
+    /** Encoded head of a map or an array with 32-bit count */
+    bytes container(bool map, uint32_t cnt) const {
+        bytes out;
+        if (cbor()) {
+            out.push_back(map ? 0xBA : 0x9A);
+        } else {
+            out.push_back(map ? 0xDF : 0xDD);
+        }
+        out.push_back(static_cast<uint8_t>(cnt >> 24));
+        out.push_back(static_cast<uint8_t>(cnt >> 16));
+        out.push_back(static_cast<uint8_t>(cnt >> 8));
+        out.push_back(static_cast<uint8_t>(cnt));
+        return out;
+    }
+
+    /** Either CBOR or MessagePack bytes based on the tested encoding */
+    bytes pick(const bytes &c, const bytes &m) const {
+        return cbor() ? c : m;
+    }
+
+    /**
+     * \brief Parse a Template and assign definitions of its fields
+     *
+     * Fields without a definition (nullptr) are unknown.
+     */
+    struct fds_template *
+    tmplt_add(enum fds_template_type type, uint16_t id,
+        const std::vector<std::pair<const elem_def *, uint16_t>> &fields) {
+        bytes raw;
+        put16(raw, id);
+        put16(raw, static_cast<uint16_t>(fields.size()));
+        if (type == FDS_TYPE_TEMPLATE_OPTS) {
+            put16(raw, 1);
+        }
+        for (const auto &field : fields) {
+            const elem_def *def = field.first;
+            put16(raw, static_cast<uint16_t>(def->id | ((def->en != 0) ? 0x8000 : 0)));
+            put16(raw, field.second);
+            if (def->en != 0) {
+                put16(raw, static_cast<uint16_t>(def->en >> 16));
+                put16(raw, static_cast<uint16_t>(def->en));
+            }
+        }
+
+        uint16_t len = static_cast<uint16_t>(raw.size());
+        struct fds_template *tmplt;
+        EXPECT_EQ(fds_template_parse(type, raw.data(), &len, &tmplt), FDS_OK);
+        tmplts.emplace_back(tmplt, &fds_template_destroy);
+
+        for (uint16_t i = 0; i < tmplt->fields_cnt_total; ++i) {
+            const elem_def *def = fields[i].first;
+            if (def->name == nullptr) {
+                continue; // unknown
+            }
+            elems.emplace_back(new struct fds_iemgr_elem());
+            struct fds_iemgr_elem *elem = elems.back().get();
+            elem->id = def->id;
+            elem->name = const_cast<char *>(def->name);
+            elem->scope = (def->en == 0) ? &scope_iana : &scope_test;
+            elem->data_type = def->type;
+            tmplt->fields[i].def = elem;
+        }
+        return tmplt;
+    }
+
+    /** Convert a record and compare the result */
+    void expect_record(const struct fds_template *tmplt, bytes data, const bytes &expected,
+        const struct fds_ipfix_msg_hdr *hdr = nullptr, const char *src_addr = nullptr) {
+        struct fds_drec rec;
+        rec.data = data.data();
+        rec.size = static_cast<uint16_t>(data.size());
+        rec.tmplt = tmplt;
+        rec.snap = nullptr;
+
+        Binary conv(fmt);
+        conv.convert(rec, hdr, src_addr, false);
+        const bytes result(conv.data(), conv.data() + conv.size());
+        EXPECT_EQ(result, expected);
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Encoding, Encoder, ::testing::Values(encoding::CBOR, encoding::MSGPACK));
+
+static const elem_def IE_BYTES      = {0, 1, "octetDeltaCount", FDS_ET_UNSIGNED_64};
+static const elem_def IE_PKTS       = {0, 2, "packetDeltaCount", FDS_ET_UNSIGNED_64};
+static const elem_def IE_SRC_IP4    = {0, 8, "sourceIPv4Address", FDS_ET_IPV4_ADDRESS};
+static const elem_def IE_SRC_IP6    = {0, 27, "sourceIPv6Address", FDS_ET_IPV6_ADDRESS};
+static const elem_def IE_IF_NAME    = {0, 82, "interfaceName", FDS_ET_STRING};
+static const elem_def IE_APP_DESC   = {0, 94, "applicationDescription", FDS_ET_STRING};
+static const elem_def IE_START_SEC  = {0, 150, "flowStartSeconds", FDS_ET_DATE_TIME_SECONDS};
+static const elem_def IE_START_MS   = {0, 152, "flowStartMilliseconds",
+    FDS_ET_DATE_TIME_MILLISECONDS};
+static const elem_def IE_SIGNED     = {10, 100, "signed", FDS_ET_SIGNED_32};
+static const elem_def IE_FLOAT      = {10, 101, "float", FDS_ET_FLOAT_64};
+static const elem_def IE_BOOL       = {10, 102, "bool", FDS_ET_BOOLEAN};
+static const elem_def IE_UNKNOWN    = {10, 103, nullptr, FDS_ET_OCTET_ARRAY};
+
+// All supported types of values are stored as native types of the encoding
+TEST_P(Encoder, valueTypes)
+{
+    const struct fds_template *tmplt = tmplt_add(FDS_TYPE_TEMPLATE, 256, {
+        {&IE_BYTES, 8}, {&IE_SRC_IP4, 4}, {&IE_SRC_IP6, 16}, {&IE_START_SEC, 4},
+        {&IE_START_MS, 8}, {&IE_SIGNED, 4}, {&IE_FLOAT, 8}, {&IE_BOOL, 1},
+        {&IE_IF_NAME, 0xFFFF}, {&IE_APP_DESC, 3}, {&IE_UNKNOWN, 2}
+    });
+
+    bytes data = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xE8,             // 1000
+        0x0A, 0x00, 0x00, 0x01,                                     // 10.0.0.1
+        0x20, 0x01, 0x0D, 0xB8, 0x00, 0x00, 0x00, 0x00,             // 2001:db8::1
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        0x59, 0x68, 0x2F, 0x00,                                     // 1500000000 s
+        0x00, 0x00, 0x01, 0x5D, 0x3E, 0xF7, 0x99, 0xF4,             // 1500000000500 ms
+        0xFF, 0xFF, 0xFF, 0x9C,                                     // -100
+        0x3F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,             // 1.5
+        0x01,                                                       // true
+        0x04, 'e', 't', 'h', '0',                                   // "eth0"
+        0xFF, 0xFE, 0x41,                                           // invalid UTF-8
+        0xBE, 0xEF                                                  // unknown
+    };
+
+    bytes exp;
+    exp << container(true, 12) << text("@type") << text("ipfix.entry");
+    exp << text("iana:octetDeltaCount") << pick({0x19, 0x03, 0xE8}, {0xCD, 0x03, 0xE8});
+    exp << text("iana:sourceIPv4Address")
+        << pick({0xD8, 0x34, 0x44}, {0xC4, 0x04}) << bytes{0x0A, 0x00, 0x00, 0x01};
+    exp << text("iana:sourceIPv6Address")
+        << pick({0xD8, 0x36, 0x50}, {0xC4, 0x10})
+        << bytes{0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+    exp << text("iana:flowStartSeconds")
+        << pick({0xC1, 0x1A}, {0xD6, 0xFF}) << bytes{0x59, 0x68, 0x2F, 0x00};
+    // CBOR: epoch time as a double (1500000000.5), MessagePack: 64-bit timestamp
+    exp << text("iana:flowStartMilliseconds") << pick(
+        {0xC1, 0xFB, 0x41, 0xD6, 0x5A, 0x0B, 0xC0, 0x20, 0x00, 0x00},
+        {0xD7, 0xFF, 0x77, 0x35, 0x94, 0x00, 0x59, 0x68, 0x2F, 0x00});
+    exp << text("test:signed") << pick({0x38, 0x63}, {0xD0, 0x9C});
+    exp << text("test:float") << pick({0xFB}, {0xCB})
+        << bytes{0x3F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    exp << text("test:bool") << pick({0xF5}, {0xC3});
+    exp << text("iana:interfaceName") << text("eth0");
+    exp << text("iana:applicationDescription") << pick({0x43}, {0xC4, 0x03})
+        << bytes{0xFF, 0xFE, 0x41};
+    exp << text("en10:id103") << pick({0x42}, {0xC4, 0x02}) << bytes{0xBE, 0xEF};
+
+    expect_record(tmplt, data, exp);
+}
+
+// Integers are stored in the shortest form
+TEST_P(Encoder, integerSizes)
+{
+    const struct fds_template *tmplt = tmplt_add(FDS_TYPE_TEMPLATE, 256, {
+        {&IE_BYTES, 1}, {&IE_BYTES, 2}, {&IE_BYTES, 4}, {&IE_BYTES, 8},
+        {&IE_SIGNED, 1}, {&IE_SIGNED, 2}, {&IE_SIGNED, 4}
+    });
+    bytes data = {
+        0x17,                                                       // 23
+        0x00, 0xC8,                                                 // 200
+        0x00, 0x01, 0x00, 0x00,                                     // 65536
+        0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,             // 2^32
+        0xE0,                                                       // -32
+        0xFF, 0x7F,                                                 // -129
+        0xFF, 0xFF, 0x00, 0x00,                                     // -65536
+    };
+
+    // Multiple occurrences of the same element are stored as an array
+    bytes exp;
+    exp << container(true, 3) << text("@type") << text("ipfix.entry");
+    exp << text("iana:octetDeltaCount") << container(false, 4) << pick(
+        {0x17, 0x18, 0xC8, 0x1A, 0x00, 0x01, 0x00, 0x00,
+         0x1B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00},
+        {0x17, 0xCC, 0xC8, 0xCE, 0x00, 0x01, 0x00, 0x00,
+         0xCF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00});
+    exp << text("test:signed") << container(false, 3) << pick(
+        {0x38, 0x1F, 0x38, 0x80, 0x39, 0xFF, 0xFF},
+        {0xE0, 0xD1, 0xFF, 0x7F, 0xD2, 0xFF, 0xFF, 0x00, 0x00});
+
+    expect_record(tmplt, data, exp);
+}
+
+// Numeric names of fields, detailed info and Options Template records
+TEST_P(Encoder, detailedInfo)
+{
+    fmt.numeric_names = true;
+    fmt.detailed_info = true;
+    const struct fds_template *tmplt = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 300, {
+        {&IE_PKTS, 4}
+    });
+    bytes data = {0x00, 0x00, 0x00, 0x05};
+
+    struct fds_ipfix_msg_hdr hdr;
+    hdr.version = htons(FDS_IPFIX_VERSION);
+    hdr.length = htons(100);
+    hdr.export_time = htonl(1000);
+    hdr.seq_num = htonl(70000);
+    hdr.odid = htonl(1);
+
+    bytes exp;
+    exp << container(true, 8) << text("@type") << text("ipfix.optionsEntry");
+    exp << text("en0:id2") << bytes{0x05};
+    exp << text("ipfix:exportTime") << pick({0x19, 0x03, 0xE8}, {0xCD, 0x03, 0xE8});
+    exp << text("ipfix:seqNumber")
+        << pick({0x1A, 0x00, 0x01, 0x11, 0x70}, {0xCE, 0x00, 0x01, 0x11, 0x70});
+    exp << text("ipfix:odid") << bytes{0x01};
+    exp << text("ipfix:msgLength") << pick({0x18, 0x64}, {0x64});
+    exp << text("ipfix:srcAddr") << text("10.0.0.1");
+    exp << text("ipfix:templateId") << pick({0x19, 0x01, 0x2C}, {0xCD, 0x01, 0x2C});
+
+    expect_record(tmplt, data, exp, &hdr, "10.0.0.1");
+}
+
+// Conversion of a Template definition
+TEST_P(Encoder, tmplt)
+{
+    const struct fds_template *tmplt = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 300, {
+        {&IE_PKTS, 4}, {&IE_UNKNOWN, 0xFFFF}
+    });
+
+    Binary conv(fmt);
+    conv.convert_tmplt(tmplt, nullptr, nullptr);
+    const bytes result(conv.data(), conv.data() + conv.size());
+
+    bytes exp;
+    exp << container(true, 4) << text("@type") << text("ipfix.optionsTemplate");
+    exp << text("ipfix:templateId") << pick({0x19, 0x01, 0x2C}, {0xCD, 0x01, 0x2C});
+    exp << text("ipfix:scopeCount") << bytes{0x01};
+    exp << text("ipfix:fields") << container(false, 2);
+    exp << container(true, 3) << text("ipfix:elementId") << bytes{0x02}
+        << text("ipfix:enterpriseId") << bytes{0x00}
+        << text("ipfix:fieldLength") << bytes{0x04};
+    exp << container(true, 3) << text("ipfix:elementId") << pick({0x18, 0x67}, {0x67})
+        << text("ipfix:enterpriseId") << bytes{0x0A}
+        << text("ipfix:fieldLength") << pick({0x19, 0xFF, 0xFF}, {0xCD, 0xFF, 0xFF});
+    EXPECT_EQ(result, exp);
+}
+
+/** Encoders compared by the benchmark (including the JSON text) */
+class EncoderBench : public Encoder {};
+
+INSTANTIATE_TEST_CASE_P(Encoding, EncoderBench,
+    ::testing::Values(encoding::JSON, encoding::CBOR, encoding::MSGPACK));
+
+// Compare the size of encoded records and encoder throughput of JSON, CBOR and MessagePack.
+// It's a benchmark without any assertions, run it explicitly with
+// "--gtest_also_run_disabled_tests --gtest_filter=*EncoderBench*".
+TEST_P(EncoderBench, DISABLED_throughput)
+{
+    // A typical flow record
+    const struct fds_template *tmplt = tmplt_add(FDS_TYPE_TEMPLATE, 256, {
+        {&IE_BYTES, 8}, {&IE_PKTS, 8}, {&IE_SRC_IP4, 4}, {&IE_SRC_IP6, 16},
+        {&IE_START_MS, 8}, {&IE_SIGNED, 4}, {&IE_IF_NAME, 0xFFFF}
+    });
+
+    // Records with different values (short and long integers, names, etc.)
+    const size_t rec_variants = 1024;
+    std::vector<bytes> data(rec_variants);
+    for (size_t i = 0; i < rec_variants; ++i) {
+        bytes &rec = data[i];
+        const uint64_t octets = uint64_t(i) * 1499U;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            rec.push_back(static_cast<uint8_t>(octets >> shift));
+        }
+        rec << bytes{0, 0, 0, 0, 0, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+        rec << bytes{10, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+        rec << bytes{0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+        rec << bytes{0x00, 0x00, 0x01, 0x5D, 0x3E, 0xF7, static_cast<uint8_t>(i >> 8),
+            static_cast<uint8_t>(i)};
+        rec << bytes{0xFF, 0xFF, 0xFF, static_cast<uint8_t>(i)};
+        const std::string name = "eth" + std::to_string(i % 16);
+        rec.push_back(static_cast<uint8_t>(name.size()));
+        rec.insert(rec.end(), name.begin(), name.end());
+    }
+
+    std::vector<struct fds_drec> recs(rec_variants);
+    for (size_t i = 0; i < rec_variants; ++i) {
+        recs[i].data = data[i].data();
+        recs[i].size = static_cast<uint16_t>(data[i].size());
+        recs[i].tmplt = tmplt;
+        recs[i].snap = nullptr;
+    }
+
+    const size_t rec_cnt = 1000000;
+    uint64_t total_size = 0;
+    Binary conv(fmt);
+    char *json_buffer = nullptr;
+    size_t json_alloc = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rec_cnt; ++i) {
+        struct fds_drec &rec = recs[i % rec_variants];
+        if (GetParam() == encoding::JSON) {
+            int rc = fds_drec2json(&rec, FDS_CD2J_ALLOW_REALLOC, nullptr, &json_buffer,
+                &json_alloc);
+            ASSERT_GE(rc, 0);
+            total_size += static_cast<uint64_t>(rc);
+        } else {
+            conv.convert(rec, nullptr, nullptr, false);
+            total_size += conv.size();
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    free(json_buffer);
+
+    const double duration = std::chrono::duration<double>(end - start).count();
+    const double rec_size = static_cast<double>(total_size) / rec_cnt;
+    const double rec_rate = rec_cnt / duration;
+    const char *name = (GetParam() == encoding::JSON) ? "JSON"
+        : ((GetParam() == encoding::CBOR) ? "CBOR" : "MessagePack");
+
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed
+        << std::setprecision(1) << std::setw(8) << rec_size << " B/record "
+        << std::setprecision(0) << std::setw(12) << rec_rate << " records/s" << std::endl;
+
+    RecordProperty("bytes_per_record", std::to_string(rec_size));
+    RecordProperty("records_per_second", std::to_string(rec_rate));
+}
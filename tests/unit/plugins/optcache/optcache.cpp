@@ -0,0 +1,581 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/message_ipfix.h>
+    #include <core/message_terminate.h>
+    #include <core/ring.h>
+    #include <plugins/intermediate/optcache/cache.h>
+    #include <plugins/intermediate/optcache/optcache.h>
+
+    // Callbacks of the plugin (the plugin is linked into the test)
+    extern struct ipx_plugin_info ipx_plugin_info;
+    int ipx_plugin_init(ipx_ctx_t *ctx, const char *params);
+    void ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg);
+    int ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_iemgr = std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)>;
+using unique_ring = std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)>;
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using unique_tmplt = std::unique_ptr<struct fds_template, decltype(&fds_template_destroy)>;
+using unique_session = std::unique_ptr<struct ipx_session, decltype(&ipx_session_destroy)>;
+using bytes = std::vector<uint8_t>;
+
+// -------------------------------------------------------------------------------------------------
+// Lookup tables
+
+// Entries are kept sorted regardless of the order of insertion
+TEST(OptCacheTable, insertAndFind)
+{
+    struct oc_table tbl = {nullptr, 0, 0};
+    EXPECT_EQ(oc_table_find(&tbl, 0), nullptr);
+
+    // More entries than are allocated at once, in a non-monotonic order
+    const uint64_t cnt = 100;
+    for (uint64_t i = 0; i < cnt; ++i) {
+        const uint64_t key = (i * 37U) % cnt * 2U; // only even keys
+        struct oc_entry *entry = oc_table_set(&tbl, key);
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(entry->key, key);
+        EXPECT_EQ(entry->value, 0U);
+        EXPECT_STREQ(entry->name, "");
+        entry->value = static_cast<uint32_t>(key + 1);
+    }
+
+    ASSERT_EQ(tbl.cnt, cnt);
+    for (size_t i = 1; i < tbl.cnt; ++i) {
+        EXPECT_LT(tbl.items[i - 1].key, tbl.items[i].key);
+    }
+
+    for (uint64_t key = 0; key < 2 * cnt; ++key) {
+        const struct oc_entry *entry = oc_table_find(&tbl, key);
+        if (key % 2 != 0) {
+            EXPECT_EQ(entry, nullptr);
+            continue;
+        }
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(entry->value, key + 1);
+    }
+    EXPECT_EQ(oc_table_find(&tbl, UINT64_MAX), nullptr);
+
+    // Existing entries are not duplicated nor reset
+    struct oc_entry *entry = oc_table_set(&tbl, 10);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->value, 11U);
+    EXPECT_EQ(tbl.cnt, cnt);
+    free(tbl.items);
+}
+
+// Domains are identified by the Transport Session and ODID
+TEST(OptCacheDomains, getAndRemove)
+{
+    struct oc_domains domains = {nullptr, 0, nullptr};
+    const auto *s1 = reinterpret_cast<const struct ipx_session *>(0x10);
+    const auto *s2 = reinterpret_cast<const struct ipx_session *>(0x20);
+
+    EXPECT_EQ(oc_domains_get(&domains, s1, 1, false), nullptr);
+    struct oc_domain *d11 = oc_domains_get(&domains, s1, 1, true);
+    struct oc_domain *d12 = oc_domains_get(&domains, s1, 2, true);
+    struct oc_domain *d21 = oc_domains_get(&domains, s2, 1, true);
+    ASSERT_NE(d11, nullptr);
+    ASSERT_NE(d12, nullptr);
+    ASSERT_NE(d21, nullptr);
+    EXPECT_NE(d11, d12);
+    EXPECT_NE(d11, d21);
+    EXPECT_EQ(domains.cnt, 3U);
+
+    // The last accessed domain is cached, others are found too
+    EXPECT_EQ(domains.last, d21);
+    EXPECT_EQ(oc_domains_get(&domains, s1, 1, false), d11);
+    EXPECT_EQ(domains.last, d11);
+    EXPECT_EQ(oc_domains_get(&domains, s1, 1, true), d11);
+    EXPECT_EQ(oc_domains_get(&domains, s2, 2, false), nullptr);
+    EXPECT_EQ(domains.cnt, 3U);
+
+    ASSERT_NE(oc_table_set(&d11->ifaces, 1), nullptr);
+    ASSERT_NE(oc_table_set(&d12->vrfs, 1), nullptr);
+
+    // All domains of the session are removed
+    oc_domains_remove(&domains, s1);
+    EXPECT_EQ(domains.cnt, 1U);
+    EXPECT_EQ(domains.last, nullptr);
+    EXPECT_EQ(oc_domains_get(&domains, s1, 1, false), nullptr);
+    EXPECT_EQ(oc_domains_get(&domains, s1, 2, false), nullptr);
+    EXPECT_EQ(oc_domains_get(&domains, s2, 1, false), d21);
+
+    oc_domains_clear(&domains);
+    EXPECT_EQ(domains.cnt, 0U);
+    EXPECT_EQ(domains.items, nullptr);
+    EXPECT_EQ(oc_domains_get(&domains, s2, 1, false), nullptr);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Plugin instance
+
+/** Consumer of the extension produced by the plugin */
+static ipx_ctx_rext_t *consumer_rext = nullptr;
+
+static int
+consumer_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+    ipx_ctx_private_set(ctx, ctx);
+    return ipx_ctx_rext_consumer(ctx, OPTCACHE_EXT_TYPE, OPTCACHE_EXT_NAME, &consumer_rext);
+}
+
+static void
+consumer_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    (void) cfg;
+}
+
+static int
+consumer_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    (void) cfg;
+    (void) msg;
+    return IPX_OK;
+}
+
+/** Append a 16-bit value in network byte order */
+static void
+put16(bytes &out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/** Append a 32-bit value in network byte order */
+static void
+put32(bytes &out, uint32_t value)
+{
+    put16(out, static_cast<uint16_t>(value >> 16));
+    put16(out, static_cast<uint16_t>(value));
+}
+
+/** Append a variable-length string (with the long length prefix, if necessary) */
+static void
+put_str(bytes &out, const std::string &str)
+{
+    if (str.size() < 255) {
+        out.push_back(static_cast<uint8_t>(str.size()));
+    } else {
+        out.push_back(255);
+        put16(out, static_cast<uint16_t>(str.size()));
+    }
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+/** Data Record and its Template */
+struct drec {
+    const struct fds_template *tmplt;
+    bytes data;
+};
+
+/** Instance of the plugin running in its own thread and a consumer of its extension */
+class OptCache : public ::testing::Test {
+protected:
+    unique_iemgr iemgr{fds_iemgr_create(), &fds_iemgr_destroy};
+    unique_ring ring_in{ipx_ring_init(8, false), &ipx_ring_destroy};
+    unique_ring ring_out{ipx_ring_init(8, false), &ipx_ring_destroy};
+    struct ipx_ctx_callbacks cbs_plugin;
+    struct ipx_ctx_callbacks cbs_consumer;
+    struct ipx_plugin_info info_consumer;
+    unique_ctx plugin{nullptr, &ipx_ctx_destroy};
+    unique_ctx consumer{nullptr, &ipx_ctx_destroy};
+    bool running = false;
+    std::vector<unique_tmplt> tmplts;
+    unique_session session1{nullptr, &ipx_session_destroy};
+    unique_session session2{nullptr, &ipx_session_destroy};
+
+    /** Options: ingressInterface (scope), interfaceName (variable-length)       */
+    const struct fds_template *t_iface;
+    /** Options: egressInterface (scope), interfaceDescription                   */
+    const struct fds_template *t_iface_desc;
+    /** Options: ingressVRFID (scope), VRFname (8 bytes)                         */
+    const struct fds_template *t_vrf;
+    /** Options: samplerId (scope), samplingInterval, samplerName                */
+    const struct fds_template *t_sampler;
+    /** Options: meteringProcessId (scope), samplingInterval                     */
+    const struct fds_template *t_sampling;
+    /** Options: private field and ingressInterface (scope), interfaceName       */
+    const struct fds_template *t_private;
+    /** Data: ingressInterface, egressInterface, ingressVRFID, samplerId         */
+    const struct fds_template *t_flow;
+    /** Data: variable-length field followed by ingressInterface                 */
+    const struct fds_template *t_flow_var;
+    /** Data: sourceIPv4Address only                                             */
+    const struct fds_template *t_other;
+
+    void SetUp() override {
+        memset(&cbs_plugin, 0, sizeof(cbs_plugin));
+        cbs_plugin.info = &ipx_plugin_info;
+        cbs_plugin.init = &ipx_plugin_init;
+        cbs_plugin.destroy = &ipx_plugin_destroy;
+        cbs_plugin.process = &ipx_plugin_process;
+
+        memset(&info_consumer, 0, sizeof(info_consumer));
+        info_consumer.name = "consumer";
+        info_consumer.dsc = "Consumer of the extension";
+        info_consumer.type = IPX_PT_OUTPUT;
+        info_consumer.version = "1.0.0";
+        info_consumer.ipx_min = "2.0.0";
+        memset(&cbs_consumer, 0, sizeof(cbs_consumer));
+        cbs_consumer.info = &info_consumer;
+        cbs_consumer.init = &consumer_init;
+        cbs_consumer.destroy = &consumer_destroy;
+        cbs_consumer.process = &consumer_process;
+
+        plugin.reset(ipx_ctx_create("optcache", &cbs_plugin));
+        consumer.reset(ipx_ctx_create("consumer", &cbs_consumer));
+        ASSERT_NE(plugin, nullptr);
+        ASSERT_NE(consumer, nullptr);
+        ipx_ctx_iemgr_set(plugin.get(), iemgr.get());
+        ipx_ctx_iemgr_set(consumer.get(), iemgr.get());
+        ipx_ctx_ring_src_set(plugin.get(), ring_in.get());
+        ipx_ctx_ring_dst_set(plugin.get(), ring_out.get());
+        ipx_ctx_ring_src_set(consumer.get(), ring_out.get());
+
+        ASSERT_EQ(ipx_ctx_init(plugin.get(), "<params/>"), IPX_OK);
+        ASSERT_EQ(ipx_ctx_init(consumer.get(), nullptr), IPX_OK);
+        ipx_ctx_t *pipeline[] = {plugin.get(), consumer.get()};
+        size_t rec_size;
+        ASSERT_EQ(ipx_ctx_rext_resolve(pipeline, 2, &rec_size), IPX_OK);
+        ipx_ctx_recsize_set(plugin.get(), rec_size);
+
+        // The consumer only resolves the extension, the test reads the output ring instead
+        ASSERT_EQ(ipx_ctx_run(plugin.get()), IPX_OK);
+        running = true;
+
+        t_iface = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 300, 1, {{10, 4}, {82, 0xFFFF}});
+        t_iface_desc = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 301, 1, {{14, 4}, {83, 16}});
+        t_vrf = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 302, 1, {{234, 4}, {236, 8}});
+        t_sampler = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 303, 1, {{48, 1}, {34, 4}, {84, 0xFFFF}});
+        t_sampling = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 304, 1, {{143, 4}, {34, 4}});
+        t_private = tmplt_add(FDS_TYPE_TEMPLATE_OPTS, 305, 2, {{0x8001, 4}, {10, 4}, {82, 8}});
+        t_flow = tmplt_add(FDS_TYPE_TEMPLATE, 256, 0, {{10, 4}, {14, 4}, {234, 4}, {48, 1}});
+        t_flow_var = tmplt_add(FDS_TYPE_TEMPLATE, 257, 0, {{96, 0xFFFF}, {10, 4}});
+        t_other = tmplt_add(FDS_TYPE_TEMPLATE, 258, 0, {{8, 4}});
+
+        session1 = session_create("10.0.0.1");
+        session2 = session_create("10.0.0.2");
+    }
+
+    void TearDown() override {
+        if (running) {
+            // Stop the thread and wait for the termination message
+            ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+            ipx_ring_push(ring_in.get(), ipx_msg_terminate2base(msg));
+            ipx_msg_t *out = ipx_ring_pop(ring_out.get());
+            EXPECT_EQ(ipx_msg_get_type(out), IPX_MSG_TERMINATE);
+            ipx_msg_termiante_destroy(ipx_msg_base2terminate(out));
+        }
+
+        plugin.reset();
+        consumer.reset();
+        consumer_rext = nullptr;
+    }
+
+    /** Parse a Template (fields are pairs of an ID and a length, bit 15 means PEN 1) */
+    const struct fds_template *
+    tmplt_add(enum fds_template_type type, uint16_t id, uint16_t scope_cnt,
+        const std::vector<std::pair<uint16_t, uint16_t>> &fields) {
+        bytes raw;
+        put16(raw, id);
+        put16(raw, static_cast<uint16_t>(fields.size()));
+        if (type == FDS_TYPE_TEMPLATE_OPTS) {
+            put16(raw, scope_cnt);
+        }
+        for (const auto &field : fields) {
+            put16(raw, field.first);
+            put16(raw, field.second);
+            if (field.first & 0x8000) {
+                put32(raw, 1);
+            }
+        }
+
+        uint16_t len = static_cast<uint16_t>(raw.size());
+        struct fds_template *tmplt;
+        EXPECT_EQ(fds_template_parse(type, raw.data(), &len, &tmplt), FDS_OK);
+        tmplts.emplace_back(tmplt, &fds_template_destroy);
+        return tmplt;
+    }
+
+    /** Create a Transport Session of an exporter */
+    static unique_session session_create(const char *addr) {
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = 50000;
+        net.port_dst = 4739;
+        EXPECT_EQ(inet_pton(AF_INET, addr, &net.addr_src.ipv4), 1);
+        return unique_session(ipx_session_new_udp(&net, 0, 0), &ipx_session_destroy);
+    }
+
+    /** Pass a message through the instance */
+    ipx_msg_t *process(ipx_msg_t *msg) {
+        EXPECT_EQ(ipx_ring_push(ring_in.get(), msg), IPX_OK);
+        return ipx_ring_pop(ring_out.get());
+    }
+
+    /** Pass an IPFIX Message with the Data Records through the instance */
+    ipx_msg_ipfix_t *process(const struct ipx_session *session, uint32_t odid,
+        const std::vector<drec> &recs) {
+        size_t size = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            size += rec.data.size();
+        }
+
+        uint8_t *raw = static_cast<uint8_t *>(calloc(1, size));
+        struct ipx_msg_ctx msg_ctx;
+        msg_ctx.session = session;
+        msg_ctx.odid = odid;
+        msg_ctx.stream = 0;
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(plugin.get(), &msg_ctx, raw,
+            static_cast<uint16_t>(size));
+        EXPECT_NE(msg, nullptr);
+
+        size_t offset = FDS_IPFIX_MSG_HDR_LEN;
+        for (const auto &rec : recs) {
+            memcpy(raw + offset, rec.data.data(), rec.data.size());
+            struct ipx_ipfix_record *ref = ipx_msg_ipfix_add_drec_ref(&msg);
+            EXPECT_NE(ref, nullptr);
+            ref->rec.data = raw + offset;
+            ref->rec.size = static_cast<uint16_t>(rec.data.size());
+            ref->rec.tmplt = rec.tmplt;
+            ref->rec.snap = nullptr;
+            offset += rec.data.size();
+        }
+
+        ipx_msg_t *out = process(ipx_msg_ipfix2base(msg));
+        EXPECT_EQ(ipx_msg_get_type(out), IPX_MSG_IPFIX);
+        return ipx_msg_base2ipfix(out);
+    }
+
+    /** Close a Transport Session */
+    void close(const struct ipx_session *session) {
+        ipx_msg_session_t *msg = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+        ipx_msg_t *out = process(ipx_msg_session2base(msg));
+        EXPECT_EQ(ipx_msg_get_type(out), IPX_MSG_SESSION);
+        ipx_msg_session_destroy(ipx_msg_base2session(out));
+    }
+
+    /** Get the metadata of a Data Record (NULL, if not filled) */
+    static const struct optcache_meta *
+    meta(ipx_msg_ipfix_t *msg, uint32_t idx) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(msg, idx);
+        void *data;
+        size_t size;
+        if (ipx_ctx_rext_get(consumer_rext, rec, &data, &size) != IPX_OK) {
+            return nullptr;
+        }
+        EXPECT_EQ(size, sizeof(struct optcache_meta));
+        return static_cast<const struct optcache_meta *>(data);
+    }
+
+    // Records of the Templates
+    drec iface(uint32_t idx, const std::string &name) {
+        drec rec{t_iface, {}};
+        put32(rec.data, idx);
+        put_str(rec.data, name);
+        return rec;
+    }
+    drec iface_desc(uint32_t idx, const std::string &desc) {
+        drec rec{t_iface_desc, {}};
+        put32(rec.data, idx);
+        bytes padded(16, 0);
+        memcpy(padded.data(), desc.data(), std::min<size_t>(desc.size(), 16));
+        rec.data.insert(rec.data.end(), padded.begin(), padded.end());
+        return rec;
+    }
+    drec vrf(uint32_t id, const std::string &name) {
+        drec rec{t_vrf, {}};
+        put32(rec.data, id);
+        bytes padded(8, 0);
+        memcpy(padded.data(), name.data(), std::min<size_t>(name.size(), 8));
+        rec.data.insert(rec.data.end(), padded.begin(), padded.end());
+        return rec;
+    }
+    drec sampler(uint8_t id, uint32_t interval, const std::string &name) {
+        drec rec{t_sampler, {id}};
+        put32(rec.data, interval);
+        put_str(rec.data, name);
+        return rec;
+    }
+    drec sampling(uint32_t interval) {
+        drec rec{t_sampling, {}};
+        put32(rec.data, 1);
+        put32(rec.data, interval);
+        return rec;
+    }
+    drec priv(uint32_t idx, const std::string &name) {
+        drec rec{t_private, {}};
+        put32(rec.data, 1);
+        put32(rec.data, idx);
+        bytes padded(8, 0);
+        memcpy(padded.data(), name.data(), std::min<size_t>(name.size(), 8));
+        rec.data.insert(rec.data.end(), padded.begin(), padded.end());
+        return rec;
+    }
+    drec flow(uint32_t in_if, uint32_t out_if, uint32_t vrf_id, uint8_t sampler_id) {
+        drec rec{t_flow, {}};
+        put32(rec.data, in_if);
+        put32(rec.data, out_if);
+        put32(rec.data, vrf_id);
+        rec.data.push_back(sampler_id);
+        return rec;
+    }
+    drec flow_var(const std::string &app, uint32_t in_if) {
+        drec rec{t_flow_var, {}};
+        put_str(rec.data, app);
+        put32(rec.data, in_if);
+        return rec;
+    }
+    drec other() {
+        drec rec{t_other, {}};
+        put32(rec.data, 0x0A000001);
+        return rec;
+    }
+};
+
+// Metadata are resolved using options records received earlier (or in the same message)
+TEST_F(OptCache, lookup)
+{
+    ipx_msg_ipfix_t *msg = process(session1.get(), 1, {
+        iface(1, "eth0"), iface(2, "eth1"), vrf(7, "red"), sampler(3, 100, "s1"),
+        flow(1, 2, 7, 3)
+    });
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 5U);
+    for (uint32_t i = 0; i < 4; ++i) {
+        // Options records are not annotated
+        EXPECT_EQ(meta(msg, i), nullptr);
+    }
+
+    const struct optcache_meta *res = meta(msg, 4);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->in_if_name, "eth0");
+    EXPECT_STREQ(res->out_if_name, "eth1");
+    EXPECT_STREQ(res->in_vrf_name, "red");
+    EXPECT_STREQ(res->out_vrf_name, "");
+    EXPECT_STREQ(res->sampler_name, "s1");
+    EXPECT_EQ(res->sampling_interval, 100U);
+    ipx_msg_ipfix_destroy(msg);
+
+    // Unknown keys, a variable-length field before the key and records without any key
+    msg = process(session1.get(), 1, {
+        flow(5, 1, 8, 9), flow_var("http", 2), flow_var(std::string(300, 'x'), 1), other()
+    });
+    res = meta(msg, 0);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->in_if_name, "");
+    EXPECT_STREQ(res->out_if_name, "eth0");
+    EXPECT_STREQ(res->in_vrf_name, "");
+    EXPECT_STREQ(res->sampler_name, "");
+    EXPECT_EQ(res->sampling_interval, 0U);
+
+    res = meta(msg, 1);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->in_if_name, "eth1");
+    res = meta(msg, 2);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->in_if_name, "eth0");
+    EXPECT_EQ(meta(msg, 3), nullptr);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Tables are selected by the first known scope field
+TEST_F(OptCache, scopeMatching)
+{
+    ipx_msg_ipfix_t *msg = process(session1.get(), 1, {
+        iface_desc(4, "uplink"),    // egress scope fills the same table
+        priv(5, "private"),         // enterprise-specific scope fields are skipped
+        sampling(64),               // no known scope field, i.e. sampling of the whole domain
+        flow(4, 5, 0, 1)
+    });
+
+    const struct optcache_meta *res = meta(msg, 3);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->in_if_name, "uplink");
+    EXPECT_STREQ(res->out_if_name, "private");
+    EXPECT_STREQ(res->sampler_name, "");
+    EXPECT_EQ(res->sampling_interval, 64U);
+    ipx_msg_ipfix_destroy(msg);
+
+    // A known sampler takes precedence over the sampling of the whole domain
+    msg = process(session1.get(), 1, {sampler(1, 10, "fast"), flow(0, 0, 0, 1), flow(0, 0, 0, 2)});
+    res = meta(msg, 1);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->sampler_name, "fast");
+    EXPECT_EQ(res->sampling_interval, 10U);
+    res = meta(msg, 2);
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->sampling_interval, 64U);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Newer options records replace older ones, long names are truncated
+TEST_F(OptCache, update)
+{
+    const std::string long_name(40, 'n');
+    ipx_msg_ipfix_t *msg = process(session1.get(), 1, {
+        iface(1, "old"), iface(1, "new"), iface(2, long_name), flow(1, 2, 0, 0)
+    });
+
+    const struct optcache_meta *res = meta(msg, 3);
+    ASSERT_NE(res, nullptr);
+    EXPECT_STREQ(res->in_if_name, "new");
+    EXPECT_EQ(std::string(res->out_if_name), long_name.substr(0, OPTCACHE_NAME_LEN - 1));
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Options data are kept per Transport Session and ODID and removed with the session
+TEST_F(OptCache, expiry)
+{
+    ipx_msg_ipfix_t *msg = process(session1.get(), 1, {iface(1, "eth0")});
+    ipx_msg_ipfix_destroy(msg);
+    msg = process(session2.get(), 1, {iface(1, "ge-0/0/0")});
+    ipx_msg_ipfix_destroy(msg);
+
+    // Another ODID of the same session doesn't have any options data
+    msg = process(session1.get(), 2, {flow(1, 0, 0, 0)});
+    EXPECT_EQ(meta(msg, 0), nullptr);
+    ipx_msg_ipfix_destroy(msg);
+
+    msg = process(session2.get(), 1, {flow(1, 0, 0, 0)});
+    ASSERT_NE(meta(msg, 0), nullptr);
+    EXPECT_STREQ(meta(msg, 0)->in_if_name, "ge-0/0/0");
+    ipx_msg_ipfix_destroy(msg);
+
+    close(session1.get());
+    msg = process(session1.get(), 1, {flow(1, 0, 0, 0)});
+    EXPECT_EQ(meta(msg, 0), nullptr);
+    ipx_msg_ipfix_destroy(msg);
+
+    msg = process(session2.get(), 1, {flow(1, 0, 0, 0)});
+    ASSERT_NE(meta(msg, 0), nullptr);
+    EXPECT_STREQ(meta(msg, 0)->in_if_name, "ge-0/0/0");
+    ipx_msg_ipfix_destroy(msg);
+}
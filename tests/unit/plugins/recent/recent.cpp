@@ -0,0 +1,367 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <plugins/output/recent/src/Block.hpp>
+#include <plugins/output/recent/src/Cache.hpp>
+#include <plugins/output/recent/src/Config.hpp>
+#include <plugins/output/recent/src/Exception.hpp>
+#include <plugins/output/recent/src/Query.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Convert an IPv4 or IPv6 address to IPv6 (IPv4-mapped) representation */
+static void
+ip_set(uint8_t *out, const char *str)
+{
+    static const uint8_t prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    if (inet_pton(AF_INET, str, out + sizeof(prefix)) == 1) {
+        std::memcpy(out, prefix, sizeof(prefix));
+        return;
+    }
+
+    ASSERT_EQ(inet_pton(AF_INET6, str, out), 1) << str;
+}
+
+/** Create a flow record */
+static Flow
+flow_new(uint64_t ts_first, uint64_t ts_last, const char *src, const char *dst,
+    uint16_t src_port, uint16_t dst_port, uint8_t proto, uint8_t tcp_flags, uint64_t packets,
+    uint64_t bytes, uint32_t odid)
+{
+    Flow flow;
+    std::memset(&flow, 0, sizeof(flow));
+    flow.ts_first = ts_first;
+    flow.ts_last = ts_last;
+    ip_set(flow.src_ip, src);
+    ip_set(flow.dst_ip, dst);
+    flow.src_port = src_port;
+    flow.dst_port = dst_port;
+    flow.proto = proto;
+    flow.tcp_flags = tcp_flags;
+    flow.packets = packets;
+    flow.bytes = bytes;
+    flow.odid = odid;
+    return flow;
+}
+
+/** Check that the selected columns of two records are the same */
+static void
+flow_check(const Flow &flow, const Flow &exp, ColumnMask cols = COLUMNS_ALL)
+{
+    auto has = [cols](Column col) {return (cols & column_bit(col)) != 0;};
+
+    if (has(Column::TS_FIRST)) {
+        EXPECT_EQ(flow.ts_first, exp.ts_first);
+    }
+    if (has(Column::TS_LAST)) {
+        EXPECT_EQ(flow.ts_last, exp.ts_last);
+    }
+    if (has(Column::BYTES)) {
+        EXPECT_EQ(flow.bytes, exp.bytes);
+    }
+    if (has(Column::PACKETS)) {
+        EXPECT_EQ(flow.packets, exp.packets);
+    }
+    if (has(Column::SRC_IP)) {
+        EXPECT_EQ(std::memcmp(flow.src_ip, exp.src_ip, 16), 0);
+    }
+    if (has(Column::DST_IP)) {
+        EXPECT_EQ(std::memcmp(flow.dst_ip, exp.dst_ip, 16), 0);
+    }
+    if (has(Column::ODID)) {
+        EXPECT_EQ(flow.odid, exp.odid);
+    }
+    if (has(Column::SRC_PORT)) {
+        EXPECT_EQ(flow.src_port, exp.src_port);
+    }
+    if (has(Column::DST_PORT)) {
+        EXPECT_EQ(flow.dst_port, exp.dst_port);
+    }
+    if (has(Column::PROTO)) {
+        EXPECT_EQ(flow.proto, exp.proto);
+    }
+    if (has(Column::TCP_FLAGS)) {
+        EXPECT_EQ(flow.tcp_flags, exp.tcp_flags);
+    }
+}
+
+/** Create a configuration of the cache */
+static std::unique_ptr<Config>
+config_new(uint32_t window, uint32_t mem_limit, uint32_t block_size)
+{
+    const std::string params = "<params><socketPath>/tmp/recent.sock</socketPath>"
+        "<timeWindow>" + std::to_string(window) + "</timeWindow>"
+        "<memoryLimit>" + std::to_string(mem_limit) + "</memoryLimit>"
+        "<blockSize>" + std::to_string(block_size) + "</blockSize></params>";
+    return std::unique_ptr<Config>(new Config(params.c_str()));
+}
+
+// Encoded records are decoded without any change (IPv4-mapped and IPv6 addresses,
+// non-monotonic timestamps and values of the full range)
+TEST(Block, roundTrip)
+{
+    const std::vector<Flow> flows = {
+        flow_new(1500000000000, 1500000001000, "10.0.0.1", "10.0.0.2", 1024, 53, 17, 0,
+            1, 64, 1),
+        flow_new(1400000000000, 1400000000500, "2001:db8::1", "10.0.0.1", 443, 50000, 6, 0x1B,
+            12, 4000, 1),
+        flow_new(0, UINT64_MAX, "::ffff:10.0.0.1", "::", 0, 65535, 255, 0xFF,
+            UINT64_MAX, UINT64_MAX, UINT32_MAX),
+        flow_new(1500000000000, 1500000000000, "2001:db8::1", "2001:db8::2", 80, 80, 6, 0x02,
+            0, 0, 0),
+        flow_new(UINT64_MAX, 1, "0.0.0.0", "255.255.255.255", 1, 2, 1, 1, 1U << 31,
+            uint64_t(1) << 40, 7),
+    };
+
+    Block block(flows, 100);
+    EXPECT_EQ(block.count(), flows.size());
+    EXPECT_EQ(block.ts_min(), 0U);
+    EXPECT_EQ(block.ts_max(), UINT64_MAX);
+    EXPECT_EQ(block.created(), 100);
+
+    std::vector<Flow> out;
+    block.decode(COLUMNS_ALL, out);
+    ASSERT_EQ(out.size(), flows.size());
+    for (size_t i = 0; i < flows.size(); ++i) {
+        SCOPED_TRACE("record " + std::to_string(i));
+        flow_check(out[i], flows[i]);
+    }
+
+    // Only selected columns
+    const ColumnMask cols = column_bit(Column::TS_LAST) | column_bit(Column::DST_IP)
+        | column_bit(Column::PROTO);
+    block.decode(cols, out);
+    ASSERT_EQ(out.size(), flows.size());
+    for (size_t i = 0; i < flows.size(); ++i) {
+        SCOPED_TRACE("record " + std::to_string(i));
+        flow_check(out[i], flows[i], cols);
+    }
+}
+
+// Repeated addresses are stored only once, IPv4 addresses are stored in the short form
+TEST(Block, dictionary)
+{
+    const size_t cnt = 1000;
+    std::vector<Flow> flows_v4;
+    std::vector<Flow> flows_v6;
+    std::vector<Flow> flows_uniq;
+    for (size_t i = 0; i < cnt; ++i) {
+        const std::string uniq = "2001:db8::" + std::to_string(i + 1);
+        flows_v4.push_back(flow_new(i, i, "10.0.0.1", "10.0.0.2", 1, 2, 6, 0, 1, 1, 1));
+        flows_v6.push_back(flow_new(i, i, "2001:db8::1", "2001:db8::2", 1, 2, 6, 0, 1, 1, 1));
+        flows_uniq.push_back(flow_new(i, i, uniq.c_str(), "2001:db8::2", 1, 2, 6, 0, 1, 1, 1));
+    }
+
+    Block block_v4(flows_v4, 0);
+    Block block_v6(flows_v6, 0);
+    Block block_uniq(flows_uniq, 0);
+    EXPECT_LT(block_v4.memory(), block_v6.memory());
+    EXPECT_LT(block_v6.memory() + (cnt - 1) * 16U, block_uniq.memory());
+
+    std::vector<Flow> out;
+    block_uniq.decode(COLUMNS_ALL, out);
+    ASSERT_EQ(out.size(), cnt);
+    for (size_t i = 0; i < cnt; ++i) {
+        flow_check(out[i], flows_uniq[i]);
+    }
+}
+
+// Pending records become visible after the flush interval or when a block is full
+TEST(Cache, flush)
+{
+    std::unique_ptr<Config> cfg = config_new(900, 512, 3);
+    Cache cache(*cfg);
+    const Flow flow = flow_new(1000, 2000, "10.0.0.1", "10.0.0.2", 1, 2, 6, 0, 1, 100, 1);
+
+    cache.add(flow, 100);
+    cache.add(flow, 100);
+    cache.update(100);
+    EXPECT_TRUE(cache.snapshot().empty());
+    cache.update(101);
+    ASSERT_EQ(cache.snapshot().size(), 1U);
+    EXPECT_EQ(cache.snapshot()[0]->count(), 2U);
+
+    // A full block is created immediately
+    cache.add(flow, 102);
+    cache.add(flow, 102);
+    cache.add(flow, 102);
+    ASSERT_EQ(cache.snapshot().size(), 2U);
+    EXPECT_EQ(cache.snapshot()[1]->count(), 3U);
+
+    const struct Cache::stats stats = cache.stats_get();
+    EXPECT_EQ(stats.blocks, 2U);
+    EXPECT_EQ(stats.records, 5U);
+    EXPECT_EQ(stats.evicted, 0U);
+    EXPECT_EQ(stats.memory, cache.snapshot()[0]->memory() + cache.snapshot()[1]->memory());
+}
+
+// Blocks are removed from the oldest one when they are out of the time window
+TEST(Cache, evictWindow)
+{
+    std::unique_ptr<Config> cfg = config_new(10, 512, 100);
+    Cache cache(*cfg);
+
+    cache.add(flow_new(1, 1, "10.0.0.1", "10.0.0.2", 1, 2, 6, 0, 1, 100, 1), 100);
+    cache.update(101);
+    cache.add(flow_new(2, 2, "10.0.0.1", "10.0.0.2", 1, 2, 6, 0, 1, 100, 1), 105);
+    cache.add(flow_new(3, 3, "10.0.0.1", "10.0.0.2", 1, 2, 6, 0, 1, 100, 1), 105);
+    cache.update(106);
+    ASSERT_EQ(cache.snapshot().size(), 2U);
+
+    // A query still holds the snapshot, eviction must not affect it
+    const BlockList snap = cache.snapshot();
+
+    cache.expire(111);
+    EXPECT_EQ(cache.snapshot().size(), 2U);
+    cache.expire(112);
+    ASSERT_EQ(cache.snapshot().size(), 1U);
+    EXPECT_EQ(cache.snapshot()[0]->ts_min(), 2U);
+    EXPECT_EQ(cache.stats_get().evicted, 1U);
+    EXPECT_EQ(cache.stats_get().records, 2U);
+
+    cache.update(117);
+    EXPECT_TRUE(cache.snapshot().empty());
+    EXPECT_EQ(cache.stats_get().evicted, 3U);
+    EXPECT_EQ(cache.stats_get().memory, 0U);
+
+    ASSERT_EQ(snap.size(), 2U);
+    EXPECT_EQ(snap[0]->count(), 1U);
+    EXPECT_EQ(snap[1]->count(), 2U);
+}
+
+// Blocks are removed from the oldest one when the memory limit is exceeded
+TEST(Cache, evictMemory)
+{
+    const uint64_t limit = 1U << 20; // 1 MiB
+    const size_t block_size = 16384;
+    std::unique_ptr<Config> cfg = config_new(900, 1, block_size);
+    Cache cache(*cfg);
+
+    // Unique IPv6 addresses make blocks bigger than a half of the limit
+    char addr[INET6_ADDRSTRLEN];
+    for (size_t i = 0; i < 3 * block_size; ++i) {
+        snprintf(addr, sizeof(addr), "2001:db8::%zx:%zx", i >> 16, i & 0xFFFF);
+        cache.add(flow_new(i, i, addr, addr, 1, 2, 6, 0, 1, 100, 1), 100);
+    }
+
+    BlockList blocks = cache.snapshot();
+    ASSERT_EQ(blocks.size(), 1U);
+    EXPECT_GT(blocks[0]->memory(), limit / 2);
+    EXPECT_EQ(blocks[0]->ts_min(), 2 * block_size);
+
+    const struct Cache::stats stats = cache.stats_get();
+    EXPECT_LE(stats.memory, limit);
+    EXPECT_EQ(stats.blocks, 1U);
+    EXPECT_EQ(stats.records, block_size);
+    EXPECT_EQ(stats.evicted, 2 * block_size);
+}
+
+// Malformed queries are refused
+TEST(Query, parse)
+{
+    EXPECT_EQ(Query("stats").type(), Query::Type::STATS);
+    EXPECT_EQ(Query("flows").type(), Query::Type::FLOWS);
+    EXPECT_EQ(Query("FLOWS Last 60 WHERE ip=10.0.0.0/8 AND port=53 limit 5").type(),
+        Query::Type::FLOWS);
+    EXPECT_EQ(Query("aggregate dst_ip by packets").type(), Query::Type::AGGREGATE);
+    EXPECT_EQ(Query("top 10 src_port by flows last 300 where proto=6").type(),
+        Query::Type::AGGREGATE);
+    EXPECT_EQ(Query("flows where src_ip=2001:db8::/32 and odid=4294967295").type(),
+        Query::Type::FLOWS);
+
+    const char *invalid[] = {
+        "", "   ", "list", "aggregate", "aggregate bytes", "top src_ip", "top -1 src_ip",
+        "top 10", "flows limit", "flows limit x", "flows limit 4294967296", "flows last -5",
+        "flows by bytes", "aggregate proto by octets", "flows and port=53", "flows where",
+        "flows where port", "flows where port=65536", "flows where proto=256",
+        "flows where mac=1", "flows where ip=10.0.0.256", "flows where ip=10.0.0.0/33",
+        "flows where ip=2001:db8::/129", "flows where ip=10.0.0.0/", "flows where odid=1 x"
+    };
+    for (const char *str : invalid) {
+        EXPECT_THROW(Query query(str), Recent_exception) << "'" << str << "'";
+    }
+}
+
+/** Cache with known records (the current time is 1000000 seconds) */
+class QueryExec : public ::testing::Test {
+protected:
+    const time_t now = 1000000;
+    BlockList blocks;
+
+    void SetUp() override {
+        blocks.push_back(std::make_shared<const Block>(std::vector<Flow>{
+            flow_new(999900000, 999910000, "10.0.0.1", "10.0.1.1", 1000, 53, 17, 0, 1, 100, 1),
+            flow_new(999950000, 999990000, "10.0.0.2", "2001:db8::1", 2000, 443, 6, 0x12,
+                10, 5000, 1),
+            flow_new(999000000, 999500000, "2001:db8::2", "10.0.0.1", 53, 3000, 17, 0, 2, 300, 2)
+        }, now));
+        blocks.push_back(std::make_shared<const Block>(std::vector<Flow>{
+            flow_new(999960000, 999970000, "10.0.0.1", "10.0.1.2", 1001, 53, 17, 0, 3, 250, 2),
+            flow_new(999980000, 999995000, "192.168.1.1", "10.0.0.2", 5000, 80, 6, 0, 20, 20000, 1)
+        }, now));
+    }
+
+    /** Execute a query using one and multiple threads (both results must be the same) */
+    std::string execute(const std::string &str) {
+        Query query(str);
+        const std::string result = query.execute(blocks, 1, now);
+        EXPECT_EQ(query.execute(blocks, 4, now), result) << str;
+        return result;
+    }
+};
+
+static const char *FLOWS_HDR = "#ts_first\tts_last\tsrc_ip\tdst_ip\tsrc_port\tdst_port\tproto"
+    "\ttcp_flags\tpackets\tbytes\todid\n";
+
+// The most recent matching flows
+TEST_F(QueryExec, flows)
+{
+    EXPECT_EQ(execute("flows where src_ip=10.0.0.0/24 limit 2"), std::string(FLOWS_HDR)
+        + "999950000\t999990000\t10.0.0.2\t2001:db8::1\t2000\t443\t6\t18\t10\t5000\t1\n"
+        + "999960000\t999970000\t10.0.0.1\t10.0.1.2\t1001\t53\t17\t0\t3\t250\t2\n");
+    EXPECT_EQ(execute("flows where ip=2001:db8::/32"), std::string(FLOWS_HDR)
+        + "999950000\t999990000\t10.0.0.2\t2001:db8::1\t2000\t443\t6\t18\t10\t5000\t1\n"
+        + "999000000\t999500000\t2001:db8::2\t10.0.0.1\t53\t3000\t17\t0\t2\t300\t2\n");
+    EXPECT_EQ(execute("flows last 10 where odid=1"), std::string(FLOWS_HDR)
+        + "999980000\t999995000\t192.168.1.1\t10.0.0.2\t5000\t80\t6\t0\t20\t20000\t1\n"
+        + "999950000\t999990000\t10.0.0.2\t2001:db8::1\t2000\t443\t6\t18\t10\t5000\t1\n");
+    EXPECT_EQ(execute("flows where port=53 and proto=6"), FLOWS_HDR);
+}
+
+// Aggregation and top-N of matching flows
+TEST_F(QueryExec, aggregate)
+{
+    EXPECT_EQ(execute("top 2 src_ip by packets"),
+        "#src_ip\tflows\tpackets\tbytes\n"
+        "192.168.1.1\t1\t20\t20000\n"
+        "10.0.0.2\t1\t10\t5000\n");
+    EXPECT_EQ(execute("AGGREGATE proto BY flows"),
+        "#proto\tflows\tpackets\tbytes\n"
+        "17\t3\t6\t650\n"
+        "6\t2\t30\t25000\n");
+    EXPECT_EQ(execute("aggregate dst_port where port=53 and proto=17"),
+        "#dst_port\tflows\tpackets\tbytes\n"
+        "53\t2\t4\t350\n"
+        "3000\t1\t2\t300\n");
+    EXPECT_EQ(execute("aggregate odid last 60"),
+        "#odid\tflows\tpackets\tbytes\n"
+        "1\t2\t30\t25000\n"
+        "2\t1\t3\t250\n");
+    EXPECT_EQ(execute("aggregate src_ip where ip=10.0.0.1 limit 1"),
+        "#src_ip\tflows\tpackets\tbytes\n"
+        "10.0.0.1\t2\t4\t350\n");
+    EXPECT_EQ(execute("top 5 dst_ip last 1"), "#dst_ip\tflows\tpackets\tbytes\n");
+}
@@ -0,0 +1,608 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libfds.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/fpipe.h>
+    #include <core/message_terminate.h>
+    #include <core/ring.h>
+    #include <plugins/input/tcp/tls.h>
+
+    // Callbacks of the plugin (the plugin is linked into the test)
+    extern struct ipx_plugin_info ipx_plugin_info;
+    int ipx_plugin_init(ipx_ctx_t *ctx, const char *params);
+    void ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg);
+    int ipx_plugin_get(ipx_ctx_t *ctx, void *cfg);
+    void ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *session);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+using unique_ctx = std::unique_ptr<ipx_ctx_t, decltype(&ipx_ctx_destroy)>;
+using unique_key = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+using unique_cert = std::unique_ptr<X509, decltype(&X509_free)>;
+using unique_server = std::unique_ptr<tls_server_t, decltype(&tls_server_destroy)>;
+
+/** Generate a new EC key */
+static unique_key
+key_create()
+{
+    EVP_PKEY *key = nullptr;
+    EVP_PKEY_CTX *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    if (kctx != nullptr && EVP_PKEY_keygen_init(kctx) == 1
+            && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) == 1) {
+        EVP_PKEY_keygen(kctx, &key);
+    }
+
+    EVP_PKEY_CTX_free(kctx);
+    return unique_key(key, &EVP_PKEY_free);
+}
+
+/** Create a certificate signed by an issuer (or self-signed if the issuer is not defined) */
+static unique_cert
+cert_create(EVP_PKEY *key, const char *cn, X509 *issuer = nullptr, EVP_PKEY *issuer_key = nullptr)
+{
+    static long serial = 1;
+    unique_cert cert(X509_new(), &X509_free);
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), serial++);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 3600);
+    X509_set_pubkey(cert.get(), key);
+
+    X509_NAME *name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char *>(cn), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), issuer ? X509_get_subject_name(issuer) : name);
+    if (!issuer) {
+        // Self-signed certificates are used as Certificate Authorities
+        char value[] = "critical,CA:TRUE";
+        X509_EXTENSION *ext = X509V3_EXT_conf_nid(nullptr, nullptr, NID_basic_constraints, value);
+        X509_add_ext(cert.get(), ext, -1);
+        X509_EXTENSION_free(ext);
+    }
+    X509_sign(cert.get(), issuer_key ? issuer_key : key, EVP_sha256());
+    return cert;
+}
+
+/** Certificates and keys of a Certificate Authority, the collector and exporters */
+class Tls : public ::testing::Test {
+protected:
+    std::string dir;
+    unique_ctx ctx{nullptr, &ipx_ctx_destroy};
+    unique_key ca_key{nullptr, &EVP_PKEY_free};
+    unique_cert ca_cert{nullptr, &X509_free};
+    unique_key srv_key{nullptr, &EVP_PKEY_free};
+    unique_cert srv_cert{nullptr, &X509_free};
+    unique_key cli_key{nullptr, &EVP_PKEY_free};
+    unique_cert cli_cert{nullptr, &X509_free};
+    unique_cert rogue_cert{nullptr, &X509_free};
+
+    struct tcp_tls_config cfg;
+    std::string cert_file;
+    std::string key_file;
+    std::string ca_file;
+
+    void SetUp() override {
+        char tmp[] = "/tmp/ipfixcol2_tls_XXXXXX";
+        ASSERT_NE(mkdtemp(tmp), nullptr);
+        dir = tmp;
+        ctx.reset(ipx_ctx_create("tcp (TLS)", nullptr));
+        ASSERT_NE(ctx, nullptr);
+
+        ca_key = key_create();
+        srv_key = key_create();
+        cli_key = key_create();
+        ASSERT_TRUE(ca_key && srv_key && cli_key);
+        ca_cert = cert_create(ca_key.get(), "Test CA");
+        srv_cert = cert_create(srv_key.get(), "collector", ca_cert.get(), ca_key.get());
+        cli_cert = cert_create(cli_key.get(), "exporter", ca_cert.get(), ca_key.get());
+        rogue_cert = cert_create(cli_key.get(), "rogue"); // Self-signed
+
+        cert_file = dir + "/collector.crt";
+        key_file = dir + "/collector.key";
+        ca_file = dir + "/ca.crt";
+        write_pem(cert_file, srv_cert.get(), nullptr);
+        write_pem(key_file, nullptr, srv_key.get());
+        write_pem(ca_file, ca_cert.get(), nullptr);
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.enabled = true;
+        cfg.cert_file = &cert_file[0];
+        cfg.key_file = &key_file[0];
+    }
+
+    void TearDown() override {
+        for (const auto &file : {cert_file, key_file, ca_file, dir + "/other.key"}) {
+            unlink(file.c_str());
+        }
+        rmdir(dir.c_str());
+    }
+
+    static void write_pem(const std::string &path, X509 *cert, EVP_PKEY *key) {
+        FILE *file = fopen(path.c_str(), "w");
+        ASSERT_NE(file, nullptr);
+        if (cert) {
+            PEM_write_X509(file, cert);
+        }
+        if (key) {
+            PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr);
+        }
+        fclose(file);
+    }
+
+    /** Create a connected pair of TCP sockets over the loopback (collector, exporter) */
+    static void socket_pair(int &srv, int &cli) {
+        srv = cli = -1;
+        int fd_listen = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(fd_listen, -1);
+
+        struct sockaddr_in addr;
+        socklen_t addr_len = sizeof(addr);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(fd_listen, reinterpret_cast<struct sockaddr *>(&addr), addr_len), 0);
+        ASSERT_EQ(listen(fd_listen, 1), 0);
+        ASSERT_EQ(getsockname(fd_listen, reinterpret_cast<struct sockaddr *>(&addr),
+            &addr_len), 0);
+
+        cli = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(cli, -1);
+        ASSERT_EQ(connect(cli, reinterpret_cast<struct sockaddr *>(&addr), addr_len), 0);
+        srv = ::accept(fd_listen, nullptr, nullptr);
+        ASSERT_NE(srv, -1);
+        close(fd_listen);
+
+        // Never block forever
+        struct timeval tv = {5, 0};
+        setsockopt(srv, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(cli, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    /** Behaviour of an exporter */
+    struct exporter {
+        bool tls = true;            ///< Use TLS (otherwise send data in plain text)
+        X509 *cert = nullptr;       ///< Certificate of the exporter (can be NULL)
+        EVP_PKEY *key = nullptr;    ///< Private key of the exporter (can be NULL)
+        std::vector<std::string> data; ///< Messages to send (each by a separate write)
+        bool shutdown = true;       ///< Send a close notification
+    };
+
+    /** Run an exporter (in a separate thread) */
+    void exporter_run(int fd, const exporter &exp) {
+        if (!exp.tls) {
+            for (const auto &msg : exp.data) {
+                (void) !write(fd, msg.data(), msg.size());
+            }
+            shutdown(fd, SHUT_WR);
+            return;
+        }
+
+        SSL_CTX *cli_ctx = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_load_verify_locations(cli_ctx, ca_file.c_str(), nullptr);
+        SSL_CTX_set_verify(cli_ctx, SSL_VERIFY_PEER, nullptr);
+        if (exp.cert && exp.key) {
+            SSL_CTX_use_certificate(cli_ctx, exp.cert);
+            SSL_CTX_use_PrivateKey(cli_ctx, exp.key);
+        }
+
+        SSL *ssl = SSL_new(cli_ctx);
+        SSL_set_fd(ssl, fd);
+        if (SSL_connect(ssl) == 1) {
+            for (const auto &msg : exp.data) {
+                if (SSL_write(ssl, msg.data(), (int) msg.size()) <= 0) {
+                    break;
+                }
+            }
+            if (exp.shutdown) {
+                SSL_shutdown(ssl);
+            }
+        }
+
+        shutdown(fd, SHUT_WR);
+        SSL_free(ssl);
+        SSL_CTX_free(cli_ctx);
+        ERR_clear_error();
+    }
+
+    /**
+     * Accept a connection of an exporter
+     * \param[in] server Server context
+     * \param[in] exp    Behaviour of the exporter
+     * \param[in] check  Function called with the accepted connection (can be NULL)
+     * \return True if the handshake succeeded
+     */
+    template <typename Fn>
+    bool accept(tls_server_t *server, const exporter &exp, Fn check) {
+        int srv, cli;
+        socket_pair(srv, cli);
+        if (srv == -1 || cli == -1) {
+            return false;
+        }
+
+        std::thread thread([this, cli, &exp]() { exporter_run(cli, exp); });
+        // The socket is blocking, so the handshake is performed at once
+        tls_conn_t *conn = tls_conn_create(server, srv);
+        bool ok = conn && tls_conn_handshake(conn, "127.0.0.1") == TLS_HS_DONE;
+        if (ok) {
+            check(conn);
+        }
+        if (conn) {
+            tls_conn_close(conn);
+        }
+
+        close(srv);
+        thread.join();
+        close(cli);
+        return ok;
+    }
+
+    bool accept(tls_server_t *server, const exporter &exp) {
+        return accept(server, exp, [](tls_conn_t *) {});
+    }
+};
+
+// Invalid certificates and keys are refused
+TEST_F(Tls, serverInvalidFiles)
+{
+    unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+    EXPECT_NE(server, nullptr);
+
+    std::string missing = dir + "/missing.pem";
+    struct tcp_tls_config cfg_bad = cfg;
+    cfg_bad.cert_file = &missing[0];
+    EXPECT_EQ(tls_server_create(ctx.get(), &cfg_bad), nullptr);
+
+    cfg_bad = cfg;
+    cfg_bad.key_file = &missing[0];
+    EXPECT_EQ(tls_server_create(ctx.get(), &cfg_bad), nullptr);
+
+    cfg_bad = cfg;
+    cfg_bad.ca_file = &missing[0];
+    EXPECT_EQ(tls_server_create(ctx.get(), &cfg_bad), nullptr);
+
+    // The key doesn't match the certificate
+    unique_key other = key_create();
+    std::string other_file = dir + "/other.key";
+    write_pem(other_file, nullptr, other.get());
+    cfg_bad = cfg;
+    cfg_bad.key_file = &other_file[0];
+    EXPECT_EQ(tls_server_create(ctx.get(), &cfg_bad), nullptr);
+}
+
+// Application data are received in exact sizes independently of TLS records
+TEST_F(Tls, handshakeAndRecv)
+{
+    for (bool ktls : {false, true}) {
+        SCOPED_TRACE(ktls ? "kTLS enabled" : "kTLS disabled");
+        cfg.ktls = ktls;
+        unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+        ASSERT_NE(server, nullptr);
+
+        exporter exp;
+        exp.data = {"0123456789", "abcdefghijklmnopqrst", std::string(5000, 'x')};
+        bool ok = accept(server.get(), exp, [ktls](tls_conn_t *conn) {
+            if (!ktls) {
+                EXPECT_FALSE(tls_conn_ktls(conn));
+            }
+
+            char buf[5000];
+            ASSERT_EQ(tls_conn_recv(conn, buf, 15), 15);
+            EXPECT_EQ(std::string(buf, 15), "0123456789abcde");
+            ASSERT_EQ(tls_conn_recv(conn, buf, 15), 15);
+            EXPECT_EQ(std::string(buf, 15), "fghijklmnopqrst");
+            ASSERT_EQ(tls_conn_recv(conn, buf, 5000), 5000);
+            EXPECT_EQ(std::string(buf, 5000), std::string(5000, 'x'));
+
+            // Closed by the exporter
+            EXPECT_EQ(tls_conn_recv(conn, buf, 1), 0);
+        });
+        EXPECT_TRUE(ok);
+    }
+}
+
+// Handshake on a non-blocking socket is performed step by step and never waits
+TEST_F(Tls, handshakeNonBlocking)
+{
+    unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+    ASSERT_NE(server, nullptr);
+
+    int srv, cli;
+    socket_pair(srv, cli);
+    ASSERT_TRUE(srv != -1 && cli != -1);
+    ASSERT_EQ(fcntl(srv, F_SETFL, fcntl(srv, F_GETFL) | O_NONBLOCK), 0);
+    tls_conn_t *conn = tls_conn_create(server.get(), srv);
+    ASSERT_NE(conn, nullptr);
+
+    // The exporter hasn't sent anything yet
+    EXPECT_EQ(tls_conn_handshake(conn, "127.0.0.1"), TLS_HS_WANT_READ);
+
+    exporter exp;
+    exp.data = {"0123456789"};
+    std::thread thread([this, cli, &exp]() { exporter_run(cli, exp); });
+
+    enum tls_handshake ret;
+    while ((ret = tls_conn_handshake(conn, "127.0.0.1")) != TLS_HS_DONE) {
+        ASSERT_NE(ret, TLS_HS_FAILED);
+        struct pollfd pfd = {srv, (short) ((ret == TLS_HS_WANT_READ) ? POLLIN : POLLOUT), 0};
+        ASSERT_EQ(poll(&pfd, 1, 5000), 1);
+    }
+
+    ASSERT_EQ(fcntl(srv, F_SETFL, fcntl(srv, F_GETFL) & ~O_NONBLOCK), 0);
+    char buf[10];
+    ASSERT_EQ(tls_conn_recv(conn, buf, sizeof(buf)), 10);
+    EXPECT_EQ(std::string(buf, 10), "0123456789");
+
+    tls_conn_close(conn);
+    close(srv);
+    thread.join();
+    close(cli);
+}
+
+// Decrypted data buffered inside the library are signaled
+TEST_F(Tls, pending)
+{
+    unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+    ASSERT_NE(server, nullptr);
+
+    exporter exp;
+    exp.data = {std::string(100, 'a')};
+    EXPECT_TRUE(accept(server.get(), exp, [](tls_conn_t *conn) {
+        char buf[100];
+        ASSERT_EQ(tls_conn_recv(conn, buf, 10), 10);
+        EXPECT_TRUE(tls_conn_pending(conn));
+        ASSERT_EQ(tls_conn_recv(conn, buf, 90), 90);
+        EXPECT_FALSE(tls_conn_pending(conn));
+    }));
+}
+
+// Connection closed in the middle of a message or without a close notification
+TEST_F(Tls, unexpectedClose)
+{
+    unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+    ASSERT_NE(server, nullptr);
+
+    exporter exp;
+    exp.data = {"0123456789"};
+    EXPECT_TRUE(accept(server.get(), exp, [](tls_conn_t *conn) {
+        char buf[20];
+        errno = 0;
+        EXPECT_EQ(tls_conn_recv(conn, buf, sizeof(buf)), -1);
+        EXPECT_EQ(errno, ECONNRESET);
+    }));
+
+    exp.shutdown = false;
+    EXPECT_TRUE(accept(server.get(), exp, [](tls_conn_t *conn) {
+        char buf[10];
+        ASSERT_EQ(tls_conn_recv(conn, buf, sizeof(buf)), 10);
+        EXPECT_EQ(tls_conn_recv(conn, buf, sizeof(buf)), 0);
+    }));
+}
+
+// Handshake fails if the exporter doesn't speak TLS or disconnects
+TEST_F(Tls, handshakeFailure)
+{
+    unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+    ASSERT_NE(server, nullptr);
+
+    // IPFIX Message header in plain text
+    exporter plain;
+    plain.tls = false;
+    plain.data = {std::string("\x00\x0a\x00\x10\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x01",
+        16)};
+    EXPECT_FALSE(accept(server.get(), plain));
+
+    // Disconnected before the handshake
+    plain.data.clear();
+    EXPECT_FALSE(accept(server.get(), plain));
+}
+
+// Certificates of exporters are verified
+TEST_F(Tls, verifyPeer)
+{
+    cfg.ca_file = &ca_file[0];
+    cfg.verify_peer = true;
+    unique_server server(tls_server_create(ctx.get(), &cfg), &tls_server_destroy);
+    ASSERT_NE(server, nullptr);
+
+    exporter exp;
+    exp.data = {"data"};
+
+    // Without a certificate
+    EXPECT_FALSE(accept(server.get(), exp));
+
+    // Self-signed (untrusted) certificate
+    exp.cert = rogue_cert.get();
+    exp.key = cli_key.get();
+    EXPECT_FALSE(accept(server.get(), exp));
+
+    // Certificate signed by the trusted CA
+    exp.cert = cli_cert.get();
+    EXPECT_TRUE(accept(server.get(), exp, [](tls_conn_t *conn) {
+        char buf[4];
+        ASSERT_EQ(tls_conn_recv(conn, buf, sizeof(buf)), 4);
+        EXPECT_EQ(std::string(buf, 4), "data");
+    }));
+}
+
+// -------------------------------------------------------------------------------------------------
+// Plugin instance
+
+/** Instance of the plugin with TLS enabled running in its own thread */
+class TlsPlugin : public Tls {
+protected:
+    std::unique_ptr<fds_iemgr_t, decltype(&fds_iemgr_destroy)> iemgr{nullptr, &fds_iemgr_destroy};
+    std::unique_ptr<ipx_ring_t, decltype(&ipx_ring_destroy)> ring{nullptr, &ipx_ring_destroy};
+    std::unique_ptr<ipx_fpipe_t, decltype(&ipx_fpipe_destroy)> fpipe{nullptr, &ipx_fpipe_destroy};
+    struct ipx_ctx_callbacks cbs;
+    unique_ctx plugin{nullptr, &ipx_ctx_destroy};
+    uint16_t port = 0;
+    bool running = false;
+
+    void SetUp() override {
+        Tls::SetUp();
+        ASSERT_FALSE(HasFatalFailure());
+
+        iemgr.reset(fds_iemgr_create());
+        ring.reset(ipx_ring_init(64, false));
+        fpipe.reset(ipx_fpipe_create());
+        ASSERT_TRUE(iemgr && ring && fpipe);
+
+        memset(&cbs, 0, sizeof(cbs));
+        cbs.info = &ipx_plugin_info;
+        cbs.init = &ipx_plugin_init;
+        cbs.destroy = &ipx_plugin_destroy;
+        cbs.get = &ipx_plugin_get;
+        cbs.ts_close = &ipx_plugin_session_close;
+        plugin.reset(ipx_ctx_create("tcp", &cbs));
+        ASSERT_NE(plugin, nullptr);
+        ipx_ctx_iemgr_set(plugin.get(), iemgr.get());
+        ipx_ctx_fpipe_set(plugin.get(), fpipe.get());
+        ipx_ctx_ring_dst_set(plugin.get(), ring.get());
+
+        port = free_port();
+        ASSERT_NE(port, 0);
+        std::string params = "<params><localPort>" + std::to_string(port) + "</localPort>"
+            "<localIPAddress>127.0.0.1</localIPAddress><tls>"
+            "<certificateFile>" + cert_file + "</certificateFile>"
+            "<privateKeyFile>" + key_file + "</privateKeyFile>"
+            "</tls></params>";
+        ASSERT_EQ(ipx_ctx_init(plugin.get(), params.c_str()), IPX_OK);
+        ASSERT_EQ(ipx_ctx_run(plugin.get()), IPX_OK);
+        running = true;
+    }
+
+    void TearDown() override {
+        if (running) {
+            // Stop the thread and drop all messages until the termination message
+            ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+            ipx_fpipe_write(fpipe.get(), ipx_msg_terminate2base(msg));
+            ipx_msg_t *out;
+            while (ipx_msg_get_type(out = ipx_ring_pop(ring.get())) != IPX_MSG_TERMINATE) {
+                ipx_msg_destroy(out);
+            }
+            ipx_msg_destroy(out);
+        }
+
+        plugin.reset();
+        Tls::TearDown();
+    }
+
+    /** Find an unused local TCP port */
+    static uint16_t free_port() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        socklen_t addr_len = sizeof(addr);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        uint16_t port = 0;
+        if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), addr_len) == 0
+                && getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &addr_len) == 0) {
+            port = ntohs(addr.sin_port);
+        }
+        close(fd);
+        return port;
+    }
+
+    /** Connect to the plugin (the exporter gives up after 1 second of silence) */
+    int connect_plugin() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+
+        struct timeval tv = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        return fd;
+    }
+
+    /** Wait for the next message of the plugin (or NULL if nothing arrives within a second) */
+    ipx_msg_t *msg_wait() {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += 1;
+        return ipx_ring_pop_timed(ring.get(), &deadline);
+    }
+};
+
+// An exporter that stalls in the middle of the handshake doesn't block other exporters
+TEST_F(TlsPlugin, stalledHandshake)
+{
+    // The stalled exporter is accepted first
+    int stalled = connect_plugin();
+    ASSERT_NE(stalled, -1);
+    int fd = connect_plugin();
+    ASSERT_NE(fd, -1);
+
+    // Beginning of a ClientHello record, one byte at a time (never completed)
+    std::thread staller([stalled]() {
+        const char hello[] = "\x16\x03\x01\x02\x00\x01\x00\x01\xfc\x03\x03";
+        for (size_t i = 0; i < sizeof(hello) - 1; ++i) {
+            if (send(stalled, &hello[i], 1, MSG_NOSIGNAL) != 1) {
+                break;
+            }
+            usleep(200000);
+        }
+    });
+
+    // The other exporter performs the handshake meanwhile and sends an IPFIX Message header
+    usleep(100000);
+    exporter exp;
+    exp.data = {std::string("\x00\x0a\x00\x10\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+        "\x00\x01", 16)};
+    exporter_run(fd, exp);
+
+    ipx_msg_t *msg_open = msg_wait();
+    ipx_msg_t *msg_data = msg_wait();
+    staller.join();
+
+    ASSERT_NE(msg_open, nullptr);
+    ASSERT_EQ(ipx_msg_get_type(msg_open), IPX_MSG_SESSION);
+    EXPECT_EQ(ipx_msg_session_get_event(ipx_msg_base2session(msg_open)), IPX_MSG_SESSION_OPEN);
+    ipx_msg_destroy(msg_open);
+
+    ASSERT_NE(msg_data, nullptr);
+    ASSERT_EQ(ipx_msg_get_type(msg_data), IPX_MSG_IPFIX);
+    EXPECT_EQ(ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg_data))->odid, 1U);
+    ipx_msg_destroy(msg_data);
+
+    close(stalled);
+    close(fd);
+}
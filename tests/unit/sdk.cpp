@@ -0,0 +1,129 @@
+//
+// Created by agent on 18/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <ipfixcol2/sdk.hpp>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Data Record with its template (fixed-length fields, a variable-length field and a field with
+// unknown offset)
+class Sdk : public ::testing::Test {
+protected:
+    using tmplt_uniq = std::unique_ptr<fds_template, decltype(&fds_template_destroy)>;
+
+    tmplt_uniq tmplt {nullptr, &fds_template_destroy};
+    ipfix_drec drec;
+    struct ipx_ipfix_record rec;
+
+    const uint64_t bytes = 123456789;
+    const uint64_t pkts = 42;
+    const uint64_t ts = 1571300000123ULL;
+    const std::string app = "example";
+
+    void SetUp() override {
+        ipfix_trec trec(256);
+        trec.add_field(1, 8);                    // octetDeltaCount
+        trec.add_field(8, 4);                    // sourceIPv4Address
+        trec.add_field(7, 2);                    // sourceTransportPort
+        trec.add_field(152, 8);                  // flowStartMilliseconds
+        trec.add_field(95, ipfix_trec::SIZE_VAR); // applicationId
+        trec.add_field(2, 4);                    // packetDeltaCount (reduced-size)
+
+        fds_template *ptr;
+        const ipfix_trec &trec_ref = trec;
+        uint16_t len = trec_ref.size();
+        ASSERT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, trec_ref.front(), &len, &ptr), FDS_OK);
+        tmplt.reset(ptr);
+
+        drec.append_uint(bytes, 8);
+        drec.append_ip("10.0.0.1");
+        drec.append_uint(80, 2);
+        drec.append_datetime(ts, FDS_ET_DATE_TIME_MILLISECONDS);
+        drec.append_string(app, ipfix_drec::SIZE_VAR);
+        drec.append_uint(pkts, 4);
+
+        memset(&rec, 0, sizeof(rec));
+        const ipfix_drec &drec_ref = drec;
+        rec.rec.data = const_cast<uint8_t *>(drec_ref.front());
+        rec.rec.size = drec_ref.size();
+        rec.rec.tmplt = tmplt.get();
+        rec.rec.snap = nullptr;
+    }
+};
+
+// Lookup of fields without cache
+TEST_F(Sdk, recordGet)
+{
+    ipx::Record view(&rec);
+    EXPECT_FALSE(view.is_options());
+    EXPECT_EQ(view.get(ipx::ie::iana::octetDeltaCount), bytes);
+    EXPECT_EQ(view.get(ipx::ie::iana::packetDeltaCount), pkts);
+    EXPECT_EQ(view.get(ipx::ie::iana::applicationId), app);
+    EXPECT_FALSE(view.get(ipx::ie::iana::destinationIPv4Address).has_value());
+    EXPECT_FALSE(view.get(ipx::reverse(ipx::ie::iana::octetDeltaCount)).has_value());
+
+    const ipx::ip4_t exp_addr = {10, 0, 0, 1};
+    EXPECT_EQ(view.get(ipx::ie::iana::sourceIPv4Address), exp_addr);
+
+    // The value doesn't fit into the type
+    const ipx::Field<uint8_t> narrow {0, 1, FDS_ET_UNSIGNED_64};
+    EXPECT_FALSE(view.get(narrow).has_value());
+}
+
+// Lookup of fields with cached positions
+TEST_F(Sdk, accessor)
+{
+    ipx::Accessor<4, 2> acc;
+    const auto h_bytes = acc.add(ipx::ie::iana::octetDeltaCount);
+    const auto h_ts = acc.add(ipx::ie::iana::flowStartMilliseconds);
+    const auto h_pkts = acc.add(ipx::ie::iana::packetDeltaCount);
+    const auto h_dst = acc.add(ipx::ie::iana::destinationIPv4Address);
+    EXPECT_THROW(acc.add(ipx::ie::iana::sourceTransportPort), std::length_error);
+
+    ipx::Record view(&rec);
+    for (int i = 0; i < 2; ++i) {
+        // The first iteration fills the cache, the second one uses it
+        uint64_t value;
+        ASSERT_TRUE(acc.get(view, h_bytes, value));
+        EXPECT_EQ(value, bytes);
+        EXPECT_EQ(acc.get(view, h_pkts), pkts);
+        EXPECT_TRUE(acc.has(view, h_pkts));
+
+        auto time = acc.get(view, h_ts);
+        ASSERT_TRUE(time.has_value());
+        EXPECT_EQ(time->tv_sec, static_cast<time_t>(ts / 1000));
+        EXPECT_EQ(time->tv_nsec, static_cast<long>((ts % 1000) * 1000000));
+
+        EXPECT_FALSE(acc.has(view, h_dst));
+        EXPECT_FALSE(acc.get(view, h_dst).has_value());
+    }
+
+    acc.reset();
+    EXPECT_EQ(acc.get(view, h_bytes), bytes);
+}
+
+// Conversion of values with reduced-size encoding
+TEST(SdkValue, reducedSize)
+{
+    const uint8_t data[] = {0xFF, 0xFE};
+    uint32_t u32;
+    ASSERT_TRUE(ipx::detail::value_get(data, sizeof(data), FDS_ET_UNSIGNED_32, u32));
+    EXPECT_EQ(u32, 0xFFFEU);
+
+    int32_t i32;
+    ASSERT_TRUE(ipx::detail::value_get(data, sizeof(data), FDS_ET_SIGNED_32, i32));
+    EXPECT_EQ(i32, -2);
+
+    int8_t i8;
+    EXPECT_FALSE(ipx::detail::value_get(data, sizeof(data), FDS_ET_SIGNED_8, i8));
+
+    ipx::mac_t mac;
+    EXPECT_FALSE(ipx::detail::value_get(data, sizeof(data), FDS_ET_MAC_ADDRESS, mac));
+}
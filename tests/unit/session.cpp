@@ -136,6 +136,31 @@ TEST(udp, invalid)
     ASSERT_EQ(ipx_session_new_udp(&net6_family, 60, 60), nullptr);
 }
 
+TEST(udp, named)
+{
+    struct ipx_session_net net4;
+    net4.l3_proto = AF_INET;
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &net4.addr_src), 1);
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &net4.addr_dst), 1);
+    net4.port_src = 1234;
+    net4.port_dst = 0;
+
+    struct ipx_session *session = ipx_session_new_udp_named(&net4, "exporter (pid 1234)", 60, 30);
+    ASSERT_NE(session, nullptr);
+    EXPECT_EQ(session->type, FDS_SESSION_UDP);
+    EXPECT_STREQ(session->ident, "exporter (pid 1234)");
+    EXPECT_EQ(session->udp.net.port_src, 1234);
+    EXPECT_EQ(session->udp.lifetime.tmplts, 60);
+    EXPECT_EQ(session->udp.lifetime.opts_tmplts, 30);
+    ipx_session_destroy(session);
+
+    // Empty identification and invalid AF family
+    EXPECT_EQ(ipx_session_new_udp_named(&net4, "", 60, 60), nullptr);
+    struct ipx_session_net net4_family = net4;
+    net4_family.l3_proto = 0;
+    EXPECT_EQ(ipx_session_new_udp_named(&net4_family, "exporter", 60, 60), nullptr);
+}
+
 TEST(sctp, valid)
 {
     // IPv4
@@ -0,0 +1,667 @@
+//
+// Created by agent on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+extern "C" {
+    #include <tools/ipfixgen/dist.h>
+    #include <tools/ipfixgen/encoder.h>
+    #include <tools/ipfixgen/profile.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Current time used by tests of the encoder (ms) */
+static const uint64_t NOW_MS = 1500000000500ULL;
+
+/** Read an unsigned integer in network byte order */
+static uint64_t
+get(const uint8_t *ptr, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value = (value << 8) | ptr[i];
+    }
+    return value;
+}
+
+/** Distribution that is automatically cleared */
+class Dist {
+public:
+    struct dist dist;
+    int rc;
+
+    Dist(enum dist_type type, const std::vector<struct dist_item> &items, double exp = 1.0) {
+        rc = dist_init(&dist, type, items.data(), items.size(), exp);
+    }
+    ~Dist() {
+        if (rc == 0) {
+            dist_clear(&dist);
+        }
+    }
+
+    /** Get number of occurrences of sampled values */
+    std::map<uint64_t, size_t> hist(size_t cnt, uint64_t seed = 1) {
+        struct rng rng;
+        rng_init(&rng, seed);
+
+        std::map<uint64_t, size_t> ret;
+        for (size_t i = 0; i < cnt; ++i) {
+            ret[dist_sample(&dist, &rng)]++;
+        }
+        return ret;
+    }
+};
+
+// The same seed produces the same sequence, different seeds produce different sequences
+TEST(Rng, seed)
+{
+    struct rng a, b, c;
+    rng_init(&a, 42);
+    rng_init(&b, 42);
+    rng_init(&c, 43);
+
+    size_t same = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const uint64_t value = rng_next(&a);
+        EXPECT_EQ(value, rng_next(&b));
+        same += (value == rng_next(&c)) ? 1 : 0;
+    }
+    EXPECT_EQ(same, 0U);
+}
+
+// Bounded numbers are always in range
+TEST(Rng, bounds)
+{
+    struct rng rng;
+    rng_init(&rng, 1);
+
+    std::set<uint64_t> seen;
+    for (int i = 0; i < 10000; ++i) {
+        const uint64_t value = rng_below(&rng, 10);
+        ASSERT_LT(value, 10U);
+        seen.insert(value);
+
+        const double unit = rng_unit(&rng);
+        ASSERT_GE(unit, 0.0);
+        ASSERT_LT(unit, 1.0);
+    }
+    EXPECT_EQ(seen.size(), 10U);
+}
+
+// Constant and uniform distributions
+TEST(Dist, constAndUniform)
+{
+    Dist dconst(DIST_CONST, {{7, 7, 1.0}});
+    ASSERT_EQ(dconst.rc, 0);
+    auto hist_const = dconst.hist(1000);
+    ASSERT_EQ(hist_const.size(), 1U);
+    EXPECT_EQ(hist_const.begin()->first, 7U);
+
+    Dist duni(DIST_UNIFORM, {{100, 109, 1.0}});
+    ASSERT_EQ(duni.rc, 0);
+    auto hist_uni = duni.hist(100000);
+    ASSERT_EQ(hist_uni.size(), 10U);
+    EXPECT_EQ(hist_uni.begin()->first, 100U);
+    EXPECT_EQ(hist_uni.rbegin()->first, 109U);
+    for (const auto &pair : hist_uni) {
+        EXPECT_NEAR(pair.second / 100000.0, 0.1, 0.01);
+    }
+
+    // The whole 64-bit range
+    Dist dfull(DIST_UNIFORM, {{0, UINT64_MAX, 1.0}});
+    ASSERT_EQ(dfull.rc, 0);
+    EXPECT_GT(dfull.hist(100).size(), 90U);
+}
+
+// Lower values of a Zipf distribution are more popular
+TEST(Dist, zipf)
+{
+    Dist dist(DIST_ZIPF, {{1000, 1009, 1.0}}, 1.0);
+    ASSERT_EQ(dist.rc, 0);
+
+    const size_t cnt = 200000;
+    auto hist = dist.hist(cnt);
+    ASSERT_EQ(hist.size(), 10U);
+    EXPECT_EQ(hist.begin()->first, 1000U);
+    EXPECT_EQ(hist.rbegin()->first, 1009U);
+
+    // P(rank k) = (1 / k) / H(10)
+    double harmonic = 0.0;
+    for (int k = 1; k <= 10; ++k) {
+        harmonic += 1.0 / k;
+    }
+    for (int k = 1; k <= 10; ++k) {
+        EXPECT_NEAR(hist[1000 + k - 1] / double(cnt), (1.0 / k) / harmonic, 0.01);
+    }
+}
+
+// Weighted mix of values and intervals
+TEST(Dist, mix)
+{
+    Dist dist(DIST_MIX, {{443, 443, 50.0}, {80, 80, 25.0}, {1024, 1033, 25.0}});
+    ASSERT_EQ(dist.rc, 0);
+
+    const size_t cnt = 100000;
+    auto hist = dist.hist(cnt);
+    EXPECT_NEAR(hist[443] / double(cnt), 0.5, 0.01);
+    EXPECT_NEAR(hist[80] / double(cnt), 0.25, 0.01);
+
+    size_t interval = 0;
+    for (const auto &pair : hist) {
+        if (pair.first == 443 || pair.first == 80) {
+            continue;
+        }
+        ASSERT_GE(pair.first, 1024U);
+        ASSERT_LE(pair.first, 1033U);
+        interval += pair.second;
+    }
+    EXPECT_NEAR(interval / double(cnt), 0.25, 0.01);
+}
+
+// Invalid distributions are refused
+TEST(Dist, invalid)
+{
+    EXPECT_NE(Dist(DIST_CONST, {}).rc, 0);
+    EXPECT_NE(Dist(DIST_UNIFORM, {{1, 2, 1.0}, {3, 4, 1.0}}).rc, 0);
+    EXPECT_NE(Dist(DIST_UNIFORM, {{10, 9, 1.0}}).rc, 0);
+    EXPECT_NE(Dist(DIST_ZIPF, {{0, DIST_ZIPF_MAX, 1.0}}).rc, 0);
+    EXPECT_EQ(Dist(DIST_ZIPF, {{0, DIST_ZIPF_MAX - 1, 1.0}}).rc, 0);
+    EXPECT_NE(Dist(DIST_ZIPF, {{0, 10, 1.0}}, 0.0).rc, 0);
+    EXPECT_NE(Dist(DIST_MIX, {{1, 1, 0.0}, {2, 2, 0.0}}).rc, 0);
+}
+
+/** Temporary profile file */
+class ProfileFile {
+public:
+    std::string path;
+
+    explicit ProfileFile(const std::string &content) {
+        char tmp[] = "/tmp/ipfixcol2_ipfixgen_XXXXXX";
+        int fd = mkstemp(tmp);
+        EXPECT_GE(fd, 0);
+        path = tmp;
+        EXPECT_EQ(write(fd, content.data(), content.size()), ssize_t(content.size()));
+        close(fd);
+    }
+    ~ProfileFile() {
+        unlink(path.c_str());
+    }
+};
+
+/** Profile that is automatically destroyed */
+using profile_ptr = std::unique_ptr<struct profile, decltype(&profile_destroy)>;
+
+/** Load a profile with the given content */
+static profile_ptr
+profile_str(const std::string &content)
+{
+    ProfileFile file(content);
+    return profile_ptr(profile_load(file.path.c_str()), &profile_destroy);
+}
+
+/** Create a definition of a field */
+static std::string
+field(const std::string &name, const std::string &dist, const std::string &value)
+{
+    return "<field><name>" + name + "</name><distribution>" + dist + "</distribution>"
+        "<value>" + value + "</value></field>";
+}
+
+/** Create a profile with the given parameters and fields */
+static std::string
+profile_xml(const std::string &params, const std::string &fields)
+{
+    return "<profile>" + params + "<fields>" + fields + "</fields></profile>";
+}
+
+// Parameters and fields of a profile
+TEST(Profile, load)
+{
+    const std::string xml = profile_xml(
+        "<format>netflow9</format><exporters>3</exporters><odidBase>10</odidBase>"
+        "<mtu>1000</mtu><templateRefresh>5</templateRefresh><flowAge>2000</flowAge>",
+        field("dstAddr6", "uniform", "2001:db8::1-2001:db8::ff")
+        + field("srcPort", "const", "80")
+        + field("protocol", "mix", "6@80, 17@20")
+        + "<field><name>packets</name><distribution>zipf</distribution>"
+          "<value>1-100</value><exponent>1.5</exponent></field>");
+
+    profile_ptr profile = profile_str(xml);
+    ASSERT_NE(profile, nullptr);
+    EXPECT_EQ(profile->format, PROFILE_FMT_NF9);
+    EXPECT_EQ(profile->exporters, 3U);
+    EXPECT_EQ(profile->odid_base, 10U);
+    EXPECT_EQ(profile->mtu, 1000U);
+    EXPECT_EQ(profile->tmplt_refresh, 5U);
+    EXPECT_EQ(profile->flow_age, 2000U);
+    EXPECT_DOUBLE_EQ(profile->biflow_share, 0.0);
+
+    ASSERT_EQ(profile->fields_cnt, 4U);
+    const struct profile_field *fields = profile->fields;
+    EXPECT_EQ(fields[0].id, FIELD_DST_ADDR6);
+    EXPECT_EQ(fields[0].dist.type, DIST_UNIFORM);
+    EXPECT_EQ(fields[0].dist.items[0].min, 1U);
+    EXPECT_EQ(fields[0].dist.items[0].max, 0xFFU);
+    const uint8_t prefix[8] = {0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0};
+    EXPECT_EQ(memcmp(fields[0].ip6_prefix, prefix, sizeof(prefix)), 0);
+
+    EXPECT_EQ(fields[1].id, FIELD_SRC_PORT);
+    EXPECT_EQ(fields[1].dist.type, DIST_CONST);
+    EXPECT_EQ(fields[1].dist.items[0].min, 80U);
+
+    EXPECT_EQ(fields[2].id, FIELD_PROTOCOL);
+    EXPECT_EQ(fields[2].dist.type, DIST_MIX);
+    ASSERT_EQ(fields[2].dist.items_cnt, 2U);
+    EXPECT_EQ(fields[2].dist.items[0].min, 6U);
+    EXPECT_DOUBLE_EQ(fields[2].dist.items[0].weight, 80.0);
+    EXPECT_EQ(fields[2].dist.items[1].min, 17U);
+    EXPECT_DOUBLE_EQ(fields[2].dist.items[1].weight, 20.0);
+
+    EXPECT_EQ(fields[3].id, FIELD_PACKETS);
+    EXPECT_EQ(fields[3].dist.type, DIST_ZIPF);
+    EXPECT_EQ(fields[3].dist.alias.cnt, 100U);
+}
+
+// Optional parameters are replaced with default values
+TEST(Profile, defaults)
+{
+    profile_ptr profile = profile_str(profile_xml("<format>ipfix</format>",
+        field("srcAddr4", "const", "10.0.0.1")));
+    ASSERT_NE(profile, nullptr);
+    EXPECT_EQ(profile->format, PROFILE_FMT_IPFIX);
+    EXPECT_EQ(profile->exporters, 1U);
+    EXPECT_EQ(profile->odid_base, 1U);
+    EXPECT_EQ(profile->mtu, 1400U);
+    EXPECT_EQ(profile->tmplt_refresh, 4096U);
+    EXPECT_EQ(profile->flow_age, 30000U);
+    ASSERT_EQ(profile->fields_cnt, 1U);
+    EXPECT_EQ(profile->fields[0].dist.items[0].min, 0x0A000001U);
+}
+
+// Invalid profiles are refused
+TEST(Profile, invalid)
+{
+    const std::string ipfix = "<format>ipfix</format>";
+    const std::string bytes = field("bytes", "uniform", "1-100");
+    const std::vector<std::string> invalid = {
+        profile_xml("<format>netflow8</format>", bytes),
+        profile_xml(ipfix + "<mtu>511</mtu>", bytes),
+        profile_xml(ipfix + "<exporters>0</exporters>", bytes),
+        profile_xml(ipfix + "<biflowShare>1.5</biflowShare>", bytes),
+        profile_xml(ipfix + "<flowAge>0</flowAge>", bytes),
+        profile_xml(ipfix, ""),
+        // Invalid fields
+        profile_xml(ipfix, field("unknown", "const", "1")),
+        profile_xml(ipfix, bytes + bytes),
+        profile_xml(ipfix, field("protocol", "const", "256")),
+        profile_xml(ipfix, field("protocol", "const", "1-2")),
+        profile_xml(ipfix, field("protocol", "uniform", "1, 2")),
+        profile_xml(ipfix, field("protocol", "gauss", "1")),
+        profile_xml(ipfix, field("srcPort", "uniform", "100-10")),
+        profile_xml(ipfix, field("srcPort", "mix", "80@0")),
+        profile_xml(ipfix, field("srcAddr4", "const", "10.0.0.256")),
+        profile_xml(ipfix, field("srcAddr6", "uniform", "2001:db8::1-2001:db9::1")),
+        profile_xml(ipfix, field("srcPort", "zipf", "0-65535") + "<field><name>dstPort</name>"
+            "<distribution>zipf</distribution><value>1-10</value><exponent>0</exponent></field>"),
+        // Unsupported by the export protocol
+        profile_xml("<format>netflow5</format>", field("srcAddr6", "const", "::1")),
+        profile_xml("<format>netflow9</format><biflowShare>0.5</biflowShare>", bytes),
+        profile_xml(ipfix + "<biflowShare>0.5</biflowShare>", field("srcPort", "const", "1"))
+    };
+
+    for (const auto &xml : invalid) {
+        SCOPED_TRACE("profile: " + xml);
+        EXPECT_EQ(profile_str(xml), nullptr);
+    }
+
+    EXPECT_EQ(profile_load("/tmp/ipfixcol2_ipfixgen_nonexistent"), nullptr);
+}
+
+/** Encoder of a profile (both are automatically destroyed) */
+class Encoder : public ::testing::Test {
+protected:
+    profile_ptr profile {nullptr, &profile_destroy};
+    struct encoder enc;
+    struct exporter exp;
+    struct rng rng;
+    bool enc_ready = false;
+    std::vector<uint8_t> buffer;
+
+    void TearDown() override {
+        if (enc_ready) {
+            encoder_clear(&enc);
+        }
+    }
+
+    /** Load a profile and initialize the encoder */
+    void init(const std::string &params, const std::string &fields) {
+        profile = profile_str(profile_xml(params, fields));
+        ASSERT_NE(profile, nullptr);
+        ASSERT_EQ(encoder_init(&enc, profile.get()), 0);
+        enc_ready = true;
+
+        memset(&exp, 0, sizeof(exp));
+        exp.fd = -1;
+        exp.odid = 5;
+        exp.boot_ms = NOW_MS - 60000;
+        rng_init(&rng, 1);
+        buffer.assign(profile->mtu, 0);
+    }
+
+    /** Generate a packet */
+    uint16_t packet(uint32_t max_recs, uint32_t *recs) {
+        return encoder_packet(&enc, &exp, &rng, NOW_MS, max_recs, buffer.data(), recs);
+    }
+};
+
+/** Parsed (Flow)Set */
+struct set_info {
+    uint16_t id;
+    const uint8_t *data;   ///< Content after the header
+    uint16_t size;         ///< Size of the content
+};
+
+/** Split a packet into (Flow)Sets */
+static std::vector<struct set_info>
+sets_get(const uint8_t *ptr, size_t size)
+{
+    std::vector<struct set_info> ret;
+    while (size > 0) {
+        EXPECT_GE(size, 4U);
+        const uint16_t len = static_cast<uint16_t>(get(ptr + 2, 2));
+        EXPECT_GE(len, 4U);
+        EXPECT_LE(len, size);
+        if (len < 4 || len > size) {
+            break;
+        }
+        ret.push_back({static_cast<uint16_t>(get(ptr, 2)), ptr + 4, uint16_t(len - 4)});
+        ptr += len;
+        size -= len;
+    }
+    return ret;
+}
+
+/** Template field: {IE ID, length, PEN} */
+using tfield = std::vector<uint64_t>;
+
+/** Parse a Template Record */
+static std::vector<tfield>
+tmplt_get(const uint8_t *&ptr, uint16_t id)
+{
+    EXPECT_EQ(get(ptr, 2), id);
+    const uint64_t cnt = get(ptr + 2, 2);
+    ptr += 4;
+
+    std::vector<tfield> ret;
+    for (uint64_t i = 0; i < cnt; ++i) {
+        const uint64_t ie = get(ptr, 2);
+        const uint64_t len = get(ptr + 2, 2);
+        ptr += 4;
+        if (ie & 0x8000) {
+            ret.push_back({ie & 0x7FFF, len, get(ptr, 4)});
+            ptr += 4;
+        } else {
+            ret.push_back({ie, len, 0});
+        }
+    }
+    return ret;
+}
+
+/** Fields used by tests of the IPFIX and NetFlow v9 encoder */
+static const std::string FIELDS =
+    field("srcAddr4", "const", "10.0.0.1")
+    + field("dstPort", "uniform", "1-100")
+    + field("protocol", "const", "17")
+    + field("bytes", "uniform", "1000-1999");
+
+// IPFIX Messages with templates (including the refresh) and uniflow records
+TEST_F(Encoder, ipfix)
+{
+    init("<format>ipfix</format><mtu>512</mtu><templateRefresh>3</templateRefresh>"
+        "<flowAge>1000</flowAge>", FIELDS);
+    const size_t rec_size = 4 + 2 + 1 + 8 + 16;
+    EXPECT_EQ(enc.rec_size[0], rec_size);
+
+    uint32_t seq = 0;
+    for (int pkt = 0; pkt < 4; ++pkt) {
+        SCOPED_TRACE("packet: " + std::to_string(pkt));
+        uint32_t recs;
+        const uint16_t size = packet(UINT32_MAX, &recs);
+        ASSERT_LE(size, 512U);
+        ASSERT_GT(recs, 0U);
+
+        const uint8_t *hdr = buffer.data();
+        EXPECT_EQ(get(hdr, 2), 10U);
+        EXPECT_EQ(get(hdr + 2, 2), size);
+        EXPECT_EQ(get(hdr + 4, 4), NOW_MS / 1000);
+        EXPECT_EQ(get(hdr + 8, 4), seq);
+        EXPECT_EQ(get(hdr + 12, 4), 5U);
+        seq += recs;
+
+        auto sets = sets_get(hdr + 16, size - 16U);
+        const bool tmplt = (pkt == 0 || pkt == 3);
+        ASSERT_EQ(sets.size(), tmplt ? 2U : 1U);
+
+        if (tmplt) {
+            ASSERT_EQ(sets[0].id, 2U);
+            const uint8_t *ptr = sets[0].data;
+            auto fields = tmplt_get(ptr, 256);
+            const std::vector<tfield> expected = {
+                {8, 4, 0}, {11, 2, 0}, {4, 1, 0}, {1, 8, 0}, {152, 8, 0}, {153, 8, 0}
+            };
+            EXPECT_EQ(fields, expected);
+            EXPECT_EQ(ptr, sets[0].data + sets[0].size);
+        }
+
+        // All records fit into the MTU and no other record would fit
+        const struct set_info &data = sets.back();
+        ASSERT_EQ(data.id, 256U);
+        ASSERT_EQ(data.size % rec_size, 0U);
+        EXPECT_EQ(data.size / rec_size, recs);
+        EXPECT_GT(size + rec_size, 512U);
+
+        for (uint32_t i = 0; i < recs; ++i) {
+            const uint8_t *rec = data.data + i * rec_size;
+            EXPECT_EQ(get(rec, 4), 0x0A000001U);
+            EXPECT_GE(get(rec + 4, 2), 1U);
+            EXPECT_LE(get(rec + 4, 2), 100U);
+            EXPECT_EQ(get(rec + 6, 1), 17U);
+            EXPECT_GE(get(rec + 7, 8), 1000U);
+            EXPECT_LE(get(rec + 7, 8), 1999U);
+
+            const uint64_t start = get(rec + 15, 8);
+            const uint64_t end = get(rec + 23, 8);
+            EXPECT_GT(start, NOW_MS - 1000);
+            EXPECT_LE(start, end);
+            EXPECT_LE(end, NOW_MS);
+        }
+    }
+
+    EXPECT_EQ(exp.pkts, 4U);
+    EXPECT_EQ(exp.seq, seq);
+}
+
+// The number of records is limited by the caller
+TEST_F(Encoder, maxRecords)
+{
+    init("<format>ipfix</format>", FIELDS);
+
+    uint32_t recs;
+    packet(1, &recs);
+    EXPECT_EQ(recs, 1U);
+    const uint16_t size = packet(3, &recs);
+    EXPECT_EQ(recs, 3U);
+    EXPECT_EQ(size, 16U + 4U + 3U * enc.rec_size[0]);
+    EXPECT_EQ(exp.seq, 4U);
+}
+
+// Biflow records have their own template with reverse counters
+TEST_F(Encoder, biflow)
+{
+    init("<format>ipfix</format><biflowShare>0.5</biflowShare>",
+        FIELDS + field("packets", "const", "3"));
+    ASSERT_EQ(enc.tset_recs, 2U);
+    const size_t uni_size = 4 + 2 + 1 + 8 + 8 + 16;
+    const size_t bi_size = uni_size + 8 + 8;
+    EXPECT_EQ(enc.rec_size[0], uni_size);
+    EXPECT_EQ(enc.rec_size[1], bi_size);
+
+    uint32_t recs;
+    const uint16_t size = packet(UINT32_MAX, &recs);
+    auto sets = sets_get(buffer.data() + 16, size - 16U);
+    ASSERT_EQ(sets.size(), 3U);
+
+    ASSERT_EQ(sets[0].id, 2U);
+    const uint8_t *ptr = sets[0].data;
+    auto uni = tmplt_get(ptr, 256);
+    auto bi = tmplt_get(ptr, 257);
+    EXPECT_EQ(ptr, sets[0].data + sets[0].size);
+    EXPECT_EQ(uni.size(), 7U);
+    ASSERT_EQ(bi.size(), 9U);
+    EXPECT_EQ(std::vector<tfield>(bi.begin(), bi.begin() + 7), uni);
+    EXPECT_EQ(bi[7], (tfield{1, 8, 29305}));
+    EXPECT_EQ(bi[8], (tfield{2, 8, 29305}));
+
+    ASSERT_EQ(sets[1].id, 256U);
+    ASSERT_EQ(sets[2].id, 257U);
+    ASSERT_EQ(sets[1].size % uni_size, 0U);
+    ASSERT_EQ(sets[2].size % bi_size, 0U);
+    EXPECT_EQ(sets[1].size / uni_size + sets[2].size / bi_size, recs);
+
+    // Reverse counters follow the timestamps
+    for (size_t i = 0; i < sets[2].size / bi_size; ++i) {
+        const uint8_t *rec = sets[2].data + i * bi_size;
+        EXPECT_EQ(get(rec + 15, 8), 3U);
+        EXPECT_GE(get(rec + uni_size, 8), 1000U);
+        EXPECT_LE(get(rec + uni_size, 8), 1999U);
+        EXPECT_EQ(get(rec + uni_size + 8, 8), 3U);
+    }
+}
+
+// NetFlow v9 packets count template records and use relative timestamps
+TEST_F(Encoder, netflow9)
+{
+    init("<format>netflow9</format><mtu>600</mtu><templateRefresh>0</templateRefresh>"
+        "<flowAge>1000</flowAge>", FIELDS);
+    const size_t rec_size = 4 + 2 + 1 + 8 + 8;
+
+    for (uint32_t pkt = 0; pkt < 3; ++pkt) {
+        SCOPED_TRACE("packet: " + std::to_string(pkt));
+        uint32_t recs;
+        const uint16_t size = packet(UINT32_MAX, &recs);
+        ASSERT_LE(size, 600U);
+
+        const uint8_t *hdr = buffer.data();
+        EXPECT_EQ(get(hdr, 2), 9U);
+        EXPECT_EQ(get(hdr + 2, 2), recs + (pkt == 0 ? 1U : 0U));
+        EXPECT_EQ(get(hdr + 4, 4), 60000U);
+        EXPECT_EQ(get(hdr + 8, 4), NOW_MS / 1000);
+        EXPECT_EQ(get(hdr + 12, 4), pkt);
+        EXPECT_EQ(get(hdr + 16, 4), 5U);
+
+        auto sets = sets_get(hdr + 20, size - 20U);
+        ASSERT_EQ(sets.size(), (pkt == 0) ? 2U : 1U);
+        if (pkt == 0) {
+            ASSERT_EQ(sets[0].id, 0U);
+            const uint8_t *ptr = sets[0].data;
+            auto fields = tmplt_get(ptr, 256);
+            const std::vector<tfield> expected = {
+                {8, 4, 0}, {11, 2, 0}, {4, 1, 0}, {1, 8, 0}, {21, 4, 0}, {22, 4, 0}
+            };
+            EXPECT_EQ(fields, expected);
+        }
+
+        const struct set_info &data = sets.back();
+        ASSERT_EQ(data.id, 256U);
+        EXPECT_EQ(data.size, recs * rec_size);
+        EXPECT_GT(size + rec_size, 600U);
+
+        for (uint32_t i = 0; i < recs; ++i) {
+            const uint8_t *rec = data.data + i * rec_size;
+            const uint64_t last = get(rec + 15, 4);
+            const uint64_t first = get(rec + 19, 4);
+            EXPECT_GT(first, 59000U);
+            EXPECT_LE(first, last);
+            EXPECT_LE(last, 60000U);
+        }
+    }
+
+    EXPECT_EQ(exp.seq, 3U);
+}
+
+// NetFlow v5 packets with fixed records
+TEST_F(Encoder, netflow5)
+{
+    init("<format>netflow5</format><mtu>1500</mtu>",
+        field("srcAddr4", "const", "10.0.0.1")
+        + field("dstPort", "const", "53")
+        + field("protocol", "const", "17")
+        + field("bytes", "const", "1234")
+        + field("packets", "const", "2")
+        + field("srcAS", "const", "65000"));
+    EXPECT_EQ(enc.tset, nullptr);
+
+    uint32_t recs;
+    uint16_t size = packet(UINT32_MAX, &recs);
+    EXPECT_EQ(recs, 30U);
+    EXPECT_EQ(size, 24U + 30U * 48U);
+
+    const uint8_t *hdr = buffer.data();
+    EXPECT_EQ(get(hdr, 2), 5U);
+    EXPECT_EQ(get(hdr + 2, 2), 30U);
+    EXPECT_EQ(get(hdr + 4, 4), 60000U);
+    EXPECT_EQ(get(hdr + 8, 4), NOW_MS / 1000);
+    EXPECT_EQ(get(hdr + 12, 4), 500000000U);
+    EXPECT_EQ(get(hdr + 16, 4), 0U);
+    EXPECT_EQ(get(hdr + 21, 1), 5U);
+
+    for (uint32_t i = 0; i < recs; ++i) {
+        const uint8_t *rec = hdr + 24 + i * 48;
+        EXPECT_EQ(get(rec, 4), 0x0A000001U);
+        EXPECT_EQ(get(rec + 4, 4), 0U);
+        EXPECT_EQ(get(rec + 16, 4), 2U);
+        EXPECT_EQ(get(rec + 20, 4), 1234U);
+        EXPECT_LE(get(rec + 24, 4), get(rec + 28, 4));
+        EXPECT_EQ(get(rec + 34, 2), 53U);
+        EXPECT_EQ(get(rec + 38, 1), 17U);
+        EXPECT_EQ(get(rec + 40, 2), 65000U);
+    }
+
+    // The sequence number is the number of previously sent flows
+    size = packet(7, &recs);
+    EXPECT_EQ(recs, 7U);
+    EXPECT_EQ(size, 24U + 7U * 48U);
+    EXPECT_EQ(get(hdr + 16, 4), 30U);
+    EXPECT_EQ(exp.seq, 37U);
+}
+
+// Too small MTU is refused
+TEST(EncoderInit, mtu)
+{
+    profile_ptr profile = profile_str(profile_xml("<format>ipfix</format><mtu>512</mtu>",
+        field("srcAddr6", "const", "::1") + field("dstAddr6", "const", "::2")));
+    ASSERT_NE(profile, nullptr);
+
+    struct encoder enc;
+    ASSERT_EQ(encoder_init(&enc, profile.get()), 0);
+    encoder_clear(&enc);
+
+    profile->mtu = 64;
+    EXPECT_NE(encoder_init(&enc, profile.get()), 0);
+}